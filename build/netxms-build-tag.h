@@ -0,0 +1,12 @@
+/* BUILDTAG:e7412ba */
+#ifndef _netxms_build_tag_h_
+#define _netxms_build_tag_h_
+#define NETXMS_BUILD_TAG _T("e7412ba")
+#define NETXMS_BUILD_TAG_A "e7412ba"
+#define NETXMS_BUILD_NUMBER 0
+#define NETXMS_BUILD_NUMBER_STRING _T("0")
+#define NETXMS_BUILD_NUMBER_STRING_A "0"
+#define NETXMS_VERSION_BUILD 0
+#define NETXMS_VERSION_STRING _T("4.4.0-SNAPSHOT")
+#define NETXMS_VERSION_STRING_A "4.4.0-SNAPSHOT"
+#endif
@@ -139,4 +139,74 @@ enum
    DBIsTableExist_Found = 1
 };
 
+/**
+ * Find row template in VALUES clause of INSERT statement. Used by drivers that implement batch mode by converting
+ * statement into multi-row INSERT, so only statements in form INSERT INTO ... VALUES (...) without anything after
+ * values list are accepted. On success, start and end offsets of row template (including parentheses) are stored
+ * in valuesStart and valuesEnd.
+ */
+static inline bool DrvFindInsertValuesClause(const char *query, int *valuesStart, int *valuesEnd)
+{
+   if (strnicmp(query, "INSERT", 6))
+      return false;
+
+   bool inString = false;
+   const char *values = nullptr;
+   for(const char *p = query; *p != 0; p++)
+   {
+      if (*p == '\'')
+         inString = !inString;
+      else if (!inString && !strnicmp(p, "VALUES", 6) && ((p == query) || isspace(*(p - 1)) || (*(p - 1) == ')')))
+         values = p;
+   }
+   if (values == nullptr)
+      return false;
+
+   const char *p = values + 6;
+   while(isspace(*p))
+      p++;
+   if (*p != '(')
+      return false;
+
+   const char *start = p;
+   int level = 0;
+   inString = false;
+   for(; *p != 0; p++)
+   {
+      if (*p == '\'')
+         inString = !inString;
+      else if (!inString && (*p == '('))
+         level++;
+      else if (!inString && (*p == ')') && (--level == 0))
+         break;
+   }
+   if (*p == 0)
+      return false;
+
+   const char *end = p + 1;
+   for(p = end; *p != 0; p++)
+      if (!isspace(*p))
+         return false;   // Something after VALUES clause
+
+   *valuesStart = static_cast<int>(start - query);
+   *valuesEnd = static_cast<int>(end - query);
+   return true;
+}
+
+/**
+ * Build multi-row INSERT statement from single row INSERT statement by repeating row template found
+ * by DrvFindInsertValuesClause.
+ */
+static inline void DrvBuildMultiRowInsert(ByteStream *out, const char *query, int valuesStart, int valuesEnd, int rows)
+{
+   size_t rowLen = valuesEnd - valuesStart;
+   out->write(query, valuesStart);
+   for(int i = 0; i < rows; i++)
+   {
+      if (i > 0)
+         out->write(',');
+      out->write(&query[valuesStart], rowLen);
+   }
+}
+
 #endif   /* _dbdrv_h_ */
@@ -244,6 +244,7 @@ struct PolicyChangeNotification
 #define DCIDESC_AGENT_CONFIG_LOAD_STATUS             _T("Agent configuration load status")
 #define DCIDESC_AGENT_CONFIG_SERVER                  _T("Configuration server address set on agent startup")
 #define DCIDESC_AGENT_DATACOLLQUEUESIZE              _T("Agent data collector queue size")
+#define DCIDESC_AGENT_DATACOLLLOSTRECORDS            _T("Number of data collection records lost by agent data collector")
 #define DCIDESC_AGENT_FAILEDREQUESTS                 _T("Number of failed requests to agent")
 #define DCIDESC_AGENT_EVENTS_GENERATED               _T("Agent: generated events")
 #define DCIDESC_AGENT_EVENTS_LAST_TIMESTAMP          _T("Agent: timestamp of last generated event")
@@ -1313,6 +1314,82 @@ class LIBNXAGENT_EXPORTABLE OptionList
    bool getAsBoolean(const TCHAR *key, bool defaultValue = false) const;
 };
 
+/**
+ * Position in offline data queue
+ */
+struct OfflineQueuePosition
+{
+   uint64_t segment;
+   uint32_t offset;
+};
+
+/**
+ * Record read from offline data queue
+ */
+struct OfflineQueueRecord
+{
+   BYTE *data;
+   size_t size;
+   OfflineQueuePosition next;   // Position right after this record
+
+   OfflineQueueRecord(const BYTE *_data, size_t _size, const OfflineQueuePosition& _next)
+   {
+      data = MemCopyBlock(_data, _size);
+      size = _size;
+      next = _next;
+   }
+   ~OfflineQueueRecord()
+   {
+      MemFree(data);
+   }
+};
+
+class OfflineQueueSegment;
+
+/**
+ * Append-only segmented queue for offline data. Records are appended to memory-mapped segment files
+ * and consumed from persistent cursor. Segment files are deleted as a whole when cursor moves past them.
+ */
+class LIBNXAGENT_EXPORTABLE OfflineDataQueue
+{
+private:
+   TCHAR m_path[MAX_PATH];
+   size_t m_segmentSize;
+   Mutex m_mutex;
+   IntegerArray<uint64_t> m_segments;
+   OfflineQueueSegment *m_writeSegment;
+   size_t m_writeOffset;
+   OfflineQueueSegment *m_readSegment;
+   OfflineQueuePosition m_cursor;
+   uint32_t m_pendingRecords;
+
+   void buildSegmentPath(uint64_t id, TCHAR *path) const;
+   OfflineQueueSegment *getSegment(uint64_t id);
+   bool createWriteSegment(size_t recordSize);
+   void deleteSegment(uint64_t id);
+   size_t getDataLimit(OfflineQueueSegment *segment) const;
+   bool nextSegment(OfflineQueuePosition *position) const;
+   void normalizeCursor();
+   void loadCursor();
+   void saveCursor();
+   bool recover();
+   void close();
+
+public:
+   OfflineDataQueue(const TCHAR *path, size_t segmentSize);
+   ~OfflineDataQueue();
+
+   bool open();
+   bool append(const void *data, size_t size);
+   void flush();
+   void read(int maxRecords, ObjectArray<OfflineQueueRecord> *records);
+   void acknowledge(const OfflineQueuePosition& position, uint32_t count);
+   void destroy();
+
+   uint32_t getPendingRecords() const { return m_pendingRecords; }
+   int getSegmentCount() const { return m_segments.size(); }
+};
+
 /**
  * API for subagents
  */
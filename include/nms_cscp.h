@@ -230,6 +230,7 @@ typedef struct
 #define MF_COMPRESSED         0x0040   /* compressed message indicator */
 #define MF_STREAM             0x0080   /* indicates that this message is part of data stream */
 #define MF_DONT_COMPRESS      0x0100   /* prevent message compression */
+#define MF_COMPRESSED_LZ4     0x0200   /* compressed message uses LZ4 instead of deflate (only valid together with MF_COMPRESSED) */
 #define MF_NXCP_VERSION(v)    (((v) & 0x0F) << 12) /* protocol version encoded in highest 4 bits */
 
 /**
@@ -1516,6 +1517,7 @@ typedef struct
 #define VID_MONITOR_ID              ((uint32_t)811)
 #define VID_NUM_TIME_FRAMES         ((uint32_t)812)
 #define VID_NUM_POLL_STATES         ((uint32_t)813)
+#define VID_SYSLOG_BATCHING         ((uint32_t)814)
 
 // Base variabe for single threshold in message
 #define VID_THRESHOLD_BASE          ((UINT32)0x00800000)
@@ -1722,6 +1722,7 @@ template <class T> class IntegerArray : public Array
    bool contains(T value) const { return indexOf(value) >= 0; }
    void set(int index, T value) { Array::set(index, m_storePointers ? CAST_TO_POINTER(value, void *) : &value); }
    void replace(int index, T value) { Array::replace(index, m_storePointers ? CAST_TO_POINTER(value, void *) : &value); }
+   void insert(int index, T value) { Array::insert(index, m_storePointers ? CAST_TO_POINTER(value, void *) : &value); }
 
    using Array::sort;
    void sort(int (*cb)(const T *, const T *)) { Array::sort((int (*)(const void *, const void *))cb); }
@@ -3298,6 +3299,17 @@ class LIBNETXMS_EXPORTABLE TableColumnDefinition
    void setMultiplier(int multiplier) { m_multipier = multiplier; }
 };
 
+/**
+ * Type of numeric representation of table cell value
+ */
+enum class TableCellNumericType
+{
+   NONE = 0,
+   INTEGER = 1,
+   UNSIGNED = 2,
+   FLOAT = 3
+};
+
 /**
  * Table cell
  */
@@ -3307,6 +3319,13 @@ class TableCell
    TCHAR *m_value;
    int m_status;
    uint32_t m_objectId;
+   TableCellNumericType m_numericType;
+   union
+   {
+      int64_t i;
+      uint64_t u;
+      double d;
+   } m_numericValue;
 
 public:
    TableCell()
@@ -3314,24 +3333,29 @@ class TableCell
       m_value = nullptr;
       m_status = -1;
       m_objectId = 0;
+      m_numericType = TableCellNumericType::NONE;
    }
    TableCell(const TCHAR *value)
    {
       m_value = MemCopyString(value);
       m_status = -1;
       m_objectId = 0;
+      m_numericType = TableCellNumericType::NONE;
    }
    TableCell(const TCHAR *value, int status)
    {
       m_value = MemCopyString(value);
       m_status = status;
       m_objectId = 0;
+      m_numericType = TableCellNumericType::NONE;
    }
    TableCell(const TableCell& src)
    {
       m_value = MemCopyString(src.m_value);
       m_status = src.m_status;
       m_objectId = src.m_objectId;
+      m_numericType = src.m_numericType;
+      m_numericValue = src.m_numericValue;
    }
    ~TableCell()
    {
@@ -3344,6 +3368,7 @@ class TableCell
       m_value = MemCopyString(value);
       m_status = status;
       m_objectId = objectId;
+      m_numericType = TableCellNumericType::NONE;
    }
    void setPreallocated(TCHAR *value, int status, uint32_t objectId)
    {
@@ -3351,6 +3376,7 @@ class TableCell
       m_value = value;
       m_status = status;
       m_objectId = objectId;
+      m_numericType = TableCellNumericType::NONE;
    }
 
    const TCHAR *getValue() const { return m_value; }
@@ -3358,13 +3384,54 @@ class TableCell
    {
       MemFree(m_value);
       m_value = MemCopyString(value);
+      m_numericType = TableCellNumericType::NONE;
    }
    void setPreallocatedValue(TCHAR *value)
    {
       MemFree(m_value);
       m_value = value;
+      m_numericType = TableCellNumericType::NONE;
+   }
+
+   /**
+    * Update numeric representation of cell value according to column data type
+    */
+   void updateNumericValue(int32_t dataType)
+   {
+      if (m_value == nullptr)
+      {
+         m_numericType = TableCellNumericType::NONE;
+         return;
+      }
+      switch(dataType)
+      {
+         case DCI_DT_INT:
+         case DCI_DT_INT64:
+            m_numericValue.i = _tcstoll(m_value, nullptr, 0);
+            m_numericType = TableCellNumericType::INTEGER;
+            break;
+         case DCI_DT_UINT:
+         case DCI_DT_UINT64:
+         case DCI_DT_COUNTER32:
+         case DCI_DT_COUNTER64:
+            m_numericValue.u = _tcstoull(m_value, nullptr, 0);
+            m_numericType = TableCellNumericType::UNSIGNED;
+            break;
+         case DCI_DT_FLOAT:
+            m_numericValue.d = _tcstod(m_value, nullptr);
+            m_numericType = TableCellNumericType::FLOAT;
+            break;
+         default:
+            m_numericType = TableCellNumericType::NONE;
+            break;
+      }
    }
 
+   TableCellNumericType getNumericType() const { return m_numericType; }
+   int64_t getIntegerValue() const { return m_numericValue.i; }
+   uint64_t getUnsignedValue() const { return m_numericValue.u; }
+   double getFloatValue() const { return m_numericValue.d; }
+
    int getStatus() const { return m_status; }
    void setStatus(int status) { m_status = status; }
 
@@ -3434,6 +3501,14 @@ class TableRow
       const TableCell *c = m_cells.get(index);
       return (c != nullptr) ? c->getValue() : nullptr;
    }
+   const TableCell *getCell(int index) const { return m_cells.get(index); }
+   void updateNumericValue(int index, int32_t dataType)
+   {
+      TableCell *c = m_cells.get(index);
+      if (c != nullptr)
+         c->updateNumericValue(dataType);
+   }
+
    int getStatus(int index) const
    {
       const TableCell *c = m_cells.get(index);
@@ -3464,6 +3539,11 @@ template class LIBNETXMS_EXPORTABLE ObjectArray<TableRow>;
 template class LIBNETXMS_EXPORTABLE ObjectArray<TableColumnDefinition>;
 #endif
 
+/**
+ * Entry of table instance index
+ */
+struct TableInstanceIndexEntry;
+
 /**
  * Class for table data storage
  */
@@ -3475,9 +3555,24 @@ class LIBNETXMS_EXPORTABLE Table
    TCHAR *m_title;
    int m_source;
    bool m_extendedFormat;
+   TableInstanceIndexEntry *m_instanceIndex;
+   int m_indexedRows;   // Rows [0, m_indexedRows) are present in instance index
+   Mutex m_instanceIndexLock;
 
    void createFromMessage(const NXCPMessage& msg);
    bool parseXML(const char *xml);
+   bool parsePackedData(const BYTE *data, size_t size);
+
+   void addToInstanceIndex(int row);
+   void removeFromInstanceIndex(int row);
+   void destroyInstanceIndex();
+   void clearInstanceIndex();
+   void updateNumericValues(TableRow *row);
+   const TableCell *getCell(int row, int col) const
+   {
+      const TableRow *r = m_data.get(row);
+      return (r != nullptr) ? r->getCell(col) : nullptr;
+   }
 
 public:
    Table();
@@ -3503,18 +3598,29 @@ class LIBNETXMS_EXPORTABLE Table
 
    const TCHAR *getColumnName(int col) const { return ((col >= 0) && (col < m_columns.size())) ? m_columns.get(col)->getName() : nullptr; }
    int32_t getColumnDataType(int col) const { return ((col >= 0) && (col < m_columns.size())) ? m_columns.get(col)->getDataType() : 0; }
-   const TableColumnDefinition *getColumnDefinition(int col) const { return m_columns.get(col); }
+   const TableColumnDefinition *getColumnDefinition(int col) const { return ((col >= 0) && (col < m_columns.size())) ? m_columns.get(col) : nullptr; }
 	int getColumnIndex(const TCHAR *name) const;
-   const ObjectArray<TableColumnDefinition>& getColumnDefinitions() { return m_columns; }
 
    void setTitle(const TCHAR *title) { MemFree(m_title); m_title = MemCopyString(title); }
    void setSource(int source) { m_source = source; }
    int addColumn(const TCHAR *name, int32_t dataType = 0, const TCHAR *displayName = nullptr, bool isInstance = false);
    int addColumn(const TableColumnDefinition& d);
-   void setColumnDataType(int col, int32_t dataType)
+   void setColumnDataType(int col, int32_t dataType);
+   void setInstanceColumn(int col, bool isInstance);
+   void setColumnDisplayName(int col, const TCHAR *displayName)
+   {
+      if ((col >= 0) && (col < m_columns.size()))
+         m_columns.get(col)->setDisplayName(displayName);
+   }
+   void setColumnUnitName(int col, const TCHAR *unitName)
    {
       if ((col >= 0) && (col < m_columns.size()))
-         m_columns.get(col)->setDataType(dataType);
+         m_columns.get(col)->setUnitName(unitName);
+   }
+   void setColumnMultiplier(int col, int multiplier)
+   {
+      if ((col >= 0) && (col < m_columns.size()))
+         m_columns.get(col)->setMultiplier(multiplier);
    }
    int addRow();
 
@@ -3554,6 +3660,7 @@ class LIBNETXMS_EXPORTABLE Table
 
    int getStatus(int nRow, int nCol) const;
 
+   void buildInstanceString(int row, StringBuffer *instance) const;
    void buildInstanceString(int row, TCHAR *buffer, size_t bufLen);
    int findRowByInstance(const TCHAR *instance);
 
@@ -3598,6 +3705,9 @@ class LIBNETXMS_EXPORTABLE Table
    static Table *createFromPackedXML(const char *packedXml);
    char *createPackedXML() const;
 
+   static Table *createFromPackedData(const char *packedData);
+   char *createPackedData() const;
+
    static Table *createFromCSV(const TCHAR *content, const TCHAR separator);
 };
 
@@ -4101,7 +4211,9 @@ class LIBNETXMS_EXPORTABLE SocketPoller
    struct pollfd m_sockets[SOCKET_POLLER_MAX_SOCKETS];
 #else
    bool m_invalidDescriptor;
+   bool m_hasAltDescriptors;
    fd_set m_rwDescriptors;
+   fd_set m_altDescriptors;   // Sockets polled in direction opposite to m_write
    fd_set m_exDescriptors;
 #ifndef _WIN32
    SOCKET m_maxfd;
@@ -4113,9 +4225,11 @@ class LIBNETXMS_EXPORTABLE SocketPoller
    SocketPoller(const SocketPoller& src) = delete;
    ~SocketPoller();
 
-   bool add(SOCKET s);
+   bool add(SOCKET s) { return add(s, m_write); }
+   bool add(SOCKET s, bool write);
    int poll(uint32_t timeout);
    bool isSet(SOCKET s);
+   bool isSet(SOCKET s, bool write);
    bool isReady(SOCKET s);
    bool isError(SOCKET s);
    void reset();
@@ -4153,6 +4267,7 @@ struct BackgroundSocketPollRequest
    void *context;
    int64_t queueTime;
    uint32_t timeout;
+   bool write;
    bool cancelled;
 };
 
@@ -4182,10 +4297,10 @@ class LIBNETXMS_EXPORTABLE BackgroundSocketPoller
    BackgroundSocketPoller(const BackgroundSocketPoller& src) = delete;
    ~BackgroundSocketPoller();
 
-   void poll(SOCKET socket, uint32_t timeout, void (*callback)(BackgroundSocketPollResult, SOCKET, void*), void *context);
-   template<typename C> void poll(SOCKET socket, uint32_t timeout, void (*callback)(BackgroundSocketPollResult, SOCKET, C*), C *context)
+   void poll(SOCKET socket, uint32_t timeout, void (*callback)(BackgroundSocketPollResult, SOCKET, void*), void *context, bool write = false);
+   template<typename C> void poll(SOCKET socket, uint32_t timeout, void (*callback)(BackgroundSocketPollResult, SOCKET, C*), C *context, bool write = false)
    {
-      poll(socket, timeout, reinterpret_cast<void (*)(BackgroundSocketPollResult, SOCKET, void*)>(callback), context);
+      poll(socket, timeout, reinterpret_cast<void (*)(BackgroundSocketPollResult, SOCKET, void*)>(callback), context, write);
    }
    void cancel(SOCKET socket);
    void shutdown();
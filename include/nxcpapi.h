@@ -47,6 +47,16 @@ enum class FileTransferResumeMode : uint16_t
    RESUME = 2     // Resume file transfer (append to existing file part)
 };
 
+/**
+ * NXCP compression methods (used for both file streams and individual messages)
+ */
+enum NXCPStreamCompressionMethod
+{
+   NXCP_STREAM_COMPRESSION_NONE = 0,
+   NXCP_STREAM_COMPRESSION_LZ4 = 1,
+   NXCP_STREAM_COMPRESSION_DEFLATE = 2
+};
+
 /**
  * Default size hint
  */
@@ -84,7 +94,8 @@ class LIBNETXMS_EXPORTABLE NXCPMessage
    ~NXCPMessage();
 
    static NXCPMessage *deserialize(const NXCP_MESSAGE *rawMsg, int version = NXCP_VERSION);
-   NXCP_MESSAGE *serialize(bool allowCompression = false) const;
+   NXCP_MESSAGE *serialize(bool allowCompression = false) const { return serialize(allowCompression ? NXCP_STREAM_COMPRESSION_DEFLATE : NXCP_STREAM_COMPRESSION_NONE); }
+   NXCP_MESSAGE *serialize(NXCPStreamCompressionMethod compressionMethod) const;
 
    uint16_t getCode() const { return m_code; }
    void setCode(uint16_t code) { m_code = code; }
@@ -450,16 +461,6 @@ class LIBNETXMS_EXPORTABLE PipeMessageReceiver : public AbstractMessageReceiver
    virtual void cancel() override;
 };
 
-/**
- * NXCP stresam compression methods
- */
-enum NXCPStreamCompressionMethod
-{
-   NXCP_STREAM_COMPRESSION_NONE = 0,
-   NXCP_STREAM_COMPRESSION_LZ4 = 1,
-   NXCP_STREAM_COMPRESSION_DEFLATE = 2
-};
-
 /**
  * Abstract stream compressor
  */
@@ -607,6 +608,8 @@ bool LIBNETXMS_EXPORTABLE SendFileOverNXCP(AbstractCommChannel *channel, uint32_
          void (* progressCallback)(size_t, void *), void *cbArg, Mutex *mutex, NXCPStreamCompressionMethod compressionMethod = NXCP_STREAM_COMPRESSION_NONE,
          VolatileCounter *cancellationFlag = nullptr);
 
+void LIBNETXMS_EXPORTABLE NXCPSetMessageCompressionLevel(int level);
+
 TCHAR LIBNETXMS_EXPORTABLE *NXCPMessageCodeName(uint16_t vode, TCHAR *buffer);
 void LIBNETXMS_EXPORTABLE NXCPRegisterMessageNameResolver(NXCPMessageNameResolver r);
 void LIBNETXMS_EXPORTABLE NXCPUnregisterMessageNameResolver(NXCPMessageNameResolver r);
@@ -175,4 +175,69 @@ template<typename T> class SharedObjectQueue : public Queue
    void insert(shared_ptr<T> object) { Queue::insert(new(m_pool.allocate()) shared_ptr<T>(object)); }
 };
 
+/**
+ * Internal bounded queue data
+ */
+struct BoundedQueueData;
+
+/**
+ * Bounded lock-free multi-producer/multi-consumer queue. Elements are stored in fixed size
+ * ring buffer (capacity is rounded up to power of 2). Producers and consumers only block
+ * (and take internal lock) when queue is full or empty respectively. Unlike Queue, it does not
+ * support insert(), find(), forEach() or remove() and is not a drop-in replacement for it.
+ */
+class LIBNETXMS_EXPORTABLE BoundedQueue
+{
+private:
+   BoundedQueueData *m_data;
+   bool m_owner;
+
+   bool enqueue(void *object);
+   void *dequeue();
+   bool putOrBlock(void *object);
+   void wakeConsumers(bool all);
+   void wakeProducers(bool all);
+
+protected:
+   void (*m_destructor)(void*, BoundedQueue*);
+
+public:
+   BoundedQueue(size_t capacity = 1024, Ownership owner = Ownership::False);
+   BoundedQueue(const BoundedQueue& src) = delete;
+   virtual ~BoundedQueue();
+
+   bool put(void *object);
+   bool tryPut(void *object);
+   bool putMany(void **objects, size_t count);
+   void setShutdownMode();
+   void setOwner(bool owner) { m_owner = owner; }
+   void *get();
+   void *getOrBlock(uint32_t timeout = INFINITE);
+   size_t getAll(void **buffer, size_t maxCount);
+   size_t size() const;
+   size_t capacity() const;
+   void clear();
+};
+
+/**
+ * Bounded object queue
+ */
+template<typename T> class BoundedObjectQueue : public BoundedQueue
+{
+private:
+   static void destructor(void *object, BoundedQueue *queue) { delete static_cast<T*>(object); }
+
+public:
+   BoundedObjectQueue(size_t capacity = 1024, Ownership owner = Ownership::False) : BoundedQueue(capacity, owner) { m_destructor = destructor; }
+   BoundedObjectQueue(const BoundedObjectQueue& src) = delete;
+   virtual ~BoundedObjectQueue() { clear(); }
+
+   bool put(T *object) { return BoundedQueue::put(object); }
+   bool tryPut(T *object) { return BoundedQueue::tryPut(object); }
+   bool putMany(T **objects, size_t count) { return BoundedQueue::putMany(reinterpret_cast<void**>(objects), count); }
+   T *get() { return static_cast<T*>(BoundedQueue::get()); }
+   T *getOrBlock(uint32_t timeout = INFINITE) { return static_cast<T*>(BoundedQueue::getOrBlock(timeout)); }
+   size_t getAll(T **buffer, size_t maxCount) { return BoundedQueue::getAll(reinterpret_cast<void**>(buffer), maxCount); }
+};
+
 #endif    /* _nxqueue_h_ */
@@ -114,7 +114,7 @@ struct NXSL_FileHeader
 /**
  * Binary format version
  */
-#define NXSL_BIN_FORMAT_VERSION     3
+#define NXSL_BIN_FORMAT_VERSION     4
 
 /**
  * Exportable classes
@@ -124,7 +124,7 @@ struct NXSL_FileHeader
 /**
  * Functions
  */
-NXSL_Program LIBNXSL_EXPORTABLE *NXSLCompile(const TCHAR *source, TCHAR *errorMessage, size_t errorMessageLen, int *errorLineNumber, NXSL_Environment *env);
+NXSL_Program LIBNXSL_EXPORTABLE *NXSLCompile(const TCHAR *source, TCHAR *errorMessage, size_t errorMessageLen, int *errorLineNumber, NXSL_Environment *env, bool fullOptimization = true);
 NXSL_VM LIBNXSL_EXPORTABLE *NXSLCompileAndCreateVM(const TCHAR *source, TCHAR *errorMessage, size_t errorMessageLen, NXSL_Environment *env);
 TCHAR LIBNXSL_EXPORTABLE *NXSLLoadFile(const TCHAR *fileName);
 
@@ -1082,12 +1082,14 @@ class LIBNXSL_EXPORTABLE NXSL_Program : public NXSL_ValueManager
    NXSL_ValueHashMap<NXSL_Identifier> m_constants;
    StructArray<NXSL_Function> m_functions;
    StringMap m_metadata;
+   uint64_t m_id;
 
 public:
    NXSL_Program(size_t valueRegionSize = 0, size_t identifierRegionSize = 0);
    NXSL_Program(NXSL_ProgramBuilder *builder);
    ~NXSL_Program();
 
+   uint64_t getId() const { return m_id; }
    uint32_t getCodeSize() const { return m_instructionSet.size(); }
    bool isEmpty() const;
    StringList *getRequiredModules() const;
@@ -1139,6 +1141,16 @@ class LIBNXSL_EXPORTABLE NXSL_LibraryScript
 class ScriptVMHandle;
 enum class ScriptVMFailureReason;
 
+/**
+ * Idle VM in library VM pool
+ */
+struct NXSL_PooledVM
+{
+   NXSL_VM *vm;
+   uint64_t generation;
+   time_t releaseTime;
+};
+
 /**
  * Script library
  */
@@ -1147,6 +1159,12 @@ class LIBNXSL_EXPORTABLE NXSL_Library
 private:
    ObjectArray<NXSL_LibraryScript> *m_scriptList;
    Mutex m_mutex;
+   VolatileCounter64 m_generation;
+   HashMap<uint64_t, StructArray<NXSL_PooledVM>> m_vmPool;
+   Mutex m_vmPoolMutex;
+   int m_vmPoolSize;
+   int m_vmPoolLimitPerProgram;
+   int m_vmPoolLimitTotal;
 
    void deleteInternal(int nIndex);
 
@@ -1165,7 +1183,14 @@ class LIBNXSL_EXPORTABLE NXSL_Library
    NXSL_LibraryScript *findScript(const TCHAR *name);
    StringList *getScriptDependencies(const TCHAR *name);
    NXSL_VM *createVM(const TCHAR *name, NXSL_Environment *env);
-   ScriptVMHandle createVM(const TCHAR *name, std::function<NXSL_Environment *()> environmentCreator, std::function<ScriptVMFailureReason (NXSL_LibraryScript*)> scriptValidator);
+   ScriptVMHandle createVM(const TCHAR *name, std::function<NXSL_Environment *()> environmentCreator,
+            std::function<ScriptVMFailureReason (NXSL_LibraryScript*)> scriptValidator, bool usePool = false);
+
+   ScriptVMHandle acquireVM(const NXSL_Program *program, std::function<NXSL_Environment *()> environmentCreator);
+   void releaseVM(NXSL_VM *vm, uint64_t programId, uint64_t generation);
+   void purgeVMPool(time_t maxIdleTime);
+   void setVMPoolLimits(int perProgram, int total);
+   int getVMPoolSize() const;
 
    void forEach(std::function<void (const NXSL_LibraryScript*)> callback);
 
@@ -1258,6 +1283,7 @@ class LIBNXSL_EXPORTABLE NXSL_VM : public NXSL_ValueManager
    uint16_t m_spreadCounts[NESTED_FUNCTION_CALLS_LIMIT]; // Number of stack items produced by SPREAD instruction at current level
 
    NXSL_VariableSystem *m_constants;
+   NXSL_VariableSystem *m_programConstants;  // Constants as they were after program load (used by reset)
    NXSL_VariableSystem *m_globalVariables;
    NXSL_VariableSystem *m_localVariables;
    NXSL_VariableSystem *m_expressionVariables;
@@ -1359,6 +1385,7 @@ class LIBNXSL_EXPORTABLE NXSL_VM : public NXSL_ValueManager
 	void setContextObject(NXSL_Value *value);
 
    bool load(const NXSL_Program *program);
+   void reset();
    bool run(const ObjectRefArray<NXSL_Value>& args, NXSL_VariableSystem **globals = nullptr,
             NXSL_VariableSystem **expressionVariables = nullptr,
             NXSL_VariableSystem *constants = nullptr, const char *entryPoint = nullptr);
@@ -1418,10 +1445,35 @@ class LIBNXSL_EXPORTABLE ScriptVMHandle
 private:
    NXSL_VM *m_vm;
    ScriptVMFailureReason m_failureReason;
+   NXSL_Library *m_pool;
+   uint64_t m_programId;
+   uint64_t m_generation;
 
 public:
-   ScriptVMHandle(NXSL_VM *vm) { m_vm = vm; m_failureReason = ScriptVMFailureReason::SUCCESS; }
-   ScriptVMHandle(ScriptVMFailureReason failureReason) { m_vm = nullptr; m_failureReason = failureReason; }
+   ScriptVMHandle(NXSL_VM *vm)
+   {
+      m_vm = vm;
+      m_failureReason = ScriptVMFailureReason::SUCCESS;
+      m_pool = nullptr;
+      m_programId = 0;
+      m_generation = 0;
+   }
+   ScriptVMHandle(NXSL_VM *vm, NXSL_Library *pool, uint64_t programId, uint64_t generation)
+   {
+      m_vm = vm;
+      m_failureReason = ScriptVMFailureReason::SUCCESS;
+      m_pool = pool;
+      m_programId = programId;
+      m_generation = generation;
+   }
+   ScriptVMHandle(ScriptVMFailureReason failureReason)
+   {
+      m_vm = nullptr;
+      m_failureReason = failureReason;
+      m_pool = nullptr;
+      m_programId = 0;
+      m_generation = 0;
+   }
 
    operator NXSL_VM *() { return m_vm; }
    NXSL_VM *operator->() { return m_vm; }
@@ -1429,8 +1481,19 @@ class LIBNXSL_EXPORTABLE ScriptVMHandle
    ScriptVMFailureReason failureReason() const { return m_failureReason; }
    const TCHAR *failureReasonText() const;
    bool isValid() const { return m_vm != nullptr; }
+   bool isPooled() const { return m_pool != nullptr; }
 
-   void destroy() { delete m_vm; }
+   /**
+    * Destroy VM or return it to the pool it was taken from
+    */
+   void destroy()
+   {
+      if ((m_pool != nullptr) && (m_vm != nullptr))
+         m_pool->releaseVM(m_vm, m_programId, m_generation);
+      else
+         delete m_vm;
+      m_vm = nullptr;
+   }
 };
 
 /**
@@ -714,6 +714,7 @@ class LIBNXSNMP_EXPORTABLE SNMP_PDU
    SNMP_Variable *getVariable(int index) { return m_variables.get(index); }
    SNMP_Version getVersion() const { return m_version; }
    SNMP_ErrorCode getErrorCode() const { return static_cast<SNMP_ErrorCode>(m_errorCode); }
+   uint32_t getErrorIndex() const { return m_errorIndex; }
 
    void setTrapId(const SNMP_ObjectId& id) { setTrapId(id.value(), id.length()); }
    void setTrapId(const uint32_t *value, size_t length);
@@ -753,6 +754,12 @@ class LIBNXSNMP_EXPORTABLE SNMP_PDU
    void unlinkVariables();
 };
 
+/**
+ * Completion callback for asynchronous SNMP request. Callback takes ownership of response PDU (which is
+ * nullptr if request failed). Callbacks are called from engine I/O thread and should not block.
+ */
+typedef void (*SNMP_RequestCallback)(uint32_t rcc, SNMP_PDU *response, void *context);
+
 /**
  * Generic SNMP transport
  */
@@ -770,6 +777,8 @@ class LIBNXSNMP_EXPORTABLE SNMP_Transport
 
 	uint32_t doEngineIdDiscovery(SNMP_PDU *originalRequest, uint32_t timeout, int numRetries);
 
+   virtual bool submitAsyncRequest(SNMP_PDU *request, uint32_t timeout, int numRetries, SNMP_RequestCallback callback, void *context);
+
 public:
    SNMP_Transport();
    virtual ~SNMP_Transport();
@@ -783,6 +792,8 @@ class LIBNXSNMP_EXPORTABLE SNMP_Transport
 
    uint32_t doRequest(SNMP_PDU *request, SNMP_PDU **response, uint32_t timeout, int numRetries, bool engineIdDiscoveryOnly = false);
    uint32_t doRequest(SNMP_PDU *request, SNMP_PDU **response);
+   void doRequestAsync(SNMP_PDU *request, SNMP_RequestCallback callback, void *context, uint32_t timeout, int numRetries);
+   void doRequestAsync(SNMP_PDU *request, SNMP_RequestCallback callback, void *context);
    uint32_t sendTrap(SNMP_PDU *trap, uint32_t timeout = INFINITE, int numRetries = 1);
 
 	void setSecurityContext(SNMP_SecurityContext *ctx);
@@ -820,6 +831,9 @@ class LIBNXSNMP_EXPORTABLE SNMP_UDPTransport : public SNMP_Transport
    size_t preParsePDU();
    int recvData(UINT32 dwTimeout, struct sockaddr *pSender, socklen_t *piAddrSize);
    void clearBuffer();
+   uint32_t createSocket();
+
+   virtual bool submitAsyncRequest(SNMP_PDU *request, uint32_t timeout, int numRetries, SNMP_RequestCallback callback, void *context) override;
 
 public:
    SNMP_UDPTransport();
@@ -905,6 +919,9 @@ const TCHAR LIBNXSNMP_EXPORTABLE *SnmpGetErrorText(uint32_t errorCode);
 const TCHAR LIBNXSNMP_EXPORTABLE *SnmpGetProtocolErrorText(SNMP_ErrorCode errorCode);
 
 uint32_t LIBNXSNMP_EXPORTABLE SnmpNewRequestId();
+bool LIBNXSNMP_EXPORTABLE SnmpStartAsyncEngine();
+void LIBNXSNMP_EXPORTABLE SnmpStopAsyncEngine();
+int LIBNXSNMP_EXPORTABLE SnmpGetAsyncEnginePendingRequests();
 void LIBNXSNMP_EXPORTABLE SnmpSetDefaultTimeout(uint32_t timeout);
 uint32_t LIBNXSNMP_EXPORTABLE SnmpGetDefaultTimeout();
 void LIBNXSNMP_EXPORTABLE SnmpSetDefaultRetryCount(int numRetries);
@@ -920,6 +937,8 @@ int LIBNXSNMP_EXPORTABLE SnmpWalkCount(SNMP_Transport *transport, const TCHAR *r
 
 uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, const InetAddress& to, uint16_t port, SNMP_Version snmpVersion,
       const char *community, void (*callback)(const InetAddress&, uint32_t, void*), void *context);
+uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, const InetAddress& to, uint16_t port, const StringList& communities,
+      bool probeV3, void (*callback)(const InetAddress&, uint32_t, void*), void *context);
 
 /**
  * Enumerate multiple values by walking through MIB, starting at given root
@@ -53,6 +53,7 @@ extern uint32_t g_dcWriterMaxTransactionSize;
 extern uint32_t g_dcMinCollectorPoolSize;
 extern uint32_t g_dcMaxCollectorPoolSize;
 extern uint32_t g_dcOfflineExpirationTime;
+extern uint64_t g_dcOfflineLogSegmentSize;
 
 /**
  * Data collector start indicator
@@ -749,6 +750,41 @@ class DataElement
       }
    }
 
+   /**
+    * Create data element from serialized form (as produced by serialize())
+    */
+   DataElement(uint64_t serverId, const BYTE *data, size_t size)
+   {
+      ByteStream in(data, size);
+      m_serverId = serverId;
+      m_dciId = in.readUInt32B();
+      m_type = in.readInt16B();
+      m_origin = in.readInt16B();
+      m_statusCode = in.readUInt32B();
+      m_timestamp = static_cast<time_t>(in.readInt64B());
+      uuid_t guid;
+      in.read(guid, UUID_LENGTH);
+      m_snmpNode = uuid(guid);
+
+      uint32_t len = in.readUInt32B();
+      char *value = MemAllocArrayNoInit<char>(len + 1);
+      value[in.read(value, len)] = 0;
+      switch(m_type)
+      {
+         case DCO_TYPE_ITEM:
+            m_value.item = TStringFromUTF8String(value);
+            break;
+         case DCO_TYPE_TABLE:
+            m_value.table = Table::createFromXML(value);
+            break;
+         default:
+            m_type = DCO_TYPE_ITEM;
+            m_value.item = MemCopyString(_T(""));
+            break;
+      }
+      MemFree(value);
+   }
+
    ~DataElement()
    {
       switch(m_type)
@@ -768,7 +804,8 @@ class DataElement
    int getType() const { return m_type; }
    uint32_t getStatusCode() const { return m_statusCode; }
 
-   void saveToDatabase(DB_STATEMENT hStmt) const;
+   bool saveToDatabase(DB_STATEMENT hStmt) const;
+   void serialize(ByteStream *out) const;
    bool sendToServer(bool reconcillation) const;
    void fillReconciliationMessage(NXCPMessage *msg, uint32_t baseId) const;
 };
@@ -776,7 +813,7 @@ class DataElement
 /**
  * Save data element to database
  */
-void DataElement::saveToDatabase(DB_STATEMENT hStmt) const
+bool DataElement::saveToDatabase(DB_STATEMENT hStmt) const
 {
    DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, m_serverId);
    DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, (LONG)m_dciId);
@@ -794,7 +831,36 @@ void DataElement::saveToDatabase(DB_STATEMENT hStmt) const
          DBBind(hStmt, 8, DB_SQLTYPE_TEXT, m_value.table->createXML(), DB_BIND_DYNAMIC);
          break;
    }
-   DBExecute(hStmt);
+   return DBExecute(hStmt);
+}
+
+/**
+ * Serialize data element for offline data queue
+ */
+void DataElement::serialize(ByteStream *out) const
+{
+   out->writeB(m_dciId);
+   out->writeB(static_cast<int16_t>(m_type));
+   out->writeB(static_cast<int16_t>(m_origin));
+   out->writeB(m_statusCode);
+   out->writeB(static_cast<int64_t>(m_timestamp));
+   out->write(m_snmpNode.getValue(), UUID_LENGTH);
+
+   char *value;
+   if (m_type == DCO_TYPE_TABLE)
+   {
+      TCHAR *xml = m_value.table->createXML();
+      value = UTF8StringFromTString(xml);
+      MemFree(xml);
+   }
+   else
+   {
+      value = UTF8StringFromTString(m_value.item);
+   }
+   uint32_t len = static_cast<uint32_t>(strlen(value));
+   out->writeB(len);
+   out->write(value, len);
+   MemFree(value);
 }
 
 /**
@@ -886,6 +952,11 @@ static Mutex s_serverSyncStatusLock;
  */
 static ObjectQueue<DataElement> s_databaseWriterQueue;
 
+/**
+ * Query for inserting data element into local database queue
+ */
+static const TCHAR s_dcQueueInsertQuery[] = _T("INSERT INTO dc_queue (server_id,dci_id,dci_type,dci_origin,status_code,snmp_target_guid,timestamp,value) VALUES (?,?,?,?,?,?,?,?)");
+
 /**
  * Database writer
  */
@@ -900,7 +971,7 @@ static void DatabaseWriter()
       if (e == INVALID_POINTER_VALUE)
          break;
 
-      DB_STATEMENT hStmt = DBPrepare(hdb, _T("INSERT INTO dc_queue (server_id,dci_id,dci_type,dci_origin,status_code,snmp_target_guid,timestamp,value) VALUES (?,?,?,?,?,?,?,?)"));
+      DB_STATEMENT hStmt = DBPrepare(hdb, s_dcQueueInsertQuery);
       if (hStmt == nullptr)
       {
          delete e;
@@ -934,6 +1005,136 @@ static void DatabaseWriter()
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Database writer thread stopped"));
 }
 
+/**
+ * Offline data queues (used instead of local database if offline data log is enabled)
+ */
+static HashMap<uint64_t, OfflineDataQueue> s_offlineQueues(Ownership::True);
+static Mutex s_offlineQueuesLock(MutexType::FAST);
+
+/**
+ * Get offline data queue for given server. Queue is created if it does not exist yet.
+ */
+static OfflineDataQueue *GetOfflineDataQueue(uint64_t serverId)
+{
+   s_offlineQueuesLock.lock();
+   OfflineDataQueue *queue = s_offlineQueues.get(serverId);
+   if (queue == nullptr)
+   {
+      TCHAR path[MAX_PATH];
+      _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR _T("dcqueue") FS_PATH_SEPARATOR UINT64X_FMT(_T("016")), g_szDataDirectory, serverId);
+      queue = new OfflineDataQueue(path, static_cast<size_t>(g_dcOfflineLogSegmentSize));
+      if (queue->open())
+      {
+         s_offlineQueues.set(serverId, queue);
+      }
+      else
+      {
+         delete queue;
+         queue = nullptr;
+      }
+   }
+   s_offlineQueuesLock.unlock();
+   return queue;
+}
+
+/**
+ * Set if local database contains data elements not yet moved to offline data log
+ */
+static bool s_offlineDataMigrationPending = false;
+
+/**
+ * Move offline data stored in local database into offline data log
+ */
+static bool MigrateOfflineDataToLog(DB_HANDLE hdb);
+
+/**
+ * Number of data elements lost because they cannot be written either to offline data log or to local database
+ */
+static VolatileCounter64 s_offlineDataLostRecords = 0;
+
+/**
+ * Offline data log writer. Alternative to database writer which appends data elements to offline data queue.
+ * Data elements that cannot be written to offline data log (for example, because of insufficient disk space
+ * for new segment) are saved to local database and moved to offline data log later by reconciliation thread.
+ */
+static void OfflineLogWriter()
+{
+   DB_HANDLE hdb = GetLocalDatabaseHandle();
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Offline data log writer thread started"));
+
+   ByteStream record(1024);
+   ObjectArray<OfflineDataQueue> modifiedQueues(16, 16, Ownership::False);
+   while(true)
+   {
+      DataElement *e = s_databaseWriterQueue.getOrBlock();
+      if (e == INVALID_POINTER_VALUE)
+         break;
+
+      uint32_t count = 0, savedToDatabase = 0, lost = 0;
+      DB_STATEMENT hStmt = nullptr;
+      while((e != nullptr) && (e != INVALID_POINTER_VALUE))
+      {
+         bool success = false;
+         OfflineDataQueue *queue = GetOfflineDataQueue(e->getServerId());
+         if (queue != nullptr)
+         {
+            record.clear();
+            e->serialize(&record);
+            if (queue->append(record.buffer(), record.size()))
+            {
+               if (!modifiedQueues.contains(queue))
+                  modifiedQueues.add(queue);
+               count++;
+               success = true;
+            }
+         }
+
+         if (!success)
+         {
+            if (hStmt == nullptr)
+            {
+               hStmt = DBPrepare(hdb, s_dcQueueInsertQuery);
+               if (hStmt != nullptr)
+                  DBBegin(hdb);
+            }
+            if ((hStmt != nullptr) && e->saveToDatabase(hStmt))
+               savedToDatabase++;
+            else
+               lost++;
+         }
+
+         delete e;
+         e = s_databaseWriterQueue.get();
+      }
+
+      for(int i = 0; i < modifiedQueues.size(); i++)
+         modifiedQueues.get(i)->flush();
+      modifiedQueues.clear();
+      nxlog_debug_tag(DEBUG_TAG, 7, _T("Offline data log writer: %u records written"), count);
+
+      if (hStmt != nullptr)
+      {
+         DBCommit(hdb);
+         DBFreeStatement(hStmt);
+         if (savedToDatabase > 0)
+         {
+            s_offlineDataMigrationPending = true;
+            nxlog_debug_tag(DEBUG_TAG, 3, _T("Offline data log writer: %u records cannot be written to offline data log and were saved to local database"), savedToDatabase);
+         }
+      }
+      if (lost > 0)
+      {
+         InterlockedAdd64(&s_offlineDataLostRecords, lost);
+         nxlog_write_tag(NXLOG_WARNING, DEBUG_TAG, _T("%u offline data records lost (cannot write to offline data log or local database)"), lost);
+      }
+
+      if (e == INVALID_POINTER_VALUE)
+         break;
+   }
+
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Offline data log writer thread stopped"));
+}
+
 /**
  * List of all data collection items
  */
@@ -967,6 +1168,154 @@ static inline uint32_t NextDelayValue(uint32_t curr)
    return curr + rand() % (curr / 2) + (curr / 2);
 }
 
+/**
+ * Send block of DCI values to server in bulk reconciliation mode. Returns true if server accepted the block,
+ * in that case status array contains delivery status for each element.
+ */
+static bool SendBulkReconciliationBlock(CommSession *session, const ObjectArray<DataElement>& elements, BYTE *status, uint32_t *sendDelay)
+{
+   nxlog_debug_tag(DEBUG_TAG, 6, _T("ReconciliationThread: %d records to be sent in bulk mode"), elements.size());
+
+   NXCPMessage msg(CMD_DCI_DATA, session->generateRequestId(), session->getProtocolVersion());
+   msg.setField(VID_BULK_RECONCILIATION, true);
+   msg.setField(VID_NUM_ELEMENTS, static_cast<int16_t>(elements.size()));
+   msg.setField(VID_TIMEOUT, g_dcReconciliationTimeout);
+
+   uint32_t fieldId = VID_ELEMENT_LIST_BASE;
+   for(int i = 0; i < elements.size(); i++)
+   {
+      elements.get(i)->fillReconciliationMessage(&msg, fieldId);
+      fieldId += 10;
+   }
+
+   if (!session->sendMessage(&msg))
+   {
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: communication error"));
+      *sendDelay = NextDelayValue(*sendDelay);
+      return false;
+   }
+
+   uint32_t rcc;
+   do
+   {
+      NXCPMessage *response = session->waitForMessage(CMD_REQUEST_COMPLETED, msg.getId(), g_dcReconciliationTimeout);
+      if (response != nullptr)
+      {
+         rcc = response->getFieldAsUInt32(VID_RCC);
+         if (rcc == ERR_SUCCESS)
+         {
+            memset(status, 0, MAX_BULK_DATA_BLOCK_SIZE);
+            response->getFieldAsBinary(VID_STATUS, status, MAX_BULK_DATA_BLOCK_SIZE);
+         }
+         else if (rcc == ERR_PROCESSING)
+         {
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: server is processing data (%d%% completed)"), response->getFieldAsInt32(VID_PROGRESS));
+         }
+         else if (rcc == ERR_RESOURCE_BUSY)
+         {
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: server is busy"));
+         }
+         else
+         {
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: bulk send failed (%u)"), rcc);
+         }
+         delete response;
+      }
+      else
+      {
+         nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: timeout on bulk send"));
+         rcc = ERR_REQUEST_TIMEOUT;
+      }
+   } while(rcc == ERR_PROCESSING);
+
+   *sendDelay = (rcc == ERR_SUCCESS) ? 0 : NextDelayValue(*sendDelay);
+   return rcc == ERR_SUCCESS;
+}
+
+/**
+ * Send next block of offline data from offline data queue. Records are acknowledged in queue order, so delivery stops
+ * at first record that cannot be delivered. Returns number of records read from queue.
+ */
+static int ReconcileFromOfflineLog(const shared_ptr<CommSession>& session, uint32_t *sendDelay)
+{
+   OfflineDataQueue *queue = GetOfflineDataQueue(session->getServerId());
+   if (queue == nullptr)
+      return 0;
+
+   ObjectArray<OfflineQueueRecord> records(g_dcReconciliationBlockSize, 64, Ownership::True);
+   queue->read(g_dcReconciliationBlockSize, &records);
+   int count = records.size();
+   if (count == 0)
+   {
+      // Queue is empty but sync status indicates pending data (can happen if damaged records were skipped)
+      s_serverSyncStatusLock.lock();
+      ServerSyncStatus *status = s_serverSyncStatus.get(session->getServerId());
+      if ((status != nullptr) && (s_databaseWriterQueue.size() == 0) && (queue->getPendingRecords() == 0) && !s_offlineDataMigrationPending)
+         status->queueSize = 0;
+      s_serverSyncStatusLock.unlock();
+      return 0;
+   }
+
+   ObjectArray<DataElement> elements(count, 16, Ownership::True);
+   for(int i = 0; i < count; i++)
+   {
+      OfflineQueueRecord *r = records.get(i);
+      elements.add(new DataElement(session->getServerId(), r->data, r->size));
+   }
+
+   int delivered = 0;
+   bool failed = false;
+   while((delivered < count) && !failed)
+   {
+      DataElement *e = elements.get(delivered);
+      if ((e->getType() == DCO_TYPE_ITEM) && session->isBulkReconciliationSupported())
+      {
+         ObjectArray<DataElement> block(count - delivered, 16, Ownership::False);
+         for(int i = delivered; (i < count) && (elements.get(i)->getType() == DCO_TYPE_ITEM); i++)
+            block.add(elements.get(i));
+
+         BYTE status[MAX_BULK_DATA_BLOCK_SIZE];
+         if (SendBulkReconciliationBlock(session.get(), block, status, sendDelay))
+         {
+            int i = 0;
+            while((i < block.size()) && (status[i] != BULK_DATA_REC_RETRY))
+               i++;
+            delivered += i;
+            failed = (i < block.size());
+         }
+         else
+         {
+            failed = true;
+         }
+      }
+      else if (e->sendToServer(true))
+      {
+         delivered++;
+      }
+      else
+      {
+         failed = true;
+         *sendDelay = NextDelayValue(*sendDelay);
+      }
+   }
+
+   if (delivered > 0)
+   {
+      queue->acknowledge(records.get(delivered - 1)->next, delivered);
+
+      s_serverSyncStatusLock.lock();
+      ServerSyncStatus *status = s_serverSyncStatus.get(session->getServerId());
+      if (status != nullptr)
+      {
+         status->queueSize -= delivered;
+         status->lastSync = time(nullptr);
+      }
+      s_serverSyncStatusLock.unlock();
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: %d records sent from offline data log"), delivered);
+   }
+   return count;
+}
+
 /**
  * Data reconciliation thread
  */
@@ -980,6 +1329,14 @@ static void ReconciliationThread()
    bool vacuumNeeded = false;
    while(!AgentSleepAndCheckForShutdown(sleepTime + sendDelay))
    {
+      // Move records saved to local database because offline data log was not writable
+      if ((g_dwFlags & AF_OFFLINE_DATA_LOG) && s_offlineDataMigrationPending)
+      {
+         s_offlineDataMigrationPending = false;
+         if (!MigrateOfflineDataToLog(hdb))
+            s_offlineDataMigrationPending = true;
+      }
+
       // Check if there is something to sync
       s_serverSyncStatusLock.lock();
       shared_ptr<CommSession> session = static_pointer_cast<CommSession>(FindServerSession(SessionComparator_Reconciliation, nullptr));
@@ -1014,6 +1371,13 @@ static void ReconciliationThread()
          continue;
       }
 
+      if (g_dwFlags & AF_OFFLINE_DATA_LOG)
+      {
+         int count = ReconcileFromOfflineLog(session, &sendDelay);
+         sleepTime = (count > 0) ? 50 : 30000;
+         continue;
+      }
+
       TCHAR query[1024];
       _sntprintf(query, 1024, _T("SELECT server_id,dci_id,dci_type,dci_origin,status_code,snmp_target_guid,timestamp,value FROM dc_queue INDEXED BY idx_dc_queue_timestamp WHERE server_id=") UINT64_FMT _T(" ORDER BY timestamp LIMIT %d"), session->getServerId(), g_dcReconciliationBlockSize);
 
@@ -1067,82 +1431,30 @@ static void ReconciliationThread()
 
          if (bulkSendList.size() > 0)
          {
-            nxlog_debug_tag(DEBUG_TAG, 6, _T("ReconciliationThread: %d records to be sent in bulk mode"), bulkSendList.size());
-
-            NXCPMessage msg(CMD_DCI_DATA, session->generateRequestId(), session->getProtocolVersion());
-            msg.setField(VID_BULK_RECONCILIATION, true);
-            msg.setField(VID_NUM_ELEMENTS, static_cast<int16_t>(bulkSendList.size()));
-            msg.setField(VID_TIMEOUT, g_dcReconciliationTimeout);
-
-            uint32_t fieldId = VID_ELEMENT_LIST_BASE;
-            for(int i = 0; i < bulkSendList.size(); i++)
+            BYTE status[MAX_BULK_DATA_BLOCK_SIZE];
+            if (SendBulkReconciliationBlock(session.get(), bulkSendList, status, &sendDelay))
             {
-               bulkSendList.get(i)->fillReconciliationMessage(&msg, fieldId);
-               fieldId += 10;
-            }
+               s_serverSyncStatusLock.lock();
+               ServerSyncStatus *serverSyncStatus = s_serverSyncStatus.get(session->getServerId());
 
-            if (session->sendMessage(&msg))
-            {
-               uint32_t rcc;
-               do
+               // Check status for each data element
+               bulkSendList.setOwner(Ownership::False);
+               for(int i = 0; i < bulkSendList.size(); i++)
                {
-                  NXCPMessage *response = session->waitForMessage(CMD_REQUEST_COMPLETED, msg.getId(), g_dcReconciliationTimeout);
-                  if (response != nullptr)
+                  DataElement *e = bulkSendList.get(i);
+                  if (status[i] != BULK_DATA_REC_RETRY)
                   {
-                     rcc = response->getFieldAsUInt32(VID_RCC);
-                     if (rcc == ERR_SUCCESS)
-                     {
-                        s_serverSyncStatusLock.lock();
-                        ServerSyncStatus *serverSyncStatus = s_serverSyncStatus.get(session->getServerId());
-
-                        // Check status for each data element
-                        BYTE status[MAX_BULK_DATA_BLOCK_SIZE];
-                        memset(status, 0, MAX_BULK_DATA_BLOCK_SIZE);
-                        response->getFieldAsBinary(VID_STATUS, status, MAX_BULK_DATA_BLOCK_SIZE);
-                        bulkSendList.setOwner(Ownership::False);
-                        for(int i = 0; i < bulkSendList.size(); i++)
-                        {
-                           DataElement *e = bulkSendList.get(i);
-                           if (status[i] != BULK_DATA_REC_RETRY)
-                           {
-                              deleteList.add(e);
-                              serverSyncStatus->queueSize--;
-                           }
-                           else
-                           {
-                              delete e;
-                           }
-                        }
-                        serverSyncStatus->lastSync = time(nullptr);
-
-                        s_serverSyncStatusLock.unlock();
-                     }
-                     else if (rcc == ERR_PROCESSING)
-                     {
-                        nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: server is processing data (%d%% completed)"), response->getFieldAsInt32(VID_PROGRESS));
-                     }
-                     else if (rcc == ERR_RESOURCE_BUSY)
-                     {
-                        nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: server is busy"));
-                     }
-                     else
-                     {
-                        nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: bulk send failed (%u)"), rcc);
-                     }
-                     delete response;
+                     deleteList.add(e);
+                     serverSyncStatus->queueSize--;
                   }
                   else
                   {
-                     nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: timeout on bulk send"));
-                     rcc = ERR_REQUEST_TIMEOUT;
+                     delete e;
                   }
-               } while(rcc == ERR_PROCESSING);
-               sendDelay = (rcc == ERR_SUCCESS) ? 0 : NextDelayValue(sendDelay);
-            }
-            else
-            {
-               nxlog_debug_tag(DEBUG_TAG, 4, _T("ReconciliationThread: communication error"));
-               sendDelay = NextDelayValue(sendDelay);
+               }
+               serverSyncStatus->lastSync = time(nullptr);
+
+               s_serverSyncStatusLock.unlock();
             }
          }
 
@@ -1561,6 +1873,126 @@ void ConfigureDataCollection(uint64_t serverId, const NXCPMessage& request)
    nxlog_debug_tag(DEBUG_TAG, 4, _T("Data collection for server ") UINT64X_FMT(_T("016")) _T(" reconfigured"), serverId);
 }
 
+/**
+ * Move offline data stored in local database into offline data log. Returns true if all records were moved.
+ */
+static bool MigrateOfflineDataToLog(DB_HANDLE hdb)
+{
+   TCHAR query[256];
+   _sntprintf(query, 256, _T("SELECT server_id,dci_id,dci_type,dci_origin,status_code,snmp_target_guid,timestamp,value FROM dc_queue ORDER BY timestamp LIMIT %u"), g_dcWriterMaxTransactionSize);
+
+   ByteStream record(1024);
+   int total = 0;
+   bool success = false;
+   while(true)
+   {
+      DB_RESULT hResult = DBSelect(hdb, query);
+      if (hResult == nullptr)
+         break;
+
+      int count = DBGetNumRows(hResult);
+      if (count == 0)
+      {
+         DBFreeResult(hResult);
+         success = true;
+         break;
+      }
+
+      DB_STATEMENT hStmt = DBPrepare(hdb, _T("DELETE FROM dc_queue WHERE server_id=? AND dci_id=? AND timestamp=?"), true);
+      if (hStmt == nullptr)
+      {
+         DBFreeResult(hResult);
+         break;
+      }
+
+      // Record is deleted from database only after it was successfully written to offline data log
+      bool failure = false;
+      int migrated = 0;
+      DBBegin(hdb);
+      for(int i = 0; i < count; i++)
+      {
+         DataElement e(hResult, i);
+         OfflineDataQueue *queue = GetOfflineDataQueue(e.getServerId());
+         if (queue == nullptr)
+         {
+            nxlog_debug_tag(DEBUG_TAG, 2, _T("Cannot open offline data log for server ") UINT64X_FMT(_T("016")) _T(", migration stopped"), e.getServerId());
+            failure = true;
+            break;
+         }
+
+         record.clear();
+         e.serialize(&record);
+         if (!queue->append(record.buffer(), record.size()))
+         {
+            nxlog_debug_tag(DEBUG_TAG, 2, _T("Cannot write record to offline data log for server ") UINT64X_FMT(_T("016")) _T(", migration stopped"), e.getServerId());
+            failure = true;
+            break;
+         }
+
+         DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, e.getServerId());
+         DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, e.getDciId());
+         DBBind(hStmt, 3, DB_SQLTYPE_BIGINT, static_cast<int64_t>(e.getTimestamp()));
+         DBExecute(hStmt);
+         migrated++;
+      }
+      DBCommit(hdb);
+      DBFreeStatement(hStmt);
+      DBFreeResult(hResult);
+      total += migrated;
+      if (failure)
+         break;
+   }
+
+   if (total > 0)
+   {
+      s_offlineQueuesLock.lock();
+      for(OfflineDataQueue *queue : s_offlineQueues)
+         queue->flush();
+      s_offlineQueuesLock.unlock();
+      DBQuery(hdb, _T("VACUUM"));
+      nxlog_debug_tag(DEBUG_TAG, 2, _T("%d offline data records moved from local database to offline data log"), total);
+   }
+   return success;
+}
+
+/**
+ * Load state of offline data log
+ */
+static void LoadOfflineLogState()
+{
+   TCHAR path[MAX_PATH];
+   _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR _T("dcqueue"), g_szDataDirectory);
+   _TDIR *dir = _topendir(path);
+   if (dir == nullptr)
+      return;
+
+   struct _tdirent *d;
+   while((d = _treaddir(dir)) != nullptr)
+   {
+      TCHAR *eptr;
+      uint64_t serverId = _tcstoull(d->d_name, &eptr, 16);
+      if ((eptr - d->d_name != 16) || (*eptr != 0))
+         continue;
+
+      OfflineDataQueue *queue = GetOfflineDataQueue(serverId);
+      if ((queue == nullptr) || (queue->getPendingRecords() == 0))
+         continue;
+
+      ServerSyncStatus *s = new ServerSyncStatus(serverId);
+      s->queueSize = queue->getPendingRecords();
+
+      // Use timestamp of oldest record as last sync time, same as for records in local database
+      ObjectArray<OfflineQueueRecord> records(1, 1, Ownership::True);
+      queue->read(1, &records);
+      if (!records.isEmpty())
+         s->lastSync = DataElement(serverId, records.get(0)->data, records.get(0)->size).getTimestamp();
+
+      s_serverSyncStatus.set(serverId, s);
+      nxlog_debug_tag(DEBUG_TAG, 2, _T("%d elements in offline data log for server ID ") UINT64X_FMT(_T("016")), s->queueSize, serverId);
+   }
+   _tclosedir(dir);
+}
+
 /**
  * Load saved state of local data collection
  */
@@ -1590,6 +2022,19 @@ static void LoadState()
       DBFreeResult(hResult);
    }
 
+   if (g_dwFlags & AF_OFFLINE_DATA_LOG)
+   {
+      s_offlineDataMigrationPending = !MigrateOfflineDataToLog(hdb);
+      LoadOfflineLogState();
+      if (!s_offlineDataMigrationPending)
+      {
+         LoadProxyConfiguration();
+         return;
+      }
+      // Records remaining in local database will be moved to offline data log by reconciliation thread,
+      // count them in addition to records already in offline data log
+   }
+
    hResult = DBSelect(hdb, _T("SELECT server_id,count(*),coalesce(min(timestamp),0) FROM dc_queue GROUP BY server_id"));
    if (hResult != nullptr)
    {
@@ -1597,10 +2042,19 @@ static void LoadState()
       for(int i = 0; i < count; i++)
       {
          uint64_t serverId = DBGetFieldUInt64(hResult, i, 0);
-         ServerSyncStatus *s = new ServerSyncStatus(serverId);
-         s->queueSize = DBGetFieldLong(hResult, i, 1);
-         s->lastSync = static_cast<time_t>(DBGetFieldInt64(hResult, i, 2));
-         s_serverSyncStatus.set(serverId, s);
+         time_t oldestTimestamp = static_cast<time_t>(DBGetFieldInt64(hResult, i, 2));
+         ServerSyncStatus *s = s_serverSyncStatus.get(serverId);
+         if (s == nullptr)
+         {
+            s = new ServerSyncStatus(serverId);
+            s->lastSync = oldestTimestamp;
+            s_serverSyncStatus.set(serverId, s);
+         }
+         else if (oldestTimestamp < s->lastSync)
+         {
+            s->lastSync = oldestTimestamp;
+         }
+         s->queueSize += DBGetFieldLong(hResult, i, 1);
          nxlog_debug_tag(DEBUG_TAG, 2, _T("%d elements in queue for server ID ") UINT64X_FMT(_T("016")), s->queueSize, serverId);
 
          TCHAR ts[64];
@@ -1659,6 +2113,13 @@ static void ClearStalledOfflineData()
          }
          s_itemLock.unlock();
 
+         if (g_dwFlags & AF_OFFLINE_DATA_LOG)
+         {
+            OfflineDataQueue *queue = GetOfflineDataQueue(serverId);
+            if (queue != nullptr)
+               queue->destroy();
+         }
+
          DBBegin(hdb);
 
          _sntprintf(query, 256, _T("DELETE FROM dc_queue WHERE server_id=") UINT64_FMT, serverId);
@@ -1727,7 +2188,7 @@ void StartLocalDataCollector()
    g_dataCollectorPool = ThreadPoolCreate(_T("DATACOLL"), g_dcMinCollectorPoolSize, g_dcMaxCollectorPoolSize);
    s_dataCollectionSchedulerThread = ThreadCreateEx(DataCollectionScheduler);
    s_dataSenderThread = ThreadCreateEx(DataSender);
-   s_databaseWriterThread = ThreadCreateEx(DatabaseWriter);
+   s_databaseWriterThread = ThreadCreateEx((g_dwFlags & AF_OFFLINE_DATA_LOG) ? OfflineLogWriter : DatabaseWriter);
    s_reconciliationThread = ThreadCreateEx(ReconciliationThread);
    s_proxyListennerThread = ThreadCreateEx(ProxyListenerThread);
    ThreadPoolScheduleRelative(g_dataCollectorPool, STALLED_DATA_CHECK_INTERVAL, ClearStalledOfflineData);
@@ -1768,6 +2229,10 @@ void ShutdownLocalDataCollector()
 
    nxlog_debug_tag(DEBUG_TAG, 5, _T("Waiting for proxy heartbeat listening thread"));
    ThreadJoin(s_proxyListennerThread);
+
+   s_offlineQueuesLock.lock();
+   s_offlineQueues.clear();
+   s_offlineQueuesLock.unlock();
 }
 
 /**
@@ -1785,6 +2250,11 @@ void ClearDataCollectionConfiguration()
    s_items.clear();
    s_itemLock.unlock();
 
+   s_offlineQueuesLock.lock();
+   for(OfflineDataQueue *queue : s_offlineQueues)
+      queue->destroy();
+   s_offlineQueuesLock.unlock();
+
    s_serverSyncStatusLock.lock();
    s_serverSyncStatus.clear();
    s_serverSyncStatusLock.unlock();
@@ -1809,3 +2279,14 @@ LONG H_DataCollectorQueueSize(const TCHAR *cmd, const TCHAR *arg, TCHAR *value,
    return SYSINFO_RC_SUCCESS;
 }
 
+/**
+ * Handler for number of data collection records lost because they cannot be stored locally
+ */
+LONG H_DataCollectorLostRecords(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
+{
+   if (!s_dataCollectorStarted)
+      return SYSINFO_RC_UNSUPPORTED;
+
+   ret_uint64(value, static_cast<uint64_t>(s_offlineDataLostRecords));
+   return SYSINFO_RC_SUCCESS;
+}
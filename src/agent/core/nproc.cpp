@@ -26,12 +26,18 @@
 #define ONE_DAY (60 * 60 * 24)
 #define SYNC_DATA_SIZE        1000
 #define SYNC_DATA_SIZE_TEXT   _T("1000")
+#define NOTIFICATION_BATCH_SIZE  256
 
 /**
  * Offline data expiration time (in days)
  */
 extern uint32_t g_dcOfflineExpirationTime;
 
+/**
+ * Externals
+ */
+bool SendSyslogRecords(CommSession *session, const NXCPMessage *msg);
+
 /**
  * Notification processor queue
  */
@@ -91,76 +97,117 @@ static void ExtSubagentLoaderNotificationProcessor()
 }
 
 /**
- * Process notifications - master agent
+ * Send notification message to server session
+ */
+static inline bool SendNotification(CommSession *session, const NXCPMessage *msg)
+{
+   return (msg->getCode() == CMD_SYSLOG_RECORDS) ? SendSyslogRecords(session, msg) : session->sendMessage(msg);
+}
+
+/**
+ * Save notification messages starting at given index to local database for later delivery to given server.
+ * Serialized messages are cached in encodedMessages so they are encoded only once for all servers.
+ */
+static void SaveNotifications(ServerRegistration *server, const ObjectArray<NXCPMessage>& batch, int startIndex, char **encodedMessages)
+{
+   DB_HANDLE hdb = GetLocalDatabaseHandle();
+   if (hdb == nullptr)
+      return;
+
+   DB_STATEMENT hStmt = DBPrepare(hdb, _T("INSERT INTO notification_data (server_id,id,serialized_data) VALUES (?,?,?)"), true);
+   if (hStmt == nullptr)
+      return;
+
+   bool transaction = DBBegin(hdb);
+   DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, server->serverId);
+   for(int i = startIndex; i < batch.size(); i++)
+   {
+      if (encodedMessages[i] == nullptr)
+      {
+         NXCP_MESSAGE *rawMessage = batch.get(i)->serialize(true);
+         base64_encode_alloc(reinterpret_cast<char*>(rawMessage), ntohl(rawMessage->size), &encodedMessages[i]);
+         MemFree(rawMessage);
+      }
+      DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, server->recordId++);
+      DBBind(hStmt, 3, DB_SQLTYPE_TEXT, DB_CTYPE_UTF8_STRING, encodedMessages[i], DB_BIND_STATIC);
+      DBExecute(hStmt);
+   }
+   if (transaction)
+      DBCommit(hdb);
+   DBFreeStatement(hStmt);
+
+   server->status = SyncStatus::SYNCHRONIZING;
+   nxlog_debug_tag(DEBUG_TAG, 6, _T("NotificationSender: %d notification messages saved to database"), batch.size() - startIndex);
+}
+
+/**
+ * Process notifications - master agent. All messages already waiting in queue are processed as single batch.
  */
 static void MasterNotificationProcessor()
 {
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Notification processor started"));
-   while(true)
+   ObjectArray<NXCPMessage> batch(NOTIFICATION_BATCH_SIZE, NOTIFICATION_BATCH_SIZE, Ownership::True);
+   SharedHashMap<uint64_t, CommSession> sessions;
+   char *encodedMessages[NOTIFICATION_BATCH_SIZE];
+   bool stop = false;
+   while(!stop)
    {
       NXCPMessage *msg = g_notificationProcessorQueue.getOrBlock();
       if (msg == INVALID_POINTER_VALUE)
          break;
 
-      nxlog_debug_tag(DEBUG_TAG, 6, _T("NotificationProcessor: new message received"));
+      batch.add(msg);
+      while(batch.size() < NOTIFICATION_BATCH_SIZE)
+      {
+         msg = g_notificationProcessorQueue.get();
+         if (msg == nullptr)
+            break;
+         if (msg == INVALID_POINTER_VALUE)
+         {
+            stop = true;   // Shutdown indicator received, process already collected messages and exit
+            break;
+         }
+         batch.add(msg);
+      }
+
+      nxlog_debug_tag(DEBUG_TAG, 6, _T("NotificationProcessor: processing %d new messages"), batch.size());
+
+      // Build server to session lookup table
+      g_sessionLock.lock();
+      for(int i = 0; i < g_sessions.size(); i++)
+      {
+         CommSession *session = g_sessions.get(i);
+         if (session->canAcceptTraps() && !sessions.contains(session->getServerId()))
+            sessions.set(session->getServerId(), g_sessions.getShared(i));
+      }
+      g_sessionLock.unlock();
 
-      DB_STATEMENT hStmt = nullptr;
+      memset(encodedMessages, 0, sizeof(char*) * batch.size());
 
       s_serverSyncStatusLock.lock();
       nxlog_debug_tag(DEBUG_TAG, 8, _T("NotificationProcessor: Server count: %d"), s_serverSyncStatus.size());
       for(int i = 0; i < s_serverSyncStatus.size(); i++)
       {
-         bool sent = false;
          ServerRegistration *server = s_serverSyncStatus.get(i);
-         if (server->status == SyncStatus::ONLINE)
-         {
-            g_sessionLock.lock();
-            for(int j = 0; j < g_sessions.size(); j++)
-            {
-               CommSession *session = g_sessions.get(j);
-               if ((session->getServerId() == server->serverId) && session->canAcceptTraps())
-               {
-                  sent = session->sendMessage(msg);
-                  break;
-               }
-            }
-            g_sessionLock.unlock();
-         }
+         CommSession *session = (server->status == SyncStatus::ONLINE) ? sessions.get(server->serverId) : nullptr;
 
-         if (!sent)
+         int sent = 0;
+         if (session != nullptr)
          {
-            DB_HANDLE hdb = GetLocalDatabaseHandle();
-            if (hdb != nullptr)
-            {
-               if (hStmt == nullptr)
-               {
-                  hStmt = DBPrepare(hdb, _T("INSERT INTO notification_data (server_id,id,serialized_data) VALUES (?,?,?)"), true);
-               }
-               if (hStmt != nullptr)
-               {
-                  NXCP_MESSAGE *rawMessage = msg->serialize(true);
-                  char *base64Encoded = nullptr;
-                  base64_encode_alloc(reinterpret_cast<char*>(rawMessage), ntohl(rawMessage->size), &base64Encoded);
-                  MemFree(rawMessage);
-
-                  DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, server->serverId);
-                  DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, server->recordId++);
-                  DBBind(hStmt, 3, DB_SQLTYPE_TEXT, DB_CTYPE_UTF8_STRING, base64Encoded, DB_BIND_DYNAMIC);
-                  DBExecute(hStmt);
-                  server->status = SyncStatus::SYNCHRONIZING;
-                  nxlog_debug_tag(DEBUG_TAG, 6, _T("NotificationSender: Notification message saved to database"));
-               }
-            }
-         }
-         else
-         {
-            nxlog_debug_tag(DEBUG_TAG, 8, _T("NotificationSender: Notification message successfully forwarded to server"));
+            while((sent < batch.size()) && SendNotification(session, batch.get(sent)))
+               sent++;
+            nxlog_debug_tag(DEBUG_TAG, 8, _T("NotificationSender: %d notification messages successfully forwarded to server ") UINT64X_FMT(_T("016")), sent, server->serverId);
          }
+
+         if (sent < batch.size())
+            SaveNotifications(server, batch, sent, encodedMessages);
       }
       s_serverSyncStatusLock.unlock();
-      DBFreeStatement(hStmt);
 
-      delete msg;
+      for(int i = 0; i < batch.size(); i++)
+         MemFree(encodedMessages[i]);
+      sessions.clear();
+      batch.clear();
    }
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Notification processor stopped"));
 }
@@ -204,7 +251,7 @@ static void NotificationSync(const shared_ptr<CommSession>& session)
             continue;
          }
 
-         success = session->sendMessage(msg);
+         success = SendNotification(session.get(), msg);
          delete msg;
 
          if (!success)
@@ -238,6 +238,7 @@ uint32_t g_dcWriterMaxTransactionSize = 10000;
 uint32_t g_dcMinCollectorPoolSize = 4;
 uint32_t g_dcMaxCollectorPoolSize = 64;
 uint32_t g_dcOfflineExpirationTime = 10; // 10 days
+uint64_t g_dcOfflineLogSegmentSize = 16 * 1024 * 1024;
 int32_t g_zoneUIN = 0;
 uint32_t g_tunnelKeepaliveInterval = 30;
 uint16_t g_syslogListenPort = 514;
@@ -372,6 +373,8 @@ static NX_CFG_TEMPLATE m_cfgTemplate[] =
    { _T("MaxLogSize"), CT_SIZE_BYTES, 0, 0, 0, 0, &s_maxLogSize, nullptr },
    { _T("MaxSessions"), CT_LONG, 0, 0, 0, 0, &g_maxCommSessions, nullptr },
    { _T("OfflineDataExpirationTime"), CT_LONG, 0, 0, 0, 0, &g_dcOfflineExpirationTime, nullptr },
+   { _T("OfflineDataLog"), CT_BOOLEAN_FLAG_32, 0, 0, AF_OFFLINE_DATA_LOG, 0, &g_dwFlags, nullptr },
+   { _T("OfflineDataLogSegmentSize"), CT_SIZE_BYTES, 0, 0, 0, 0, &g_dcOfflineLogSegmentSize, nullptr },
    { _T("PlatformSuffix"), CT_STRING, 0, 0, MAX_PSUFFIX_LENGTH, 0, g_szPlatformSuffix, nullptr },
    { _T("RequireAuthentication"), CT_BOOLEAN_FLAG_32, 0, 0, AF_REQUIRE_AUTH, 0, &g_dwFlags, nullptr },
    { _T("RequireEncryption"), CT_BOOLEAN_FLAG_32, 0, 0, AF_REQUIRE_ENCRYPTION, 0, &g_dwFlags, nullptr },
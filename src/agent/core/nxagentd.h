@@ -100,6 +100,7 @@
 #define AF_CHECK_SERVER_CERTIFICATE 0x00080000
 #define AF_ENABLE_WEBSVC_PROXY      0x00100000
 #define AF_ENABLE_TFTP_PROXY        0x00200000
+#define AF_OFFLINE_DATA_LOG         0x00400000
 
 // Flags for component failures
 #define FAIL_OPEN_LOG               0x00000001
@@ -326,7 +327,9 @@ class CommSession : public AbstractCommSession
    bool m_acceptFileUpdates;
    bool m_ipv6Aware;
    bool m_bulkReconciliationSupported;
+   bool m_syslogBatchingSupported;  // server accepts multiple syslog records in single message
    bool m_allowCompression;   // allow compression for structured messages
+   NXCPStreamCompressionMethod m_messageCompressionMethod;  // compression method for structured messages negotiated with server
    bool m_acceptKeepalive;    // true if server will respond to keepalive messages
    HashMap<uint32_t, DownloadFileInfo> m_downloadFileMap;
 	shared_ptr<NXCPEncryptionContext> m_encryptionContext;
@@ -398,6 +401,7 @@ class CommSession : public AbstractCommSession
    virtual bool canAcceptFileUpdates() override { return m_acceptFileUpdates; }
    virtual bool isBulkReconciliationSupported() override { return m_bulkReconciliationSupported; }
    virtual bool isIPv6Aware() override { return m_ipv6Aware; }
+   bool isSyslogBatchingSupported() const { return m_syslogBatchingSupported; }
 
    virtual const TCHAR *getDebugTag() const override { return m_debugTag; }
 
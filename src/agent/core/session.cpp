@@ -115,8 +115,10 @@ CommSession::CommSession(const shared_ptr<AbstractCommChannel>& channel, const I
    m_acceptFileUpdates = false;
    m_ipv6Aware = false;
    m_bulkReconciliationSupported = false;
+   m_syslogBatchingSupported = false;
    m_disconnected = false;
    m_allowCompression = false;
+   m_messageCompressionMethod = NXCP_STREAM_COMPRESSION_DEFLATE;
    m_acceptKeepalive = false;
    m_ts = time(nullptr);
    m_responseQueue = new MsgWaitQueue();
@@ -516,7 +518,7 @@ bool CommSession::sendMessage(const NXCPMessage *msg)
    if (m_disconnected)
       return false;
 
-   return sendRawMessage(msg->serialize(m_allowCompression), m_encryptionContext.get());
+   return sendRawMessage(msg->serialize(m_allowCompression ? m_messageCompressionMethod : NXCP_STREAM_COMPRESSION_NONE), m_encryptionContext.get());
 }
 
 /**
@@ -534,7 +536,7 @@ void CommSession::postMessage(const NXCPMessage *msg)
 {
    if (m_disconnected)
       return;
-   ThreadPoolExecuteSerialized(g_commThreadPool, m_key, self(), &CommSession::sendMessageInBackground, msg->serialize(m_allowCompression));
+   ThreadPoolExecuteSerialized(g_commThreadPool, m_key, self(), &CommSession::sendMessageInBackground, msg->serialize(m_allowCompression ? m_messageCompressionMethod : NXCP_STREAM_COMPRESSION_NONE));
 }
 
 /**
@@ -707,14 +709,19 @@ void CommSession::processingThread()
                // Servers before 2.0 use VID_ENABLED
                m_ipv6Aware = request->isFieldExist(VID_IPV6_SUPPORT) ? request->getFieldAsBoolean(VID_IPV6_SUPPORT) : request->getFieldAsBoolean(VID_ENABLED);
                m_bulkReconciliationSupported = request->getFieldAsBoolean(VID_BULK_RECONCILIATION);
+               m_syslogBatchingSupported = request->getFieldAsBoolean(VID_SYSLOG_BATCHING);
                m_allowCompression = request->getFieldAsBoolean(VID_ENABLE_COMPRESSION);
+               // Servers before 4.3 will not send preferred compression method and can only use deflate
+               m_messageCompressionMethod = (request->getFieldAsUInt16(VID_COMPRESSION_METHOD) == NXCP_STREAM_COMPRESSION_LZ4) ? NXCP_STREAM_COMPRESSION_LZ4 : NXCP_STREAM_COMPRESSION_DEFLATE;
                m_acceptKeepalive = request->getFieldAsBoolean(VID_ACCEPT_KEEPALIVE);
                response.setField(VID_RCC, ERR_SUCCESS);
                response.setField(VID_FLAGS, static_cast<uint16_t>((m_controlServer ? 0x01 : 0x00) | (m_masterServer ? 0x02 : 0x00)));
-               debugPrintf(4, _T("Server capabilities: IPv6: %s; bulk reconciliation: %s; compression: %s"),
+               response.setField(VID_COMPRESSION_METHOD, static_cast<uint16_t>(m_messageCompressionMethod));
+               debugPrintf(4, _T("Server capabilities: IPv6: %s; bulk reconciliation: %s; syslog batching: %s; compression: %s"),
                            m_ipv6Aware ? _T("yes") : _T("no"),
                            m_bulkReconciliationSupported ? _T("yes") : _T("no"),
-                           m_allowCompression ? _T("yes") : _T("no"));
+                           m_syslogBatchingSupported ? _T("yes") : _T("no"),
+                           m_allowCompression ? ((m_messageCompressionMethod == NXCP_STREAM_COMPRESSION_LZ4) ? _T("LZ4") : _T("deflate")) : _T("no"));
                break;
             case CMD_SET_SERVER_ID:
                m_serverId = request->getFieldAsUInt64(VID_SERVER_ID);
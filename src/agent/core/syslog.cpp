@@ -23,28 +23,34 @@
 #include "nxagentd.h"
 
 #define MAX_SYSLOG_MSG_LEN    1024
+#define SYSLOG_BATCH_SIZE     64
 
 /**
- * Syslog record
+ * Buffer for receiving batch of syslog datagrams
  */
-class SyslogRecord
+struct SyslogReceiveBuffer
 {
-public:
-   InetAddress addr;
-   time_t timestamp;
-   char *message;
-   INT32 messageLength;
+   char data[SYSLOG_BATCH_SIZE][MAX_SYSLOG_MSG_LEN + 1];
+   int length[SYSLOG_BATCH_SIZE];
+   SockAddrBuffer addr[SYSLOG_BATCH_SIZE];
+#if HAVE_RECVMMSG
+   struct mmsghdr headers[SYSLOG_BATCH_SIZE];
+   struct iovec iov[SYSLOG_BATCH_SIZE];
+#endif
 
-   SyslogRecord(const InetAddress& a, const char *m, int len)
-   {
-      addr = a;
-      timestamp = time(nullptr);
-      message = MemCopyStringA(m);
-      messageLength = len;
-   }
-   ~SyslogRecord()
+   SyslogReceiveBuffer()
    {
-      MemFree(message);
+#if HAVE_RECVMMSG
+      memset(headers, 0, sizeof(headers));
+      for(int i = 0; i < SYSLOG_BATCH_SIZE; i++)
+      {
+         iov[i].iov_base = data[i];
+         iov[i].iov_len = MAX_SYSLOG_MSG_LEN;
+         headers[i].msg_hdr.msg_name = &addr[i];
+         headers[i].msg_hdr.msg_iov = &iov[i];
+         headers[i].msg_hdr.msg_iovlen = 1;
+      }
+#endif
    }
 };
 
@@ -69,6 +75,117 @@ LONG H_SyslogStats(const TCHAR *cmd, const TCHAR *arg, TCHAR *value, AbstractCom
    return SYSINFO_RC_SUCCESS;
 }
 
+/**
+ * Read all datagrams already waiting on given socket (up to SYSLOG_BATCH_SIZE). Returns number of datagrams read or -1 on error.
+ */
+static int ReceiveSyslogBatch(SOCKET s, SyslogReceiveBuffer *buffer)
+{
+#if HAVE_RECVMMSG
+   for(int i = 0; i < SYSLOG_BATCH_SIZE; i++)
+      buffer->headers[i].msg_hdr.msg_namelen = sizeof(SockAddrBuffer);
+   int count = recvmmsg(s, buffer->headers, SYSLOG_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+   for(int i = 0; i < count; i++)
+      buffer->length[i] = static_cast<int>(buffer->headers[i].msg_len);
+   return count;
+#else
+   int count = 0;
+   SocketPoller sp;
+   do
+   {
+      socklen_t addrLen = sizeof(SockAddrBuffer);
+      int bytes = recvfrom(s, buffer->data[count], MAX_SYSLOG_MSG_LEN, 0, (struct sockaddr *)&buffer->addr[count], &addrLen);
+      if (bytes <= 0)
+         return (count > 0) ? count : -1;
+      buffer->length[count++] = bytes;
+      sp.reset();
+      sp.add(s);
+   } while((count < SYSLOG_BATCH_SIZE) && (sp.poll(0) > 0));
+   return count;
+#endif
+}
+
+/**
+ * Pack received syslog records into single message and pass it to notification processor. Single record
+ * is sent using old message format. Each record in multi-record message occupies 10 fields starting at
+ * VID_SYSLOG_MSG_BASE: record ID, source address, timestamp, message text, and message length.
+ */
+static void ForwardSyslogRecords(SyslogReceiveBuffer *buffer, int count, uint64_t *id)
+{
+   int validRecords = 0;
+   for(int i = 0; i < count; i++)
+   {
+      if (buffer->length[i] > 0)
+         validRecords++;
+   }
+   if (validRecords == 0)
+      return;
+
+   time_t now = time(nullptr);
+   NXCPMessage *msg = new NXCPMessage(CMD_SYSLOG_RECORDS, GenerateMessageId(), 4);   // Use version 4
+   msg->setField(VID_ZONE_UIN, g_zoneUIN);
+   if (validRecords > 1)
+      msg->setField(VID_NUM_RECORDS, validRecords);
+
+   uint32_t fieldId = VID_SYSLOG_MSG_BASE;
+   for(int i = 0; i < count; i++)
+   {
+      int length = buffer->length[i];
+      if (length <= 0)
+         continue;
+
+      buffer->data[i][length] = 0;
+      InetAddress addr = InetAddress::createFromSockaddr((struct sockaddr *)&buffer->addr[i]);
+      if (validRecords == 1)
+      {
+         msg->setField(VID_REQUEST_ID, (*id)++);
+         msg->setField(VID_IP_ADDRESS, addr);
+         msg->setFieldFromTime(VID_TIMESTAMP, now);
+         msg->setField(VID_MESSAGE, (BYTE *)buffer->data[i], length + 1);
+         msg->setField(VID_MESSAGE_LENGTH, length);
+      }
+      else
+      {
+         msg->setField(fieldId++, (*id)++);
+         msg->setField(fieldId++, addr);
+         msg->setFieldFromTime(fieldId++, now);
+         msg->setField(fieldId++, (BYTE *)buffer->data[i], length + 1);
+         msg->setField(fieldId++, length);
+         fieldId += 5;
+      }
+   }
+   g_notificationProcessorQueue.put(msg);
+   s_receivedMessages += validRecords;
+}
+
+/**
+ * Send syslog records message to server. Multi-record messages are split into single record messages
+ * for servers that do not support syslog record batching.
+ */
+bool SendSyslogRecords(CommSession *session, const NXCPMessage *msg)
+{
+   if (session->isSyslogBatchingSupported() || !msg->isFieldExist(VID_NUM_RECORDS))
+      return session->sendMessage(msg);
+
+   int32_t zoneUIN = msg->getFieldAsInt32(VID_ZONE_UIN);
+   int count = msg->getFieldAsInt32(VID_NUM_RECORDS);
+   uint32_t fieldId = VID_SYSLOG_MSG_BASE;
+   for(int i = 0; i < count; i++, fieldId += 10)
+   {
+      NXCPMessage record(CMD_SYSLOG_RECORDS, msg->getId(), msg->getProtocolVersion());
+      record.setField(VID_REQUEST_ID, msg->getFieldAsUInt64(fieldId));
+      record.setField(VID_IP_ADDRESS, msg->getFieldAsInetAddress(fieldId + 1));
+      record.setFieldFromTime(VID_TIMESTAMP, msg->getFieldAsTime(fieldId + 2));
+      size_t size;
+      const BYTE *text = msg->getBinaryFieldPtr(fieldId + 3, &size);
+      record.setField(VID_MESSAGE, text, size);
+      record.setField(VID_MESSAGE_LENGTH, msg->getFieldAsInt32(fieldId + 4));
+      record.setField(VID_ZONE_UIN, zoneUIN);
+      if (!session->sendMessage(&record))
+         return false;
+   }
+   return true;
+}
+
 /**
  * Syslog messages receiver thread
  */
@@ -198,6 +315,7 @@ void SyslogReceiver()
    nxlog_debug(1, _T("Syslog receiver thread started"));
 
    // Wait for packets
+   SyslogReceiveBuffer *receiveBuffer = new SyslogReceiveBuffer();
    SocketPoller sp;
    while(!(g_dwFlags & AF_SHUTDOWN))
    {
@@ -212,31 +330,27 @@ void SyslogReceiver()
       int rc = sp.poll(1000);
       if (rc > 0)
       {
-         char syslogMessage[MAX_SYSLOG_MSG_LEN + 1];
-         SockAddrBuffer addr;
-         socklen_t addrLen = sizeof(SockAddrBuffer);
+         // Drain each ready socket and forward everything received as single message
+         bool failure = false;
+         if ((hSocket != INVALID_SOCKET) && sp.isSet(hSocket))
+         {
+            int count = ReceiveSyslogBatch(hSocket, receiveBuffer);
+            if (count > 0)
+               ForwardSyslogRecords(receiveBuffer, count, &id);
+            else
+               failure = true;
+         }
 #ifdef WITH_IPV6
-         SOCKET s = sp.isSet(hSocket) ? hSocket : hSocket6;
-#else
-         SOCKET s = hSocket;
-#endif
-         int bytes = recvfrom(s, syslogMessage, MAX_SYSLOG_MSG_LEN, 0, (struct sockaddr *)&addr, &addrLen);
-         if (bytes > 0)
+         if ((hSocket6 != INVALID_SOCKET) && sp.isSet(hSocket6))
          {
-            syslogMessage[bytes] = 0;
-            SyslogRecord rec(InetAddress::createFromSockaddr((struct sockaddr *)&addr), syslogMessage, bytes);
-
-            NXCPMessage *msg = new NXCPMessage(CMD_SYSLOG_RECORDS, GenerateMessageId(), 4);   // Use version 4
-            msg->setField(VID_REQUEST_ID, id++);
-            msg->setField(VID_IP_ADDRESS, rec.addr);
-            msg->setFieldFromTime(VID_TIMESTAMP, rec.timestamp);
-            msg->setField(VID_MESSAGE, (BYTE *)rec.message, rec.messageLength + 1);
-            msg->setField(VID_MESSAGE_LENGTH, rec.messageLength);
-            msg->setField(VID_ZONE_UIN, g_zoneUIN);
-            g_notificationProcessorQueue.put(msg);
-            s_receivedMessages++;
+            int count = ReceiveSyslogBatch(hSocket6, receiveBuffer);
+            if (count > 0)
+               ForwardSyslogRecords(receiveBuffer, count, &id);
+            else
+               failure = true;
          }
-         else
+#endif
+         if (failure)
          {
             // Sleep on error
             ThreadSleepMs(100);
@@ -249,6 +363,7 @@ void SyslogReceiver()
       }
    }
 
+   delete receiveBuffer;
    if (hSocket != INVALID_SOCKET)
       closesocket(hSocket);
 #ifdef WITH_IPV6
@@ -0,0 +1,741 @@
+/*
+** NetXMS - Network Management System
+** Copyright (C) 2003-2023 Raden Solutions
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation; either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: dcqueue.cpp
+**
+**/
+
+#include "libnxagent.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#define DEBUG_TAG _T("dc.queue")
+
+/**
+ * Segment file header: magic (4 bytes), version (4 bytes), segment ID (8 bytes)
+ */
+#define SEGMENT_MAGIC         0x5144584E
+#define SEGMENT_VERSION       1
+#define SEGMENT_HEADER_SIZE   16
+
+/**
+ * Record header: payload size (4 bytes), payload CRC32 (4 bytes)
+ */
+#define RECORD_HEADER_SIZE    8
+
+/**
+ * Cursor file magic
+ */
+#define CURSOR_MAGIC          0x4344584E
+
+/**
+ * Cursor file content
+ */
+struct CursorFileData
+{
+   uint32_t magic;
+   uint32_t crc;
+   uint64_t segment;
+   uint32_t offset;
+   uint32_t reserved;
+};
+
+/**
+ * Memory-mapped segment file
+ */
+class OfflineQueueSegment
+{
+private:
+   uint64_t m_id;
+   size_t m_size;
+   BYTE *m_data;
+#ifdef _WIN32
+   HANDLE m_file;
+   HANDLE m_mapping;
+#else
+   int m_fd;
+#endif
+
+public:
+   OfflineQueueSegment(uint64_t id);
+   ~OfflineQueueSegment();
+
+   bool open(const TCHAR *path, size_t size, bool create);
+   void flush();
+
+   uint64_t getId() const { return m_id; }
+   size_t getSize() const { return m_size; }
+   BYTE *data() { return m_data; }
+};
+
+/**
+ * Segment constructor
+ */
+OfflineQueueSegment::OfflineQueueSegment(uint64_t id)
+{
+   m_id = id;
+   m_size = 0;
+   m_data = nullptr;
+#ifdef _WIN32
+   m_file = INVALID_HANDLE_VALUE;
+   m_mapping = nullptr;
+#else
+   m_fd = -1;
+#endif
+}
+
+/**
+ * Segment destructor
+ */
+OfflineQueueSegment::~OfflineQueueSegment()
+{
+#ifdef _WIN32
+   if (m_data != nullptr)
+      UnmapViewOfFile(m_data);
+   if (m_mapping != nullptr)
+      CloseHandle(m_mapping);
+   if (m_file != INVALID_HANDLE_VALUE)
+      CloseHandle(m_file);
+#else
+   if (m_data != nullptr)
+      munmap(m_data, m_size);
+   if (m_fd != -1)
+      ::close(m_fd);
+#endif
+}
+
+#ifndef _WIN32
+
+/**
+ * Allocate disk space for newly created file. Space is allocated upfront, so writes to memory mapped file can not
+ * fail with SIGBUS when file system runs out of space. Allocated area is filled with zeroes.
+ */
+static bool AllocateFileSpace(int fd, size_t size)
+{
+#if HAVE_POSIX_FALLOCATE
+   int rc = posix_fallocate(fd, 0, size);
+   if (rc == 0)
+      return true;
+   if ((rc != EINVAL) && (rc != EOPNOTSUPP))
+   {
+      errno = rc;
+      return false;
+   }
+   // File system does not support allocation, fall back to writing zeroes
+#endif
+
+   BYTE buffer[65536];
+   memset(buffer, 0, sizeof(buffer));
+   size_t offset = 0;
+   while(offset < size)
+   {
+      ssize_t bytes = write(fd, buffer, std::min(size - offset, sizeof(buffer)));
+      if (bytes <= 0)
+      {
+         if ((bytes < 0) && (errno == EINTR))
+            continue;
+         return false;
+      }
+      offset += bytes;
+   }
+   return true;
+}
+
+#endif
+
+/**
+ * Open and map segment file. If create is true, new file of given size is created, otherwise size is taken from existing file.
+ */
+bool OfflineQueueSegment::open(const TCHAR *path, size_t size, bool create)
+{
+#ifdef _WIN32
+   m_file = CreateFile(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (m_file == INVALID_HANDLE_VALUE)
+      return false;
+
+   if (!create)
+   {
+      LARGE_INTEGER fileSize;
+      if (!GetFileSizeEx(m_file, &fileSize))
+         return false;
+      size = static_cast<size_t>(fileSize.QuadPart);
+   }
+   if (size <= SEGMENT_HEADER_SIZE)
+      return false;
+
+   // Creating mapping of requested size extends file and allocates disk space for it, so writes to mapped memory
+   // can not fail later because of insufficient disk space
+   m_mapping = CreateFileMapping(m_file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+   if (m_mapping == nullptr)
+      return false;
+
+   m_data = static_cast<BYTE*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size));
+   if (m_data == nullptr)
+      return false;
+#else
+   m_fd = _topen(path, create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0600);
+   if (m_fd == -1)
+      return false;
+
+   if (create)
+   {
+      // Unwritten area is filled with zeroes, so it never contains valid record header
+      if (!AllocateFileSpace(m_fd, size))
+      {
+         nxlog_debug_tag(DEBUG_TAG, 3, _T("Cannot allocate %u bytes for segment file %s (%s)"), static_cast<uint32_t>(size), path, _tcserror(errno));
+         return false;
+      }
+   }
+   else
+   {
+      struct stat st;
+      if (fstat(m_fd, &st) != 0)
+         return false;
+      size = static_cast<size_t>(st.st_size);
+   }
+   if (size <= SEGMENT_HEADER_SIZE)
+      return false;
+
+   void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+   if (data == MAP_FAILED)
+      return false;
+   m_data = static_cast<BYTE*>(data);
+#endif
+   m_size = size;
+
+   if (create)
+   {
+      uint32_t magic = SEGMENT_MAGIC, version = SEGMENT_VERSION;
+      memcpy(m_data, &magic, 4);
+      memcpy(m_data + 4, &version, 4);
+      memcpy(m_data + 8, &m_id, 8);
+      return true;
+   }
+
+   uint32_t magic, version;
+   uint64_t id;
+   memcpy(&magic, m_data, 4);
+   memcpy(&version, m_data + 4, 4);
+   memcpy(&id, m_data + 8, 8);
+   return (magic == SEGMENT_MAGIC) && (version == SEGMENT_VERSION) && (id == m_id);
+}
+
+/**
+ * Schedule write of modified pages to disk
+ */
+void OfflineQueueSegment::flush()
+{
+   if (m_data == nullptr)
+      return;
+#ifdef _WIN32
+   FlushViewOfFile(m_data, 0);
+#else
+   msync(m_data, m_size, MS_ASYNC);
+#endif
+}
+
+/**
+ * Validate record at given offset. Returns full record size (including header) or 0 if there is no valid record at given offset.
+ */
+static size_t ValidateRecord(const BYTE *data, size_t limit, size_t offset)
+{
+   if (offset + RECORD_HEADER_SIZE > limit)
+      return 0;
+
+   uint32_t size, crc;
+   memcpy(&size, data + offset, 4);
+   memcpy(&crc, data + offset + 4, 4);
+   if ((size == 0) || (offset + RECORD_HEADER_SIZE + size > limit))
+      return 0;
+
+   if (CalculateCRC32(data + offset + RECORD_HEADER_SIZE, size, 0) != crc)
+      return 0;
+
+   return RECORD_HEADER_SIZE + size;
+}
+
+/**
+ * Queue constructor
+ */
+OfflineDataQueue::OfflineDataQueue(const TCHAR *path, size_t segmentSize) : m_mutex(MutexType::FAST), m_segments(64, 64)
+{
+   _tcslcpy(m_path, path, MAX_PATH);
+   m_segmentSize = segmentSize;
+   m_writeSegment = nullptr;
+   m_writeOffset = 0;
+   m_readSegment = nullptr;
+   m_cursor.segment = 0;
+   m_cursor.offset = SEGMENT_HEADER_SIZE;
+   m_pendingRecords = 0;
+}
+
+/**
+ * Queue destructor
+ */
+OfflineDataQueue::~OfflineDataQueue()
+{
+   close();
+}
+
+/**
+ * Close all open segments
+ */
+void OfflineDataQueue::close()
+{
+   if (m_writeSegment != nullptr)
+   {
+      m_writeSegment->flush();
+      delete_and_null(m_writeSegment);
+   }
+   delete_and_null(m_readSegment);
+}
+
+/**
+ * Build path to segment file
+ */
+void OfflineDataQueue::buildSegmentPath(uint64_t id, TCHAR *path) const
+{
+   _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR UINT64X_FMT(_T("016")) _T(".seg"), m_path, id);
+}
+
+/**
+ * Get segment with given ID for reading. Returned segment is valid until next call.
+ */
+OfflineQueueSegment *OfflineDataQueue::getSegment(uint64_t id)
+{
+   if ((m_writeSegment != nullptr) && (m_writeSegment->getId() == id))
+      return m_writeSegment;
+   if ((m_readSegment != nullptr) && (m_readSegment->getId() == id))
+      return m_readSegment;
+
+   delete_and_null(m_readSegment);
+
+   TCHAR path[MAX_PATH];
+   buildSegmentPath(id, path);
+   auto segment = new OfflineQueueSegment(id);
+   if (!segment->open(path, 0, false))
+   {
+      nxlog_debug_tag(DEBUG_TAG, 3, _T("Cannot open segment file %s"), path);
+      delete segment;
+      return nullptr;
+   }
+   m_readSegment = segment;
+   return segment;
+}
+
+/**
+ * Get limit for valid data in given segment
+ */
+size_t OfflineDataQueue::getDataLimit(OfflineQueueSegment *segment) const
+{
+   return (segment == m_writeSegment) ? m_writeOffset : segment->getSize();
+}
+
+/**
+ * Move position to the beginning of next existing segment. Returns false if there are no more segments.
+ */
+bool OfflineDataQueue::nextSegment(OfflineQueuePosition *position) const
+{
+   for(int i = 0; i < m_segments.size(); i++)
+   {
+      uint64_t id = m_segments.get(i);
+      if (id > position->segment)
+      {
+         position->segment = id;
+         position->offset = SEGMENT_HEADER_SIZE;
+         return true;
+      }
+   }
+   return false;
+}
+
+/**
+ * Delete segment file
+ */
+void OfflineDataQueue::deleteSegment(uint64_t id)
+{
+   if ((m_readSegment != nullptr) && (m_readSegment->getId() == id))
+      delete_and_null(m_readSegment);
+   if ((m_writeSegment != nullptr) && (m_writeSegment->getId() == id))
+      delete_and_null(m_writeSegment);
+
+   TCHAR path[MAX_PATH];
+   buildSegmentPath(id, path);
+   if (_tremove(path) != 0)
+      nxlog_debug_tag(DEBUG_TAG, 3, _T("Cannot delete segment file %s (%s)"), path, _tcserror(errno));
+   else
+      nxlog_debug_tag(DEBUG_TAG, 6, _T("Segment file %s deleted"), path);
+
+   for(int i = 0; i < m_segments.size(); i++)
+   {
+      if (m_segments.get(i) == id)
+      {
+         m_segments.remove(i);
+         break;
+      }
+   }
+}
+
+/**
+ * Move cursor past fully consumed sealed segments and delete them
+ */
+void OfflineDataQueue::normalizeCursor()
+{
+   if (m_segments.isEmpty())
+      return;
+
+   while(true)
+   {
+      OfflineQueueSegment *segment = getSegment(m_cursor.segment);
+      if (segment != nullptr)
+      {
+         if ((segment == m_writeSegment) || (ValidateRecord(segment->data(), segment->getSize(), m_cursor.offset) != 0))
+            break;
+      }
+      if (!nextSegment(&m_cursor))
+         break;
+   }
+
+   while(!m_segments.isEmpty() && (m_segments.get(0) < m_cursor.segment))
+      deleteSegment(m_segments.get(0));
+}
+
+/**
+ * Load cursor from file
+ */
+void OfflineDataQueue::loadCursor()
+{
+   TCHAR path[MAX_PATH];
+   _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR _T("cursor"), m_path);
+
+   CursorFileData data;
+   bool valid = false;
+   FILE *f = _tfopen(path, _T("rb"));
+   if (f != nullptr)
+   {
+      valid = (fread(&data, sizeof(data), 1, f) == 1) && (data.magic == CURSOR_MAGIC) &&
+               (data.crc == CalculateCRC32(reinterpret_cast<BYTE*>(&data.segment), sizeof(data) - 8, 0));
+      fclose(f);
+   }
+
+   if (valid)
+   {
+      m_cursor.segment = data.segment;
+      m_cursor.offset = data.offset;
+   }
+   else
+   {
+      // Start from oldest segment; records may be delivered more than once but nothing is lost
+      if (f != nullptr)
+         nxlog_debug_tag(DEBUG_TAG, 3, _T("Cursor file %s is invalid, reading from oldest segment"), path);
+      m_cursor.segment = !m_segments.isEmpty() ? m_segments.get(0) : 0;
+      m_cursor.offset = SEGMENT_HEADER_SIZE;
+   }
+
+   if (!m_segments.isEmpty() && (m_cursor.segment < m_segments.get(0)))
+   {
+      m_cursor.segment = m_segments.get(0);
+      m_cursor.offset = SEGMENT_HEADER_SIZE;
+   }
+}
+
+/**
+ * Save cursor to file
+ */
+void OfflineDataQueue::saveCursor()
+{
+   TCHAR path[MAX_PATH];
+   _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR _T("cursor"), m_path);
+
+   CursorFileData data;
+   data.magic = CURSOR_MAGIC;
+   data.segment = m_cursor.segment;
+   data.offset = m_cursor.offset;
+   data.reserved = 0;
+   data.crc = CalculateCRC32(reinterpret_cast<BYTE*>(&data.segment), sizeof(data) - 8, 0);
+
+   FILE *f = _tfopen(path, _T("wb"));
+   if (f == nullptr)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 3, _T("Cannot open cursor file %s (%s)"), path, _tcserror(errno));
+      return;
+   }
+   fwrite(&data, sizeof(data), 1, f);
+   fclose(f);
+}
+
+/**
+ * Open queue and recover its state after restart or crash
+ */
+bool OfflineDataQueue::open()
+{
+   m_mutex.lock();
+   bool success = recover();
+   m_mutex.unlock();
+   return success;
+}
+
+/**
+ * Recover queue state from segment and cursor files
+ */
+bool OfflineDataQueue::recover()
+{
+   // CreateDirectoryTree fails if directory already exists, so only directory open result is checked
+   CreateDirectoryTree(m_path);
+   _TDIR *dir = _topendir(m_path);
+   if (dir == nullptr)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 2, _T("Cannot open queue directory %s"), m_path);
+      return false;
+   }
+   struct _tdirent *d;
+   while((d = _treaddir(dir)) != nullptr)
+   {
+      TCHAR *eptr;
+      uint64_t id = _tcstoull(d->d_name, &eptr, 16);
+      if ((eptr - d->d_name == 16) && !_tcscmp(eptr, _T(".seg")))
+         m_segments.add(id);
+   }
+   _tclosedir(dir);
+   m_segments.sortAscending();
+
+   loadCursor();
+
+   // Last segment becomes write segment; scan it to find end of valid data and discard partially written record
+   if (!m_segments.isEmpty())
+   {
+      uint64_t id = m_segments.get(m_segments.size() - 1);
+      TCHAR path[MAX_PATH];
+      buildSegmentPath(id, path);
+      m_writeSegment = new OfflineQueueSegment(id);
+      if (m_writeSegment->open(path, 0, false))
+      {
+         BYTE *data = m_writeSegment->data();
+         size_t size = m_writeSegment->getSize();
+         size_t offset = SEGMENT_HEADER_SIZE;
+         size_t rs;
+         while((rs = ValidateRecord(data, size, offset)) != 0)
+            offset += rs;
+         m_writeOffset = offset;
+
+         for(size_t i = offset; i < size; i++)
+         {
+            if (data[i] != 0)
+            {
+               nxlog_debug_tag(DEBUG_TAG, 3, _T("Discarding incomplete data at offset %u in segment file %s"), static_cast<uint32_t>(offset), path);
+               memset(&data[offset], 0, size - offset);
+               m_writeSegment->flush();
+               break;
+            }
+         }
+      }
+      else
+      {
+         nxlog_debug_tag(DEBUG_TAG, 3, _T("Segment file %s is corrupted and will be deleted"), path);
+         delete_and_null(m_writeSegment);
+         deleteSegment(id);
+      }
+   }
+
+   normalizeCursor();
+
+   // Count pending records
+   m_pendingRecords = 0;
+   OfflineQueuePosition position = m_cursor;
+   while(!m_segments.isEmpty())
+   {
+      OfflineQueueSegment *segment = getSegment(position.segment);
+      if (segment != nullptr)
+      {
+         size_t limit = getDataLimit(segment);
+         size_t offset = position.offset;
+         size_t rs;
+         while((rs = ValidateRecord(segment->data(), limit, offset)) != 0)
+         {
+            offset += rs;
+            m_pendingRecords++;
+         }
+      }
+      if (!nextSegment(&position))
+         break;
+   }
+   delete_and_null(m_readSegment);
+
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Offline data queue %s opened (%d segments, %u pending records)"), m_path, m_segments.size(), m_pendingRecords);
+   return true;
+}
+
+/**
+ * Create new write segment large enough to hold record of given size
+ */
+bool OfflineDataQueue::createWriteSegment(size_t recordSize)
+{
+   if (m_writeSegment != nullptr)
+   {
+      m_writeSegment->flush();
+      delete_and_null(m_writeSegment);
+   }
+
+   uint64_t id;
+   if (m_segments.isEmpty())
+   {
+      CreateDirectoryTree(m_path);  // Directory may be deleted by destroy()
+      id = m_cursor.segment + 1;
+      m_cursor.segment = id;
+      m_cursor.offset = SEGMENT_HEADER_SIZE;
+      saveCursor();
+   }
+   else
+   {
+      id = m_segments.get(m_segments.size() - 1) + 1;
+   }
+
+   TCHAR path[MAX_PATH];
+   buildSegmentPath(id, path);
+   auto segment = new OfflineQueueSegment(id);
+   if (!segment->open(path, std::max(m_segmentSize, SEGMENT_HEADER_SIZE + recordSize), true))
+   {
+      nxlog_debug_tag(DEBUG_TAG, 2, _T("Cannot create segment file %s"), path);
+      delete segment;
+      _tremove(path);
+      return false;
+   }
+
+   m_segments.add(id);
+   m_writeSegment = segment;
+   m_writeOffset = SEGMENT_HEADER_SIZE;
+   nxlog_debug_tag(DEBUG_TAG, 6, _T("Created segment file %s"), path);
+   return true;
+}
+
+/**
+ * Append record to queue
+ */
+bool OfflineDataQueue::append(const void *data, size_t size)
+{
+   if ((size == 0) || (size > 0x7FFFFFFF))
+      return false;
+
+   m_mutex.lock();
+
+   size_t recordSize = RECORD_HEADER_SIZE + size;
+   if ((m_writeSegment == nullptr) || (m_writeOffset + recordSize > m_writeSegment->getSize()))
+   {
+      if (!createWriteSegment(recordSize))
+      {
+         m_mutex.unlock();
+         return false;
+      }
+   }
+
+   // Size field is written last, so partially written record is never considered valid
+   BYTE *p = m_writeSegment->data() + m_writeOffset;
+   uint32_t crc = CalculateCRC32(static_cast<const BYTE*>(data), size, 0);
+   uint32_t size32 = static_cast<uint32_t>(size);
+   memcpy(p + RECORD_HEADER_SIZE, data, size);
+   memcpy(p + 4, &crc, 4);
+   memcpy(p, &size32, 4);
+
+   m_writeOffset += recordSize;
+   m_pendingRecords++;
+
+   m_mutex.unlock();
+   return true;
+}
+
+/**
+ * Flush current write segment
+ */
+void OfflineDataQueue::flush()
+{
+   m_mutex.lock();
+   if (m_writeSegment != nullptr)
+      m_writeSegment->flush();
+   m_mutex.unlock();
+}
+
+/**
+ * Read up to given number of records starting at cursor. Cursor is not moved until records are acknowledged.
+ */
+void OfflineDataQueue::read(int maxRecords, ObjectArray<OfflineQueueRecord> *records)
+{
+   m_mutex.lock();
+
+   OfflineQueuePosition position = m_cursor;
+   while(records->size() < maxRecords)
+   {
+      OfflineQueueSegment *segment = getSegment(position.segment);
+      if (segment != nullptr)
+      {
+         size_t rs = ValidateRecord(segment->data(), getDataLimit(segment), position.offset);
+         if (rs != 0)
+         {
+            const BYTE *data = segment->data() + position.offset + RECORD_HEADER_SIZE;
+            position.offset += static_cast<uint32_t>(rs);
+            records->add(new OfflineQueueRecord(data, rs - RECORD_HEADER_SIZE, position));
+            continue;
+         }
+         if (segment == m_writeSegment)
+            break;   // No more data
+      }
+
+      // End of sealed segment or missing segment
+      if (!nextSegment(&position))
+         break;
+   }
+
+   m_mutex.unlock();
+}
+
+/**
+ * Acknowledge delivery of all records up to given position
+ */
+void OfflineDataQueue::acknowledge(const OfflineQueuePosition& position, uint32_t count)
+{
+   m_mutex.lock();
+   if ((position.segment > m_cursor.segment) || ((position.segment == m_cursor.segment) && (position.offset > m_cursor.offset)))
+   {
+      m_cursor = position;
+      m_pendingRecords = (count < m_pendingRecords) ? m_pendingRecords - count : 0;
+      normalizeCursor();
+      saveCursor();
+   }
+   m_mutex.unlock();
+}
+
+/**
+ * Delete all queue data, including queue directory. Queue remains usable and directory will be re-created on next write.
+ */
+void OfflineDataQueue::destroy()
+{
+   m_mutex.lock();
+
+   close();
+   m_segments.clear();
+   m_writeOffset = 0;
+   m_cursor.segment = 0;
+   m_cursor.offset = SEGMENT_HEADER_SIZE;
+   m_pendingRecords = 0;
+
+   if (!DeleteDirectoryTree(m_path))
+      nxlog_debug_tag(DEBUG_TAG, 3, _T("Cannot delete queue directory %s"), m_path);
+
+   m_mutex.unlock();
+}
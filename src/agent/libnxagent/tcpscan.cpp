@@ -22,92 +22,103 @@
 
 #include "libnxagent.h"
 
-#define BLOCK_SIZE   32
+/**
+ * Maximum number of concurrent connection attempts
+ */
+#define WINDOW_SIZE     32
+
+/**
+ * Connection timeout (milliseconds)
+ */
+#define CONNECT_TIMEOUT 2000
 
 /**
- * Scan data for each address
+ * Connection attempt in progress
  */
 struct ScanData
 {
    SOCKET handle;
+   uint32_t addr;
    int64_t startTime;
-   bool completed;
-   bool success;
-   uint32_t rtt;
 };
 
 /**
- * Scan block of addresses
+ * Start connection attempt to given address. Returns true if connection attempt is in progress.
  */
-static void ScanBlock(uint32_t startAddr, uint32_t endAddr, uint16_t port, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
+static bool StartConnect(ScanData *target, uint32_t addr, uint16_t port, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
 {
    struct sockaddr_in remoteAddr;
    memset(&remoteAddr, 0, sizeof(remoteAddr));
    remoteAddr.sin_family = AF_INET;
    remoteAddr.sin_port = htons(port);
+   remoteAddr.sin_addr.s_addr = htonl(addr);
 
-   ScanData targets[BLOCK_SIZE];
-   memset(targets, 0, sizeof(targets));
-
-   int64_t pollStartTime = GetCurrentTimeMs();
-   int targetCount = endAddr - startAddr + 1;
-   int waitCount = 0;
-   for(int i = 0; i < targetCount; i++)
-   {
-      targets[i].handle = CreateSocket(AF_INET, SOCK_STREAM, 0);
-      SetSocketNonBlocking(targets[i].handle);
-      remoteAddr.sin_addr.s_addr = htonl(startAddr + i);
-      if (connect(targets[i].handle, reinterpret_cast<sockaddr*>(&remoteAddr), sizeof(remoteAddr)) == 0)
-      {
-         // connected immediately
-         targets[i].success = true;
-         targets[i].completed = true;
-      }
-      else if ((WSAGetLastError() != WSAEWOULDBLOCK) && (WSAGetLastError() != WSAEINPROGRESS))
-      {
-         // failed immediately
-         targets[i].completed = true;
-      }
-      else
-      {
-         targets[i].startTime = pollStartTime;
-         waitCount++;
-      }
-   }
-
-   while((waitCount > 0) && (GetCurrentTimeMs() - pollStartTime < 2000))
+   target->handle = CreateSocket(AF_INET, SOCK_STREAM, 0);
+   if (target->handle == INVALID_SOCKET)
+      return false;
+   SetSocketNonBlocking(target->handle);
+   target->addr = addr;
+   target->startTime = GetCurrentTimeMs();
+   if (connect(target->handle, reinterpret_cast<sockaddr*>(&remoteAddr), sizeof(remoteAddr)) == 0)
    {
-      SocketPoller sp(true);
-      for(int i = 0; i < targetCount; i++)
-         if (!targets[i].completed)
-            sp.add(targets[i].handle);
-      int rc = sp.poll(std::max(2000 - static_cast<int>(GetCurrentTimeMs() - pollStartTime), 0));
-      if (rc <= 0)
-         break;
-
-      for(int i = 0; i < targetCount; i++)
-         if (!targets[i].completed && sp.isSet(targets[i].handle))
-         {
-            targets[i].completed = true;
-            targets[i].success = sp.isReady(targets[i].handle);
-            targets[i].rtt = static_cast<uint32_t>(GetCurrentTimeMs() - targets[i].startTime);
-            waitCount--;
-         }
+      // connected immediately
+      callback(addr, 0, context);
    }
-
-   for(int i = 0; i < targetCount; i++)
+   else if ((WSAGetLastError() == WSAEWOULDBLOCK) || (WSAGetLastError() == WSAEINPROGRESS))
    {
-      if (targets[i].success)
-         callback(startAddr + i, targets[i].rtt, context);
-      closesocket(targets[i].handle);
+      return true;
    }
+   closesocket(target->handle);
+   return false;
 }
 
 /**
- * Scan range of IPv4 addresses using SNMP requests
+ * Scan range of IPv4 addresses using TCP connection attempts. Up to WINDOW_SIZE non-blocking connection attempts
+ * are kept in progress, new attempt is started as soon as any of the active ones completes or times out.
  */
 void LIBNXAGENT_EXPORTABLE TCPScanAddressRange(const InetAddress& from, const InetAddress& to, uint16_t port, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
 {
-   for(uint32_t a = from.getAddressV4(); a <= to.getAddressV4(); a += BLOCK_SIZE)
-      ScanBlock(a, std::min(a + BLOCK_SIZE - 1, to.getAddressV4()), port, callback, context);
+   ScanData targets[WINDOW_SIZE];
+   int activeCount = 0;
+   uint64_t next = from.getAddressV4();
+   uint64_t last = to.getAddressV4();
+   while((next <= last) || (activeCount > 0))
+   {
+      // Fill window
+      while((activeCount < WINDOW_SIZE) && (next <= last))
+      {
+         if (StartConnect(&targets[activeCount], static_cast<uint32_t>(next), port, callback, context))
+            activeCount++;
+         next++;
+      }
+      if (activeCount == 0)
+         break;
+
+      int64_t now = GetCurrentTimeMs();
+      int64_t oldestStartTime = now;
+      SocketPoller sp(true);
+      for(int i = 0; i < activeCount; i++)
+      {
+         sp.add(targets[i].handle);
+         if (targets[i].startTime < oldestStartTime)
+            oldestStartTime = targets[i].startTime;
+      }
+      sp.poll(static_cast<uint32_t>(std::max(CONNECT_TIMEOUT - (now - oldestStartTime), static_cast<int64_t>(0))));
+
+      // Complete finished and expired attempts
+      now = GetCurrentTimeMs();
+      for(int i = 0; i < activeCount; i++)
+      {
+         ScanData *t = &targets[i];
+         bool completed = sp.isSet(t->handle);
+         if (!completed && (now - t->startTime < CONNECT_TIMEOUT))
+            continue;
+
+         if (completed && sp.isReady(t->handle))
+            callback(t->addr, static_cast<uint32_t>(now - t->startTime), context);
+         closesocket(t->handle);
+         targets[i] = targets[--activeCount];
+         i--;
+      }
+   }
 }
@@ -103,6 +103,8 @@ static uint32_t H_SoftShutdown(const shared_ptr<ActionExecutionContext>& context
  */
 static bool SubAgentInit(Config *config)
 {
+   g_interfaceStatsMaxAge = config->getValueAsUInt(_T("/Linux/InterfaceStatsMaxAge"), g_interfaceStatsMaxAge);
+   g_processSnapshotMaxAge = config->getValueAsUInt(_T("/Linux/ProcessSnapshotMaxAge"), g_processSnapshotMaxAge);
    ReadCPUVendorId();
    SMBIOS_Parse(SMBIOS_Reader);
    StartCpuUsageCollector();
@@ -242,4 +242,7 @@ void StopDrbdCollector();
 
 void ReadCPUVendorId();
 
+extern uint32_t g_interfaceStatsMaxAge;
+extern uint32_t g_processSnapshotMaxAge;
+
 #endif // __LINUX_SUBAGENT_H__
@@ -298,6 +298,30 @@ static int ReceiveMessage(int socket, char *replyBuffer, size_t replyBufferSize)
    return recvmsg(socket, &reply, 0);
 }
 
+/**
+ * Open and bind netlink socket for NETLINK_ROUTE requests. Port ID is assigned by kernel,
+ * so multiple sockets can be used concurrently.
+ */
+static int OpenNetlinkSocket()
+{
+   int netlinkSocket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+   if (netlinkSocket == INVALID_SOCKET)
+      return INVALID_SOCKET;
+
+   int nOne = 1;
+   setsockopt(netlinkSocket, SOL_SOCKET, SO_REUSEADDR, (void*)&nOne, sizeof(int));
+
+   sockaddr_nl local;
+   memset(&local, 0, sizeof(local));
+   local.nl_family = AF_NETLINK;
+   if (bind(netlinkSocket, (struct sockaddr *)&local, sizeof(local)) == -1)
+   {
+      close(netlinkSocket);
+      return INVALID_SOCKET;
+   }
+   return netlinkSocket;
+}
+
 /**
  * Interface type conversion table
  */
@@ -447,30 +471,16 @@ static void ParseAddressMessage(nlmsghdr *messageHeader, ObjectArray<LinuxInterf
  */
 static ObjectArray<LinuxInterfaceInfo> *GetInterfaces()
 {
-   int netlinkSocket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+   int netlinkSocket = OpenNetlinkSocket();
    if (netlinkSocket == INVALID_SOCKET)
    {
-      AgentWriteDebugLog(4, _T("GetInterfaces: failed to open socket"));
-      return NULL;
+      AgentWriteDebugLog(4, _T("GetInterfaces: failed to open netlink socket"));
+      return nullptr;
    }
 
-   int nOne = 1;
-   setsockopt(netlinkSocket, SOL_SOCKET, SO_REUSEADDR, (void*)&nOne, sizeof(int));
-
-   sockaddr_nl local;
-   memset(&local, 0, sizeof(local));
-   local.nl_family = AF_NETLINK;
-   local.nl_pid = getpid();
-
    bool done;
    ObjectArray<LinuxInterfaceInfo> *ifList = nullptr;
 
-   if (bind(netlinkSocket, (struct sockaddr *)&local, sizeof(local)) == -1)
-   {
-      AgentWriteDebugLog(4, _T("GetInterfaces: failed to bind socket"));
-      goto failure_1;
-   }
-
    // Send request to read interface list
    if (SendMessage(netlinkSocket, RTM_GETLINK) == -1)
    {
@@ -750,119 +760,376 @@ static LONG ValueFromLine64(char *pszLine, int nPos, TCHAR *pValue)
 }
 
 /**
- * Handler for interface parameters (using /proc file system)
+ * Get interface counter from /proc/net/dev (used when netlink is not available)
  */
-LONG H_NetIfInfoFromProc(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
+static LONG NetIfInfoFromProcFile(const char *ifName, const TCHAR *arg, TCHAR *value)
 {
-   char *ptr, szBuffer[256], szName[IFNAMSIZ];
-   LONG nIndex, nRet = SYSINFO_RC_SUCCESS;
-
-   if (!AgentGetParameterArgA(param, 1, szBuffer, 256))
-      return SYSINFO_RC_UNSUPPORTED;
+   char *ptr, szBuffer[256];
+   LONG nRet = SYSINFO_RC_SUCCESS;
 
-   // Check if we have interface name or index
-   nIndex = strtol(szBuffer, &ptr, 10);
-   if (*ptr == 0)
+   FILE *fp = fopen("/proc/net/dev", "r");
+   if (fp != nullptr)
    {
-      // Index passed as argument, convert to name
-      if (if_indextoname(nIndex, szName) == nullptr)
-         nRet = SYSINFO_RC_ERROR;
+      while(1)
+      {
+         char *ret = fgets(szBuffer, 256, fp);
+         if (ret == nullptr || feof(fp))
+         {
+            nRet = SYSINFO_RC_ERROR;   // Interface record not found
+            break;
+         }
+
+         // We expect line in form interface:stats
+         TrimA(szBuffer);
+         ptr = strchr(szBuffer, ':');
+         if (ptr == nullptr)
+            continue;
+         *ptr = 0;
+
+         if (!stricmp(szBuffer, ifName))
+         {
+            ptr++;
+            break;
+         }
+      }
+      fclose(fp);
    }
    else
    {
-      // Name passed as argument
-      strlcpy(szName, szBuffer, IFNAMSIZ);
+      nRet = SYSINFO_RC_ERROR;
    }
 
-   // Get interface information
    if (nRet == SYSINFO_RC_SUCCESS)
    {
-      // If name is an alias (i.e. eth0:1), remove alias number
-      ptr = strchr(szName, ':');
-      if (ptr != nullptr)
-         *ptr = 0;
-
-      FILE *fp = fopen("/proc/net/dev", "r");
-      if (fp != nullptr)
+      TrimA(ptr);
+      switch ((long) arg)
       {
-         while(1)
-         {
-            char *ret = fgets(szBuffer, 256, fp);
-            if (ret == nullptr || feof(fp))
-            {
-               nRet = SYSINFO_RC_ERROR;   // Interface record not found
-               break;
-            }
+         case IF_INFO_BYTES_IN:
+            nRet = ValueFromLine(ptr, 0, value);
+            break;
+         case IF_INFO_BYTES_IN_64:
+            nRet = ValueFromLine64(ptr, 0, value);
+            break;
+         case IF_INFO_PACKETS_IN:
+            nRet = ValueFromLine(ptr, 1, value);
+            break;
+         case IF_INFO_PACKETS_IN_64:
+            nRet = ValueFromLine64(ptr, 1, value);
+            break;
+         case IF_INFO_ERRORS_IN:
+            nRet = ValueFromLine(ptr, 2, value);
+            break;
+         case IF_INFO_ERRORS_IN_64:
+            nRet = ValueFromLine64(ptr, 2, value);
+            break;
+         case IF_INFO_BYTES_OUT:
+            nRet = ValueFromLine(ptr, 8, value);
+            break;
+         case IF_INFO_BYTES_OUT_64:
+            nRet = ValueFromLine64(ptr, 8, value);
+            break;
+         case IF_INFO_PACKETS_OUT:
+            nRet = ValueFromLine(ptr, 9, value);
+            break;
+         case IF_INFO_PACKETS_OUT_64:
+            nRet = ValueFromLine64(ptr, 9, value);
+            break;
+         case IF_INFO_ERRORS_OUT:
+            nRet = ValueFromLine(ptr, 10, value);
+            break;
+         case IF_INFO_ERRORS_OUT_64:
+            nRet = ValueFromLine64(ptr, 10, value);
+            break;
+         default:
+            nRet = SYSINFO_RC_UNSUPPORTED;
+            break;
+      }
+   }
 
-            // We expect line in form interface:stats
-            TrimA(szBuffer);
-            ptr = strchr(szBuffer, ':');
-            if (ptr == nullptr)
-               continue;
-            *ptr = 0;
+   return nRet;
+}
 
-            if (!stricmp(szBuffer, szName))
-            {
-               ptr++;
-               break;
-            }
-         }
-         fclose(fp);
+/**
+ * Interface statistics
+ */
+struct InterfaceStatistics
+{
+   uint32_t index;
+   uint64_t bytesIn;
+   uint64_t packetsIn;
+   uint64_t errorsIn;
+   uint64_t bytesOut;
+   uint64_t packetsOut;
+   uint64_t errorsOut;
+};
+
+/**
+ * Interface statistics table indexed by interface name and index
+ */
+class InterfaceStatisticsTable
+{
+private:
+   ObjectArray<InterfaceStatistics> m_entries;
+   HashMap<uint32_t, InterfaceStatistics> m_byIndex;
+   StringObjectMap<InterfaceStatistics> m_byName;
+   int64_t m_timestamp;
+
+   void addInterface(nlmsghdr *messageHeader);
+
+public:
+   InterfaceStatisticsTable() : m_entries(256, 256, Ownership::True), m_byIndex(Ownership::False), m_byName(Ownership::False)
+   {
+      m_byName.setIgnoreCase(true);
+      m_timestamp = 0;
+   }
+
+   bool load();
+
+   int64_t getTimestamp() const { return m_timestamp; }
+   const InterfaceStatistics *find(uint32_t index) const { return m_byIndex.get(index); }
+   const InterfaceStatistics *find(const TCHAR *name) const { return m_byName.get(name); }
+};
+
+/**
+ * Add interface from RTM_NEWLINK message
+ */
+void InterfaceStatisticsTable::addInterface(nlmsghdr *messageHeader)
+{
+   auto interface = reinterpret_cast<ifinfomsg*>(NLMSG_DATA(messageHeader));
+   int len = messageHeader->nlmsg_len - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+
+   const char *name = nullptr;
+   rtnl_link_stats *stats32 = nullptr;
+   rtnl_link_stats64 *stats64 = nullptr;
+   for(struct rtattr *attribute = IFLA_RTA(interface); RTA_OK(attribute, len); attribute = RTA_NEXT(attribute, len))
+   {
+      switch(attribute->rta_type)
+      {
+         case IFLA_IFNAME:
+            name = static_cast<const char*>(RTA_DATA(attribute));
+            break;
+         case IFLA_STATS:
+            if (RTA_PAYLOAD(attribute) >= sizeof(rtnl_link_stats))
+               stats32 = static_cast<rtnl_link_stats*>(RTA_DATA(attribute));
+            break;
+         case IFLA_STATS64:
+            if (RTA_PAYLOAD(attribute) >= sizeof(rtnl_link_stats64))
+               stats64 = static_cast<rtnl_link_stats64*>(RTA_DATA(attribute));
+            break;
       }
-      else
+   }
+
+   if ((name == nullptr) || ((stats32 == nullptr) && (stats64 == nullptr)))
+      return;
+
+   auto entry = new InterfaceStatistics;
+   entry->index = interface->ifi_index;
+   if (stats64 != nullptr)
+   {
+      // Attribute data is only 4 byte aligned, so read 64 bit counters via memcpy
+      rtnl_link_stats64 s;
+      memcpy(&s, stats64, sizeof(s));
+      entry->bytesIn = s.rx_bytes;
+      entry->packetsIn = s.rx_packets;
+      entry->errorsIn = s.rx_errors;
+      entry->bytesOut = s.tx_bytes;
+      entry->packetsOut = s.tx_packets;
+      entry->errorsOut = s.tx_errors;
+   }
+   else
+   {
+      entry->bytesIn = stats32->rx_bytes;
+      entry->packetsIn = stats32->rx_packets;
+      entry->errorsIn = stats32->rx_errors;
+      entry->bytesOut = stats32->tx_bytes;
+      entry->packetsOut = stats32->tx_packets;
+      entry->errorsOut = stats32->tx_errors;
+   }
+
+   m_entries.add(entry);
+   m_byIndex.set(entry->index, entry);
+#ifdef UNICODE
+   m_byName.setPreallocated(WideStringFromMBString(name), entry);
+#else
+   m_byName.set(name, entry);
+#endif
+}
+
+/**
+ * Load statistics for all interfaces with single RTM_GETLINK dump
+ */
+bool InterfaceStatisticsTable::load()
+{
+   int netlinkSocket = OpenNetlinkSocket();
+   if (netlinkSocket == INVALID_SOCKET)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("InterfaceStatisticsTable::load: failed to open netlink socket (%s)"), _tcserror(errno));
+      return false;
+   }
+
+   if (SendMessage(netlinkSocket, RTM_GETLINK) == -1)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("InterfaceStatisticsTable::load: SendMessage(RTM_GETLINK) failed (%s)"), _tcserror(errno));
+      close(netlinkSocket);
+      return false;
+   }
+
+   // Link messages with statistics attributes are large, so use buffer big enough for full dump chunk
+   char *replyBuffer = MemAllocArrayNoInit<char>(32768);
+   bool success = true;
+   bool done = false;
+   while(!done)
+   {
+      int msgLen = ReceiveMessage(netlinkSocket, replyBuffer, 32768);
+      if (msgLen <= 0)
       {
-         nRet = SYSINFO_RC_ERROR;
+         nxlog_debug_tag(DEBUG_TAG, 4, _T("InterfaceStatisticsTable::load: ReceiveMessage failed (%s)"), _tcserror(errno));
+         success = false;
+         break;
       }
 
-      if (nRet == SYSINFO_RC_SUCCESS)
+      for(auto mptr = reinterpret_cast<struct nlmsghdr*>(replyBuffer); NLMSG_OK(mptr, msgLen); mptr = NLMSG_NEXT(mptr, msgLen))
       {
-         TrimA(ptr);
-         switch ((long) arg)
+         if (mptr->nlmsg_type == RTM_NEWLINK)
          {
-            case IF_INFO_BYTES_IN:
-               nRet = ValueFromLine(ptr, 0, value);
-               break;
-            case IF_INFO_BYTES_IN_64:
-               nRet = ValueFromLine64(ptr, 0, value);
-               break;
-            case IF_INFO_PACKETS_IN:
-               nRet = ValueFromLine(ptr, 1, value);
-               break;
-            case IF_INFO_PACKETS_IN_64:
-               nRet = ValueFromLine64(ptr, 1, value);
-               break;
-            case IF_INFO_ERRORS_IN:
-               nRet = ValueFromLine(ptr, 2, value);
-               break;
-            case IF_INFO_ERRORS_IN_64:
-               nRet = ValueFromLine64(ptr, 2, value);
-               break;
-            case IF_INFO_BYTES_OUT:
-               nRet = ValueFromLine(ptr, 8, value);
-               break;
-            case IF_INFO_BYTES_OUT_64:
-               nRet = ValueFromLine64(ptr, 8, value);
-               break;
-            case IF_INFO_PACKETS_OUT:
-               nRet = ValueFromLine(ptr, 9, value);
-               break;
-            case IF_INFO_PACKETS_OUT_64:
-               nRet = ValueFromLine64(ptr, 9, value);
-               break;
-            case IF_INFO_ERRORS_OUT:
-               nRet = ValueFromLine(ptr, 10, value);
-               break;
-            case IF_INFO_ERRORS_OUT_64:
-               nRet = ValueFromLine64(ptr, 10, value);
-               break;
-            default:
-               nRet = SYSINFO_RC_UNSUPPORTED;
-               break;
+            addInterface(mptr);
+         }
+         else if ((mptr->nlmsg_type == NLMSG_DONE) || (mptr->nlmsg_type == NLMSG_ERROR))
+         {
+            success = (mptr->nlmsg_type == NLMSG_DONE);
+            done = true;
+            break;
          }
       }
    }
 
-   return nRet;
+   MemFree(replyBuffer);
+   close(netlinkSocket);
+   m_timestamp = GetCurrentTimeMs();
+   return success;
+}
+
+/**
+ * Maximum age of interface statistics table in milliseconds
+ */
+uint32_t g_interfaceStatsMaxAge = 1000;
+
+/**
+ * Current interface statistics table
+ */
+static shared_ptr<InterfaceStatisticsTable> s_interfaceStatistics;
+static Mutex s_interfaceStatisticsLock(MutexType::FAST);
+
+/**
+ * Get interface statistics table no older than configured maximum age. Returns null if netlink request failed.
+ */
+static shared_ptr<InterfaceStatisticsTable> GetInterfaceStatistics()
+{
+   s_interfaceStatisticsLock.lock();
+   if ((s_interfaceStatistics == nullptr) || (GetCurrentTimeMs() - s_interfaceStatistics->getTimestamp() > g_interfaceStatsMaxAge))
+   {
+      auto table = make_shared<InterfaceStatisticsTable>();
+      if (table->load())
+         s_interfaceStatistics = table;
+      else
+         s_interfaceStatistics.reset();
+   }
+   shared_ptr<InterfaceStatisticsTable> table = s_interfaceStatistics;
+   s_interfaceStatisticsLock.unlock();
+   return table;
+}
+
+/**
+ * Handler for interface counters (using netlink statistics table, with fallback to /proc file system)
+ */
+LONG H_NetIfInfoFromProc(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
+{
+   char *ptr, buffer[256];
+   if (!AgentGetParameterArgA(param, 1, buffer, 256))
+      return SYSINFO_RC_UNSUPPORTED;
+
+   // Check if we have interface name or index
+   char name[IFNAMSIZ];
+   uint32_t index = strtol(buffer, &ptr, 10);
+   bool byIndex = (*ptr == 0);
+   if (!byIndex)
+   {
+      strlcpy(name, buffer, IFNAMSIZ);
+
+      // If name is an alias (i.e. eth0:1), remove alias number
+      ptr = strchr(name, ':');
+      if (ptr != nullptr)
+         *ptr = 0;
+   }
+
+   shared_ptr<InterfaceStatisticsTable> table = GetInterfaceStatistics();
+   if (table == nullptr)
+   {
+      if (byIndex && (if_indextoname(index, name) == nullptr))
+         return SYSINFO_RC_ERROR;
+      return NetIfInfoFromProcFile(name, arg, value);
+   }
+
+   const InterfaceStatistics *stats;
+   if (byIndex)
+   {
+      stats = table->find(index);
+   }
+   else
+   {
+#ifdef UNICODE
+      WCHAR wname[IFNAMSIZ];
+      mb_to_wchar(name, -1, wname, IFNAMSIZ);
+      stats = table->find(wname);
+#else
+      stats = table->find(name);
+#endif
+   }
+   if (stats == nullptr)
+      return SYSINFO_RC_ERROR;
+
+   switch(CAST_FROM_POINTER(arg, int))
+   {
+      case IF_INFO_BYTES_IN:
+         ret_uint(value, static_cast<uint32_t>(stats->bytesIn));
+         break;
+      case IF_INFO_BYTES_IN_64:
+         ret_uint64(value, stats->bytesIn);
+         break;
+      case IF_INFO_PACKETS_IN:
+         ret_uint(value, static_cast<uint32_t>(stats->packetsIn));
+         break;
+      case IF_INFO_PACKETS_IN_64:
+         ret_uint64(value, stats->packetsIn);
+         break;
+      case IF_INFO_ERRORS_IN:
+         ret_uint(value, static_cast<uint32_t>(stats->errorsIn));
+         break;
+      case IF_INFO_ERRORS_IN_64:
+         ret_uint64(value, stats->errorsIn);
+         break;
+      case IF_INFO_BYTES_OUT:
+         ret_uint(value, static_cast<uint32_t>(stats->bytesOut));
+         break;
+      case IF_INFO_BYTES_OUT_64:
+         ret_uint64(value, stats->bytesOut);
+         break;
+      case IF_INFO_PACKETS_OUT:
+         ret_uint(value, static_cast<uint32_t>(stats->packetsOut));
+         break;
+      case IF_INFO_PACKETS_OUT_64:
+         ret_uint64(value, stats->packetsOut);
+         break;
+      case IF_INFO_ERRORS_OUT:
+         ret_uint(value, static_cast<uint32_t>(stats->errorsOut));
+         break;
+      case IF_INFO_ERRORS_OUT_64:
+         ret_uint64(value, stats->errorsOut);
+         break;
+      default:
+         return SYSINFO_RC_UNSUPPORTED;
+   }
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
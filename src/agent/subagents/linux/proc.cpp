@@ -61,6 +61,13 @@ struct FileDescriptor
    }
 };
 
+/**
+ * Flags for lazily loaded process data
+ */
+#define PROCESS_USER_LOADED      0x01
+#define PROCESS_CMDLINE_LOADED   0x02
+#define PROCESS_HANDLES_LOADED   0x04
+
 /**
  * Process entry
  */
@@ -71,7 +78,6 @@ struct Process
    uint32_t parent;      // PID of parent process
    uint32_t group;       // Group ID
    char state;           // Process state
-   char user[MAX_USER_NAME_LEN];   // Process owner user
    long threads;         // Number of threads
    unsigned long ktime;  // Number of ticks spent in kernel mode
    unsigned long utime;  // Number of ticks spent in user mode
@@ -79,17 +85,18 @@ struct Process
    long rss;             // Process's resident set size in pages
    unsigned long minflt; // Number of minor page faults
    unsigned long majflt; // Number of major page faults
-   ObjectArray<FileDescriptor> *fd;
-   char *cmdLine; // Process command line
+   uint32_t loaded;      // Lazily loaded data flags
+   char user[MAX_USER_NAME_LEN];   // Process owner user (loaded on demand)
+   ObjectArray<FileDescriptor> *fd;   // Open file descriptors (loaded on demand)
+   char *cmdLine;        // Process command line (loaded on demand)
 
-   Process(uint32_t _pid, const char *_name, char *_user, char *_cmdLine)
+   Process(uint32_t _pid, const char *_name)
    {
       pid = _pid;
       strlcpy(name, _name, MAX_PROCESS_NAME_LEN);
       parent = 0;
       group = 0;
       state = '?';
-      strlcpy(user, CHECK_NULL_EX_A(_user), MAX_USER_NAME_LEN);
       threads = 0;
       ktime = 0;
       utime = 0;
@@ -97,8 +104,10 @@ struct Process
       rss = 0;
       minflt = 0;
       majflt = 0;
+      loaded = 0;
+      user[0] = 0;
       fd = nullptr;
-      cmdLine = _cmdLine;
+      cmdLine = nullptr;
    }
 
    ~Process()
@@ -137,29 +146,122 @@ static ObjectArray<FileDescriptor> *ReadProcessHandles(const char *path)
 }
 
 /**
- * Read process information from /proc system
- * Parameters:
- *    plist    - array to fill, can be NULL
- *    procNameFilter - If not NULL, only processes with matched name will
- *               be counted and read. If cmdLineFilter is NULL, then exact
- *               match required to pass filter; otherwise procNameFilter can
- *               be a regular expression.
- *    cmdLineFilter - If not NULL, only processes with command line matched to
- *              regular expression will be counted and read.
- *    procUser - If not NULL, only processes run by this user will be counted.
- * Return value: number of matched processes or -1 in case of error.
+ * Read owner user name of given process
  */
-static int ProcRead(ObjectArray<Process> *plist, const char *procNameFilter, const char *cmdLineFilter, const char *procUserFilter, bool readHandles, bool readCmdLine)
+static void ReadProcessUser(uint32_t pid, char *user)
 {
-   nxlog_debug_tag(DEBUG_TAG, 6, _T("ProcRead(%p, \"%hs\",\"%hs\",\"%hs\")"), plist, CHECK_NULL_A(procNameFilter), CHECK_NULL_A(cmdLineFilter), CHECK_NULL_A(procUserFilter));
+   char fileName[64];
+   snprintf(fileName, 64, "/proc/%u/status", pid);
+   int hFile = _open(fileName, O_RDONLY);
+   if (hFile == -1)
+      return;
+
+   char statusBuffer[8192];
+   ssize_t bytes = _read(hFile, statusBuffer, sizeof(statusBuffer) - 1);
+   _close(hFile);
+   if (bytes <= 0)
+      return;
+
+   statusBuffer[bytes] = 0;
+   char *puid = strstr(statusBuffer, "Uid:");
+   if (puid == nullptr)
+      return;
+
+   puid += 4;
+   while((*puid == '\t') || (*puid == ' '))
+      puid++;
+   uint32_t uid = strtoul(puid, nullptr, 10);
+
+   passwd pbuffer, *userInfo;
+   char pwbuffer[512];
+   getpwuid_r(uid, &pbuffer, pwbuffer, sizeof(pwbuffer), &userInfo);
+   if (userInfo != nullptr)
+      strlcpy(user, userInfo->pw_name, MAX_USER_NAME_LEN);
+}
+
+/**
+ * Read command line of given process. Arguments are separated by spaces.
+ */
+static char *ReadProcessCommandLine(uint32_t pid)
+{
+   char fileName[64];
+   snprintf(fileName, 64, "/proc/%u/cmdline", pid);
+   int hFile = _open(fileName, O_RDONLY);
+   if (hFile == -1)
+      return nullptr;
+
+   size_t len = 0, pos = 0;
+   char *cmdLine = MemAllocStringA(4096);
+   while (true)
+   {
+      ssize_t bytes = _read(hFile, &cmdLine[pos], 4096);
+      if (bytes < 0)
+         bytes = 0;
+      len += bytes;
+      if (bytes < 4096)
+      {
+         cmdLine[len] = 0;
+         break;
+      }
+      pos += bytes;
+      cmdLine = MemRealloc(cmdLine, pos + 4096);
+   }
+   _close(hFile);
+
+   // got a valid record in format: argv[0]\x00argv[1]\x00...
+   // Note: to behave identicaly on different platforms,
+   // full command line including argv[0] should be matched
+   // replace 0x00 with spaces
+   for (size_t j = 0; j + 1 < len; j++)
+   {
+      if (cmdLine[j] == 0)
+         cmdLine[j] = ' ';
+   }
+   return cmdLine;
+}
+
+/**
+ * Snapshot of process table. Only /proc/<pid>/stat is read when snapshot is created; owner, command line,
+ * and open handles are read on first access. Snapshot is shared by concurrent metric handlers. Lazily loaded
+ * data is not carried over to next snapshot, because it can change during process lifetime (exec, setuid,
+ * argv rewriting) without changing PID and start time.
+ */
+class ProcessSnapshot
+{
+private:
+   ObjectArray<Process> m_processes;
+   HashMap<uint32_t, Process> m_index;
+   int64_t m_timestamp;
+   Mutex m_lock;
+
+public:
+   ProcessSnapshot() : m_processes(256, 256, Ownership::True), m_index(Ownership::False), m_lock(MutexType::FAST)
+   {
+      m_timestamp = 0;
+   }
+
+   bool load();
+
+   int64_t getTimestamp() const { return m_timestamp; }
+   int size() const { return m_processes.size(); }
+   Process *get(int index) const { return m_processes.get(index); }
+   Process *find(uint32_t pid) const { return m_index.get(pid); }
+
+   const char *getUser(Process *p);
+   const char *getCommandLine(Process *p);
+   ObjectArray<FileDescriptor> *getHandles(Process *p);
+};
 
+/**
+ * Load process table from /proc
+ */
+bool ProcessSnapshot::load()
+{
    DIR *dir = opendir("/proc");
    if (dir == nullptr)
-      return -1;
+      return false;
 
    char fileName[MAX_PATH] = "/proc/";
-
-   int count = 0;
    struct dirent *d;
    while ((d = readdir(dir)) != nullptr)
    {
@@ -171,168 +273,204 @@ static int ProcRead(ObjectArray<Process> *plist, const char *procNameFilter, con
       if (*eptr != 0)
          continue;
 
-      strcpy(&fileName[6], d->d_name);
-      strcat(fileName, "/");
-      size_t fileNamePos = strlen(fileName);
-
-      // Read stat file
-      char szProcStat[1024], *pProcStat = nullptr, *pProcName = nullptr;
-      bool procNameMatch = false;
-      strcpy(&fileName[fileNamePos], "stat");
+      snprintf(&fileName[6], MAX_PATH - 6, "%s/stat", d->d_name);
       int hFile = _open(fileName, O_RDONLY);
-      if (hFile != -1)
-      {
-         ssize_t bytes = _read(hFile, szProcStat, sizeof(szProcStat) - 1);
-         if (bytes > 0)
-         {
-            szProcStat[bytes] = 0;
-            uint32_t tmp;
-            if (sscanf(szProcStat, "%u ", &tmp) == 1) // Skip PID
-            {
-               char *procNamePos = strchr(szProcStat, '(');
-               if (procNamePos != nullptr)
-               {
-                  pProcStat = strrchr(procNamePos, ')');
-                  if (pProcStat != nullptr)
-                  {
-                     pProcName = procNamePos + 1;
-                     *pProcStat = 0;
-                     pProcStat++;
-                  }
-                  if (pProcName != nullptr)
-                  {
-                     if ((procNameFilter != nullptr) && (*procNameFilter != 0))
-                     {
-                        if (cmdLineFilter == nullptr) // use old style compare
-                           procNameMatch = (strcmp(pProcName, procNameFilter) == 0);
-                        else
-                           procNameMatch = RegexpMatchA(pProcName, procNameFilter, false);
-                     }
-                     else
-                     {
-                        procNameMatch = true;
-                     }
-                  }
-               }
-            }
-         }
-         _close(hFile);
-      }
+      if (hFile == -1)
+         continue;
 
-      if (!procNameMatch)
+      char procStat[1024];
+      ssize_t bytes = _read(hFile, procStat, sizeof(procStat) - 1);
+      _close(hFile);
+      if (bytes <= 0)
          continue;
+      procStat[bytes] = 0;
 
-      // Read status file
-      passwd pbuffer, *userInfo;
-      char pwbuffer[512];
-      char *userName = nullptr;
-      strcpy(&fileName[fileNamePos], "status");
-      hFile = _open(fileName, O_RDONLY);
-      if (hFile != -1)
+      // Process name is enclosed in parenthesis and may contain spaces and parenthesis
+      char *procName = strchr(procStat, '(');
+      if (procName == nullptr)
+         continue;
+      char *rest = strrchr(procName, ')');
+      if (rest == nullptr)
+         continue;
+      procName++;
+      *rest = 0;
+      rest++;
+
+      auto p = new Process(pid, procName);
+      if (sscanf(rest, " %c %d %d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu %*u %*u %*d %*d %ld %*d %*u %lu %ld ",
+                 &p->state, &p->parent, &p->group, &p->minflt, &p->majflt,
+                 &p->utime, &p->ktime, &p->threads, &p->vmsize, &p->rss) != 10)
       {
-         char statusBuffer[8192];
-         ssize_t bytes = _read(hFile, statusBuffer, sizeof(statusBuffer) - 1);
-         if (bytes > 0)
-         {
-            statusBuffer[bytes] = 0;
-            char *puid = strstr(statusBuffer, "Uid:");
-            if (puid != nullptr)
-            {
-               puid += 4;
-               while((*puid == '\t') || (*puid == ' '))
-                  puid++;
-               uint32_t uid = strtoul(puid, &eptr, 10);
-
-               getpwuid_r(uid, &pbuffer, pwbuffer, sizeof(pwbuffer), &userInfo);
-               if (userInfo != nullptr)
-               {
-                  userName = userInfo->pw_name;
-               }
-            }
-         }
-         _close(hFile);
+         nxlog_debug_tag(DEBUG_TAG, 5, _T("Error parsing /proc/%u/stat"), pid);
       }
 
-      // Check if user name matches pattern
-      if ((procUserFilter != nullptr) && (*procUserFilter != 0)  && !RegexpMatchA(CHECK_NULL_EX_A(userName), procUserFilter, true))
-         continue;
+      m_processes.add(p);
+      m_index.set(pid, p);
+   }
+   closedir(dir);
 
-      char *processCmdLine = nullptr;
-      if (readCmdLine || ((cmdLineFilter != nullptr) && (*cmdLineFilter != 0)))
-      {
-         strcpy(&fileName[fileNamePos], "cmdline");
-         hFile = _open(fileName, O_RDONLY);
-         if (hFile != -1)
-         {
-            size_t len = 0, pos = 0;
-            processCmdLine = MemAllocStringA(4096);
-            while (true)
-            {
-               ssize_t bytes = _read(hFile, &processCmdLine[pos], 4096);
-               if (bytes < 0)
-                  bytes = 0;
-               len += bytes;
-               if (bytes < 4096)
-               {
-                  processCmdLine[len] = 0;
-                  break;
-               }
-               pos += bytes;
-               processCmdLine = MemRealloc(processCmdLine, pos + 4096);
-            }
-            _close(hFile);
-            if (len > 0)
-            {
-               // got a valid record in format: argv[0]\x00argv[1]\x00...
-               // Note: to behave identicaly on different platforms,
-               // full command line including argv[0] should be matched
-               // replace 0x00 with spaces
-               for (int j = 0; j < len - 1; j++)
-               {
-                  if (processCmdLine[j] == 0)
-                  {
-                     processCmdLine[j] = ' ';
-                  }
-               }
-            }
-         }
+   m_timestamp = GetCurrentTimeMs();
+   return true;
+}
 
-         if ((cmdLineFilter != nullptr) && (*cmdLineFilter != 0))
-         {
-            if (!RegexpMatchA(CHECK_NULL_EX_A(processCmdLine), cmdLineFilter, true))
-            {
-               MemFree(processCmdLine);
-               continue;
-            }
-            if (!readCmdLine)
-               MemFreeAndNull(processCmdLine);
-         }
+/**
+ * Get process owner. Data is read from /proc without holding snapshot lock; if another thread loads same data
+ * concurrently, first stored result is used. Loaded data is never changed afterwards.
+ */
+const char *ProcessSnapshot::getUser(Process *p)
+{
+   m_lock.lock();
+   bool loaded = (p->loaded & PROCESS_USER_LOADED) != 0;
+   m_lock.unlock();
+   if (loaded)
+      return p->user;
+
+   char user[MAX_USER_NAME_LEN] = "";
+   ReadProcessUser(p->pid, user);
+
+   m_lock.lock();
+   if (!(p->loaded & PROCESS_USER_LOADED))
+   {
+      strcpy(p->user, user);
+      p->loaded |= PROCESS_USER_LOADED;
+   }
+   m_lock.unlock();
+   return p->user;
+}
+
+/**
+ * Get process command line (can be NULL)
+ */
+const char *ProcessSnapshot::getCommandLine(Process *p)
+{
+   m_lock.lock();
+   bool loaded = (p->loaded & PROCESS_CMDLINE_LOADED) != 0;
+   m_lock.unlock();
+   if (loaded)
+      return p->cmdLine;
+
+   char *cmdLine = ReadProcessCommandLine(p->pid);
+
+   m_lock.lock();
+   if (!(p->loaded & PROCESS_CMDLINE_LOADED))
+   {
+      p->cmdLine = cmdLine;
+      p->loaded |= PROCESS_CMDLINE_LOADED;
+      cmdLine = nullptr;
+   }
+   m_lock.unlock();
+   MemFree(cmdLine);
+   return p->cmdLine;
+}
+
+/**
+ * Get process open handles (can be NULL)
+ */
+ObjectArray<FileDescriptor> *ProcessSnapshot::getHandles(Process *p)
+{
+   m_lock.lock();
+   bool loaded = (p->loaded & PROCESS_HANDLES_LOADED) != 0;
+   m_lock.unlock();
+   if (loaded)
+      return p->fd;
+
+   char path[64];
+   snprintf(path, 64, "/proc/%u/fd", p->pid);
+   ObjectArray<FileDescriptor> *fd = ReadProcessHandles(path);
+
+   m_lock.lock();
+   if (!(p->loaded & PROCESS_HANDLES_LOADED))
+   {
+      p->fd = fd;
+      p->loaded |= PROCESS_HANDLES_LOADED;
+      fd = nullptr;
+   }
+   m_lock.unlock();
+   delete fd;
+   return p->fd;
+}
+
+/**
+ * Maximum age of process snapshot in milliseconds
+ */
+uint32_t g_processSnapshotMaxAge = 1000;
+
+/**
+ * Current process snapshot
+ */
+static shared_ptr<ProcessSnapshot> s_processSnapshot;
+static Mutex s_processSnapshotLock(MutexType::FAST);
+
+/**
+ * Get process snapshot no older than configured maximum age. Concurrent callers wait for single /proc scan.
+ */
+static shared_ptr<ProcessSnapshot> AcquireProcessSnapshot()
+{
+   s_processSnapshotLock.lock();
+   if ((s_processSnapshot == nullptr) || (GetCurrentTimeMs() - s_processSnapshot->getTimestamp() > g_processSnapshotMaxAge))
+   {
+      auto snapshot = make_shared<ProcessSnapshot>();
+      if (snapshot->load())
+      {
+         nxlog_debug_tag(DEBUG_TAG, 7, _T("New process snapshot created (%d processes)"), snapshot->size());
+         s_processSnapshot = snapshot;
       }
+      else
+      {
+         s_processSnapshotLock.unlock();
+         return shared_ptr<ProcessSnapshot>();
+      }
+   }
+   shared_ptr<ProcessSnapshot> snapshot = s_processSnapshot;
+   s_processSnapshotLock.unlock();
+   return snapshot;
+}
 
-      if ((plist != nullptr) && (pProcName != nullptr))
+/**
+ * Select processes from snapshot
+ * Parameters:
+ *    snapshot - process snapshot
+ *    plist    - array to fill, can be NULL. Array should not own its elements.
+ *    procNameFilter - If not NULL, only processes with matched name will
+ *               be counted and read. If cmdLineFilter is NULL, then exact
+ *               match required to pass filter; otherwise procNameFilter can
+ *               be a regular expression.
+ *    cmdLineFilter - If not NULL, only processes with command line matched to
+ *              regular expression will be counted and read.
+ *    procUser - If not NULL, only processes run by this user will be counted.
+ * Return value: number of matched processes.
+ */
+static int ProcRead(ProcessSnapshot *snapshot, ObjectArray<Process> *plist, const char *procNameFilter, const char *cmdLineFilter, const char *procUserFilter)
+{
+   nxlog_debug_tag(DEBUG_TAG, 6, _T("ProcRead(%p, \"%hs\",\"%hs\",\"%hs\")"), plist, CHECK_NULL_A(procNameFilter), CHECK_NULL_A(cmdLineFilter), CHECK_NULL_A(procUserFilter));
+
+   int count = 0;
+   for(int i = 0; i < snapshot->size(); i++)
+   {
+      Process *p = snapshot->get(i);
+
+      if ((procNameFilter != nullptr) && (*procNameFilter != 0))
       {
-         auto p = new Process(pid, pProcName, userName, processCmdLine);
-         // Parse rest of /proc/pid/stat file
-         if (pProcStat != nullptr)
-         {
-            if (sscanf(pProcStat, " %c %d %d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu %*u %*u %*d %*d %ld %*d %*u %lu %ld ",
-                       &p->state, &p->parent, &p->group, &p->minflt, &p->majflt,
-                       &p->utime, &p->ktime, &p->threads, &p->vmsize, &p->rss) != 10)
-            {
-               nxlog_debug_tag(DEBUG_TAG, 5, _T("Error parsing /proc/%u/stat"), pid);
-            }
-         }
-         if (readHandles)
-         {
-            strcpy(&fileName[fileNamePos], "fd");
-            p->fd = ReadProcessHandles(fileName);
-         }
-         plist->add(p);
+         bool match;
+         if (cmdLineFilter == nullptr) // use old style compare
+            match = (strcmp(p->name, procNameFilter) == 0);
+         else
+            match = RegexpMatchA(p->name, procNameFilter, false);
+         if (!match)
+            continue;
       }
 
+      // Check if user name matches pattern
+      if ((procUserFilter != nullptr) && (*procUserFilter != 0) && !RegexpMatchA(snapshot->getUser(p), procUserFilter, true))
+         continue;
+
+      if ((cmdLineFilter != nullptr) && (*cmdLineFilter != 0) && !RegexpMatchA(CHECK_NULL_EX_A(snapshot->getCommandLine(p)), cmdLineFilter, true))
+         continue;
+
+      if (plist != nullptr)
+         plist->add(p);
       count++;
    }
-   closedir(dir);
    return count;
 }
 
@@ -372,10 +510,12 @@ LONG H_ProcessCount(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, Abs
       AgentGetParameterArgA(pszParam, 3, userFilter, sizeof(userFilter));
    }
 
-   int count = ProcRead(nullptr, procNameFilter, (*pArg == _T('E')) ? cmdLineFilter : nullptr, (*pArg == _T('E')) ? userFilter : nullptr, false, false);
-   if (count == -1)
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
       return SYSINFO_RC_ERROR;
 
+   int count = ProcRead(snapshot.get(), nullptr, procNameFilter, (*pArg == _T('E')) ? cmdLineFilter : nullptr, (*pArg == _T('E')) ? userFilter : nullptr);
+
    ret_int(pValue, count);
    return SYSINFO_RC_SUCCESS;
 }
@@ -385,19 +525,15 @@ LONG H_ProcessCount(const TCHAR *pszParam, const TCHAR *pArg, TCHAR *pValue, Abs
  */
 LONG H_ThreadCount(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
 {
-   int i, sum, count, ret = SYSINFO_RC_ERROR;
-   ObjectArray<Process> procList(128, 128, Ownership::True);
-
-   count = ProcRead(&procList, nullptr, nullptr, nullptr, false, false);
-   if (count >= 0)
-   {
-      for (i = 0, sum = 0; i < procList.size(); i++)
-         sum += procList.get(i)->threads;
-      ret_int(value, sum);
-      ret = SYSINFO_RC_SUCCESS;
-   }
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
+      return SYSINFO_RC_ERROR;
 
-   return ret;
+   int sum = 0;
+   for (int i = 0; i < snapshot->size(); i++)
+      sum += snapshot->get(i)->threads;
+   ret_int(value, sum);
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -405,22 +541,19 @@ LONG H_ThreadCount(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractC
  */
 LONG H_HandleCount(const TCHAR *param, const TCHAR *arg, TCHAR *value, AbstractCommSession *session)
 {
-   int i, sum, count, ret = SYSINFO_RC_ERROR;
-   ObjectArray<Process> procList(128, 128, Ownership::True);
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
+      return SYSINFO_RC_ERROR;
 
-   count = ProcRead(&procList, nullptr, nullptr, nullptr, true, false);
-   if (count >= 0)
+   int sum = 0;
+   for (int i = 0; i < snapshot->size(); i++)
    {
-      for (i = 0, sum = 0; i < procList.size(); i++)
-      {
-         if (procList.get(i)->fd != NULL)
-            sum += procList.get(i)->fd->size();
-      }
-      ret_int(value, sum);
-      ret = SYSINFO_RC_SUCCESS;
+      ObjectArray<FileDescriptor> *fd = snapshot->getHandles(snapshot->get(i));
+      if (fd != nullptr)
+         sum += fd->size();
    }
-
-   return ret;
+   ret_int(value, sum);
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -495,14 +628,13 @@ LONG H_ProcessDetails(const TCHAR *param, const TCHAR *arg, TCHAR *value, Abstra
    AgentGetParameterArgA(param, 4, userFilter, sizeof(userFilter));
    TrimA(cmdLineFilter);
 
-   ObjectArray<Process> procList(128, 128, Ownership::True);
-   count = ProcRead(&procList, procNameFilter, (cmdLineFilter[0] != 0) ? cmdLineFilter : nullptr,
-                    (userFilter[0] != 0) ? userFilter : nullptr, CAST_FROM_POINTER(arg, int) == PROCINFO_HANDLES, false);
-   nxlog_debug_tag(DEBUG_TAG, 5, _T("H_ProcessDetails(\"%hs\"): ProcRead() returns %d"), param, count);
-   if (count == -1)
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
       return SYSINFO_RC_ERROR;
-   if (count == -2)
-      return SYSINFO_RC_UNSUPPORTED;
+
+   ObjectArray<Process> procList(128, 128, Ownership::False);
+   count = ProcRead(snapshot.get(), &procList, procNameFilter, (cmdLineFilter[0] != 0) ? cmdLineFilter : nullptr, (userFilter[0] != 0) ? userFilter : nullptr);
+   nxlog_debug_tag(DEBUG_TAG, 5, _T("H_ProcessDetails(\"%hs\"): ProcRead() returns %d"), param, count);
 
    long pageSize = getpagesize();
    long ticksPerSecond = sysconf(_SC_CLK_TCK);
@@ -515,7 +647,10 @@ LONG H_ProcessDetails(const TCHAR *param, const TCHAR *arg, TCHAR *value, Abstra
             currVal = (p->ktime + p->utime) * 1000 / ticksPerSecond;
             break;
          case PROCINFO_HANDLES:
-            currVal = (p->fd != NULL) ? p->fd->size() : 0;
+            {
+               ObjectArray<FileDescriptor> *fd = snapshot->getHandles(p);
+               currVal = (fd != nullptr) ? fd->size() : 0;
+            }
             break;
          case PROCINFO_KTIME:
             currVal = p->ktime * 1000 / ticksPerSecond;
@@ -570,23 +705,18 @@ LONG H_ProcessDetails(const TCHAR *param, const TCHAR *arg, TCHAR *value, Abstra
  */
 LONG H_ProcessList(const TCHAR *pszParam, const TCHAR *pArg, StringList *value, AbstractCommSession *session)
 {
-   int nRet = SYSINFO_RC_ERROR;
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
+      return SYSINFO_RC_ERROR;
 
-   ObjectArray<Process> procList(128, 128, Ownership::True);
-   int nCount = ProcRead(&procList, nullptr, nullptr, nullptr, false, false);
-   if (nCount >= 0)
+   for (int i = 0; i < snapshot->size(); i++)
    {
-      nRet = SYSINFO_RC_SUCCESS;
-
-      for (int i = 0; i < procList.size(); i++)
-      {
-         Process *p = procList.get(i);
-         TCHAR szBuff[128];
-         _sntprintf(szBuff, sizeof(szBuff), _T("%d %hs"), p->pid, p->name);
-         value->add(szBuff);
-      }
+      Process *p = snapshot->get(i);
+      TCHAR szBuff[128];
+      _sntprintf(szBuff, 128, _T("%d %hs"), p->pid, p->name);
+      value->add(szBuff);
    }
-   return nRet;
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -606,39 +736,35 @@ LONG H_ProcessTable(const TCHAR *cmd, const TCHAR *arg, Table *value, AbstractCo
    value->addColumn(_T("PAGE_FAULTS"), DCI_DT_UINT64, _T("Page Faults"));
    value->addColumn(_T("CMDLINE"), DCI_DT_STRING, _T("Command Line"));
 
-   int rc = SYSINFO_RC_ERROR;
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
+      return SYSINFO_RC_ERROR;
 
-   ObjectArray<Process> procList(128, 128, Ownership::True);
-   int nCount = ProcRead(&procList, nullptr, nullptr, nullptr, true, true);
-   if (nCount >= 0)
+   uint64_t pageSize = getpagesize();
+   uint64_t ticksPerSecond = sysconf(_SC_CLK_TCK);
+   for (int i = 0; i < snapshot->size(); i++)
    {
-      rc = SYSINFO_RC_SUCCESS;
-
-      uint64_t pageSize = getpagesize();
-      uint64_t ticksPerSecond = sysconf(_SC_CLK_TCK);
-      for (int i = 0; i < procList.size(); i++)
-      {
-         Process *p = procList.get(i);
-         value->addRow();
-         value->set(0, p->pid);
+      Process *p = snapshot->get(i);
+      ObjectArray<FileDescriptor> *fd = snapshot->getHandles(p);
+      value->addRow();
+      value->set(0, p->pid);
 #ifdef UNICODE
-         value->setPreallocated(1, WideStringFromMBString(p->name));
-         value->setPreallocated(2, WideStringFromMBString(p->user));
+      value->setPreallocated(1, WideStringFromMBString(p->name));
+      value->setPreallocated(2, WideStringFromMBString(snapshot->getUser(p)));
 #else
-         value->set(1, p->name);
-         value->set(2, p->user);
+      value->set(1, p->name);
+      value->set(2, snapshot->getUser(p));
 #endif
-         value->set(3, static_cast<uint32_t>(p->threads));
-         value->set(4, static_cast<uint32_t>((p->fd != nullptr) ? p->fd->size() : 0));
-         value->set(5, static_cast<uint64_t>(p->ktime) * 1000 / ticksPerSecond);
-         value->set(6, static_cast<uint64_t>(p->utime) * 1000 / ticksPerSecond);
-         value->set(7, static_cast<uint64_t>(p->vmsize));
-         value->set(8, static_cast<uint64_t>(p->rss) * pageSize);
-         value->set(9, static_cast<uint64_t>(p->minflt) + static_cast<uint64_t>(p->majflt));
-         value->set(10, p->cmdLine);
-      }
+      value->set(3, static_cast<uint32_t>(p->threads));
+      value->set(4, static_cast<uint32_t>((fd != nullptr) ? fd->size() : 0));
+      value->set(5, static_cast<uint64_t>(p->ktime) * 1000 / ticksPerSecond);
+      value->set(6, static_cast<uint64_t>(p->utime) * 1000 / ticksPerSecond);
+      value->set(7, static_cast<uint64_t>(p->vmsize));
+      value->set(8, static_cast<uint64_t>(p->rss) * pageSize);
+      value->set(9, static_cast<uint64_t>(p->minflt) + static_cast<uint64_t>(p->majflt));
+      value->set(10, snapshot->getCommandLine(p));
    }
-   return rc;
+   return SYSINFO_RC_SUCCESS;
 }
 
 /**
@@ -651,35 +777,31 @@ LONG H_OpenFilesTable(const TCHAR *cmd, const TCHAR *arg, Table *value, Abstract
    value->addColumn(_T("HANDLE"), DCI_DT_UINT, _T("Handle"), true);
    value->addColumn(_T("NAME"), DCI_DT_STRING, _T("Name"));
 
-   int rc = SYSINFO_RC_ERROR;
+   shared_ptr<ProcessSnapshot> snapshot = AcquireProcessSnapshot();
+   if (snapshot == nullptr)
+      return SYSINFO_RC_ERROR;
 
-   ObjectArray<Process> procList(128, 128, Ownership::True);
-   int nCount = ProcRead(&procList, nullptr, nullptr, nullptr, true, false);
-   if (nCount >= 0)
+   for (int i = 0; i < snapshot->size(); i++)
    {
-      rc = SYSINFO_RC_SUCCESS;
+      Process *p = snapshot->get(i);
+      ObjectArray<FileDescriptor> *fd = snapshot->getHandles(p);
+      if (fd == nullptr)
+         continue;
 
-      for (int i = 0; i < procList.size(); i++)
+      for (int j = 0; j < fd->size(); j++)
       {
-         Process *p = procList.get(i);
-         if (p->fd != nullptr)
-         {
-            for (int j = 0; j < p->fd->size(); j++)
-            {
-               FileDescriptor *f = p->fd->get(j);
-               value->addRow();
-               value->set(0, p->pid);
-               value->set(2, f->handle);
+         FileDescriptor *f = fd->get(j);
+         value->addRow();
+         value->set(0, p->pid);
+         value->set(2, f->handle);
 #ifdef UNICODE
-               value->setPreallocated(1, WideStringFromMBString(p->name));
-               value->setPreallocated(3, WideStringFromMBString(f->name));
+         value->setPreallocated(1, WideStringFromMBString(p->name));
+         value->setPreallocated(3, WideStringFromMBString(f->name));
 #else
-               value->set(1, p->name);
-               value->set(3, f->name);
+         value->set(1, p->name);
+         value->set(3, f->name);
 #endif
-            }
-         }
       }
    }
-   return rc;
+   return SYSINFO_RC_SUCCESS;
 }
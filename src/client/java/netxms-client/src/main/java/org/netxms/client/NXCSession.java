@@ -172,6 +172,7 @@
 import org.netxms.client.objects.interfaces.NodeItemPair;
 import org.netxms.client.objects.queries.ObjectQuery;
 import org.netxms.client.objects.queries.ObjectQueryResult;
+import org.netxms.client.objects.queries.ObjectQueryResultPage;
 import org.netxms.client.objecttools.ObjectContextBase;
 import org.netxms.client.objecttools.ObjectTool;
 import org.netxms.client.objecttools.ObjectToolDetails;
@@ -3873,6 +3874,28 @@ public List<AbstractObject> queryObjects(String query) throws IOException, NXCEx
     */
    public List<ObjectQueryResult> queryObjectDetails(String query, List<String> properties, List<String> orderBy, Map<String, String> inputFields, boolean readAllComputedProperties, int limit)
          throws IOException, NXCException
+   {
+      return queryObjectDetails(query, properties, orderBy, inputFields, readAllComputedProperties, limit, 0).getResults();
+   }
+
+   /**
+    * Query objects on server side and read certain object properties. Only requested page of sorted result set is returned,
+    * starting at given offset.
+    *
+    * @param query query to execute
+    * @param properties object properties to read
+    * @param orderBy list of properties for ordering result set (can be null)
+    * @param inputFields set of input fields provided by user (can be null)
+    * @param readAllComputedProperties if set to <code>true</code>, query will return all computed properties in addition to
+    *           properties explicitly listed in <code>properties</code> parameter
+    * @param limit limit number of records (0 for unlimited)
+    * @param offset number of matching records to skip
+    * @return requested page of matching objects with total number of matching objects
+    * @throws IOException if socket I/O error occurs
+    * @throws NXCException if NetXMS server returns an error or operation was timed out
+    */
+   public ObjectQueryResultPage queryObjectDetails(String query, List<String> properties, List<String> orderBy, Map<String, String> inputFields, boolean readAllComputedProperties, int limit, int offset)
+         throws IOException, NXCException
    {
       NXCPMessage request = newMessage(NXCPCodes.CMD_QUERY_OBJECT_DETAILS);
       request.setField(NXCPCodes.VID_QUERY, query);
@@ -3883,6 +3906,7 @@ public List<ObjectQueryResult> queryObjectDetails(String query, List<String> pro
       if (inputFields != null)
          request.setFieldsFromStringMap(inputFields, NXCPCodes.VID_INPUT_FIELD_BASE, NXCPCodes.VID_INPUT_FIELD_COUNT);
       request.setFieldInt32(NXCPCodes.VID_RECORD_LIMIT, limit);
+      request.setFieldInt32(NXCPCodes.VID_START_ROW, offset);
       request.setField(NXCPCodes.VID_READ_ALL_FIELDS, readAllComputedProperties);
       sendMessage(request);
 
@@ -3900,7 +3924,11 @@ public List<ObjectQueryResult> queryObjectDetails(String query, List<String> pro
          }
          fieldId += values.size() * 2 + 1;
       }
-      return results;
+
+      // Servers without paging support do not report total number of matching objects
+      int nextOffset = offset + objects.length;
+      int totalCount = response.isFieldPresent(NXCPCodes.VID_NUM_RECORDS) ? response.getFieldAsInt32(NXCPCodes.VID_NUM_RECORDS) : nextOffset;
+      return new ObjectQueryResultPage(results, nextOffset, totalCount);
    }
 
    /**
@@ -0,0 +1,86 @@
+/**
+ * NetXMS - open source network management system
+ * Copyright (C) 2003-2023 Victor Kirhenshtein
+ * <p>
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * <p>
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * <p>
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+package org.netxms.client.objects.queries;
+
+import java.util.List;
+
+/**
+ * Single page of object query results
+ */
+public class ObjectQueryResultPage
+{
+   private List<ObjectQueryResult> results;
+   private int nextOffset;
+   private int totalCount;
+
+   /**
+    * Create new result page.
+    *
+    * @param results results on this page
+    * @param nextOffset offset of first record after this page within full result set
+    * @param totalCount total number of objects matching query
+    */
+   public ObjectQueryResultPage(List<ObjectQueryResult> results, int nextOffset, int totalCount)
+   {
+      this.results = results;
+      this.nextOffset = nextOffset;
+      this.totalCount = totalCount;
+   }
+
+   /**
+    * Get results on this page.
+    *
+    * @return results on this page
+    */
+   public List<ObjectQueryResult> getResults()
+   {
+      return results;
+   }
+
+   /**
+    * Get offset of first record after this page within full result set. Objects not known to client are not included into
+    * results, so this offset can be greater than sum of requested offset and number of results on this page.
+    *
+    * @return offset to be used for requesting next page
+    */
+   public int getNextOffset()
+   {
+      return nextOffset;
+   }
+
+   /**
+    * Get total number of objects matching query.
+    *
+    * @return total number of matching objects
+    */
+   public int getTotalCount()
+   {
+      return totalCount;
+   }
+
+   /**
+    * Check if there are more matching objects after this page.
+    *
+    * @return true if there are more matching objects after this page
+    */
+   public boolean hasMore()
+   {
+      return nextOffset < totalCount;
+   }
+}
@@ -109,6 +109,8 @@ public class AgentConfigEditor extends Composite
       "MaxLogSize",
       "MaxSessions",
       "OfflineDataExpirationTime",
+      "OfflineDataLog",
+      "OfflineDataLogSegmentSize",
       "PlatformSuffix",
       "RequireAuthentication",
       "RequireEncryption",
@@ -80,6 +80,16 @@ struct MARIADB_STATEMENT
 	unsigned long *lengthFields;
 	Array *buffers;
 	int paramCount;
+	char *query;               // Original query (UTF-8)
+	int valuesStart;           // Start of row template in VALUES clause (-1 if batch mode is not supported)
+	int valuesEnd;             // End of row template in VALUES clause
+	bool batchMode;
+	int batchSize;
+	int batchCapacity;
+	MYSQL_BIND *batchBindings;
+	unsigned long *batchLengthFields;
+	MYSQL_STMT *batchStatement; // Cached multi-row statement
+	int batchStatementRows;
 };
 
 /**
@@ -191,6 +191,57 @@ static void Disconnect(DBDRV_CONNECTION connection)
    delete static_cast<MYSQL_CONN*>(connection);
 }
 
+/**
+ * Maximum number of rows in single multi-row INSERT statement
+ */
+#define MAX_ROWS_PER_BATCH_STATEMENT   256
+
+/**
+ * Open batch
+ */
+static bool OpenBatch(DBDRV_STATEMENT hStmt)
+{
+   auto stmt = static_cast<MYSQL_STATEMENT*>(hStmt);
+   if (stmt->valuesStart == -1)
+      return false;
+
+   stmt->batchMode = true;
+   stmt->batchSize = 0;
+   memset(stmt->bindings, 0, sizeof(MYSQL_BIND) * stmt->paramCount);
+   return true;
+}
+
+/**
+ * Save bindings of current row to batch
+ */
+static void SaveBatchRow(MYSQL_STATEMENT *stmt)
+{
+   if (stmt->batchSize > stmt->batchCapacity)
+   {
+      stmt->batchCapacity += 256;
+      stmt->batchBindings = MemReallocArray(stmt->batchBindings, stmt->batchCapacity * stmt->paramCount);
+      stmt->batchLengthFields = MemReallocArray(stmt->batchLengthFields, stmt->batchCapacity * stmt->paramCount);
+   }
+   int offset = (stmt->batchSize - 1) * stmt->paramCount;
+   memcpy(&stmt->batchBindings[offset], stmt->bindings, sizeof(MYSQL_BIND) * stmt->paramCount);
+   memcpy(&stmt->batchLengthFields[offset], stmt->lengthFields, sizeof(unsigned long) * stmt->paramCount);
+   memset(stmt->bindings, 0, sizeof(MYSQL_BIND) * stmt->paramCount);
+}
+
+/**
+ * Start next batch row
+ */
+static void NextBatchRow(DBDRV_STATEMENT hStmt)
+{
+   auto stmt = static_cast<MYSQL_STATEMENT*>(hStmt);
+   if (!stmt->batchMode)
+      return;
+
+   if (stmt->batchSize > 0)
+      SaveBatchRow(stmt);
+   stmt->batchSize++;
+}
+
 /**
  * Prepare statement
  */
@@ -214,6 +265,9 @@ static DBDRV_STATEMENT Prepare(DBDRV_CONNECTION connection, const WCHAR *pwszQue
 			result->bindings = MemAllocArray<MYSQL_BIND>(result->paramCount);
 			result->lengthFields = MemAllocArray<unsigned long>(result->paramCount);
 			result->buffers = new Array(result->paramCount, 16, Ownership::True);
+			result->query = MemCopyStringA(pszQueryUTF8);
+			if ((result->paramCount == 0) || !DrvFindInsertValuesClause(result->query, &result->valuesStart, &result->valuesEnd))
+			   result->valuesStart = -1;
 			*pdwError = DBERR_SUCCESS;
 		}
 		else
@@ -278,7 +332,16 @@ static void Bind(DBDRV_STATEMENT hStmt, int pos, int sqlType, int cType, void *b
 		switch(allocType)
 		{
 			case DB_BIND_STATIC:
-				b->buffer = buffer;
+			   if (statement->batchMode)
+			   {
+			      // Row data should be preserved until batch is executed
+	            b->buffer = MemCopyBlock(buffer, bufferSize[cType]);
+	            statement->buffers->add(b->buffer);
+			   }
+			   else
+			   {
+			      b->buffer = buffer;
+			   }
 				break;
 			case DB_BIND_DYNAMIC:
 				b->buffer = buffer;
@@ -313,15 +376,95 @@ static void Bind(DBDRV_STATEMENT hStmt, int pos, int sqlType, int cType, void *b
 	}
 }
 
+/**
+ * Get connection error code from MySQL error number
+ */
+static inline uint32_t ErrorCodeFromStatement(MYSQL_STMT *stmt)
+{
+   unsigned int err = mysql_stmt_errno(stmt);
+   return ((err == CR_SERVER_LOST) || (err == CR_CONNECTION_ERROR) || (err == CR_SERVER_GONE_ERROR)) ? DBERR_CONNECTION_LOST : DBERR_OTHER_ERROR;
+}
+
+/**
+ * Execute batch as sequence of multi-row INSERT statements. Should be called with connection lock held.
+ */
+static uint32_t ExecuteBatch(MYSQL_CONN *conn, MYSQL_STATEMENT *stmt, WCHAR *errorText)
+{
+   int maxRows = std::min(MAX_ROWS_PER_BATCH_STATEMENT, 65535 / stmt->paramCount);
+   for(int start = 0; start < stmt->batchSize; start += maxRows)
+   {
+      int rows = std::min(maxRows, stmt->batchSize - start);
+      if (stmt->batchStatementRows != rows)
+      {
+         if (stmt->batchStatement != nullptr)
+         {
+            mysql_stmt_close(stmt->batchStatement);
+            stmt->batchStatement = nullptr;
+            stmt->batchStatementRows = 0;
+         }
+
+         MYSQL_STMT *batchStatement = mysql_stmt_init(conn->mysql);
+         if (batchStatement == nullptr)
+         {
+            UpdateErrorMessage("Call to mysql_stmt_init failed", errorText);
+            return DBERR_OTHER_ERROR;
+         }
+
+         ByteStream query(stmt->valuesEnd + (stmt->valuesEnd - stmt->valuesStart + 1) * rows);
+         DrvBuildMultiRowInsert(&query, stmt->query, stmt->valuesStart, stmt->valuesEnd, rows);
+         if (mysql_stmt_prepare(batchStatement, reinterpret_cast<const char*>(query.buffer()), static_cast<unsigned long>(query.size())) != 0)
+         {
+            UpdateErrorMessage(mysql_stmt_error(batchStatement), errorText);
+            uint32_t rc = ErrorCodeFromStatement(batchStatement);
+            mysql_stmt_close(batchStatement);
+            return rc;
+         }
+         stmt->batchStatement = batchStatement;
+         stmt->batchStatementRows = rows;
+      }
+
+      // Length fields should point to batch length array
+      MYSQL_BIND *bindings = &stmt->batchBindings[start * stmt->paramCount];
+      for(int i = 0; i < rows * stmt->paramCount; i++)
+      {
+         if (bindings[i].length != nullptr)
+            bindings[i].length = &stmt->batchLengthFields[start * stmt->paramCount + i];
+      }
+
+      if ((mysql_stmt_bind_param(stmt->batchStatement, bindings) != 0) || (mysql_stmt_execute(stmt->batchStatement) != 0))
+      {
+         UpdateErrorMessage(mysql_stmt_error(stmt->batchStatement), errorText);
+         return ErrorCodeFromStatement(stmt->batchStatement);
+      }
+   }
+   return DBERR_SUCCESS;
+}
+
 /**
  * Execute prepared statement
  */
 static uint32_t Execute(DBDRV_CONNECTION connection, DBDRV_STATEMENT hStmt, WCHAR *errorText)
 {
+   auto statement = static_cast<MYSQL_STATEMENT*>(hStmt);
+   if (statement->batchMode)
+   {
+      uint32_t rc = DBERR_SUCCESS;
+      if (statement->batchSize > 0)
+      {
+         SaveBatchRow(statement);
+         static_cast<MYSQL_CONN*>(connection)->mutexQueryLock.lock();
+         rc = ExecuteBatch(static_cast<MYSQL_CONN*>(connection), statement, errorText);
+         static_cast<MYSQL_CONN*>(connection)->mutexQueryLock.unlock();
+      }
+      statement->batchMode = false;
+      statement->batchSize = 0;
+      statement->buffers->clear();
+      return rc;
+   }
+
    uint32_t rc;
 
    static_cast<MYSQL_CONN*>(connection)->mutexQueryLock.lock();
-   auto statement = static_cast<MYSQL_STATEMENT*>(hStmt);
 	if (mysql_stmt_bind_param(statement->statement, statement->bindings) == 0)
 	{
 		if (mysql_stmt_execute(statement->statement) == 0)
@@ -360,10 +503,15 @@ static void FreeStatement(DBDRV_STATEMENT hStmt)
    auto statement = static_cast<MYSQL_STATEMENT*>(hStmt);
    statement->connection->mutexQueryLock.lock();
    mysql_stmt_close(statement->statement);
+   if (statement->batchStatement != nullptr)
+      mysql_stmt_close(statement->batchStatement);
    statement->connection->mutexQueryLock.unlock();
    delete statement->buffers;
    MemFree(statement->bindings);
    MemFree(statement->lengthFields);
+   MemFree(statement->query);
+   MemFree(statement->batchBindings);
+   MemFree(statement->batchLengthFields);
    MemFree(statement);
 }
 
@@ -1147,8 +1295,8 @@ static DBDriverCallTable s_callTable =
    nullptr, // SetPrefetchLimit
    Prepare,
    FreeStatement,
-   nullptr, // OpenBatch
-   nullptr, // NextBatchRow
+   OpenBatch,
+   NextBatchRow,
    Bind,
    Execute,
    Query,
@@ -37,12 +37,20 @@ static bool UnsafeQuery(PG_CONN *pConn, const char *szQuery, WCHAR *errorText);
 #ifndef _WIN32
 static void *s_libpq = nullptr;
 static int (*s_PQsetSingleRowMode)(PGconn *) = nullptr;
+static int (*s_PQenterPipelineMode)(PGconn *) = nullptr;
+static int (*s_PQexitPipelineMode)(PGconn *) = nullptr;
+static int (*s_PQpipelineSync)(PGconn *) = nullptr;
 #endif
 
 #if !HAVE_DECL_PGRES_SINGLE_TUPLE
 #define PGRES_SINGLE_TUPLE    9
 #endif
 
+#ifndef LIBPQ_HAS_PIPELINING
+#define PGRES_PIPELINE_SYNC      10
+#define PGRES_PIPELINE_ABORTED   11
+#endif
+
 #define DEBUG_TAG _T("db.drv.pgsql")
 
 /**
@@ -90,8 +98,16 @@ static bool Initialize(const char *options)
 #ifndef _WIN32
    s_libpq = dlopen("libpq.so.5", RTLD_NOW);
    if (s_libpq != nullptr)
+   {
       s_PQsetSingleRowMode = (int (*)(PGconn *))dlsym(s_libpq, "PQsetSingleRowMode");
+      s_PQenterPipelineMode = (int (*)(PGconn *))dlsym(s_libpq, "PQenterPipelineMode");
+      s_PQexitPipelineMode = (int (*)(PGconn *))dlsym(s_libpq, "PQexitPipelineMode");
+      s_PQpipelineSync = (int (*)(PGconn *))dlsym(s_libpq, "PQpipelineSync");
+      if ((s_PQenterPipelineMode == nullptr) || (s_PQexitPipelineMode == nullptr) || (s_PQpipelineSync == nullptr))
+         s_PQenterPipelineMode = nullptr;
+   }
    nxlog_debug_tag(DEBUG_TAG, 2, _T("PostgreSQL driver: single row mode %s"), (s_PQsetSingleRowMode != NULL) ? _T("enabled") : _T("disabled"));
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("PostgreSQL driver: pipeline mode %s"), (s_PQenterPipelineMode != NULL) ? _T("enabled") : _T("disabled"));
 #endif
 	return true;
 }
@@ -312,6 +328,101 @@ static DBDRV_STATEMENT Prepare(DBDRV_CONNECTION connection, const WCHAR *query,
 	return hStmt;
 }
 
+/**
+ * Check if pipeline mode is supported by client library
+ */
+static inline bool IsPipelineModeSupported()
+{
+#ifdef _WIN32
+#ifdef LIBPQ_HAS_PIPELINING
+   return true;
+#else
+   return false;
+#endif
+#else
+   return s_PQenterPipelineMode != nullptr;
+#endif
+}
+
+/**
+ * Enter pipeline mode
+ */
+static inline bool EnterPipelineMode(PGconn *conn)
+{
+#ifdef _WIN32
+#ifdef LIBPQ_HAS_PIPELINING
+   return PQenterPipelineMode(conn) != 0;
+#else
+   return false;
+#endif
+#else
+   return s_PQenterPipelineMode(conn) != 0;
+#endif
+}
+
+/**
+ * Exit pipeline mode
+ */
+static inline void ExitPipelineMode(PGconn *conn)
+{
+#ifdef _WIN32
+#ifdef LIBPQ_HAS_PIPELINING
+   PQexitPipelineMode(conn);
+#endif
+#else
+   s_PQexitPipelineMode(conn);
+#endif
+}
+
+/**
+ * Send pipeline synchronization point
+ */
+static inline bool PipelineSync(PGconn *conn)
+{
+#ifdef _WIN32
+#ifdef LIBPQ_HAS_PIPELINING
+   return PQpipelineSync(conn) != 0;
+#else
+   return false;
+#endif
+#else
+   return s_PQpipelineSync(conn) != 0;
+#endif
+}
+
+/**
+ * Open batch. Batch is executed using pipeline mode, so it is only supported with libpq 14 or higher.
+ */
+static bool OpenBatch(DBDRV_STATEMENT hStmt)
+{
+   if (!IsPipelineModeSupported())
+      return false;
+
+   auto stmt = static_cast<PG_STATEMENT*>(hStmt);
+   stmt->batchRows.clear();
+   stmt->buffers.clear();
+   stmt->batchMode = true;
+   stmt->batchSize = 0;
+   return true;
+}
+
+/**
+ * Start next batch row
+ */
+static void NextBatchRow(DBDRV_STATEMENT hStmt)
+{
+   auto stmt = static_cast<PG_STATEMENT*>(hStmt);
+   if (!stmt->batchMode)
+      return;
+
+   if (stmt->batchSize > 0)
+   {
+      stmt->batchRows.push_back(std::move(stmt->buffers));
+      stmt->buffers.clear();
+   }
+   stmt->batchSize++;
+}
+
 /**
  * Bind parameter to prepared statement
  */
@@ -379,6 +490,123 @@ static void Bind(DBDRV_STATEMENT hStmt, int pos, int sqlType, int cType, void *b
 		MemFree(buffer);
 }
 
+/**
+ * Set error text from failed result
+ */
+static void SetErrorText(WCHAR *errorText, PG_CONN *conn, PGresult *result)
+{
+   if (errorText == nullptr)
+      return;
+
+   utf8_to_wchar(CHECK_NULL_EX_A(PQresultErrorField(result, PG_DIAG_SQLSTATE)), -1, errorText, DBDRV_MAX_ERROR_TEXT);
+   int len = (int)wcslen(errorText);
+   if (len > 0)
+   {
+      errorText[len] = L' ';
+      len++;
+   }
+   const char *message = PQresultErrorMessage(result);
+   utf8_to_wchar(((message != nullptr) && (*message != 0)) ? message : PQerrorMessage(conn->handle), -1, &errorText[len], DBDRV_MAX_ERROR_TEXT - len);
+   errorText[DBDRV_MAX_ERROR_TEXT - 1] = 0;
+   RemoveTrailingCRLFW(errorText);
+}
+
+/**
+ * Set error text from connection error message
+ */
+static void SetConnectionErrorText(WCHAR *errorText, PG_CONN *conn)
+{
+   if (errorText == nullptr)
+      return;
+
+   utf8_to_wchar(PQerrorMessage(conn->handle), -1, errorText, DBDRV_MAX_ERROR_TEXT);
+   errorText[DBDRV_MAX_ERROR_TEXT - 1] = 0;
+   RemoveTrailingCRLFW(errorText);
+}
+
+/**
+ * Execute prepared statement in batch mode. All rows are sent in pipeline mode followed by single synchronization
+ * point, so outside of explicit transaction whole batch is executed in one implicit transaction and either applied
+ * completely or not applied at all. Should be called with connection lock held.
+ */
+static uint32_t ExecuteBatch(PG_CONN *conn, PG_STATEMENT *stmt, WCHAR *errorText)
+{
+   if (!EnterPipelineMode(conn->handle))
+   {
+      if (errorText != nullptr)
+         wcslcpy(errorText, L"Internal error (call to PQenterPipelineMode failed)", DBDRV_MAX_ERROR_TEXT);
+      return (PQstatus(conn->handle) == CONNECTION_BAD) ? DBERR_CONNECTION_LOST : DBERR_OTHER_ERROR;
+   }
+
+   uint32_t rc = DBERR_SUCCESS;
+   char **values = nullptr;
+   size_t valuesSize = 0;
+   for(size_t i = 0; i < stmt->batchRows.size(); i++)
+   {
+      std::vector<Buffer<char>>& row = stmt->batchRows[i];
+      if (row.size() > valuesSize)
+      {
+         valuesSize = row.size();
+         values = MemReallocArray(values, valuesSize);
+      }
+      for(size_t j = 0; j < row.size(); j++)
+         values[j] = row[j].buffer();
+
+      int success = (stmt->name[0] != 0) ?
+         PQsendQueryPrepared(conn->handle, stmt->name, static_cast<int>(row.size()), values, nullptr, nullptr, 0) :
+         PQsendQueryParams(conn->handle, stmt->query, static_cast<int>(row.size()), nullptr, values, nullptr, nullptr, 0);
+      if (!success)
+      {
+         // Remaining rows are not sent; statements already in pipeline are synchronized and their results drained below
+         SetConnectionErrorText(errorText, conn);
+         rc = (PQstatus(conn->handle) == CONNECTION_BAD) ? DBERR_CONNECTION_LOST : DBERR_OTHER_ERROR;
+         break;
+      }
+   }
+   MemFree(values);
+
+   if (PipelineSync(conn->handle))
+   {
+      // Read results up to synchronization point (each statement result is followed by nullptr)
+      int nullCount = 0;
+      while(true)
+      {
+         PGresult *result = PQgetResult(conn->handle);
+         if (result == nullptr)
+         {
+            if (++nullCount > 1)
+               break;   // Should not happen - protection against waiting for sync that was never sent
+            continue;
+         }
+         nullCount = 0;
+
+         ExecStatusType status = PQresultStatus(result);
+         if (status == PGRES_PIPELINE_SYNC)
+         {
+            PQclear(result);
+            break;
+         }
+         if ((status != PGRES_COMMAND_OK) && (status != PGRES_TUPLES_OK) && (rc == DBERR_SUCCESS))
+         {
+            // Only first error is reported, following statements will be aborted by server
+            SetErrorText(errorText, conn, result);
+            rc = (PQstatus(conn->handle) == CONNECTION_BAD) ? DBERR_CONNECTION_LOST : DBERR_OTHER_ERROR;
+         }
+         PQclear(result);
+      }
+   }
+   else if (rc == DBERR_SUCCESS)
+   {
+      SetConnectionErrorText(errorText, conn);
+      rc = (PQstatus(conn->handle) == CONNECTION_BAD) ? DBERR_CONNECTION_LOST : DBERR_OTHER_ERROR;
+   }
+
+   ExitPipelineMode(conn->handle);
+   if ((rc == DBERR_SUCCESS) && (errorText != nullptr))
+      *errorText = 0;
+   return rc;
+}
+
 /**
  * Execute prepared statement
  */
@@ -387,6 +615,27 @@ static uint32_t Execute(DBDRV_CONNECTION connection, DBDRV_STATEMENT hStmt, WCHA
 	uint32_t rc;
    auto stmt = static_cast<PG_STATEMENT*>(hStmt);
 
+   if (stmt->batchMode)
+   {
+      if (stmt->batchSize > 0)
+      {
+         stmt->batchRows.push_back(std::move(stmt->buffers));
+         stmt->buffers.clear();
+
+         static_cast<PG_CONN*>(connection)->mutexQueryLock.lock();
+         rc = ExecuteBatch(static_cast<PG_CONN*>(connection), stmt, errorText);
+         static_cast<PG_CONN*>(connection)->mutexQueryLock.unlock();
+      }
+      else
+      {
+         rc = DBERR_SUCCESS;  // empty batch
+      }
+      stmt->batchMode = false;
+      stmt->batchSize = 0;
+      stmt->batchRows.clear();
+      return rc;
+   }
+
    char **values = static_cast<char**>(MemAllocLocal(stmt->buffers.size() * sizeof(char*)));
    for(int i = 0; i < stmt->buffers.size(); i++)
       values[i] = stmt->buffers[i].buffer();
@@ -1176,8 +1425,8 @@ static DBDriverCallTable s_callTable =
    nullptr, // SetPrefetchLimit
    Prepare,
    FreeStatement,
-   nullptr, // OpenBatch
-   nullptr, // NextBatchRow
+   OpenBatch,
+   NextBatchRow,
    Bind,
    Execute,
    Query,
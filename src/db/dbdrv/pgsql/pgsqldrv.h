@@ -69,11 +69,16 @@ struct PG_STATEMENT
 	char name[64];
    char *query;
 	std::vector<Buffer<char>> buffers;
+	std::vector<std::vector<Buffer<char>>> batchRows;
+	bool batchMode;
+	int batchSize;
 
 	PG_STATEMENT(PG_CONN *c)
 	{
 	   connection = c;
 	   query = nullptr;
+	   batchMode = false;
+	   batchSize = 0;
 	}
 
 	~PG_STATEMENT()
@@ -16,7 +16,6 @@ static int s_numTcpSockets = 0;
 static SOCKET *s_tcpSockets = NULL;
 static int s_numUdpSockets = 0;
 static SOCKET *s_udpSockets = NULL;
-static INT64 s_flowId = 1;
 
 
 //
@@ -69,36 +68,94 @@ static INT64 Int64FromData(void *data, int len)
 }
 
 
-//
-// Handler for data record
-//
+/**
+ * Get unsigned integer value from data field (already converted to host byte order by decoder)
+ */
+static uint64_t UInt64FromData(const void *data, int len)
+{
+   switch(len)
+   {
+      case 1:
+         return *static_cast<const uint8_t*>(data);
+      case 2:
+         uint16_t v16;
+         memcpy(&v16, data, 2);
+         return v16;
+      case 4:
+         uint32_t v32;
+         memcpy(&v32, data, 4);
+         return v32;
+      case 8:
+         uint64_t v64;
+         memcpy(&v64, data, 8);
+         return v64;
+      default:
+         return 0;
+   }
+}
 
+/**
+ * Mapping between IPFIX fields and database columns
+ */
 static struct
 {
 	int ipfixField;
 	const TCHAR *dbField;
+	bool numeric;
 } s_fieldMapping[] =
 {
-	{ IPFIX_FT_EXPORTERIPV4ADDRESS, _T("exporter_ip_addr") },
-	{ IPFIX_FT_SOURCEMACADDRESS, _T("source_mac_addr") },
-	{ IPFIX_FT_DESTINATIONMACADDRESS, _T("dest_mac_addr") },
-	{ IPFIX_FT_SOURCEIPV4ADDRESS, _T("source_ip_addr") },
-	{ IPFIX_FT_DESTINATIONIPV4ADDRESS, _T("dest_ip_addr") },
-	{ IPFIX_FT_PROTOCOLIDENTIFIER, _T("ip_proto") },
-	{ IPFIX_FT_SOURCETRANSPORTPORT, _T("source_ip_port") },
-	{ IPFIX_FT_DESTINATIONTRANSPORTPORT, _T("dest_ip_port") },
-	{ IPFIX_FT_OCTETDELTACOUNT, _T("octet_count") },
-	{ IPFIX_FT_PACKETDELTACOUNT, _T("packet_count") },
-	{ IPFIX_FT_INGRESSINTERFACE, _T("ingress_interface") },
-	{ IPFIX_FT_EGRESSINTERFACE, _T("egress_interface") },
-	{ 0, NULL }
+	{ IPFIX_FT_EXPORTERIPV4ADDRESS, _T("exporter_ip_addr"), false },
+	{ IPFIX_FT_SOURCEMACADDRESS, _T("source_mac_addr"), false },
+	{ IPFIX_FT_DESTINATIONMACADDRESS, _T("dest_mac_addr"), false },
+	{ IPFIX_FT_SOURCEIPV4ADDRESS, _T("source_ip_addr"), false },
+	{ IPFIX_FT_DESTINATIONIPV4ADDRESS, _T("dest_ip_addr"), false },
+	{ IPFIX_FT_PROTOCOLIDENTIFIER, _T("ip_proto"), true },
+	{ IPFIX_FT_SOURCETRANSPORTPORT, _T("source_ip_port"), true },
+	{ IPFIX_FT_DESTINATIONTRANSPORTPORT, _T("dest_ip_port"), true },
+	{ IPFIX_FT_OCTETDELTACOUNT, _T("octet_count"), true },
+	{ IPFIX_FT_PACKETDELTACOUNT, _T("packet_count"), true },
+	{ IPFIX_FT_INGRESSINTERFACE, _T("ingress_interface"), true },
+	{ IPFIX_FT_EGRESSINTERFACE, _T("egress_interface"), true },
+	{ 0, nullptr, false }
 };
 
+/**
+ * Get database column name for mapped field
+ */
+const TCHAR *GetFlowFieldColumnName(int index)
+{
+   return s_fieldMapping[index].dbField;
+}
+
+/**
+ * Check if mapped field is numeric
+ */
+bool IsFlowFieldNumeric(int index)
+{
+   return s_fieldMapping[index].numeric;
+}
+
+/**
+ * Get exporter IPv4 address
+ */
+static uint32_t GetExporterAddress(ipfixs_node_t *node)
+{
+   if ((node->input == nullptr) || (node->input->type != IPFIX_INPUT_IPCON) ||
+       (node->input->u.ipcon.addr == nullptr) || (node->input->u.ipcon.addr->sa_family != AF_INET))
+      return 0;
+   return ntohl(reinterpret_cast<struct sockaddr_in*>(node->input->u.ipcon.addr)->sin_addr.s_addr);
+}
+
+/**
+ * Handler for data record. Record is decoded into typed values and passed to writer queue.
+ */
 static int H_DataRecord(ipfixs_node_t *node, ipfixt_node_t *trec, ipfix_datarecord_t *data, void *arg) 
 {
-	StringBuffer fields, values;
-	char buffer[256];
-	INT64 flowStartTime = 0, flowEndTime = 0;
+   FlowRecord *record = new FlowRecord;
+   record->exporter = GetExporterAddress(node);
+   record->startTime = 0;
+   record->endTime = 0;
+   record->fieldMask = 0;
 
 	for(int i = 0; i < trec->ipfixt->nfields; i++)
 	{
@@ -107,53 +164,54 @@ static int H_DataRecord(ipfixs_node_t *node, ipfixt_node_t *trec, ipfix_datareco
 		{
 			case IPFIX_FT_FLOWSTARTSYSUPTIME:
 				if (node->boot_time != 0)
-					flowStartTime = node->boot_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
+				   record->startTime = node->boot_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
 				break;
 			case IPFIX_FT_FLOWENDSYSUPTIME:
 				if (node->boot_time != 0)
-					flowEndTime = node->boot_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
+				   record->endTime = node->boot_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
 				break;
 			case IPFIX_FT_FLOWSTARTSECONDS:
-				flowStartTime = Int64FromData(data->addrs[i], data->lens[i]) * 1000;
+			   record->startTime = Int64FromData(data->addrs[i], data->lens[i]) * 1000;
 				break;
 			case IPFIX_FT_FLOWENDSECONDS:
-				flowEndTime = Int64FromData(data->addrs[i], data->lens[i]) * 1000;
+			   record->endTime = Int64FromData(data->addrs[i], data->lens[i]) * 1000;
 				break;
 			case IPFIX_FT_FLOWSTARTMILLISECONDS:
-				flowStartTime = Int64FromData(data->addrs[i], data->lens[i]);
+			   record->startTime = Int64FromData(data->addrs[i], data->lens[i]);
 				break;
 			case IPFIX_FT_FLOWENDMILLISECONDS:
-				flowEndTime = Int64FromData(data->addrs[i], data->lens[i]);
+			   record->endTime = Int64FromData(data->addrs[i], data->lens[i]);
 				break;
 			case IPFIX_FT_FLOWSTARTMICROSECONDS:
-				flowStartTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000;
+			   record->startTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000;
 				break;
 			case IPFIX_FT_FLOWENDMICROSECONDS:
-				flowEndTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000;
+			   record->endTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000;
 				break;
 			case IPFIX_FT_FLOWSTARTNANOSECONDS:
-				flowStartTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000000;
+			   record->startTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000000;
 				break;
 			case IPFIX_FT_FLOWENDNANOSECONDS:
-				flowEndTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000000;
+			   record->endTime = Int64FromData(data->addrs[i], data->lens[i]) / 1000000;
 				break;
 			case IPFIX_FT_FLOWSTARTDELTAMICROSECONDS:
 				if (node->export_time != 0)
-					flowStartTime = node->export_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
+				   record->startTime = node->export_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
 				break;
 			case IPFIX_FT_FLOWENDDELTAMICROSECONDS:
 				if (node->export_time != 0)
-					flowEndTime = node->export_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
+				   record->endTime = node->export_time * 1000 + Int64FromData(data->addrs[i], data->lens[i]);
 				break;
 			default:
-				for(int j = 0; s_fieldMapping[j].dbField != NULL; j++)
+				for(int j = 0; s_fieldMapping[j].dbField != nullptr; j++)
 				{
 					if (ftype == s_fieldMapping[j].ipfixField)
 					{
-						fields += _T(",");
-						fields += s_fieldMapping[j].dbField;
-						trec->ipfixt->fields[i].elem->snprint(buffer, sizeof(buffer), data->addrs[i], data->lens[i]);
-						values.appendFormattedString(_T(",'%hs'"), buffer);
+					   record->fieldMask |= (1 << j);
+					   if (s_fieldMapping[j].numeric)
+					      record->values[j].numeric = UInt64FromData(data->addrs[i], data->lens[i]);
+					   else
+					      trec->ipfixt->fields[i].elem->snprint(record->values[j].text, sizeof(record->values[j].text), data->addrs[i], data->lens[i]);
 						break;
 					}
 				}
@@ -161,20 +219,13 @@ static int H_DataRecord(ipfixs_node_t *node, ipfixt_node_t *trec, ipfix_datareco
 		}
 	}
 
-	if (!fields.isEmpty() && (flowStartTime != 0) && (flowEndTime != 0))
-	{
-		StringBuffer query = _T("INSERT INTO flows (flow_id,start_time,end_time");
-		query += (const TCHAR *)fields;
-		query.appendFormattedString(_T(") VALUES (") INT64_FMT _T(",") INT64_FMT _T(",") INT64_FMT, s_flowId++, flowStartTime, flowEndTime);
-		query += (const TCHAR *)values;
-		query += _T(")");
-
-		DBQuery(g_dbConnection, query);
-	}
+	if ((record->fieldMask != 0) && (record->startTime != 0) && (record->endTime != 0))
+	   EnqueueFlowRecord(record);
+	else
+	   delete record;
 	return 0;
 }
 
-
 //
 // Close collectors
 //
@@ -215,14 +266,6 @@ static THREAD_RESULT THREAD_CALL CollectorThread(void *arg)
  */
 bool StartCollector()
 {
-	// Initialize flow ID
-	DB_RESULT hResult = DBSelect(g_dbConnection, _T("SELECT max(flow_id) FROM flows"));
-	if (hResult != NULL)
-	{
-		s_flowId = DBGetFieldInt64(hResult, 0, 0) + 1;
-		DBFreeResult(hResult);
-	}
-
 	s_collectorInfo = (ipfix_col_info_t *)malloc(sizeof(ipfix_col_info_t));
 	s_collectorInfo->export_newsource = NULL;
 	s_collectorInfo->export_newmsg = H_NewMessage;
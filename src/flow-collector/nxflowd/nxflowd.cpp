@@ -36,6 +36,8 @@ DWORD g_tcpPort = IPFIX_DEFAULT_PORT;
 DWORD g_udpPort = IPFIX_DEFAULT_PORT;
 DB_DRIVER g_dbDriverHandle = NULL;
 DB_HANDLE g_dbConnection = NULL;
+int32_t g_writerQueueSize = 100000;
+int32_t g_writerBatchSize = 1000;
 #ifdef _WIN32
 TCHAR g_configFile[MAX_PATH] = _T("C:\\nxflowd.conf");
 TCHAR g_logFile[MAX_PATH] = _T("C:\\nxflowd.log");
@@ -76,6 +78,8 @@ static NX_CFG_TEMPLATE m_cfgTemplate[] =
    { _T("ListenPortUDP"), CT_LONG, 0, 0, 0, 0, &g_udpPort },
    { _T("LogFile"), CT_STRING, 0, 0, MAX_PATH, 0, g_logFile },
    { _T("LogFailedSQLQueries"), CT_BOOLEAN_FLAG_32, 0, 0, AF_LOG_SQL_ERRORS, 0, &g_flags },
+   { _T("WriterBatchSize"), CT_LONG, 0, 0, 0, 0, &g_writerBatchSize },
+   { _T("WriterQueueSize"), CT_LONG, 0, 0, 0, 0, &g_writerQueueSize },
    { _T("LogFile"), CT_STRING, 0, 0, MAX_PATH, 0, g_logFile },
    { _T(""), CT_END_OF_LIST, 0, 0, 0, 0, NULL }
 };
@@ -161,6 +165,12 @@ bool Initialize()
 	}
 	nxlog_debug(1, _T("Successfully connected to database %s@%s"), s_dbName, s_dbServer);
 
+	if (g_writerBatchSize < 1)
+	   g_writerBatchSize = 1;
+	if (g_writerQueueSize < 1)
+	   g_writerQueueSize = 1;
+	StartFlowWriter();
+
 	if (!StartCollector())
 		return false;
 
@@ -176,6 +186,7 @@ void Shutdown()
    g_flags |= AF_SHUTDOWN;
 
 	WaitForCollectorThread();
+	StopFlowWriter();
 
 	ipfix_cleanup();
    nxlog_close();
@@ -9,6 +9,7 @@
 #include <nms_common.h>
 #include <nms_util.h>
 #include <nms_threads.h>
+#include <nxqueue.h>
 #include <nxdbapi.h>
 #include <ipfix.h>
 #include <ipfix_col.h>
@@ -39,6 +40,27 @@
 #define AF_LOG_SQL_ERRORS  0x00000008
 #define AF_SHUTDOWN        0x01000000
 
+/**
+ * Maximum number of mapped flow fields
+ */
+#define MAX_FLOW_FIELDS    16
+
+/**
+ * Decoded flow record
+ */
+struct FlowRecord
+{
+   uint32_t exporter;      // Exporter IPv4 address
+   int64_t startTime;
+   int64_t endTime;
+   uint32_t fieldMask;     // Bit mask of fields present in record (bit position is index in field mapping table)
+   union
+   {
+      uint64_t numeric;
+      char text[48];
+   } values[MAX_FLOW_FIELDS];
+};
+
 
 //
 // Functions
@@ -50,6 +72,12 @@ void Main();
 
 bool StartCollector();
 void WaitForCollectorThread();
+const TCHAR *GetFlowFieldColumnName(int index);
+bool IsFlowFieldNumeric(int index);
+
+void StartFlowWriter();
+void StopFlowWriter();
+void EnqueueFlowRecord(FlowRecord *record);
 
 #ifdef _WIN32
 void InitService();
@@ -75,5 +103,7 @@ extern TCHAR g_configFile[];
 extern TCHAR g_logFile[];
 extern int g_debugLevel;
 extern DB_HANDLE g_dbConnection;
+extern int32_t g_writerQueueSize;
+extern int32_t g_writerBatchSize;
 
 #endif
@@ -0,0 +1,343 @@
+/*
+** nxflowd - NetXMS Flow Collector Daemon
+** Copyright (c) 2009-2023 Raden Solutions
+*/
+
+#include "nxflowd.h"
+
+/**
+ * Flow record queue (created on writer start because capacity is configurable)
+ */
+static BoundedObjectQueue<FlowRecord> *s_writerQueue = nullptr;
+
+/**
+ * Writer thread handle
+ */
+static THREAD s_writerThread = INVALID_THREAD_HANDLE;
+
+/**
+ * Next flow ID
+ */
+static int64_t s_flowId = 1;
+
+/**
+ * Exporter statistics
+ */
+struct ExporterStatistics
+{
+   uint64_t received;
+   uint64_t dropped;
+   uint64_t written;
+   uint64_t failed;
+};
+
+/**
+ * Per-exporter statistics (key is exporter IPv4 address)
+ */
+static HashMap<uint32_t, ExporterStatistics> s_exporterStatistics(Ownership::True);
+static Mutex s_exporterStatisticsLock(MutexType::FAST);
+
+/**
+ * Get statistics entry for exporter. Should be called with statistics lock held.
+ */
+static ExporterStatistics *GetExporterStatistics(uint32_t exporter)
+{
+   ExporterStatistics *s = s_exporterStatistics.get(exporter);
+   if (s == nullptr)
+   {
+      s = MemAllocStruct<ExporterStatistics>();
+      s_exporterStatistics.set(exporter, s);
+   }
+   return s;
+}
+
+/**
+ * Queue flow record for writing. Record is dropped if writer queue is full, so collector thread never blocks on database.
+ * Takes ownership of record.
+ */
+void EnqueueFlowRecord(FlowRecord *record)
+{
+   bool accepted = s_writerQueue->tryPut(record);
+
+   s_exporterStatisticsLock.lock();
+   ExporterStatistics *s = GetExporterStatistics(record->exporter);
+   s->received++;
+   if (!accepted)
+      s->dropped++;
+   s_exporterStatisticsLock.unlock();
+
+   if (!accepted)
+      delete record;
+}
+
+/**
+ * Update exporter statistics after write
+ */
+static void UpdateWriteStatistics(FlowRecord **records, int count, bool success)
+{
+   s_exporterStatisticsLock.lock();
+   for(int i = 0; i < count; i++)
+   {
+      ExporterStatistics *s = GetExporterStatistics(records[i]->exporter);
+      if (success)
+         s->written++;
+      else
+         s->failed++;
+   }
+   s_exporterStatisticsLock.unlock();
+}
+
+/**
+ * Write exporter statistics to log
+ */
+static void LogExporterStatistics()
+{
+   nxlog_debug(4, _T("Flow writer queue size: %u"), static_cast<unsigned int>(s_writerQueue->size()));
+   s_exporterStatisticsLock.lock();
+   s_exporterStatistics.forEach(
+      [] (const uint32_t& exporter, ExporterStatistics *s) -> EnumerationCallbackResult
+      {
+         TCHAR addr[16];
+         nxlog_debug(4, _T("Exporter %s: received=") UINT64_FMT _T(" dropped=") UINT64_FMT _T(" written=") UINT64_FMT _T(" failed=") UINT64_FMT,
+                  IpToStr(exporter, addr), s->received, s->dropped, s->written, s->failed);
+         return _CONTINUE;
+      });
+   s_exporterStatisticsLock.unlock();
+}
+
+/**
+ * Prepared INSERT statement for specific set of fields
+ */
+class FlowInsertStatement
+{
+private:
+   DB_STATEMENT m_hStmt;
+
+public:
+   FlowInsertStatement(DB_STATEMENT hStmt) { m_hStmt = hStmt; }
+   ~FlowInsertStatement() { DBFreeStatement(m_hStmt); }
+
+   DB_STATEMENT handle() { return m_hStmt; }
+};
+
+/**
+ * Prepared statements (key is field mask)
+ */
+static HashMap<uint32_t, FlowInsertStatement> s_statements(Ownership::True);
+
+/**
+ * Get prepared statement for given field mask
+ */
+static DB_STATEMENT GetInsertStatement(uint32_t fieldMask)
+{
+   FlowInsertStatement *s = s_statements.get(fieldMask);
+   if (s != nullptr)
+      return s->handle();
+
+   StringBuffer query = _T("INSERT INTO flows (flow_id,start_time,end_time");
+   int count = 0;
+   for(int i = 0; i < MAX_FLOW_FIELDS; i++)
+   {
+      if (fieldMask & (1 << i))
+      {
+         query.append(_T(','));
+         query.append(GetFlowFieldColumnName(i));
+         count++;
+      }
+   }
+   query.append(_T(") VALUES (?,?,?"));
+   for(int i = 0; i < count; i++)
+      query.append(_T(",?"));
+   query.append(_T(')'));
+
+   DB_STATEMENT hStmt = DBPrepare(g_dbConnection, query, true);
+   if (hStmt == nullptr)
+      return nullptr;
+
+   s_statements.set(fieldMask, new FlowInsertStatement(hStmt));
+   return hStmt;
+}
+
+/**
+ * Bind flow record to prepared statement
+ */
+static void BindFlowRecord(DB_STATEMENT hStmt, FlowRecord *record)
+{
+   DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, s_flowId++);
+   DBBind(hStmt, 2, DB_SQLTYPE_BIGINT, record->startTime);
+   DBBind(hStmt, 3, DB_SQLTYPE_BIGINT, record->endTime);
+   int pos = 4;
+   for(int i = 0; i < MAX_FLOW_FIELDS; i++)
+   {
+      if (!(record->fieldMask & (1 << i)))
+         continue;
+      if (IsFlowFieldNumeric(i))
+         DBBind(hStmt, pos++, DB_SQLTYPE_BIGINT, record->values[i].numeric);
+      else
+         DBBind(hStmt, pos++, DB_SQLTYPE_VARCHAR, DB_CTYPE_UTF8_STRING, record->values[i].text, DB_BIND_STATIC);
+   }
+}
+
+/**
+ * Write records with same field set
+ */
+static bool WriteFlowRecords(FlowRecord **records, int count)
+{
+   DB_STATEMENT hStmt = GetInsertStatement(records[0]->fieldMask);
+   if (hStmt == nullptr)
+      return false;
+
+   bool success = true;
+   if (DBOpenBatch(hStmt))
+   {
+      for(int i = 0; i < count; i++)
+      {
+         DBNextBatchRow(hStmt);
+         BindFlowRecord(hStmt, records[i]);
+      }
+      success = DBExecute(hStmt);
+   }
+   else
+   {
+      for(int i = 0; (i < count) && success; i++)
+      {
+         BindFlowRecord(hStmt, records[i]);
+         success = DBExecute(hStmt);
+      }
+   }
+   return success;
+}
+
+/**
+ * Compare flow records by field mask
+ */
+static int CompareFlowRecords(const void *r1, const void *r2)
+{
+   uint32_t m1 = (*static_cast<FlowRecord* const*>(r1))->fieldMask;
+   uint32_t m2 = (*static_cast<FlowRecord* const*>(r2))->fieldMask;
+   return (m1 < m2) ? -1 : ((m1 > m2) ? 1 : 0);
+}
+
+/**
+ * Write batch of flow records in single transaction
+ */
+static void WriteBatch(FlowRecord **records, int count)
+{
+   // Group records by field set so each group uses single prepared statement
+   qsort(records, count, sizeof(FlowRecord*), CompareFlowRecords);
+
+   DBBegin(g_dbConnection);
+   bool success = true;
+   int start = 0;
+   while((start < count) && success)
+   {
+      int end = start + 1;
+      while((end < count) && (records[end]->fieldMask == records[start]->fieldMask))
+         end++;
+      success = WriteFlowRecords(&records[start], end - start);
+      start = end;
+   }
+
+   if (success)
+   {
+      DBCommit(g_dbConnection);
+      UpdateWriteStatistics(records, count, true);
+   }
+   else
+   {
+      DBRollback(g_dbConnection);
+
+      // Retry records one by one outside of transaction, so only records that cannot be written are lost
+      int failed = 0;
+      for(int i = 0; i < count; i++)
+      {
+         DB_STATEMENT hStmt = GetInsertStatement(records[i]->fieldMask);
+         bool written = false;
+         if (hStmt != nullptr)
+         {
+            BindFlowRecord(hStmt, records[i]);
+            written = DBExecute(hStmt);
+         }
+         if (!written)
+            failed++;
+         UpdateWriteStatistics(&records[i], 1, written);
+      }
+      nxlog_debug(3, _T("Failed to write batch of %d flow records (%d records rejected when written individually)"), count, failed);
+   }
+
+   for(int i = 0; i < count; i++)
+      delete records[i];
+}
+
+/**
+ * Writer thread
+ */
+static void WriterThread()
+{
+   nxlog_debug(1, _T("Flow writer thread started"));
+
+   FlowRecord **batch = MemAllocArray<FlowRecord*>(g_writerBatchSize);
+   time_t lastStatReport = time(nullptr);
+   while(true)
+   {
+      FlowRecord *record = s_writerQueue->getOrBlock(1000);
+      if (record == INVALID_POINTER_VALUE)
+         break;
+
+      if (record != nullptr)
+      {
+         batch[0] = record;
+         int count = static_cast<int>(s_writerQueue->getAll(&batch[1], g_writerBatchSize - 1)) + 1;
+
+         // Shutdown marker can only be the last element taken from queue
+         bool stop = (batch[count - 1] == INVALID_POINTER_VALUE);
+         if (stop)
+            count--;
+         if (count > 0)
+            WriteBatch(batch, count);
+         if (stop)
+            break;
+      }
+
+      time_t now = time(nullptr);
+      if (now - lastStatReport >= 60)
+      {
+         LogExporterStatistics();
+         lastStatReport = now;
+      }
+   }
+   MemFree(batch);
+
+   s_statements.clear();
+   LogExporterStatistics();
+   nxlog_debug(1, _T("Flow writer thread stopped"));
+}
+
+/**
+ * Start flow writer
+ */
+void StartFlowWriter()
+{
+   // Initialize flow ID
+   DB_RESULT hResult = DBSelect(g_dbConnection, _T("SELECT max(flow_id) FROM flows"));
+   if (hResult != nullptr)
+   {
+      s_flowId = DBGetFieldInt64(hResult, 0, 0) + 1;
+      DBFreeResult(hResult);
+   }
+
+   s_writerQueue = new BoundedObjectQueue<FlowRecord>(g_writerQueueSize, Ownership::True);
+   s_writerThread = ThreadCreateEx(WriterThread);
+}
+
+/**
+ * Stop flow writer. All queued records will be written before writer thread exits.
+ */
+void StopFlowWriter()
+{
+   s_writerQueue->put(static_cast<FlowRecord*>(INVALID_POINTER_VALUE));
+   ThreadJoin(s_writerThread);
+   s_writerThread = INVALID_THREAD_HANDLE;
+   delete s_writerQueue;
+   s_writerQueue = nullptr;
+}
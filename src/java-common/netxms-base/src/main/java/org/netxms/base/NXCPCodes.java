@@ -1296,6 +1296,7 @@
    public static final long VID_MONITOR_ID = 811;
    public static final long VID_NUM_TIME_FRAMES = 812;
    public static final long VID_NUM_POLL_STATES = 813;
+   public static final long VID_SYSLOG_BATCHING = 814;
 
 	public static final long VID_ACL_USER_BASE = 0x00001000L;
 	public static final long VID_ACL_USER_LAST = 0x00001FFFL;
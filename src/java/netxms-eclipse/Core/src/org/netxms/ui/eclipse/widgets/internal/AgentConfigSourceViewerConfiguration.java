@@ -113,6 +113,8 @@ public boolean isWordStart(char c)
 		"MaxLogSize", //$NON-NLS-1$
 		"MaxSessions", //$NON-NLS-1$
       "OfflineDataExpirationTime", //$NON-NLS-1$
+		"OfflineDataLog", //$NON-NLS-1$
+		"OfflineDataLogSegmentSize", //$NON-NLS-1$
 		"PlatformSuffix", //$NON-NLS-1$
 		"RequireAuthentication", //$NON-NLS-1$
 		"RequireEncryption", //$NON-NLS-1$
@@ -168,6 +168,12 @@ private void fillMetricList()
          list.add(new AgentParameter("Server.DBWriter.Requests.IData", "DB writer requests (DCI data)", DataType.COUNTER64)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.DBWriter.Requests.Other", "DB writer requests (other queries)", DataType.COUNTER64)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.DBWriter.Requests.RawData", "DB writer requests (raw DCI data)", DataType.COUNTER64)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.DBWriter.Requests.TData", "DB writer requests (table DCI data)", DataType.COUNTER64)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.EventLogWriter.AverageBatchSize", "Event log writer: average batch size", DataType.UINT32)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.EventLogWriter.AverageWriteTime", "Event log writer: average batch write time", DataType.UINT32)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.EventLogWriter.FailedEvents", "Event log writer: total number of events failed to write", DataType.COUNTER64)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.EventLogWriter.MaxWriteTime", "Event log writer: maximum batch write time", DataType.UINT32)); //$NON-NLS-1$
+         list.add(new AgentParameter("Server.EventLogWriter.WrittenEvents", "Event log writer: total number of written events", DataType.COUNTER64)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.EventProcessor.AverageWaitTime(*)", "Event processor {instance}: average event wait time", DataType.UINT32)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.EventProcessor.Bindings(*)", "Event processor {instance}: active bindings", DataType.UINT32)); //$NON-NLS-1$
          list.add(new AgentParameter("Server.EventProcessor.ProcessedEvents(*)", "Event processor {instance}: total number of processed events", DataType.COUNTER64)); //$NON-NLS-1$
@@ -23,6 +23,7 @@
 #include "libnetxms.h"
 #include <nxcpapi.h>
 #include <zlib.h>
+#include "lz4.h"
 
 #undef uthash_malloc
 #define uthash_malloc(sz) m_pool.allocate(sz)
@@ -49,6 +50,127 @@ static void ZLibFree(voidpf pool, voidpf address)
 {
 }
 
+/**
+ * Deflate compression level for messages
+ */
+static int s_deflateLevel = 6;
+
+/**
+ * Set deflate compression level used for messages (1 - fastest, 9 - best compression)
+ */
+void LIBNETXMS_EXPORTABLE NXCPSetMessageCompressionLevel(int level)
+{
+   s_deflateLevel = std::max(1, std::min(level, 9));
+}
+
+/**
+ * Message compressor. Keeps deflate and LZ4 state between messages so it is not re-allocated for each message.
+ */
+class MessageCompressor
+{
+private:
+   z_stream m_stream;
+   int m_deflateLevel;
+   void *m_lz4State;
+
+public:
+   MessageCompressor()
+   {
+      memset(&m_stream, 0, sizeof(m_stream));
+      m_deflateLevel = 0;
+      m_lz4State = nullptr;
+   }
+
+   ~MessageCompressor()
+   {
+      if (m_deflateLevel != 0)
+         deflateEnd(&m_stream);
+      MemFree(m_lz4State);
+   }
+
+   static size_t compressBound(NXCPStreamCompressionMethod method, size_t size)
+   {
+      return (method == NXCP_STREAM_COMPRESSION_LZ4) ? LZ4_compressBound(static_cast<int>(size)) : ::compressBound(static_cast<uLong>(size));
+   }
+
+   size_t compress(NXCPStreamCompressionMethod method, const BYTE *in, size_t inSize, BYTE *out, size_t outSize);
+};
+
+/**
+ * Compress data block. Returns size of compressed data or 0 on failure.
+ */
+size_t MessageCompressor::compress(NXCPStreamCompressionMethod method, const BYTE *in, size_t inSize, BYTE *out, size_t outSize)
+{
+   if (method == NXCP_STREAM_COMPRESSION_LZ4)
+   {
+      if (m_lz4State == nullptr)
+         m_lz4State = MemAlloc(LZ4_sizeofState());
+      return LZ4_compress_fast_extState(m_lz4State, reinterpret_cast<const char*>(in), reinterpret_cast<char*>(out), static_cast<int>(inSize), static_cast<int>(outSize), 1);
+   }
+
+   int level = s_deflateLevel;
+   if (m_deflateLevel != level)
+   {
+      if (m_deflateLevel != 0)
+         deflateEnd(&m_stream);
+      memset(&m_stream, 0, sizeof(m_stream));
+      if (deflateInit(&m_stream, level) != Z_OK)
+      {
+         m_deflateLevel = 0;
+         return 0;
+      }
+      m_deflateLevel = level;
+   }
+   else if (deflateReset(&m_stream) != Z_OK)
+   {
+      return 0;
+   }
+
+#if ZLIB_CONST_INPUT
+   m_stream.next_in = in;
+#else
+   m_stream.next_in = const_cast<BYTE*>(in);
+#endif
+   m_stream.avail_in = static_cast<uInt>(inSize);
+   m_stream.next_out = out;
+   m_stream.avail_out = static_cast<uInt>(outSize);
+   return (deflate(&m_stream, Z_FINISH) == Z_STREAM_END) ? outSize - m_stream.avail_out : 0;
+}
+
+/**
+ * Decompress message payload into given buffer. Memory pool is used for deflate state allocation if provided.
+ */
+static bool DecompressMessagePayload(const NXCP_MESSAGE *msg, uint16_t flags, BYTE *out, size_t outSize, MemoryPool *pool)
+{
+   const BYTE *in = reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4;
+   size_t inSize = ntohl(msg->size) - NXCP_HEADER_SIZE - 4;
+
+   if (flags & MF_COMPRESSED_LZ4)
+   {
+      // Compressed data is followed by alignment padding, so exact compressed size is not known
+      return LZ4_decompress_safe_partial(reinterpret_cast<const char*>(in), reinterpret_cast<char*>(out), static_cast<int>(inSize), static_cast<int>(outSize), static_cast<int>(outSize)) == static_cast<int>(outSize);
+   }
+
+   z_stream stream;
+   stream.zalloc = (pool != nullptr) ? ZLibAlloc : Z_NULL;
+   stream.zfree = (pool != nullptr) ? ZLibFree : Z_NULL;
+   stream.opaque = pool;
+   stream.avail_in = static_cast<uInt>(inSize);
+#if ZLIB_CONST_INPUT
+   stream.next_in = in;
+#else
+   stream.next_in = const_cast<BYTE*>(in);
+#endif
+   if (inflateInit(&stream) != Z_OK)
+      return false;
+
+   stream.next_out = out;
+   stream.avail_out = static_cast<uInt>(outSize);
+   bool success = (inflate(&stream, Z_FINISH) == Z_STREAM_END);
+   inflateEnd(&stream);
+   return success;
+}
+
 /**
  * Calculate field size
  */
@@ -215,38 +337,17 @@ NXCPMessage::NXCPMessage(const NXCP_MESSAGE *msg, int version) : m_pool(SizeHint
       m_dataSize = (size_t)ntohl(msg->numFields);
       if ((m_flags & MF_COMPRESSED) && !(m_flags & MF_STREAM) && (m_version >= 4))
       {
-         m_flags &= ~MF_COMPRESSED; // clear "compressed" flag so it will not be mistakenly re-sent
-
-         z_stream stream;
-         stream.zalloc = ZLibAlloc;
-         stream.zfree = ZLibFree;
-         stream.opaque = &m_pool;
-         stream.avail_in = (UINT32)ntohl(msg->size) - NXCP_HEADER_SIZE - 4;
-#if ZLIB_CONST_INPUT
-         stream.next_in = reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4;
-#else
-         stream.next_in = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4);
-#endif
-         if (inflateInit(&stream) != Z_OK)
-         {
-            nxlog_debug(6, _T("NXCPMessage: inflateInit() failed"));
-            m_version = -1;   // error indicator
-            return;
-         }
+         uint16_t flags = m_flags;
+         m_flags &= ~(MF_COMPRESSED | MF_COMPRESSED_LZ4); // clear "compressed" flags so they will not be mistakenly re-sent
 
          m_data = m_pool.allocateArray<BYTE>(m_dataSize);
-         stream.next_out = m_data;
-         stream.avail_out = (UINT32)m_dataSize;
-
-         if (inflate(&stream, Z_FINISH) != Z_STREAM_END)
+         if (!DecompressMessagePayload(msg, flags, m_data, m_dataSize, &m_pool))
          {
-            inflateEnd(&stream);
             TCHAR buffer[256];
             nxlog_debug(6, _T("NXCPMessage: failed to decompress binary message %s with ID %d"), NXCPMessageCodeName(m_code, buffer), m_id);
             m_version = -1;   // error indicator
             return;
          }
-         inflateEnd(&stream);
       }
       else
       {
@@ -267,39 +368,18 @@ NXCPMessage::NXCPMessage(const NXCP_MESSAGE *msg, int version) : m_pool(SizeHint
       size_t msgDataSize;
       if ((m_flags & MF_COMPRESSED) && (m_version >= 4))
       {
-         m_flags &= ~MF_COMPRESSED; // clear "compressed" flag so it will not be mistakenly re-sent
+         uint16_t flags = m_flags;
+         m_flags &= ~(MF_COMPRESSED | MF_COMPRESSED_LZ4); // clear "compressed" flags so they will not be mistakenly re-sent
          msgDataSize = ntohl(*reinterpret_cast<const uint32_t*>(reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE)) - NXCP_HEADER_SIZE;
 
-         z_stream stream;
-         stream.zalloc = ZLibAlloc;
-         stream.zfree = ZLibFree;
-         stream.opaque = &m_pool;
-         stream.avail_in = ntohl(msg->size) - NXCP_HEADER_SIZE - 4;
-#if ZLIB_CONST_INPUT
-         stream.next_in = reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4;
-#else
-         stream.next_in = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4);
-#endif
-         if (inflateInit(&stream) != Z_OK)
-         {
-            nxlog_debug(6, _T("NXCPMessage: inflateInit() failed"));
-            m_version = -1;   // error indicator
-            return;
-         }
-
          msgData = m_pool.allocateArray<BYTE>(msgDataSize);
-         stream.next_out = msgData;
-         stream.avail_out = (UINT32)msgDataSize;
-
-         if (inflate(&stream, Z_FINISH) != Z_STREAM_END)
+         if (!DecompressMessagePayload(msg, flags, msgData, msgDataSize, &m_pool))
          {
-            inflateEnd(&stream);
             TCHAR buffer[256];
             nxlog_debug(6, _T("NXCPMessage: failed to decompress message %s with ID %d"), NXCPMessageCodeName(m_code, buffer), m_id);
             m_version = -1;   // error indicator
             return;
          }
-         inflateEnd(&stream);
       }
       else
       {
@@ -1123,7 +1203,7 @@ uuid NXCPMessage::getFieldAsGUID(uint32_t fieldId) const
 /**
  * Build protocol message ready to be send over the wire
  */
-NXCP_MESSAGE *NXCPMessage::serialize(bool allowCompression) const
+NXCP_MESSAGE *NXCPMessage::serialize(NXCPStreamCompressionMethod compressionMethod) const
 {
    // Calculate message size
    size_t size = NXCP_HEADER_SIZE;
@@ -1221,46 +1301,35 @@ NXCP_MESSAGE *NXCPMessage::serialize(bool allowCompression) const
    }
 
    // Compress message payload if requested. Compression supported starting with NXCP version 4.
-   if ((m_version >= 4) && allowCompression && (size > 128) && !(m_flags & (MF_STREAM | MF_DONT_COMPRESS)))
+   if ((m_version >= 4) && (compressionMethod != NXCP_STREAM_COMPRESSION_NONE) && (size > 128) && !(m_flags & (MF_STREAM | MF_DONT_COMPRESS)))
    {
-      z_stream stream;
-      stream.zalloc = ZLibAlloc;
-      stream.zfree = ZLibFree;
-      stream.opaque = (void*)&m_pool;
-      stream.avail_in = 0;
-      stream.next_in = Z_NULL;
-      if (deflateInit(&stream, 9) == Z_OK)
+      // Compressor state is kept per thread when possible
+#if defined(_WIN32) || HAVE_THREAD_LOCAL_SPECIFIER
+      static thread_local MessageCompressor compressor;
+#else
+      MessageCompressor compressor;
+#endif
+
+      size_t compBufferSize = MessageCompressor::compressBound(compressionMethod, size - NXCP_HEADER_SIZE);
+      BYTE *compressedMsg = static_cast<BYTE*>(MemAlloc(compBufferSize + NXCP_HEADER_SIZE + 4 + 8));
+      size_t compDataSize = compressor.compress(compressionMethod, reinterpret_cast<BYTE*>(msg->fields), size - NXCP_HEADER_SIZE, compressedMsg + NXCP_HEADER_SIZE + 4, compBufferSize);
+      size_t compMsgSize = compDataSize + NXCP_HEADER_SIZE + 4;
+      // Message should be aligned to 8 bytes boundary
+      size_t padding = (8 - (compMsgSize % 8)) & 7;
+      if ((compDataSize > 0) && (compMsgSize + padding < size - 4))
       {
-         size_t compBufferSize = deflateBound(&stream, (unsigned long)(size - NXCP_HEADER_SIZE));
-         BYTE *compressedMsg = (BYTE *)MemAlloc(compBufferSize + NXCP_HEADER_SIZE + 4);
-         stream.next_in = reinterpret_cast<BYTE*>(msg->fields);
-         stream.avail_in = (UINT32)(size - NXCP_HEADER_SIZE);
-         stream.next_out = compressedMsg + NXCP_HEADER_SIZE + 4;
-         stream.avail_out = (UINT32)compBufferSize;
-         if (deflate(&stream, Z_FINISH) == Z_STREAM_END)
-         {
-            size_t compMsgSize = compBufferSize - stream.avail_out + NXCP_HEADER_SIZE + 4;
-            // Message should be aligned to 8 bytes boundary
-            compMsgSize += (8 - (compMsgSize % 8)) & 7;
-            if (compMsgSize < size - 4)
-            {
-               memcpy(compressedMsg, msg, NXCP_HEADER_SIZE);
-               MemFree(msg);
-               msg = (NXCP_MESSAGE *)compressedMsg;
-               msg->flags |= htons(MF_COMPRESSED);
-               memcpy((BYTE *)msg + NXCP_HEADER_SIZE, &msg->size, 4); // Save size of uncompressed message
-               msg->size = htonl((UINT32)compMsgSize);
-            }
-            else
-            {
-               MemFree(compressedMsg);
-            }
-         }
-         else
-         {
-            MemFree(compressedMsg);
-         }
-         deflateEnd(&stream);
+         memset(compressedMsg + compMsgSize, 0, padding);
+         compMsgSize += padding;
+         memcpy(compressedMsg, msg, NXCP_HEADER_SIZE);
+         MemFree(msg);
+         msg = reinterpret_cast<NXCP_MESSAGE*>(compressedMsg);
+         msg->flags |= htons((compressionMethod == NXCP_STREAM_COMPRESSION_LZ4) ? (MF_COMPRESSED | MF_COMPRESSED_LZ4) : MF_COMPRESSED);
+         memcpy(reinterpret_cast<BYTE*>(msg) + NXCP_HEADER_SIZE, &msg->size, 4); // Save size of uncompressed message
+         msg->size = htonl(static_cast<uint32_t>(compMsgSize));
+      }
+      else
+      {
+         MemFree(compressedMsg);
       }
    }
    return msg;
@@ -1491,35 +1560,13 @@ StringBuffer NXCPMessage::dump(const NXCP_MESSAGE *msg, int version)
    if ((flags & MF_COMPRESSED) && (version >= 4))
    {
       msgDataSize = (size_t)ntohl(*((UINT32 *)((BYTE *)msg + NXCP_HEADER_SIZE))) - NXCP_HEADER_SIZE;
-
-      z_stream stream;
-      stream.zalloc = Z_NULL;
-      stream.zfree = Z_NULL;
-      stream.opaque = Z_NULL;
-      stream.avail_in = size - NXCP_HEADER_SIZE - 4;
-#if ZLIB_CONST_INPUT
-      stream.next_in = reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4;
-#else
-      stream.next_in = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(msg) + NXCP_HEADER_SIZE + 4);
-#endif
-      if (inflateInit(&stream) != Z_OK)
-      {
-         out.append(_T("Cannot decompress message"));
-         return out;
-      }
-
       msgData = allocatedMsgData = static_cast<BYTE*>(MemAlloc(msgDataSize));
-      stream.next_out = allocatedMsgData;
-      stream.avail_out = (UINT32)msgDataSize;
-
-      if (inflate(&stream, Z_FINISH) != Z_STREAM_END)
+      if (!DecompressMessagePayload(msg, flags, allocatedMsgData, msgDataSize, nullptr))
       {
-         inflateEnd(&stream);
          MemFree(allocatedMsgData);
          out.append(_T("Cannot decompress message"));
          return out;
       }
-      inflateEnd(&stream);
    }
    else
    {
@@ -438,3 +438,480 @@ void Queue::forEach(QueueEnumerationCallback callback, void *context)
 stop_enumeration:
    unlock();
 }
+
+/**
+ * Bounded queue cell
+ */
+struct BoundedQueueCell
+{
+   std::atomic<size_t> sequence;
+   void *element;
+};
+
+/**
+ * Internal bounded queue data. Enqueue and dequeue positions are placed on separate cache lines.
+ */
+struct BoundedQueueData
+{
+   BoundedQueueCell *cells;
+   size_t mask;
+   char padding1[64];
+   std::atomic<size_t> enqueuePos;
+   char padding2[64 - sizeof(std::atomic<size_t>)];
+   std::atomic<size_t> dequeuePos;
+   char padding3[64 - sizeof(std::atomic<size_t>)];
+   std::atomic<int> waitingConsumers;
+   std::atomic<int> waitingProducers;
+   std::atomic<bool> shutdown;
+#if defined(_WIN32)
+   CRITICAL_SECTION lock;
+   CONDITION_VARIABLE notEmpty;
+   CONDITION_VARIABLE notFull;
+#elif defined(_USE_GNU_PTH)
+   pth_mutex_t lock;
+   pth_cond_t notEmpty;
+   pth_cond_t notFull;
+#else
+   pthread_mutex_t lock;
+   pthread_cond_t notEmpty;
+   pthread_cond_t notFull;
+#endif
+};
+
+#if defined(_WIN32)
+#define BQ_LOCK(d) EnterCriticalSection(&(d)->lock)
+#define BQ_UNLOCK(d) LeaveCriticalSection(&(d)->lock)
+#define BQ_SIGNAL(c) WakeConditionVariable(&(c))
+#define BQ_BROADCAST(c) WakeAllConditionVariable(&(c))
+#elif defined(_USE_GNU_PTH)
+#define BQ_LOCK(d) pth_mutex_acquire(&(d)->lock, FALSE, nullptr)
+#define BQ_UNLOCK(d) pth_mutex_release(&(d)->lock)
+#define BQ_SIGNAL(c) pth_cond_notify(&(c), false)
+#define BQ_BROADCAST(c) pth_cond_notify(&(c), true)
+#else
+#define BQ_LOCK(d) pthread_mutex_lock(&(d)->lock)
+#define BQ_UNLOCK(d) pthread_mutex_unlock(&(d)->lock)
+#define BQ_SIGNAL(c) pthread_cond_signal(&(c))
+#define BQ_BROADCAST(c) pthread_cond_broadcast(&(c))
+#endif
+
+/**
+ * Wait on bounded queue condition. Queue lock must be held by caller. Returns false on timeout.
+ */
+#if defined(_WIN32)
+static bool BoundedQueueWait(BoundedQueueData *d, CONDITION_VARIABLE *cond, uint32_t timeout)
+{
+   return SleepConditionVariableCS(cond, &d->lock, timeout) ? true : false;
+}
+#elif defined(_USE_GNU_PTH)
+static bool BoundedQueueWait(BoundedQueueData *d, pth_cond_t *cond, uint32_t timeout)
+{
+   if (timeout == INFINITE)
+      return pth_cond_await(cond, &d->lock, nullptr) != 0;
+   pth_event_t ev = pth_event(PTH_EVENT_TIME, pth_timeout(timeout / 1000, (timeout % 1000) * 1000));
+   int rc = pth_cond_await(cond, &d->lock, ev);
+   if ((rc > 0) && (pth_event_status(ev) == PTH_STATUS_OCCURRED))
+      rc = 0;   // Timeout
+   pth_event_free(ev, PTH_FREE_ALL);
+   return rc != 0;
+}
+#else
+static bool BoundedQueueWait(BoundedQueueData *d, pthread_cond_t *cond, uint32_t timeout)
+{
+   int rc;
+   if (timeout != INFINITE)
+   {
+#if HAVE_PTHREAD_COND_RELTIMEDWAIT_NP
+      struct timespec ts;
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000;
+      rc = pthread_cond_reltimedwait_np(cond, &d->lock, &ts);
+#else
+      struct timeval now;
+      struct timespec ts;
+      gettimeofday(&now, nullptr);
+      ts.tv_sec = now.tv_sec + (timeout / 1000);
+      now.tv_usec += (timeout % 1000) * 1000;
+      ts.tv_sec += now.tv_usec / 1000000;
+      ts.tv_nsec = (now.tv_usec % 1000000) * 1000;
+      rc = pthread_cond_timedwait(cond, &d->lock, &ts);
+#endif
+   }
+   else
+   {
+      rc = pthread_cond_wait(cond, &d->lock);
+   }
+   return rc == 0;
+}
+#endif
+
+/**
+ * Default bounded queue element destructor
+ */
+static void DefaultBoundedQueueElementDestructor(void *element, BoundedQueue *queue)
+{
+   MemFree(element);
+}
+
+/**
+ * Bounded queue constructor. Capacity is rounded up to nearest power of 2.
+ */
+BoundedQueue::BoundedQueue(size_t capacity, Ownership owner)
+{
+   size_t size = 2;
+   while(size < capacity)
+      size <<= 1;
+
+   m_data = new BoundedQueueData();
+   m_data->cells = new BoundedQueueCell[size];
+   for(size_t i = 0; i < size; i++)
+   {
+      m_data->cells[i].sequence.store(i, std::memory_order_relaxed);
+      m_data->cells[i].element = nullptr;
+   }
+   m_data->mask = size - 1;
+   m_data->enqueuePos.store(0, std::memory_order_relaxed);
+   m_data->dequeuePos.store(0, std::memory_order_relaxed);
+   m_data->waitingConsumers.store(0, std::memory_order_relaxed);
+   m_data->waitingProducers.store(0, std::memory_order_relaxed);
+   m_data->shutdown.store(false, std::memory_order_relaxed);
+
+#if defined(_WIN32)
+   InitializeCriticalSectionAndSpinCount(&m_data->lock, 4000);
+   InitializeConditionVariable(&m_data->notEmpty);
+   InitializeConditionVariable(&m_data->notFull);
+#elif defined(_USE_GNU_PTH)
+   pth_mutex_init(&m_data->lock);
+   pth_cond_init(&m_data->notEmpty);
+   pth_cond_init(&m_data->notFull);
+#else
+   pthread_mutex_init(&m_data->lock, nullptr);
+   pthread_cond_init(&m_data->notEmpty, nullptr);
+   pthread_cond_init(&m_data->notFull, nullptr);
+#endif
+
+   m_owner = (owner == Ownership::True);
+   m_destructor = DefaultBoundedQueueElementDestructor;
+}
+
+/**
+ * Bounded queue destructor
+ */
+BoundedQueue::~BoundedQueue()
+{
+   setShutdownMode();
+   clear();
+
+#if defined(_WIN32)
+   DeleteCriticalSection(&m_data->lock);
+#elif defined(_USE_GNU_PTH)
+   // No cleanup for mutex or condition
+#else
+   pthread_mutex_destroy(&m_data->lock);
+   pthread_cond_destroy(&m_data->notEmpty);
+   pthread_cond_destroy(&m_data->notFull);
+#endif
+
+   delete[] m_data->cells;
+   delete m_data;
+}
+
+/**
+ * Try to place element into ring buffer. Returns false if queue is full.
+ */
+bool BoundedQueue::enqueue(void *element)
+{
+   BoundedQueueCell *cell;
+   size_t pos = m_data->enqueuePos.load(std::memory_order_relaxed);
+   while(true)
+   {
+      cell = &m_data->cells[pos & m_data->mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0)
+      {
+         if (m_data->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+      }
+      else if (diff < 0)
+      {
+         return false;  // Queue is full
+      }
+      else
+      {
+         pos = m_data->enqueuePos.load(std::memory_order_relaxed);
+      }
+   }
+   cell->element = element;
+   cell->sequence.store(pos + 1, std::memory_order_release);
+   return true;
+}
+
+/**
+ * Take element from ring buffer. Returns nullptr if queue is empty.
+ */
+void *BoundedQueue::dequeue()
+{
+   BoundedQueueCell *cell;
+   size_t pos = m_data->dequeuePos.load(std::memory_order_relaxed);
+   while(true)
+   {
+      cell = &m_data->cells[pos & m_data->mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0)
+      {
+         if (m_data->dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+      }
+      else if (diff < 0)
+      {
+         return nullptr;  // Queue is empty
+      }
+      else
+      {
+         pos = m_data->dequeuePos.load(std::memory_order_relaxed);
+      }
+   }
+   void *element = cell->element;
+   cell->sequence.store(pos + m_data->mask + 1, std::memory_order_release);
+   return element;
+}
+
+/**
+ * Wake up consumers blocked on empty queue (if any)
+ */
+void BoundedQueue::wakeConsumers(bool all)
+{
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   if (m_data->waitingConsumers.load(std::memory_order_relaxed) > 0)
+   {
+      BQ_LOCK(m_data);
+      if (all)
+         BQ_BROADCAST(m_data->notEmpty);
+      else
+         BQ_SIGNAL(m_data->notEmpty);
+      BQ_UNLOCK(m_data);
+   }
+}
+
+/**
+ * Wake up producers blocked on full queue (if any)
+ */
+void BoundedQueue::wakeProducers(bool all)
+{
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   if (m_data->waitingProducers.load(std::memory_order_relaxed) > 0)
+   {
+      BQ_LOCK(m_data);
+      if (all)
+         BQ_BROADCAST(m_data->notFull);
+      else
+         BQ_SIGNAL(m_data->notFull);
+      BQ_UNLOCK(m_data);
+   }
+}
+
+/**
+ * Put element into queue, blocking while queue is full. Returns false if queue was switched to shutdown mode.
+ * Does not wake up consumers.
+ */
+bool BoundedQueue::putOrBlock(void *element)
+{
+   if (enqueue(element))
+      return true;
+
+   bool success = false;
+   BQ_LOCK(m_data);
+   m_data->waitingProducers.fetch_add(1);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   while(!m_data->shutdown.load(std::memory_order_relaxed))
+   {
+      if (enqueue(element))
+      {
+         success = true;
+         break;
+      }
+      BoundedQueueWait(m_data, &m_data->notFull, INFINITE);
+   }
+   m_data->waitingProducers.fetch_sub(1);
+   BQ_UNLOCK(m_data);
+   return success;
+}
+
+/**
+ * Put element into queue. Will block if queue is full.
+ * Returns false if queue is in shutdown mode and element was not queued.
+ */
+bool BoundedQueue::put(void *element)
+{
+   if (element == nullptr)
+      return true;   // Null elements are skipped on read anyway
+   if (!putOrBlock(element))
+      return false;
+   wakeConsumers(false);
+   return true;
+}
+
+/**
+ * Put element into queue without blocking. Returns false if queue is full.
+ */
+bool BoundedQueue::tryPut(void *element)
+{
+   if (element == nullptr)
+      return true;
+   if (!enqueue(element))
+      return false;
+   wakeConsumers(false);
+   return true;
+}
+
+/**
+ * Put multiple elements into queue. Waiting consumers are woken up once for whole batch
+ * (or before blocking if queue became full). Returns false if queue was switched to shutdown mode
+ * before all elements were queued.
+ */
+bool BoundedQueue::putMany(void **elements, size_t count)
+{
+   size_t queued = 0;
+   for(size_t i = 0; i < count; i++)
+   {
+      if (elements[i] == nullptr)
+         continue;
+      if (!enqueue(elements[i]))
+      {
+         if (queued > 0)
+         {
+            wakeConsumers(queued > 1);
+            queued = 0;
+         }
+         if (!putOrBlock(elements[i]))
+            return false;
+      }
+      queued++;
+   }
+   if (queued > 0)
+      wakeConsumers(queued > 1);
+   return true;
+}
+
+/**
+ * Get element from queue. Returns nullptr if queue is empty and INVALID_POINTER_VALUE if queue is in shutdown mode.
+ */
+void *BoundedQueue::get()
+{
+   if (m_data->shutdown.load(std::memory_order_relaxed))
+      return INVALID_POINTER_VALUE;
+
+   void *element = dequeue();
+   if (element != nullptr)
+      wakeProducers(false);
+   return element;
+}
+
+/**
+ * Get element from queue or block with timeout if queue is empty
+ */
+void *BoundedQueue::getOrBlock(uint32_t timeout)
+{
+   void *element = get();
+   if (element != nullptr)
+      return element;
+
+   int64_t deadline = (timeout != INFINITE) ? GetCurrentTimeMs() + timeout : 0;
+   BQ_LOCK(m_data);
+   m_data->waitingConsumers.fetch_add(1);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   while(true)
+   {
+      if (m_data->shutdown.load(std::memory_order_relaxed))
+      {
+         element = INVALID_POINTER_VALUE;
+         break;
+      }
+
+      element = dequeue();
+      if (element != nullptr)
+         break;
+
+      uint32_t waitTime = INFINITE;
+      if (timeout != INFINITE)
+      {
+         int64_t now = GetCurrentTimeMs();
+         if (now >= deadline)
+            break;
+         waitTime = static_cast<uint32_t>(deadline - now);
+      }
+      BoundedQueueWait(m_data, &m_data->notEmpty, waitTime);
+   }
+   m_data->waitingConsumers.fetch_sub(1);
+   if ((element != nullptr) && (element != INVALID_POINTER_VALUE) && (m_data->waitingProducers.load() > 0))
+      BQ_SIGNAL(m_data->notFull);
+   BQ_UNLOCK(m_data);
+   return element;
+}
+
+/**
+ * Get up to maxCount elements from queue without blocking. Returns number of elements retrieved.
+ */
+size_t BoundedQueue::getAll(void **buffer, size_t maxCount)
+{
+   if (m_data->shutdown.load(std::memory_order_relaxed))
+      return 0;
+
+   size_t count = 0;
+   while(count < maxCount)
+   {
+      void *element = dequeue();
+      if (element == nullptr)
+         break;
+      buffer[count++] = element;
+   }
+   if (count > 0)
+      wakeProducers(count > 1);
+   return count;
+}
+
+/**
+ * Get approximate number of elements in queue
+ */
+size_t BoundedQueue::size() const
+{
+   size_t dequeuePos = m_data->dequeuePos.load(std::memory_order_relaxed);
+   size_t enqueuePos = m_data->enqueuePos.load(std::memory_order_relaxed);
+   return (enqueuePos > dequeuePos) ? std::min(enqueuePos - dequeuePos, m_data->mask + 1) : 0;
+}
+
+/**
+ * Get queue capacity
+ */
+size_t BoundedQueue::capacity() const
+{
+   return m_data->mask + 1;
+}
+
+/**
+ * Clear queue
+ */
+void BoundedQueue::clear()
+{
+   void *element;
+   while((element = dequeue()) != nullptr)
+   {
+      if (m_owner && (element != INVALID_POINTER_VALUE))
+         m_destructor(element, this);
+   }
+   wakeProducers(true);
+}
+
+/**
+ * Set shutdown flag. When this flag is set, get() always return INVALID_POINTER_VALUE and blocked producers are released.
+ */
+void BoundedQueue::setShutdownMode()
+{
+   BQ_LOCK(m_data);
+   m_data->shutdown.store(true);
+   BQ_BROADCAST(m_data->notEmpty);
+   BQ_BROADCAST(m_data->notFull);
+   BQ_UNLOCK(m_data);
+}
@@ -32,7 +32,9 @@ SocketPoller::SocketPoller(bool write)
    m_count = 0;
 #if !HAVE_POLL
    m_invalidDescriptor = false;
+   m_hasAltDescriptors = false;
    FD_ZERO(&m_rwDescriptors);
+   FD_ZERO(&m_altDescriptors);
    FD_ZERO(&m_exDescriptors);
 #ifndef _WIN32
    m_maxfd = 0;
@@ -48,22 +50,30 @@ SocketPoller::~SocketPoller()
 }
 
 /**
- * Add socket
+ * Add socket for polling in given direction (same socket can be added for both reading and writing)
  */
-bool SocketPoller::add(SOCKET s)
+bool SocketPoller::add(SOCKET s, bool write)
 {
    if ((s == INVALID_SOCKET) || (m_count == SOCKET_POLLER_MAX_SOCKETS))
       return false;
 
 #if HAVE_POLL
    m_sockets[m_count].fd = s;
-   m_sockets[m_count].events = m_write ? POLLOUT : POLLIN;
+   m_sockets[m_count].events = write ? POLLOUT : POLLIN;
 #else
 #ifndef _WIN32
    if (s >= FD_SETSIZE)
       return false;
 #endif
-   FD_SET(s, &m_rwDescriptors);
+   if (write == m_write)
+   {
+      FD_SET(s, &m_rwDescriptors);
+   }
+   else
+   {
+      FD_SET(s, &m_altDescriptors);
+      m_hasAltDescriptors = true;
+   }
    FD_SET(s, &m_exDescriptors);
 #ifndef _WIN32
    if (s > m_maxfd)
@@ -103,13 +113,16 @@ int SocketPoller::poll(uint32_t timeout)
       return rc;
    }
 #else
+   fd_set *altDescriptors = m_hasAltDescriptors ? &m_altDescriptors : nullptr;
+   fd_set *readDescriptors = m_write ? altDescriptors : &m_rwDescriptors;
+   fd_set *writeDescriptors = m_write ? &m_rwDescriptors : altDescriptors;
    if (timeout == INFINITE)
    {
 #ifdef _WIN32
-      int rc = select(0, m_write ? nullptr : &m_rwDescriptors, m_write ? &m_rwDescriptors : nullptr, &m_exDescriptors, nullptr);
+      int rc = select(0, readDescriptors, writeDescriptors, &m_exDescriptors, nullptr);
       m_invalidDescriptor = ((rc == -1) && (WSAGetLastError() == WSAENOTSOCK));
 #else
-      int rc = select(SELECT_NFDS(m_maxfd + 1), m_write ? nullptr : &m_rwDescriptors, m_write ? &m_rwDescriptors : nullptr, &m_exDescriptors, nullptr);
+      int rc = select(SELECT_NFDS(m_maxfd + 1), readDescriptors, writeDescriptors, &m_exDescriptors, nullptr);
       m_invalidDescriptor = ((rc == -1) && (errno == EBADF));
 #endif
       return rc;
@@ -120,7 +133,7 @@ int SocketPoller::poll(uint32_t timeout)
 #ifdef _WIN32
       tv.tv_sec = timeout / 1000;
       tv.tv_usec = (timeout % 1000) * 1000;
-      int rc = select(0, m_write ? nullptr : &m_rwDescriptors, m_write ? &m_rwDescriptors : nullptr, &m_exDescriptors, &tv);
+      int rc = select(0, readDescriptors, writeDescriptors, &m_exDescriptors, &tv);
       m_invalidDescriptor = ((rc == -1) && (WSAGetLastError() == WSAENOTSOCK));
       return rc;
 #else
@@ -130,7 +143,7 @@ int SocketPoller::poll(uint32_t timeout)
          tv.tv_sec = timeout / 1000;
          tv.tv_usec = (timeout % 1000) * 1000;
          int64_t startTime = GetCurrentTimeMs();
-         rc = select(m_maxfd + 1, m_write ? nullptr : &m_rwDescriptors, m_write ? &m_rwDescriptors : nullptr, &m_exDescriptors, &tv);
+         rc = select(m_maxfd + 1, readDescriptors, writeDescriptors, &m_exDescriptors, &tv);
          if ((rc != -1) || (errno != EINTR))
             break;
          uint32_t elapsed = static_cast<uint32_t>(GetCurrentTimeMs() - startTime);
@@ -152,11 +165,29 @@ bool SocketPoller::isSet(SOCKET s)
    for(int i = 0; i < m_count; i++)
    {
       if (s == m_sockets[i].fd)
-         return (m_sockets[i].revents & ((m_write ? POLLOUT : POLLIN) | POLLERR | POLLHUP)) != 0;
+         return (m_sockets[i].revents & (m_sockets[i].events | POLLERR | POLLHUP)) != 0;
+   }
+   return false;
+#else
+   return (FD_ISSET(s, &m_rwDescriptors) || FD_ISSET(s, &m_altDescriptors) || FD_ISSET(s, &m_exDescriptors)) ? true : false;
+#endif
+}
+
+/**
+ * Check if socket is set for given polling direction
+ */
+bool SocketPoller::isSet(SOCKET s, bool write)
+{
+#if HAVE_POLL
+   short events = write ? POLLOUT : POLLIN;
+   for(int i = 0; i < m_count; i++)
+   {
+      if ((s == m_sockets[i].fd) && (m_sockets[i].events == events))
+         return (m_sockets[i].revents & (events | POLLERR | POLLHUP)) != 0;
    }
    return false;
 #else
-   return (FD_ISSET(s, &m_rwDescriptors) || FD_ISSET(s, &m_exDescriptors)) ? true : false;
+   return (FD_ISSET(s, (write == m_write) ? &m_rwDescriptors : &m_altDescriptors) || FD_ISSET(s, &m_exDescriptors)) ? true : false;
 #endif
 }
 
@@ -169,11 +200,11 @@ bool SocketPoller::isReady(SOCKET s)
    for(int i = 0; i < m_count; i++)
    {
       if (s == m_sockets[i].fd)
-         return ((m_sockets[i].revents & (m_write ? POLLOUT : POLLIN)) != 0) && ((m_sockets[i].revents & (POLLERR | POLLHUP)) == 0);
+         return ((m_sockets[i].revents & m_sockets[i].events) != 0) && ((m_sockets[i].revents & (POLLERR | POLLHUP)) == 0);
    }
    return false;
 #else
-   return FD_ISSET(s, &m_rwDescriptors) && !FD_ISSET(s, &m_exDescriptors);
+   return (FD_ISSET(s, &m_rwDescriptors) || FD_ISSET(s, &m_altDescriptors)) && !FD_ISSET(s, &m_exDescriptors);
 #endif
 }
 
@@ -201,7 +232,9 @@ void SocketPoller::reset()
 {
    m_count = 0;
 #if !HAVE_POLL
+   m_hasAltDescriptors = false;
    FD_ZERO(&m_rwDescriptors);
+   FD_ZERO(&m_altDescriptors);
    FD_ZERO(&m_exDescriptors);
 #ifndef _WIN32
    m_maxfd = 0;
@@ -262,9 +295,10 @@ BackgroundSocketPoller::~BackgroundSocketPoller()
 }
 
 /**
- * Add socket for background polling
+ * Add socket for background polling. If write is true, callback is called when socket becomes writable
+ * instead of readable. Same socket can have both read and write poll requests at the same time.
  */
-void BackgroundSocketPoller::poll(SOCKET socket, uint32_t timeout, void (*callback)(BackgroundSocketPollResult, SOCKET, void*), void *context)
+void BackgroundSocketPoller::poll(SOCKET socket, uint32_t timeout, void (*callback)(BackgroundSocketPollResult, SOCKET, void*), void *context, bool write)
 {
    if (m_shutdown)
    {
@@ -284,6 +318,7 @@ void BackgroundSocketPoller::poll(SOCKET socket, uint32_t timeout, void (*callba
    request->callback = callback;
    request->context = context;
    request->queueTime = GetCurrentTimeMs();
+   request->write = write;
    request->cancelled = false;
 
    m_mutex.lock();
@@ -298,25 +333,25 @@ void BackgroundSocketPoller::poll(SOCKET socket, uint32_t timeout, void (*callba
 }
 
 /**
- * Cancel socket poll. Registered callback will be called with CANCELLED status.
+ * Cancel all poll requests for given socket. Registered callbacks will be called with CANCELLED status.
  */
 void BackgroundSocketPoller::cancel(SOCKET socket)
 {
+   bool found = false;
    m_mutex.lock();
-   auto r = m_head->next;
-   for(; r != nullptr; r = r->next)
+   for(auto r = m_head->next; r != nullptr; r = r->next)
    {
       if (r->socket == socket)
       {
          r->cancelled = true;
-         break;
+         found = true;
       }
    }
    m_mutex.unlock();
 
    // No need for notification if poll() called from worker thread itself
    // (likely that means cancellation from poll completion callback)
-   if ((r != nullptr) && (GetCurrentThreadId() != m_workerThreadId))
+   if (found && (GetCurrentThreadId() != m_workerThreadId))
       notifyWorkerThread();
 }
 
@@ -375,7 +410,7 @@ void BackgroundSocketPoller::workerThread()
             uint32_t t = r->timeout - waitTime;
             if (t < timeout)
                timeout = t;
-            sp.add(r->socket);
+            sp.add(r->socket, r->write);
          }
          else
          {
@@ -414,7 +449,7 @@ void BackgroundSocketPoller::workerThread()
          m_mutex.lock();
          for(auto r = m_head->next, p = m_head; r != nullptr; p = r, r = r->next)
          {
-            if (r->cancelled || sp.isSet(r->socket))
+            if (r->cancelled || sp.isSet(r->socket, r->write))
             {
                p->next = r->next;
                r->next = processedRequests;
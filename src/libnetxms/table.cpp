@@ -24,6 +24,7 @@
 #include <nxcpapi.h>
 #include <expat.h>
 #include <zlib.h>
+#include <uthash.h>
 
 #define DEFAULT_OBJECT_ID  (0)
 #define DEFAULT_STATUS     (-1)
@@ -50,30 +51,47 @@ TableRow::TableRow(const TableRow& src) : m_cells(src.m_cells.size(), 8, Ownersh
    m_baseRow = src.m_baseRow;
 }
 
+/**
+ * Entry of table instance index
+ */
+struct TableInstanceIndexEntry
+{
+   UT_hash_handle hh;
+   int row;
+   TCHAR key[1];
+};
+
 /**
  * Create empty table
  */
-Table::Table() : m_data(32, 32, Ownership::True), m_columns(8, 8, Ownership::True)
+Table::Table() : m_data(32, 32, Ownership::True), m_columns(8, 8, Ownership::True), m_instanceIndexLock(MutexType::FAST)
 {
    m_title = nullptr;
    m_source = DS_INTERNAL;
    m_extendedFormat = false;
+   m_instanceIndex = nullptr;
+   m_indexedRows = 0;
 }
 
 /**
  * Create table from NXCP message
  */
-Table::Table(const NXCPMessage& msg) : m_data(32, 32, Ownership::True), m_columns(8, 8, Ownership::True)
+Table::Table(const NXCPMessage& msg) : m_data(32, 32, Ownership::True), m_columns(8, 8, Ownership::True), m_instanceIndexLock(MutexType::FAST)
 {
+   m_instanceIndex = nullptr;
+   m_indexedRows = 0;
    createFromMessage(msg);
 }
 
 /**
  * Copy constructor
  */
-Table::Table(const Table& src) : m_data(src.m_data.size(), 32, Ownership::True), m_columns(src.m_columns.size(), 8, Ownership::True)
+Table::Table(const Table& src) : m_data(src.m_data.size(), 32, Ownership::True), m_columns(src.m_columns.size(), 8, Ownership::True),
+         m_instanceIndexLock(MutexType::FAST)
 {
    m_extendedFormat = src.m_extendedFormat;
+   m_instanceIndex = nullptr;
+   m_indexedRows = 0;
    for(int i = 0; i < src.m_data.size(); i++)
       m_data.add(new TableRow(*src.m_data.get(i)));
    m_title = MemCopyString(src.m_title);
@@ -88,6 +106,7 @@ Table::Table(const Table& src) : m_data(src.m_data.size(), 32, Ownership::True),
 Table::~Table()
 {
    MemFree(m_title);
+   clearInstanceIndex();
 }
 
 /**
@@ -292,6 +311,11 @@ Table *Table::createFromXML(const char *xml)
    return NULL;
 }
 
+/**
+ * Maximum compression ratio achievable by zlib (used to validate declared uncompressed size)
+ */
+#define MAX_ZLIB_COMPRESSION_RATIO  1032
+
 /**
  * Create table from packed XML document
  */
@@ -303,7 +327,21 @@ Table *Table::createFromPackedXML(const char *packedXml)
    if (compressedXml == nullptr)
       return nullptr;
 
-   size_t xmlSize = ntohl(*reinterpret_cast<uint32_t*>(compressedXml));
+   if (compressedSize < 4)
+   {
+      MemFree(compressedXml);
+      return nullptr;
+   }
+
+   uint32_t n;
+   memcpy(&n, compressedXml, 4);
+   size_t xmlSize = ntohl(n);
+   if (xmlSize > (compressedSize - 4) * MAX_ZLIB_COMPRESSION_RATIO)
+   {
+      MemFree(compressedXml);
+      return nullptr;  // Declared size cannot be produced from given input
+   }
+
    char *xml = MemAllocStringA(xmlSize + 1);
    uLongf uncompSize = (uLongf)xmlSize;
    if (uncompress((BYTE *)xml, &uncompSize, (BYTE *)&compressedXml[4], (uLong)compressedSize - 4) != Z_OK)
@@ -411,6 +449,383 @@ char *Table::createPackedXML() const
    return encodedBuffer;
 }
 
+/**
+ * Signature of binary packed table format. First byte never appears at the beginning of
+ * packed XML (it would mean uncompressed XML document size above 4GB).
+ */
+static const BYTE s_packedTableSignature[3] = { 0xFF, 'N', 'T' };
+
+/**
+ * Current version of binary packed table format
+ */
+#define PACKED_TABLE_VERSION  1
+
+/**
+ * Flag in version byte indicating that table body is not compressed
+ */
+#define PACKED_TABLE_UNCOMPRESSED   0x80
+
+/**
+ * Bodies smaller than this are stored without compression
+ */
+#define PACKED_TABLE_COMPRESSION_THRESHOLD   4096
+
+/**
+ * Size of binary packed table header (signature, version, uncompressed body size)
+ */
+#define PACKED_TABLE_HEADER_SIZE 8
+
+/**
+ * Flags for binary packed table format
+ */
+#define PTF_EXTENDED_FORMAT   0x01
+#define PTF_INSTANCE_COLUMN   0x01
+#define PTF_ROW_OBJECT_IDS    0x01
+#define PTF_ROW_BASE_ROWS     0x02
+#define PTF_CELL_STATUS       0x01
+#define PTF_CELL_OBJECT_IDS   0x02
+
+/**
+ * Write string in binary packed table format (32 bit length followed by UTF-8 characters)
+ */
+static void WritePackedString(ByteStream *out, const TCHAR *s, Buffer<char, 1024> *buffer)
+{
+   size_t len = (s != nullptr) ? _tcslen(s) : 0;
+   if (len == 0)
+   {
+      out->writeB(static_cast<uint32_t>(0));
+      return;
+   }
+
+   if (buffer->size() < len * 4)
+      buffer->realloc(len * 4);
+   size_t bytes = tchar_to_utf8(s, len, buffer->buffer(), len * 4);
+   out->writeB(static_cast<uint32_t>(bytes));
+   out->write(buffer->buffer(), bytes);
+}
+
+/**
+ * Create table representation in binary packed format. Data is stored column by column, so values of the same
+ * column are placed together and compressed efficiently. Status and object ID arrays are omitted if all
+ * elements have default values. Small tables are stored without compression. Result is base64 encoded
+ * because it is stored in text column.
+ */
+char *Table::createPackedData() const
+{
+   int numRows = m_data.size();
+   int numColumns = m_columns.size();
+
+   ByteStream body(4096 + numRows * numColumns * 16);
+   Buffer<char, 1024> buffer;
+
+   body.write(static_cast<BYTE>(m_extendedFormat ? PTF_EXTENDED_FORMAT : 0));
+   body.writeB(static_cast<int32_t>(m_source));
+   WritePackedString(&body, m_title, &buffer);
+   body.writeB(static_cast<uint32_t>(numColumns));
+   body.writeB(static_cast<uint32_t>(numRows));
+
+   for(int i = 0; i < numColumns; i++)
+   {
+      const TableColumnDefinition *c = m_columns.get(i);
+      WritePackedString(&body, c->getName(), &buffer);
+      WritePackedString(&body, c->getDisplayName(), &buffer);
+      WritePackedString(&body, c->getUnitName(), &buffer);
+      body.writeB(c->getDataType());
+      body.writeB(static_cast<int32_t>(c->getMultiplier()));
+      body.write(static_cast<BYTE>(c->isInstanceColumn() ? PTF_INSTANCE_COLUMN : 0));
+   }
+
+   BYTE rowFlags = 0;
+   for(int i = 0; i < numRows; i++)
+   {
+      const TableRow *r = m_data.get(i);
+      if (r->getObjectId() != DEFAULT_OBJECT_ID)
+         rowFlags |= PTF_ROW_OBJECT_IDS;
+      if (r->getBaseRow() != -1)
+         rowFlags |= PTF_ROW_BASE_ROWS;
+   }
+   body.write(rowFlags);
+   if (rowFlags & PTF_ROW_OBJECT_IDS)
+   {
+      for(int i = 0; i < numRows; i++)
+         body.writeB(m_data.get(i)->getObjectId());
+   }
+   if (rowFlags & PTF_ROW_BASE_ROWS)
+   {
+      for(int i = 0; i < numRows; i++)
+         body.writeB(static_cast<int32_t>(m_data.get(i)->getBaseRow()));
+   }
+
+   for(int i = 0; i < numColumns; i++)
+   {
+      BYTE flags = 0;
+      for(int j = 0; j < numRows; j++)
+      {
+         const TableRow *r = m_data.get(j);
+         if (r->getStatus(i) != DEFAULT_STATUS)
+            flags |= PTF_CELL_STATUS;
+         if (r->getCellObjectId(i) != DEFAULT_OBJECT_ID)
+            flags |= PTF_CELL_OBJECT_IDS;
+      }
+      body.write(flags);
+
+      for(int j = 0; j < numRows; j++)
+         WritePackedString(&body, m_data.get(j)->getValue(i), &buffer);
+      if (flags & PTF_CELL_STATUS)
+      {
+         for(int j = 0; j < numRows; j++)
+            body.writeB(static_cast<int32_t>(m_data.get(j)->getStatus(i)));
+      }
+      if (flags & PTF_CELL_OBJECT_IDS)
+      {
+         for(int j = 0; j < numRows; j++)
+            body.writeB(m_data.get(j)->getCellObjectId(i));
+      }
+   }
+
+   size_t bodySize;
+   const BYTE *bodyData = body.buffer(&bodySize);
+   BYTE *packedData;
+   uLongf compressedSize;
+   if (bodySize >= PACKED_TABLE_COMPRESSION_THRESHOLD)
+   {
+      compressedSize = compressBound(static_cast<uLong>(bodySize));
+      packedData = MemAllocArrayNoInit<BYTE>(compressedSize + PACKED_TABLE_HEADER_SIZE);
+      if (compress2(&packedData[PACKED_TABLE_HEADER_SIZE], &compressedSize, bodyData, static_cast<uLong>(bodySize), Z_BEST_SPEED) != Z_OK)
+      {
+         MemFree(packedData);
+         return nullptr;
+      }
+      packedData[3] = PACKED_TABLE_VERSION;
+   }
+   else
+   {
+      compressedSize = static_cast<uLongf>(bodySize);
+      packedData = MemAllocArrayNoInit<BYTE>(bodySize + PACKED_TABLE_HEADER_SIZE);
+      memcpy(&packedData[PACKED_TABLE_HEADER_SIZE], bodyData, bodySize);
+      packedData[3] = PACKED_TABLE_VERSION | PACKED_TABLE_UNCOMPRESSED;
+   }
+   memcpy(packedData, s_packedTableSignature, 3);
+   uint32_t n = htonl(static_cast<uint32_t>(bodySize));
+   memcpy(&packedData[4], &n, 4);
+
+   char *encodedData = nullptr;
+   base64_encode_alloc(reinterpret_cast<char*>(packedData), compressedSize + PACKED_TABLE_HEADER_SIZE, &encodedData);
+   MemFree(packedData);
+   return encodedData;
+}
+
+/**
+ * Reader for binary packed table format
+ */
+class PackedTableReader
+{
+private:
+   const BYTE *m_data;
+   size_t m_size;
+   size_t m_pos;
+   bool m_error;
+
+   bool check(size_t bytes)
+   {
+      if (m_error || (m_pos + bytes > m_size))
+      {
+         m_error = true;
+         return false;
+      }
+      return true;
+   }
+
+public:
+   PackedTableReader(const BYTE *data, size_t size)
+   {
+      m_data = data;
+      m_size = size;
+      m_pos = 0;
+      m_error = false;
+   }
+
+   bool isError() const { return m_error; }
+   size_t remaining() const { return m_size - m_pos; }
+
+   BYTE readByte()
+   {
+      return check(1) ? m_data[m_pos++] : 0;
+   }
+
+   uint32_t readUInt32()
+   {
+      if (!check(4))
+         return 0;
+      uint32_t n;
+      memcpy(&n, &m_data[m_pos], 4);
+      m_pos += 4;
+      return ntohl(n);
+   }
+
+   int32_t readInt32()
+   {
+      return static_cast<int32_t>(readUInt32());
+   }
+
+   TCHAR *readString()
+   {
+      uint32_t len = readUInt32();
+      if (!check(len))
+         return nullptr;
+      TCHAR *s = MemAllocString(len + 1);
+      size_t chars = (len > 0) ? utf8_to_tchar(reinterpret_cast<const char*>(&m_data[m_pos]), len, s, len + 1) : 0;
+      s[chars] = 0;
+      m_pos += len;
+      return s;
+   }
+
+   void readString(TCHAR *buffer, size_t size)
+   {
+      uint32_t len = readUInt32();
+      if (!check(len))
+      {
+         buffer[0] = 0;
+         return;
+      }
+      size_t chars = (len > 0) ? utf8_to_tchar(reinterpret_cast<const char*>(&m_data[m_pos]), len, buffer, size - 1) : 0;
+      buffer[chars] = 0;
+      m_pos += len;
+   }
+};
+
+/**
+ * Parse table body in binary packed format
+ */
+bool Table::parsePackedData(const BYTE *data, size_t size)
+{
+   PackedTableReader reader(data, size);
+
+   m_extendedFormat = ((reader.readByte() & PTF_EXTENDED_FORMAT) != 0);
+   m_source = reader.readInt32();
+   MemFree(m_title);
+   m_title = reader.readString();
+
+   uint32_t numColumns = reader.readUInt32();
+   uint32_t numRows = reader.readUInt32();
+   // Each cell value occupies at least 4 bytes, so this check prevents huge allocations on malformed input
+   // (rows of table without columns are counted as having one cell)
+   if (reader.isError() || (static_cast<uint64_t>(numColumns) * 4 > reader.remaining()) ||
+       (static_cast<uint64_t>(std::max(numColumns, 1u)) * numRows * 4 > reader.remaining()))
+      return false;
+
+   TCHAR name[MAX_COLUMN_NAME], displayName[MAX_DB_STRING], unitName[63];
+   for(uint32_t i = 0; i < numColumns; i++)
+   {
+      reader.readString(name, MAX_COLUMN_NAME);
+      reader.readString(displayName, MAX_DB_STRING);
+      reader.readString(unitName, 63);
+      int32_t dataType = reader.readInt32();
+      int32_t multiplier = reader.readInt32();
+      bool isInstance = ((reader.readByte() & PTF_INSTANCE_COLUMN) != 0);
+      if (reader.isError())
+         return false;
+
+      auto c = new TableColumnDefinition(name, displayName, dataType, isInstance);
+      c->setUnitName(unitName);
+      c->setMultiplier(multiplier);
+      m_columns.add(c);
+   }
+
+   for(uint32_t i = 0; i < numRows; i++)
+      m_data.add(new TableRow(numColumns));
+
+   BYTE rowFlags = reader.readByte();
+   if (rowFlags & PTF_ROW_OBJECT_IDS)
+   {
+      for(uint32_t i = 0; i < numRows; i++)
+         m_data.get(i)->setObjectId(reader.readUInt32());
+   }
+   if (rowFlags & PTF_ROW_BASE_ROWS)
+   {
+      for(uint32_t i = 0; i < numRows; i++)
+         m_data.get(i)->setBaseRow(reader.readInt32());
+   }
+
+   for(uint32_t i = 0; (i < numColumns) && !reader.isError(); i++)
+   {
+      BYTE flags = reader.readByte();
+      for(uint32_t j = 0; j < numRows; j++)
+         m_data.get(j)->setPreallocatedValue(i, reader.readString());
+      if (flags & PTF_CELL_STATUS)
+      {
+         for(uint32_t j = 0; j < numRows; j++)
+            m_data.get(j)->setStatus(i, reader.readInt32());
+      }
+      if (flags & PTF_CELL_OBJECT_IDS)
+      {
+         for(uint32_t j = 0; j < numRows; j++)
+            m_data.get(j)->setCellObjectId(i, reader.readUInt32());
+      }
+   }
+
+   for(uint32_t i = 0; i < numRows; i++)
+      updateNumericValues(m_data.get(i));
+   return !reader.isError();
+}
+
+/**
+ * Create table from packed data. Both binary packed format and packed XML are accepted. Declared body size is
+ * validated against actual input size before any allocation, so truncated or malformed input is rejected.
+ */
+Table *Table::createFromPackedData(const char *packedData)
+{
+   char *data = nullptr;
+   size_t size = 0;
+   base64_decode_alloc(packedData, strlen(packedData), &data, &size);
+   if (data == nullptr)
+      return nullptr;
+
+   if ((size < PACKED_TABLE_HEADER_SIZE) || memcmp(data, s_packedTableSignature, 3))
+   {
+      MemFree(data);
+      return createFromPackedXML(packedData);
+   }
+
+   BYTE version = static_cast<BYTE>(data[3]);
+   if ((version & ~PACKED_TABLE_UNCOMPRESSED) != PACKED_TABLE_VERSION)
+   {
+      MemFree(data);
+      return nullptr;
+   }
+
+   uint32_t bodySize;
+   memcpy(&bodySize, &data[4], 4);
+   bodySize = ntohl(bodySize);
+   size_t payloadSize = size - PACKED_TABLE_HEADER_SIZE;
+   const BYTE *payload = reinterpret_cast<BYTE*>(&data[PACKED_TABLE_HEADER_SIZE]);
+
+   Table *table = nullptr;
+   if (version & PACKED_TABLE_UNCOMPRESSED)
+   {
+      if (bodySize == payloadSize)
+      {
+         table = new Table();
+         if (!table->parsePackedData(payload, bodySize))
+            delete_and_null(table);
+      }
+   }
+   else if ((payloadSize > 0) && (bodySize <= payloadSize * MAX_ZLIB_COMPRESSION_RATIO))
+   {
+      BYTE *body = MemAllocArrayNoInit<BYTE>(std::max(bodySize, 1u));
+      uLongf uncompSize = static_cast<uLongf>(bodySize);
+      if ((uncompress(body, &uncompSize, payload, static_cast<uLong>(payloadSize)) == Z_OK) && (uncompSize == bodySize))
+      {
+         table = new Table();
+         if (!table->parsePackedData(body, bodySize))
+            delete_and_null(table);
+      }
+      MemFree(body);
+   }
+   MemFree(data);
+   return table;
+}
+
 Table *Table::createFromCSV(const TCHAR *content, const TCHAR separator)
 {
    if (content == nullptr)
@@ -586,6 +1001,7 @@ void Table::createFromMessage(const NXCPMessage& msg)
             row->setPreallocated(j, value, -1, 0);
          }
       }
+      updateNumericValues(row);
    }
 }
 
@@ -594,6 +1010,7 @@ void Table::createFromMessage(const NXCPMessage& msg)
  */
 void Table::updateFromMessage(const NXCPMessage& msg)
 {
+   clearInstanceIndex();
    m_columns.clear();
    m_data.clear();
    MemFree(m_title);
@@ -655,6 +1072,8 @@ int Table::fillMessage(NXCPMessage *msg, int offset, int rowLimit) const
  */
 int Table::addColumn(const TCHAR *name, int32_t dataType, const TCHAR *displayName, bool isInstance)
 {
+   if (isInstance)
+      clearInstanceIndex();
    m_columns.add(new TableColumnDefinition(name, displayName, dataType, isInstance));
    for(int i = 0; i < m_data.size(); i++)
       m_data.get(i)->addColumn();
@@ -666,6 +1085,8 @@ int Table::addColumn(const TCHAR *name, int32_t dataType, const TCHAR *displayNa
  */
 int Table::addColumn(const TableColumnDefinition& d)
 {
+   if (d.isInstanceColumn())
+      clearInstanceIndex();
    m_columns.add(new TableColumnDefinition(d));
    for(int i = 0; i < m_data.size(); i++)
       m_data.get(i)->addColumn();
@@ -699,6 +1120,14 @@ int Table::addRow()
  */
 void Table::deleteRow(int row)
 {
+   if ((row < 0) || (row >= m_data.size()))
+      return;
+
+   // Indexes of all following rows are changed, so index should be rebuilt if deleted row was indexed
+   m_instanceIndexLock.lock();
+   if (row < m_indexedRows)
+      destroyInstanceIndex();
+   m_instanceIndexLock.unlock();
    m_data.remove(row);
 }
 
@@ -710,21 +1139,54 @@ void Table::deleteColumn(int col)
    if ((col < 0) || (col >= m_columns.size()))
       return;
 
+   if (m_columns.get(col)->isInstanceColumn())
+      clearInstanceIndex();
    m_columns.remove(col);
    for(int i = 0; i < m_data.size(); i++)
       m_data.get(i)->deleteColumn(col);
 }
 
+/**
+ * Set column data type. Numeric representation of all cells in that column is updated accordingly.
+ */
+void Table::setColumnDataType(int col, int32_t dataType)
+{
+   if ((col < 0) || (col >= m_columns.size()))
+      return;
+
+   m_columns.get(col)->setDataType(dataType);
+   for(int i = 0; i < m_data.size(); i++)
+      m_data.get(i)->updateNumericValue(col, dataType);
+}
+
+/**
+ * Set or clear instance flag for column
+ */
+void Table::setInstanceColumn(int col, bool isInstance)
+{
+   TableColumnDefinition *c = m_columns.get(col);
+   if ((c == nullptr) || (c->isInstanceColumn() == isInstance))
+      return;
+
+   c->setInstanceColumn(isInstance);
+   clearInstanceIndex();
+}
+
+/**
+ * Update numeric representation of all cells in given row
+ */
+void Table::updateNumericValues(TableRow *row)
+{
+   for(int i = 0; i < m_columns.size(); i++)
+      row->updateNumericValue(i, m_columns.get(i)->getDataType());
+}
+
 /**
  * Set data at position
  */
 void Table::setAt(int nRow, int nCol, const TCHAR *value)
 {
-   TableRow *r = m_data.get(nRow);
-   if (r != NULL)
-   {
-      r->setValue(nCol, value);
-   }
+   setPreallocatedAt(nRow, nCol, MemCopyString(value));
 }
 
 /**
@@ -733,13 +1195,30 @@ void Table::setAt(int nRow, int nCol, const TCHAR *value)
 void Table::setPreallocatedAt(int nRow, int nCol, TCHAR *value)
 {
    TableRow *r = m_data.get(nRow);
-   if (r != NULL)
+   if (r == nullptr)
    {
-      r->setPreallocatedValue(nCol, value);
+      MemFree(value);
+      return;
    }
-   else
+
+   const TableColumnDefinition *c = m_columns.get(nCol);
+   bool instance = (c != nullptr) && c->isInstanceColumn();
+   if (instance)
    {
-      MemFree(value);
+      m_instanceIndexLock.lock();
+      if (nRow < m_indexedRows)
+         removeFromInstanceIndex(nRow);
+   }
+
+   r->setPreallocatedValue(nCol, value);
+   if (c != nullptr)
+      r->updateNumericValue(nCol, c->getDataType());
+
+   if (instance)
+   {
+      if (nRow < m_indexedRows)
+         addToInstanceIndex(nRow);
+      m_instanceIndexLock.unlock();
    }
 }
 
@@ -810,7 +1289,12 @@ const TCHAR *Table::getAsString(int nRow, int nCol, const TCHAR *defaultValue) c
  */
 int32_t Table::getAsInt(int nRow, int nCol) const
 {
-   const TCHAR *v = getAsString(nRow, nCol);
+   const TableCell *c = getCell(nRow, nCol);
+   if (c == nullptr)
+      return 0;
+   if (c->getNumericType() == TableCellNumericType::INTEGER)
+      return static_cast<int32_t>(c->getIntegerValue());
+   const TCHAR *v = c->getValue();
    return v != nullptr ? _tcstol(v, nullptr, 0) : 0;
 }
 
@@ -819,7 +1303,12 @@ int32_t Table::getAsInt(int nRow, int nCol) const
  */
 uint32_t Table::getAsUInt(int nRow, int nCol) const
 {
-   const TCHAR *v = getAsString(nRow, nCol);
+   const TableCell *c = getCell(nRow, nCol);
+   if (c == nullptr)
+      return 0;
+   if (c->getNumericType() == TableCellNumericType::UNSIGNED)
+      return static_cast<uint32_t>(c->getUnsignedValue());
+   const TCHAR *v = c->getValue();
    return v != nullptr ? _tcstoul(v, nullptr, 0) : 0;
 }
 
@@ -828,7 +1317,12 @@ uint32_t Table::getAsUInt(int nRow, int nCol) const
  */
 int64_t Table::getAsInt64(int nRow, int nCol) const
 {
-   const TCHAR *v = getAsString(nRow, nCol);
+   const TableCell *c = getCell(nRow, nCol);
+   if (c == nullptr)
+      return 0;
+   if (c->getNumericType() == TableCellNumericType::INTEGER)
+      return c->getIntegerValue();
+   const TCHAR *v = c->getValue();
    return v != nullptr ? _tcstoll(v, nullptr, 0) : 0;
 }
 
@@ -837,7 +1331,12 @@ int64_t Table::getAsInt64(int nRow, int nCol) const
  */
 uint64_t Table::getAsUInt64(int nRow, int nCol) const
 {
-   const TCHAR *v = getAsString(nRow, nCol);
+   const TableCell *c = getCell(nRow, nCol);
+   if (c == nullptr)
+      return 0;
+   if (c->getNumericType() == TableCellNumericType::UNSIGNED)
+      return c->getUnsignedValue();
+   const TCHAR *v = c->getValue();
    return v != nullptr ? _tcstoull(v, nullptr, 0) : 0;
 }
 
@@ -846,7 +1345,12 @@ uint64_t Table::getAsUInt64(int nRow, int nCol) const
  */
 double Table::getAsDouble(int nRow, int nCol) const
 {
-   const TCHAR *v = getAsString(nRow, nCol);
+   const TableCell *c = getCell(nRow, nCol);
+   if (c == nullptr)
+      return 0;
+   if (c->getNumericType() == TableCellNumericType::FLOAT)
+      return c->getFloatValue();
+   const TCHAR *v = c->getValue();
    return v != nullptr ? _tcstod(v, nullptr) : 0;
 }
 
@@ -912,6 +1416,7 @@ void Table::addAll(const Table *src)
       {
          dstRow->set(j, srcRow->getValue(j), srcRow->getStatus(j), srcRow->getCellObjectId(j));
       }
+      updateNumericValues(dstRow);
       m_data.add(dstRow);
    }
 }
@@ -932,6 +1437,7 @@ int Table::copyRow(const Table *src, int row)
    {
       dstRow->set(j, srcRow->getValue(j), srcRow->getStatus(j), srcRow->getCellObjectId(j));
    }
+   updateNumericValues(dstRow);
 
    return m_data.add(dstRow);
 }
@@ -963,6 +1469,7 @@ void Table::merge(const Table *src)
       {
          dstRow->set(tran[c], srcRow->getValue(c), srcRow->getStatus(c), srcRow->getCellObjectId(c));
       }
+      updateNumericValues(dstRow);
       m_data.add(dstRow);
    }
 
@@ -997,6 +1504,7 @@ int Table::mergeRow(const Table *src, int row)
    {
       dstRow->set(tran[c], srcRow->getValue(c), srcRow->getStatus(c), srcRow->getCellObjectId(c));
    }
+   updateNumericValues(dstRow);
 
    MemFreeLocal(tran);
    return m_data.add(dstRow);
@@ -1005,52 +1513,124 @@ int Table::mergeRow(const Table *src, int row)
 /**
  * Build instance string
  */
-void Table::buildInstanceString(int row, TCHAR *buffer, size_t bufLen)
+void Table::buildInstanceString(int row, StringBuffer *instance) const
 {
-   TableRow *r = m_data.get(row);
-   if (r == NULL)
-   {
-      buffer[0] = 0;
+   const TableRow *r = m_data.get(row);
+   if (r == nullptr)
       return;
-   }
 
-   StringBuffer instance;
    bool first = true;
    for(int i = 0; i < m_columns.size(); i++)
    {
       if (m_columns.get(i)->isInstanceColumn())
       {
          if (!first)
-            instance += _T("~~~");
+            instance->append(_T("~~~"));
          first = false;
          const TCHAR *value = r->getValue(i);
-         if (value != NULL)
-            instance += value;
+         if (value != nullptr)
+            instance->append(value);
       }
    }
-   if (instance.isEmpty())
+   if (instance->isEmpty())
    {
-      instance.append(_T("#"));
-      instance.append(row);
+      instance->append(_T("#"));
+      instance->append(row);
    }
+}
+
+/**
+ * Build instance string
+ */
+void Table::buildInstanceString(int row, TCHAR *buffer, size_t bufLen)
+{
+   StringBuffer instance;
+   buildInstanceString(row, &instance);
    _tcslcpy(buffer, instance.cstr(), bufLen);
 }
 
 /**
- * Find row by instance value
+ * Add given row to instance index. If another row with same instance already indexed, lower row number is kept.
+ * Should be called with index lock held.
+ */
+void Table::addToInstanceIndex(int row)
+{
+   StringBuffer instance;
+   buildInstanceString(row, &instance);
+   int keyLen = static_cast<int>(instance.length() * sizeof(TCHAR));
+
+   TableInstanceIndexEntry *entry;
+   HASH_FIND(hh, m_instanceIndex, instance.cstr(), keyLen, entry);
+   if (entry == nullptr)
+   {
+      entry = static_cast<TableInstanceIndexEntry*>(MemAlloc(sizeof(TableInstanceIndexEntry) + instance.length() * sizeof(TCHAR)));
+      memcpy(entry->key, instance.cstr(), (instance.length() + 1) * sizeof(TCHAR));
+      entry->row = row;
+      HASH_ADD_KEYPTR(hh, m_instanceIndex, entry->key, keyLen, entry);
+   }
+   else if (entry->row > row)
+   {
+      entry->row = row;
+   }
+}
+
+/**
+ * Remove given row from instance index before change of instance column value. Should be called with index lock held.
+ */
+void Table::removeFromInstanceIndex(int row)
+{
+   StringBuffer instance;
+   buildInstanceString(row, &instance);
+
+   TableInstanceIndexEntry *entry;
+   HASH_FIND(hh, m_instanceIndex, instance.cstr(), static_cast<int>(instance.length() * sizeof(TCHAR)), entry);
+
+   // Other rows with same instance may exist but are not recorded in index, so index has to be rebuilt
+   if ((entry != nullptr) && (entry->row == row))
+      destroyInstanceIndex();
+}
+
+/**
+ * Destroy instance index. Should be called with index lock held.
+ */
+void Table::destroyInstanceIndex()
+{
+   TableInstanceIndexEntry *entry, *tmp;
+   HASH_ITER(hh, m_instanceIndex, entry, tmp)
+   {
+      HASH_DEL(m_instanceIndex, entry);
+      MemFree(entry);
+   }
+   m_indexedRows = 0;
+}
+
+/**
+ * Clear instance index. It will be rebuilt on next lookup.
+ */
+void Table::clearInstanceIndex()
+{
+   m_instanceIndexLock.lock();
+   destroyInstanceIndex();
+   m_instanceIndexLock.unlock();
+}
+
+/**
+ * Find row by instance value. Uses hash index which is built on first call and then maintained on table
+ * modifications. Rows added since last lookup are indexed on next lookup.
  *
  * @return row number or -1 if no such row
  */
 int Table::findRowByInstance(const TCHAR *instance)
 {
-   for(int i = 0; i < m_data.size(); i++)
-   {
-      TCHAR currInstance[256];
-      buildInstanceString(i, currInstance, 256);
-      if (!_tcscmp(instance, currInstance))
-         return i;
-   }
-   return -1;
+   m_instanceIndexLock.lock();
+   for(; m_indexedRows < m_data.size(); m_indexedRows++)
+      addToInstanceIndex(m_indexedRows);
+
+   TableInstanceIndexEntry *entry;
+   HASH_FIND(hh, m_instanceIndex, instance, static_cast<int>(_tcslen(instance) * sizeof(TCHAR)), entry);
+   int row = (entry != nullptr) ? entry->row : -1;
+   m_instanceIndexLock.unlock();
+   return row;
 }
 
 /**
@@ -87,7 +87,7 @@ void NXSL_Compiler::error(const char *pszMsg)
 /**
  * Compile source code
  */
-NXSL_Program *NXSL_Compiler::compile(const TCHAR *sourceCode, NXSL_Environment *env)
+NXSL_Program *NXSL_Compiler::compile(const TCHAR *sourceCode, NXSL_Environment *env, bool fullOptimization)
 {
    m_lexer = new NXSL_Lexer(this, sourceCode);
 
@@ -100,7 +100,7 @@ NXSL_Program *NXSL_Compiler::compile(const TCHAR *sourceCode, NXSL_Environment *
    if (yyparse(scanner, m_lexer, this, &builder) == 0)
    {
       builder.resolveFunctions();
-		builder.optimize();
+		builder.optimize(fullOptimization);
 		code = new NXSL_Program(&builder);
    }
 	yylex_destroy(scanner);
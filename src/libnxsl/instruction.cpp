@@ -131,6 +131,8 @@ OperandType NXSL_Instruction::getOperandType() const
          return OP_TYPE_ADDR;
       case OPCODE_CALL_EXTPTR:
          return OP_TYPE_EXT_FUNCTION;
+      case OPCODE_ARITH_INT32:
+      case OPCODE_COMPARE_INT32:
       case OPCODE_PUSH_INT32:
          return OP_TYPE_INT32;
       case OPCODE_PUSH_INT64:
@@ -154,6 +154,8 @@ typedef void *yyscan_t;
 #define OPCODE_ARGV           109
 #define OPCODE_APPEND_ALL     110
 #define OPCODE_FSTRING        111
+#define OPCODE_COMPARE_INT32  112
+#define OPCODE_ARITH_INT32    113
 
 class NXSL_Compiler;
 
@@ -231,6 +233,10 @@ class NXSL_ProgramBuilder : public NXSL_ValueManager
 
    uint32_t getFinalJumpDestination(uint32_t addr, int srcJump);
    uint32_t getExpressionVariableCodeBlock(const NXSL_Identifier& identifier);
+   bool isJumpTarget(uint32_t addr) const;
+   void foldConstants();
+   void removeUnreachableCode();
+   void fuseInstructions();
 
    NXSL_Instruction *addInstructionPlaceholder(int line, int16_t opCode)
    {
@@ -280,7 +286,7 @@ class NXSL_ProgramBuilder : public NXSL_ValueManager
    void resolveLastJump(int opcode, int offset = 0);
    void createJumpAt(uint32_t opAddr, uint32_t jumpAddr);
    void addRequiredModule(const char *name, int lineNumber, bool removeLastElement);
-   void optimize();
+   void optimize(bool fullOptimization = true);
    void removeInstructions(uint32_t start, int count);
    bool addConstant(const NXSL_Identifier& name, NXSL_Value *value);
    NXSL_Value *getConstantValue(const NXSL_Identifier& name);
@@ -355,7 +361,7 @@ class NXSL_Compiler
    NXSL_Compiler();
    ~NXSL_Compiler();
 
-   NXSL_Program *compile(const TCHAR *sourceCode, NXSL_Environment *env);
+   NXSL_Program *compile(const TCHAR *sourceCode, NXSL_Environment *env, bool fullOptimization = true);
    void error(const char *pszMsg);
 
    const TCHAR *getErrorText() { return CHECK_NULL(m_errorText); }
@@ -394,6 +400,12 @@ struct NXSL_ClassRegistry
 };
 
 
+//
+// Functions
+//
+
+int SelectResultType(int dataTypeLeft, int dataTypeRight, int operation);
+
 //
 // Global variables
 //
@@ -23,12 +23,32 @@
 
 #include "libnxsl.h"
 
+/**
+ * Default VM pool limits
+ */
+#define DEFAULT_VM_POOL_LIMIT_PER_PROGRAM    8
+#define DEFAULT_VM_POOL_LIMIT_TOTAL          1024
+
 /**
  * Constructor
  */
-NXSL_Library::NXSL_Library() : m_mutex(MutexType::FAST)
+NXSL_Library::NXSL_Library() : m_mutex(MutexType::FAST), m_vmPool(Ownership::True), m_vmPoolMutex(MutexType::FAST)
 {
    m_scriptList = new ObjectArray<NXSL_LibraryScript>(16, 16, Ownership::True);
+   m_generation = 0;
+   m_vmPoolSize = 0;
+   m_vmPoolLimitPerProgram = DEFAULT_VM_POOL_LIMIT_PER_PROGRAM;
+   m_vmPoolLimitTotal = DEFAULT_VM_POOL_LIMIT_TOTAL;
+}
+
+/**
+ * Destroy all VMs in pool list
+ */
+static EnumerationCallbackResult DestroyPooledVMs(const uint64_t& key, StructArray<NXSL_PooledVM> *list)
+{
+   for(int i = 0; i < list->size(); i++)
+      delete list->get(i)->vm;
+   return _CONTINUE;
 }
 
 /**
@@ -36,6 +56,7 @@ NXSL_Library::NXSL_Library() : m_mutex(MutexType::FAST)
  */
 NXSL_Library::~NXSL_Library()
 {
+   m_vmPool.forEach(DestroyPooledVMs);
    delete m_scriptList;
 }
 
@@ -45,6 +66,7 @@ NXSL_Library::~NXSL_Library()
 bool NXSL_Library::addScript(NXSL_LibraryScript *script)
 {
    m_scriptList->add(script);
+   InterlockedIncrement64(&m_generation);
    return true;
 }
 
@@ -57,6 +79,7 @@ void NXSL_Library::deleteScript(const TCHAR *pszName)
       if (!_tcsicmp(m_scriptList->get(i)->getName(), pszName))
       {
          m_scriptList->remove(i);
+         InterlockedIncrement64(&m_generation);
          break;
       }
 }
@@ -70,6 +93,7 @@ void NXSL_Library::deleteScript(uint32_t id)
       if (m_scriptList->get(i)->getId() == id)
       {
          m_scriptList->remove(i);
+         InterlockedIncrement64(&m_generation);
          break;
       }
 }
@@ -134,9 +158,11 @@ void NXSL_Library::forEach(std::function<void (const NXSL_LibraryScript*)> callb
 /**
  * Create ready to run VM for given script using provided environment creator and script validator.
  * This method will do library lock internally.
- * VM must be deleted by caller when no longer needed.
+ * VM must be destroyed by caller via handle's destroy() method when no longer needed. If usePool is true,
+ * VM can be taken from library's VM pool and will be returned to it on destroy().
  */
-ScriptVMHandle NXSL_Library::createVM(const TCHAR *name, std::function<NXSL_Environment *()> environmentCreator, std::function<ScriptVMFailureReason (NXSL_LibraryScript*)> scriptValidator)
+ScriptVMHandle NXSL_Library::createVM(const TCHAR *name, std::function<NXSL_Environment *()> environmentCreator,
+         std::function<ScriptVMFailureReason (NXSL_LibraryScript*)> scriptValidator, bool usePool)
 {
    lock();
    NXSL_LibraryScript *s = findScript(name);
@@ -158,6 +184,13 @@ ScriptVMHandle NXSL_Library::createVM(const TCHAR *name, std::function<NXSL_Envi
 
       if (reson == ScriptVMFailureReason::SUCCESS)
       {
+         if (usePool)
+         {
+            ScriptVMHandle handle = acquireVM(s->getProgram(), environmentCreator);
+            unlock();
+            return handle;
+         }
+
          vm = new NXSL_VM(environmentCreator());
          if (!vm->load(s->getProgram()))
          {
@@ -171,6 +204,173 @@ ScriptVMHandle NXSL_Library::createVM(const TCHAR *name, std::function<NXSL_Envi
    return (vm != nullptr) ? ScriptVMHandle(vm) : ScriptVMHandle(reson);
 }
 
+/**
+ * Get ready to run VM for given program from VM pool or create new one if there are no idle VMs for that program.
+ * VM is returned to the pool when handle's destroy() method is called. Pooled VMs are invalidated when any
+ * library script is added or deleted, because program may import changed library script as module.
+ * Program code is not shared between VMs - each pooled VM holds its own copy of instructions, constants and
+ * linked modules, made once when VM is created.
+ */
+ScriptVMHandle NXSL_Library::acquireVM(const NXSL_Program *program, std::function<NXSL_Environment *()> environmentCreator)
+{
+   uint64_t generation = static_cast<uint64_t>(m_generation);
+   NXSL_VM *vm = nullptr;
+   ObjectRefArray<NXSL_VM> staleVMs(0, 16);
+
+   m_vmPoolMutex.lock();
+   StructArray<NXSL_PooledVM> *list = m_vmPool.get(program->getId());
+   if (list != nullptr)
+   {
+      while(!list->isEmpty())
+      {
+         // Use most recently released VM first - it is most likely to be in CPU cache
+         NXSL_PooledVM *e = list->get(list->size() - 1);
+         NXSL_VM *candidate = e->vm;
+         bool valid = (e->generation == generation);
+         list->remove(list->size() - 1);
+         m_vmPoolSize--;
+         if (valid)
+         {
+            vm = candidate;
+            break;
+         }
+         staleVMs.add(candidate);
+      }
+   }
+   m_vmPoolMutex.unlock();
+
+   for(int i = 0; i < staleVMs.size(); i++)
+      delete staleVMs.get(i);
+
+   if (vm == nullptr)
+   {
+      vm = new NXSL_VM(environmentCreator());
+      if (!vm->load(program))
+      {
+         delete vm;
+         return ScriptVMHandle(ScriptVMFailureReason::SCRIPT_LOAD_ERROR);
+      }
+   }
+   return ScriptVMHandle(vm, this, program->getId(), generation);
+}
+
+/**
+ * Return VM to the pool. VM will be destroyed if pool is full or VM is outdated.
+ */
+void NXSL_Library::releaseVM(NXSL_VM *vm, uint64_t programId, uint64_t generation)
+{
+   if (generation != static_cast<uint64_t>(m_generation))
+   {
+      delete vm;
+      return;
+   }
+
+   vm->reset();
+
+   bool pooled = false;
+   m_vmPoolMutex.lock();
+   if (m_vmPoolSize < m_vmPoolLimitTotal)
+   {
+      StructArray<NXSL_PooledVM> *list = m_vmPool.get(programId);
+      if (list == nullptr)
+      {
+         list = new StructArray<NXSL_PooledVM>(0, 8);
+         m_vmPool.set(programId, list);
+      }
+      if (list->size() < m_vmPoolLimitPerProgram)
+      {
+         NXSL_PooledVM *e = list->addPlaceholder();
+         e->vm = vm;
+         e->generation = generation;
+         e->releaseTime = time(nullptr);
+         m_vmPoolSize++;
+         pooled = true;
+      }
+   }
+   m_vmPoolMutex.unlock();
+
+   if (!pooled)
+      delete vm;
+}
+
+/**
+ * Context for VM pool purge
+ */
+struct VMPoolPurgeContext
+{
+   time_t cutoffTime;
+   uint64_t generation;
+   ObjectRefArray<NXSL_VM> *vms;
+   IntegerArray<uint64_t> *emptyLists;
+};
+
+/**
+ * Remove expired VMs from pool list
+ */
+static EnumerationCallbackResult PurgePooledVMs(const uint64_t& key, StructArray<NXSL_PooledVM> *list, VMPoolPurgeContext *context)
+{
+   for(int i = 0; i < list->size(); i++)
+   {
+      NXSL_PooledVM *e = list->get(i);
+      if ((e->releaseTime < context->cutoffTime) || (e->generation != context->generation))
+      {
+         context->vms->add(e->vm);
+         list->remove(i);
+         i--;
+      }
+   }
+   if (list->isEmpty())
+      context->emptyLists->add(key);
+   return _CONTINUE;
+}
+
+/**
+ * Destroy VMs which were idle for more than given number of seconds, as well as outdated VMs
+ */
+void NXSL_Library::purgeVMPool(time_t maxIdleTime)
+{
+   ObjectRefArray<NXSL_VM> vms(0, 64);
+   IntegerArray<uint64_t> emptyLists(0, 64);
+
+   VMPoolPurgeContext context;
+   context.cutoffTime = time(nullptr) - maxIdleTime;
+   context.generation = static_cast<uint64_t>(m_generation);
+   context.vms = &vms;
+   context.emptyLists = &emptyLists;
+
+   m_vmPoolMutex.lock();
+   m_vmPool.forEach(PurgePooledVMs, &context);
+   for(int i = 0; i < emptyLists.size(); i++)
+      m_vmPool.remove(emptyLists.get(i));
+   m_vmPoolSize -= vms.size();
+   m_vmPoolMutex.unlock();
+
+   for(int i = 0; i < vms.size(); i++)
+      delete vms.get(i);
+}
+
+/**
+ * Set VM pool limits. Setting per program limit to 0 effectively disables pooling.
+ */
+void NXSL_Library::setVMPoolLimits(int perProgram, int total)
+{
+   m_vmPoolMutex.lock();
+   m_vmPoolLimitPerProgram = std::max(perProgram, 0);
+   m_vmPoolLimitTotal = std::max(total, 0);
+   m_vmPoolMutex.unlock();
+}
+
+/**
+ * Get number of idle VMs in pool
+ */
+int NXSL_Library::getVMPoolSize() const
+{
+   m_vmPoolMutex.lock();
+   int size = m_vmPoolSize;
+   m_vmPoolMutex.unlock();
+   return size;
+}
+
 /**
  * Create ready to run VM for given script. This method will do library lock internally.
  * VM must be deleted by caller when no longer needed.
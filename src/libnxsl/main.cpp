@@ -26,10 +26,10 @@
 /**
  * Interface to compiler
  */
-NXSL_Program LIBNXSL_EXPORTABLE *NXSLCompile(const TCHAR *source, TCHAR *errorMessage, size_t errorMessageLen, int *errorLine, NXSL_Environment *env)
+NXSL_Program LIBNXSL_EXPORTABLE *NXSLCompile(const TCHAR *source, TCHAR *errorMessage, size_t errorMessageLen, int *errorLine, NXSL_Environment *env, bool fullOptimization)
 {
    NXSL_Compiler compiler;
-   NXSL_Program *pResult = compiler.compile(source, env);
+   NXSL_Program *pResult = compiler.compile(source, env, fullOptimization);
    if (pResult == nullptr)
    {
       if (errorMessage != nullptr)
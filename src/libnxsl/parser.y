@@ -334,7 +334,7 @@ Metadata:
 ;
 
 MetadataValues:
-	MetadataValue ',' MetadataValue
+	MetadataValue ',' MetadataValues
 |	MetadataValue
 ;
 
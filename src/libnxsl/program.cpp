@@ -59,7 +59,7 @@ static const char *s_nxslCommandMnemonic[] =
    "CASELT", "CASEGT", "CASEGT", "PUSH",
    "PUSH", "PUSH", "PUSH", "PUSH", "PUSH",
    "PUSH", "PUSH", "SPREAD", "ARGV", "APPEND",
-   "FSTR"
+   "FSTR", "CMPI", "ARITHI"
 };
 
 /**
@@ -408,6 +408,10 @@ void NXSL_ProgramBuilder::dump(FILE *fp, uint32_t addr, const NXSL_Instruction&
       case OPCODE_PUSH_UINT64:
          _ftprintf(fp, UINT64_FMT _T("UL\n"), instruction.m_operand.m_valueUInt64);
          break;
+      case OPCODE_COMPARE_INT32:
+      case OPCODE_ARITH_INT32:
+         _ftprintf(fp, _T("%hs, %d\n"), s_nxslCommandMnemonic[instruction.m_stackItems], instruction.m_operand.m_valueInt32);
+         break;
       case OPCODE_APPEND:
          _ftprintf(fp, _T("ELEMENT\n"));
          break;
@@ -451,27 +455,399 @@ template<typename T> static inline bool ValidateConstantConversion(T intValue, c
 }
 
 /**
- * Optimize compiled program
+ * Check if instruction at given address can be entered other than by falling through from previous instruction
+ */
+bool NXSL_ProgramBuilder::isJumpTarget(uint32_t addr) const
+{
+   for(int i = 0; i < m_instructionSet.size(); i++)
+   {
+      const NXSL_Instruction *instr = m_instructionSet.get(i);
+      if ((instr->getOperandType() == OP_TYPE_ADDR) && (instr->m_operand.m_addr == addr))
+         return true;
+      if ((instr->m_addr2 != INVALID_ADDRESS) && (instr->m_addr2 == addr))
+         return true;
+      switch(instr->m_opCode)
+      {
+         case OPCODE_PUSHCP:
+            if (static_cast<uint32_t>(i + instr->m_stackItems) == addr)
+               return true;
+            break;
+         case OPCODE_PUSH_EXPRVAR:
+         case OPCODE_UPDATE_EXPRVAR:
+            // Expression code block returns to next instruction, otherwise next instruction is skipped
+            if ((static_cast<uint32_t>(i + 1) == addr) || (static_cast<uint32_t>(i + 2) == addr))
+               return true;
+            break;
+         default:
+            break;
+      }
+   }
+   for(int i = 0; i < m_functions.size(); i++)
+      if (m_functions.get(i)->m_addr == addr)
+         return true;
+   return false;
+}
+
+/**
+ * Evaluate binary operation on two constant operands. Mirrors NXSL_VM::doBinaryOperation for the supported
+ * operations. Returns nullptr if operation cannot be evaluated at compile time (including cases that will
+ * cause runtime error).
+ */
+static NXSL_Value *EvaluateConstantExpression(NXSL_ValueManager *vm, int opcode, NXSL_Value *v1, NXSL_Value *v2)
+{
+   if ((v1->isNull() || v2->isNull()) && (opcode != OPCODE_EQ) && (opcode != OPCODE_NE))
+      return nullptr;
+
+   if (v1->isNumeric() && v2->isNumeric() && (opcode != OPCODE_CONCAT) && (opcode != OPCODE_LIKE) && (opcode != OPCODE_ILIKE))
+   {
+      int type = SelectResultType(v1->getDataType(), v2->getDataType(), opcode);
+      if (type == NXSL_DT_NULL)
+         return nullptr;
+
+      NXSL_Value *left = vm->createValue(v1);
+      NXSL_Value *right = vm->createValue(v2);
+      NXSL_Value *result = nullptr;
+      if (left->convert(type) && right->convert(type) &&
+          !(((opcode == OPCODE_DIV) || (opcode == OPCODE_IDIV) || (opcode == OPCODE_REM)) && right->isFalse()))
+      {
+         switch(opcode)
+         {
+            case OPCODE_ADD:
+               left->add(right);
+               result = left;
+               break;
+            case OPCODE_SUB:
+               left->sub(right);
+               result = left;
+               break;
+            case OPCODE_MUL:
+               left->mul(right);
+               result = left;
+               break;
+            case OPCODE_DIV:
+            case OPCODE_IDIV:
+               left->div(right);
+               result = left;
+               break;
+            case OPCODE_REM:
+               left->rem(right);
+               result = left;
+               break;
+            case OPCODE_EQ:
+               result = vm->createValue(left->EQ(right));
+               break;
+            case OPCODE_NE:
+               result = vm->createValue(!left->EQ(right));
+               break;
+            case OPCODE_LT:
+               result = vm->createValue(left->LT(right));
+               break;
+            case OPCODE_LE:
+               result = vm->createValue(left->LE(right));
+               break;
+            case OPCODE_GT:
+               result = vm->createValue(left->GT(right));
+               break;
+            case OPCODE_GE:
+               result = vm->createValue(left->GE(right));
+               break;
+            case OPCODE_LSHIFT:
+               left->lshift(right->getValueAsInt32());
+               result = left;
+               break;
+            case OPCODE_RSHIFT:
+               left->rshift(right->getValueAsInt32());
+               result = left;
+               break;
+            case OPCODE_BIT_AND:
+               left->bitAnd(right);
+               result = left;
+               break;
+            case OPCODE_BIT_OR:
+               left->bitOr(right);
+               result = left;
+               break;
+            case OPCODE_BIT_XOR:
+               left->bitXor(right);
+               result = left;
+               break;
+            default:
+               break;
+         }
+      }
+      if (result != left)
+         vm->destroyValue(left);
+      vm->destroyValue(right);
+      return result;
+   }
+
+   switch(opcode)
+   {
+      case OPCODE_EQ:
+      case OPCODE_NE:
+         {
+            bool equals;
+            if (v1->isNull() && v2->isNull())
+            {
+               equals = true;
+            }
+            else if (v1->isNull() || v2->isNull())
+            {
+               equals = false;
+            }
+            else
+            {
+               uint32_t len1, len2;
+               const TCHAR *s1 = v1->getValueAsString(&len1);
+               const TCHAR *s2 = v2->getValueAsString(&len2);
+               equals = (len1 == len2) && (memcmp(s1, s2, len1 * sizeof(TCHAR)) == 0);
+            }
+            return vm->createValue((opcode == OPCODE_EQ) ? equals : !equals);
+         }
+      case OPCODE_CONCAT:
+         {
+            NXSL_Value *result = vm->createValue(v1);
+            if (!result->convert(NXSL_DT_STRING))
+            {
+               vm->destroyValue(result);
+               return nullptr;
+            }
+            uint32_t len;
+            const TCHAR *s = v2->getValueAsString(&len);
+            result->concatenate(s, len);
+            return result;
+         }
+      case OPCODE_LIKE:
+      case OPCODE_ILIKE:
+         return vm->createValue(MatchString(v2->getValueAsCString(), v1->getValueAsCString(), opcode == OPCODE_LIKE));
+      default:
+         return nullptr;
+   }
+}
+
+/**
+ * Fold operations on constant operands into single constant
  */
-void NXSL_ProgramBuilder::optimize()
+void NXSL_ProgramBuilder::foldConstants()
+{
+   for(int i = 0; i < m_instructionSet.size() - 2; i++)
+   {
+      NXSL_Instruction *instr = m_instructionSet.get(i);
+      if ((instr->m_opCode != OPCODE_PUSH_CONSTANT) || (!instr->m_operand.m_constant->isNull() && !instr->m_operand.m_constant->isString()))
+         continue;
+
+      // Unary operations
+      NXSL_Instruction *next = m_instructionSet.get(i + 1);
+      if (((next->m_opCode == OPCODE_NOT) || ((next->m_opCode == OPCODE_BIT_NOT) && instr->m_operand.m_constant->isInteger())) && !isJumpTarget(i + 1))
+      {
+         NXSL_Value *value = instr->m_operand.m_constant;
+         if (next->m_opCode == OPCODE_NOT)
+            value->set(value->isFalse());
+         else
+            value->bitNot();
+         removeInstructions(i + 1, 1);
+         i = std::max(i - 2, -1);
+         continue;
+      }
+
+      // Binary operations
+      if ((i + 3 >= m_instructionSet.size()) || (next->m_opCode != OPCODE_PUSH_CONSTANT) || (!next->m_operand.m_constant->isNull() && !next->m_operand.m_constant->isString()))
+         continue;
+
+      NXSL_Instruction *op = m_instructionSet.get(i + 2);
+      switch(op->m_opCode)
+      {
+         case OPCODE_ADD:
+         case OPCODE_SUB:
+         case OPCODE_MUL:
+         case OPCODE_DIV:
+         case OPCODE_IDIV:
+         case OPCODE_REM:
+         case OPCODE_EQ:
+         case OPCODE_NE:
+         case OPCODE_LT:
+         case OPCODE_LE:
+         case OPCODE_GT:
+         case OPCODE_GE:
+         case OPCODE_LSHIFT:
+         case OPCODE_RSHIFT:
+         case OPCODE_BIT_AND:
+         case OPCODE_BIT_OR:
+         case OPCODE_BIT_XOR:
+         case OPCODE_CONCAT:
+         case OPCODE_LIKE:
+         case OPCODE_ILIKE:
+            break;
+         default:
+            continue;
+      }
+
+      if (isJumpTarget(i + 1) || isJumpTarget(i + 2))
+         continue;
+
+      NXSL_Value *result = EvaluateConstantExpression(this, op->m_opCode, instr->m_operand.m_constant, next->m_operand.m_constant);
+      if (result == nullptr)
+         continue;
+
+      destroyValue(instr->m_operand.m_constant);
+      instr->m_operand.m_constant = result;
+      removeInstructions(i + 1, 2);
+      i = std::max(i - 2, -1);   // result may be an operand of enclosing expression
+   }
+}
+
+/**
+ * Remove instructions that cannot be reached from program entry point or any function
+ */
+void NXSL_ProgramBuilder::removeUnreachableCode()
+{
+   uint32_t size = static_cast<uint32_t>(m_instructionSet.size());
+   if (size < 2)
+      return;
+
+   bool *reachable = MemAllocArray<bool>(size);
+   IntegerArray<uint32_t> pending(64, 64);
+   pending.add(0);
+   for(int i = 0; i < m_functions.size(); i++)
+      pending.add(m_functions.get(i)->m_addr);
+
+   while(!pending.isEmpty())
+   {
+      uint32_t addr = pending.get(pending.size() - 1);
+      pending.remove(pending.size() - 1);
+      if ((addr >= size) || reachable[addr])
+         continue;
+      reachable[addr] = true;
+
+      const NXSL_Instruction *instr = m_instructionSet.get(addr);
+      switch(instr->m_opCode)
+      {
+         case OPCODE_JMP:
+            pending.add(instr->m_operand.m_addr);
+            break;
+         case OPCODE_RETURN:
+         case OPCODE_RET_NULL:
+         case OPCODE_EXIT:
+         case OPCODE_ABORT:
+            break;
+         case OPCODE_PUSHCP:
+            pending.add(addr + instr->m_stackItems);
+            pending.add(addr + 1);
+            break;
+         case OPCODE_PUSH_EXPRVAR:
+         case OPCODE_UPDATE_EXPRVAR:
+            pending.add(addr + 2);
+            pending.add(addr + 1);
+            break;
+         default:
+            if (instr->getOperandType() == OP_TYPE_ADDR)
+               pending.add(instr->m_operand.m_addr);
+            pending.add(addr + 1);
+            break;
+      }
+      if (instr->m_addr2 != INVALID_ADDRESS)
+         pending.add(instr->m_addr2);
+   }
+
+   // Remove unreachable blocks starting from the end so that positions of blocks not yet processed remain valid
+   for(int i = static_cast<int>(size) - 1; i >= 0; i--)
+   {
+      if (reachable[i])
+         continue;
+      int end = i;
+      while((i > 0) && !reachable[i - 1])
+         i--;
+      removeInstructions(i, end - i + 1);
+   }
+
+   MemFree(reachable);
+}
+
+/**
+ * Replace common instruction sequences with single instructions
+ */
+void NXSL_ProgramBuilder::fuseInstructions()
+{
+   for(int i = 0; i < m_instructionSet.size() - 2; i++)
+   {
+      NXSL_Instruction *instr = m_instructionSet.get(i);
+      NXSL_Instruction *next = m_instructionSet.get(i + 1);
+      switch(instr->m_opCode)
+      {
+         case OPCODE_INC:
+         case OPCODE_DEC:
+         case OPCODE_INCP:
+         case OPCODE_DECP:
+            // Increment or decrement with result discarded
+            if ((instr->m_stackItems == 0) && (next->m_opCode == OPCODE_POP) && (next->m_stackItems == 1) && !isJumpTarget(i + 1))
+            {
+               instr->m_stackItems = 1;
+               removeInstructions(i + 1, 1);
+            }
+            break;
+         case OPCODE_PUSH_INT32:
+            // Comparison or arithmetic operation with integer constant as right operand
+            if (isJumpTarget(i + 1))
+               break;
+            switch(next->m_opCode)
+            {
+               case OPCODE_EQ:
+               case OPCODE_NE:
+               case OPCODE_LT:
+               case OPCODE_LE:
+               case OPCODE_GT:
+               case OPCODE_GE:
+                  instr->m_opCode = OPCODE_COMPARE_INT32;
+                  instr->m_stackItems = next->m_opCode;
+                  removeInstructions(i + 1, 1);
+                  break;
+               case OPCODE_ADD:
+               case OPCODE_SUB:
+                  instr->m_opCode = OPCODE_ARITH_INT32;
+                  instr->m_stackItems = next->m_opCode;
+                  removeInstructions(i + 1, 1);
+                  break;
+               default:
+                  break;
+            }
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+/**
+ * Optimize compiled program. Basic optimizations are always performed, constant folding, unreachable
+ * code removal and instruction fusion only if full optimization is requested.
+ */
+void NXSL_ProgramBuilder::optimize(bool fullOptimization)
 {
 	int i;
 
 	// Convert push constant followed by NEG to single push constant
-	// Convert push integer and boolean constants to special push instructions
 	for(i = 0; (m_instructionSet.size() > 1) && (i < m_instructionSet.size() - 1); i++)
 	{
       NXSL_Instruction *instr = m_instructionSet.get(i);
-		if (instr->m_opCode != OPCODE_PUSH_CONSTANT)
-		   continue;
-
-		if ((m_instructionSet.get(i + 1)->m_opCode == OPCODE_NEG) &&
+		if ((instr->m_opCode == OPCODE_PUSH_CONSTANT) &&
+		    (m_instructionSet.get(i + 1)->m_opCode == OPCODE_NEG) &&
 			 instr->m_operand.m_constant->isNumeric() &&
 			 !instr->m_operand.m_constant->isUnsigned())
 		{
 			instr->m_operand.m_constant->negate();
 			removeInstructions(i + 1, 1);
 		}
+	}
+
+	if (fullOptimization)
+	   foldConstants();
+
+	// Convert push integer and boolean constants to special push instructions
+	for(i = 0; i < m_instructionSet.size(); i++)
+	{
+      NXSL_Instruction *instr = m_instructionSet.get(i);
+		if (instr->m_opCode != OPCODE_PUSH_CONSTANT)
+		   continue;
 
 		switch(instr->m_operand.m_constant->getDataType())
 		{
@@ -591,6 +967,12 @@ void NXSL_ProgramBuilder::optimize()
          removeInstructions(i + 1, 1);
       }
    }
+
+   if (fullOptimization)
+   {
+      removeUnreachableCode();
+      fuseInstructions();
+   }
 }
 
 /**
@@ -668,12 +1050,18 @@ uint64_t NXSL_ProgramBuilder::getMemoryUsage() const
    return mem;
 }
 
+/**
+ * Last assigned program ID
+ */
+static VolatileCounter64 s_programId = 0;
+
 /**
  * Create empty compiled script
  */
 NXSL_Program::NXSL_Program(size_t valueRegionSize, size_t identifierRegionSize) : NXSL_ValueManager(valueRegionSize, identifierRegionSize),
          m_instructionSet(0, 256), m_requiredModules(0, 16), m_constants(this, Ownership::True), m_functions(0, 64)
 {
+   m_id = InterlockedIncrement64(&s_programId);
 }
 
 /**
@@ -700,6 +1088,7 @@ NXSL_Program::NXSL_Program(NXSL_ProgramBuilder *builder) :
    for(int i = 0; i < builder->m_instructionSet.size(); i++)
       m_instructionSet.addPlaceholder()->copyFrom(builder->m_instructionSet.get(i), this);
    builder->m_constants.forEach(CopyConstantsCallback, &m_constants);
+   m_id = InterlockedIncrement64(&s_programId);
 }
 
 /**
@@ -259,20 +259,18 @@ NXSL_Value *NXSL_TableClass::getAttr(NXSL_Object *object, const NXSL_Identifier&
    else if (NXSL_COMPARE_ATTRIBUTE_NAME("columns"))
    {
       NXSL_Array *columns = new NXSL_Array(vm);
-      const ObjectArray<TableColumnDefinition>& cd = table->getColumnDefinitions();
-      for(int i = 0; i < cd.size(); i++)
+      for(int i = 0; i < table->getNumColumns(); i++)
       {
-         columns->set(i, vm->createValue(vm->createObject(&g_nxslTableColumnClass, new TableColumnDefinition(*cd.get(i)))));
+         columns->set(i, vm->createValue(vm->createObject(&g_nxslTableColumnClass, new TableColumnDefinition(*table->getColumnDefinition(i)))));
       }
       value = vm->createValue(columns);
    }
    else if (NXSL_COMPARE_ATTRIBUTE_NAME("instanceColumns"))
    {
       NXSL_Array *columns = new NXSL_Array(vm);
-      const ObjectArray<TableColumnDefinition>& cd = table->getColumnDefinitions();
-      for(int i = 0, j = 0; i < cd.size(); i++)
+      for(int i = 0, j = 0; i < table->getNumColumns(); i++)
       {
-         auto column = cd.get(i);
+         auto column = table->getColumnDefinition(i);
          if (column->isInstanceColumn())
             columns->set(j++, vm->createValue(vm->createObject(&g_nxslTableColumnClass, new TableColumnDefinition(*column))));
       }
@@ -281,11 +279,9 @@ NXSL_Value *NXSL_TableClass::getAttr(NXSL_Object *object, const NXSL_Identifier&
    else if (NXSL_COMPARE_ATTRIBUTE_NAME("instanceColumnIndexes"))
    {
       NXSL_Array *columns = new NXSL_Array(vm);
-      const ObjectArray<TableColumnDefinition>& cd = table->getColumnDefinitions();
-      for(int i = 0, j = 0; i < cd.size(); i++)
+      for(int i = 0, j = 0; i < table->getNumColumns(); i++)
       {
-         auto column = cd.get(i);
-         if (column->isInstanceColumn())
+         if (table->getColumnDefinition(i)->isInstanceColumn())
             columns->set(j++, vm->createValue(i));
       }
       value = vm->createValue(columns);
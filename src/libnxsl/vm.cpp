@@ -117,7 +117,7 @@ static const TCHAR *GetErrorMessage(int error)
 /**
  * Determine operation data type
  */
-static int SelectResultType(int dataTypeLeft, int dataTypeRight, int operation)
+int SelectResultType(int dataTypeLeft, int dataTypeRight, int operation)
 {
    int nType;
 
@@ -161,6 +161,29 @@ static int SelectResultType(int dataTypeLeft, int dataTypeRight, int operation)
    return nType;
 }
 
+/**
+ * Compare two integers using given comparison opcode
+ */
+static inline bool CompareIntegers(int opcode, int64_t left, int64_t right)
+{
+   switch(opcode)
+   {
+      case OPCODE_EQ:
+         return left == right;
+      case OPCODE_NE:
+         return left != right;
+      case OPCODE_LT:
+         return left < right;
+      case OPCODE_LE:
+         return left <= right;
+      case OPCODE_GT:
+         return left > right;
+      case OPCODE_GE:
+         return left >= right;
+   }
+   return false;
+}
+
 /**
  * Security context destructor
  */
@@ -191,6 +214,7 @@ NXSL_VM::NXSL_VM(NXSL_Environment *env, NXSL_Storage *storage) : NXSL_ValueManag
    m_errorModule = nullptr;
    m_assertMessage = nullptr;
    m_constants = nullptr;
+   m_programConstants = nullptr;
    m_globalVariables = new NXSL_VariableSystem(this, NXSL_VariableSystemType::GLOBAL);
    m_localVariables = nullptr;
    m_expressionVariables = nullptr;
@@ -225,6 +249,7 @@ NXSL_VM::~NXSL_VM()
       m_instructionSet.get(i)->dispose(this);
 
    delete m_constants;
+   delete m_programConstants;
    delete m_globalVariables;
    delete m_localVariables;
    delete m_expressionVariables;
@@ -305,9 +330,50 @@ bool NXSL_VM::load(const NXSL_Program *program)
       }
    }
 
+   // Keep copy of program and module constants so VM can be reset to initial state
+   delete m_programConstants;
+   m_programConstants = (m_constants != nullptr) ? new NXSL_VariableSystem(this, m_constants) : nullptr;
+
    return success;
 }
 
+/**
+ * Reset VM to the state it was in right after program load. Loaded code, functions and modules are kept,
+ * while global variables, constants added by caller, context, storage, security context, and error state are discarded.
+ * Intended for reusing already loaded VM for another script execution.
+ */
+void NXSL_VM::reset()
+{
+   destroyValue(m_pRetValue);
+   m_pRetValue = nullptr;
+
+   delete m_globalVariables;
+   m_globalVariables = new NXSL_VariableSystem(this, NXSL_VariableSystemType::GLOBAL);
+
+   delete m_constants;
+   m_constants = (m_programConstants != nullptr) ? new NXSL_VariableSystem(this, m_programConstants) : nullptr;
+
+   setContextObject(nullptr);
+   delete_and_null(m_securityContext);
+
+   delete m_localStorage;
+   m_localStorage = new NXSL_LocalStorage(this);
+   m_storage = m_localStorage;
+
+   m_userData = nullptr;
+   m_instructionTraceFile = nullptr;
+   m_cp = INVALID_ADDRESS;
+   m_stopFlag = false;
+
+   m_errorCode = 0;
+   m_errorLine = 0;
+   m_errorModule = nullptr;
+   MemFree(m_errorText);
+   m_errorText = nullptr;
+   MemFree(m_assertMessage);
+   m_assertMessage = nullptr;
+}
+
 /**
  * Run program
  * Returns true on success and false on error
@@ -1549,6 +1615,52 @@ void NXSL_VM::execute()
       case OPCODE_CASE_CONST_GT:
          doBinaryOperation(cp->m_opCode);
          break;
+      case OPCODE_COMPARE_INT32:
+         pValue = m_dataStack.peek();
+         if (pValue != nullptr)
+         {
+            if ((pValue->getDataType() == NXSL_DT_INT32) || (pValue->getDataType() == NXSL_DT_INT64))
+            {
+               // Fast path - both operands will be converted to same signed type
+               bool result = CompareIntegers(cp->m_stackItems, pValue->getValueAsInt64(), cp->m_operand.m_valueInt32);
+               destroyValue(m_dataStack.pop());
+               m_dataStack.push(createValue(result));
+            }
+            else
+            {
+               m_dataStack.push(createValue(cp->m_operand.m_valueInt32));
+               doBinaryOperation(cp->m_stackItems);
+            }
+         }
+         else
+         {
+            error(NXSL_ERR_DATA_STACK_UNDERFLOW);
+         }
+         break;
+      case OPCODE_ARITH_INT32:
+         pValue = m_dataStack.peek();
+         if (pValue != nullptr)
+         {
+            if (pValue->getDataType() == NXSL_DT_INT32)
+            {
+               // Fast path - same wrap around semantic as NXSL_Value::add and NXSL_Value::sub
+               uint32_t left = static_cast<uint32_t>(pValue->getValueAsInt32());
+               uint32_t right = static_cast<uint32_t>(cp->m_operand.m_valueInt32);
+               int32_t result = static_cast<int32_t>((cp->m_stackItems == OPCODE_ADD) ? left + right : left - right);
+               destroyValue(m_dataStack.pop());
+               m_dataStack.push(createValue(result));
+            }
+            else
+            {
+               m_dataStack.push(createValue(cp->m_operand.m_valueInt32));
+               doBinaryOperation(cp->m_stackItems);
+            }
+         }
+         else
+         {
+            error(NXSL_ERR_DATA_STACK_UNDERFLOW);
+         }
+         break;
       case OPCODE_NEG:
       case OPCODE_NOT:
       case OPCODE_BIT_NOT:
@@ -1562,7 +1674,8 @@ void NXSL_VM::execute()
             pValue = pVar->getValue();
             if (pValue->isNumeric())
             {
-               m_dataStack.push(createValueRef(pValue));
+               if (cp->m_stackItems == 0)
+                  m_dataStack.push(createValueRef(pValue));
                pValue = pVar->unshareValue();
                if (cp->m_opCode == OPCODE_INC)
                   pValue->increment();
@@ -1592,7 +1705,8 @@ void NXSL_VM::execute()
          pValue = pVar->getValue();
          if (pValue->isNumeric())
          {
-            m_dataStack.push(createValueRef(pValue));
+            if (cp->m_stackItems == 0)
+               m_dataStack.push(createValueRef(pValue));
             pValue = pVar->unshareValue();
             if (cp->m_opCode == OPCODE_INC_VARPTR)
                pValue->increment();
@@ -1617,7 +1731,8 @@ void NXSL_VM::execute()
                   pValue->increment();
                else
                   pValue->decrement();
-               m_dataStack.push(createValueRef(pValue));
+               if (cp->m_stackItems == 0)
+                  m_dataStack.push(createValueRef(pValue));
 
                // Convert to direct variable access
                if (vs->createVariableReferenceRestorePoint(m_cp, cp->m_operand.m_identifier))
@@ -1647,7 +1762,8 @@ void NXSL_VM::execute()
                pValue->increment();
             else
                pValue->decrement();
-            m_dataStack.push(createValueRef(pValue));
+            if (cp->m_stackItems == 0)
+               m_dataStack.push(createValueRef(pValue));
          }
          else
          {
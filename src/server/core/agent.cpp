@@ -167,6 +167,34 @@ void AgentConnectionEx::onTrap(NXCPMessage *pMsg)
    }
 }
 
+/**
+ * Process single syslog record received from agent
+ */
+void AgentConnectionEx::processSyslogRecord(Node *node, int32_t zoneUIN, uint64_t id, const InetAddress& sourceAddr, time_t timestamp,
+         const NXCPMessage& msg, uint32_t messageFieldId, int msgLen)
+{
+   // Check for duplicate messages - only accept messages with ID
+   // higher than last received
+   if (!node->checkSyslogMessageId(id))
+   {
+      debugPrintf(5, _T("AgentConnectionEx::onSyslogMessage(): message ID is invalid (node %s [%d])"), node->getName(), node->getId());
+      return;
+   }
+
+   if (msgLen < 2048)
+   {
+      char message[2048];
+      msg.getFieldAsBinary(messageFieldId, (BYTE *)message, msgLen + 1);
+      uint32_t sourceNodeId = 0;
+      if (sourceAddr.isLoopback())
+      {
+         debugPrintf(5, _T("Source IP address for syslog message is loopback, setting source node ID to %d"), m_nodeId);
+         sourceNodeId = m_nodeId;
+      }
+      QueueProxiedSyslogMessage(sourceAddr, zoneUIN, sourceNodeId, timestamp, message, msgLen);
+   }
+}
+
 /**
  * Incoming syslog message processor
  */
@@ -186,28 +214,21 @@ void AgentConnectionEx::onSyslogMessage(const NXCPMessage& msg)
       node = FindNodeByIP(zoneUIN, getIpAddr());
    if (node != nullptr)
    {
-      // Check for duplicate messages - only accept messages with ID
-      // higher than last received
-      if (node->checkSyslogMessageId(msg.getFieldAsUInt64(VID_REQUEST_ID)))
+      if (msg.isFieldExist(VID_NUM_RECORDS))
       {
-         int msgLen = msg.getFieldAsInt32(VID_MESSAGE_LENGTH);
-         if (msgLen < 2048)
+         // Multiple records packed into single message
+         int count = msg.getFieldAsInt32(VID_NUM_RECORDS);
+         uint32_t fieldId = VID_SYSLOG_MSG_BASE;
+         for(int i = 0; i < count; i++, fieldId += 10)
          {
-            char message[2048];
-            msg.getFieldAsBinary(VID_MESSAGE, (BYTE *)message, msgLen + 1);
-            InetAddress sourceAddr = msg.getFieldAsInetAddress(VID_IP_ADDRESS);
-            uint32_t sourceNodeId = 0;
-            if (sourceAddr.isLoopback())
-            {
-               debugPrintf(5, _T("Source IP address for syslog message is loopback, setting source node ID to %d"), m_nodeId);
-               sourceNodeId = m_nodeId;
-            }
-            QueueProxiedSyslogMessage(sourceAddr, zoneUIN, sourceNodeId, msg.getFieldAsTime(VID_TIMESTAMP), message, msgLen);
+            processSyslogRecord(node.get(), zoneUIN, msg.getFieldAsUInt64(fieldId), msg.getFieldAsInetAddress(fieldId + 1),
+                  msg.getFieldAsTime(fieldId + 2), msg, fieldId + 3, msg.getFieldAsInt32(fieldId + 4));
          }
       }
       else
       {
-         debugPrintf(5, _T("AgentConnectionEx::onSyslogMessage(): message ID is invalid (node %s [%d])"), node->getName(), node->getId());
+         processSyslogRecord(node.get(), zoneUIN, msg.getFieldAsUInt64(VID_REQUEST_ID), msg.getFieldAsInetAddress(VID_IP_ADDRESS),
+               msg.getFieldAsTime(VID_TIMESTAMP), msg, VID_MESSAGE, msg.getFieldAsInt32(VID_MESSAGE_LENGTH));
       }
    }
    else
@@ -844,7 +865,7 @@ uint32_t AgentConnectionEx::processBulkCollectedData(NXCPMessage *request, NXCPM
          NXCPMessage msg(CMD_REQUEST_COMPLETED, request->getId(), getProtocolVersion());
          msg.setField(VID_RCC, ERR_PROCESSING);
          msg.setField(VID_PROGRESS, i * 100 / count);
-         postRawMessage(msg.serialize(isCompressionAllowed()));
+         postRawMessage(msg.serialize(getMessageCompressionMethod()));
          startTime = GetCurrentTimeMs();
       }
 
@@ -743,6 +743,14 @@ static void OnConfigVariableChange(bool isCLOB, const TCHAR *name, const TCHAR *
    {
       tchar_to_utf8(value, -1, g_snmpCodepage, sizeof(g_snmpCodepage));
    }
+   else if (!_tcscmp(name, _T("Server.NXCP.CompressionLevel")))
+   {
+      NXCPSetMessageCompressionLevel(_tcstol(value, nullptr, 0));
+   }
+   else if (!_tcscmp(name, _T("SNMP.MaxVarbindsPerRequest")))
+   {
+      g_snmpMaxVarbindsPerRequest = ConvertToUint32(value, 32);
+   }
    else if (!_tcscmp(name, _T("SNMP.Traps.AllowVarbindsConversion")))
    {
       UpdateServerFlag(AF_ALLOW_TRAP_VARBIND_CONVERSION, value);
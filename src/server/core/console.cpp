@@ -28,8 +28,6 @@
 /**
  * Externals
  */
-extern ObjectQueue<SyslogMessage> g_syslogProcessingQueue;
-extern ObjectQueue<SyslogMessage> g_syslogWriteQueue;
 extern ObjectQueue<WindowsEvent> g_windowsEventProcessingQueue;
 extern ObjectQueue<WindowsEvent> g_windowsEventWriterQueue;
 extern ThreadPool *g_pollerThreadPool;
@@ -42,12 +40,15 @@ uint32_t BindAgentTunnel(uint32_t tunnelId, uint32_t nodeId, uint32_t userId);
 uint32_t UnbindAgentTunnel(uint32_t nodeId, uint32_t userId);
 int64_t GetEventLogWriterQueueSize();
 int64_t GetEventProcessorQueueSize();
+int64_t GetSyslogProcessingQueueSize();
+int64_t GetSyslogWriterQueueSize();
 void RangeScanCallback(const InetAddress& addr, int32_t zoneUIN, const Node *proxy, uint32_t rtt, const TCHAR *proto, ServerConsole *console, void *context);
 void CheckRange(const InetAddressListElement& range, void(*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context);
 void ShowSyncerStats(ServerConsole *console);
 void ShowAuthenticationTokens(ServerConsole *console);
 void RunHouseKeeper(ServerConsole *console);
 void ShowActiveDiscoveryState(ServerConsole *console);
+void ShowDiscoveryStats(ServerConsole *console);
 void RunThreadPoolLoadTest(const TCHAR *poolName, int numTasks, ServerConsole *console);
 
 /**
@@ -895,6 +896,7 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
 
          ConsolePrintf(pCtx, _T("Background writer requests:\n"));
          ConsolePrintf(pCtx, _T("   DCI data ....... ") INT64_FMT _T("\n"), g_idataWriteRequests);
+         ConsolePrintf(pCtx, _T("   Table DCI data . ") INT64_FMT _T("\n"), g_tdataWriteRequests);
          ConsolePrintf(pCtx, _T("   DCI raw data ... ") INT64_FMT _T("\n"), g_rawDataWriteRequests);
          ConsolePrintf(pCtx, _T("   Others ......... ") INT64_FMT _T("\n"), g_otherWriteRequests);
       }
@@ -909,6 +911,10 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          {
             ShowActiveDiscoveryState(pCtx);
          }
+         else if (IsCommand(_T("STATS"), szBuffer, 1))
+         {
+            ShowDiscoveryStats(pCtx);
+         }
          else
          {
             ConsoleWrite(pCtx, _T("Invalid subcommand\n"));
@@ -934,6 +940,17 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
             ConsoleWrite(pCtx, _T("Parallel event processing is disabled\n"));
          }
          delete stats;
+
+         EventLogWriterStats ws = GetEventLogWriterStats();
+         ConsolePrintf(pCtx, _T("\nEvent log writers .......: %d\n")
+                             _T("Event log queue .........: %u\n")
+                             _T("Written events ..........: ") UINT64_FMT _T("\n")
+                             _T("Failed events ...........: ") UINT64_FMT _T("\n")
+                             _T("Average batch size ......: %u\n")
+                             _T("Max batch size ..........: %u\n")
+                             _T("Average write time ......: %u ms\n")
+                             _T("Max write time ..........: %u ms\n"),
+                  ws.threads, ws.queueSize, ws.writtenEvents, ws.failedEvents, ws.averageBatchSize, ws.maxBatchSize, ws.averageWriteTime, ws.maxWriteTime);
       }
       else if (IsCommand(_T("FDB"), szBuffer, 3))
       {
@@ -1026,6 +1043,7 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          ConsolePrintf(pCtx, SHOW_FLAG_VALUE(AF_DISABLE_SNMP_V2_PROBE));
          ConsolePrintf(pCtx, SHOW_FLAG_VALUE(AF_DISABLE_SNMP_V3_PROBE));
          ConsolePrintf(pCtx, SHOW_FLAG_VALUE(AF_DISABLE_SSH_PROBE));
+         ConsolePrintf(pCtx, SHOW_FLAG_VALUE(AF_PARTITIONED_TABLES));
          ConsolePrintf(pCtx, SHOW_FLAG_VALUE(AF_SERVER_INITIALIZED));
          ConsolePrintf(pCtx, SHOW_FLAG_VALUE(AF_SHUTDOWN));
          ConsolePrintf(pCtx, _T("\n"));
@@ -1298,13 +1316,14 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
          ShowQueueStats(pCtx, &g_templateUpdateQueue, _T("Template updater"));
          ShowQueueStats(pCtx, &g_dbWriterQueue, _T("Database writer"));
          ShowQueueStats(pCtx, GetIDataWriterQueueSize(), _T("Database writer (IData)"));
+         ShowQueueStats(pCtx, GetTDataWriterQueueSize(), _T("Database writer (TData)"));
          ShowQueueStats(pCtx, GetRawDataWriterQueueSize(), _T("Database writer (raw DCI values)"));
          ShowQueueStats(pCtx, GetEventProcessorQueueSize(), _T("Event processor"));
          ShowQueueStats(pCtx, GetEventLogWriterQueueSize(), _T("Event log writer"));
          ShowThreadPoolPendingQueue(pCtx, g_pollerThreadPool, _T("Poller"));
          ShowQueueStats(pCtx, GetDiscoveryPollerQueueSize(), _T("Node discovery poller"));
-         ShowQueueStats(pCtx, &g_syslogProcessingQueue, _T("Syslog processor"));
-         ShowQueueStats(pCtx, &g_syslogWriteQueue, _T("Syslog writer"));
+         ShowQueueStats(pCtx, GetSyslogProcessingQueueSize(), _T("Syslog processor"));
+         ShowQueueStats(pCtx, GetSyslogWriterQueueSize(), _T("Syslog writer"));
          ShowThreadPoolPendingQueue(pCtx, g_schedulerThreadPool, _T("Scheduler"));
          ShowQueueStats(pCtx, &g_windowsEventProcessingQueue, _T("Windows event processor"));
          ShowQueueStats(pCtx, &g_windowsEventWriterQueue, _T("Windows event writer"));
@@ -1824,8 +1843,9 @@ int ProcessConsoleCommand(const TCHAR *pszCmdLine, CONSOLE_CTX pCtx)
             _T("   show dbcp                         - Show active sessions in database connection pool\n")
             _T("   show dbstats                      - Show DB library statistics\n")
             _T("   show discovery ranges             - Show state of active network discovery by address range\n")
+            _T("   show discovery stats              - Show network discovery pipeline statistics\n")
             _T("   show discovery queue              - Show content of network discovery queue\n")
-            _T("   show ep                           - Show event processing threads statistics\n")
+            _T("   show ep                           - Show event processing and event log writer statistics\n")
             _T("   show fdb <node>                   - Show forwarding database for node\n")
             _T("   show flags                        - Show internal server flags\n")
             _T("   show heap details                 - Show detailed heap information\n")
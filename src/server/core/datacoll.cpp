@@ -244,6 +244,49 @@ static shared_ptr<Table> GetTableData(DataCollectionTarget *dcTarget, DCTable *t
 	return result;
 }
 
+/**
+ * Transform and store collected value or handle collection error
+ */
+static void ProcessCollectedData(const shared_ptr<DCObject>& dcObject, time_t currTime, uint32_t error, const TCHAR *value, const shared_ptr<Table>& table)
+{
+   switch(error)
+   {
+      case DCE_SUCCESS:
+         if (dcObject->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
+            dcObject->setStatus(ITEM_STATUS_ACTIVE, true);
+         static_cast<DataCollectionTarget*>(dcObject->getOwner().get())->processNewDCValue(dcObject, currTime, value, table);
+         break;
+      case DCE_COLLECTION_ERROR:
+         if (dcObject->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
+            dcObject->setStatus(ITEM_STATUS_ACTIVE, true);
+         dcObject->processNewError(false);
+         break;
+      case DCE_NO_SUCH_INSTANCE:
+         if (dcObject->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
+            dcObject->setStatus(ITEM_STATUS_ACTIVE, true);
+         dcObject->processNewError(true);
+         break;
+      case DCE_COMM_ERROR:
+         dcObject->processNewError(false);
+         break;
+      case DCE_NOT_SUPPORTED:
+         // Change item's status
+         dcObject->setStatus(ITEM_STATUS_NOT_SUPPORTED, true);
+         break;
+   }
+
+   // Send session notification when force poll is performed
+   if (dcObject->isForcePollRequested())
+   {
+      ClientSession *session = dcObject->processForcePoll();
+      if (session != nullptr)
+      {
+         session->notify(NX_NOTIFY_FORCE_DCI_POLL, dcObject->getOwnerId());
+         session->decRefCount();
+      }
+   }
+}
+
 /**
  * Data collector
  */
@@ -324,43 +367,7 @@ void DataCollector(const shared_ptr<DCObject>& dcObject)
                break;
          }
 
-         // Transform and store received value into database or handle error
-         switch(error)
-         {
-            case DCE_SUCCESS:
-               if (dcObject->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
-                  dcObject->setStatus(ITEM_STATUS_ACTIVE, true);
-               static_cast<DataCollectionTarget*>(dcObject->getOwner().get())->processNewDCValue(dcObject, currTime, buffer, table);
-               break;
-            case DCE_COLLECTION_ERROR:
-               if (dcObject->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
-                  dcObject->setStatus(ITEM_STATUS_ACTIVE, true);
-               dcObject->processNewError(false);
-               break;
-            case DCE_NO_SUCH_INSTANCE:
-               if (dcObject->getStatus() == ITEM_STATUS_NOT_SUPPORTED)
-                  dcObject->setStatus(ITEM_STATUS_ACTIVE, true);
-               dcObject->processNewError(true);
-               break;
-            case DCE_COMM_ERROR:
-               dcObject->processNewError(false);
-               break;
-            case DCE_NOT_SUPPORTED:
-               // Change item's status
-               dcObject->setStatus(ITEM_STATUS_NOT_SUPPORTED, true);
-               break;
-         }
-
-         // Send session notification when force poll is performed
-         if (dcObject->isForcePollRequested())
-         {
-            ClientSession *session = dcObject->processForcePoll();
-            if (session != nullptr)
-            {
-               session->notify(NX_NOTIFY_FORCE_DCI_POLL, dcObject->getOwnerId());
-               session->decRefCount();
-            }
-         }
+         ProcessCollectedData(dcObject, currTime, error, buffer, table);
       }
    }
    else     /* target == nullptr */
@@ -375,6 +382,71 @@ void DataCollector(const shared_ptr<DCObject>& dcObject)
    dcObject->clearBusyFlag();
 }
 
+/**
+ * Data collector for batch of SNMP DCIs with same owner node, SNMP port, and SNMP version. Values for all DCIs in batch
+ * are requested with coalesced multi-varbind SNMP requests.
+ */
+void SNMPBatchCollector(SharedObjectArray<DCObject> *batch)
+{
+   shared_ptr<Node> node = static_pointer_cast<Node>(batch->get(0)->getOwner());
+
+   SharedObjectArray<DCObject> items(batch->size());
+   StringList names;
+   for(int i = 0; i < batch->size(); i++)
+   {
+      const shared_ptr<DCObject>& dcObject = batch->getShared(i);
+      if (dcObject->isScheduledForDeletion())
+      {
+         nxlog_debug(7, _T("SNMPBatchCollector(): about to destroy DC object [%u] \"%s\" owner=[%u]"),
+                     dcObject->getId(), dcObject->getName().cstr(), (node != nullptr) ? node->getId() : 0);
+         dcObject->deleteFromDatabase();
+         continue;
+      }
+
+      if ((node == nullptr) || IsShutdownInProgress())
+      {
+         if (node == nullptr)
+            dcObject->setLastPollTime(time(nullptr));
+         dcObject->clearBusyFlag();
+         continue;
+      }
+
+      items.add(dcObject);
+      names.add(dcObject->getName());
+   }
+   delete batch;
+
+   if (items.isEmpty())
+      return;
+
+   StructArray<SNMPMetricRequest> requests(items.size());
+   for(int i = 0; i < items.size(); i++)
+   {
+      DCItem *dci = static_cast<DCItem*>(items.get(i));
+      SNMPMetricRequest *r = requests.addPlaceholder();
+      r->name = names.get(i);
+      r->interpretRawValue = dci->isInterpretSnmpRawValue() ? (int)dci->getSnmpRawValueType() : SNMP_RAWTYPE_NONE;
+   }
+
+   DCObject *first = items.get(0);
+   nxlog_debug(8, _T("SNMPBatchCollector(): collecting %d SNMP DCIs for node %s [%u]"), items.size(), node->getName(), node->getId());
+   node->getMetricsFromSNMP(first->getSnmpPort(), first->getSnmpVersion(), requests.getBuffer(), requests.size());
+
+   time_t currTime = time(nullptr);
+   shared_ptr<Table> noTable;
+   for(int i = 0; i < items.size(); i++)
+   {
+      const shared_ptr<DCObject>& dcObject = items.getShared(i);
+      SNMPMetricRequest *r = requests.get(i);
+      if (!IsShutdownInProgress())
+         ProcessCollectedData(dcObject, currTime, r->result, CHECK_NULL_EX(r->value), noTable);
+      MemFree(r->value);
+
+      dcObject->setLastPollTime(currTime);
+      dcObject->clearBusyFlag();
+   }
+}
+
 /**
  * Callback for queueing DCIs
  */
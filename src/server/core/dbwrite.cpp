@@ -48,6 +48,33 @@ struct DELAYED_IDATA_INSERT
    TCHAR rawValue[2]; // Actual size determined by text part length
 };
 
+/**
+ * Delayed request for tdata INSERT. Table value is encoded by writer thread.
+ */
+struct DELAYED_TDATA_INSERT
+{
+   time_t timestamp;
+   uint32_t nodeId;
+   uint32_t tableId;
+   DCObjectStorageClass storageClass;
+   shared_ptr<Table> value;
+   char *encodedValue;
+
+   DELAYED_TDATA_INSERT(time_t _timestamp, uint32_t _nodeId, uint32_t _tableId, DCObjectStorageClass _storageClass, const shared_ptr<Table>& _value) : value(_value)
+   {
+      timestamp = _timestamp;
+      nodeId = _nodeId;
+      tableId = _tableId;
+      storageClass = _storageClass;
+      encodedValue = nullptr;
+   }
+
+   ~DELAYED_TDATA_INSERT()
+   {
+      MemFree(encodedValue);
+   }
+};
+
 /**
  * Delayed request for raw_dci_values UPDATE or DELETE
  */
@@ -102,6 +129,12 @@ static void WriterQueueElementDestructor(void *element, Queue *queue)
  */
 ObjectQueue<DELAYED_SQL_REQUEST> g_dbWriterQueue(1024, Ownership::True, WriterQueueElementDestructor);
 
+/**
+ * Table DCI data writer queue
+ */
+static ObjectQueue<DELAYED_TDATA_INSERT> s_tdataWriterQueue(1024, Ownership::True);
+static VolatileCounter s_tdataPendingRequests = 0;
+
 /**
  * Raw DCI data writer queue
  */
@@ -113,6 +146,7 @@ static VolatileCounter s_batchSize = 0;
  * Performance counters
  */
 VolatileCounter64 g_idataWriteRequests = 0;
+VolatileCounter64 g_tdataWriteRequests = 0;
 uint64_t g_rawDataWriteRequests = 0;
 VolatileCounter64 g_otherWriteRequests = 0;
 
@@ -128,6 +162,7 @@ static Condition s_queueMonitorStopCondition(true);
  */
 static THREAD s_writerThread = INVALID_THREAD_HANDLE;
 static THREAD s_rawDataWriterThread = INVALID_THREAD_HANDLE;
+static THREAD s_tdataWriterThread = INVALID_THREAD_HANDLE;
 static THREAD s_queueMonitorThread = INVALID_THREAD_HANDLE;
 
 /**
@@ -256,6 +291,18 @@ void QueueIDataInsert(time_t timestamp, uint32_t nodeId, uint32_t dciId, const T
 	InterlockedIncrement64(&g_idataWriteRequests);
 }
 
+/**
+ * Queue INSERT request for tdata table
+ */
+void QueueTDataInsert(time_t timestamp, uint32_t nodeId, uint32_t tableId, DCObjectStorageClass storageClass, const shared_ptr<Table>& value)
+{
+   if (s_queueMonitorDiscardFlag)
+      return;
+
+   s_tdataWriterQueue.put(new DELAYED_TDATA_INSERT(timestamp, nodeId, tableId, storageClass, value));
+   InterlockedIncrement64(&g_tdataWriteRequests);
+}
+
 /**
  * Queue UPDATE request for raw_dci_values table
  */
@@ -896,6 +943,173 @@ static void SaveRawData(int maxRecords, ThreadPool *writerPool)
       SaveRawDataBatch(batch, maxRecords);
 }
 
+/**
+ * Get key of target table for tdata INSERT request. Requests with same key are written using same prepared statement.
+ */
+static inline uint32_t GetTDataTargetKey(const DELAYED_TDATA_INSERT *rq)
+{
+   if (g_flags & AF_SINGLE_TABLE_PERF_DATA)
+      return (g_dbSyntax == DB_SYNTAX_TSDB) ? static_cast<uint32_t>(rq->storageClass) : 0;
+   return rq->nodeId;
+}
+
+/**
+ * Compare tdata INSERT requests by target table
+ */
+static int CompareTDataRequests(const DELAYED_TDATA_INSERT **r1, const DELAYED_TDATA_INSERT **r2)
+{
+   uint32_t k1 = GetTDataTargetKey(*r1);
+   uint32_t k2 = GetTDataTargetKey(*r2);
+   return (k1 < k2) ? -1 : ((k1 > k2) ? 1 : 0);
+}
+
+/**
+ * Bind tdata INSERT request to prepared statement
+ */
+static void BindTDataInsert(DB_STATEMENT hStmt, DELAYED_TDATA_INSERT *rq)
+{
+   DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, rq->tableId);
+   DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, static_cast<int64_t>(rq->timestamp));
+   DBBind(hStmt, 3, DB_SQLTYPE_TEXT, DB_CTYPE_UTF8_STRING, rq->encodedValue, DB_BIND_STATIC);
+}
+
+/**
+ * Write group of tdata records with same target table in single transaction
+ */
+static bool WriteTDataGroup(DB_HANDLE hdb, const ObjectArray<DELAYED_TDATA_INSERT>& batch, int start, int end)
+{
+   TCHAR query[256];
+   if (g_flags & AF_SINGLE_TABLE_PERF_DATA)
+   {
+      if (g_dbSyntax == DB_SYNTAX_TSDB)
+      {
+         _sntprintf(query, 256, _T("INSERT INTO tdata_sc_%s (item_id,tdata_timestamp,tdata_value) VALUES (?,to_timestamp(?),?)"),
+                  DCObject::getStorageClassName(batch.get(start)->storageClass));
+      }
+      else
+      {
+         _tcscpy(query, _T("INSERT INTO tdata (item_id,tdata_timestamp,tdata_value) VALUES (?,?,?)"));
+      }
+   }
+   else
+   {
+      _sntprintf(query, 256, _T("INSERT INTO tdata_%u (item_id,tdata_timestamp,tdata_value) VALUES (?,?,?)"), batch.get(start)->nodeId);
+   }
+
+   if (!DBBegin(hdb))
+      return false;
+
+   bool success = false;
+   DB_STATEMENT hStmt = DBPrepare(hdb, query, end - start > 1);
+   if (hStmt != nullptr)
+   {
+      if ((end - start > 1) && DBOpenBatch(hStmt))
+      {
+         for(int i = start; i < end; i++)
+         {
+            DBNextBatchRow(hStmt);
+            BindTDataInsert(hStmt, batch.get(i));
+         }
+         success = DBExecute(hStmt);
+      }
+      else
+      {
+         success = true;
+         for(int i = start; (i < end) && success; i++)
+         {
+            BindTDataInsert(hStmt, batch.get(i));
+            success = DBExecute(hStmt);
+         }
+      }
+      DBFreeStatement(hStmt);
+   }
+
+   if (success)
+      DBCommit(hdb);
+   else
+      DBRollback(hdb);
+   return success;
+}
+
+/**
+ * Database "lazy" write thread for tdata INSERTs. Requests are taken from queue in batches, encoded
+ * outside of transaction, and written grouped by target table.
+ */
+static void TDataWriteThread()
+{
+   ThreadSetName("DBWriter/TData");
+   int maxRecords = ConfigReadInt(_T("DBWriter.MaxRecordsPerTransaction"), 1000);
+
+   ObjectArray<DELAYED_TDATA_INSERT> batch(256, 256, Ownership::True);
+   bool stop = false;
+   while(!stop)
+   {
+      DELAYED_TDATA_INSERT *rq = s_tdataWriterQueue.getOrBlock();
+      if (rq == INVALID_POINTER_VALUE)   // End-of-job indicator
+         break;
+
+      batch.add(rq);
+      while(batch.size() < maxRecords)
+      {
+         rq = s_tdataWriterQueue.get();
+         if (rq == nullptr)
+            break;
+         if (rq == INVALID_POINTER_VALUE)
+         {
+            stop = true;
+            break;
+         }
+         batch.add(rq);
+      }
+      s_tdataPendingRequests = batch.size();
+
+      for(int i = 0; i < batch.size(); i++)
+      {
+         rq = batch.get(i);
+         rq->encodedValue = rq->value->createPackedData();
+         rq->value.reset();
+         if (rq->encodedValue == nullptr)
+         {
+            nxlog_debug_tag(DEBUG_TAG, 5, _T("Cannot encode value of table DCI [%u] on node [%u]"), rq->tableId, rq->nodeId);
+            batch.remove(i);
+            i--;
+         }
+      }
+      batch.sort(CompareTDataRequests);
+
+      bool idataLock;
+      if (g_flags & AF_DBWRITER_HK_INTERLOCK)
+      {
+         s_idataWriteLock.readLock();
+         idataLock = true;
+      }
+      else
+      {
+         idataLock = false;
+      }
+
+      DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
+      int start = 0;
+      while(start < batch.size())
+      {
+         uint32_t key = GetTDataTargetKey(batch.get(start));
+         int end = start + 1;
+         while((end < batch.size()) && (GetTDataTargetKey(batch.get(end)) == key))
+            end++;
+         if (!WriteTDataGroup(hdb, batch, start, end))
+            nxlog_debug_tag(DEBUG_TAG, 5, _T("Failed to write %d table DCI values"), end - start);
+         start = end;
+      }
+      DBConnectionPoolReleaseConnection(hdb);
+
+      if (idataLock)
+         s_idataWriteLock.unlock();
+
+      batch.clear();
+      s_tdataPendingRequests = 0;
+   }
+}
+
 /**
  * Database "lazy" write thread for raw_dci_values UPDATEs
  */
@@ -942,7 +1156,7 @@ static void QueueMonitorThread()
          break;
       }
 
-      int64_t currentQueueSize = GetIDataWriterQueueSize();
+      int64_t currentQueueSize = GetIDataWriterQueueSize() + GetTDataWriterQueueSize();
       if (currentQueueSize > maxQueueSize)
       {
          if (!s_queueMonitorDiscardFlag)
@@ -979,6 +1193,7 @@ void StartDBWriter()
 {
    s_writerThread = ThreadCreateEx(DBWriteThread);
 	s_rawDataWriterThread = ThreadCreateEx(RawDataWriteThread);
+	s_tdataWriterThread = ThreadCreateEx(TDataWriteThread);
 
 	if (g_flags & AF_SINGLE_TABLE_PERF_DATA)
 	{
@@ -1065,6 +1280,9 @@ void StopDBWriter()
    }
    ThreadJoin(s_rawDataWriterThread);
 
+   s_tdataWriterQueue.put(INVALID_POINTER_VALUE);
+   ThreadJoin(s_tdataWriterThread);
+
    nxlog_debug_tag(DEBUG_TAG, 1, _T("All background database writers stopped"));
 }
 
@@ -1102,6 +1320,14 @@ int64_t GetIDataWriterQueueSize()
    return size;
 }
 
+/**
+ * Get size of table DCI data writer queue
+ */
+int64_t GetTDataWriterQueueSize()
+{
+   return s_tdataWriterQueue.size() + s_tdataPendingRequests;
+}
+
 /**
  * Get size of raw data writer queue
  */
@@ -1132,6 +1358,7 @@ void ClearDBWriterData(ServerConsole *console, const TCHAR *component)
    if (!_tcsicmp(component, _T("Counters")))
    {
       g_idataWriteRequests = 0;
+      g_tdataWriteRequests = 0;
       g_rawDataWriteRequests = 0;
       g_otherWriteRequests = 0;
       console->print(_T("Database writer counters cleared\n"));
@@ -1142,6 +1369,7 @@ void ClearDBWriterData(ServerConsole *console, const TCHAR *component)
       {
          s_idataWriters[i].queue->clear();
       }
+      s_tdataWriterQueue.clear();
       console->print(_T("Database writer data queue cleared\n"));
    }
    else
@@ -1113,6 +1113,14 @@ void DCItem::updateCacheSizeInternal(bool allowLoad)
          if (requiredSize < m_thresholds->get(i)->getRequiredCacheSize())
             requiredSize = m_thresholds->get(i)->getRequiredCacheSize();
 
+      // Prediction engine reads recent values from cache
+      if (m_predictionEngine[0] != 0)
+      {
+         PredictionEngine *engine = FindPredictionEngine(m_predictionEngine);
+         if ((engine != nullptr) && (requiredSize < static_cast<uint32_t>(engine->getRequiredCacheSize())))
+            requiredSize = engine->getRequiredCacheSize();
+      }
+
 		unique_ptr<SharedObjectArray<NetObj>> conditions = g_idxConditionById.getObjects();
 		for(int i = 0; i < conditions->size(); i++)
       {
@@ -1366,6 +1374,33 @@ uint64_t DCItem::getCacheMemoryUsage() const
    return size;
 }
 
+/**
+ * Get up to given number of most recent values from cache (newest first). Returns false if cache
+ * is not loaded or cannot hold requested number of values.
+ */
+bool DCItem::getCachedValues(int count, StructArray<DciValue> *values) const
+{
+   lock();
+   if (!m_bCacheLoaded || (m_cacheSize < static_cast<uint32_t>(count)))
+   {
+      unlock();
+      return false;
+   }
+
+   for(int i = 0; i < count; i++)
+   {
+      ItemValue *v = m_ppValueCache[i];
+      if (v->getTimeStamp() <= 1)
+         break;   // Placeholder for value not read from database
+      DciValue dv;
+      dv.timestamp = v->getTimeStamp();
+      dv.value = v->getDouble();
+      values->add(&dv);
+   }
+   unlock();
+   return true;
+}
+
 /**
  * Put last value into NXCP message (single DCI per message)
  */
@@ -311,8 +311,8 @@ ThresholdCheckResult Threshold::check(ItemValue &value, ItemValue **ppPrevValues
                m_value;
       if ((m_script != nullptr) && !m_script->isEmpty())
       {
-         NXSL_VM *vm = CreateServerScriptVM(m_script, target, dci->createDescriptor());
-         if (vm != nullptr)
+         ScriptVMHandle vm = CreateServerScriptVM(m_script, target, dci->createDescriptor());
+         if (vm.isValid())
          {
             NXSL_Value *parameters[2];
             parameters[0] = vm->createValue(value.getString());
@@ -332,7 +332,7 @@ ThresholdCheckResult Threshold::check(ItemValue &value, ItemValue **ppPrevValues
                   m_lastScriptErrorReport = now;
                }
             }
-            delete vm;
+            vm.destroy();
          }
          else
          {
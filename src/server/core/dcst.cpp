@@ -22,6 +22,13 @@
 
 #include "nxcore.h"
 
+#define DEBUG_TAG _T("dc.summary")
+
+/**
+ * Number of targets processed by single summary table query task
+ */
+#define SUMMARY_TABLE_BATCH_SIZE    64
+
 /**
  * Modify DCI summary table. Will create new table if id is 0.
  *
@@ -112,6 +119,31 @@ SummaryTableColumn::SummaryTableColumn(const NXCPMessage& msg, uint32_t baseId)
       msg.getFieldAsString(baseId + 3, m_separator, 16);
    else
       _tcscpy(m_separator, _T(";"));
+   m_regexp = nullptr;
+}
+
+/**
+ * Column definition destructor
+ */
+SummaryTableColumn::~SummaryTableColumn()
+{
+   if (m_regexp != nullptr)
+      _pcre_free_t(m_regexp);
+}
+
+/**
+ * Compile regular expression for regexp match column
+ */
+void SummaryTableColumn::compileRegexp()
+{
+   if (!isRegexpMatch() || (m_regexp != nullptr))
+      return;
+
+   const char *errptr;
+   int erroffset;
+   m_regexp = _pcre_compile_t(reinterpret_cast<const PCRE_TCHAR*>(m_dciName), PCRE_COMMON_FLAGS | PCRE_CASELESS, &errptr, &erroffset, nullptr);
+   if (m_regexp == nullptr)
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("Cannot compile regular expression \"%s\" for summary table column \"%s\" (%hs at offset %d)"), m_dciName, m_name, errptr, erroffset);
 }
 
 /**
@@ -172,12 +204,13 @@ SummaryTableColumn::SummaryTableColumn(TCHAR *configStr)
       m_flags = 0;
    }
    _tcslcpy(m_name, configStr, MAX_DB_STRING);
+   m_regexp = nullptr;
 }
 
 /**
  * Create ad-hoc summary table definition from NXCP message
  */
-SummaryTable::SummaryTable(const NXCPMessage& msg)
+SummaryTable::SummaryTable(const NXCPMessage& msg) : m_columnsByName(Ownership::True), m_columnsByDescription(Ownership::True)
 {
    m_id = 0;
    m_guid = uuid::generate();
@@ -200,12 +233,13 @@ SummaryTable::SummaryTable(const NXCPMessage& msg)
       id += 10;
    }
    msg.getFieldAsString(VID_DCI_NAME, m_tableDciName, MAX_PARAM_NAME);
+   prepareColumnMatchers();
 }
 
 /**
  * Create summary table definition from DB data
  */
-SummaryTable::SummaryTable(uint32_t id, DB_RESULT hResult)
+SummaryTable::SummaryTable(uint32_t id, DB_RESULT hResult) : m_columnsByName(Ownership::True), m_columnsByDescription(Ownership::True)
 {
    m_id = id;
 
@@ -262,6 +296,60 @@ SummaryTable::SummaryTable(uint32_t id, DB_RESULT hResult)
       MemFree(config);
    }
    DBGetField(hResult, 0, 6, m_tableDciName, MAX_PARAM_NAME);
+   prepareColumnMatchers();
+}
+
+/**
+ * Prepare column matchers: compile regular expressions and build index of exact match columns by DCI name and description
+ */
+void SummaryTable::prepareColumnMatchers()
+{
+   m_columnsByName.setIgnoreCase(true);
+   m_columnsByDescription.setIgnoreCase(true);
+   for(int i = 0; i < m_columns->size(); i++)
+   {
+      SummaryTableColumn *c = m_columns->get(i);
+      if (c->isRegexpMatch())
+      {
+         c->compileRegexp();
+         m_regexpColumns.add(i);
+      }
+      else
+      {
+         StringObjectMap<IntegerArray<int>> *index = c->isMatchByDescription() ? &m_columnsByDescription : &m_columnsByName;
+         IntegerArray<int> *columns = index->get(c->m_dciName);
+         if (columns == nullptr)
+         {
+            columns = new IntegerArray<int>();
+            index->set(c->m_dciName, columns);
+         }
+         columns->add(i);
+      }
+   }
+}
+
+/**
+ * Find columns matching given data collection object. Indexes of matching columns are added to provided array.
+ */
+void SummaryTable::matchColumns(const DCObject *dci, IntegerArray<int> *columns) const
+{
+   IntegerArray<int> *c = m_columnsByName.get(dci->getName());
+   if (c != nullptr)
+      columns->addAll(*c);
+   c = m_columnsByDescription.get(dci->getDescription());
+   if (c != nullptr)
+      columns->addAll(*c);
+
+   for(int i = 0; i < m_regexpColumns.size(); i++)
+   {
+      SummaryTableColumn *tc = m_columns->get(m_regexpColumns.get(i));
+      if (tc->m_regexp == nullptr)
+         continue;
+      const TCHAR *text = tc->isMatchByDescription() ? dci->getDescription() : dci->getName();
+      int ovector[30];
+      if (_pcre_exec_t(tc->m_regexp, nullptr, reinterpret_cast<const PCRE_TCHAR*>(text), static_cast<int>(_tcslen(text)), 0, 0, ovector, 30) >= 0)
+         columns->add(m_regexpColumns.get(i));
+   }
 }
 
 /**
@@ -387,6 +475,116 @@ void SummaryTable::createExportRecord(StringBuffer &xml) const
    xml.append(_T("\t\t\t</columns>\n\t\t</table>\n"));
 }
 
+/**
+ * Summary table query context shared by all batches
+ */
+struct SummaryTableQueryContext
+{
+   SummaryTable *tableDefinition;
+   SharedObjectArray<DataCollectionTarget> *targets;
+   uint32_t userId;
+   VolatileCounter outstandingBatches;
+   Condition completed;
+
+   SummaryTableQueryContext(SummaryTable *_tableDefinition, SharedObjectArray<DataCollectionTarget> *_targets, uint32_t _userId, int numBatches) : completed(true)
+   {
+      tableDefinition = _tableDefinition;
+      targets = _targets;
+      userId = _userId;
+      outstandingBatches = numBatches;
+   }
+};
+
+/**
+ * Batch of targets for summary table query
+ */
+struct SummaryTableQueryBatch
+{
+   SummaryTableQueryContext *context;
+   int start;
+   int end;
+   Table *result;
+
+   SummaryTableQueryBatch(SummaryTableQueryContext *_context, int _start, int _end)
+   {
+      context = _context;
+      start = _start;
+      end = _end;
+      result = _context->tableDefinition->createEmptyResultTable();
+   }
+
+   ~SummaryTableQueryBatch()
+   {
+      delete result;
+   }
+};
+
+/**
+ * Evaluate summary table for batch of targets
+ */
+static void ProcessSummaryTableBatch(SummaryTableQueryBatch *batch)
+{
+   SummaryTableQueryContext *context = batch->context;
+   for(int i = batch->start; i < batch->end; i++)
+      context->targets->get(i)->getDciValuesSummary(context->tableDefinition, batch->result, context->userId);
+   if (InterlockedDecrement(&context->outstandingBatches) == 0)
+      context->completed.set();
+}
+
+/**
+ * Merge partial summary table query result into final result. Columns are matched by name. Column definitions
+ * of item-based tables are updated from partial result if it contains data for that column, so last matching
+ * DCI defines column data type and units, same as in sequential evaluation.
+ */
+static void MergeSummaryTableData(Table *dest, const Table *src, bool updateColumnDefinitions)
+{
+   int numColumns = src->getNumColumns();
+   int *columnMap = static_cast<int*>(MemAllocLocal(numColumns * sizeof(int)));
+   for(int c = 0; c < numColumns; c++)
+   {
+      int index = dest->getColumnIndex(src->getColumnName(c));
+      columnMap[c] = (index != -1) ? index : dest->addColumn(*src->getColumnDefinition(c));
+   }
+
+   int rowOffset = dest->getNumRows();
+   for(int r = 0; r < src->getNumRows(); r++)
+   {
+      dest->addRow();
+      dest->setObjectId(src->getObjectId(r));
+      int baseRow = src->getBaseRow(r);
+      if (baseRow >= 0)
+         dest->setBaseRow(baseRow + rowOffset);
+      int row = dest->getNumRows() - 1;
+      for(int c = 0; c < numColumns; c++)
+      {
+         const TCHAR *value = src->getAsString(r, c);
+         if (value != nullptr)
+            dest->setAt(row, columnMap[c], value);
+         dest->setStatusAt(row, columnMap[c], src->getStatus(r, c));
+         dest->setCellObjectIdAt(row, columnMap[c], src->getCellObjectId(r, c));
+      }
+   }
+
+   if (updateColumnDefinitions)
+   {
+      for(int c = 0; c < numColumns; c++)
+      {
+         bool hasData = false;
+         for(int r = 0; (r < src->getNumRows()) && !hasData; r++)
+            hasData = (src->getCellObjectId(r, c) != 0);
+         if (!hasData)
+            continue;
+
+         const TableColumnDefinition *sc = src->getColumnDefinition(c);
+         dest->setColumnDataType(columnMap[c], sc->getDataType());
+         dest->setColumnUnitName(columnMap[c], sc->getUnitName());
+         dest->setColumnMultiplier(columnMap[c], sc->getMultiplier());
+      }
+   }
+
+   MemFreeLocal(columnMap);
+}
+
 /**
  * Query summary table. If ad-hoc definition is provided it will be deleted by this function.
  */
@@ -418,8 +616,9 @@ Table *QuerySummaryTable(uint32_t tableId, SummaryTable *adHocDefinition, uint32
    if (tableDefinition == nullptr)
       return nullptr;
 
+   // Filter script is executed by single VM, so filtering is done before parallel evaluation
    unique_ptr<SharedObjectArray<NetObj>> childObjects = object->getAllChildren(true);
-   Table *tableData = tableDefinition->createEmptyResultTable();
+   SharedObjectArray<DataCollectionTarget> targets(childObjects->size());
    for(int i = 0; i < childObjects->size(); i++)
    {
       NetObj *obj = childObjects->get(i);
@@ -428,9 +627,34 @@ Table *QuerySummaryTable(uint32_t tableId, SummaryTable *adHocDefinition, uint32
 
       shared_ptr<DataCollectionTarget> target = static_pointer_cast<DataCollectionTarget>(childObjects->getShared(i));
       if (tableDefinition->filter(target))
+         targets.add(target);
+   }
+
+   Table *tableData = tableDefinition->createEmptyResultTable();
+   if (targets.size() <= SUMMARY_TABLE_BATCH_SIZE)
+   {
+      for(int i = 0; i < targets.size(); i++)
+         targets.get(i)->getDciValuesSummary(tableDefinition, tableData, userId);
+   }
+   else
+   {
+      // Evaluate batches of targets in parallel and merge partial results in original target order
+      int numBatches = (targets.size() + SUMMARY_TABLE_BATCH_SIZE - 1) / SUMMARY_TABLE_BATCH_SIZE;
+      SummaryTableQueryContext context(tableDefinition, &targets, userId, numBatches);
+      ObjectArray<SummaryTableQueryBatch> batches(numBatches, 16, Ownership::True);
+      for(int i = 0; i < numBatches; i++)
       {
-         target->getDciValuesSummary(tableDefinition, tableData, userId);
+         SummaryTableQueryBatch *batch = new SummaryTableQueryBatch(&context, i * SUMMARY_TABLE_BATCH_SIZE,
+                  std::min((i + 1) * SUMMARY_TABLE_BATCH_SIZE, targets.size()));
+         batches.add(batch);
+         ThreadPoolExecute(g_mainThreadPool, ProcessSummaryTableBatch, batch);
       }
+      context.completed.wait(INFINITE);
+
+      for(int i = 0; i < numBatches; i++)
+         MergeSummaryTableData(tableData, batches.get(i)->result, !tableDefinition->isTableDciSource());
+      nxlog_debug_tag(DEBUG_TAG, 6, _T("Summary table query on %s [%u]: %d targets evaluated in %d batches"),
+               object->getName(), object->getId(), targets.size(), numBatches);
    }
 
    delete tableDefinition;
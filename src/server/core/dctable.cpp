@@ -371,59 +371,15 @@ bool DCTable::processNewValue(time_t timestamp, const shared_ptr<Table>& value,
 	uint32_t tableId = m_id;
 	uint32_t nodeId = owner->getId();
    bool save = (m_retentionType != DC_RETENTION_NONE);
+   DCObjectStorageClass storageClass = getStorageClass();
 
    unlock();
 
 	// Save data to database
 	// Object is unlocked, so only local variables can be used
    if (save)
-   {
-	   DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
-      if (!DBBegin(hdb))
-      {
-   	   DBConnectionPoolReleaseConnection(hdb);
-         return true;
-      }
-
-      bool success = false;
-
-	   DB_STATEMENT hStmt;
-	   if (g_flags & AF_SINGLE_TABLE_PERF_DATA)
-	   {
-	      if (g_dbSyntax == DB_SYNTAX_TSDB)
-	      {
-	         TCHAR query[256];
-	         _sntprintf(query, 256, _T("INSERT INTO tdata_sc_%s (item_id,tdata_timestamp,tdata_value) VALUES (?,to_timestamp(?),?)"),
-	                  getStorageClassName(getStorageClass()));
-            hStmt = DBPrepare(hdb, query);
-	      }
-	      else
-	      {
-	         hStmt = DBPrepare(hdb, _T("INSERT INTO tdata (item_id,tdata_timestamp,tdata_value) VALUES (?,?,?)"));
-	      }
-	   }
-	   else
-	   {
-	      TCHAR query[256];
-	      _sntprintf(query, 256, _T("INSERT INTO tdata_%u (item_id,tdata_timestamp,tdata_value) VALUES (?,?,?)"), nodeId);
-	      hStmt = DBPrepare(hdb, query);
-	   }
-	   if (hStmt != nullptr)
-	   {
-		   DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, tableId);
-		   DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, (INT32)timestamp);
-		   DBBind(hStmt, 3, DB_SQLTYPE_TEXT, DB_CTYPE_UTF8_STRING, value->createPackedXML(), DB_BIND_DYNAMIC);
-	      success = DBExecute(hStmt);
-		   DBFreeStatement(hStmt);
-	   }
-
-      if (success)
-         DBCommit(hdb);
-      else
-         DBRollback(hdb);
+      QueueTDataInsert(timestamp, nodeId, tableId, storageClass, value);
 
-	   DBConnectionPoolReleaseConnection(hdb);
-   }
    if ((g_offlineDataRelevanceTime <= 0) || (timestamp > (time(nullptr) - g_offlineDataRelevanceTime)))
       checkThresholds(value.get());
 
@@ -496,8 +452,8 @@ void DCTable::checkThresholds(Table *value)
    lock();
    for(int row = 0; row < value->getNumRows(); row++)
    {
-      TCHAR instance[MAX_RESULT_LENGTH];
-      value->buildInstanceString(row, instance, MAX_RESULT_LENGTH);
+      StringBuffer instance;
+      value->buildInstanceString(row, &instance);
       for(int i = 0; i < m_thresholds->size(); i++)
       {
 		   DCTableThreshold *t = m_thresholds->get(i);
@@ -505,13 +461,13 @@ void DCTable::checkThresholds(Table *value)
          switch(result)
          {
             case ThresholdCheckResult::ACTIVATED:
-               PostDciEventWithNames(t->getActivationEvent(), m_ownerId, m_id, "ssids", paramNames, m_name.cstr(), m_description.cstr(), m_id, row, instance);
+               PostDciEventWithNames(t->getActivationEvent(), m_ownerId, m_id, "ssids", paramNames, m_name.cstr(), m_description.cstr(), m_id, row, instance.cstr());
                if (!(m_flags & DCF_ALL_THRESHOLDS))
                   i = m_thresholds->size();  // Stop processing (for current row)
                NotifyClientsOnThresholdChange(m_ownerId, m_id, t->getId(), instance, result);
                break;
             case ThresholdCheckResult::DEACTIVATED:
-               PostDciEventWithNames(t->getDeactivationEvent(), m_ownerId, m_id, "ssids", paramNames, m_name.cstr(), m_description.cstr(), m_id, row, instance);
+               PostDciEventWithNames(t->getDeactivationEvent(), m_ownerId, m_id, "ssids", paramNames, m_name.cstr(), m_description.cstr(), m_id, row, instance.cstr());
                NotifyClientsOnThresholdChange(m_ownerId, m_id, t->getId(), instance, result);
                break;
             case ThresholdCheckResult::ALREADY_ACTIVE:
@@ -1002,9 +958,8 @@ void DCTable::mergeValues(Table *dest, Table *src, int count)
 {
    for(int sRow = 0; sRow < src->getNumRows(); sRow++)
    {
-      TCHAR instance[MAX_RESULT_LENGTH];
-
-      src->buildInstanceString(sRow, instance, MAX_RESULT_LENGTH);
+      StringBuffer instance;
+      src->buildInstanceString(sRow, &instance);
       int dRow = dest->findRowByInstance(instance);
       if (dRow >= 0)
       {
@@ -1066,13 +1021,9 @@ void DCTable::updateResultColumns(const shared_ptr<Table>& t)
       int index = t->getColumnIndex(col->getName());
       if (index != -1)
       {
-         TableColumnDefinition *cd = t->getColumnDefinitions().get(index);
-         if (cd != nullptr)
-         {
-            cd->setDataType(col->getDataType());
-            cd->setInstanceColumn(col->isInstanceColumn());
-            cd->setDisplayName(col->getDisplayName());
-         }
+         t->setColumnDataType(index, col->getDataType());
+         t->setInstanceColumn(index, col->isInstanceColumn());
+         t->setColumnDisplayName(index, col->getDisplayName());
       }
    }
    unlock();
@@ -1384,7 +1335,7 @@ void DCTable::loadCache()
    lock();
    if (encodedTable != nullptr && m_lastValue == nullptr) //m_lastValue can be changed while query is executed
    {
-      m_lastValue = shared_ptr<Table>(Table::createFromPackedXML(encodedTable));
+      m_lastValue = shared_ptr<Table>(Table::createFromPackedData(encodedTable));
       m_lastValueTimestamp = timestamp;
    }
    unlock();
@@ -33,6 +33,7 @@ extern ThreadPool *g_dataCollectorThreadPool;
  * Data collector worker
  */
 void DataCollector(const shared_ptr<DCObject>& dcObject);
+void SNMPBatchCollector(SharedObjectArray<DCObject> *batch);
 
 /**
  * Throttle housekeeper if needed. Returns false if shutdown time has arrived and housekeeper process should be aborted.
@@ -294,6 +295,25 @@ void DataCollectionTarget::calculateDciCutoffTimes(time_t *cutoffTimeIData, time
    unlockDciAccess();
 }
 
+/**
+ * Calculate maximum retention time (in days) for DCIs with data storage enabled
+ */
+void DataCollectionTarget::calculateMaxDciRetentionTime(int *itemRetentionTime, int *tableRetentionTime)
+{
+   readLockDciAccess();
+   for(int i = 0; i < m_dcObjects.size(); i++)
+   {
+      DCObject *o = m_dcObjects.get(i);
+      if (!o->isDataStorageEnabled())
+         continue;
+
+      int *retentionTime = (o->getType() == DCO_TYPE_ITEM) ? itemRetentionTime : tableRetentionTime;
+      if (*retentionTime < o->getEffectiveRetentionTime())
+         *retentionTime = o->getEffectiveRetentionTime();
+   }
+   unlockDciAccess();
+}
+
 /**
  * Clean expired DCI data
  */
@@ -913,6 +933,10 @@ void DataCollectionTarget::queueItemsForPolling()
 
    time_t currTime = time(nullptr);
 
+   // SNMP items collected from node itself are grouped by SNMP port and version for coalesced collection
+   bool coalesceSnmpRequests = (getObjectClass() == OBJECT_NODE) && (g_snmpMaxVarbindsPerRequest > 1);
+   ObjectArray<SharedObjectArray<DCObject>> snmpBatches(0, 4, Ownership::False);
+
    readLockDciAccess();
    for(int i = 0; i < m_dcObjects.size(); i++)
    {
@@ -921,7 +945,26 @@ void DataCollectionTarget::queueItemsForPolling()
       {
          object->setBusyFlag();
 
-         if ((object->getDataSource() == DS_NATIVE_AGENT) ||
+         if (coalesceSnmpRequests && (object->getType() == DCO_TYPE_ITEM) && (object->getDataSource() == DS_SNMP_AGENT) && (getEffectiveSourceNode(object) == 0))
+         {
+            SharedObjectArray<DCObject> *batch = nullptr;
+            for(int j = 0; j < snmpBatches.size(); j++)
+            {
+               DCObject *first = snmpBatches.get(j)->get(0);
+               if ((first->getSnmpPort() == object->getSnmpPort()) && (first->getSnmpVersion() == object->getSnmpVersion()))
+               {
+                  batch = snmpBatches.get(j);
+                  break;
+               }
+            }
+            if (batch == nullptr)
+            {
+               batch = new SharedObjectArray<DCObject>(64, 64);
+               snmpBatches.add(batch);
+            }
+            batch->add(m_dcObjects.getShared(i));
+         }
+         else if ((object->getDataSource() == DS_NATIVE_AGENT) ||
              (object->getDataSource() == DS_WINPERF) ||
              (object->getDataSource() == DS_SNMP_AGENT) ||
              (object->getDataSource() == DS_SSH) ||
@@ -941,6 +984,23 @@ void DataCollectionTarget::queueItemsForPolling()
       }
    }
    unlockDciAccess();
+
+   for(int i = 0; i < snmpBatches.size(); i++)
+   {
+      SharedObjectArray<DCObject> *batch = snmpBatches.get(i);
+      TCHAR key[32];
+      _sntprintf(key, 32, _T("%08X/%s"), m_id, batch->get(0)->getDataProviderName());
+      if (batch->size() == 1)
+      {
+         ThreadPoolExecuteSerialized(g_dataCollectorThreadPool, key, DataCollector, batch->getShared(0));
+         delete batch;
+      }
+      else
+      {
+         nxlog_debug_tag(_T("obj.dc.queue"), 8, _T("DataCollectionTarget(%s)->QueueItemsForPolling(): batch of %d SNMP items added to queue"), m_name, batch->size());
+         ThreadPoolExecuteSerialized(g_dataCollectorThreadPool, key, SNMPBatchCollector, batch);
+      }
+   }
 }
 
 /**
@@ -1556,15 +1616,6 @@ void DataCollectionTarget::getDciValuesSummary(SummaryTable *tableDefinition, Ta
       getItemDciValuesSummary(tableDefinition, tableData, userId);
 }
 
-/**
- * Match data collection object to column definition
- */
-static inline bool MatchDCItem(SummaryTableColumn *tc, DCObject *dci)
-{
-   const TCHAR *text = (tc->m_flags & COLUMN_DEFINITION_BY_DESCRIPTION) ? dci->getDescription() : dci->getName();
-   return (tc->m_flags & COLUMN_DEFINITION_REGEXP_MATCH) ? RegexpMatch(text, tc->m_dciName, false) : (_tcsicmp(text, tc->m_dciName) == 0);
-}
-
 /**
  * Get last (current) DCI values for summary table using single-value DCIs
  */
@@ -1573,88 +1624,115 @@ void DataCollectionTarget::getItemDciValuesSummary(SummaryTable *tableDefinition
    int offset = tableDefinition->isMultiInstance() ? 2 : 1;
    int baseRow = tableData->getNumRows();
    bool rowAdded = false;
+   int numColumns = tableDefinition->getNumColumns();
    readLockDciAccess();
-   for(int i = 0; i < tableDefinition->getNumColumns(); i++)
+
+   // Single pass over DCI list to find matching DCIs for all columns
+   ObjectArray<ObjectArray<DCObject>> columnMatches(numColumns, 16, Ownership::True);
+   for(int i = 0; i < numColumns; i++)
+      columnMatches.add(nullptr);
+   IntegerArray<int> columns(16, 16);
+   for(int j = 0; j < m_dcObjects.size(); j++)
    {
+      DCObject *object = m_dcObjects.get(j);
+      if ((object->getType() != DCO_TYPE_ITEM) || !object->hasValue() || (object->getStatus() != ITEM_STATUS_ACTIVE) || !object->hasAccess(userId))
+         continue;
+
+      columns.clear();
+      tableDefinition->matchColumns(object, &columns);
+      for(int k = 0; k < columns.size(); k++)
+      {
+         ObjectArray<DCObject> *matches = columnMatches.get(columns.get(k));
+         if (matches == nullptr)
+         {
+            matches = new ObjectArray<DCObject>(16, 16, Ownership::False);
+            columnMatches.set(columns.get(k), matches);
+         }
+         matches->add(object);
+      }
+   }
+
+   for(int i = 0; i < numColumns; i++)
+   {
+      ObjectArray<DCObject> *matches = columnMatches.get(i);
+      if (matches == nullptr)
+         continue;
+
       SummaryTableColumn *tc = tableDefinition->getColumn(i);
-      for(int j = 0; j < m_dcObjects.size(); j++)
-	   {
-		   DCObject *object = m_dcObjects.get(j);
-         if ((object->getType() == DCO_TYPE_ITEM) && object->hasValue() && object->hasAccess(userId) &&
-             (object->getStatus() == ITEM_STATUS_ACTIVE) && MatchDCItem(tc, object))
+      for(int j = 0; j < matches->size(); j++)
+      {
+         DCObject *object = matches->get(j);
+         int row;
+         if (tableDefinition->isMultiInstance())
          {
-            int row;
-            if (tableDefinition->isMultiInstance())
+            // Find instance
+            const TCHAR *instance = object->getInstanceName();
+            for(row = baseRow; row < tableData->getNumRows(); row++)
             {
-               // Find instance
-               const TCHAR *instance = object->getInstanceName();
-               for(row = baseRow; row < tableData->getNumRows(); row++)
-               {
-                  const TCHAR *v = tableData->getAsString(row, 1);
-                  if (!_tcscmp(CHECK_NULL_EX(v), instance))
-                     break;
-               }
-               if (row == tableData->getNumRows())
-               {
-                  tableData->addRow();
-                  tableData->set(0, m_name);
-                  tableData->set(1, instance);
-                  tableData->setObjectId(m_id);
-               }
+               const TCHAR *v = tableData->getAsString(row, 1);
+               if (!_tcscmp(CHECK_NULL_EX(v), instance))
+                  break;
             }
-            else
+            if (row == tableData->getNumRows())
             {
-               if (!rowAdded)
-               {
-                  tableData->addRow();
-                  tableData->set(0, m_name);
-                  tableData->setObjectId(m_id);
-                  rowAdded = true;
-               }
-               row = tableData->getNumRows() - 1;
+               tableData->addRow();
+               tableData->set(0, m_name);
+               tableData->set(1, instance);
+               tableData->setObjectId(m_id);
             }
-            tableData->setStatusAt(row, i + offset, static_cast<DCItem*>(object)->getThresholdSeverity());
-            tableData->setCellObjectIdAt(row, i + offset, object->getId());
-            tableData->getColumnDefinitions().get(i + offset)->setDataType(static_cast<DCItem*>(object)->getDataType());
-            tableData->getColumnDefinitions().get(i + offset)->setUnitName(static_cast<DCItem*>(object)->getUnitName());
-            tableData->getColumnDefinitions().get(i + offset)->setMultiplier(static_cast<DCItem*>(object)->getMultiplier());
-            if (tableDefinition->getAggregationFunction() == DCI_AGG_LAST)
+         }
+         else
+         {
+            if (!rowAdded)
+            {
+               tableData->addRow();
+               tableData->set(0, m_name);
+               tableData->setObjectId(m_id);
+               rowAdded = true;
+            }
+            row = tableData->getNumRows() - 1;
+         }
+         tableData->setStatusAt(row, i + offset, static_cast<DCItem*>(object)->getThresholdSeverity());
+         tableData->setCellObjectIdAt(row, i + offset, object->getId());
+         tableData->setColumnDataType(i + offset, static_cast<DCItem*>(object)->getDataType());
+         tableData->setColumnUnitName(i + offset, static_cast<DCItem*>(object)->getUnitName());
+         tableData->setColumnMultiplier(i + offset, static_cast<DCItem*>(object)->getMultiplier());
+         if (tableDefinition->getAggregationFunction() == DCI_AGG_LAST)
+         {
+            if (tc->m_flags & COLUMN_DEFINITION_MULTIVALUED)
             {
-               if (tc->m_flags & COLUMN_DEFINITION_MULTIVALUED)
+               StringList *values = String(static_cast<DCItem*>(object)->getLastValue()).split(tc->m_separator);
+               tableData->setAt(row, i + offset, values->get(0));
+               for(int r = 1; r < values->size(); r++)
                {
-                  StringList *values = String(static_cast<DCItem*>(object)->getLastValue()).split(tc->m_separator);
-                  tableData->setAt(row, i + offset, values->get(0));
-                  for(int r = 1; r < values->size(); r++)
+                  if (row + r >= tableData->getNumRows())
                   {
-                     if (row + r >= tableData->getNumRows())
-                     {
-                        tableData->addRow();
-                        tableData->setObjectId(m_id);
-                        tableData->setBaseRow(row);
-                     }
-                     tableData->setAt(row + r, i + offset, values->get(r));
-                     tableData->setStatusAt(row + r, i + offset, static_cast<DCItem*>(object)->getThresholdSeverity());
-                     tableData->setCellObjectIdAt(row + r, i + offset, object->getId());
+                     tableData->addRow();
+                     tableData->setObjectId(m_id);
+                     tableData->setBaseRow(row);
                   }
-                  delete values;
-               }
-               else
-               {
-                  tableData->setAt(row, i + offset, static_cast<DCItem*>(object)->getLastValue());
+                  tableData->setAt(row + r, i + offset, values->get(r));
+                  tableData->setStatusAt(row + r, i + offset, static_cast<DCItem*>(object)->getThresholdSeverity());
+                  tableData->setCellObjectIdAt(row + r, i + offset, object->getId());
                }
+               delete values;
             }
             else
             {
-               tableData->setPreallocatedAt(row, i + offset,
-                  static_cast<DCItem*>(object)->getAggregateValue(
-                     tableDefinition->getAggregationFunction(),
-                     tableDefinition->getPeriodStart(),
-                     tableDefinition->getPeriodEnd()));
+               tableData->setAt(row, i + offset, static_cast<DCItem*>(object)->getLastValue());
             }
-
-            if (!tableDefinition->isMultiInstance())
-               break;
          }
+         else
+         {
+            tableData->setPreallocatedAt(row, i + offset,
+               static_cast<DCItem*>(object)->getAggregateValue(
+                  tableDefinition->getAggregationFunction(),
+                  tableDefinition->getPeriodStart(),
+                  tableDefinition->getPeriodEnd()));
+         }
+
+         if (!tableDefinition->isMultiInstance())
+            break;
       }
    }
    unlockDciAccess();
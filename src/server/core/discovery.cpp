@@ -50,34 +50,133 @@ static const TCHAR *s_discoveredAddrSourceTypeAsText[] = {
 };
 
 /**
- * IP addresses being processed by node poller
+ * Maximum number of addresses taken from node poller queue for single ICMP sweep
  */
-static ObjectArray<DiscoveredAddress> s_processingList(64, 64, Ownership::False);
-static Mutex s_processingListLock;
+#define DISCOVERY_BATCH_SIZE  256
 
 /**
- * Check if given address is in processing by new node poller
+ * Key for in-flight address index
  */
-static bool IsNodePollerActiveAddress(const InetAddress& addr)
+struct InFlightAddressKey
 {
-   bool result = false;
-   s_processingListLock.lock();
-   for(int i = 0; i < s_processingList.size(); i++)
+   int32_t zoneUIN;
+   int32_t family;
+   BYTE addr[16];
+
+   InFlightAddressKey(int32_t _zoneUIN, const InetAddress& ipAddr)
    {
-      if (s_processingList.get(i)->ipAddr.equals(addr))
+      zoneUIN = _zoneUIN;
+      family = ipAddr.getFamily();
+      memset(addr, 0, sizeof(addr));
+      if (family == AF_INET)
       {
-         result = true;
-         break;
+         uint32_t a = ipAddr.getAddressV4();
+         memcpy(addr, &a, sizeof(uint32_t));
+      }
+      else
+      {
+         memcpy(addr, ipAddr.getAddressV6(), 16);
       }
    }
-   s_processingListLock.unlock();
+};
+
+/**
+ * IP addresses queued for processing or being processed by node poller
+ */
+static HashMap<InFlightAddressKey, DiscoveredAddress> s_inFlightAddresses(Ownership::False);
+static Mutex s_inFlightAddressesLock(MutexType::FAST);
+
+/**
+ * Discovery pipeline stages
+ */
+enum DiscoveryStage
+{
+   DPS_ICMP = 0,
+   DPS_SNMP = 1,
+   DPS_AGENT = 2,
+   DPS_SSH = 3,
+   DPS_TOTAL = 4
+};
+
+/**
+ * Discovery pipeline stage names
+ */
+static const TCHAR *s_discoveryStageNames[] = { _T("ICMP"), _T("SNMP"), _T("Agent"), _T("SSH"), _T("Total") };
+
+/**
+ * Discovery pipeline stage statistics
+ */
+struct DiscoveryStageStats
+{
+   VolatileCounter64 processed;
+   VolatileCounter64 succeeded;
+   VolatileCounter64 elapsedTime;   // Milliseconds
+};
+static DiscoveryStageStats s_stageStats[5];
+
+/**
+ * Update discovery pipeline stage statistics
+ */
+static void UpdateStageStats(DiscoveryStage stage, int64_t processed, int64_t succeeded, int64_t startTime)
+{
+   InterlockedAdd64(&s_stageStats[stage].processed, processed);
+   InterlockedAdd64(&s_stageStats[stage].succeeded, succeeded);
+   InterlockedAdd64(&s_stageStats[stage].elapsedTime, GetCurrentTimeMs() - startTime);
+}
+
+/**
+ * Check if given address is queued for processing or being processed by node poller
+ */
+static bool IsNodePollerActiveAddress(int32_t zoneUIN, const InetAddress& addr)
+{
+   InFlightAddressKey key(zoneUIN, addr);
+   s_inFlightAddressesLock.lock();
+   bool result = s_inFlightAddresses.contains(key);
+   s_inFlightAddressesLock.unlock();
+   return result;
+}
+
+/**
+ * Check if given discovered address is still valid for processing (was not removed by discovery poller reset)
+ */
+static bool IsInFlightAddress(DiscoveredAddress *address)
+{
+   InFlightAddressKey key(address->zoneUIN, address->ipAddr);
+   s_inFlightAddressesLock.lock();
+   bool result = (s_inFlightAddresses.get(key) == address);
+   s_inFlightAddressesLock.unlock();
    return result;
 }
 
 /**
- * Check if host at given IP address is reachable by NetXMS server
+ * Remove discovered address from in-flight address index
+ */
+static void ReleaseInFlightAddress(DiscoveredAddress *address)
+{
+   InFlightAddressKey key(address->zoneUIN, address->ipAddr);
+   s_inFlightAddressesLock.lock();
+   if (s_inFlightAddresses.get(key) == address)
+      s_inFlightAddresses.remove(key);
+   s_inFlightAddressesLock.unlock();
+}
+
+/**
+ * Put discovered address into node poller queue
+ */
+void QueueDiscoveredAddress(DiscoveredAddress *address)
+{
+   InFlightAddressKey key(address->zoneUIN, address->ipAddr);
+   s_inFlightAddressesLock.lock();
+   s_inFlightAddresses.set(key, address);
+   s_inFlightAddressesLock.unlock();
+   g_nodePollerQueue.put(address);
+}
+
+/**
+ * Check if host at given IP address is reachable by NetXMS server. ICMP check is skipped if ping status
+ * is already known from ICMP sweep.
  */
-static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool fullCheck, SNMP_Transport **transport,
+static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, DiscoveryPingStatus pingStatus, bool fullCheck, SNMP_Transport **transport,
       shared_ptr<AgentConnection> *preparedAgentConnection, SSHCredentials *sshCredentials, uint16_t *sshPort)
 {
    bool reachable = false;
@@ -102,7 +201,13 @@ static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool ful
    }
 
    // *** ICMP PING ***
-   if (zoneProxy != 0)
+   int64_t startTime = GetCurrentTimeMs();
+   if (pingStatus != DiscoveryPingStatus::UNKNOWN)
+   {
+      // Address was already checked by ICMP sweep
+      reachable = (pingStatus == DiscoveryPingStatus::REACHABLE);
+   }
+   else if (zoneProxy != 0)
    {
       shared_ptr<Node> proxyNode = static_pointer_cast<Node>(g_idxNodeById.get(zoneProxy));
       if ((proxyNode != nullptr) && proxyNode->isNativeAgent() && !proxyNode->isDown())
@@ -133,6 +238,40 @@ static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool ful
       if (IcmpPing(ipAddr, 3, g_icmpPingTimeout, nullptr, g_icmpPingSize, false) == ICMP_SUCCESS)
          reachable = true;
    }
+   if (pingStatus == DiscoveryPingStatus::UNKNOWN)
+      UpdateStageStats(DPS_ICMP, 1, reachable ? 1 : 0, startTime);
+
+   if (reachable && !fullCheck)
+      return true;
+
+   // *** SNMP ***
+   if ((g_flags & (AF_DISABLE_SNMP_V3_PROBE | AF_DISABLE_SNMP_V2_PROBE | AF_DISABLE_SNMP_V1_PROBE)) != (AF_DISABLE_SNMP_V3_PROBE | AF_DISABLE_SNMP_V2_PROBE | AF_DISABLE_SNMP_V1_PROBE))
+   {
+      startTime = GetCurrentTimeMs();
+      SNMP_Version version;
+      StringList oids;
+      oids.add(_T(".1.3.6.1.2.1.1.2.0"));
+      oids.add(_T(".1.3.6.1.2.1.1.1.0"));
+      AddDriverSpecificOids(&oids);
+      SNMP_Transport *snmpTransport = SnmpCheckCommSettings(zoneProxy, ipAddr, &version, 0, nullptr, oids, zoneUIN, true);
+      UpdateStageStats(DPS_SNMP, 1, (snmpTransport != nullptr) ? 1 : 0, startTime);
+      if (snmpTransport != nullptr)
+      {
+         if (transport != nullptr)
+         {
+            snmpTransport->setSnmpVersion(version);
+            *transport = snmpTransport;
+            snmpTransport = nullptr;   // prevent deletion
+         }
+         reachable = true;
+         delete snmpTransport;
+      }
+   }
+   else
+   {
+      TCHAR ipAddrText[64];
+      nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("HostIsReachable(%s): all SNMP probes disabled"), ipAddr.toString(ipAddrText));
+   }
 
    if (reachable && !fullCheck)
       return true;
@@ -140,6 +279,7 @@ static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool ful
    // *** NetXMS agent ***
    if (!(g_flags & AF_DISABLE_AGENT_PROBE))
    {
+      startTime = GetCurrentTimeMs();
       auto agentConnection = make_shared<AgentConnectionEx>(0, ipAddr, AGENT_LISTEN_PORT, nullptr);
       shared_ptr<Node> proxyNode;
       if (zoneProxy != 0)
@@ -213,6 +353,7 @@ static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool ful
                   ipAddr.toString(ipAddrText), rcc, AgentErrorCodeToText(rcc), (proxyNode != nullptr) ? _T(", proxy node ") : _T(""),
                   (proxyNode != nullptr) ? proxyNode->getName() : _T(""));
       }
+      UpdateStageStats(DPS_AGENT, 1, (rcc == ERR_SUCCESS) ? 1 : 0, startTime);
    }
    else
    {
@@ -220,46 +361,19 @@ static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool ful
       nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("HostIsReachable(%s): agent connection probe disabled"), ipAddr.toString(ipAddrText));
    }
 
-   if (reachable && !fullCheck)
-      return true;
-
-   // *** SNMP ***
-   if ((g_flags & (AF_DISABLE_SNMP_V3_PROBE | AF_DISABLE_SNMP_V2_PROBE | AF_DISABLE_SNMP_V1_PROBE)) != (AF_DISABLE_SNMP_V3_PROBE | AF_DISABLE_SNMP_V2_PROBE | AF_DISABLE_SNMP_V1_PROBE))
-   {
-      SNMP_Version version;
-      StringList oids;
-      oids.add(_T(".1.3.6.1.2.1.1.2.0"));
-      oids.add(_T(".1.3.6.1.2.1.1.1.0"));
-      AddDriverSpecificOids(&oids);
-      SNMP_Transport *snmpTransport = SnmpCheckCommSettings(zoneProxy, ipAddr, &version, 0, nullptr, oids, zoneUIN, true);
-      if (snmpTransport != nullptr)
-      {
-         if (transport != nullptr)
-         {
-            snmpTransport->setSnmpVersion(version);
-            *transport = snmpTransport;
-            snmpTransport = nullptr;   // prevent deletion
-         }
-         reachable = true;
-         delete snmpTransport;
-      }
-   }
-   else
-   {
-      TCHAR ipAddrText[64];
-      nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("HostIsReachable(%s): all SNMP probes disabled"), ipAddr.toString(ipAddrText));
-   }
-
    if (reachable && !fullCheck)
       return true;
 
    // *** SSH ***
    if (!(g_flags & AF_DISABLE_SSH_PROBE))
    {
-      if (SSHCheckCommSettings((zoneProxy != 0) ? zoneProxy : g_dwMgmtNode, ipAddr, zoneUIN, sshCredentials, sshPort))
+      startTime = GetCurrentTimeMs();
+      bool success = SSHCheckCommSettings((zoneProxy != 0) ? zoneProxy : g_dwMgmtNode, ipAddr, zoneUIN, sshCredentials, sshPort);
+      if (success)
       {
          reachable = true;
       }
+      UpdateStageStats(DPS_SSH, 1, success ? 1 : 0, startTime);
    }
    else
    {
@@ -273,7 +387,7 @@ static bool HostIsReachable(const InetAddress& ipAddr, int32_t zoneUIN, bool ful
 /**
  * Check if newly discovered node should be added
  */
-static bool AcceptNewNode(NewNodeData *newNodeData)
+static bool AcceptNewNode(NewNodeData *newNodeData, DiscoveryPingStatus pingStatus)
 {
    TCHAR buffer[256], ipAddrText[64];
 
@@ -370,7 +484,7 @@ static bool AcceptNewNode(NewNodeData *newNodeData)
          if (iface == nullptr)
             break;
 
-         if (!HostIsReachable(newNodeData->ipAddr, newNodeData->zoneUIN, false, nullptr, nullptr, nullptr, nullptr))
+         if (!HostIsReachable(newNodeData->ipAddr, newNodeData->zoneUIN, pingStatus, false, nullptr, nullptr, nullptr, nullptr))
          {
             nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("AcceptNewNode(%s): found existing interface with same MAC address, but new IP is not reachable"), ipAddrText);
             return false;
@@ -444,7 +558,7 @@ static bool AcceptNewNode(NewNodeData *newNodeData)
    shared_ptr<AgentConnection> agentConnection;
    SSHCredentials sshCredentials;
    uint16_t sshPort;
-   if (!HostIsReachable(newNodeData->ipAddr, newNodeData->zoneUIN, true, &snmpTransport, &agentConnection, &sshCredentials, &sshPort))
+   if (!HostIsReachable(newNodeData->ipAddr, newNodeData->zoneUIN, pingStatus, true, &snmpTransport, &agentConnection, &sshCredentials, &sshPort))
    {
       nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("AcceptNewNode(%s): host is not reachable"), ipAddrText);
       return false;
@@ -718,19 +832,18 @@ static void CreateDiscoveredNode(NewNodeData *newNodeData)
  */
 static void ProcessDiscoveredAddress(DiscoveredAddress *address)
 {
-   s_processingListLock.lock();
-   bool addressInList = s_processingList.contains(address);
-   s_processingListLock.unlock();
-
-   if (!IsShutdownInProgress() && addressInList)//no shutdown process and address is in list
+   int64_t startTime = GetCurrentTimeMs();
+   bool accepted = false;
+   if (!IsShutdownInProgress() && IsInFlightAddress(address))
    {
       auto newNodeData = new NewNodeData(address->ipAddr, address->macAddr);
       newNodeData->zoneUIN = address->zoneUIN;
       newNodeData->origin = NODE_ORIGIN_NETWORK_DISCOVERY;
       newNodeData->doConfPoll = true;
 
-      if (address->ignoreFilter || AcceptNewNode(newNodeData))
+      if (address->ignoreFilter || AcceptNewNode(newNodeData, address->pingStatus))
       {
+         accepted = true;
          if (g_discoveryThreadPool != nullptr)
          {
             TCHAR key[32];
@@ -752,12 +865,70 @@ static void ProcessDiscoveredAddress(DiscoveredAddress *address)
       nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 6, _T("ProcessDiscoveredAddress(%s): address discarded."), address->ipAddr.toString().cstr());
    }
 
-   s_processingListLock.lock();
-   s_processingList.remove(address);
-   s_processingListLock.unlock();
+   UpdateStageStats(DPS_TOTAL, 1, accepted ? 1 : 0, startTime);
+   ReleaseInFlightAddress(address);
    delete address;
 }
 
+/**
+ * Callback for ICMP sweep
+ */
+static void PingSweepCallback(const InetAddress& addr, int32_t zoneUIN, const Node *proxy, uint32_t rtt, const TCHAR *proto, ServerConsole *console, void *context)
+{
+   static_cast<HashSet<uint32_t>*>(context)->put(addr.getAddressV4());
+}
+
+/**
+ * Check batch of discovered addresses with single ICMP sweep. Addresses behind zone proxy and non-IPv4
+ * addresses are left for individual check.
+ */
+static void RunPingSweep(ObjectArray<DiscoveredAddress> *batch)
+{
+   IntegerArray<uint32_t> addrList(batch->size());
+   for(int i = 0; i < batch->size(); i++)
+   {
+      DiscoveredAddress *address = batch->get(i);
+      if (address->ipAddr.getFamily() != AF_INET)
+         continue;
+      if (IsZoningEnabled() && (address->zoneUIN != 0))
+      {
+         shared_ptr<Zone> zone = FindZoneByUIN(address->zoneUIN);
+         if ((zone != nullptr) && (zone->getProxyNodeId(nullptr) != 0))
+            continue;
+      }
+      addrList.add(address->ipAddr.getAddressV4());
+   }
+   if (addrList.isEmpty())
+      return;
+
+   int64_t startTime = GetCurrentTimeMs();
+   HashSet<uint32_t> responses;
+   if (!ScanAddressListICMP(addrList, PingSweepCallback, nullptr, &responses))
+   {
+      nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 5, _T("ICMP sweep cannot be started, addresses will be checked individually"));
+      return;
+   }
+
+   int succeeded = 0;
+   for(int i = 0; i < batch->size(); i++)
+   {
+      DiscoveredAddress *address = batch->get(i);
+      if ((address->ipAddr.getFamily() != AF_INET) || !addrList.contains(address->ipAddr.getAddressV4()))
+         continue;
+      if (responses.contains(address->ipAddr.getAddressV4()))
+      {
+         address->pingStatus = DiscoveryPingStatus::REACHABLE;
+         succeeded++;
+      }
+      else
+      {
+         address->pingStatus = DiscoveryPingStatus::UNREACHABLE;
+      }
+   }
+   UpdateStageStats(DPS_ICMP, addrList.size(), succeeded, startTime);
+   nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 6, _T("ICMP sweep completed for %d addresses (%d responded)"), addrList.size(), succeeded);
+}
+
 /**
  * Node poller thread (poll new nodes and put them into the database)
  */
@@ -768,49 +939,62 @@ void NodePoller()
    ThreadSetName("NodePoller");
    nxlog_debug(1, _T("Node poller started"));
 
-   while(!IsShutdownInProgress())
+   ObjectArray<DiscoveredAddress> batch(DISCOVERY_BATCH_SIZE, DISCOVERY_BATCH_SIZE, Ownership::False);
+   bool stop = false;
+   while(!stop && !IsShutdownInProgress())
    {
       DiscoveredAddress *address = g_nodePollerQueue.getOrBlock();
       if (address == INVALID_POINTER_VALUE)
          break;   // Shutdown indicator received
 
-      nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("NodePoller: processing address %s/%d in zone %d (source type %s, source node [%u])"),
-               address->ipAddr.toString(szIpAddr), address->ipAddr.getMaskBits(), (int)address->zoneUIN,
-               s_discoveredAddrSourceTypeAsText[address->sourceType], address->sourceNodeId);
+      // Take all addresses already waiting in queue so they can be checked by single ICMP sweep
+      batch.add(address);
+      while(batch.size() < DISCOVERY_BATCH_SIZE)
+      {
+         address = g_nodePollerQueue.get();
+         if (address == nullptr)
+            break;
+         if (address == INVALID_POINTER_VALUE)
+         {
+            stop = true;   // Shutdown indicator received, pass already collected addresses to processing and exit
+            break;
+         }
+         batch.add(address);
+      }
 
-      s_processingListLock.lock();
-      s_processingList.add(address);
-      s_processingListLock.unlock();
+      if (!stop)
+         RunPingSweep(&batch);
 
-      if (g_discoveryThreadPool != nullptr)
+      for(int i = 0; i < batch.size(); i++)
       {
-         if (g_flags & AF_PARALLEL_NETWORK_DISCOVERY)
+         address = batch.get(i);
+         nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("NodePoller: processing address %s/%d in zone %d (source type %s, source node [%u])"),
+                  address->ipAddr.toString(szIpAddr), address->ipAddr.getMaskBits(), (int)address->zoneUIN,
+                  s_discoveredAddrSourceTypeAsText[address->sourceType], address->sourceNodeId);
+
+         if (g_discoveryThreadPool != nullptr)
          {
-            ThreadPoolExecute(g_discoveryThreadPool, ProcessDiscoveredAddress, address);
+            if (g_flags & AF_PARALLEL_NETWORK_DISCOVERY)
+            {
+               ThreadPoolExecute(g_discoveryThreadPool, ProcessDiscoveredAddress, address);
+            }
+            else
+            {
+               TCHAR key[32];
+               _sntprintf(key, 32, _T("PROC/%u"), address->zoneUIN);
+               ThreadPoolExecuteSerialized(g_discoveryThreadPool, key, ProcessDiscoveredAddress, address);
+            }
          }
          else
          {
-            TCHAR key[32];
-            _sntprintf(key, 32, _T("PROC/%u"), address->zoneUIN);
-            ThreadPoolExecuteSerialized(g_discoveryThreadPool, key, ProcessDiscoveredAddress, address);
+            ProcessDiscoveredAddress(address);
          }
       }
-      else
-      {
-         ProcessDiscoveredAddress(address);
-      }
+      batch.clear();
    }
    nxlog_debug(1, _T("Node poller thread terminated"));
 }
 
-/**
- * Comparator for poller queue elements
- */
-static bool PollerQueueElementComparator(const InetAddress *key, const DiscoveredAddress *element)
-{
-   return key->equals(element->ipAddr);
-}
-
 /**
  * Check potential new node from sysog, SNMP trap, or address range scan
  */
@@ -839,7 +1023,7 @@ void CheckPotentialNode(const InetAddress& ipAddr, int32_t zoneUIN, DiscoveredAd
       return;
    }
 
-   if (IsNodePollerActiveAddress(ipAddr) || (g_nodePollerQueue.find(&ipAddr, PollerQueueElementComparator) != nullptr))
+   if (IsNodePollerActiveAddress(zoneUIN, ipAddr))
    {
       nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 6, _T("Potential node %s rejected (IP address already queued for polling)"), ipAddr.toString(buffer));
       return;
@@ -853,7 +1037,7 @@ void CheckPotentialNode(const InetAddress& ipAddr, int32_t zoneUIN, DiscoveredAd
          DiscoveredAddress *addressInfo = new DiscoveredAddress(ipAddr, zoneUIN, sourceNodeId, sourceType);
          addressInfo->ipAddr.setMaskBits(subnet->getIpAddress().getMaskBits());
          nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 5, _T("New node queued: %s/%d"), addressInfo->ipAddr.toString(buffer), addressInfo->ipAddr.getMaskBits());
-         g_nodePollerQueue.put(addressInfo);
+         QueueDiscoveredAddress(addressInfo);
       }
       else
       {
@@ -864,7 +1048,7 @@ void CheckPotentialNode(const InetAddress& ipAddr, int32_t zoneUIN, DiscoveredAd
    {
       DiscoveredAddress *addressInfo = new DiscoveredAddress(ipAddr, zoneUIN, sourceNodeId, sourceType);
       nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 5, _T("New node queued: %s/%d"), addressInfo->ipAddr.toString(buffer), addressInfo->ipAddr.getMaskBits());
-      g_nodePollerQueue.put(addressInfo);
+      QueueDiscoveredAddress(addressInfo);
    }
 }
 
@@ -906,7 +1090,7 @@ static void CheckPotentialNode(Node *node, const InetAddress& ipAddr, uint32_t i
       return;
    }
 
-   if (IsNodePollerActiveAddress(ipAddr) || (g_nodePollerQueue.find(&ipAddr, PollerQueueElementComparator) != nullptr))
+   if (IsNodePollerActiveAddress(node->getZoneUIN(), ipAddr))
    {
       nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 6, _T("Potential node %s rejected (IP address already queued for polling)"), ipAddr.toString(buffer));
       return;
@@ -930,7 +1114,7 @@ static void CheckPotentialNode(Node *node, const InetAddress& ipAddr, uint32_t i
                addressInfo->ipAddr.setMaskBits(interfaceAddress.getMaskBits());
                addressInfo->macAddr = macAddr;
                nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 5, _T("New node queued: %s/%d"), addressInfo->ipAddr.toString(buffer), addressInfo->ipAddr.getMaskBits());
-               g_nodePollerQueue.put(addressInfo);
+               QueueDiscoveredAddress(addressInfo);
             }
             else
             {
@@ -1077,9 +1261,9 @@ static void ScanCallback(const InetAddress& addr, uint32_t rtt, void *context)
 }
 
 /**
- * Scan address range via SNMP
+ * Scan address range via SNMP (all given communities with SNMPv1 and SNMPv2c, and SNMPv3, probed in single pass)
  */
-static void ScanAddressRangeSNMP(const InetAddress& from, const InetAddress& to, uint16_t port, SNMP_Version snmpVersion, const char *community,
+static void ScanAddressRangeSNMP(const InetAddress& from, const InetAddress& to, uint16_t port, const StringList& communities,
       void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context)
 {
    ScanCallbackData cd;
@@ -1087,7 +1271,7 @@ static void ScanAddressRangeSNMP(const InetAddress& from, const InetAddress& to,
    cd.console = console;
    cd.context = context;
    cd.protocol = _T("SNMP");
-   SnmpScanAddressRange(from, to, port, snmpVersion, community, ScanCallback, &cd);
+   SnmpScanAddressRange(from, to, port, communities, true, ScanCallback, &cd);
 }
 
 /**
@@ -1143,9 +1327,54 @@ static void ScanAddressRangeTCPProxy(AgentConnection *conn, uint32_t from, uint3
 }
 
 /**
- * Check given address range with ICMP ping for new nodes
+ * Context for parallel scan
  */
-void CheckRange(const InetAddressListElement& range, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context)
+struct ParallelScanContext
+{
+   const std::function<void (int)> *task;
+   int count;
+   VolatileCounter next;
+   VolatileCounter workers;
+   Condition completed;
+
+   ParallelScanContext(int _count, int _workers, const std::function<void (int)> *_task) : completed(true)
+   {
+      task = _task;
+      count = _count;
+      next = 0;
+      workers = _workers;
+   }
+
+   void run()
+   {
+      int index;
+      while(!IsShutdownInProgress() && ((index = InterlockedIncrement(&next) - 1) < count))
+         (*task)(index);
+      if (InterlockedDecrement(&workers) == 0)
+         completed.set();
+   }
+};
+
+/**
+ * Run task for each index in range [0, count) using up to maxWorkers parallel workers. Calling thread is one
+ * of the workers, additional workers are started in given thread pool (if provided).
+ */
+static void RunParallelScan(ThreadPool *pool, int count, int maxWorkers, const std::function<void (int)>& task)
+{
+   int workers = (pool != nullptr) ? std::max(std::min(maxWorkers, count), 1) : 1;
+   ParallelScanContext context(count, workers, &task);
+   for(int i = 1; i < workers; i++)
+      ThreadPoolExecute(pool, [&context] () { context.run(); });
+   context.run();
+   context.completed.wait(INFINITE);
+}
+
+/**
+ * Check given address range for new nodes. Address blocks within range are scanned by up to maxParallelBlocks
+ * workers from given thread pool.
+ */
+static void ScanRange(const InetAddressListElement& range, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*),
+         ServerConsole *console, void *context, ThreadPool *pool, int maxParallelBlocks)
 {
    if (range.getBaseAddress().getFamily() != AF_INET)
    {
@@ -1172,9 +1401,28 @@ void CheckRange(const InetAddressListElement& range, void (*callback)(const Inet
    }
 
    uint32_t blockSize = ConfigReadULong(_T("NetworkDiscovery.ActiveDiscovery.BlockSize"), 1024);
+   if (blockSize == 0)
+      blockSize = 1024;
    uint32_t interBlockDelay = ConfigReadULong(_T("NetworkDiscovery.ActiveDiscovery.InterBlockDelay"), 0);
    bool snmpScanEnabled = ConfigReadBoolean(_T("NetworkDiscovery.ActiveDiscovery.EnableSNMPProbing"), true);
    bool tcpScanEnabled = ConfigReadBoolean(_T("NetworkDiscovery.ActiveDiscovery.EnableTCPProbing"), false);
+   int blockCount = static_cast<int>((static_cast<uint64_t>(to) - from) / blockSize + 1);
+
+   IntegerArray<uint16_t> snmpPorts;
+   unique_ptr<StringList> communities;
+   if (snmpScanEnabled)
+   {
+      snmpPorts.addAll(GetWellKnownPorts(_T("snmp"), 0));
+      communities = SnmpGetKnownCommunities(0);
+   }
+
+   IntegerArray<uint16_t> tcpPorts;
+   if (tcpScanEnabled)
+   {
+      tcpPorts.addAll(GetWellKnownPorts(_T("agent"), 0));
+      tcpPorts.addAll(GetWellKnownPorts(_T("ssh"), 0));
+      tcpPorts.add(ETHERNET_IP_DEFAULT_PORT);
+   }
 
    if ((range.getZoneUIN() != 0) || (range.getProxyId() != 0))
    {
@@ -1211,59 +1459,55 @@ void CheckRange(const InetAddressListElement& range, void (*callback)(const Inet
 
       TCHAR ipAddr1[64], ipAddr2[64], rangeText[128];
       _sntprintf(rangeText, 128, _T("%s - %s"), IpToStr(from, ipAddr1), IpToStr(to, ipAddr2));
-      ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 4, _T("Starting active discovery check on range %s via proxy %s [%u]"), rangeText, proxy->getName(), proxy->getId());
-      while((from <= to) && !IsShutdownInProgress())
-      {
-         if (interBlockDelay > 0)
-            ThreadSleepMs(interBlockDelay);
+      ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 4, _T("Starting active discovery check on range %s via proxy %s [%u] (snmp=%s tcp=%s bs=%u delay=%u)"),
+            rangeText, proxy->getName(), proxy->getId(), snmpScanEnabled ? _T("true") : _T("false"), tcpScanEnabled ? _T("true") : _T("false"), blockSize, interBlockDelay);
+      RunParallelScan(pool, blockCount, maxParallelBlocks,
+         [&] (int block) -> void
+         {
+            if (interBlockDelay > 0)
+               ThreadSleepMs(interBlockDelay);
 
-         uint32_t blockEndAddr = std::min(to, from + blockSize - 1);
+            TCHAR ipAddr1[64], ipAddr2[64];
+            uint32_t blockStartAddr = static_cast<uint32_t>(from + static_cast<uint64_t>(block) * blockSize);
+            uint32_t blockEndAddr = static_cast<uint32_t>(std::min(static_cast<uint64_t>(to), static_cast<uint64_t>(blockStartAddr) + blockSize - 1));
 
-         TCHAR request[256];
-         _sntprintf(request, 256, _T("ICMP.ScanRange(%s,%s)"), IpToStr(from, ipAddr1), IpToStr(blockEndAddr, ipAddr2));
-         StringList *list;
-         if (conn->getList(request, &list) == ERR_SUCCESS)
-         {
-            for(int i = 0; i < list->size(); i++)
+            TCHAR request[256];
+            _sntprintf(request, 256, _T("ICMP.ScanRange(%s,%s)"), IpToStr(blockStartAddr, ipAddr1), IpToStr(blockEndAddr, ipAddr2));
+            StringList *list;
+            if (conn->getList(request, &list) == ERR_SUCCESS)
             {
-               callback(InetAddress::parse(list->get(i)), range.getZoneUIN(), proxy.get(), 0, _T("ICMP"), console, nullptr);
+               for(int i = 0; i < list->size(); i++)
+               {
+                  callback(InetAddress::parse(list->get(i)), range.getZoneUIN(), proxy.get(), 0, _T("ICMP"), console, nullptr);
+               }
+               delete list;
             }
-            delete list;
-         }
 
-         if (snmpScanEnabled)
-         {
-            ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting SNMP check on range %s - %s via proxy %s [%u] (snmp=%s tcp=%s bs=%u delay=%u)"),
-                  IpToStr(from, ipAddr1), IpToStr(to, ipAddr2), proxy->getName(), proxy->getId(), snmpScanEnabled ? _T("true") : _T("false"),
-                  tcpScanEnabled ? _T("true") : _T("false"), blockSize, interBlockDelay);
-            IntegerArray<uint16_t> ports = GetWellKnownPorts(_T("snmp"), 0);
-            unique_ptr<StringList> communities = SnmpGetKnownCommunities(0);
-            for(int i = 0; i < ports.size(); i++)
+            if (snmpScanEnabled)
             {
-               uint16_t port = ports.get(i);
-               for(int j = 0; j < communities->size(); j++)
+               ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting SNMP check on range %s - %s via proxy %s [%u]"),
+                     IpToStr(blockStartAddr, ipAddr1), IpToStr(blockEndAddr, ipAddr2), proxy->getName(), proxy->getId());
+               for(int i = 0; i < snmpPorts.size(); i++)
                {
-                  const TCHAR *community = communities->get(j);
-                  ScanAddressRangeSNMPProxy(conn.get(), from, blockEndAddr, port, SNMP_VERSION_1, community, callback, range.getZoneUIN(), proxy.get(), console);
-                  ScanAddressRangeSNMPProxy(conn.get(), from, blockEndAddr, port, SNMP_VERSION_2C, community, callback, range.getZoneUIN(), proxy.get(), console);
+                  uint16_t port = snmpPorts.get(i);
+                  for(int j = 0; j < communities->size(); j++)
+                  {
+                     const TCHAR *community = communities->get(j);
+                     ScanAddressRangeSNMPProxy(conn.get(), blockStartAddr, blockEndAddr, port, SNMP_VERSION_1, community, callback, range.getZoneUIN(), proxy.get(), console);
+                     ScanAddressRangeSNMPProxy(conn.get(), blockStartAddr, blockEndAddr, port, SNMP_VERSION_2C, community, callback, range.getZoneUIN(), proxy.get(), console);
+                  }
+                  ScanAddressRangeSNMPProxy(conn.get(), blockStartAddr, blockEndAddr, port, SNMP_VERSION_3, nullptr, callback, range.getZoneUIN(), proxy.get(), console);
                }
-               ScanAddressRangeSNMPProxy(conn.get(), from, blockEndAddr, port, SNMP_VERSION_3, nullptr, callback, range.getZoneUIN(), proxy.get(), console);
             }
-         }
 
-         if (tcpScanEnabled)
-         {
-            ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting TCP check on range %s - %s via proxy %s [%u]"),
-                  IpToStr(from, ipAddr1), IpToStr(to, ipAddr2), proxy->getName(), proxy->getId());
-            IntegerArray<uint16_t> ports = GetWellKnownPorts(_T("agent"), 0);
-            ports.addAll(GetWellKnownPorts(_T("ssh"), 0));
-            for(int i = 0; i < ports.size(); i++)
-               ScanAddressRangeTCPProxy(conn.get(), from, blockEndAddr, ports.get(i), callback, range.getZoneUIN(), proxy.get(), console);
-            ScanAddressRangeTCPProxy(conn.get(), from, blockEndAddr, ETHERNET_IP_DEFAULT_PORT, callback, range.getZoneUIN(), proxy.get(), console);
-         }
-
-         from += blockSize;
-      }
+            if (tcpScanEnabled)
+            {
+               ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting TCP check on range %s - %s via proxy %s [%u]"),
+                     IpToStr(blockStartAddr, ipAddr1), IpToStr(blockEndAddr, ipAddr2), proxy->getName(), proxy->getId());
+               for(int i = 0; i < tcpPorts.size(); i++)
+                  ScanAddressRangeTCPProxy(conn.get(), blockStartAddr, blockEndAddr, tcpPorts.get(i), callback, range.getZoneUIN(), proxy.get(), console);
+            }
+         });
       ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 4, _T("Finished active discovery check on range %s via proxy %s [%u]"), rangeText, proxy->getName(), proxy->getId());
    }
    else
@@ -1272,67 +1516,122 @@ void CheckRange(const InetAddressListElement& range, void (*callback)(const Inet
       _sntprintf(rangeText, 128, _T("%s - %s"), IpToStr(from, ipAddr1), IpToStr(to, ipAddr2));
       ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 4, _T("Starting active discovery check on range %s (snmp=%s tcp=%s bs=%u delay=%u)"),
             rangeText, snmpScanEnabled ? _T("true") : _T("false"), tcpScanEnabled ? _T("true") : _T("false"), blockSize, interBlockDelay);
-      while((from <= to) && !IsShutdownInProgress())
-      {
-         if (interBlockDelay > 0)
-            ThreadSleepMs(interBlockDelay);
+      RunParallelScan(pool, blockCount, maxParallelBlocks,
+         [&] (int block) -> void
+         {
+            if (interBlockDelay > 0)
+               ThreadSleepMs(interBlockDelay);
 
-         uint32_t blockEndAddr = std::min(to, from + blockSize - 1);
+            TCHAR ipAddr1[64], ipAddr2[64];
+            uint32_t blockStartAddr = static_cast<uint32_t>(from + static_cast<uint64_t>(block) * blockSize);
+            uint32_t blockEndAddr = static_cast<uint32_t>(std::min(static_cast<uint64_t>(to), static_cast<uint64_t>(blockStartAddr) + blockSize - 1));
 
-         ScanAddressRangeICMP(from, blockEndAddr, callback, console, nullptr);
+            ScanAddressRangeICMP(blockStartAddr, blockEndAddr, callback, console, nullptr);
 
-         if (snmpScanEnabled)
-         {
-            ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting SNMP check on range %s - %s"), IpToStr(from, ipAddr1), IpToStr(blockEndAddr, ipAddr2));
-            IntegerArray<uint16_t> ports = GetWellKnownPorts(_T("snmp"), 0);
-            unique_ptr<StringList> communities = SnmpGetKnownCommunities(0);
-            for(int i = 0; i < ports.size(); i++)
+            if (snmpScanEnabled)
             {
-               uint16_t port = ports.get(i);
-               for(int j = 0; j < communities->size(); j++)
-               {
-#ifdef UNICODE
-                  char community[256];
-                  wchar_to_mb(communities->get(j), -1, community, 256);
-#else
-                  const char *community = communities->get(j);
-#endif
-                  ScanAddressRangeSNMP(from, blockEndAddr, port, SNMP_VERSION_1, community, callback, console, nullptr);
-                  ScanAddressRangeSNMP(from, blockEndAddr, port, SNMP_VERSION_2C, community, callback, console, nullptr);
-               }
-               ScanAddressRangeSNMP(from, blockEndAddr, port, SNMP_VERSION_3, nullptr, callback, console, nullptr);
+               ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting SNMP check on range %s - %s"), IpToStr(blockStartAddr, ipAddr1), IpToStr(blockEndAddr, ipAddr2));
+               for(int i = 0; i < snmpPorts.size(); i++)
+                  ScanAddressRangeSNMP(blockStartAddr, blockEndAddr, snmpPorts.get(i), *communities, callback, console, nullptr);
             }
-         }
 
-         if (tcpScanEnabled)
-         {
-            ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting TCP check on range %s - %s"), IpToStr(from, ipAddr1), IpToStr(blockEndAddr, ipAddr2));
-            IntegerArray<uint16_t> ports = GetWellKnownPorts(_T("agent"), 0);
-            ports.addAll(GetWellKnownPorts(_T("ssh"), 0));
-            for(int i = 0; i < ports.size(); i++)
-               ScanAddressRangeTCP(from, blockEndAddr, ports.get(i), callback, console, nullptr);
-            ScanAddressRangeTCP(from, blockEndAddr, ETHERNET_IP_DEFAULT_PORT, callback, console, nullptr);
-         }
-
-         from += blockSize;
-      }
+            if (tcpScanEnabled)
+            {
+               ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 5, _T("Starting TCP check on range %s - %s"), IpToStr(blockStartAddr, ipAddr1), IpToStr(blockEndAddr, ipAddr2));
+               for(int i = 0; i < tcpPorts.size(); i++)
+                  ScanAddressRangeTCP(blockStartAddr, blockEndAddr, tcpPorts.get(i), callback, console, nullptr);
+            }
+         });
       ConsoleDebugPrintf(console, DEBUG_TAG_DISCOVERY, 4, _T("Finished active discovery check on range %s"), rangeText);
    }
 }
 
+/**
+ * Check given address range for new nodes
+ */
+void CheckRange(const InetAddressListElement& range, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context)
+{
+   ScanRange(range, callback, console, context, nullptr, 1);
+}
+
 /**
  * Active discovery thread wakeup condition
  */
 static Condition s_activeDiscoveryWakeup(false);
 
+/**
+ * Active discovery range states
+ */
+enum class ActiveDiscoveryRangeState
+{
+   PENDING = 0,
+   PROCESSING = 1,
+   COMPLETED = 2
+};
+
 /**
  * Active discovery state
  */
 static bool s_activeDiscoveryActive = false;
 static ObjectArray<InetAddressListElement> *s_activeDiscoveryRanges = nullptr;
-static int s_activeDiscoveryCurrentRange = 0;
+static ActiveDiscoveryRangeState *s_activeDiscoveryRangeStates = nullptr;
 static Mutex s_activeDiscoveryStateLock(MutexType::FAST);
 
+/**
+ * Comparator for active discovery ranges (by zone and then by base address)
+ */
+static int CompareActiveDiscoveryRanges(const InetAddressListElement **r1, const InetAddressListElement **r2)
+{
+   if ((*r1)->getZoneUIN() != (*r2)->getZoneUIN())
+      return ((*r1)->getZoneUIN() < (*r2)->getZoneUIN()) ? -1 : 1;
+   return (*r1)->getBaseAddress().compareTo((*r2)->getBaseAddress());
+}
+
+/**
+ * Calculate fingerprint of active discovery range list (used to validate saved progress)
+ */
+static uint32_t CalculateRangeListFingerprint(const ObjectArray<InetAddressListElement>& ranges)
+{
+   uint32_t crc = 0;
+   for(int i = 0; i < ranges.size(); i++)
+   {
+      const InetAddressListElement *range = ranges.get(i);
+      TCHAR text[256];
+      _sntprintf(text, 256, _T("%s/%d/%u"), range->toString().cstr(), range->getZoneUIN(), range->getProxyId());
+      crc = CalculateCRC32(reinterpret_cast<const BYTE*>(text), _tcslen(text) * sizeof(TCHAR), crc);
+   }
+   return crc;
+}
+
+/**
+ * Save active discovery progress (index of first range not completed yet). Must be called with state lock held.
+ */
+static void SaveActiveDiscoveryProgress(uint32_t fingerprint)
+{
+   int watermark = 0;
+   while((watermark < s_activeDiscoveryRanges->size()) && (s_activeDiscoveryRangeStates[watermark] == ActiveDiscoveryRangeState::COMPLETED))
+      watermark++;
+
+   TCHAR value[32];
+   _sntprintf(value, 32, _T("%08X:%d"), fingerprint, watermark);
+   MetaDataWriteStr(_T("ActiveDiscoveryProgress"), value);
+}
+
+/**
+ * Load saved active discovery progress. Returns index of first range to be scanned.
+ */
+static int LoadActiveDiscoveryProgress(uint32_t fingerprint, int rangeCount)
+{
+   TCHAR value[32];
+   MetaDataReadStr(_T("ActiveDiscoveryProgress"), value, 32, _T(""));
+   TCHAR *eptr;
+   uint32_t savedFingerprint = _tcstoul(value, &eptr, 16);
+   if ((*eptr != _T(':')) || (savedFingerprint != fingerprint))
+      return 0;
+   int watermark = _tcstol(eptr + 1, nullptr, 10);
+   return ((watermark > 0) && (watermark < rangeCount)) ? watermark : 0;
+}
+
 /**
  * Active discovery poller thread
  */
@@ -1342,6 +1641,10 @@ void ActiveDiscoveryPoller()
 
    nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 2, _T("Active discovery thread started"));
 
+   int maxParallelRanges = std::max(ConfigReadInt(_T("NetworkDiscovery.ActiveDiscovery.MaxParallelRanges"), 4), 1);
+   int maxParallelBlocks = std::max(ConfigReadInt(_T("NetworkDiscovery.ActiveDiscovery.MaxParallelBlocks"), 2), 1);
+   ThreadPool *pool = (maxParallelRanges * maxParallelBlocks > 1) ? ThreadPoolCreate(_T("ACTDISCOVERY"), 1, maxParallelRanges * maxParallelBlocks) : nullptr;
+
    time_t lastRun = 0;
    uint32_t sleepTime = 60000;
 
@@ -1402,14 +1705,43 @@ void ActiveDiscoveryPoller()
       {
          if (!s_activeDiscoveryRanges->isEmpty())
          {
+            s_activeDiscoveryRanges->sort(CompareActiveDiscoveryRanges);
+            int rangeCount = s_activeDiscoveryRanges->size();
+            uint32_t fingerprint = CalculateRangeListFingerprint(*s_activeDiscoveryRanges);
+            int startIndex = LoadActiveDiscoveryProgress(fingerprint, rangeCount);
+            s_activeDiscoveryRangeStates = MemAllocArrayNoInit<ActiveDiscoveryRangeState>(rangeCount);
+            for(int i = 0; i < rangeCount; i++)
+               s_activeDiscoveryRangeStates[i] = (i < startIndex) ? ActiveDiscoveryRangeState::COMPLETED : ActiveDiscoveryRangeState::PENDING;
             s_activeDiscoveryActive = true;
             s_activeDiscoveryStateLock.unlock();
-            for(s_activeDiscoveryCurrentRange = 0; (s_activeDiscoveryCurrentRange < s_activeDiscoveryRanges->size()) && !IsShutdownInProgress(); s_activeDiscoveryCurrentRange++)
-            {
-               CheckRange(*s_activeDiscoveryRanges->get(s_activeDiscoveryCurrentRange), RangeScanCallback, nullptr, nullptr);
-            }
+
+            if (startIndex > 0)
+               nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 4, _T("Resuming interrupted active discovery cycle from range %d of %d"), startIndex + 1, rangeCount);
+
+            RunParallelScan(pool, rangeCount - startIndex, maxParallelRanges,
+               [startIndex, fingerprint, pool, maxParallelBlocks] (int index) -> void
+               {
+                  index += startIndex;
+                  s_activeDiscoveryStateLock.lock();
+                  s_activeDiscoveryRangeStates[index] = ActiveDiscoveryRangeState::PROCESSING;
+                  s_activeDiscoveryStateLock.unlock();
+
+                  ScanRange(*s_activeDiscoveryRanges->get(index), RangeScanCallback, nullptr, nullptr, pool, maxParallelBlocks);
+                  if (IsShutdownInProgress())
+                     return;  // Range may be incomplete, do not mark it as completed
+
+                  s_activeDiscoveryStateLock.lock();
+                  s_activeDiscoveryRangeStates[index] = ActiveDiscoveryRangeState::COMPLETED;
+                  SaveActiveDiscoveryProgress(fingerprint);
+                  s_activeDiscoveryStateLock.unlock();
+               });
+
+            if (!IsShutdownInProgress())
+               MetaDataWriteStr(_T("ActiveDiscoveryProgress"), _T(""));
+
             s_activeDiscoveryStateLock.lock();
             s_activeDiscoveryActive = false;
+            MemFreeAndNull(s_activeDiscoveryRangeStates);
          }
          delete_and_null(s_activeDiscoveryRanges);
       }
@@ -1419,6 +1751,9 @@ void ActiveDiscoveryPoller()
       sleepTime = (interval > 0) ? interval * 1000 : 60000;
    }
 
+   if (pool != nullptr)
+      ThreadPoolDestroy(pool);
+
    nxlog_debug_tag(DEBUG_TAG_DISCOVERY, 2, _T("Active discovery thread terminated"));
 }
 
@@ -1435,8 +1770,9 @@ void ShowActiveDiscoveryState(ServerConsole *console)
       for(int i = 0; i < s_activeDiscoveryRanges->size(); i++)
       {
          InetAddressListElement *range = s_activeDiscoveryRanges->get(i);
+         ActiveDiscoveryRangeState state = s_activeDiscoveryRangeStates[i];
          console->printf(_T("   %-36s %s\n"), range->toString().cstr(),
-            (i < s_activeDiscoveryCurrentRange) ? _T("\x1b[32mcompleted\x1b[0m") : ((i == s_activeDiscoveryCurrentRange) ? _T("\x1b[33mprocessing\x1b[0m") : _T("\x1b[36mpending\x1b[0m")));
+            (state == ActiveDiscoveryRangeState::COMPLETED) ? _T("\x1b[32mcompleted\x1b[0m") : ((state == ActiveDiscoveryRangeState::PROCESSING) ? _T("\x1b[33mprocessing\x1b[0m") : _T("\x1b[36mpending\x1b[0m")));
       }
    }
    else
@@ -1446,6 +1782,27 @@ void ShowActiveDiscoveryState(ServerConsole *console)
    s_activeDiscoveryStateLock.unlock();
 }
 
+/**
+ * Show discovery pipeline statistics on server console
+ */
+void ShowDiscoveryStats(ServerConsole *console)
+{
+   console->print(_T("Discovery pipeline statistics (average time in milliseconds, rate in addresses per second of stage processing time):\n"));
+   for(int i = 0; i < 5; i++)
+   {
+      int64_t processed = s_stageStats[i].processed;
+      int64_t elapsedTime = s_stageStats[i].elapsedTime;
+      console->printf(_T("   %-5s processed=") INT64_FMT _T(" succeeded=") INT64_FMT _T(" avgTime=") INT64_FMT _T(" rate=") INT64_FMT _T("\n"),
+               s_discoveryStageNames[i], processed, static_cast<int64_t>(s_stageStats[i].succeeded),
+               (processed > 0) ? elapsedTime / processed : 0, (elapsedTime > 0) ? processed * 1000 / elapsedTime : processed);
+   }
+
+   s_inFlightAddressesLock.lock();
+   int inFlight = s_inFlightAddresses.size();
+   s_inFlightAddressesLock.unlock();
+   console->printf(_T("Addresses queued or being processed: %d\n"), inFlight);
+}
+
 /**
  * Check if active discovery is currently running
  */
@@ -1455,14 +1812,25 @@ bool IsActiveDiscoveryRunning()
 }
 
 /**
- * Get textual description of active discovery range currently being processed (empty string if none)
+ * Get textual description of active discovery ranges currently being processed (empty string if none)
  */
 String GetCurrentActiveDiscoveryRange()
 {
+   StringBuffer ranges;
    s_activeDiscoveryStateLock.lock();
-   String range = s_activeDiscoveryActive ? s_activeDiscoveryRanges->get(s_activeDiscoveryCurrentRange)->toString() : String();
+   if (s_activeDiscoveryActive)
+   {
+      for(int i = 0; i < s_activeDiscoveryRanges->size(); i++)
+      {
+         if (s_activeDiscoveryRangeStates[i] != ActiveDiscoveryRangeState::PROCESSING)
+            continue;
+         if (!ranges.isEmpty())
+            ranges.append(_T(", "));
+         ranges.append(s_activeDiscoveryRanges->get(i)->toString());
+      }
+   }
    s_activeDiscoveryStateLock.unlock();
-   return range;
+   return ranges;
 }
 
 /**
@@ -1477,9 +1845,9 @@ static void ClearDiscoveryPollerQueue()
          delete addressInfo;
    }
 
-   s_processingListLock.lock();
-   s_processingList.clear();
-   s_processingListLock.unlock();
+   s_inFlightAddressesLock.lock();
+   s_inFlightAddresses.clear();
+   s_inFlightAddressesLock.unlock();
 }
 
 /**
@@ -41,7 +41,6 @@ VolatileCounter64 g_totalEventsProcessed = 0;
  * Static data
  */
 static THREAD s_threadStormDetector = INVALID_THREAD_HANDLE;
-static THREAD s_threadLogger = INVALID_THREAD_HANDLE;
 static ObjectQueue<Event> s_loggerQueue(4096, Ownership::True);
 
 /**
@@ -94,6 +93,7 @@ static void EventStormDetector()
  */
 static time_t s_dbQueryFailedTimestamps[MAX_DB_QUERY_FAILED_EVENTS];
 static int s_dbQueryFailedTimestampPos = 0;
+static Mutex s_dbQueryFailedTimestampsLock(MutexType::FAST);
 
 /**
  * Check that event can be written to database
@@ -106,6 +106,7 @@ static bool IsEventWriteAllowed(Event *event)
    {
       time_t now = time(nullptr);
       bool allow = false;
+      s_dbQueryFailedTimestampsLock.lock();
       for(int i = 0; i < MAX_DB_QUERY_FAILED_EVENTS; i++)
       {
          if (s_dbQueryFailedTimestamps[i] < now - 60)
@@ -117,6 +118,7 @@ static bool IsEventWriteAllowed(Event *event)
       s_dbQueryFailedTimestamps[s_dbQueryFailedTimestampPos++] = event->getTimestamp();
       if (s_dbQueryFailedTimestampPos == MAX_DB_QUERY_FAILED_EVENTS)
          s_dbQueryFailedTimestampPos = 0;
+      s_dbQueryFailedTimestampsLock.unlock();
       if (!allow)
          nxlog_debug_tag(DEBUG_TAG, 5, _T("EventLogger: event %s with ID ") UINT64_FMT _T(" dropped by rate limiter"), event->getName(), event->getId());
       return allow;
@@ -125,9 +127,44 @@ static bool IsEventWriteAllowed(Event *event)
 }
 
 /**
- * Write event
+ * Event log writer. Each writer takes events from shared logger queue and acquires database connection
+ * from connection pool for every batch.
  */
-static inline void WriteEvent(DB_STATEMENT hStmt, Event *event)
+struct EventLogWriter
+{
+   THREAD thread;
+   int id;
+   ObjectArray<Event> batch;  // Events currently being written (should be accessed under lock)
+   Mutex lock;
+
+   EventLogWriter(int _id) : batch(256, 256, Ownership::True), lock(MutexType::FAST)
+   {
+      thread = INVALID_THREAD_HANDLE;
+      id = _id;
+   }
+};
+
+/**
+ * Event log writers
+ */
+static ObjectArray<EventLogWriter> s_logWriters(4, 4, Ownership::True);
+
+/**
+ * Event log writer statistics
+ */
+static uint64_t s_logWriterEvents = 0;
+static uint64_t s_logWriterFailedEvents = 0;
+static uint64_t s_logWriterBatches = 0;
+static int64_t s_logWriterAverageBatchSize = 0;
+static int64_t s_logWriterAverageWriteTime = 0;
+static uint32_t s_logWriterMaxBatchSize = 0;
+static uint32_t s_logWriterMaxWriteTime = 0;
+static Mutex s_logWriterStatsLock(MutexType::FAST);
+
+/**
+ * Bind event to prepared INSERT statement
+ */
+static inline void BindEvent(DB_STATEMENT hStmt, Event *event)
 {
    DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, event->getId());
    DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, event->getCode());
@@ -142,106 +179,197 @@ static inline void WriteEvent(DB_STATEMENT hStmt, Event *event)
    DBBind(hStmt, 11, DB_SQLTYPE_BIGINT, event->getRootId());
    DBBind(hStmt, 12, DB_SQLTYPE_VARCHAR, event->getTagsAsList(), DB_BIND_TRANSIENT, 2000);
    DBBind(hStmt, 13, DB_SQLTYPE_TEXT, event->toJson(), DB_BIND_DYNAMIC);
-   DBExecute(hStmt);
-   nxlog_debug_tag(DEBUG_TAG, 8, _T("EventLogger: DBExecute: id=%d,code=%d"), (int)event->getId(), (int)event->getCode());
 }
 
 /**
- * Event logger
+ * Get query for inserting event into event log
  */
-static void EventLogger()
+static inline const TCHAR *GetEventInsertQuery()
 {
-   ThreadSetName("EventLogger");
+   return (g_dbSyntax == DB_SYNTAX_TSDB) ?
+         _T("INSERT INTO event_log (event_id,event_code,event_timestamp,origin,")
+         _T("origin_timestamp,event_source,zone_uin,dci_id,event_severity,event_message,root_event_id,event_tags,raw_data) ")
+         _T("VALUES (?,?,to_timestamp(?),?,?,?,?,?,?,?,?,?,?)") :
+         _T("INSERT INTO event_log (event_id,event_code,event_timestamp,origin,")
+         _T("origin_timestamp,event_source,zone_uin,dci_id,event_severity,event_message,root_event_id,event_tags,raw_data) ")
+         _T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?)");
+}
 
-   while(true)
+/**
+ * Write batch of events to event log in single transaction. If transaction fails, events are written
+ * one by one so only events that cannot be written are lost. Returns number of events written.
+ */
+static int WriteEventBatch(DB_HANDLE hdb, const ObjectArray<Event>& batch)
+{
+   bool success = false;
+   if (DBBegin(hdb))
+   {
+      DB_STATEMENT hStmt = DBPrepare(hdb, GetEventInsertQuery(), batch.size() > 1);
+      if (hStmt != nullptr)
+      {
+         if ((batch.size() > 1) && DBOpenBatch(hStmt))
+         {
+            for(int i = 0; i < batch.size(); i++)
+            {
+               DBNextBatchRow(hStmt);
+               BindEvent(hStmt, batch.get(i));
+            }
+            success = DBExecute(hStmt);
+         }
+         else
+         {
+            success = true;
+            for(int i = 0; (i < batch.size()) && success; i++)
+            {
+               BindEvent(hStmt, batch.get(i));
+               success = DBExecute(hStmt);
+            }
+         }
+         DBFreeStatement(hStmt);
+      }
+
+      if (success)
+         DBCommit(hdb);
+      else
+         DBRollback(hdb);
+   }
+   if (success)
+      return batch.size();
+   if (batch.size() == 1)
+      return 0;
+
+   int written = 0;
+   DB_STATEMENT hStmt = DBPrepare(hdb, GetEventInsertQuery());
+   if (hStmt != nullptr)
+   {
+      for(int i = 0; i < batch.size(); i++)
+      {
+         BindEvent(hStmt, batch.get(i));
+         if (DBExecute(hStmt))
+            written++;
+      }
+      DBFreeStatement(hStmt);
+   }
+   return written;
+}
+
+/**
+ * Update event log writer statistics
+ */
+static void UpdateEventLogWriterStats(int batchSize, int written, uint32_t writeTime)
+{
+   s_logWriterStatsLock.lock();
+   s_logWriterEvents += written;
+   s_logWriterFailedEvents += batchSize - written;
+   s_logWriterBatches++;
+   UpdateExpMovingAverage(s_logWriterAverageBatchSize, EMA_EXP_60, static_cast<int64_t>(batchSize));
+   UpdateExpMovingAverage(s_logWriterAverageWriteTime, EMA_EXP_60, static_cast<int64_t>(writeTime));
+   if (static_cast<uint32_t>(batchSize) > s_logWriterMaxBatchSize)
+      s_logWriterMaxBatchSize = batchSize;
+   if (writeTime > s_logWriterMaxWriteTime)
+      s_logWriterMaxWriteTime = writeTime;
+   s_logWriterStatsLock.unlock();
+}
+
+/**
+ * Event logger. Events are taken from queue in batches and written in single transaction.
+ */
+static void EventLogger(EventLogWriter *writer)
+{
+   char threadName[16];
+   snprintf(threadName, 16, "EventLogger/%d", writer->id);
+   ThreadSetName(threadName);
+
+   int maxBatchSize = ConfigReadInt(_T("DBWriter.MaxRecordsPerTransaction"), 1000);
+   bool stop = false;
+   while(!stop)
    {
       Event *event = s_loggerQueue.getOrBlock();
       if (event == INVALID_POINTER_VALUE)
          break;   // Shutdown indicator
 
-      if (!IsEventWriteAllowed(event))
+      writer->lock.lock();
+      while(true)
       {
-         delete event;
-         continue;
+         if (IsEventWriteAllowed(event))
+            writer->batch.add(event);
+         else
+            delete event;
+
+         if (writer->batch.size() >= maxBatchSize)
+            break;
+
+         event = s_loggerQueue.get();
+         if (event == nullptr)
+            break;
+         if (event == INVALID_POINTER_VALUE)
+         {
+            stop = true;
+            break;
+         }
       }
+      writer->lock.unlock();
 
-		DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
-		int syntaxId = DBGetSyntax(hdb);
-		if (syntaxId == DB_SYNTAX_SQLITE)
-		{ 
-         StringBuffer query = _T("INSERT INTO event_log (event_id,event_code,event_timestamp,event_source,zone_uin,origin,")
-                        _T("origin_timestamp,dci_id,event_severity,event_message,root_event_id,event_tags,raw_data) VALUES (");
-         query.append(event->getId());
-         query.append(_T(','));
-         query.append(event->getCode());
-         query.append(_T(','));
-         query.append((UINT32)event->getTimestamp());
-         query.append(_T(','));
-         query.append(event->getSourceId());
-         query.append(_T(','));
-         query.append(event->getZoneUIN());
-         query.append(_T(','));
-         query.append(static_cast<int32_t>(event->getOrigin()));
-         query.append(_T(','));
-         query.append(static_cast<uint32_t>(event->getOriginTimestamp()));
-         query.append(_T(','));
-         query.append(event->getDciId());
-         query.append(_T(','));
-         query.append(event->getSeverity());
-         query.append(_T(','));
-         query.append(DBPrepareString(hdb, event->getMessage(), MAX_EVENT_MSG_LENGTH));
-         query.append(_T(','));
-         query.append(event->getRootId());
-         query.append(_T(','));
-         query.append(DBPrepareString(hdb, event->getTagsAsList(), 2000));
-         query.append(_T(','));
-         json_t *json = event->toJson();
-         char *jsonText = json_dumps(json, JSON_INDENT(3) | JSON_EMBED);
-         query.append(DBPrepareStringUTF8(hdb, jsonText));
-         MemFree(jsonText);
-         json_decref(json);
-         query.append(_T(')'));
-
-         DBQuery(hdb, query);
-         nxlog_debug_tag(DEBUG_TAG, 8, _T("EventLogger: DBQuery: id=%d,code=%d"), (int)event->getId(), (int)event->getCode());
-			delete event;
-		}
-		else
-		{
-			DB_STATEMENT hStmt = DBPrepare(hdb,
-			         (g_dbSyntax == DB_SYNTAX_TSDB) ?
-                        _T("INSERT INTO event_log (event_id,event_code,event_timestamp,origin,")
-                        _T("origin_timestamp,event_source,zone_uin,dci_id,event_severity,event_message,root_event_id,event_tags,raw_data) ")
-                        _T("VALUES (?,?,to_timestamp(?),?,?,?,?,?,?,?,?,?,?)") :
-                        _T("INSERT INTO event_log (event_id,event_code,event_timestamp,origin,")
-                        _T("origin_timestamp,event_source,zone_uin,dci_id,event_severity,event_message,root_event_id,event_tags,raw_data) ")
-                        _T("VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?)"), true);
-			if (hStmt != nullptr)
-			{
-			   WriteEvent(hStmt, event);
-			   delete event;
-            event = s_loggerQueue.getOrBlock(500);
-			   while((event != nullptr) && (event != INVALID_POINTER_VALUE))
-				{
-				   if (IsEventWriteAllowed(event))
-				   {
-		            WriteEvent(hStmt, event);
-				   }
-					delete event;
-					event = s_loggerQueue.getOrBlock(500);
-				}
-				DBFreeStatement(hStmt);
-			}
-			else
-			{
-				delete event;
-			}
-		}
+      if (writer->batch.isEmpty())
+         continue;
 
-		DBConnectionPoolReleaseConnection(hdb);
-		if (event == INVALID_POINTER_VALUE)
-         break;   // Shutdown indicator (need second check if got it in inner loop)
-	}
+      int64_t startTime = GetCurrentTimeMs();
+      DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
+      int written = WriteEventBatch(hdb, writer->batch);
+      DBConnectionPoolReleaseConnection(hdb);
+      uint32_t writeTime = static_cast<uint32_t>(GetCurrentTimeMs() - startTime);
+
+      if (written == writer->batch.size())
+         nxlog_debug_tag(DEBUG_TAG, 8, _T("EventLogger/%d: %d events written in %u ms"), writer->id, written, writeTime);
+      else
+         nxlog_debug_tag(DEBUG_TAG, 4, _T("EventLogger/%d: failed to write %d of %d events"), writer->id, writer->batch.size() - written, writer->batch.size());
+      UpdateEventLogWriterStats(writer->batch.size(), written, writeTime);
+
+      writer->lock.lock();
+      writer->batch.clear();
+      writer->lock.unlock();
+   }
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("Event log writer #%d stopped"), writer->id);
+}
+
+/**
+ * Start event log writers
+ */
+static void StartEventLogWriters()
+{
+   int count = ConfigReadInt(_T("Events.LogWriter.Threads"), 1);
+   if ((count > 1) && (g_dbSyntax == DB_SYNTAX_SQLITE))
+   {
+      nxlog_debug_tag(DEBUG_TAG, 1, _T("Only one event log writer can be used with SQLite database"));
+      count = 1;
+   }
+   else if (count < 1)
+   {
+      count = 1;
+   }
+   else if (count > 64)
+   {
+      count = 64;
+   }
+
+   for(int i = 0; i < count; i++)
+   {
+      auto writer = new EventLogWriter(i + 1);
+      s_logWriters.add(writer);
+      writer->thread = ThreadCreateEx(EventLogger, writer);
+   }
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("%d event log writer(s) started"), count);
+}
+
+/**
+ * Stop event log writers. All queued events will be written before writers exit.
+ */
+static void StopEventLogWriters()
+{
+   for(int i = 0; i < s_logWriters.size(); i++)
+      s_loggerQueue.put(INVALID_POINTER_VALUE);
+   for(int i = 0; i < s_logWriters.size(); i++)
+      ThreadJoin(s_logWriters.get(i)->thread);
 }
 
 /**
@@ -346,9 +474,8 @@ static void SerialEventProcessor()
       ProcessEvent(event, 0);
    }
 
-   s_loggerQueue.put(INVALID_POINTER_VALUE);
+   StopEventLogWriters();
    ThreadJoin(s_threadStormDetector);
-   ThreadJoin(s_threadLogger);
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Event processing thread stopped"));
 }
 
@@ -579,9 +706,8 @@ static void ParallelEventProcessor()
    HASH_CLEAR(hh, queueBindings);
    MemFreeLocal(weights);
 
-	s_loggerQueue.put(INVALID_POINTER_VALUE);
+   StopEventLogWriters();
 	ThreadJoin(s_threadStormDetector);
-	ThreadJoin(s_threadLogger);
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Event processing thread stopped"));
 }
 
@@ -591,7 +717,7 @@ static void ParallelEventProcessor()
 THREAD StartEventProcessor()
 {
    memset(s_dbQueryFailedTimestamps, 0, sizeof(s_dbQueryFailedTimestamps));
-   s_threadLogger = ThreadCreateEx(EventLogger);
+   StartEventLogWriters();
    s_threadStormDetector = ThreadCreateEx(EventStormDetector);
    ThreadPoolScheduleRelative(g_mainThreadPool, 600000, ResetScriptErrorEventCounter);
    return (ConfigReadInt(_T("Events.Processor.PoolSize"), 1) > 1) ? ThreadCreateEx(ParallelEventProcessor) : ThreadCreateEx(SerialEventProcessor);
@@ -649,13 +775,61 @@ static Event *CopyEvent(Event *event)
  */
 Event *FindEventInLoggerQueue(uint64_t eventId)
 {
-   return s_loggerQueue.find(&eventId, CompareEvent, CopyEvent);
+   Event *event = s_loggerQueue.find(&eventId, CompareEvent, CopyEvent);
+   if (event != nullptr)
+      return event;
+
+   // Check events currently being written
+   for(int i = 0; (i < s_logWriters.size()) && (event == nullptr); i++)
+   {
+      EventLogWriter *writer = s_logWriters.get(i);
+      writer->lock.lock();
+      for(int j = 0; j < writer->batch.size(); j++)
+      {
+         Event *e = writer->batch.get(j);
+         if (e->getId() == eventId)
+         {
+            event = new Event(e);
+            break;
+         }
+      }
+      writer->lock.unlock();
+   }
+   return event;
 }
 
 /**
- * Get size of event log writer queue
+ * Get size of event log writer queue (including events currently being written)
  */
 int64_t GetEventLogWriterQueueSize()
 {
-   return s_loggerQueue.size();
+   int64_t size = s_loggerQueue.size();
+   for(int i = 0; i < s_logWriters.size(); i++)
+   {
+      EventLogWriter *writer = s_logWriters.get(i);
+      writer->lock.lock();
+      size += writer->batch.size();
+      writer->lock.unlock();
+   }
+   return size;
+}
+
+/**
+ * Get event log writer statistics
+ */
+EventLogWriterStats GetEventLogWriterStats()
+{
+   EventLogWriterStats stats;
+   s_logWriterStatsLock.lock();
+   stats.writtenEvents = s_logWriterEvents;
+   stats.failedEvents = s_logWriterFailedEvents;
+   stats.batches = s_logWriterBatches;
+   stats.averageBatchSize = static_cast<uint32_t>(s_logWriterAverageBatchSize / EMA_FP_1);
+   stats.maxBatchSize = s_logWriterMaxBatchSize;
+   stats.averageWriteTime = static_cast<uint32_t>(s_logWriterAverageWriteTime / EMA_FP_1);
+   stats.maxWriteTime = s_logWriterMaxWriteTime;
+   s_logWriterStatsLock.unlock();
+   stats.queueSize = static_cast<uint32_t>(GetEventLogWriterQueueSize());
+   stats.threads = s_logWriters.size();
+   return stats;
 }
@@ -24,6 +24,16 @@
 
 #define DEBUG_TAG _T("housekeeper")
 
+/**
+ * Lock IDATA writes
+ */
+void LockIDataWrites();
+
+/**
+ * Unlock IDATA writes
+ */
+void UnlockIDataWrites();
+
 /**
  * Housekeeper wakeup condition
  */
@@ -50,7 +60,7 @@ static size_t s_throttlingLowWatermark = 50000;
  */
 bool ThrottleHousekeeper()
 {
-   size_t qsize = g_dbWriterQueue.size() + static_cast<size_t>(GetIDataWriterQueueSize() + GetRawDataWriterQueueSize());
+   size_t qsize = g_dbWriterQueue.size() + static_cast<size_t>(GetIDataWriterQueueSize() + GetTDataWriterQueueSize() + GetRawDataWriterQueueSize());
    if (qsize < s_throttlingHighWatermark)
       return true;
 
@@ -58,7 +68,7 @@ bool ThrottleHousekeeper()
    while((qsize >= s_throttlingLowWatermark) && !s_shutdown)
    {
       s_wakeupCondition.wait(30000);
-      qsize = g_dbWriterQueue.size() + static_cast<size_t>(GetIDataWriterQueueSize() + GetRawDataWriterQueueSize());
+      qsize = g_dbWriterQueue.size() + static_cast<size_t>(GetIDataWriterQueueSize() + GetTDataWriterQueueSize() + GetRawDataWriterQueueSize());
    }
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Housekeeper resumed (queue size %d)"), qsize);
    return !s_shutdown;
@@ -227,6 +237,33 @@ static void CleanTimescaleData(DB_HANDLE hdb)
    }
 }
 
+/**
+ * Drop partitions of idata and tdata tables that contain only records older than retention time of any DCI
+ */
+static void DropExpiredDataPartitions(DB_HANDLE hdb, const SharedObjectArray<NetObj>& objects)
+{
+   bool idataPartitioned = IsPartitionedTable(_T("idata"));
+   bool tdataPartitioned = IsPartitionedTable(_T("tdata"));
+   if (!idataPartitioned && !tdataPartitioned)
+      return;
+
+   int itemRetentionTime = DCObject::m_defaultRetentionTime;
+   int tableRetentionTime = DCObject::m_defaultRetentionTime;
+   for(int i = 0; i < objects.size(); i++)
+      static_cast<DataCollectionTarget*>(objects.get(i))->calculateMaxDciRetentionTime(&itemRetentionTime, &tableRetentionTime);
+
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("Dropping expired data partitions (max retention time: items %d days, tables %d days)"), itemRetentionTime, tableRetentionTime);
+   time_t now = time(nullptr);
+   if (idataPartitioned)
+   {
+      LockIDataWrites();
+      DropExpiredPartitions(hdb, _T("idata"), now - itemRetentionTime * 86400);
+      UnlockIDataWrites();
+   }
+   if (tdataPartitioned)
+      DropExpiredPartitions(hdb, _T("tdata"), now - tableRetentionTime * 86400);
+}
+
 /**
  * Construct query with drop_chunks() function
  */
@@ -250,6 +287,13 @@ static bool DeleteExpiredLogRecords(const TCHAR *logName, const TCHAR *logTable,
    nxlog_debug_tag(DEBUG_TAG, 2, _T("Clearing %s (retention time %d days)"), logName, retentionTime);
    retentionTime *= 86400; // Convert days to seconds
    TCHAR query[256];
+   if (IsPartitionedTable(logTable))
+   {
+      // Drop whole expired partitions first, DELETE will then only touch records in partially expired partition
+      DropExpiredPartitions(hdb, logTable, cycleStartTime - retentionTime);
+      if (!ThrottleHousekeeper())
+         return false;
+   }
    if (g_dbSyntax == DB_SYNTAX_TSDB)
       BuildDropChunksQuery(logTable, cycleStartTime - retentionTime, query, sizeof(query) / sizeof(TCHAR));
    else
@@ -322,6 +366,7 @@ static void HouseKeeper()
       nxlog_debug_tag(DEBUG_TAG, 5, _T("Throttling high watermark = %d, low watermark= %d"), s_throttlingHighWatermark, s_throttlingLowWatermark);
 
 		DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
+      MaintainTablePartitions(hdb);
 		CleanAlarmHistory(hdb);
 
 		// Remove expired log records
@@ -409,6 +454,9 @@ static void HouseKeeper()
             g_idxNodeById.getObjects(&objects);
             g_idxSensorById.getObjects(&objects);
 
+            if (g_flags & AF_SINGLE_TABLE_PERF_DATA)
+               DropExpiredDataPartitions(hdb, objects);
+
             for(int i = 0; (i < objects.size()) && !s_shutdown; i++)
             {
                static_cast<DataCollectionTarget*>(objects.get(i))->cleanDCIData(hdb);
@@ -108,10 +108,49 @@ void ScanAddressRangeICMP(const InetAddress& from, const InetAddress& to, void (
    IcmpCloseHandle(hIcmpFile);
 }
 
+/**
+ * Scan list of IPv4 addresses. Returns false if scan cannot be started.
+ */
+bool ScanAddressListICMP(const IntegerArray<uint32_t>& addrList, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context)
+{
+   static char payload[64] = "NetXMS ICMP probe [list scan]";
+
+   HANDLE hIcmpFile = IcmpCreateFile();
+   if (hIcmpFile == INVALID_HANDLE_VALUE)
+      return false;
+
+   volatile int pendingRequests = 0;
+   for(int i = 0; i < addrList.size(); i++)
+   {
+      uint32_t a = addrList.get(i);
+      EchoRequest *rq = new EchoRequest(a, callback, console, context, &pendingRequests);
+      DWORD rc = IcmpSendEcho2(hIcmpFile, nullptr, (FARPROC)EchoCallback, rq, htonl(a), payload, 64, nullptr, rq->replyBuffer, rq->replyBufferSize, g_icmpPingTimeout);
+      if ((rc == 0) && (GetLastError() == ERROR_IO_PENDING))
+      {
+         pendingRequests++;
+      }
+      else
+      {
+         delete rq;
+      }
+   }
+
+   while(pendingRequests > 0)
+      SleepEx(1000, TRUE);
+
+   IcmpCloseHandle(hIcmpFile);
+   return true;
+}
+
 #else /* _WIN32 */
 
 #include <nxnet.h>
 
+/**
+ * Number of echo requests sent before waiting for responses
+ */
+#define SCAN_WINDOW_SIZE   32
+
 /**
  * ICMP echo request structure
  */
@@ -196,11 +235,16 @@ void ScanAddressRangeICMP(const InetAddress& from, const InetAddress& to, void (
       status[i].success = false;
       sendto(sock, (char *)&request, sizeof(ECHOREQUEST), 0, (struct sockaddr *)&saDest, sizeof(struct sockaddr_in));
 
-      sp.reset();
-      sp.add(sock);
-      if (sp.poll(10) > 0)
+      // Wait for responses only after each full window, otherwise just read what is already available
+      bool windowEnd = ((i + 1) % SCAN_WINDOW_SIZE == 0);
+      while(true)
       {
+         sp.reset();
+         sp.add(sock);
+         if (sp.poll(windowEnd ? 10 : 0) <= 0)
+            break;
          ProcessResponse(sock, baseAddr, to.getAddressV4(), status);
+         windowEnd = false;
       }
    }
 
@@ -227,4 +271,125 @@ void ScanAddressRangeICMP(const InetAddress& from, const InetAddress& to, void (
    MemFree(status);
 }
 
+/**
+ * Address list element for list scan
+ */
+struct ScanListElement
+{
+   uint32_t addr;
+   ScanStatus status;
+};
+
+/**
+ * Compare address list elements
+ */
+static int CompareScanListElements(const void *e1, const void *e2)
+{
+   uint32_t a1 = static_cast<const ScanListElement*>(e1)->addr;
+   uint32_t a2 = static_cast<const ScanListElement*>(e2)->addr;
+   return (a1 < a2) ? -1 : ((a1 > a2) ? 1 : 0);
+}
+
+/**
+ * Process ICMP response for list scan
+ */
+static void ProcessListResponse(SOCKET sock, ScanListElement *elements, int count)
+{
+   ECHOREPLY reply;
+   struct sockaddr_in saSrc;
+   socklen_t addrLen = sizeof(struct sockaddr_in);
+   if (recvfrom(sock, reinterpret_cast<char*>(&reply), sizeof(ECHOREPLY), 0, reinterpret_cast<struct sockaddr*>(&saSrc), &addrLen) > 0)
+   {
+      if (reply.m_icmpHdr.m_cType != 0)
+         return;
+
+      ScanListElement key;
+      key.addr = ntohl(reply.m_ipHdr.m_iaSrc.s_addr);
+      auto e = static_cast<ScanListElement*>(bsearch(&key, elements, count, sizeof(ScanListElement), CompareScanListElements));
+      if ((e != nullptr) && !e->status.success)
+      {
+         e->status.success = true;
+         e->status.rtt = static_cast<uint32_t>(GetCurrentTimeMs() - e->status.startTime);
+      }
+   }
+}
+
+/**
+ * Scan list of IPv4 addresses. Returns false if scan cannot be started.
+ */
+bool ScanAddressListICMP(const IntegerArray<uint32_t>& addrList, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context)
+{
+   if (addrList.isEmpty())
+      return true;
+
+   SOCKET sock = CreateSocket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+   if (sock == INVALID_SOCKET)
+      return false;
+
+   ECHOREQUEST request;
+   memset(&request, 0, sizeof(ECHOREQUEST));
+   request.m_icmpHdr.m_cType = 8;   // ICMP ECHO REQUEST
+   request.m_icmpHdr.m_cCode = 0;
+   request.m_icmpHdr.m_wId = (WORD)GetCurrentThreadId();
+   request.m_icmpHdr.m_wSeq = 0;
+
+   struct sockaddr_in saDest;
+   memset(&saDest, 0, sizeof(sockaddr_in));
+   saDest.sin_family = AF_INET;
+   saDest.sin_port = 0;
+
+   // Sorted copy of address list for fast lookup of responding address
+   int count = addrList.size();
+   ScanListElement *elements = MemAllocArray<ScanListElement>(count);
+   for(int i = 0; i < count; i++)
+      elements[i].addr = addrList.get(i);
+   qsort(elements, count, sizeof(ScanListElement), CompareScanListElements);
+
+   SocketPoller sp;
+   for(int i = 0; i < count; i++)
+   {
+      request.m_icmpHdr.m_wSeq++;
+      request.m_icmpHdr.m_wChecksum = 0;
+      request.m_icmpHdr.m_wChecksum = CalculateIPChecksum(&request, sizeof(ECHOREQUEST));
+      saDest.sin_addr.s_addr = htonl(elements[i].addr);
+      elements[i].status.startTime = GetCurrentTimeMs();
+      elements[i].status.success = false;
+      sendto(sock, (char *)&request, sizeof(ECHOREQUEST), 0, (struct sockaddr *)&saDest, sizeof(struct sockaddr_in));
+
+      bool windowEnd = ((i + 1) % SCAN_WINDOW_SIZE == 0);
+      while(true)
+      {
+         sp.reset();
+         sp.add(sock);
+         if (sp.poll(windowEnd ? 10 : 0) <= 0)
+            break;
+         ProcessListResponse(sock, elements, count);
+         windowEnd = false;
+      }
+   }
+
+   uint32_t elapsedTime = 0;
+   while(elapsedTime < g_icmpPingTimeout)
+   {
+      sp.reset();
+      sp.add(sock);
+      int64_t startTime = GetCurrentTimeMs();
+      if (sp.poll(g_icmpPingTimeout - elapsedTime) <= 0)
+         break;
+
+      ProcessListResponse(sock, elements, count);
+      elapsedTime += static_cast<uint32_t>(GetCurrentTimeMs() - startTime);
+   }
+
+   closesocket(sock);
+
+   for(int i = 0; i < count; i++)
+   {
+      if (elements[i].status.success)
+         callback(elements[i].addr, 0, nullptr, elements[i].status.rtt, _T("ICMP"), console, context);
+   }
+   MemFree(elements);
+   return true;
+}
+
 #endif   /* _WIN32 */
@@ -172,6 +172,7 @@ uint32_t g_requiredPolls = 1;
 int32_t g_instanceRetentionTime = 7; // Default instance retention time (in days)
 uint32_t g_snmpTrapStormCountThreshold = 0;
 uint32_t g_snmpTrapStormDurationThreshold = 15;
+uint32_t g_snmpMaxVarbindsPerRequest = 32;
 DB_DRIVER g_dbDriver = nullptr;
 NXCORE_EXPORTABLE_VAR(ThreadPool *g_mainThreadPool) = nullptr;
 int16_t g_defaultAgentCacheMode = AGENT_CACHE_OFF;
@@ -392,6 +393,19 @@ static void LoadGlobalConfig()
       g_flags |= AF_SINGLE_TABLE_PERF_DATA;
    }
 
+   if (MetaDataReadInt32(_T("PartitionedTables"), 0))
+   {
+      if ((g_dbSyntax == DB_SYNTAX_PGSQL) || (g_dbSyntax == DB_SYNTAX_MYSQL))
+      {
+         nxlog_debug_tag(_T("db.partitions"), 1, _T("Using time partitioned tables for collected data and logs"));
+         g_flags |= AF_PARTITIONED_TABLES;
+      }
+      else
+      {
+         nxlog_debug_tag(_T("db.partitions"), 1, _T("Table partitioning is not supported for current database syntax"));
+      }
+   }
+
    g_conditionPollingInterval = ConfigReadInt(_T("Objects.Conditions.PollingInterval"), 60);
    g_configurationPollingInterval = ConfigReadInt(_T("Objects.ConfigurationPollingInterval"), 3600);
    g_discoveryPollingInterval = ConfigReadInt(_T("NetworkDiscovery.PassiveDiscovery.Interval"), 900);
@@ -521,6 +535,8 @@ static void LoadGlobalConfig()
    g_instanceRetentionTime = ConfigReadInt(_T("DataCollection.InstanceRetentionTime"), 7); // Config values are in days
    g_snmpTrapStormCountThreshold = ConfigReadInt(_T("SNMP.Traps.RateLimit.Threshold"), 0);
    g_snmpTrapStormDurationThreshold = ConfigReadInt(_T("SNMP.Traps.RateLimit.Duration"), 15);
+   g_snmpMaxVarbindsPerRequest = ConfigReadULong(_T("SNMP.MaxVarbindsPerRequest"), 32);
+   NXCPSetMessageCompressionLevel(ConfigReadInt(_T("Server.NXCP.CompressionLevel"), 6));
 
    switch(ConfigReadInt(_T("Objects.Nodes.ResolveDNSToIPOnStatusPoll"), static_cast<int>(PrimaryIPUpdateMode::NEVER)))
    {
@@ -1072,6 +1088,12 @@ BOOL NXCORE_EXPORTABLE Initialize()
    ConfigPreLoad();
    LoadGlobalConfig();
    CASReadSettings();
+   if (g_flags & AF_PARTITIONED_TABLES)
+   {
+      DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
+      MaintainTablePartitions(hdb);
+      DBConnectionPoolReleaseConnection(hdb);
+   }
    nxlog_debug_tag(DEBUG_TAG_STARTUP, 1, _T("Global configuration loaded"));
 
    // Setup thread pool resize parameters
@@ -1204,6 +1226,8 @@ BOOL NXCORE_EXPORTABLE Initialize()
    // Initialize data collection subsystem
    LoadPerfDataStorageDrivers();
    LoadWebServiceDefinitions();
+   if (!SnmpStartAsyncEngine())
+      nxlog_write_tag(NXLOG_WARNING, DEBUG_TAG_STARTUP, _T("Unable to start asynchronous SNMP engine, SNMP requests will be processed synchronously"));
    InitDataCollector();
 
    LoadObjectQueries();
@@ -1372,6 +1396,7 @@ void NXCORE_EXPORTABLE Shutdown()
    // Wait for critical threads
    ThreadJoin(s_pollManagerThread);
    ThreadJoin(s_syncerThread);
+   SnmpStopAsyncEngine();
 
    nxlog_debug_tag(DEBUG_TAG_SHUTDOWN, 2, _T("Waiting for listener threads to stop"));
    ThreadJoin(s_tunnelListenerThread);
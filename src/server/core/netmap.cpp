@@ -90,7 +90,7 @@ NetworkMap::NetworkMap(const NetworkMap &src) : super(), m_seedObjects(src.m_see
    setFilter(src.m_filterSource);
    for(int i = 0; i < src.m_elements.size(); i++)
    {
-      m_elements.add(src.m_elements.get(i)->clone());
+      addElement(src.m_elements.get(i)->clone());
    }
    for(int i = 0; i < src.m_links.size(); i++)
    {
@@ -554,7 +554,7 @@ bool NetworkMap::loadFromDatabase(DB_HANDLE hdb, UINT32 dwId)
 					e = new NetworkMapElement(id, flags);
 				}
 				delete config;
-				m_elements.add(e);
+				addElement(e);
 				if (m_nextElementId <= e->getId())
 					m_nextElementId = e->getId() + 1;
 			}
@@ -760,21 +760,19 @@ uint32_t NetworkMap::modifyFromMessageInternal(const NXCPMessage& msg)
 					m_nextElementId = e->getId() + 1;
 			}
 		}
+		HashSet<uint32_t> newElementIds;
 		for(int i = 0; i < newElements.size(); i++)
 		{
 		   NetworkMapElement *newElement = newElements.get(i);
+		   newElementIds.put(newElement->getId());
 
 		   bool found = false;
-		   for(int j = 0; j < m_elements.size(); j++)
-		   {
-	         NetworkMapElement *oldElement = m_elements.get(j);
-		      if (newElement->getId() == oldElement->getId() && newElement->getType() == oldElement->getType())
-		      {
-		         newElement->updateInternalFields(oldElement);
-		         found = true;
-		         break;
-		      }
-		   }
+         NetworkMapElement *oldElement = m_elementIndex.get(newElement->getId());
+         if ((oldElement != nullptr) && (newElement->getType() == oldElement->getType()))
+         {
+            newElement->updateInternalFields(oldElement);
+            found = true;
+         }
 
          if (newElement->getType() != MAP_ELEMENT_OBJECT)
             continue;
@@ -800,16 +798,7 @@ uint32_t NetworkMap::modifyFromMessageInternal(const NXCPMessage& msg)
          if (oldElement->getType() != MAP_ELEMENT_OBJECT)
             continue;
 
-         bool found = false;
-		   for(int i = 0; i < newElements.size(); i++)
-         {
-		      if (newElements.get(i)->getId() == oldElement->getId() )
-            {
-               found = true;
-               break;
-            }
-         }
-         if (!found)
+         if (!newElementIds.contains(oldElement->getId()))
          {
             NetworkMapObjectLocation loc;
             loc.objectId = static_cast<NetworkMapObject*>(oldElement)->getObjectId();
@@ -822,6 +811,7 @@ uint32_t NetworkMap::modifyFromMessageInternal(const NXCPMessage& msg)
       }
 		m_elements.clear();
 		m_elements.addAll(newElements);
+		rebuildElementIndex();
 
 		m_links.clear();
 		int numLinks = msg.getFieldAsUInt32(VID_NUM_LINKS);
@@ -987,6 +977,7 @@ void NetworkMap::updateObjects(NetworkMapObjectList *objects)
    }
 
    // remove non-existing objects
+   bool elementsRemoved = false;
    for(int i = 0; i < m_elements.size(); i++)
    {
       NetworkMapElement *e = m_elements.get(i);
@@ -1007,29 +998,21 @@ void NetworkMap::updateObjects(NetworkMapObjectList *objects)
             m_deletedObjects.remove(MAX_DELETED_OBJECT_COUNT);
          m_elements.remove(i);
          i--;
-         modified = true;
+         elementsRemoved = true;
       }
    }
+   if (elementsRemoved)
+   {
+      rebuildElementIndex();
+      modified = true;
+   }
 
    // add new objects
    for(int i = 0; i < objects->getNumObjects(); i++)
    {
-      bool found = false;
-      NetworkMapElement *e = nullptr;
-      for(int j = 0; j < m_elements.size(); j++)
-      {
-         e = m_elements.get(j);
-         if (e->getType() != MAP_ELEMENT_OBJECT)
-            continue;
-         if (static_cast<NetworkMapObject*>(e)->getObjectId() == objects->getObjects().get(i))
-         {
-            found = true;
-            break;
-         }
-      }
-      if (!found)
+      uint32_t objectId = objects->getObjects().get(i);
+      if (!m_objectIndex.contains(objectId))
       {
-         uint32_t objectId = objects->getObjects().get(i);
          NetworkMapObject *e = new NetworkMapObject(m_nextElementId++, objectId, 1);
          for (int i = 0; i < m_deletedObjects.size(); i++)
          {
@@ -1041,31 +1024,30 @@ void NetworkMap::updateObjects(NetworkMapObjectList *objects)
                break;
             }
          }
-         m_elements.add(e);
+         addElement(e);
          modified = true;
          nxlog_debug_tag(DEBUG_TAG_NETMAP, 5, _T("NetworkMap(%s [%u])/updateObjects: new object %u (element ID %u) added"), m_name, m_id, objectId, e->getId());
       }
    }
 
+   // Index existing links by connected objects
+   HashMap<ObjLinkIndexKey, NetworkMapLink> linkIndex;
+   for(int i = 0; i < m_links.size(); i++)
+   {
+      NetworkMapLink *link = m_links.get(i);
+      ObjLinkIndexKey key(objectIdFromElementId(link->getElement1()), objectIdFromElementId(link->getElement2()), link->getType());
+      if (!linkIndex.contains(key))
+         linkIndex.set(key, link);
+   }
+
    // add new links and update existing
    const ObjectArray<ObjLink>& links = objects->getLinks();
    for(int i = 0; i < links.size(); i++)
    {
       ObjLink *newLink = links.get(i);
-      NetworkMapLink *link = nullptr;
-      bool isNew = true;
-      for(int j = 0; j < m_links.size(); j++)
-      {
-         NetworkMapLink *currLink = m_links.get(j);
-         uint32_t obj1 = objectIdFromElementId(currLink->getElement1());
-         uint32_t obj2 = objectIdFromElementId(currLink->getElement2());
-         if ((newLink->id1 == obj1) && (newLink->id2 == obj2) && (newLink->type == currLink->getType()))
-         {
-            link = currLink;
-            isNew = false;
-            break;
-         }
-      }
+      ObjLinkIndexKey key(newLink->id1, newLink->id2, newLink->type);
+      NetworkMapLink *link = linkIndex.get(key);
+      bool isNew = (link == nullptr);
 
       // Add new link if needed
       if (link == nullptr)
@@ -1079,6 +1061,7 @@ void NetworkMap::updateObjects(NetworkMapObjectList *objects)
             link->setColorSource(MAP_LINK_COLOR_SOURCE_OBJECT_STATUS);
             link->setFlags(AUTO_GENERATED);
             m_links.add(link);
+            linkIndex.set(key, link);
          }
          else
          {
@@ -1198,22 +1181,8 @@ void NetworkMap::updateLinks()
  */
 uint32_t NetworkMap::objectIdFromElementId(uint32_t eid)
 {
-	for(int i = 0; i < m_elements.size(); i++)
-	{
-		NetworkMapElement *e = m_elements.get(i);
-		if (e->getId() == eid)
-		{
-			if (e->getType() == MAP_ELEMENT_OBJECT)
-			{
-				return ((NetworkMapObject *)e)->getObjectId();
-			}
-			else
-			{
-				return 0;
-			}
-		}
-	}
-	return 0;
+   NetworkMapElement *e = m_elementIndex.get(eid);
+   return ((e != nullptr) && (e->getType() == MAP_ELEMENT_OBJECT)) ? static_cast<NetworkMapObject*>(e)->getObjectId() : 0;
 }
 
 /**
@@ -1222,15 +1191,45 @@ uint32_t NetworkMap::objectIdFromElementId(uint32_t eid)
  */
 uint32_t NetworkMap::elementIdFromObjectId(uint32_t oid)
 {
-	for(int i = 0; i < m_elements.size(); i++)
-	{
-		NetworkMapElement *e = m_elements.get(i);
-		if ((e->getType() == MAP_ELEMENT_OBJECT) && (((NetworkMapObject *)e)->getObjectId() == oid))
-		{
-			return e->getId();
-		}
-	}
-	return 0;
+   NetworkMapObject *e = m_objectIndex.get(oid);
+   return (e != nullptr) ? e->getId() : 0;
+}
+
+/**
+ * Add element to indexes. Only first element with given ID or object ID is indexed, so lookups return same element as sequential search.
+ */
+void NetworkMap::indexElement(NetworkMapElement *e)
+{
+   if (!m_elementIndex.contains(e->getId()))
+      m_elementIndex.set(e->getId(), e);
+   if (e->getType() == MAP_ELEMENT_OBJECT)
+   {
+      uint32_t objectId = static_cast<NetworkMapObject*>(e)->getObjectId();
+      if (!m_objectIndex.contains(objectId))
+         m_objectIndex.set(objectId, static_cast<NetworkMapObject*>(e));
+   }
+}
+
+/**
+ * Add element to map
+ * Assumes that object data already locked
+ */
+void NetworkMap::addElement(NetworkMapElement *e)
+{
+   m_elements.add(e);
+   indexElement(e);
+}
+
+/**
+ * Rebuild element indexes (should be called after elements were removed)
+ * Assumes that object data already locked
+ */
+void NetworkMap::rebuildElementIndex()
+{
+   m_elementIndex.clear();
+   m_objectIndex.clear();
+   for(int i = 0; i < m_elements.size(); i++)
+      indexElement(m_elements.get(i));
 }
 
 /**
@@ -1312,6 +1311,7 @@ void NetworkMap::onObjectDelete(const NetObj& object)
       if ((element->getType() == MAP_ELEMENT_OBJECT) && (static_cast<NetworkMapObject*>(element)->getObjectId() == object.getId()))
       {
          m_elements.remove(i);
+         rebuildElementIndex();
          break;
       }
       else
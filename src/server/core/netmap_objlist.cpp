@@ -95,7 +95,64 @@ NetworkMapObjectList::NetworkMapObjectList(const NetworkMapObjectList& src) : m_
 {
    m_allowDuplicateLinks = src.m_allowDuplicateLinks;
 	for(int i = 0; i < src.m_linkList.size(); i++)
-      m_linkList.add(new ObjLink(*src.m_linkList.get(i)));
+      addLink(new ObjLink(*src.m_linkList.get(i)));
+}
+
+/**
+ * Add link to index. Only first link with given key is indexed, so lookups return same link as sequential search.
+ */
+void NetworkMapObjectList::indexLink(ObjLink *link)
+{
+   ObjLinkIndexKey key(link->id1, link->id2, -1);
+   if (m_linkIndex.get(key) == nullptr)
+      m_linkIndex.set(key, link);
+   key.type = link->type;
+   if (m_linkIndex.get(key) == nullptr)
+      m_linkIndex.set(key, link);
+}
+
+/**
+ * Add link to the list
+ */
+void NetworkMapObjectList::addLink(ObjLink *link)
+{
+   m_linkList.add(link);
+   indexLink(link);
+}
+
+/**
+ * Rebuild link index (should be called after links were removed or link types changed)
+ */
+void NetworkMapObjectList::rebuildLinkIndex()
+{
+   m_linkIndex.clear();
+   for(int i = 0; i < m_linkList.size(); i++)
+      indexLink(m_linkList.get(i));
+}
+
+/**
+ * Change type of existing link
+ */
+void NetworkMapObjectList::setLinkType(ObjLink *link, int type)
+{
+   if (link->type == type)
+      return;
+
+   if (m_allowDuplicateLinks)
+   {
+      // Other link with same key may exist and should become indexed
+      link->type = type;
+      rebuildLinkIndex();
+      return;
+   }
+
+   ObjLinkIndexKey key(link->id1, link->id2, link->type);
+   if (m_linkIndex.get(key) == link)
+      m_linkIndex.remove(key);
+   link->type = type;
+   key.type = type;
+   if (m_linkIndex.get(key) == nullptr)
+      m_linkIndex.set(key, link);
 }
 
 /**
@@ -116,13 +173,18 @@ void NetworkMapObjectList::merge(const NetworkMapObjectList& src)
       if (currLink != nullptr)
       {
          if (m_allowDuplicateLinks)
-            m_linkList.add(new ObjLink(*srcLink));
+         {
+            addLink(new ObjLink(*srcLink));
+         }
          else
+         {
+            setLinkType(currLink, srcLink->type);
             currLink->update(*srcLink);
+         }
       }
       else
       {
-         m_linkList.add(new ObjLink(*srcLink));
+         addLink(new ObjLink(*srcLink));
       }
    }
 }
@@ -132,6 +194,7 @@ void NetworkMapObjectList::merge(const NetworkMapObjectList& src)
  */
 void NetworkMapObjectList::clear()
 {
+   m_linkIndex.clear();
    m_linkList.clear();
    m_objectList.clear();
 }
@@ -156,11 +219,19 @@ void NetworkMapObjectList::filterObjects(bool (*filter)(uint32_t, void *), void
  */
 void NetworkMapObjectList::addObject(uint32_t id)
 {
-   if (!isObjectExist(id))
+   // Keep list sorted for binary search
+   int low = 0, high = m_objectList.size();
+   const uint32_t *objects = m_objectList.getBuffer();
+   while(low < high)
    {
-      m_objectList.add(id);
-      m_objectList.sortAscending();
+      int mid = (low + high) / 2;
+      if (objects[mid] < id)
+         low = mid + 1;
+      else
+         high = mid;
    }
+   if ((low == m_objectList.size()) || (objects[low] != id))
+      m_objectList.insert(low, id);
 }
 
 /**
@@ -170,14 +241,18 @@ void NetworkMapObjectList::removeObject(uint32_t id)
 {
    m_objectList.remove(m_objectList.indexOf(id));
 
+   bool linksRemoved = false;
    for(int i = 0; i < m_linkList.size(); i++)
    {
       if ((m_linkList.get(i)->id1 == id) || (m_linkList.get(i)->id2 == id))
       {
          m_linkList.remove(i);
          i--;
+         linksRemoved = true;
       }
    }
+   if (linksRemoved)
+      rebuildLinkIndex();
 }
 
 /**
@@ -185,34 +260,17 @@ void NetworkMapObjectList::removeObject(uint32_t id)
  */
 void NetworkMapObjectList::linkObjects(uint32_t id1, uint32_t id2, int linkType, const TCHAR *linkName, const TCHAR *port1, const TCHAR *port2)
 {
-   if ((m_objectList.indexOf(id1) == -1) || (m_objectList.indexOf(id2) == -1))
+   if (!isObjectExist(id1) || !isObjectExist(id2))
       return;  // both objects should exist
 
-   // Check for duplicate links
+   // Check for duplicate links (only links of same type are considered duplicates if duplicate links are allowed)
+   int type = m_allowDuplicateLinks ? linkType : -1;
    bool swappedSides = false;
-   ObjLink *link = nullptr;
-   for(int i = 0; i < m_linkList.size(); i++)
+   ObjLink *link = findLink(id1, id2, type);
+   if (link == nullptr)
    {
-      ObjLink *curr = m_linkList.get(i);
-      if (((curr->id1 == id1) && (curr->id2 == id2)) ||
-          ((curr->id2 == id1) && (curr->id1 == id2)))
-      {
-         if (m_allowDuplicateLinks)
-         {
-            if (curr->type == linkType)
-            {
-               swappedSides = (curr->id1 == id2);
-               link = curr;
-               break;
-            }
-         }
-         else
-         {
-            swappedSides = (curr->id1 == id2);
-            link = curr;
-            break;
-         }
-      }
+      link = findLink(id2, id1, type);
+      swappedSides = (link != nullptr) && (link->id1 != id1);
    }
 
    if (link == nullptr)
@@ -221,7 +279,7 @@ void NetworkMapObjectList::linkObjects(uint32_t id1, uint32_t id2, int linkType,
       link->id1 = id1;
       link->id2 = id2;
       link->type = linkType;
-      m_linkList.add(link);
+      addLink(link);
    }
 
    if (linkName != nullptr)
@@ -248,7 +306,7 @@ static void UpdatePortNames(ObjLink *link, const TCHAR *port1, const TCHAR *port
  */
 void NetworkMapObjectList::linkObjectsEx(uint32_t id1, uint32_t id2, const TCHAR *port1, const TCHAR *port2, uint32_t portId1, uint32_t portId2, const TCHAR *name)
 {
-   if ((m_objectList.indexOf(id1) == -1) || (m_objectList.indexOf(id2) == -1))
+   if (!isObjectExist(id1) || !isObjectExist(id2))
       return;  // both objects should exist
 
    if (id1 == id2)
@@ -256,55 +314,39 @@ void NetworkMapObjectList::linkObjectsEx(uint32_t id1, uint32_t id2, const TCHAR
 
    // Check for duplicate links
    bool linkExists = false;
-   for(int i = 0; i < m_linkList.size(); i++)
+   bool swapped = false;
+   ObjLink *link = findLink(id1, id2, -1);
+   if (link == nullptr)
    {
-      if ((m_linkList.get(i)->id1 == id1) && (m_linkList.get(i)->id2 == id2))
+      link = findLink(id2, id1, -1);
+      swapped = true;
+   }
+   if (link != nullptr)
+   {
+      uint32_t linkPortId1 = swapped ? portId2 : portId1;
+      uint32_t linkPortId2 = swapped ? portId1 : portId2;
+      int j;
+      for(j = 0; j < link->portIdCount; j++)
       {
-         int j;
-         for(j = 0; j < m_linkList.get(i)->portIdCount; j++)
-         {
-            if ((m_linkList.get(i)->portIdArray1[j] == portId1) && (m_linkList.get(i)->portIdArray2[j] == portId2))
-            {
-               m_linkList.get(i)->name = name;
-               linkExists = true;
-               break;
-            }
-         }
-         if (!linkExists && (m_linkList.get(i)->portIdCount < MAX_PORT_COUNT))
+         if ((link->portIdArray1[j] == linkPortId1) && (link->portIdArray2[j] == linkPortId2))
          {
-            m_linkList.get(i)->portIdArray1[j] = portId1;
-            m_linkList.get(i)->portIdArray2[j] = portId2;
-            m_linkList.get(i)->portIdCount++;
-            UpdatePortNames(m_linkList.get(i), port1, port2);
-            m_linkList.get(i)->type = LINK_TYPE_MULTILINK;
-            m_linkList.get(i)->name = name;
+            link->name = name;
             linkExists = true;
+            break;
          }
-         break;
       }
-      if ((m_linkList.get(i)->id1 == id2) && (m_linkList.get(i)->id2 == id1))
+      if (!linkExists && (link->portIdCount < MAX_PORT_COUNT))
       {
-         int j;
-         for(j = 0; j < m_linkList.get(i)->portIdCount; j++)
-         {
-            if ((m_linkList.get(i)->portIdArray1[j] == portId2) && (m_linkList.get(i)->portIdArray2[j] == portId1))
-            {
-               m_linkList.get(i)->name = name;
-               linkExists = true;
-               break;
-            }
-         }
-         if (!linkExists && (m_linkList.get(i)->portIdCount < MAX_PORT_COUNT))
-         {
-            m_linkList.get(i)->portIdArray1[j] = portId2;
-            m_linkList.get(i)->portIdArray2[j] = portId1;
-            m_linkList.get(i)->portIdCount++;
-            UpdatePortNames(m_linkList.get(i), port2, port1);
-            m_linkList.get(i)->type = LINK_TYPE_MULTILINK;
-            m_linkList.get(i)->name = name;
-            linkExists = true;
-         }
-         break;
+         link->portIdArray1[j] = linkPortId1;
+         link->portIdArray2[j] = linkPortId2;
+         link->portIdCount++;
+         if (swapped)
+            UpdatePortNames(link, port2, port1);
+         else
+            UpdatePortNames(link, port1, port2);
+         setLinkType(link, LINK_TYPE_MULTILINK);
+         link->name = name;
+         linkExists = true;
       }
    }
 
@@ -320,7 +362,7 @@ void NetworkMapObjectList::linkObjectsEx(uint32_t id1, uint32_t id2, const TCHAR
       obj->name = name;
       _tcslcpy(obj->port1, port1, MAX_CONNECTOR_NAME);
       _tcslcpy(obj->port2, port2, MAX_CONNECTOR_NAME);
-      m_linkList.add(obj);
+      addLink(obj);
    }
 }
 
@@ -355,13 +397,7 @@ void NetworkMapObjectList::createMessage(NXCPMessage *msg)
  */
 bool NetworkMapObjectList::isLinkExist(uint32_t objectId1, uint32_t objectId2, int type) const
 {
-   for(int i = 0; i < m_linkList.size(); i++)
-   {
-      ObjLink *l = m_linkList.get(i);
-		if ((l->id1 == objectId1) && (l->id2 == objectId2) && ((type == -1) || (l->type == type)))
-			return true;
-	}
-	return false;
+   return findLink(objectId1, objectId2, type) != nullptr;
 }
 
 /**
@@ -369,15 +405,8 @@ bool NetworkMapObjectList::isLinkExist(uint32_t objectId1, uint32_t objectId2, i
  */
 ObjLink *NetworkMapObjectList::getLink(uint32_t objectId1, uint32_t objectId2, int linkType)
 {
-   for(int i = 0; i < m_linkList.size(); i++)
-   {
-      ObjLink *l = m_linkList.get(i);
-      if (((l->id1 == objectId1) && (l->id2 == objectId2)) ||
-         (((l->id1 == objectId2) && (l->id2 == objectId1)) &&
-           (l->type == linkType)))
-         return l;
-   }
-   return nullptr;
+   ObjLink *l = findLink(objectId1, objectId2, -1);
+   return (l != nullptr) ? l : findLink(objectId2, objectId1, linkType);
 }
 
 /**
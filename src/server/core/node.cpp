@@ -27,6 +27,7 @@
 #include <ncdrv.h>
 
 #define DEBUG_TAG_DC_AGENT_CACHE    _T("dc.agent.cache")
+#define DEBUG_TAG_DC_SNMP           _T("dc.snmp")
 #define DEBUG_TAG_ICMP_POLL         _T("poll.icmp")
 #define DEBUG_TAG_NODE_INTERFACES   _T("node.iface")
 #define DEBUG_TAG_ROUTES_POLL       _T("poll.routes")
@@ -100,7 +101,7 @@ String GetCurrentActiveDiscoveryRange();
  * Node class default constructor
  */
 Node::Node() : super(Pollable::STATUS | Pollable::CONFIGURATION | Pollable::DISCOVERY | Pollable::TOPOLOGY | Pollable::ROUTING_TABLE | Pollable::ICMP),
-         m_routingTableMutex(MutexType::FAST), m_topologyMutex(MutexType::FAST)
+         m_routingTableMutex(MutexType::FAST), m_topologyMutex(MutexType::FAST), m_snmpTransportCacheLock(MutexType::FAST)
 {
    m_status = STATUS_UNKNOWN;
    m_type = NODE_TYPE_UNKNOWN;
@@ -146,6 +147,9 @@ Node::Node() : super(Pollable::STATUS | Pollable::CONFIGURATION | Pollable::DISC
    m_pollerNode = 0;
    m_agentProxy = 0;
    m_snmpProxy = 0;
+   m_cachedSnmpTransport = nullptr;
+   m_cachedSnmpTransportProxy = 0;
+   m_cachedSnmpTransportTime = 0;
    m_eipProxy = 0;
    m_mqttProxy = 0;
    m_icmpProxy = 0;
@@ -211,7 +215,7 @@ Node::Node() : super(Pollable::STATUS | Pollable::CONFIGURATION | Pollable::DISC
  */
 Node::Node(const NewNodeData *newNodeData, uint32_t flags) : super(Pollable::STATUS | Pollable::CONFIGURATION | Pollable::DISCOVERY | Pollable::TOPOLOGY | Pollable::ROUTING_TABLE | Pollable::ICMP),
          m_ipAddress(newNodeData->ipAddr), m_primaryHostName(newNodeData->ipAddr.toString()), m_routingTableMutex(MutexType::FAST), m_topologyMutex(MutexType::FAST),
-         m_sshLogin(newNodeData->sshLogin), m_sshPassword(newNodeData->sshPassword)
+         m_snmpTransportCacheLock(MutexType::FAST), m_sshLogin(newNodeData->sshLogin), m_sshPassword(newNodeData->sshPassword)
 {
    m_runtimeFlags |= ODF_CONFIGURATION_POLL_PENDING;
    m_status = STATUS_UNKNOWN;
@@ -266,6 +270,9 @@ Node::Node(const NewNodeData *newNodeData, uint32_t flags) : super(Pollable::STA
    m_pollerNode = 0;
    m_agentProxy = newNodeData->agentProxyId;
    m_snmpProxy = newNodeData->snmpProxyId;
+   m_cachedSnmpTransport = nullptr;
+   m_cachedSnmpTransportProxy = 0;
+   m_cachedSnmpTransportTime = 0;
    m_eipProxy = newNodeData->eipProxyId;
    m_mqttProxy = newNodeData->mqttProxyId;
    m_icmpProxy = newNodeData->icmpProxyId;
@@ -346,6 +353,7 @@ Node::~Node()
    delete m_routingTable;
    delete m_vrrpInfo;
    delete m_snmpSecurity;
+   delete m_cachedSnmpTransport;
    delete m_wirelessStations;
    MemFree(m_lldpNodeId);
    delete m_lldpLocalPortInfo;
@@ -5218,6 +5226,8 @@ bool Node::confPollSnmp(uint32_t requestId)
       return false;
    }
 
+   invalidateSnmpTransportCache();
+
    lockProperties();
    m_snmpPort = pTransport->getPort();
    delete m_snmpSecurity;
@@ -6447,6 +6457,40 @@ inline DataCollectionError DCErrorFromSNMPError(UINT32 snmpError)
    }
 }
 
+/**
+ * Convert raw SNMP value according to requested interpretation
+ */
+static void ConvertRawSNMPValue(const BYTE *rawValue, int interpretRawValue, TCHAR *buffer, size_t size)
+{
+   switch(interpretRawValue)
+   {
+      case SNMP_RAWTYPE_INT32:
+         IntegerToString(static_cast<int32_t>(ntohl(*reinterpret_cast<const uint32_t*>(rawValue))), buffer);
+         break;
+      case SNMP_RAWTYPE_UINT32:
+         IntegerToString(static_cast<uint32_t>(ntohl(*reinterpret_cast<const uint32_t*>(rawValue))), buffer);
+         break;
+      case SNMP_RAWTYPE_INT64:
+         IntegerToString(static_cast<int64_t>(ntohq(*reinterpret_cast<const uint64_t*>(rawValue))), buffer);
+         break;
+      case SNMP_RAWTYPE_UINT64:
+         IntegerToString(ntohq(*reinterpret_cast<const uint64_t*>(rawValue)), buffer);
+         break;
+      case SNMP_RAWTYPE_DOUBLE:
+         _sntprintf(buffer, size, _T("%f"), ntohd(*reinterpret_cast<const double*>(rawValue)));
+         break;
+      case SNMP_RAWTYPE_IP_ADDR:
+         IpToStr(ntohl(*reinterpret_cast<const uint32_t*>(rawValue)), buffer);
+         break;
+      case SNMP_RAWTYPE_MAC_ADDR:
+         MACToStr(rawValue, buffer);
+         break;
+      default:
+         buffer[0] = 0;
+         break;
+   }
+}
+
 /**
  * Get DCI value via SNMP. Buffer size should be at least 64 characters.
  */
@@ -6467,7 +6511,7 @@ DataCollectionError Node::getMetricFromSNMP(uint16_t port, SNMP_Version version,
    }
 
    uint32_t snmpResult;
-   SNMP_Transport *snmp = createSnmpTransport(port, version);
+   SNMP_Transport *snmp = acquireSnmpTransport(port, version);
    if (snmp != nullptr)
    {
       if (interpretRawValue == SNMP_RAWTYPE_NONE)
@@ -6480,37 +6524,9 @@ DataCollectionError Node::getMetricFromSNMP(uint16_t port, SNMP_Version version,
          memset(rawValue, 0, 1024);
          snmpResult = SnmpGetEx(snmp, name, nullptr, 0, rawValue, 1024, SG_RAW_RESULT, nullptr);
          if (snmpResult == SNMP_ERR_SUCCESS)
-         {
-            switch(interpretRawValue)
-            {
-               case SNMP_RAWTYPE_INT32:
-                  IntegerToString(static_cast<int32_t>(ntohl(*reinterpret_cast<uint32_t*>(rawValue))), buffer);
-                  break;
-               case SNMP_RAWTYPE_UINT32:
-                  IntegerToString(static_cast<uint32_t>(ntohl(*reinterpret_cast<uint32_t*>(rawValue))), buffer);
-                  break;
-               case SNMP_RAWTYPE_INT64:
-                  IntegerToString(static_cast<int64_t>(ntohq(*reinterpret_cast<uint64_t*>(rawValue))), buffer);
-                  break;
-               case SNMP_RAWTYPE_UINT64:
-                  IntegerToString(ntohq(*reinterpret_cast<uint64_t*>(rawValue)), buffer);
-                  break;
-               case SNMP_RAWTYPE_DOUBLE:
-                  _sntprintf(buffer, size, _T("%f"), ntohd(*reinterpret_cast<double*>(rawValue)));
-                  break;
-               case SNMP_RAWTYPE_IP_ADDR:
-                  IpToStr(ntohl(*reinterpret_cast<uint32_t*>(rawValue)), buffer);
-                  break;
-               case SNMP_RAWTYPE_MAC_ADDR:
-                  MACToStr(rawValue, buffer);
-                  break;
-               default:
-                  buffer[0] = 0;
-                  break;
-            }
-         }
+            ConvertRawSNMPValue(rawValue, interpretRawValue, buffer, size);
       }
-      delete snmp;
+      releaseSnmpTransport(snmp, DCErrorFromSNMPError(snmpResult) != DCE_COMM_ERROR);
    }
    else
    {
@@ -6520,6 +6536,195 @@ DataCollectionError Node::getMetricFromSNMP(uint16_t port, SNMP_Version version,
    return DCErrorFromSNMPError(snmpResult);
 }
 
+/**
+ * Maximum estimated size of coalesced SNMP request (selected to avoid IP fragmentation)
+ */
+#define MAX_COALESCED_REQUEST_SIZE  1200
+
+/**
+ * Estimate encoded size of GET request varbind for given OID
+ */
+static size_t EstimateVarbindSize(const SNMP_ObjectId& oid)
+{
+   size_t size = 8;  // Varbind sequence, OID and NULL value headers
+   const uint32_t *value = oid.value();
+   for(size_t i = 0; i < oid.length(); i++)
+      size += (value[i] < 0x80) ? 1 : ((value[i] < 0x4000) ? 2 : ((value[i] < 0x200000) ? 3 : ((value[i] < 0x10000000) ? 4 : 5)));
+   return size;
+}
+
+/**
+ * Store value of single varbind from coalesced request response
+ */
+static void StoreCoalescedMetricValue(SNMPMetricRequest *request, const SNMP_ObjectId& oid, SNMP_Variable *v, TCHAR *buffer)
+{
+   if ((v == nullptr) || (v->getName().compare(oid) != OID_EQUAL))
+   {
+      request->result = DCE_COLLECTION_ERROR;
+      return;
+   }
+
+   if ((v->getType() == ASN_NO_SUCH_OBJECT) || (v->getType() == ASN_NO_SUCH_INSTANCE) || (v->getType() == ASN_END_OF_MIBVIEW))
+   {
+      request->result = DCErrorFromSNMPError(SNMP_ERR_NO_OBJECT);
+      return;
+   }
+
+   if (request->interpretRawValue == SNMP_RAWTYPE_NONE)
+   {
+      bool convert = true;
+      v->getValueAsPrintableString(buffer, MAX_LINE_SIZE, &convert);
+   }
+   else
+   {
+      BYTE rawValue[1024];
+      memset(rawValue, 0, 1024);
+      v->getRawValue(rawValue, 1024);
+      ConvertRawSNMPValue(rawValue, request->interpretRawValue, buffer, MAX_LINE_SIZE);
+   }
+   request->value = MemCopyString(buffer);
+   request->result = DCE_SUCCESS;
+}
+
+/**
+ * Collect values for given subset of metric requests with single multi-varbind GET request. On "tooBig" error
+ * request is split in two. On other errors (like "noSuchName" returned by SNMPv1 agents) failed varbind is excluded
+ * and request is repeated for remaining varbinds, or each OID is requested separately if agent does not report
+ * valid error index. Returns SNMP error code if communication with agent failed.
+ */
+static uint32_t CollectCoalescedSNMPMetrics(SNMP_Transport *snmp, SNMPMetricRequest *requests, const SNMP_ObjectId *oids, int *indexes, int count, TCHAR *buffer)
+{
+   while(count > 0)
+   {
+      SNMP_PDU request(SNMP_GET_REQUEST, SnmpNewRequestId(), snmp->getSnmpVersion());
+      for(int i = 0; i < count; i++)
+         request.bindVariable(new SNMP_Variable(oids[indexes[i]]));
+
+      SNMP_PDU *response;
+      uint32_t rc = snmp->doRequest(&request, &response);
+      if (rc != SNMP_ERR_SUCCESS)
+         return rc;
+
+      SNMP_ErrorCode errorCode = response->getErrorCode();
+      if (errorCode == SNMP_PDU_ERR_SUCCESS)
+      {
+         for(int i = 0; i < count; i++)
+            StoreCoalescedMetricValue(&requests[indexes[i]], oids[indexes[i]], response->getVariable(i), buffer);
+         delete response;
+         return SNMP_ERR_SUCCESS;
+      }
+
+      uint32_t errorIndex = response->getErrorIndex();
+      delete response;
+
+      DataCollectionError varbindError = DCErrorFromSNMPError((errorCode == SNMP_PDU_ERR_NO_SUCH_NAME) ? SNMP_ERR_NO_OBJECT : SNMP_ERR_AGENT);
+      if (count == 1)
+      {
+         requests[indexes[0]].result = varbindError;
+         return SNMP_ERR_SUCCESS;
+      }
+
+      if (errorCode == SNMP_PDU_ERR_TOO_BIG)
+      {
+         int half = count / 2;
+         rc = CollectCoalescedSNMPMetrics(snmp, requests, oids, indexes, half, buffer);
+         if (rc != SNMP_ERR_SUCCESS)
+            return rc;
+         indexes += half;
+         count -= half;
+         continue;
+      }
+
+      if ((errorIndex > 0) && (errorIndex <= static_cast<uint32_t>(count)))
+      {
+         requests[indexes[errorIndex - 1]].result = varbindError;
+         memmove(&indexes[errorIndex - 1], &indexes[errorIndex], (count - errorIndex) * sizeof(int));
+         count--;
+         continue;
+      }
+
+      for(int i = 0; i < count; i++)
+      {
+         rc = CollectCoalescedSNMPMetrics(snmp, requests, oids, &indexes[i], 1, buffer);
+         if (rc != SNMP_ERR_SUCCESS)
+            return rc;
+      }
+      break;
+   }
+   return SNMP_ERR_SUCCESS;
+}
+
+/**
+ * Get values for multiple DCIs via SNMP. Metrics are requested with as few multi-varbind GET requests as possible,
+ * limited by configured number of varbinds per request and estimated request size. Result for each metric is stored
+ * in corresponding request structure.
+ */
+void Node::getMetricsFromSNMP(uint16_t port, SNMP_Version version, SNMPMetricRequest *requests, int count)
+{
+   if (count <= 0)
+      return;
+
+   for(int i = 0; i < count; i++)
+   {
+      requests[i].result = DCE_COMM_ERROR;
+      requests[i].value = nullptr;
+   }
+
+   if ((((m_state & NSF_SNMP_UNREACHABLE) || !(m_capabilities & NC_IS_SNMP)) && (port == 0)) ||
+       (m_state & DCSF_UNREACHABLE) ||
+       (m_flags & NF_DISABLE_SNMP))
+   {
+      nxlog_debug_tag(DEBUG_TAG_DC_SNMP, 7, _T("Node(%s)->getMetricsFromSNMP(): SNMP is not available (%d metrics)"), m_name, count);
+      return;
+   }
+
+   SNMP_Transport *snmp = acquireSnmpTransport(port, version);
+   if (snmp == nullptr)
+   {
+      nxlog_debug_tag(DEBUG_TAG_DC_SNMP, 7, _T("Node(%s)->getMetricsFromSNMP(): cannot create SNMP transport"), m_name);
+      return;
+   }
+
+   SNMP_ObjectId *oids = new SNMP_ObjectId[count];
+   int *indexes = MemAllocArrayNoInit<int>(count);
+   int validCount = 0;
+   for(int i = 0; i < count; i++)
+   {
+      oids[i] = SNMP_ObjectId::parse(requests[i].name);
+      if (oids[i].isValid())
+         indexes[validCount++] = i;
+      else
+         requests[i].result = DCErrorFromSNMPError(SNMP_ERR_BAD_OID);
+   }
+
+   TCHAR buffer[MAX_LINE_SIZE];
+   int maxVarbinds = std::max(static_cast<int>(g_snmpMaxVarbindsPerRequest), 1);
+   int requestCount = 0;
+   uint32_t rc = SNMP_ERR_SUCCESS;
+   for(int start = 0; (start < validCount) && (rc == SNMP_ERR_SUCCESS); requestCount++)
+   {
+      int size = 0;
+      size_t requestSize = 0;
+      while((start + size < validCount) && (size < maxVarbinds))
+      {
+         size_t varbindSize = EstimateVarbindSize(oids[indexes[start + size]]);
+         if ((size > 0) && (requestSize + varbindSize > MAX_COALESCED_REQUEST_SIZE))
+            break;
+         requestSize += varbindSize;
+         size++;
+      }
+      rc = CollectCoalescedSNMPMetrics(snmp, requests, oids, &indexes[start], size, buffer);
+      start += size;
+   }
+
+   // Metrics not processed because of communication error will keep DCE_COMM_ERROR result
+   releaseSnmpTransport(snmp, rc == SNMP_ERR_SUCCESS);
+   nxlog_debug_tag(DEBUG_TAG_DC_SNMP, 7, _T("Node(%s)->getMetricsFromSNMP(): %d metrics requested in %d requests (rc=%u)"), m_name, count, requestCount, rc);
+
+   delete[] oids;
+   MemFree(indexes);
+}
+
 /**
  * Read one row for SNMP table
  */
@@ -7656,6 +7861,30 @@ DataCollectionError Node::getInternalMetric(const TCHAR *name, TCHAR *buffer, si
       {
          IntegerToString(g_rawDataWriteRequests, buffer);
       }
+      else if (!_tcsicmp(name, _T("Server.DBWriter.Requests.TData")))
+      {
+         IntegerToString(g_tdataWriteRequests, buffer);
+      }
+      else if (!_tcsicmp(name, _T("Server.EventLogWriter.AverageBatchSize")))
+      {
+         ret_uint(buffer, GetEventLogWriterStats().averageBatchSize);
+      }
+      else if (!_tcsicmp(name, _T("Server.EventLogWriter.AverageWriteTime")))
+      {
+         ret_uint(buffer, GetEventLogWriterStats().averageWriteTime);
+      }
+      else if (!_tcsicmp(name, _T("Server.EventLogWriter.FailedEvents")))
+      {
+         ret_uint64(buffer, GetEventLogWriterStats().failedEvents);
+      }
+      else if (!_tcsicmp(name, _T("Server.EventLogWriter.MaxWriteTime")))
+      {
+         ret_uint(buffer, GetEventLogWriterStats().maxWriteTime);
+      }
+      else if (!_tcsicmp(name, _T("Server.EventLogWriter.WrittenEvents")))
+      {
+         ret_uint64(buffer, GetEventLogWriterStats().writtenEvents);
+      }
       else if (MatchString(_T("Server.EventProcessor.AverageWaitTime(*)"), name, false))
       {
          rc = GetEventProcessorStatistic(name, 'W', buffer);
@@ -8412,6 +8641,13 @@ uint32_t Node::modifyFromMessageInternal(const NXCPMessage& msg)
       msg.getFieldAsUtf8String(VID_SNMP_CODEPAGE, m_snmpCodepage, 16);
    }
 
+   // Cached SNMP transport may use outdated communication settings
+   if (msg.isFieldExist(VID_SNMP_VERSION) || msg.isFieldExist(VID_SNMP_PORT) || msg.isFieldExist(VID_SNMP_AUTH_OBJECT) ||
+       msg.isFieldExist(VID_SNMP_PROXY) || msg.isFieldExist(VID_SNMP_CODEPAGE))
+   {
+      invalidateSnmpTransportCache();
+   }
+
    return super::modifyFromMessageInternal(msg);
 }
 
@@ -9607,6 +9843,74 @@ SNMP_Transport *Node::createSnmpTransport(uint16_t port, SNMP_Version version, c
    return pTransport;
 }
 
+/**
+ * Maximum idle time for cached SNMP transport (in seconds)
+ */
+#define SNMP_TRANSPORT_CACHE_TIMEOUT   300
+
+/**
+ * Acquire SNMP transport for data collection. Cached idle transport is reused if it matches requested port, version,
+ * and current SNMP proxy, otherwise new transport is created. Transport should be returned with releaseSnmpTransport().
+ */
+SNMP_Transport *Node::acquireSnmpTransport(uint16_t port, SNMP_Version version)
+{
+   uint32_t snmpProxy = getEffectiveSnmpProxy();
+
+   m_snmpTransportCacheLock.lock();
+   SNMP_Transport *transport = m_cachedSnmpTransport;
+   bool valid = (transport != nullptr) && (m_cachedSnmpTransportProxy == snmpProxy) && (time(nullptr) - m_cachedSnmpTransportTime < SNMP_TRANSPORT_CACHE_TIMEOUT);
+   m_cachedSnmpTransport = nullptr;
+   m_snmpTransportCacheLock.unlock();
+
+   if (valid)
+   {
+      lockProperties();
+      valid = (transport->getPort() == ((port != 0) ? port : m_snmpPort)) &&
+              (transport->getSnmpVersion() == ((version != SNMP_VERSION_DEFAULT) ? version : m_snmpVersion)) &&
+              transport->getPeerIpAddress().equals((snmpProxy == m_id) ? InetAddress::LOOPBACK : m_ipAddress);
+      unlockProperties();
+      if (valid)
+         return transport;
+   }
+
+   delete transport;
+   return createSnmpTransport(port, version);
+}
+
+/**
+ * Return SNMP transport acquired with acquireSnmpTransport(). Transport is kept for reuse if it is marked as
+ * reusable by caller (i.e. no communication errors) and cache is empty, otherwise it is destroyed.
+ */
+void Node::releaseSnmpTransport(SNMP_Transport *transport, bool reusable)
+{
+   if (reusable && !(m_flags & NF_DISABLE_SNMP) && !m_isDeleteInitiated)
+   {
+      uint32_t snmpProxy = getEffectiveSnmpProxy();
+      m_snmpTransportCacheLock.lock();
+      if (m_cachedSnmpTransport == nullptr)
+      {
+         m_cachedSnmpTransport = transport;
+         m_cachedSnmpTransportProxy = snmpProxy;
+         m_cachedSnmpTransportTime = time(nullptr);
+         transport = nullptr;
+      }
+      m_snmpTransportCacheLock.unlock();
+   }
+   delete transport;
+}
+
+/**
+ * Destroy cached SNMP transport
+ */
+void Node::invalidateSnmpTransportCache()
+{
+   m_snmpTransportCacheLock.lock();
+   SNMP_Transport *transport = m_cachedSnmpTransport;
+   m_cachedSnmpTransport = nullptr;
+   m_snmpTransportCacheLock.unlock();
+   delete transport;
+}
+
 /**
  * Get SNMP security context
  * ATTENTION: This method returns new copy of security context
@@ -79,7 +79,7 @@ bool PredictionEngine::getPredictedSeries(UINT32 nodeId, UINT32 dciId, DCObjectS
       return false;
 
    shared_ptr<DCObject> dci = static_cast<DataCollectionTarget*>(object.get())->getDCObjectById(dciId, 0);
-   if (dci->getType() != DCO_TYPE_ITEM)
+   if ((dci == nullptr) || (dci->getType() != DCO_TYPE_ITEM))
       return false;
 
    time_t interval = dci->getEffectivePollingInterval();
@@ -93,10 +93,24 @@ bool PredictionEngine::getPredictedSeries(UINT32 nodeId, UINT32 dciId, DCObjectS
 }
 
 /**
- * Helper method to read last N values of given DCI
+ * Helper method to read last N values of given DCI. Values are taken from DCI cache if it is large enough,
+ * otherwise from database.
  */
 StructArray<DciValue> *PredictionEngine::getDciValues(UINT32 nodeId, UINT32 dciId, DCObjectStorageClass storageClass, int maxRows)
 {
+   shared_ptr<NetObj> object = FindObjectById(nodeId);
+   if ((object != nullptr) && object->isDataCollectionTarget())
+   {
+      shared_ptr<DCObject> dci = static_cast<DataCollectionTarget*>(object.get())->getDCObjectById(dciId, 0);
+      if ((dci != nullptr) && (dci->getType() == DCO_TYPE_ITEM))
+      {
+         auto values = new StructArray<DciValue>(maxRows);
+         if (static_cast<DCItem*>(dci.get())->getCachedValues(maxRows, values))
+            return values;
+         delete values;
+      }
+   }
+
    TCHAR query[1024];
    switch(g_dbSyntax)
    {
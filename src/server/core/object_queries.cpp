@@ -336,11 +336,48 @@ static int FilterObject(NXSL_VM *vm, shared_ptr<NetObj> object, const StringMap
 }
 
 /**
- * Filter objects accessible by given user
+ * Object pre-filter declared by query script. Pre-filter is declared as metadata of global variable $query, for example:
+ *    global $query(class="Node,Sensor", name="srv-*");
+ * Objects not matching pre-filter are excluded before script execution.
  */
-static bool FilterAccessibleObjects(NetObj *object, void *data)
+struct ObjectQueryPrefilter
 {
-   return object->checkAccessRights(CAST_FROM_POINTER(data, UINT32), OBJECT_ACCESS_READ);
+   uint32_t userId;
+   IntegerArray<int> classes;
+   const TCHAR *namePattern;
+
+   ObjectQueryPrefilter(const NXSL_Program *program, uint32_t _userId) : classes(0, 16)
+   {
+      userId = _userId;
+      namePattern = program->getMetadataEntry(_T("$query.name"));
+      const TCHAR *classList = program->getMetadataEntry(_T("$query.class"));
+      if (classList != nullptr)
+      {
+         TCHAR *list = MemCopyString(classList);
+         StringList *names = String::split(list, _T(","), true);
+         for(int i = 0; i < names->size(); i++)
+         {
+            const TCHAR *name = names->get(i);
+            TCHAR *eptr;
+            int c = _tcstol(name, &eptr, 10);
+            classes.add(((*eptr == 0) && (*name != 0)) ? c : NetObj::getObjectClassByName(name));
+         }
+         delete names;
+         MemFree(list);
+      }
+   }
+};
+
+/**
+ * Filter objects accessible by given user and matching pre-filter
+ */
+static bool FilterAccessibleObjects(NetObj *object, ObjectQueryPrefilter *prefilter)
+{
+   if (!prefilter->classes.isEmpty() && !prefilter->classes.contains(object->getObjectClass()))
+      return false;
+   if ((prefilter->namePattern != nullptr) && !MatchString(prefilter->namePattern, object->getName(), false))
+      return false;
+   return object->checkAccessRights(prefilter->userId, OBJECT_ACCESS_READ);
 }
 
 /**
@@ -409,16 +446,18 @@ static inline const TCHAR *GetVariableMetadata(NXSL_VM *vm, const NXSL_Identifie
 }
 
 /**
- * Query objects
+ * Number of objects processed by single object query task
  */
-unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint32_t userId, TCHAR *errorMessage, size_t errorMessageLen,
-         bool readAllComputedFields, const StringList *fields, const StringList *orderBy, const StringMap *inputFields, uint32_t limit)
-{
-   NXSL_VM *vm = NXSLCompileAndCreateVM(query, errorMessage, errorMessageLen, new NXSL_ServerEnv());
-   if (vm == nullptr)
-      return unique_ptr<ObjectArray<ObjectQueryResult>>();
+#define OBJECT_QUERY_BATCH_SIZE  512
 
-   bool readFields = readAllComputedFields || (fields != nullptr);
+/**
+ * Create VM for object query from compiled program
+ */
+static NXSL_VM *CreateObjectQueryVM(const NXSL_Program *program)
+{
+   NXSL_VM *vm = new NXSL_VM(new NXSL_ServerEnv());
+   if (!vm->load(program))
+      return vm;  // Caller should check VM error state
 
    // Set class constants
    vm->addConstant("ACCESSPOINT", vm->createValue(OBJECT_ACCESSPOINT));
@@ -449,21 +488,90 @@ unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint
    vm->addConstant("TEMPLATEROOT", vm->createValue(OBJECT_TEMPLATEROOT));
    vm->addConstant("VPNCONNECTOR", vm->createValue(OBJECT_VPNCONNECTOR));
    vm->addConstant("ZONE", vm->createValue(OBJECT_ZONE));
+   return vm;
+}
 
-   unique_ptr<SharedObjectArray<NetObj>> objects = g_idxObjectById.getObjects(FilterAccessibleObjects);
-   auto resultSet = new ObjectArray<ObjectQueryResult>(64, 64, Ownership::True);
+/**
+ * Object query context shared by all batches
+ */
+struct ObjectQueryContext
+{
+   const NXSL_Program *program;
+   SharedObjectArray<NetObj> *objects;
+   const StringList *fields;
+   const StringMap *inputFields;
+   bool readAllComputedFields;
+   bool failed;
+   VolatileCounter outstandingBatches;
+   Condition completed;
+
+   ObjectQueryContext(const NXSL_Program *_program, SharedObjectArray<NetObj> *_objects, const StringList *_fields,
+            const StringMap *_inputFields, bool _readAllComputedFields, int numBatches) : completed(true)
+   {
+      program = _program;
+      objects = _objects;
+      fields = _fields;
+      inputFields = _inputFields;
+      readAllComputedFields = _readAllComputedFields;
+      failed = false;
+      outstandingBatches = numBatches;
+   }
+};
+
+/**
+ * Batch of objects for object query
+ */
+struct ObjectQueryBatch
+{
+   ObjectQueryContext *context;
+   int start;
+   int end;
+   ObjectArray<ObjectQueryResult> results;
    StringMap displayNameMapping;
+   TCHAR *errorMessage;
+
+   ObjectQueryBatch(ObjectQueryContext *_context, int _start, int _end) : results(64, 64, Ownership::True)
+   {
+      context = _context;
+      start = _start;
+      end = _end;
+      errorMessage = nullptr;
+   }
+
+   ~ObjectQueryBatch()
+   {
+      MemFree(errorMessage);
+   }
+};
+
+/**
+ * Execute object query on batch of objects. Each batch uses its own VM created from shared compiled program.
+ */
+static void ExecuteObjectQueryBatch(ObjectQueryBatch *batch)
+{
+   ObjectQueryContext *context = batch->context;
+   const StringList *fields = context->fields;
+   bool readAllComputedFields = context->readAllComputedFields;
+   bool readFields = readAllComputedFields || (fields != nullptr);
+
+   NXSL_VM *vm = CreateObjectQueryVM(context->program);
+   if (vm->getErrorCode() != NXSL_ERR_SUCCESS)
+   {
+      batch->errorMessage = MemCopyString(vm->getErrorText());
+      context->failed = true;
+   }
+
    bool firstResult = true;
-   for(int i = 0; i < objects->size(); i++)
+   for(int i = batch->start; (i < batch->end) && !context->failed; i++)
    {
-      shared_ptr<NetObj> curr = objects->getShared(i);
+      shared_ptr<NetObj> curr = context->objects->getShared(i);
 
       NXSL_VariableSystem *globals = nullptr;
-      int rc = FilterObject(vm, curr, inputFields, readFields ? &globals : nullptr);
+      int rc = FilterObject(vm, curr, context->inputFields, readFields ? &globals : nullptr);
       if (rc < 0)
       {
-         _tcslcpy(errorMessage, vm->getErrorText(), errorMessageLen);
-         delete_and_null(resultSet);
+         batch->errorMessage = MemCopyString(vm->getErrorText());
+         context->failed = true;
          delete globals;
          break;
       }
@@ -513,8 +621,9 @@ unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint
 
             if (readAllComputedFields)
             {
+               StringMap *displayNameMapping = &batch->displayNameMapping;
                globals->forEach(
-                  [vm, objectData, firstResult, &displayNameMapping] (const NXSL_Identifier& name, NXSL_Value *value) -> void
+                  [vm, objectData, firstResult, displayNameMapping] (const NXSL_Identifier& name, NXSL_Value *value) -> void
                   {
                      if (name.value[0] == '$')  // Ignore global variables set by system
                         return;
@@ -536,9 +645,9 @@ unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint
 #ifdef UNICODE
                            WCHAR wname[MAX_IDENTIFIER_LENGTH];
                            utf8_to_wchar(name.value, -1, wname, MAX_IDENTIFIER_LENGTH);
-                           displayNameMapping.set(displayName, wname);
+                           displayNameMapping->set(displayName, wname);
 #else
-                           displayNameMapping.set(displayName, name.value);
+                           displayNameMapping->set(displayName, name.value);
 #endif
                         }
                      }
@@ -558,13 +667,75 @@ unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint
             objectData = nullptr;
          }
 
-         resultSet->add(new ObjectQueryResult(curr, objectData));
+         batch->results.add(new ObjectQueryResult(curr, objectData));
          firstResult = false;
       }
       delete globals;
    }
 
-   // Sort result set, apply limit, remove hidden columns
+   delete vm;
+
+   if (InterlockedDecrement(&context->outstandingBatches) == 0)
+      context->completed.set();
+}
+
+/**
+ * Query objects. Filter script is compiled once and executed in parallel on batches of objects, each batch with its own VM.
+ * If offset and/or limit is given, only requested slice of sorted result set is returned. Total number of matching objects
+ * is returned in totalCount if it is not null.
+ */
+unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint32_t userId, TCHAR *errorMessage, size_t errorMessageLen,
+         bool readAllComputedFields, const StringList *fields, const StringList *orderBy, const StringMap *inputFields,
+         uint32_t limit, uint32_t offset, uint32_t *totalCount)
+{
+   NXSL_ServerEnv env;
+   NXSL_Program *program = NXSLCompile(query, errorMessage, errorMessageLen, nullptr, &env);
+   if (program == nullptr)
+      return unique_ptr<ObjectArray<ObjectQueryResult>>();
+
+   ObjectQueryPrefilter prefilter(program, userId);
+   unique_ptr<SharedObjectArray<NetObj>> objects = g_idxObjectById.getObjects(FilterAccessibleObjects, &prefilter);
+
+   int numBatches = std::max((objects->size() + OBJECT_QUERY_BATCH_SIZE - 1) / OBJECT_QUERY_BATCH_SIZE, 1);
+   ObjectQueryContext context(program, objects.get(), fields, inputFields, readAllComputedFields, numBatches);
+   ObjectArray<ObjectQueryBatch> batches(numBatches, 16, Ownership::True);
+   for(int i = 0; i < numBatches; i++)
+      batches.add(new ObjectQueryBatch(&context, i * OBJECT_QUERY_BATCH_SIZE, std::min((i + 1) * OBJECT_QUERY_BATCH_SIZE, objects->size())));
+
+   if (numBatches > 1)
+   {
+      for(int i = 0; i < numBatches; i++)
+         ThreadPoolExecute(g_mainThreadPool, ExecuteObjectQueryBatch, batches.get(i));
+      context.completed.wait(INFINITE);
+      nxlog_debug(6, _T("QueryObjects: %d objects processed in %d batches"), objects->size(), numBatches);
+   }
+   else
+   {
+      ExecuteObjectQueryBatch(batches.get(0));
+   }
+
+   // Merge results in original object order
+   auto resultSet = new ObjectArray<ObjectQueryResult>(64, 64, Ownership::True);
+   StringMap displayNameMapping;
+   for(int i = 0; i < numBatches; i++)
+   {
+      ObjectQueryBatch *batch = batches.get(i);
+      if (batch->errorMessage != nullptr)
+      {
+         _tcslcpy(errorMessage, batch->errorMessage, errorMessageLen);
+         delete_and_null(resultSet);
+         break;
+      }
+      for(int j = 0; j < batch->results.size(); j++)
+         resultSet->add(batch->results.get(j));
+      batch->results.setOwner(Ownership::False);
+      displayNameMapping.addAll(&batch->displayNameMapping);
+   }
+
+   if (totalCount != nullptr)
+      *totalCount = (resultSet != nullptr) ? resultSet->size() : 0;
+
+   // Sort result set, apply paging, remove hidden columns
    if ((resultSet != nullptr) && !resultSet->isEmpty())
    {
       StringList realOrderBy;
@@ -578,8 +749,7 @@ unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint
          const TCHAR *originalName = displayNameMapping.get(columnName);
          TCHAR key[256];
          _sntprintf(key, 256, _T("%s.order"), (originalName != nullptr) ? originalName : columnName);
-         const TCHAR *order = vm->getMetadataEntry(key);
-nxlog_debug(1, _T(">>> name='%s' orig='%s' order='%s'"), columnName, originalName, order);
+         const TCHAR *order = program->getMetadataEntry(key);
          if (order != nullptr)
          {
             if (!_tcsicmp(order, _T("asc")) || !_tcsicmp(order, _T("ascending")))
@@ -600,7 +770,22 @@ nxlog_debug(1, _T(">>> name='%s' orig='%s' order='%s'"), columnName, originalNam
       {
          resultSet->sort(ObjectQueryComparator, &realOrderBy);
       }
-      if (limit > 0)
+      if (offset > 0)
+      {
+         auto page = new ObjectArray<ObjectQueryResult>(64, 64, Ownership::True);
+         int end = (limit > 0) ? std::min(static_cast<int>(offset + limit), resultSet->size()) : resultSet->size();
+         for(int i = 0; i < resultSet->size(); i++)
+         {
+            if ((i >= static_cast<int>(offset)) && (i < end))
+               page->add(resultSet->get(i));
+            else
+               delete resultSet->get(i);
+         }
+         resultSet->setOwner(Ownership::False);
+         delete resultSet;
+         resultSet = page;
+      }
+      else if (limit > 0)
       {
          resultSet->shrinkTo((int)limit);
       }
@@ -609,7 +794,7 @@ nxlog_debug(1, _T(">>> name='%s' orig='%s' order='%s'"), columnName, originalNam
       {
          TCHAR key[256];
          _sntprintf(key, 256, _T("%s.visible"), columns->get(i));
-         const TCHAR *visible = vm->getMetadataEntry(key);
+         const TCHAR *visible = program->getMetadataEntry(key);
          if ((visible != nullptr) && (!_tcscmp(visible, _T("false")) || !_tcscmp(visible, _T("0"))))
          {
             for(int j = 0; j < resultSet->size(); j++)
@@ -621,7 +806,7 @@ nxlog_debug(1, _T(">>> name='%s' orig='%s' order='%s'"), columnName, originalNam
       delete columns;
    }
 
-   delete vm;
+   delete program;
 
    return unique_ptr<ObjectArray<ObjectQueryResult>>(resultSet);
 }
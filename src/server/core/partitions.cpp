@@ -0,0 +1,325 @@
+/*
+** NetXMS - Network Management System
+** Copyright (C) 2003-2023 Raden Solutions
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: partitions.cpp
+**
+**/
+
+#include "nxcore.h"
+
+#define DEBUG_TAG _T("db.partitions")
+
+/**
+ * Partition interval (one day)
+ */
+#define PARTITION_INTERVAL    86400
+
+/**
+ * Number of partitions created in advance
+ */
+#define PARTITIONS_AHEAD      7
+
+/**
+ * Table that can be partitioned by timestamp
+ */
+struct PartitionCandidate
+{
+   const TCHAR *name;
+   const TCHAR *timestampColumn;
+};
+
+/**
+ * Tables that can be partitioned by timestamp
+ */
+static PartitionCandidate s_partitionCandidates[] =
+{
+   { _T("idata"), _T("idata_timestamp") },
+   { _T("tdata"), _T("tdata_timestamp") },
+   { _T("event_log"), _T("event_timestamp") },
+   { _T("snmp_trap_log"), _T("trap_timestamp") },
+   { _T("syslog"), _T("msg_timestamp") },
+   { nullptr, nullptr }
+};
+
+/**
+ * Tables detected as partitioned
+ */
+static StringSet s_partitionedTables;
+static Mutex s_partitionedTablesLock(MutexType::FAST);
+
+/**
+ * Build partition name for given start time. PostgreSQL partitions are separate tables, so table name is used as prefix.
+ */
+static void BuildPartitionName(const TCHAR *table, time_t start, TCHAR *name)
+{
+#if HAVE_GMTIME_R
+   struct tm tmBuffer;
+   struct tm *t = gmtime_r(&start, &tmBuffer);
+#else
+   struct tm *t = gmtime(&start);
+#endif
+   if (g_dbSyntax == DB_SYNTAX_MYSQL)
+      _sntprintf(name, 64, _T("p%04d%02d%02d"), t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+   else
+      _sntprintf(name, 64, _T("%s_p%04d%02d%02d"), table, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+}
+
+/**
+ * Parse partition name and return partition start time or 0 if name is not in expected format
+ */
+static time_t ParsePartitionName(const TCHAR *name)
+{
+   size_t len = _tcslen(name);
+   if ((len < 9) || (name[len - 9] != _T('p')))
+      return 0;
+
+   const TCHAR *date = &name[len - 8];
+   for(int i = 0; i < 8; i++)
+      if (!_istdigit(date[i]))
+         return 0;
+
+   struct tm t;
+   memset(&t, 0, sizeof(t));
+   t.tm_year = (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0') - 1900;
+   t.tm_mon = (date[4] - '0') * 10 + (date[5] - '0') - 1;
+   t.tm_mday = (date[6] - '0') * 10 + (date[7] - '0');
+   return timegm(&t);
+}
+
+/**
+ * Get start times of all existing partitions for given table. Returns false on database error.
+ */
+static bool GetTablePartitions(DB_HANDLE hdb, const TCHAR *table, IntegerArray<int64_t> *partitions)
+{
+   TCHAR query[512];
+   if (g_dbSyntax == DB_SYNTAX_MYSQL)
+      _sntprintf(query, 512, _T("SELECT partition_name FROM information_schema.partitions WHERE table_schema=database() AND table_name='%s' AND partition_name IS NOT NULL"), table);
+   else
+      _sntprintf(query, 512, _T("SELECT c.relname FROM pg_inherits i INNER JOIN pg_class c ON c.oid=i.inhrelid INNER JOIN pg_class p ON p.oid=i.inhparent WHERE p.relname='%s'"), table);
+
+   DB_RESULT hResult = DBSelect(hdb, query);
+   if (hResult == nullptr)
+      return false;
+
+   int count = DBGetNumRows(hResult);
+   for(int i = 0; i < count; i++)
+   {
+      TCHAR name[256];
+      DBGetField(hResult, i, 0, name, 256);
+      time_t start = ParsePartitionName(name);
+      if (start != 0)
+         partitions->add(static_cast<int64_t>(start));
+   }
+   DBFreeResult(hResult);
+
+   partitions->sortAscending();
+   return true;
+}
+
+/**
+ * Get number of records in default partition (PostgreSQL only) within given time range. Returns 0 if there is no default partition.
+ */
+static int64_t GetDefaultPartitionRecordCount(DB_HANDLE hdb, const PartitionCandidate *table, time_t start)
+{
+   TCHAR query[512];
+   _sntprintf(query, 512, _T("SELECT count(*) FROM pg_class WHERE relname='%s_pdefault'"), table->name);
+   DB_RESULT hResult = DBSelect(hdb, query);
+   if (hResult == nullptr)
+      return 0;
+   bool exists = (DBGetFieldLong(hResult, 0, 0) > 0);
+   DBFreeResult(hResult);
+   if (!exists)
+      return 0;
+
+   _sntprintf(query, 512, _T("SELECT count(*) FROM %s_pdefault WHERE %s>=") INT64_FMT _T(" AND %s<") INT64_FMT,
+            table->name, table->timestampColumn, static_cast<int64_t>(start), table->timestampColumn, static_cast<int64_t>(start + PARTITION_INTERVAL));
+   hResult = DBSelect(hdb, query);
+   if (hResult == nullptr)
+      return 0;
+   int64_t count = DBGetFieldInt64(hResult, 0, 0);
+   DBFreeResult(hResult);
+   return count;
+}
+
+/**
+ * Create partition starting at given time - PostgreSQL version. If default partition already contains records
+ * within new partition's range, it is detached while new partition is created and these records are moved into it.
+ */
+static bool CreatePartition_PGSQL(DB_HANDLE hdb, const PartitionCandidate *table, time_t start, const TCHAR *name)
+{
+   TCHAR query[512];
+   _sntprintf(query, 512, _T("CREATE TABLE %s PARTITION OF %s FOR VALUES FROM (") INT64_FMT _T(") TO (") INT64_FMT _T(")"),
+            name, table->name, static_cast<int64_t>(start), static_cast<int64_t>(start + PARTITION_INTERVAL));
+
+   int64_t conflictingRecords = GetDefaultPartitionRecordCount(hdb, table, start);
+   if (conflictingRecords == 0)
+      return DBQuery(hdb, query);
+
+   nxlog_debug_tag(DEBUG_TAG, 3, _T("Moving ") INT64_FMT _T(" records from default partition of table %s to new partition %s"), conflictingRecords, table->name, name);
+   if (!DBBegin(hdb))
+      return false;
+
+   TCHAR moveQuery[512];
+   _sntprintf(moveQuery, 512, _T("ALTER TABLE %s DETACH PARTITION %s_pdefault"), table->name, table->name);
+   bool success = DBQuery(hdb, moveQuery) && DBQuery(hdb, query);
+   if (success)
+   {
+      _sntprintf(moveQuery, 512, _T("INSERT INTO %s SELECT * FROM %s_pdefault WHERE %s>=") INT64_FMT _T(" AND %s<") INT64_FMT,
+               table->name, table->name, table->timestampColumn, static_cast<int64_t>(start), table->timestampColumn, static_cast<int64_t>(start + PARTITION_INTERVAL));
+      success = DBQuery(hdb, moveQuery);
+   }
+   if (success)
+   {
+      _sntprintf(moveQuery, 512, _T("DELETE FROM %s_pdefault WHERE %s>=") INT64_FMT _T(" AND %s<") INT64_FMT,
+               table->name, table->timestampColumn, static_cast<int64_t>(start), table->timestampColumn, static_cast<int64_t>(start + PARTITION_INTERVAL));
+      success = DBQuery(hdb, moveQuery);
+   }
+   if (success)
+   {
+      _sntprintf(moveQuery, 512, _T("ALTER TABLE %s ATTACH PARTITION %s_pdefault DEFAULT"), table->name, table->name);
+      success = DBQuery(hdb, moveQuery);
+   }
+
+   if (success)
+      DBCommit(hdb);
+   else
+      DBRollback(hdb);
+   return success;
+}
+
+/**
+ * Create partition starting at given time
+ */
+static bool CreatePartition(DB_HANDLE hdb, const PartitionCandidate *table, time_t start)
+{
+   TCHAR name[64];
+   BuildPartitionName(table->name, start, name);
+   bool success;
+   if (g_dbSyntax == DB_SYNTAX_MYSQL)
+   {
+      TCHAR query[512];
+      _sntprintf(query, 512, _T("ALTER TABLE %s REORGANIZE PARTITION pmax INTO (PARTITION %s VALUES LESS THAN (") INT64_FMT _T("), PARTITION pmax VALUES LESS THAN MAXVALUE)"),
+               table->name, name, static_cast<int64_t>(start + PARTITION_INTERVAL));
+      success = DBQuery(hdb, query);
+   }
+   else
+   {
+      success = CreatePartition_PGSQL(hdb, table, start, name);
+   }
+   nxlog_debug_tag(DEBUG_TAG, success ? 4 : 2, _T("%s partition %s for table %s"), success ? _T("Created") : _T("Cannot create"), name, table->name);
+   return success;
+}
+
+/**
+ * Drop partition starting at given time
+ */
+static bool DropPartition(DB_HANDLE hdb, const TCHAR *table, time_t start)
+{
+   TCHAR name[64], query[256];
+   BuildPartitionName(table, start, name);
+   if (g_dbSyntax == DB_SYNTAX_MYSQL)
+      _sntprintf(query, 256, _T("ALTER TABLE %s DROP PARTITION %s"), table, name);
+   else
+      _sntprintf(query, 256, _T("DROP TABLE %s"), name);
+   bool success = DBQuery(hdb, query);
+   nxlog_debug_tag(DEBUG_TAG, success ? 4 : 2, _T("%s partition %s for table %s"), success ? _T("Dropped") : _T("Cannot drop"), name, table);
+   return success;
+}
+
+/**
+ * Check if given table is partitioned by timestamp
+ */
+bool IsPartitionedTable(const TCHAR *table)
+{
+   if (!(g_flags & AF_PARTITIONED_TABLES))
+      return false;
+
+   s_partitionedTablesLock.lock();
+   bool result = s_partitionedTables.contains(table);
+   s_partitionedTablesLock.unlock();
+   return result;
+}
+
+/**
+ * Detect partitioned tables and make sure that partitions for upcoming days exist
+ */
+void MaintainTablePartitions(DB_HANDLE hdb)
+{
+   if (!(g_flags & AF_PARTITIONED_TABLES))
+      return;
+
+   time_t today = time(nullptr) / PARTITION_INTERVAL * PARTITION_INTERVAL;
+   for(int i = 0; s_partitionCandidates[i].name != nullptr; i++)
+   {
+      const PartitionCandidate *candidate = &s_partitionCandidates[i];
+      const TCHAR *table = candidate->name;
+      IntegerArray<int64_t> partitions(64, 64);
+      if (!GetTablePartitions(hdb, table, &partitions))
+         continue;
+
+      if (partitions.isEmpty())
+      {
+         nxlog_debug_tag(DEBUG_TAG, 4, _T("Table %s is not partitioned"), table);
+         s_partitionedTablesLock.lock();
+         s_partitionedTables.remove(table);
+         s_partitionedTablesLock.unlock();
+         continue;
+      }
+
+      s_partitionedTablesLock.lock();
+      s_partitionedTables.add(table);
+      s_partitionedTablesLock.unlock();
+
+      // On MySQL partitions can only be added after last one, on PostgreSQL any missing partition within upcoming days
+      // is created, so range that failed to create will be retried on next maintenance run
+      time_t lastPartition = static_cast<time_t>(partitions.get(partitions.size() - 1));
+      for(time_t next = today; next <= today + PARTITIONS_AHEAD * PARTITION_INTERVAL; next += PARTITION_INTERVAL)
+      {
+         if ((g_dbSyntax == DB_SYNTAX_MYSQL) ? (next <= lastPartition) : partitions.contains(static_cast<int64_t>(next)))
+            continue;
+         if (!CreatePartition(hdb, candidate, next))
+            nxlog_write_tag(NXLOG_WARNING, DEBUG_TAG, _T("Cannot create partition for table %s starting at ") INT64_FMT, table, static_cast<int64_t>(next));
+      }
+   }
+}
+
+/**
+ * Drop partitions of given table that contain only records older than given cutoff time. Returns number of dropped partitions.
+ */
+int DropExpiredPartitions(DB_HANDLE hdb, const TCHAR *table, time_t cutoffTime)
+{
+   if (!IsPartitionedTable(table))
+      return 0;
+
+   IntegerArray<int64_t> partitions(64, 64);
+   if (!GetTablePartitions(hdb, table, &partitions))
+      return 0;
+
+   int count = 0;
+   for(int i = 0; i < partitions.size(); i++)
+   {
+      time_t start = static_cast<time_t>(partitions.get(i));
+      if (start + PARTITION_INTERVAL > cutoffTime)
+         break;
+      if (DropPartition(hdb, table, start))
+         count++;
+   }
+   if (count > 0)
+      nxlog_debug_tag(DEBUG_TAG, 3, _T("%d expired partitions dropped from table %s"), count, table);
+   return count;
+}
@@ -118,10 +118,11 @@ static ScriptVMFailureReason ScriptValidator(NXSL_LibraryScript *script)
 
 /**
  * Create NXSL VM from library script. Created VM will take ownership of DCI descriptor.
+ * VM is taken from library VM pool and will be returned to it when handle's destroy() method is called.
  */
 ScriptVMHandle NXCORE_EXPORTABLE CreateServerScriptVM(const TCHAR *name, const shared_ptr<NetObj>& object, const shared_ptr<DCObjectInfo>& dciInfo)
 {
-   ScriptVMHandle vm = s_scriptLibrary.createVM(name, [] { return new NXSL_ServerEnv(); }, ScriptValidator);
+   ScriptVMHandle vm = s_scriptLibrary.createVM(name, [] { return new NXSL_ServerEnv(); }, ScriptValidator, true);
    if (vm.isValid())
       SetupServerScriptVM(vm, object, dciInfo);
    return vm;
@@ -129,20 +130,27 @@ ScriptVMHandle NXCORE_EXPORTABLE CreateServerScriptVM(const TCHAR *name, const s
 
 /**
  * Create NXSL VM from compiled script. Created VM will take ownership of DCI descriptor.
+ * VM is taken from library VM pool and will be returned to it when handle's destroy() method is called.
  */
 ScriptVMHandle NXCORE_EXPORTABLE CreateServerScriptVM(const NXSL_Program *script, const shared_ptr<NetObj>& object, const shared_ptr<DCObjectInfo>& dciInfo)
 {
    if (script->isEmpty())
       return ScriptVMHandle(ScriptVMFailureReason::SCRIPT_IS_EMPTY);
 
-   NXSL_VM *vm = new NXSL_VM(new NXSL_ServerEnv());
-   if (!vm->load(script))
-   {
-      delete vm;
-      return ScriptVMHandle(ScriptVMFailureReason::SCRIPT_LOAD_ERROR);
-   }
+   ScriptVMHandle vm = s_scriptLibrary.acquireVM(script, [] { return new NXSL_ServerEnv(); });
+   if (vm.isValid())
+      SetupServerScriptVM(vm, object, dciInfo);
+   return vm;
+}
 
-   return ScriptVMHandle(SetupServerScriptVM(vm, object, dciInfo));
+/**
+ * Destroy script VMs idle for too long
+ */
+static void PurgeScriptVMPool()
+{
+   s_scriptLibrary.purgeVMPool(300);
+   nxlog_debug_tag(DEBUG_TAG_BASE, 7, _T("Script VM pool purged (%d idle VMs remaining)"), s_scriptLibrary.getVMPoolSize());
+   ThreadPoolScheduleRelative(g_mainThreadPool, 300000, PurgeScriptVMPool);
 }
 
 /**
@@ -172,6 +180,9 @@ void LoadScripts()
       DBFreeResult(hResult);
    }
    DBConnectionPoolReleaseConnection(hdb);
+
+   s_scriptLibrary.setVMPoolLimits(ConfigReadInt(_T("NXSL.VMPool.SizePerScript"), 8), ConfigReadInt(_T("NXSL.VMPool.TotalSize"), 1024));
+   ThreadPoolScheduleRelative(g_mainThreadPool, 300000, PurgeScriptVMPool);
 }
 
 /**
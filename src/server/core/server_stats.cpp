@@ -39,8 +39,6 @@
 /**
  * Externals
  */
-extern ObjectQueue<SyslogMessage> g_syslogProcessingQueue;
-extern ObjectQueue<SyslogMessage> g_syslogWriteQueue;
 extern ObjectQueue<WindowsEvent> g_windowsEventProcessingQueue;
 extern ObjectQueue<WindowsEvent> g_windowsEventWriterQueue;
 extern ThreadPool *g_dataCollectorThreadPool;
@@ -49,6 +47,8 @@ extern ThreadPool *g_schedulerThreadPool;
 
 int64_t GetEventLogWriterQueueSize();
 int64_t GetEventProcessorQueueSize();
+int64_t GetSyslogProcessingQueueSize();
+int64_t GetSyslogWriterQueueSize();
 
 /**
  * Internal queue statistic
@@ -102,7 +102,7 @@ inline void AddQueueToCollector(const TCHAR *name, int64_t (*function)())
  */
 static int64_t GetTotalDBWriterQueueSize()
 {
-   return GetIDataWriterQueueSize() + GetRawDataWriterQueueSize() + g_dbWriterQueue.size();
+   return GetIDataWriterQueueSize() + GetTDataWriterQueueSize() + GetRawDataWriterQueueSize() + g_dbWriterQueue.size();
 }
 
 /**
@@ -117,14 +117,15 @@ void ServerStatCollector()
    AddQueueToCollector(_T("DBWriter.IData"), GetIDataWriterQueueSize);
    AddQueueToCollector(_T("DBWriter.Other"), &g_dbWriterQueue);
    AddQueueToCollector(_T("DBWriter.RawData"), GetRawDataWriterQueueSize);
+   AddQueueToCollector(_T("DBWriter.TData"), GetTDataWriterQueueSize);
    AddQueueToCollector(_T("DBWriter.Total"), GetTotalDBWriterQueueSize);
    AddQueueToCollector(_T("EventLogWriter"), GetEventLogWriterQueueSize);
    AddQueueToCollector(_T("EventProcessor"), GetEventProcessorQueueSize);
    AddQueueToCollector(_T("NodeDiscoveryPoller"), GetDiscoveryPollerQueueSize);
    AddQueueToCollector(_T("Poller"), g_pollerThreadPool);
    AddQueueToCollector(_T("Scheduler"), g_schedulerThreadPool);
-   AddQueueToCollector(_T("SyslogProcessor"), &g_syslogProcessingQueue);
-   AddQueueToCollector(_T("SyslogWriter"), &g_syslogWriteQueue);
+   AddQueueToCollector(_T("SyslogProcessor"), GetSyslogProcessingQueueSize);
+   AddQueueToCollector(_T("SyslogWriter"), GetSyslogWriterQueueSize);
    AddQueueToCollector(_T("TemplateUpdater"), &g_templateUpdateQueue);
    AddQueueToCollector(_T("WindowsEventProcessor"), &g_windowsEventProcessingQueue);
    AddQueueToCollector(_T("WindowsEventWriter"), &g_windowsEventWriterQueue);
@@ -659,7 +659,7 @@ void ClientSession::processFileTransferMessage(NXCPMessage *msg)
                int fd = _topen(ft->fileName, O_CREAT | O_APPEND | O_WRONLY | O_BINARY, S_IRUSR | S_IWUSR);
                if (fd != -1)
                {
-                  NXCP_MESSAGE *data = msg->serialize(ft->connection->isCompressionAllowed());
+                  NXCP_MESSAGE *data = msg->serialize(ft->connection->getMessageCompressionMethod());
                   int bytes = static_cast<int>(ntohl(data->size));
                   success = (_write(fd, data, bytes) == bytes);
                   _close(fd);
@@ -2859,10 +2859,13 @@ void ClientSession::queryObjectDetails(const NXCPMessage& request)
    StringList orderBy(request, VID_ORDER_FIELD_LIST_BASE, VID_ORDER_FIELDS);
    StringMap inputFields(request, VID_INPUT_FIELD_BASE, VID_INPUT_FIELD_COUNT);
    TCHAR errorMessage[1024];
+   uint32_t totalCount = 0;
    unique_ptr<ObjectArray<ObjectQueryResult>> objects = QueryObjects(query, m_dwUserId, errorMessage, 1024,
-            request.getFieldAsBoolean(VID_READ_ALL_FIELDS), &fields, &orderBy, &inputFields, request.getFieldAsUInt32(VID_RECORD_LIMIT));
+            request.getFieldAsBoolean(VID_READ_ALL_FIELDS), &fields, &orderBy, &inputFields, request.getFieldAsUInt32(VID_RECORD_LIMIT),
+            request.getFieldAsUInt32(VID_START_ROW), &totalCount);
    if (objects != nullptr)
    {
+      response.setField(VID_NUM_RECORDS, totalCount);
       uint32_t *idList = static_cast<uint32_t*>MemAllocLocal(objects->size() * sizeof(uint32_t));
       uint32_t fieldId = VID_ELEMENT_LIST_BASE;
       for(int i = 0; i < objects->size(); i++)
@@ -4803,7 +4806,7 @@ static void ProcessDataSelectResults(DB_UNBUFFERED_RESULT hResult, ClientSession
          char *encodedTable = DBGetFieldUTF8(hResult, 1, nullptr, 0);
          if (encodedTable != nullptr)
          {
-            Table *table = Table::createFromPackedXML(encodedTable);
+            Table *table = Table::createFromPackedData(encodedTable);
             if (table != nullptr)
             {
                int row = table->findRowByInstance(instance);
@@ -4870,7 +4873,7 @@ static void ProcessTableDataSelectResults(DB_UNBUFFERED_RESULT hResult, ClientSe
       char *encodedTable = DBGetFieldUTF8(hResult, 1, nullptr, 0);
       if (encodedTable != nullptr)
       {
-         Table *table = Table::createFromPackedXML(encodedTable);
+         Table *table = Table::createFromPackedData(encodedTable);
          if (table != nullptr)
          {
             msg.setField(VID_TIMESTAMP, DBGetFieldULong(hResult, 0));
@@ -10660,7 +10663,7 @@ void ClientSession::registerAgent(const NXCPMessage& request)
       {
          DiscoveredAddress *info = new DiscoveredAddress(m_clientAddr, zoneUIN, 0, DA_SRC_AGENT_REGISTRATION);
          info->ignoreFilter = true;		// Ignore discovery filters and add node anyway
-         g_nodePollerQueue.put(info);
+         QueueDiscoveredAddress(info);
       }
       response.setField(VID_RCC, RCC_SUCCESS);
 	}
@@ -154,6 +154,83 @@ unique_ptr<StringList> SnmpGetKnownCommunities(int32_t zoneUIN)
    return unique_ptr<StringList>(communities);
 }
 
+/**
+ * State of parallel community probe
+ */
+struct CommunityProbeState
+{
+   Mutex lock;
+   Condition completed;
+   VolatileCounter pending;
+   int match;
+
+   CommunityProbeState(int count) : lock(MutexType::FAST), completed(true)
+   {
+      pending = count;
+      match = -1;
+   }
+};
+
+/**
+ * Single request within parallel community probe
+ */
+struct CommunityProbeRequest
+{
+   CommunityProbeState *state;
+   int index;
+};
+
+/**
+ * Completion callback for parallel community probe
+ */
+static void CommunityProbeCallback(uint32_t rcc, SNMP_PDU *response, void *context)
+{
+   auto request = static_cast<CommunityProbeRequest*>(context);
+   CommunityProbeState *state = request->state;
+   bool success = (rcc == SNMP_ERR_SUCCESS) &&
+            ((response->getErrorCode() == SNMP_PDU_ERR_SUCCESS) || (response->getErrorCode() == SNMP_PDU_ERR_NO_SUCH_NAME));
+   delete response;
+
+   state->lock.lock();
+   if (success && ((state->match == -1) || (request->index < state->match)))
+      state->match = request->index;
+   state->lock.unlock();
+
+   if (InterlockedDecrement(&state->pending) == 0)
+      state->completed.set();
+}
+
+/**
+ * Send test request with all given communities at once (requests are multiplexed by asynchronous SNMP engine).
+ * Returns index of first community in list order that got response or -1 if there were no valid responses.
+ */
+static int SnmpProbeCommunities(SNMP_Transport *transport, const StringList& communities, const StringList& testOids)
+{
+   if (communities.isEmpty() || testOids.isEmpty())
+      return -1;
+
+   CommunityProbeState state(communities.size());
+   CommunityProbeRequest *requests = MemAllocArrayNoInit<CommunityProbeRequest>(communities.size());
+   SNMP_PDU request(SNMP_GET_REQUEST, 0, transport->getSnmpVersion());
+   request.bindVariable(new SNMP_Variable(testOids.get(0)));
+   for(int i = 0; i < communities.size(); i++)
+   {
+      requests[i].state = &state;
+      requests[i].index = i;
+#ifdef UNICODE
+      char *community = MBStringFromWideString(communities.get(i));
+      transport->setSecurityContext(new SNMP_SecurityContext(community));
+      MemFree(community);
+#else
+      transport->setSecurityContext(new SNMP_SecurityContext(communities.get(i)));
+#endif
+      transport->doRequestAsync(&request, CommunityProbeCallback, &requests[i]);
+   }
+   state.completed.wait(INFINITE);
+   MemFree(requests);
+   return state.match;
+}
+
 /**
  * Check SNMP v3 connectivity
  */
@@ -320,6 +397,44 @@ SNMP_Transport *SnmpCheckCommSettings(uint32_t snmpProxy, const InetAddress& ipA
 
       pTransport->setSnmpVersion((initialDiscovery && (g_flags & AF_DISABLE_SNMP_V2_PROBE)) ? SNMP_VERSION_1 : SNMP_VERSION_2C);
 restart_check:
+      if (!pTransport->isProxyTransport())
+      {
+         // Probe all candidate communities in parallel and then verify only the one that responded
+         if (communities == nullptr)
+            communities = SnmpGetKnownCommunities(zoneUIN);
+
+         StringList candidates;
+         if ((originalContext != nullptr) && (originalContext->getSecurityModel() != SNMP_SECURITY_MODEL_USM))
+            candidates.addMBString(originalContext->getCommunity());
+         for(int i = 0; i < communities->size(); i++)
+         {
+            if (!candidates.contains(communities->get(i)))
+               candidates.add(communities->get(i));
+         }
+
+         nxlog_debug_tag(DEBUG_TAG_SNMP_DISCOVERY, 5, _T("SnmpCheckCommSettings(%s): probing %d communities with version %d"),
+                  ipAddrText, candidates.size(), pTransport->getSnmpVersion());
+         int index = SnmpProbeCommunities(pTransport, candidates, testOids);
+         if (index != -1)
+         {
+            nxlog_debug_tag(DEBUG_TAG_SNMP_DISCOVERY, 5, _T("SnmpCheckCommSettings(%s): trying version %d community '%s'"),
+                     ipAddrText, pTransport->getSnmpVersion(), candidates.get(index));
+#ifdef UNICODE
+            char *community = MBStringFromWideString(candidates.get(index));
+            pTransport->setSecurityContext(new SNMP_SecurityContext(community));
+            MemFree(community);
+#else
+            pTransport->setSecurityContext(new SNMP_SecurityContext(candidates.get(index)));
+#endif
+            if (SnmpTestRequest(pTransport, testOids, separateRequests))
+            {
+               *version = pTransport->getSnmpVersion();
+               goto success;
+            }
+         }
+         goto next_version;
+      }
+
       // Check current community first
       if ((originalContext != nullptr) && (originalContext->getSecurityModel() != SNMP_SECURITY_MODEL_USM))
       {
@@ -368,6 +483,7 @@ SNMP_Transport *SnmpCheckCommSettings(uint32_t snmpProxy, const InetAddress& ipA
 #endif
       }
 
+next_version:
       if ((pTransport->getSnmpVersion() == SNMP_VERSION_2C) && !IsShutdownInProgress() && !(initialDiscovery && (g_flags & AF_DISABLE_SNMP_V1_PROBE)))
       {
          pTransport->setSnmpVersion(SNMP_VERSION_1);
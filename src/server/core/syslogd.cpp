@@ -32,11 +32,17 @@
  */
 #define MAX_SYSLOG_MSG_LEN    1024
 
+/**
+ * Syslog queue capacity. Producers block when queue is full, so receiver stops reading from socket
+ * instead of consuming unbounded amount of memory when processing or writing falls behind.
+ */
+#define SYSLOG_QUEUE_CAPACITY    65536
+
 /**
  * Queues
  */
-ObjectQueue<SyslogMessage> g_syslogProcessingQueue(1024, Ownership::False);
-ObjectQueue<SyslogMessage> g_syslogWriteQueue(1024, Ownership::False);
+static BoundedObjectQueue<SyslogMessage> s_syslogProcessingQueue(SYSLOG_QUEUE_CAPACITY, Ownership::False);
+static BoundedObjectQueue<SyslogMessage> s_syslogWriteQueue(SYSLOG_QUEUE_CAPACITY, Ownership::False);
 
 /**
  * Total number of received syslog messages
@@ -364,64 +370,62 @@ static void SyslogWriterThread()
 {
    ThreadSetName("SyslogWriter");
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Syslog writer thread started"));
-   int maxRecords = ConfigReadInt(_T("DBWriter.MaxRecordsPerTransaction"), 1000);
+   int maxRecords = std::max(ConfigReadInt(_T("DBWriter.MaxRecordsPerTransaction"), 1000), 1);
+   SyslogMessage **batch = MemAllocArrayNoInit<SyslogMessage*>(maxRecords);
    while(true)
    {
-      SyslogMessage *msg = g_syslogWriteQueue.getOrBlock();
+      SyslogMessage *msg = s_syslogWriteQueue.getOrBlock();
       if (msg == INVALID_POINTER_VALUE)
          break;
 
-      DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
+      batch[0] = msg;
+      int count = static_cast<int>(s_syslogWriteQueue.getAll(&batch[1], maxRecords - 1)) + 1;
 
+      // Shutdown marker can only be the last element taken from queue
+      bool stop = (batch[count - 1] == INVALID_POINTER_VALUE);
+      if (stop)
+         count--;
+
+      DB_HANDLE hdb = DBConnectionPoolAcquireConnection();
       DB_STATEMENT hStmt = DBPrepare(hdb,
                (g_dbSyntax == DB_SYNTAX_TSDB) ?
                         _T("INSERT INTO syslog (msg_id,msg_timestamp,facility,severity,source_object_id,zone_uin,hostname,msg_tag,msg_text) VALUES (?,to_timestamp(?),?,?,?,?,?,?,?)") :
                         _T("INSERT INTO syslog (msg_id,msg_timestamp,facility,severity,source_object_id,zone_uin,hostname,msg_tag,msg_text) VALUES (?,?,?,?,?,?,?,?,?)"), true);
-      if (hStmt == nullptr)
-      {
-         delete msg;
-         DBConnectionPoolReleaseConnection(hdb);
-         continue;
-      }
-
-      int count = 0;
-      DBBegin(hdb);
-      while(true)
+      if (hStmt != nullptr)
       {
-         DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, msg->getId());
-         DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, static_cast<uint32_t>(msg->getTimestamp()));
-         DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, msg->getFacility());
-         DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, msg->getSeverity());
-         DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, msg->getNodeId());
-         DBBind(hStmt, 6, DB_SQLTYPE_INTEGER, msg->getZoneUIN());
+         DBBegin(hdb);
+         for(int i = 0; i < count; i++)
+         {
+            msg = batch[i];
+            DBBind(hStmt, 1, DB_SQLTYPE_BIGINT, msg->getId());
+            DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, static_cast<uint32_t>(msg->getTimestamp()));
+            DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, msg->getFacility());
+            DBBind(hStmt, 4, DB_SQLTYPE_INTEGER, msg->getSeverity());
+            DBBind(hStmt, 5, DB_SQLTYPE_INTEGER, msg->getNodeId());
+            DBBind(hStmt, 6, DB_SQLTYPE_INTEGER, msg->getZoneUIN());
 #ifdef UNICODE
-         DBBind(hStmt, 7, DB_SQLTYPE_VARCHAR, WideStringFromMBString(msg->getHostName()), DB_BIND_DYNAMIC);
-         DBBind(hStmt, 8, DB_SQLTYPE_VARCHAR, WideStringFromMBString(msg->getTag()), DB_BIND_DYNAMIC);
+            DBBind(hStmt, 7, DB_SQLTYPE_VARCHAR, WideStringFromMBString(msg->getHostName()), DB_BIND_DYNAMIC);
+            DBBind(hStmt, 8, DB_SQLTYPE_VARCHAR, WideStringFromMBString(msg->getTag()), DB_BIND_DYNAMIC);
 #else
-         DBBind(hStmt, 7, DB_SQLTYPE_VARCHAR, msg->getHostName(), DB_BIND_STATIC);
-         DBBind(hStmt, 8, DB_SQLTYPE_VARCHAR, msg->getTag(), DB_BIND_STATIC);
+            DBBind(hStmt, 7, DB_SQLTYPE_VARCHAR, msg->getHostName(), DB_BIND_STATIC);
+            DBBind(hStmt, 8, DB_SQLTYPE_VARCHAR, msg->getTag(), DB_BIND_STATIC);
 #endif
-         DBBind(hStmt, 9, DB_SQLTYPE_VARCHAR, msg->getMessage(), DB_BIND_STATIC);
-
-         if (!DBExecute(hStmt))
-         {
-            delete msg;
-            break;
+            DBBind(hStmt, 9, DB_SQLTYPE_VARCHAR, msg->getMessage(), DB_BIND_STATIC);
+            if (!DBExecute(hStmt))
+               break;
          }
-         delete msg;
-         count++;
-         if (count == maxRecords)
-            break;
-         msg = g_syslogWriteQueue.get();
-         if ((msg == nullptr) || (msg == INVALID_POINTER_VALUE))
-            break;
+         DBCommit(hdb);
+         DBFreeStatement(hStmt);
       }
-      DBCommit(hdb);
-      DBFreeStatement(hStmt);
       DBConnectionPoolReleaseConnection(hdb);
-      if (msg == INVALID_POINTER_VALUE)
+
+      for(int i = 0; i < count; i++)
+         delete batch[i];
+
+      if (stop)
          break;
    }
+   MemFree(batch);
    nxlog_debug_tag(DEBUG_TAG, 1, _T("Syslog writer thread stopped"));
 }
 
@@ -481,7 +485,7 @@ static void ProcessSyslogMessage(SyslogMessage *msg)
 	   }
 
 	   if (writeToDatabase && s_enableStorage)
-         g_syslogWriteQueue.put(msg);
+         s_syslogWriteQueue.put(msg);
 	   else
 	      delete msg;
    }
@@ -500,7 +504,7 @@ static void SyslogProcessingThread()
    ThreadSetName("SyslogProcessor");
    while(true)
    {
-      SyslogMessage *msg = g_syslogProcessingQueue.getOrBlock();
+      SyslogMessage *msg = s_syslogProcessingQueue.getOrBlock();
       if (msg == INVALID_POINTER_VALUE)
          break;
 
@@ -508,12 +512,28 @@ static void SyslogProcessingThread()
    }
 }
 
+/**
+ * Get size of syslog processing queue
+ */
+int64_t GetSyslogProcessingQueueSize()
+{
+   return static_cast<int64_t>(s_syslogProcessingQueue.size());
+}
+
+/**
+ * Get size of syslog writer queue
+ */
+int64_t GetSyslogWriterQueueSize()
+{
+   return static_cast<int64_t>(s_syslogWriteQueue.size());
+}
+
 /**
  * Queue syslog message for processing
  */
 static void QueueSyslogMessage(char *msg, int msgLen, const InetAddress& sourceAddr)
 {
-   g_syslogProcessingQueue.put(new SyslogMessage(sourceAddr, msg, msgLen));
+   s_syslogProcessingQueue.put(new SyslogMessage(sourceAddr, msg, msgLen));
 }
 
 /**
@@ -521,7 +541,7 @@ static void QueueSyslogMessage(char *msg, int msgLen, const InetAddress& sourceA
  */
 void QueueProxiedSyslogMessage(const InetAddress &addr, int32_t zoneUIN, uint32_t nodeId, time_t timestamp, const char *msg, int msgLen)
 {
-   g_syslogProcessingQueue.put(new SyslogMessage(addr, timestamp, zoneUIN, nodeId, msg, msgLen));
+   s_syslogProcessingQueue.put(new SyslogMessage(addr, timestamp, zoneUIN, nodeId, msg, msgLen));
 }
 
 /**
@@ -939,11 +959,11 @@ void StopSyslogServer()
    ThreadJoin(s_receiverThread);
 
    // Stop processing thread
-   g_syslogProcessingQueue.put(INVALID_POINTER_VALUE);
+   s_syslogProcessingQueue.put(static_cast<SyslogMessage*>(INVALID_POINTER_VALUE));
    ThreadJoin(s_processingThread);
 
    // Stop writer thread - it must be done after processing thread already finished
-   g_syslogWriteQueue.put(INVALID_POINTER_VALUE);
+   s_syslogWriteQueue.put(static_cast<SyslogMessage*>(INVALID_POINTER_VALUE));
    ThreadJoin(s_writerThread);
 
    delete s_parser;
@@ -27,6 +27,21 @@
 
 #define REQUEST_TIMEOUT 10000
 
+/**
+ * Outbound queue size limit (senders will wait for queue to drain when it is reached)
+ */
+#define MAX_OUTBOUND_QUEUE_SIZE  (4 * 1024 * 1024)
+
+/**
+ * Outbound queue allocation step
+ */
+#define OUTBOUND_QUEUE_ALLOCATION_STEP 65536
+
+/**
+ * Maximum size of single SSL_write call (multiple of maximum TLS record size)
+ */
+#define OUTBOUND_WRITE_SIZE   (16384 * 8)
+
 #define DEBUG_TAG       _T("agent.tunnel")
 
 /**
@@ -328,7 +343,8 @@ static VolatileCounter s_nextTunnelId = 0;
  */
 AgentTunnel::AgentTunnel(SSL_CTX *context, SSL *ssl, SOCKET sock, const InetAddress& addr,
          uint32_t nodeId, int32_t zoneUIN, const TCHAR *certificateSubject, const TCHAR *certificateIssuer,
-         time_t certificateExpirationTime, time_t certificateIssueTime, BackgroundSocketPollerHandle *socketPoller) : m_channelLock(MutexType::FAST)
+         time_t certificateExpirationTime, time_t certificateIssueTime, BackgroundSocketPollerHandle *socketPoller) :
+         m_writeLock(MutexType::FAST), m_outboundSpaceAvailable(true), m_channelLock(MutexType::FAST)
 {
    m_id = InterlockedIncrement(&s_nextTunnelId);
    m_address = addr;
@@ -338,6 +354,19 @@ AgentTunnel::AgentTunnel(SSL_CTX *context, SSL *ssl, SOCKET sock, const InetAddr
    _sntprintf(m_threadPoolKey, 12, _T("TN%u"), m_id);
    m_context = context;
    m_ssl = ssl;
+   m_outboundQueue = nullptr;
+   m_outboundQueueSize = 0;
+   m_outboundQueueAllocated = 0;
+   m_outboundBatch = nullptr;
+   m_outboundBatchSize = 0;
+   m_outboundBatchOffset = 0;
+   m_outboundBatchAllocated = 0;
+   m_writerActive = false;
+   m_messagesSent = 0;
+   m_bytesSent = 0;
+   m_writeCalls = 0;
+   m_backpressureWaits = 0;
+   m_outboundQueueMaxSize = 0;
    m_requestId = 0;
    m_nodeId = nodeId;
    m_zoneUIN = zoneUIN;
@@ -383,7 +412,11 @@ AgentTunnel::~AgentTunnel()
    MemFree(m_certificateIssuer);
    MemFree(m_certificateSubject);
    delete m_messageReceiver;
+   MemFree(m_outboundQueue);
+   MemFree(m_outboundBatch);
    InterlockedDecrement(&m_socketPoller->usageCount);
+   debugPrintf(5, _T("Outbound statistics: messages=") UINT64_FMT _T(" bytes=") UINT64_FMT _T(" writes=") UINT64_FMT _T(" backpressureWaits=") UINT64_FMT _T(" maxQueueSize=%u"),
+            m_messagesSent, m_bytesSent, m_writeCalls, m_backpressureWaits, static_cast<uint32_t>(m_outboundQueueMaxSize));
    debugPrintf(4, _T("Tunnel destroyed"));
 }
 
@@ -533,42 +566,155 @@ void AgentTunnel::socketPollerCallback(BackgroundSocketPollResult pollResult, SO
 }
 
 /**
- * Write to SSL
+ * Put data into outbound queue. Data will be sent either by calling thread (if there is no active writer)
+ * or by thread that is currently sending data on this tunnel. Returns false if data cannot be queued.
  */
-int AgentTunnel::sslWrite(const void *data, size_t size)
+bool AgentTunnel::queueOutboundData(const void *data, size_t size)
 {
-   bool canRetry;
-   int bytes;
    m_writeLock.lock();
-   do
+
+   // Wait for writer to take queued data if queue is full
+   if ((m_outboundQueueSize > 0) && (m_outboundQueueSize + size > MAX_OUTBOUND_QUEUE_SIZE))
    {
-      canRetry = false;
-      m_sslLock.lock();
-      bytes = SSL_write(m_ssl, data, (int)size);
-      if (bytes <= 0)
+      m_backpressureWaits++;
+      int64_t startTime = GetCurrentTimeMs();
+      do
       {
-         int err = SSL_get_error(m_ssl, bytes);
-         if ((err == SSL_ERROR_WANT_READ) || (err == SSL_ERROR_WANT_WRITE))
+         int64_t elapsed = GetCurrentTimeMs() - startTime;
+         if ((elapsed >= REQUEST_TIMEOUT) || (m_state == AGENT_TUNNEL_SHUTDOWN))
          {
-            m_sslLock.unlock();
-            SocketPoller sp(err == SSL_ERROR_WANT_WRITE);
-            sp.add(m_socket);
-            if (sp.poll(REQUEST_TIMEOUT) > 0)
-               canRetry = true;
-            m_sslLock.lock();
+            m_writeLock.unlock();
+            debugPrintf(5, _T("Outbound queue is full (%u bytes queued)"), static_cast<uint32_t>(m_outboundQueueSize));
+            return false;
          }
-         else
+         m_outboundSpaceAvailable.reset();
+         m_writeLock.unlock();
+         m_outboundSpaceAvailable.wait(REQUEST_TIMEOUT - static_cast<uint32_t>(elapsed));
+         m_writeLock.lock();
+      } while((m_outboundQueueSize > 0) && (m_outboundQueueSize + size > MAX_OUTBOUND_QUEUE_SIZE));
+   }
+
+   if (m_outboundQueueSize + size > m_outboundQueueAllocated)
+   {
+      m_outboundQueueAllocated = std::max(m_outboundQueueSize + size, m_outboundQueueAllocated + OUTBOUND_QUEUE_ALLOCATION_STEP);
+      m_outboundQueue = MemRealloc(m_outboundQueue, m_outboundQueueAllocated);
+   }
+   memcpy(&m_outboundQueue[m_outboundQueueSize], data, size);
+   m_outboundQueueSize += size;
+   if (m_outboundQueueSize > m_outboundQueueMaxSize)
+      m_outboundQueueMaxSize = m_outboundQueueSize;
+   m_messagesSent++;
+
+   bool startWriter = !m_writerActive;
+   m_writerActive = true;
+   m_writeLock.unlock();
+
+   if (startWriter)
+      flushOutboundQueue();
+   return true;
+}
+
+/**
+ * Send queued data. Should only be called by thread that set writer active flag. Pending messages are
+ * coalesced into single write so that TLS layer can produce full size records. If socket is not ready
+ * for writing, socket is registered with background poller and sending is continued on agent connection
+ * thread pool when socket becomes ready.
+ */
+void AgentTunnel::flushOutboundQueue()
+{
+   while(true)
+   {
+      if (m_outboundBatchOffset == m_outboundBatchSize)
+      {
+         // Take all queued data as next batch
+         m_writeLock.lock();
+         if ((m_outboundQueueSize == 0) || (m_state == AGENT_TUNNEL_SHUTDOWN))
          {
-            debugPrintf(7, _T("SSL_write error (bytes=%d ssl_err=%d socket_err=%d)"), bytes, err, WSAGetLastError());
-            if (err == SSL_ERROR_SSL)
-               LogOpenSSLErrorStack(7);
+            m_outboundQueueSize = 0;
+            m_writerActive = false;
+            m_outboundSpaceAvailable.set();
+            m_writeLock.unlock();
+            m_outboundBatchSize = 0;
+            m_outboundBatchOffset = 0;
+            return;
          }
+         std::swap(m_outboundBatch, m_outboundQueue);
+         std::swap(m_outboundBatchAllocated, m_outboundQueueAllocated);
+         m_outboundBatchSize = m_outboundQueueSize;
+         m_outboundBatchOffset = 0;
+         m_outboundQueueSize = 0;
+         m_outboundSpaceAvailable.set();
+         m_writeLock.unlock();
       }
+
+      // Size of write should not change between retries
+      int size = static_cast<int>(std::min(m_outboundBatchSize - m_outboundBatchOffset, static_cast<size_t>(OUTBOUND_WRITE_SIZE)));
+      m_sslLock.lock();
+      int bytes = SSL_write(m_ssl, &m_outboundBatch[m_outboundBatchOffset], size);
+      int err = (bytes <= 0) ? SSL_get_error(m_ssl, bytes) : SSL_ERROR_NONE;
       m_sslLock.unlock();
+
+      if (bytes > 0)
+      {
+         m_outboundBatchOffset += bytes;
+         m_bytesSent += bytes;
+         m_writeCalls++;
+         continue;
+      }
+
+      if ((err == SSL_ERROR_WANT_READ) || (err == SSL_ERROR_WANT_WRITE))
+      {
+         shared_ptr<AgentTunnel> tunnel = self();
+         if (tunnel != nullptr)
+         {
+            m_socketPoller->poller.poll(m_socket, REQUEST_TIMEOUT, outboundPollerCallback, new shared_ptr<AgentTunnel>(tunnel), err == SSL_ERROR_WANT_WRITE);
+            return;
+         }
+      }
+      else
+      {
+         debugPrintf(7, _T("SSL_write error (bytes=%d ssl_err=%d socket_err=%d)"), bytes, err, WSAGetLastError());
+         if (err == SSL_ERROR_SSL)
+            LogOpenSSLErrorStack(7);
+      }
+
+      abortOutboundQueue();
+      return;
    }
-   while(canRetry);
+}
+
+/**
+ * Socket poller callback for stalled write
+ */
+void AgentTunnel::outboundPollerCallback(BackgroundSocketPollResult pollResult, SOCKET hSocket, shared_ptr<AgentTunnel> *tunnel)
+{
+   if (pollResult == BackgroundSocketPollResult::SUCCESS)
+   {
+      ThreadPoolExecute(g_agentConnectionThreadPool, *tunnel, &AgentTunnel::flushOutboundQueue);
+   }
+   else
+   {
+      (*tunnel)->debugPrintf(5, _T("Socket is not ready for write (poll result %d)"), static_cast<int>(pollResult));
+      (*tunnel)->abortOutboundQueue();
+   }
+   delete tunnel;
+}
+
+/**
+ * Abort sending after write failure. Part of queued data may already be written, so stream cannot be
+ * continued and tunnel is shut down. Should only be called by active writer.
+ */
+void AgentTunnel::abortOutboundQueue()
+{
+   m_writeLock.lock();
+   debugPrintf(5, _T("Outbound data discarded (%u bytes), closing tunnel"), static_cast<uint32_t>(m_outboundBatchSize - m_outboundBatchOffset + m_outboundQueueSize));
+   m_outboundQueueSize = 0;
+   m_outboundBatchSize = 0;
+   m_outboundBatchOffset = 0;
+   m_writerActive = false;
+   m_outboundSpaceAvailable.set();
    m_writeLock.unlock();
-   return bytes;
+   shutdown();
 }
 
 /**
@@ -585,7 +731,7 @@ bool AgentTunnel::sendMessage(const NXCPMessage& msg)
       debugPrintf(6, _T("Sending message %s (%u)"), NXCPMessageCodeName(msg.getCode(), buffer), msg.getId());
    }
    NXCP_MESSAGE *data = msg.serialize(true);
-   bool success = (sslWrite(data, ntohl(data->size)) == static_cast<int>(ntohl(data->size)));
+   bool success = queueOutboundData(data, ntohl(data->size));
    MemFree(data);
    return success;
 }
@@ -1023,10 +1169,11 @@ void AgentTunnel::closeChannel(AgentTunnelCommChannel *channel)
  */
 ssize_t AgentTunnel::sendChannelData(uint32_t id, const void *data, size_t len)
 {
+   if (m_state == AGENT_TUNNEL_SHUTDOWN)
+      return -1;
+
    NXCP_MESSAGE *msg = CreateRawNXCPMessage(CMD_CHANNEL_DATA, id, 0, data, len, nullptr, false);
-   ssize_t rc = sslWrite(msg, ntohl(msg->size));
-   if (rc == static_cast<ssize_t>(ntohl(msg->size)))
-      rc = len;  // adjust number of bytes to exclude tunnel overhead
+   ssize_t rc = queueOutboundData(msg, ntohl(msg->size)) ? static_cast<ssize_t>(len) : -1;  // number of bytes should exclude tunnel overhead
    MemFree(msg);
    return rc;
 }
@@ -1062,6 +1209,11 @@ void AgentTunnel::fillMessage(NXCPMessage *msg, uint32_t baseId) const
    msg->setField(baseId + 21, m_certificateSubject);
    msg->setFieldFromTime(baseId + 22, m_startTime);
    msg->setField(baseId + 23, m_serialNumber);
+   msg->setField(baseId + 24, m_messagesSent);
+   msg->setField(baseId + 25, m_bytesSent);
+   msg->setField(baseId + 26, m_writeCalls);
+   msg->setField(baseId + 27, m_backpressureWaits);
+   msg->setField(baseId + 28, static_cast<uint64_t>(m_outboundQueueMaxSize));
 }
 
 /**
@@ -105,7 +105,21 @@ class AgentTunnel
    SSL_CTX *m_context;
    SSL *m_ssl;
    Mutex m_sslLock;
-   Mutex m_writeLock;
+   Mutex m_writeLock;   // Protects outbound queue
+   BYTE *m_outboundQueue;           // Data waiting to be sent
+   size_t m_outboundQueueSize;
+   size_t m_outboundQueueAllocated;
+   BYTE *m_outboundBatch;           // Data being sent (buffer should not move until it is sent completely)
+   size_t m_outboundBatchSize;
+   size_t m_outboundBatchOffset;
+   size_t m_outboundBatchAllocated;
+   bool m_writerActive;
+   Condition m_outboundSpaceAvailable;
+   uint64_t m_messagesSent;
+   uint64_t m_bytesSent;
+   uint64_t m_writeCalls;
+   uint64_t m_backpressureWaits;
+   size_t m_outboundQueueMaxSize;
    MsgWaitQueue m_queue;
    VolatileCounter m_requestId;
    uint32_t m_nodeId;
@@ -146,7 +160,10 @@ class AgentTunnel
    void processMessage(NXCPMessage *msg);
    static void socketPollerCallback(BackgroundSocketPollResult pollResult, SOCKET hSocket, AgentTunnel *tunnel);
    
-   int sslWrite(const void *data, size_t size);
+   bool queueOutboundData(const void *data, size_t size);
+   void flushOutboundQueue();
+   void abortOutboundQueue();
+   static void outboundPollerCallback(BackgroundSocketPollResult pollResult, SOCKET hSocket, shared_ptr<AgentTunnel> *tunnel);
    bool sendMessage(const NXCPMessage& msg);
    NXCPMessage *waitForMessage(uint16_t code, uint32_t id) { return m_queue.waitForMessage(code, id, g_agentCommandTimeout); }
 
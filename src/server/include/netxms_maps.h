@@ -87,6 +87,27 @@ struct NXCORE_EXPORTABLE ObjLink
 template class NXCORE_EXPORTABLE ObjectArray<ObjLink>;
 #endif
 
+/**
+ * Link index key (ordered pair of object IDs and link type, type -1 matches any link type)
+ */
+struct ObjLinkIndexKey
+{
+   uint32_t id1;
+   uint32_t id2;
+   int32_t type;
+
+   ObjLinkIndexKey(uint32_t _id1, uint32_t _id2, int32_t _type)
+   {
+      id1 = _id1;
+      id2 = _id2;
+      type = _type;
+   }
+};
+
+#ifdef _WIN32
+template class NXCORE_EXPORTABLE HashMap<ObjLinkIndexKey, ObjLink>;
+#endif
+
 /**
  * Connected object list
  */
@@ -95,8 +116,15 @@ class NXCORE_EXPORTABLE NetworkMapObjectList
 protected:
    IntegerArray<uint32_t> m_objectList;
    ObjectArray<ObjLink> m_linkList;
+   HashMap<ObjLinkIndexKey, ObjLink> m_linkIndex;  // First link for each (id1, id2, type) and (id1, id2, any type) combination
    bool m_allowDuplicateLinks;
 
+   void addLink(ObjLink *link);
+   void indexLink(ObjLink *link);
+   void rebuildLinkIndex();
+   void setLinkType(ObjLink *link, int type);
+   ObjLink *findLink(uint32_t objectId1, uint32_t objectId2, int type) const { return m_linkIndex.get(ObjLinkIndexKey(objectId1, objectId2, type)); }
+
 public:
    NetworkMapObjectList();
    NetworkMapObjectList(const NetworkMapObjectList& src);
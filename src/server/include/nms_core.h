@@ -1245,9 +1245,11 @@ void SaveObjects(DB_HANDLE hdb, UINT32 watchdogId, bool saveRuntimeData);
 void NXCORE_EXPORTABLE QueueSQLRequest(const TCHAR *query);
 void NXCORE_EXPORTABLE QueueSQLRequest(const TCHAR *query, int bindCount, int *sqlTypes, const TCHAR **values);
 void QueueIDataInsert(time_t timestamp, uint32_t nodeId, uint32_t dciId, const TCHAR *rawValue, const TCHAR *transformedValue, DCObjectStorageClass storageClass);
+void QueueTDataInsert(time_t timestamp, uint32_t nodeId, uint32_t tableId, DCObjectStorageClass storageClass, const shared_ptr<Table>& value);
 void QueueRawDciDataUpdate(time_t timestamp, uint32_t dciId, const TCHAR *rawValue, const TCHAR *transformedValue, time_t cacheTimestamp);
 void QueueRawDciDataDelete(uint32_t dciId);
 int64_t GetIDataWriterQueueSize();
+int64_t GetTDataWriterQueueSize();
 int64_t GetRawDataWriterQueueSize();
 uint64_t GetRawDataWriterMemoryUsage();
 void StartDBWriter();
@@ -1255,6 +1257,10 @@ void StopDBWriter();
 void OnDBWriterMaxQueueSizeChange();
 void ClearDBWriterData(ServerConsole *console, const TCHAR *component);
 
+void MaintainTablePartitions(DB_HANDLE hdb);
+bool IsPartitionedTable(const TCHAR *table);
+int DropExpiredPartitions(DB_HANDLE hdb, const TCHAR *table, time_t cutoffTime);
+
 void PerfDataStorageRequest(DCItem *dci, time_t timestamp, const TCHAR *value);
 void PerfDataStorageRequest(DCTable *dci, time_t timestamp, Table *value);
 
@@ -1501,6 +1507,7 @@ uint32_t DeleteScript(uint32_t scriptId);
  * Address range scan functions
  */
 void ScanAddressRangeICMP(const InetAddress& from, const InetAddress& to, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context);
+bool ScanAddressListICMP(const IntegerArray<uint32_t>& addrList, void (*callback)(const InetAddress&, int32_t, const Node*, uint32_t, const TCHAR*, ServerConsole*, void*), ServerConsole *console, void *context);
 
 /**
  * Prepare MERGE statement if possible, otherwise INSERT or UPDATE depending on record existence
@@ -1608,6 +1615,7 @@ extern uint32_t g_offlineDataRelevanceTime;
 extern int32_t g_instanceRetentionTime;
 extern uint32_t g_snmpTrapStormCountThreshold;
 extern uint32_t g_snmpTrapStormDurationThreshold;
+extern uint32_t g_snmpMaxVarbindsPerRequest;
 extern uint32_t g_pollsBetweenPrimaryIpUpdate;
 extern PrimaryIPUpdateMode g_primaryIpUpdateMode;
 extern char g_snmpCodepage[16];
@@ -1621,6 +1629,7 @@ extern TCHAR g_szDbName[];
 extern TCHAR g_szDbSchema[];
 extern DB_DRIVER g_dbDriver;
 extern VolatileCounter64 g_idataWriteRequests;
+extern VolatileCounter64 g_tdataWriteRequests;
 extern uint64_t g_rawDataWriteRequests;
 extern VolatileCounter64 g_otherWriteRequests;
 
@@ -135,6 +135,7 @@ class NXCORE_EXPORTABLE ItemValue
 
 class DCItem;
 class DataCollectionTarget;
+struct DciValue;
 
 /**
  * Threshold definition class
@@ -542,6 +543,7 @@ class NXCORE_EXPORTABLE DCItem : public DCObject
 	SharedString getUnitName() const { return GetAttributeWithLock(m_unitName, m_mutex); }
 
 	uint64_t getCacheMemoryUsage() const;
+	bool getCachedValues(int count, StructArray<DciValue> *values) const;
 
    bool processNewValue(time_t nTimeStamp, const TCHAR *value, bool *updateStatus);
 
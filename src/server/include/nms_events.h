@@ -538,6 +538,22 @@ struct EventProcessingThreadStats
    uint32_t bindings;
 };
 
+/**
+ * Event log writer statistics
+ */
+struct EventLogWriterStats
+{
+   uint64_t writtenEvents;
+   uint64_t failedEvents;
+   uint64_t batches;
+   uint32_t averageBatchSize;
+   uint32_t maxBatchSize;
+   uint32_t averageWriteTime;
+   uint32_t maxWriteTime;
+   uint32_t queueSize;
+   int threads;
+};
+
 /**
  * Functions
  */
@@ -553,6 +569,7 @@ void CorrelateEvent(Event *event);
 Event *LoadEventFromDatabase(uint64_t eventId);
 Event *FindEventInLoggerQueue(uint64_t eventId);
 StructArray<EventProcessingThreadStats> *GetEventProcessingThreadStats();
+EventLogWriterStats GetEventLogWriterStats();
 
 bool EventNameFromCode(UINT32 eventCode, TCHAR *buffer);
 uint32_t NXCORE_EXPORTABLE EventCodeFromName(const TCHAR *name, uint32_t defaultValue = 0);
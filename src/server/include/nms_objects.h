@@ -27,6 +27,7 @@
 #include <netxms_maps.h>
 #include <geolocation.h>
 #include <jansson.h>
+#include <netxms-regex.h>
 #include <math.h>
 #include "nms_topo.h"
 #include <gauge_helpers.h>
@@ -168,6 +169,9 @@ class NXCORE_EXPORTABLE AgentConnectionEx : public AgentConnection
    ClientSession *m_tcpProxySession;
    int64_t m_dbWriterQueueThreshold;
 
+   void processSyslogRecord(Node *node, int32_t zoneUIN, uint64_t id, const InetAddress& sourceAddr, time_t timestamp,
+            const NXCPMessage& msg, uint32_t messageFieldId, int msgLen);
+
    virtual shared_ptr<AbstractCommChannel> createChannel() override;
    virtual void onTrap(NXCPMessage *msg) override;
    virtual void onSyslogMessage(const NXCPMessage& msg) override;
@@ -851,9 +855,16 @@ class NXCORE_EXPORTABLE SummaryTableColumn
    TCHAR m_dciName[MAX_PARAM_NAME];
    uint32_t m_flags;
    TCHAR m_separator[16];
+   PCRE *m_regexp;   // Compiled DCI name or description pattern for regexp match columns
 
    SummaryTableColumn(const NXCPMessage& msg, uint32_t baseId);
    SummaryTableColumn(TCHAR *configStr);
+   SummaryTableColumn(const SummaryTableColumn& src) = delete;
+   ~SummaryTableColumn();
+
+   void compileRegexp();
+   bool isRegexpMatch() const { return (m_flags & COLUMN_DEFINITION_REGEXP_MATCH) != 0; }
+   bool isMatchByDescription() const { return (m_flags & COLUMN_DEFINITION_BY_DESCRIPTION) != 0; }
 
    void createExportRecord(StringBuffer &xml, uint32_t id) const;
 };
@@ -876,9 +887,14 @@ class NXCORE_EXPORTABLE SummaryTable
    time_t m_periodEnd;
    TCHAR m_menuPath[MAX_DB_STRING];
    TCHAR m_tableDciName[MAX_PARAM_NAME];
+   StringObjectMap<IntegerArray<int>> m_columnsByName;
+   StringObjectMap<IntegerArray<int>> m_columnsByDescription;
+   IntegerArray<int> m_regexpColumns;
 
    SummaryTable(uint32_t id, DB_RESULT hResult);
 
+   void prepareColumnMatchers();
+
 public:
    static SummaryTable *loadFromDB(uint32_t id, uint32_t *rcc);
 
@@ -887,6 +903,7 @@ class NXCORE_EXPORTABLE SummaryTable
 
    bool filter(const shared_ptr<DataCollectionTarget>& node);
    Table *createEmptyResultTable();
+   void matchColumns(const DCObject *dci, IntegerArray<int> *columns) const;
 
    int getNumColumns() const { return m_columns->size(); }
    SummaryTableColumn *getColumn(int index) const { return m_columns->get(index); }
@@ -2481,6 +2498,7 @@ class NXCORE_EXPORTABLE DataCollectionTarget : public DataCollectionOwner, publi
    void reloadDCItemCache(uint32_t dciId);
    void cleanDCIData(DB_HANDLE hdb);
    void calculateDciCutoffTimes(time_t *cutoffTimeIData, time_t *cutoffTimeTData);
+   void calculateMaxDciRetentionTime(int *itemRetentionTime, int *tableRetentionTime);
    void queueItemsForPolling();
    bool processNewDCValue(const shared_ptr<DCObject>& dco, time_t currTime, const TCHAR *itemValue, const shared_ptr<Table>& tableValue);
    void scheduleItemDataCleanup(uint32_t dciId);
@@ -3104,6 +3122,17 @@ template class NXCORE_EXPORTABLE StructArray<OSPFArea>;
 template class NXCORE_EXPORTABLE StructArray<OSPFNeighbor>;
 #endif
 
+/**
+ * Single metric request for coalesced SNMP data collection
+ */
+struct SNMPMetricRequest
+{
+   const TCHAR *name;         // Metric OID
+   int interpretRawValue;     // Raw value interpretation mode (SNMP_RAWTYPE_xxx)
+   DataCollectionError result;
+   TCHAR *value;              // Collected value (dynamically allocated, should be freed by caller)
+};
+
 /**
  * Node
  */
@@ -3198,6 +3227,10 @@ class NXCORE_EXPORTABLE Node : public DataCollectionTarget
    Mutex m_smclpMutex;
    Mutex m_routingTableMutex;
    Mutex m_topologyMutex;
+   Mutex m_snmpTransportCacheLock;
+   SNMP_Transport *m_cachedSnmpTransport;    // Idle SNMP transport available for reuse
+   uint32_t m_cachedSnmpTransportProxy;
+   time_t m_cachedSnmpTransportTime;
    shared_ptr<AgentConnectionEx> m_agentConnection;
    ProxyAgentConnection *m_proxyConnections;
    VolatileCounter m_pendingDataConfigurationSync;
@@ -3573,6 +3606,7 @@ class NXCORE_EXPORTABLE Node : public DataCollectionTarget
    virtual DataCollectionError getInternalTable(const TCHAR *name, shared_ptr<Table> *result) override;
 
    DataCollectionError getMetricFromSNMP(uint16_t port, SNMP_Version version, const TCHAR *name, TCHAR *buffer, size_t size, int interpretRawValue);
+   void getMetricsFromSNMP(uint16_t port, SNMP_Version version, SNMPMetricRequest *requests, int count);
    DataCollectionError getTableFromSNMP(uint16_t port, SNMP_Version version, const TCHAR *oid, const ObjectArray<DCTableColumn> &columns, shared_ptr<Table> *table);
    DataCollectionError getListFromSNMP(uint16_t port, SNMP_Version version, const TCHAR *oid, StringList **list);
    DataCollectionError getOIDSuffixListFromSNMP(uint16_t port, SNMP_Version version, const TCHAR *oid, StringMap **values);
@@ -3608,6 +3642,9 @@ class NXCORE_EXPORTABLE Node : public DataCollectionTarget
    shared_ptr<AgentConnectionEx> getAgentConnection(bool forcePrimary = false);
    shared_ptr<AgentConnectionEx> acquireProxyConnection(ProxyType type, bool validate = false);
    SNMP_Transport *createSnmpTransport(uint16_t port = 0, SNMP_Version version = SNMP_VERSION_DEFAULT, const char *context = nullptr, const char *community = nullptr);
+   SNMP_Transport *acquireSnmpTransport(uint16_t port = 0, SNMP_Version version = SNMP_VERSION_DEFAULT);
+   void releaseSnmpTransport(SNMP_Transport *transport, bool reusable);
+   void invalidateSnmpTransportCache();
    SNMP_SecurityContext *getSnmpSecurityContext() const;
 
    uint32_t getEffectiveSnmpProxy(bool backup = false);
@@ -4261,6 +4298,8 @@ class NXCORE_EXPORTABLE NetworkMap : public NetObj
    ObjectArray<NetworkMapElement> m_elements;
    ObjectArray<NetworkMapLink> m_links;
    StructArray<NetworkMapObjectLocation> m_deletedObjects;
+   HashMap<uint32_t, NetworkMapElement> m_elementIndex;  // Element ID to element
+   HashMap<uint32_t, NetworkMapObject> m_objectIndex;    // Object ID to first element referencing that object
 
    virtual void fillMessageInternal(NXCPMessage *msg, uint32_t userId) override;
    virtual uint32_t modifyFromMessageInternal(const NXCPMessage& msg) override;
@@ -4270,6 +4309,9 @@ class NXCORE_EXPORTABLE NetworkMap : public NetObj
    void updateLinks();
    uint32_t objectIdFromElementId(uint32_t eid);
    uint32_t elementIdFromObjectId(uint32_t eid);
+   void indexElement(NetworkMapElement *e);
+   void addElement(NetworkMapElement *e);
+   void rebuildElementIndex();
 
    void setFilter(const TCHAR *filter);
    bool isAllowedOnMap(const shared_ptr<NetObj>& object);
@@ -4867,7 +4909,7 @@ IntegerArray<uint32_t> CheckSubnetOverlap(const InetAddress &addr, int32_t uin);
 
 unique_ptr<ObjectArray<ObjectQueryResult>> QueryObjects(const TCHAR *query, uint32_t userId, TCHAR *errorMessage, size_t errorMessageLen,
          bool readAllComputedFields = false, const StringList *fields = nullptr, const StringList *orderBy = nullptr,
-         const StringMap *inputFields = nullptr, uint32_t limit = 0);
+         const StringMap *inputFields = nullptr, uint32_t limit = 0, uint32_t offset = 0, uint32_t *totalCount = nullptr);
 uint32_t GetObjectQueries(NXCPMessage *msg);
 uint32_t ModifyObjectQuery(const NXCPMessage& msg, uint32_t *queryId);
 uint32_t DeleteObjectQuery(uint32_t queryId);
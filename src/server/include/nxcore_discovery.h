@@ -36,6 +36,16 @@ enum DiscoveredAddressSourceType
    DA_SRC_ACTIVE_DISCOVERY = 5
 };
 
+/**
+ * Result of ICMP sweep made by discovery pipeline
+ */
+enum class DiscoveryPingStatus
+{
+   UNKNOWN = 0,
+   REACHABLE = 1,
+   UNREACHABLE = 2
+};
+
 /**
  * Discovered address information
  */
@@ -46,6 +56,7 @@ struct DiscoveredAddress
    int32_t zoneUIN;
    uint32_t sourceNodeId;
    DiscoveredAddressSourceType sourceType;
+   DiscoveryPingStatus pingStatus;
    bool ignoreFilter;
 
    DiscoveredAddress(const InetAddress& _ipAddr, int32_t _zoneUIN, uint32_t _sourceNodeId, DiscoveredAddressSourceType _sourceType) : ipAddr(_ipAddr)
@@ -53,6 +64,7 @@ struct DiscoveredAddress
       zoneUIN = _zoneUIN;
       sourceNodeId = _sourceNodeId;
       sourceType = _sourceType;
+      pingStatus = DiscoveryPingStatus::UNKNOWN;
       ignoreFilter = false;
    }
 };
@@ -125,6 +137,7 @@ extern NXSL_DiscoveredInterfaceClass g_nxslDiscoveredInterfaceClass;
 
 void CheckPotentialNode(const InetAddress& ipAddr, int32_t zoneUIN, DiscoveredAddressSourceType sourceType, uint32_t sourceNodeId);
 
+void QueueDiscoveredAddress(DiscoveredAddress *address);
 int64_t GetDiscoveryPollerQueueSize();
 
 extern ObjectQueue<DiscoveredAddress> g_nodePollerQueue;
@@ -167,6 +167,7 @@
 #define AF_DISABLE_SNMP_V2_PROBE               _LL(0x0080000000000000)
 #define AF_DISABLE_SNMP_V3_PROBE               _LL(0x0100000000000000)
 #define AF_DISABLE_SSH_PROBE                   _LL(0x0200000000000000)
+#define AF_PARTITIONED_TABLES                  _LL(0x0400000000000000)
 #define AF_SERVER_INITIALIZED                  _LL(0x2000000000000000)
 #define AF_SHUTDOWN                            _LL(0x4000000000000000)
 
@@ -920,6 +921,7 @@ class LIBNXSRV_EXPORTABLE AgentConnection : public enable_shared_from_this<Agent
 	bool m_fileUploadInProgress;
 	bool m_fileUpdateConnection;
 	bool m_allowCompression;
+	NXCPStreamCompressionMethod m_messageCompressionMethod;
 	VolatileCounter m_bulkDataProcessing;
 
    uint32_t setupEncryption(RSA_KEY serverKey);
@@ -982,6 +984,7 @@ class LIBNXSRV_EXPORTABLE AgentConnection : public enable_shared_from_this<Agent
 	bool isControlServer() const { return m_controlServer; }
 	bool isMasterServer() const { return m_masterServer; }
 	bool isCompressionAllowed() const { return m_allowCompression && (m_nProtocolVersion >= 4); }
+	NXCPStreamCompressionMethod getMessageCompressionMethod() const { return isCompressionAllowed() ? m_messageCompressionMethod : NXCP_STREAM_COMPRESSION_NONE; }
 	bool isFileUpdateConnection() const { return m_fileUpdateConnection; }
 
    bool sendMessage(NXCPMessage *msg);
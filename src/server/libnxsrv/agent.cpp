@@ -509,6 +509,7 @@ AgentConnection::AgentConnection(const InetAddress& addr, uint16_t port, const T
       m_secret[0] = 0;
    }
    m_allowCompression = allowCompression;
+   m_messageCompressionMethod = NXCP_STREAM_COMPRESSION_DEFLATE;
    m_tLastCommandTime = 0;
    m_requestId = 0;
 	m_connectionTimeout = 5000;	// 5 seconds
@@ -685,6 +686,9 @@ bool AgentConnection::connect(RSA_KEY serverKey, uint32_t *error, uint32_t *sock
    // Detach from existing channel if any
    m_channel.reset();
 
+   // Agent will confirm faster compression method during capability exchange
+   m_messageCompressionMethod = NXCP_STREAM_COMPRESSION_DEFLATE;
+
    unlock();
 
    auto channel = createChannel();
@@ -1245,7 +1249,9 @@ uint32_t AgentConnection::setServerCapabilities()
    msg.setField(VID_ENABLED, true);   // Enables IPv6 on pre-2.0 agents
    msg.setField(VID_IPV6_SUPPORT, true);
    msg.setField(VID_BULK_RECONCILIATION, true);
+   msg.setField(VID_SYSLOG_BATCHING, true);
    msg.setField(VID_ENABLE_COMPRESSION, m_allowCompression);
+   msg.setField(VID_COMPRESSION_METHOD, static_cast<uint16_t>(NXCP_STREAM_COMPRESSION_LZ4));  // Preferred message compression method
    msg.setField(VID_ACCEPT_KEEPALIVE, true);
    msg.setId(requestId);
    if (!sendMessage(&msg))
@@ -1258,6 +1264,13 @@ uint32_t AgentConnection::setServerCapabilities()
    uint32_t rcc = response->getFieldAsUInt32(VID_RCC);
    if (rcc == ERR_SUCCESS)
    {
+      // Agents not aware of message compression methods will not return selected method and can only use deflate
+      if (response->isFieldExist(VID_COMPRESSION_METHOD) && (response->getFieldAsUInt16(VID_COMPRESSION_METHOD) == NXCP_STREAM_COMPRESSION_LZ4))
+         m_messageCompressionMethod = NXCP_STREAM_COMPRESSION_LZ4;
+      else
+         m_messageCompressionMethod = NXCP_STREAM_COMPRESSION_DEFLATE;
+      debugPrintf(6, _T("Message compression method: %s"), (m_messageCompressionMethod == NXCP_STREAM_COMPRESSION_LZ4) ? _T("LZ4") : _T("deflate"));
+
       if (response->isFieldExist(VID_FLAGS))
       {
          uint16_t flags = response->getFieldAsUInt16(VID_FLAGS);
@@ -1329,7 +1342,7 @@ bool AgentConnection::sendMessage(NXCPMessage *pMsg)
    }
 
    bool success;
-   NXCP_MESSAGE *rawMsg = pMsg->serialize(m_allowCompression);
+   NXCP_MESSAGE *rawMsg = pMsg->serialize(getMessageCompressionMethod());
 	shared_ptr<NXCPEncryptionContext> encryptionContext = acquireEncryptionContext();
    if (encryptionContext != nullptr)
    {
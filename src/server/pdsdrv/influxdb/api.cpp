@@ -32,19 +32,30 @@
 
 #include "influxdb.h"
 #include <netxms-version.h>
+#include <zlib.h>
 
 #define MAX_URL_LENGTH  4096
 
 #if HAVE_LIBCURL
 
+/**
+ * Minimal size of data block to be compressed
+ */
+#define MIN_COMPRESSION_SIZE  1024
+
 /**
  * Constructor for Generic API sender
  */
-APISender::APISender(const Config& config) : InfluxDBSender(config)
+APISender::APISender(const Config& config, uint32_t id) : InfluxDBSender(config, id)
 {
    if (m_port == 0)
       m_port = 8086;
-   m_curl = nullptr;
+   for(int i = 0; i < MAX_SENDER_WORKERS; i++)
+   {
+      m_curl[i] = nullptr;
+      m_curlCreateTime[i] = 0;
+   }
+   m_compression = config.getValueAsBoolean(_T("/InfluxDB/Compression"), true);
 }
 
 /**
@@ -52,66 +63,123 @@ APISender::APISender(const Config& config) : InfluxDBSender(config)
  */
 APISender::~APISender()
 {
-   if (m_curl != nullptr)
-      curl_easy_cleanup(m_curl);
+   stop();
+   for(int i = 0; i < MAX_SENDER_WORKERS; i++)
+      if (m_curl[i] != nullptr)
+         curl_easy_cleanup(m_curl[i]);
 }
 
 /**
- * Send data block via API
+ * Create cURL handle for given worker
  */
-bool APISender::send(const char *data)
+CURL *APISender::createHandle(int worker)
 {
-   if (m_curl == nullptr)
+   time_t now = time(nullptr);
+   if (m_curlCreateTime[worker] + 60 > now) // Attempt to re-create handle once per minute
+      return nullptr;
+   m_curlCreateTime[worker] = now;
+
+   CURL *curl = curl_easy_init();
+   if (curl == nullptr)
    {
-      time_t now = time(nullptr);
-      if (m_lastConnect + 60 > now) // Attempt to re-create handle once per minute
-         return false;
-      m_curl = curl_easy_init();
-      m_lastConnect = now;
-      if (m_curl == nullptr)
-      {
-         nxlog_debug_tag(DEBUG_TAG, 4, _T("Call to curl_easy_init() failed"));
-         return false;
-      }
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("Call to curl_easy_init() failed"));
+      return nullptr;
+   }
 
-      // Common handle setup
+   // Common handle setup
 #if HAVE_DECL_CURLOPT_NOSIGNAL
-      curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, 1L);
+   curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
 #endif
 
-      curl_easy_setopt(m_curl, CURLOPT_POST, 1L);
-      curl_easy_setopt(m_curl, CURLOPT_HEADER, 0L); // do not include header in data
-      curl_easy_setopt(m_curl, CURLOPT_TIMEOUT, 300L);
-      curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, ByteStream::curlWriteFunction);
-      curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, 0L);
-      curl_easy_setopt(m_curl, CURLOPT_USERAGENT, "NetXMS InfluxDB Driver/" NETXMS_VERSION_STRING_A);
+   curl_easy_setopt(curl, CURLOPT_POST, 1L);
+   curl_easy_setopt(curl, CURLOPT_HEADER, 0L); // do not include header in data
+   curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L);
+   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, ByteStream::curlWriteFunction);
+   curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+   curl_easy_setopt(curl, CURLOPT_USERAGENT, "NetXMS InfluxDB Driver/" NETXMS_VERSION_STRING_A);
+
+   char url[MAX_URL_LENGTH];
+   buildURL(url);
+   curl_easy_setopt(curl, CURLOPT_URL, url);
+
+   nxlog_debug_tag(DEBUG_TAG, 4, _T("New cURL handle created for URL %hs (sender %u worker #%d)"), url, m_id, worker);
+   m_curl[worker] = curl;
+   return curl;
+}
+
+/**
+ * Compress data block using gzip format. Returns nullptr on failure.
+ */
+static BYTE *CompressData(const char *data, size_t size, size_t *compressedSize)
+{
+   z_stream stream;
+   memset(&stream, 0, sizeof(stream));
+   if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)  // 15 + 16 selects gzip wrapper
+      return nullptr;
 
-      char url[MAX_URL_LENGTH];
-      buildURL(url);
-      curl_easy_setopt(m_curl, CURLOPT_URL, url);
+   size_t bufferSize = deflateBound(&stream, static_cast<uLong>(size));
+   BYTE *buffer = MemAllocArrayNoInit<BYTE>(bufferSize);
+   stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+   stream.avail_in = static_cast<uInt>(size);
+   stream.next_out = buffer;
+   stream.avail_out = static_cast<uInt>(bufferSize);
+   if (deflate(&stream, Z_FINISH) == Z_STREAM_END)
+   {
+      *compressedSize = stream.total_out;
+   }
+   else
+   {
+      MemFreeAndNull(buffer);
+   }
+   deflateEnd(&stream);
+   return buffer;
+}
 
-      nxlog_debug_tag(DEBUG_TAG, 4, _T("New cURL handle created for URL %hs"), url);
+/**
+ * Send data block via API
+ */
+bool APISender::send(const char *data, size_t size, int worker)
+{
+   CURL *curl = m_curl[worker];
+   if (curl == nullptr)
+   {
+      curl = createHandle(worker);
+      if (curl == nullptr)
+         return false;
    }
 
    curl_slist *headers = nullptr;
    addHeaders(&headers);
    headers = curl_slist_append(headers, "Content-Type: text/plain; charset=utf-8");
-   curl_easy_setopt(m_curl, CURLOPT_HTTPHEADER, headers);
+
+   size_t compressedSize;
+   BYTE *compressedData = (m_compression && (size >= MIN_COMPRESSION_SIZE)) ? CompressData(data, size, &compressedSize) : nullptr;
+   if (compressedData != nullptr)
+   {
+      headers = curl_slist_append(headers, "Content-Encoding: gzip");
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(compressedSize));
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, compressedData);
+      nxlog_debug_tag(DEBUG_TAG, 8, _T("Data block compressed from %u to %u bytes"), static_cast<uint32_t>(size), static_cast<uint32_t>(compressedSize));
+   }
+   else
+   {
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(size));
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
+   }
+   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
    ByteStream responseData(32768);
    responseData.setAllocationStep(32768);
-   curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &responseData);
+   curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseData);
 
    char errorText[CURL_ERROR_SIZE];
-   curl_easy_setopt(m_curl, CURLOPT_ERRORBUFFER, errorText);
-
-   curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, data);
+   curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorText);
 
    bool success;
-   if (curl_easy_perform(m_curl) == CURLE_OK)
+   if (curl_easy_perform(curl) == CURLE_OK)
    {
       long responseCode;
-      curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &responseCode);
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
       nxlog_debug_tag(DEBUG_TAG, 7, _T("HTTP response %03ld, %d bytes data"), responseCode, static_cast<int>(responseData.size()));
       if (responseData.size() > 0)
       {
@@ -129,6 +197,7 @@ bool APISender::send(const char *data)
    }
 
    curl_slist_free_all(headers);
+   MemFree(compressedData);
    return success;
 }
 
@@ -142,7 +211,7 @@ void APISender::addHeaders(curl_slist **headers)
 /**
  * Constructor for API v1 sender
  */
-APIv1Sender::APIv1Sender(const Config& config) : APISender(config), m_db(config.getValue(_T("/InfluxDB/Database"), _T("netxms"))),
+APIv1Sender::APIv1Sender(const Config& config, uint32_t id) : APISender(config, id), m_db(config.getValue(_T("/InfluxDB/Database"), _T("netxms"))),
          m_user(config.getValue(_T("/InfluxDB/User"), _T(""))), m_password(config.getValue(_T("/InfluxDB/Password"), _T("")))
 {
 }
@@ -183,7 +252,7 @@ void APIv1Sender::buildURL(char *url)
 /**
  * Constructor for API v2 sender
  */
-APIv2Sender::APIv2Sender(const Config& config) : APISender(config),
+APIv2Sender::APIv2Sender(const Config& config, uint32_t id) : APISender(config, id),
          m_organization(config.getValue(_T("/InfluxDB/Organization"), _T(""))), m_bucket(config.getValue(_T("/InfluxDB/Bucket"), _T("")))
 {
    m_token = UTF8StringFromTString(config.getValue(_T("/InfluxDB/Token"), _T("")));
@@ -100,12 +100,12 @@ bool InfluxDBStorageDriver::init(Config *config)
    {
       InfluxDBSender *sender;
       if (!_tcsicmp(protocol, _T("udp")))
-         sender = new UDPSender(*config);
+         sender = new UDPSender(*config, i);
 #if HAVE_LIBCURL
       else if (!_tcsicmp(protocol, _T("api-v1")))
-         sender = new APIv1Sender(*config);
+         sender = new APIv1Sender(*config, i);
       else
-         sender = new APIv2Sender(*config);
+         sender = new APIv2Sender(*config, i);
 #endif
       sender->start();
       m_senders.add(sender);
@@ -475,6 +475,13 @@ DataCollectionError InfluxDBStorageDriver::getInternalMetric(const TCHAR *metric
          size += m_senders.get(i)->getQueueSizeInBytes();
       ret_uint64(value, size);
    }
+   else if (!_tcsicmp(metric, _T("spoolSize")))
+   {
+      uint64_t size = 0;
+      for(int i = 0; i < m_senders.size(); i++)
+         size += m_senders.get(i)->getSpoolSize();
+      ret_uint64(value, size);
+   }
    else if (!_tcsicmp(metric, _T("queueSize.messages")))
    {
       uint32_t size = 0;
@@ -44,16 +44,58 @@
 // debug pdsdrv.influxdb 1-8
 #define DEBUG_TAG _T("pdsdrv.influxdb")
 
+/**
+ * Maximum number of worker threads per sender
+ */
+#define MAX_SENDER_WORKERS    16
+
+/**
+ * Data block ready for sending
+ */
+struct InfluxDBDataBlock
+{
+   char *data;
+   size_t size;
+   uint32_t messages;
+   uint64_t spoolId;    // non-zero if block was loaded from spool
+
+   InfluxDBDataBlock(char *_data, size_t _size, uint32_t _messages, uint64_t _spoolId = 0)
+   {
+      data = _data;
+      size = _size;
+      messages = _messages;
+      spoolId = _spoolId;
+   }
+   ~InfluxDBDataBlock()
+   {
+      MemFree(data);
+   }
+};
+
+/**
+ * Spooled data block
+ */
+struct InfluxDBSpoolFile
+{
+   uint64_t id;
+   uint64_t size;
+};
+
 /**
  * Abstract sender
  */
 class InfluxDBSender
 {
 protected:
+   uint32_t m_id;
    StringBuffer m_queue;
+   ObjectArray<InfluxDBDataBlock> m_pendingBlocks;
+   uint64_t m_pendingBytes;
+   uint32_t m_pendingMessages;
    uint32_t m_queueFlushThreshold;
    uint32_t m_queueSizeLimit;
    uint32_t m_maxCacheWaitTime;
+   int64_t m_lastFlushTime;
    String m_hostname;
    uint16_t m_port;
    time_t m_lastConnect;
@@ -65,9 +107,19 @@ class InfluxDBSender
    pthread_cond_t m_condition;
 #endif
    bool m_shutdown;
-   THREAD m_workerThread;
+   int m_workerCount;
+   THREAD m_workerThreads[MAX_SENDER_WORKERS];
    uint64_t m_messageDrops;
    uint32_t m_queuedMessages;
+   uint32_t m_minRetryInterval;
+   uint32_t m_maxRetryInterval;
+   uint32_t m_retryInterval;
+   int64_t m_retryTime;
+   TCHAR *m_spoolDirectory;
+   uint64_t m_spoolSizeLimit;
+   uint64_t m_spoolSize;
+   StructArray<InfluxDBSpoolFile> m_spoolFiles;
+   uint64_t m_nextSpoolId;
 
    void lock()
    {
@@ -87,12 +139,31 @@ class InfluxDBSender
 #endif
    }
 
-   void workerThread();
+   void wait(uint32_t timeout);
+   void wakeup()
+   {
+#ifdef _WIN32
+      WakeAllConditionVariable(&m_condition);
+#else
+      pthread_cond_broadcast(&m_condition);
+#endif
+   }
 
-   virtual bool send(const char *data) = 0;
+   void workerThread(int worker);
+   InfluxDBDataBlock *nextBlock(bool *spoolOnly);
+   InfluxDBDataBlock *takeQueuedData();
+   void requeueBlock(InfluxDBDataBlock *block);
+
+   void scanSpool();
+   void buildSpoolFileName(uint64_t id, TCHAR *path);
+   bool writeToSpool(InfluxDBDataBlock *block);
+   InfluxDBDataBlock *loadFromSpool(const InfluxDBSpoolFile& file);
+   void removeFromSpool(uint64_t id, size_t size);
+
+   virtual bool send(const char *data, size_t size, int worker) = 0;
 
 public:
-   InfluxDBSender(const Config& config);
+   InfluxDBSender(const Config& config, uint32_t id);
    virtual ~InfluxDBSender();
 
    void start();
@@ -102,6 +173,7 @@ class InfluxDBSender
    uint64_t getQueueSizeInBytes();
    uint32_t getQueueSizeInMessages();
    uint64_t getMessageDrops();
+   uint64_t getSpoolSize();
    bool isFull();
 };
 
@@ -113,12 +185,12 @@ class UDPSender : public InfluxDBSender
 protected:
    SOCKET m_socket;
 
-   virtual bool send(const char *data) override;
+   virtual bool send(const char *data, size_t size, int worker) override;
 
    void createSocket();
 
 public:
-   UDPSender(const Config& config);
+   UDPSender(const Config& config, uint32_t id);
    virtual ~UDPSender();
 };
 
@@ -130,16 +202,20 @@ class UDPSender : public InfluxDBSender
 class APISender : public InfluxDBSender
 {
 private:
-   CURL *m_curl;
+   CURL *m_curl[MAX_SENDER_WORKERS];
+   time_t m_curlCreateTime[MAX_SENDER_WORKERS];
+   bool m_compression;
+
+   CURL *createHandle(int worker);
 
 protected:
-   virtual bool send(const char *data) override;
+   virtual bool send(const char *data, size_t size, int worker) override;
 
    virtual void buildURL(char *url) = 0;
    virtual void addHeaders(curl_slist **headers);
 
 public:
-   APISender(const Config& config);
+   APISender(const Config& config, uint32_t id);
    virtual ~APISender();
 };
 
@@ -156,7 +232,7 @@ class APIv1Sender : public APISender
    virtual void buildURL(char *url) override;
 
 public:
-   APIv1Sender(const Config& config);
+   APIv1Sender(const Config& config, uint32_t id);
    virtual ~APIv1Sender();
 };
 
@@ -174,7 +250,7 @@ class APIv2Sender : public APISender
    virtual void addHeaders(curl_slist **headers) override;
 
 public:
-   APIv2Sender(const Config& config);
+   APIv2Sender(const Config& config, uint32_t id);
    virtual ~APIv2Sender();
 };
 
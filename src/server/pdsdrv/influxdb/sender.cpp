@@ -31,17 +31,23 @@
  **/
 
 #include "influxdb.h"
+#include <nxstat.h>
 
 /**
  * Constructor for abstract sender
  */
-InfluxDBSender::InfluxDBSender(const Config& config) : m_hostname(config.getValue(_T("/InfluxDB/Hostname"), _T("localhost")))
+InfluxDBSender::InfluxDBSender(const Config& config, uint32_t id) : m_pendingBlocks(0, 64, Ownership::True),
+         m_hostname(config.getValue(_T("/InfluxDB/Hostname"), _T("localhost"))), m_spoolFiles(0, 256)
 {
+   m_id = id;
    m_queuedMessages = 0;
    m_messageDrops = 0;
+   m_pendingBytes = 0;
+   m_pendingMessages = 0;
    m_queueFlushThreshold = config.getValueAsUInt(_T("/InfluxDB/QueueFlushThreshold"), 32768);   // Flush after 32K
    m_queueSizeLimit = config.getValueAsUInt(_T("/InfluxDB/QueueSizeLimit"), 4194304);  // 4MB upper limit on queue size
    m_maxCacheWaitTime = config.getValueAsUInt(_T("/InfluxDB/MaxCacheWaitTime"), 30000);
+   m_lastFlushTime = GetCurrentTimeMs();
    m_port = static_cast<uint16_t>(config.getValueAsUInt(_T("/InfluxDB/Port"), 0));
    m_lastConnect = 0;
 #ifdef _WIN32
@@ -60,7 +66,37 @@ InfluxDBSender::InfluxDBSender(const Config& config) : m_hostname(config.getValu
    pthread_cond_init(&m_condition, nullptr);
 #endif
    m_shutdown = false;
-   m_workerThread = INVALID_THREAD_HANDLE;
+
+   m_workerCount = config.getValueAsInt(_T("/InfluxDB/Workers"), 1);
+   if (m_workerCount < 1)
+      m_workerCount = 1;
+   else if (m_workerCount > MAX_SENDER_WORKERS)
+      m_workerCount = MAX_SENDER_WORKERS;
+   for(int i = 0; i < MAX_SENDER_WORKERS; i++)
+      m_workerThreads[i] = INVALID_THREAD_HANDLE;
+
+   m_minRetryInterval = std::max(config.getValueAsUInt(_T("/InfluxDB/MinRetryInterval"), 100), 10u);
+   m_maxRetryInterval = std::max(config.getValueAsUInt(_T("/InfluxDB/MaxRetryInterval"), 60000), m_minRetryInterval);
+   m_retryInterval = 0;
+   m_retryTime = 0;
+
+   const TCHAR *spoolDirectory = config.getValue(_T("/InfluxDB/SpoolDirectory"), _T(""));
+   if (*spoolDirectory != 0)
+   {
+      StringBuffer path(spoolDirectory);
+      if (path.charAt(path.length() - 1) != FS_PATH_SEPARATOR_CHAR)
+         path.append(FS_PATH_SEPARATOR_CHAR);
+      path.append(_T("queue"));
+      path.append(m_id);
+      m_spoolDirectory = MemCopyString(path);
+   }
+   else
+   {
+      m_spoolDirectory = nullptr;
+   }
+   m_spoolSizeLimit = config.getValueAsUInt64(_T("/InfluxDB/SpoolSizeLimit"), _ULL(1073741824));  // 1GB upper limit on spool size
+   m_spoolSize = 0;
+   m_nextSpoolId = 1;
 }
 
 /**
@@ -69,6 +105,7 @@ InfluxDBSender::InfluxDBSender(const Config& config) : m_hostname(config.getValu
 InfluxDBSender::~InfluxDBSender()
 {
    stop();
+   MemFree(m_spoolDirectory);
 #ifdef _WIN32
    DeleteCriticalSection(&m_mutex);
 #else
@@ -78,88 +115,326 @@ InfluxDBSender::~InfluxDBSender()
 }
 
 /**
- * Sender worker thread
+ * Wait for wakeup or timeout. Should be called with sender lock held. Spurious wakeups are possible, so caller should re-check its condition.
  */
-void InfluxDBSender::workerThread()
+void InfluxDBSender::wait(uint32_t timeout)
 {
-   nxlog_debug_tag(DEBUG_TAG, 2, _T("Sender thread started"));
-
-   while(!m_shutdown)
-   {
 #ifdef _WIN32
-      EnterCriticalSection(&m_mutex);
-      if (m_queue.length() < m_queueFlushThreshold)
-      {
-         // SleepConditionVariableCS is subject to spurious wakeups so we need a loop here
-         BOOL signalled = FALSE;
-         uint32_t timeout = m_maxCacheWaitTime;
-         do
-         {
-            int64_t startTime = GetCurrentTimeMs();
-            signalled = SleepConditionVariableCS(&m_condition, &m_mutex, timeout);
-            if (signalled)
-               break;
-            timeout -= std::min(timeout, static_cast<uint32_t>(GetCurrentTimeMs() - startTime));
-         } while (timeout > 0);
-      }
+   SleepConditionVariableCS(&m_condition, &m_mutex, timeout);
 #else
-      pthread_mutex_lock(&m_mutex);
-      if (m_queue.length() < m_queueFlushThreshold)
-      {
 #if HAVE_PTHREAD_COND_RELTIMEDWAIT_NP
-         struct timespec timeout;
-         timeout.tv_sec = m_maxCacheWaitTime / 1000;
-         timeout.tv_nsec = (m_maxCacheWaitTime % 1000) * 1000000;
-         pthread_cond_reltimedwait_np(&m_condition, &m_mutex, &timeout);
+   struct timespec ts;
+   ts.tv_sec = timeout / 1000;
+   ts.tv_nsec = (timeout % 1000) * 1000000;
+   pthread_cond_reltimedwait_np(&m_condition, &m_mutex, &ts);
 #else
-         struct timeval now;
-         gettimeofday(&now, nullptr);
-
-         struct timespec timeout;
-         timeout.tv_sec = now.tv_sec + (m_maxCacheWaitTime / 1000);
-         now.tv_usec += (m_maxCacheWaitTime % 1000) * 1000;
-         timeout.tv_sec += now.tv_usec / 1000000;
-         timeout.tv_nsec = (now.tv_usec % 1000000) * 1000;
-         pthread_cond_timedwait(&m_condition, &m_mutex, &timeout);
+   struct timeval now;
+   gettimeofday(&now, nullptr);
+
+   struct timespec ts;
+   ts.tv_sec = now.tv_sec + (timeout / 1000);
+   now.tv_usec += (timeout % 1000) * 1000;
+   ts.tv_sec += now.tv_usec / 1000000;
+   ts.tv_nsec = (now.tv_usec % 1000000) * 1000;
+   pthread_cond_timedwait(&m_condition, &m_mutex, &ts);
 #endif
-      }
 #endif
+}
+
+/**
+ * Convert accumulated data into data block. Should be called with sender lock held.
+ */
+InfluxDBDataBlock *InfluxDBSender::takeQueuedData()
+{
+   if (m_queue.isEmpty())
+      return nullptr;
+
+   char *data = m_queue.getUTF8String();
+   auto block = new InfluxDBDataBlock(data, strlen(data), m_queuedMessages);
+   m_queue.clear();
+   m_queuedMessages = 0;
+   m_lastFlushTime = GetCurrentTimeMs();
+   return block;
+}
 
-      if (m_queue.isEmpty())
+/**
+ * Get next data block for worker. Returns nullptr on shutdown or if spooled block cannot be loaded.
+ * If sender is in backoff state and spool is enabled, accumulated data is returned with spoolOnly flag set.
+ */
+InfluxDBDataBlock *InfluxDBSender::nextBlock(bool *spoolOnly)
+{
+   InfluxDBDataBlock *block = nullptr;
+   InfluxDBSpoolFile spoolFile;
+   spoolFile.id = 0;
+
+   lock();
+   while(!m_shutdown)
+   {
+      int64_t now = GetCurrentTimeMs();
+      bool backoff = (m_retryTime > now);
+      *spoolOnly = backoff;
+      if (backoff && (m_spoolDirectory == nullptr))
       {
-#ifdef _WIN32
-         LeaveCriticalSection(&m_mutex);
-#else
-         pthread_mutex_unlock(&m_mutex);
-#endif
+         wait(static_cast<uint32_t>(m_retryTime - now));
          continue;
       }
 
-      char *data = m_queue.getUTF8String();
-      m_queue.clear();
-      m_queuedMessages = 0;
+      if (!backoff && !m_pendingBlocks.isEmpty())
+      {
+         block = m_pendingBlocks.get(0);
+         m_pendingBlocks.unlink(0);
+         m_pendingBytes -= block->size;
+         m_pendingMessages -= block->messages;
+         break;
+      }
 
-#ifdef _WIN32
-      LeaveCriticalSection(&m_mutex);
-#else
-      pthread_mutex_unlock(&m_mutex);
-#endif
+      uint32_t elapsed = static_cast<uint32_t>(now - m_lastFlushTime);
+      if ((m_queue.length() >= m_queueFlushThreshold) || (!m_queue.isEmpty() && (elapsed >= m_maxCacheWaitTime)))
+      {
+         block = takeQueuedData();
+         break;
+      }
+
+      if (!backoff && !m_spoolFiles.isEmpty())
+      {
+         spoolFile = *m_spoolFiles.get(0);
+         m_spoolFiles.remove(0);
+         break;
+      }
+
+      uint32_t timeout = (elapsed < m_maxCacheWaitTime) ? m_maxCacheWaitTime - elapsed : m_maxCacheWaitTime;
+      if (backoff)
+         timeout = std::min(timeout, static_cast<uint32_t>(m_retryTime - now));
+      wait(timeout);
+   }
+   unlock();
+
+   if (spoolFile.id != 0)
+      block = loadFromSpool(spoolFile);
+   return block;
+}
+
+/**
+ * Return block that was not sent. Block is written to spool if spool is enabled, otherwise it will be sent first on next attempt.
+ * Takes ownership of block.
+ */
+void InfluxDBSender::requeueBlock(InfluxDBDataBlock *block)
+{
+   if (block->spoolId != 0)
+   {
+      // Already in spool, just put it back into the list
+      InfluxDBSpoolFile f;
+      f.id = block->spoolId;
+      f.size = block->size;
+      lock();
+      m_spoolFiles.add(f);
+      unlock();
+      delete block;
+      return;
+   }
+
+   if ((m_spoolDirectory != nullptr) && writeToSpool(block))
+   {
+      delete block;
+      return;
+   }
+
+   lock();
+   m_pendingBlocks.insert(0, block);
+   m_pendingBytes += block->size;
+   m_pendingMessages += block->messages;
+   unlock();
+}
+
+/**
+ * Sender worker thread
+ */
+void InfluxDBSender::workerThread(int worker)
+{
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("Sender %u worker #%d started"), m_id, worker);
 
-      if (!send(data))
+   while(!m_shutdown)
+   {
+      bool spoolOnly;
+      InfluxDBDataBlock *block = nextBlock(&spoolOnly);
+      if (block == nullptr)
+         continue;
+
+      if (spoolOnly)
       {
-         nxlog_debug_tag(DEBUG_TAG, 4, _T("Data block send failed"));
-         while(!m_shutdown)
+         requeueBlock(block);
+         continue;
+      }
+
+      if (send(block->data, block->size, worker))
+      {
+         lock();
+         bool recovered = (m_retryInterval != 0);
+         m_retryInterval = 0;
+         m_retryTime = 0;
+         if (recovered)
+            wakeup();
+         unlock();
+         if (recovered)
+            nxlog_debug_tag(DEBUG_TAG, 4, _T("Sender %u: connection restored"), m_id);
+
+         if (block->spoolId != 0)
+            removeFromSpool(block->spoolId, block->size);
+         delete block;
+      }
+      else
+      {
+         // Exponential backoff - only first failure within current retry interval extends it
+         lock();
+         int64_t now = GetCurrentTimeMs();
+         if (m_retryTime <= now)
          {
-            ThreadSleep(10);
-            if (send(data))
-               break;
+            m_retryInterval = (m_retryInterval == 0) ? m_minRetryInterval : std::min(m_retryInterval * 2, m_maxRetryInterval);
+            m_retryTime = now + m_retryInterval;
          }
+         uint32_t retryInterval = m_retryInterval;
+         unlock();
+         nxlog_debug_tag(DEBUG_TAG, 4, _T("Sender %u: data block send failed (worker #%d), next attempt in %u ms"), m_id, worker, retryInterval);
+         requeueBlock(block);
       }
+   }
 
-      MemFree(data);
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("Sender %u worker #%d stopped"), m_id, worker);
+}
+
+/**
+ * Build name of spool file
+ */
+void InfluxDBSender::buildSpoolFileName(uint64_t id, TCHAR *path)
+{
+   _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR UINT64X_FMT(_T("016")) _T(".lp"), m_spoolDirectory, id);
+}
+
+/**
+ * Compare spool files by ID
+ */
+static int CompareSpoolFiles(const void *e1, const void *e2)
+{
+   uint64_t id1 = static_cast<const InfluxDBSpoolFile*>(e1)->id;
+   uint64_t id2 = static_cast<const InfluxDBSpoolFile*>(e2)->id;
+   return (id1 < id2) ? -1 : ((id1 > id2) ? 1 : 0);
+}
+
+/**
+ * Scan spool directory for data left from previous run
+ */
+void InfluxDBSender::scanSpool()
+{
+   if (!CreateDirectoryTree(m_spoolDirectory))
+   {
+      nxlog_write_tag(NXLOG_ERROR, DEBUG_TAG, _T("Cannot create spool directory %s, spooling disabled"), m_spoolDirectory);
+      MemFreeAndNull(m_spoolDirectory);
+      return;
+   }
+
+   _TDIR *dir = _topendir(m_spoolDirectory);
+   if (dir == nullptr)
+      return;
+
+   struct _tdirent *f;
+   while((f = _treaddir(dir)) != nullptr)
+   {
+      if (!MatchString(_T("*.lp"), f->d_name, true))
+         continue;
+
+      TCHAR *eptr;
+      uint64_t id = _tcstoull(f->d_name, &eptr, 16);
+      if ((id == 0) || _tcscmp(eptr, _T(".lp")))
+         continue;
+
+      TCHAR path[MAX_PATH];
+      buildSpoolFileName(id, path);
+      NX_STAT_STRUCT st;
+      if (CALL_STAT(path, &st) != 0)
+         continue;
+
+      InfluxDBSpoolFile sf;
+      sf.id = id;
+      sf.size = st.st_size;
+      m_spoolFiles.add(sf);
+      m_spoolSize += sf.size;
+      if (id >= m_nextSpoolId)
+         m_nextSpoolId = id + 1;
    }
+   _tclosedir(dir);
 
-   nxlog_debug_tag(DEBUG_TAG, 2, _T("Sender thread stopped"));
+   m_spoolFiles.sort(CompareSpoolFiles);
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("Sender %u: %d spooled data blocks (") UINT64_FMT _T(" bytes) found in %s"),
+            m_id, m_spoolFiles.size(), m_spoolSize, m_spoolDirectory);
+}
+
+/**
+ * Write data block to spool
+ */
+bool InfluxDBSender::writeToSpool(InfluxDBDataBlock *block)
+{
+   lock();
+   if (m_spoolSize + block->size > m_spoolSizeLimit)
+   {
+      unlock();
+      nxlog_debug_tag(DEBUG_TAG, 5, _T("Sender %u: spool size limit reached"), m_id);
+      return false;
+   }
+   uint64_t id = m_nextSpoolId++;
+   m_spoolSize += block->size;
+   unlock();
+
+   TCHAR path[MAX_PATH];
+   buildSpoolFileName(id, path);
+   if (SaveFile(path, block->data, block->size) != SaveFileStatus::SUCCESS)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("Sender %u: cannot write spool file %s"), m_id, path);
+      lock();
+      m_spoolSize -= block->size;
+      unlock();
+      return false;
+   }
+
+   InfluxDBSpoolFile f;
+   f.id = id;
+   f.size = block->size;
+   lock();
+   m_spoolFiles.add(f);
+   unlock();
+   nxlog_debug_tag(DEBUG_TAG, 7, _T("Sender %u: data block with %u messages written to spool file %s"), m_id, block->messages, path);
+   return true;
+}
+
+/**
+ * Load data block from spool
+ */
+InfluxDBDataBlock *InfluxDBSender::loadFromSpool(const InfluxDBSpoolFile& file)
+{
+   TCHAR path[MAX_PATH];
+   buildSpoolFileName(file.id, path);
+   size_t size;
+   char *data = reinterpret_cast<char*>(LoadFile(path, &size));
+   if (data == nullptr)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 4, _T("Sender %u: cannot load spool file %s"), m_id, path);
+      removeFromSpool(file.id, static_cast<size_t>(file.size));
+      return nullptr;
+   }
+   return new InfluxDBDataBlock(data, size, 0, file.id);
+}
+
+/**
+ * Remove data block from spool
+ */
+void InfluxDBSender::removeFromSpool(uint64_t id, size_t size)
+{
+   TCHAR path[MAX_PATH];
+   buildSpoolFileName(id, path);
+   _tremove(path);
+
+   lock();
+   m_spoolSize -= std::min(static_cast<uint64_t>(size), m_spoolSize);
+   unlock();
 }
 
 /**
@@ -167,22 +442,58 @@ void InfluxDBSender::workerThread()
  */
 void InfluxDBSender::start()
 {
-   m_workerThread = ThreadCreateEx(this, &InfluxDBSender::workerThread);
+   if (m_spoolDirectory != nullptr)
+      scanSpool();
+
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("Starting sender %u with %d worker%s"), m_id, m_workerCount, (m_workerCount > 1) ? _T("s") : _T(""));
+   for(int i = 0; i < m_workerCount; i++)
+      m_workerThreads[i] = ThreadCreateEx(this, &InfluxDBSender::workerThread, i);
 }
 
 /**
- * Stop sender
+ * Stop sender. If spool is enabled, unsent data is written to spool.
  */
 void InfluxDBSender::stop()
 {
+   lock();
    m_shutdown = true;
-#ifdef _WIN32
-   WakeAllConditionVariable(&m_condition);
-#else
-   pthread_cond_broadcast(&m_condition);
-#endif
-   ThreadJoin(m_workerThread);
-   m_workerThread = INVALID_THREAD_HANDLE;
+   wakeup();
+   unlock();
+
+   for(int i = 0; i < m_workerCount; i++)
+   {
+      ThreadJoin(m_workerThreads[i]);
+      m_workerThreads[i] = INVALID_THREAD_HANDLE;
+   }
+
+   if (m_spoolDirectory == nullptr)
+      return;
+
+   lock();
+   InfluxDBDataBlock *block = takeQueuedData();
+   if (block != nullptr)
+   {
+      m_pendingBlocks.add(block);
+      m_pendingBytes += block->size;
+      m_pendingMessages += block->messages;
+   }
+   unlock();
+
+   int count = 0;
+   while(!m_pendingBlocks.isEmpty())
+   {
+      block = m_pendingBlocks.get(0);
+      m_pendingBlocks.unlink(0);
+      m_pendingBytes -= block->size;
+      m_pendingMessages -= block->messages;
+      if (writeToSpool(block))
+         count++;
+      else
+         m_messageDrops += block->messages;
+      delete block;
+   }
+   if (count > 0)
+      nxlog_debug_tag(DEBUG_TAG, 2, _T("Sender %u: %d unsent data blocks written to spool"), m_id, count);
 }
 
 /**
@@ -192,19 +503,13 @@ void InfluxDBSender::enqueue(const TCHAR *data)
 {
    lock();
 
-   if (m_queue.length() < m_queueSizeLimit)
+   if (m_queue.length() + m_pendingBytes < m_queueSizeLimit)
    {
       m_queue.append(data);
       m_queue.append(_T('\n'));
       m_queuedMessages++;
       if (m_queue.length() >= m_queueFlushThreshold)
-      {
-#ifdef _WIN32
-         WakeAllConditionVariable(&m_condition);
-#else
-         pthread_cond_broadcast(&m_condition);
-#endif
-      }
+         wakeup();
    }
    else
    {
@@ -220,7 +525,7 @@ void InfluxDBSender::enqueue(const TCHAR *data)
 uint64_t InfluxDBSender::getQueueSizeInBytes()
 {
    lock();
-   uint64_t s = m_queue.length();
+   uint64_t s = m_queue.length() + m_pendingBytes;
    unlock();
    return s;
 }
@@ -231,7 +536,7 @@ uint64_t InfluxDBSender::getQueueSizeInBytes()
 uint32_t InfluxDBSender::getQueueSizeInMessages()
 {
    lock();
-   uint32_t s = m_queuedMessages;
+   uint32_t s = m_queuedMessages + m_pendingMessages;
    unlock();
    return s;
 }
@@ -242,7 +547,7 @@ uint32_t InfluxDBSender::getQueueSizeInMessages()
 bool InfluxDBSender::isFull()
 {
    lock();
-   bool result = (m_queue.length() >= m_queueSizeLimit);
+   bool result = (m_queue.length() + m_pendingBytes >= m_queueSizeLimit);
    unlock();
    return result;
 }
@@ -257,3 +562,14 @@ uint64_t InfluxDBSender::getMessageDrops()
    unlock();
    return count;
 }
+
+/**
+ * Get size of spooled data in bytes
+ */
+uint64_t InfluxDBSender::getSpoolSize()
+{
+   lock();
+   uint64_t size = m_spoolSize;
+   unlock();
+   return size;
+}
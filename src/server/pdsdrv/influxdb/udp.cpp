@@ -35,8 +35,9 @@
 /**
  * Constructor for UDP sender
  */
-UDPSender::UDPSender(const Config& config) : InfluxDBSender(config)
+UDPSender::UDPSender(const Config& config, uint32_t id) : InfluxDBSender(config, id)
 {
+   m_workerCount = 1;   // Parallel sending gives no benefit for UDP
    if (m_queueSizeLimit > 64000)
       m_queueSizeLimit = 64000;  // Cannot send more than 64K over UDP
    if (m_port == 0)
@@ -49,6 +50,7 @@ UDPSender::UDPSender(const Config& config) : InfluxDBSender(config)
  */
 UDPSender::~UDPSender()
 {
+   stop();
    if (m_socket != INVALID_SOCKET)
       closesocket(m_socket);
 }
@@ -77,7 +79,7 @@ void UDPSender::createSocket()
 /**
  * Send data block over UDP
  */
-bool UDPSender::send(const char *data)
+bool UDPSender::send(const char *data, size_t size, int worker)
 {
    if (m_socket == INVALID_SOCKET)
    {
@@ -90,7 +92,7 @@ bool UDPSender::send(const char *data)
          return false;
    }
 
-   if (SendEx(m_socket, data, strlen(data), 0, nullptr) <= 0)
+   if (SendEx(m_socket, data, size, 0, nullptr) <= 0)
    {
       closesocket(m_socket);
       m_socket = INVALID_SOCKET;
@@ -24,87 +24,99 @@
 #include <math.h>
 
 /**
- * Node constructor
+ * Get random initial weight
  */
-NeuralNetworkNode::NeuralNetworkNode(int nextLevelSize)
+static inline double RandomWeight()
 {
-   numWeights = nextLevelSize;
-   weights = new double[nextLevelSize];
-   weightGradients = new double[nextLevelSize];
-   for(int i = 0; i < nextLevelSize; i++)
-      weights[i] = static_cast<double>(rand()) / RAND_MAX * (0.001 - 0.0001) + 0.0001;
-   bias = static_cast<double>(rand()) / RAND_MAX * (0.001 - 0.0001) + 0.0001;
-   biasGradient = 0.0;
-   value = 0.0;
+   return static_cast<double>(rand()) / RAND_MAX * (0.001 - 0.0001) + 0.0001;
 }
 
 /**
- * Node destructor
+ * Constructor
  */
-NeuralNetworkNode::~NeuralNetworkNode()
+NeuralNetwork::NeuralNetwork(int inputCount, int hiddenCount) : m_mutex(MutexType::FAST)
 {
-   delete[] weights;
-   delete[] weightGradients;
+   m_inputCount = inputCount;
+   m_hiddenCount = hiddenCount;
+   m_inputWeights = MemAllocArrayNoInit<double>(inputCount * hiddenCount);
+   m_hiddenBiases = MemAllocArrayNoInit<double>(hiddenCount);
+   m_hiddenWeights = MemAllocArrayNoInit<double>(hiddenCount);
+   m_hiddenValues = MemAllocArray<double>(hiddenCount);
+   for(int i = 0; i < inputCount * hiddenCount; i++)
+      m_inputWeights[i] = RandomWeight();
+   for(int i = 0; i < hiddenCount; i++)
+   {
+      m_hiddenBiases[i] = RandomWeight();
+      m_hiddenWeights[i] = RandomWeight();
+   }
+   m_outputBias = RandomWeight();
 }
 
 /**
- * Reset node before training
+ * Copy constructor
  */
-void NeuralNetworkNode::reset()
+NeuralNetwork::NeuralNetwork(const NeuralNetwork& src) : m_mutex(MutexType::FAST)
 {
-   for(int i = 0; i < numWeights; i++)
-      weightGradients[i] = 0.0;
-   biasGradient = 0.0;
+   m_inputCount = src.m_inputCount;
+   m_hiddenCount = src.m_hiddenCount;
+   m_inputWeights = MemCopyArray(src.m_inputWeights, m_inputCount * m_hiddenCount);
+   m_hiddenBiases = MemCopyArray(src.m_hiddenBiases, m_hiddenCount);
+   m_hiddenWeights = MemCopyArray(src.m_hiddenWeights, m_hiddenCount);
+   m_hiddenValues = MemAllocArray<double>(m_hiddenCount);
+   m_outputBias = src.m_outputBias;
 }
 
 /**
- * Constructor
+ * Destructor
  */
-NeuralNetwork::NeuralNetwork(int inputCount, int hiddenCount) :
-      m_input(inputCount, 8, Ownership::True), m_hidden(hiddenCount, 8, Ownership::True), m_output(1), m_mutex(MutexType::FAST)
+NeuralNetwork::~NeuralNetwork()
 {
-   for(int i = 0; i < inputCount; i++)
-      m_input.add(new NeuralNetworkNode(hiddenCount));
-   for(int i = 0; i < hiddenCount; i++)
-      m_hidden.add(new NeuralNetworkNode(1));
+   MemFree(m_inputWeights);
+   MemFree(m_hiddenBiases);
+   MemFree(m_hiddenWeights);
+   MemFree(m_hiddenValues);
 }
 
 /**
- * Destructor
+ * Copy weights from other network with same topology
  */
-NeuralNetwork::~NeuralNetwork()
+void NeuralNetwork::copyWeights(const NeuralNetwork& src)
 {
+   if ((src.m_inputCount != m_inputCount) || (src.m_hiddenCount != m_hiddenCount))
+      return;
+   memcpy(m_inputWeights, src.m_inputWeights, sizeof(double) * m_inputCount * m_hiddenCount);
+   memcpy(m_hiddenBiases, src.m_hiddenBiases, sizeof(double) * m_hiddenCount);
+   memcpy(m_hiddenWeights, src.m_hiddenWeights, sizeof(double) * m_hiddenCount);
+   m_outputBias = src.m_outputBias;
 }
 
 /**
- * Compute output value
+ * Compute output value. Hidden node outputs are stored in provided buffer.
  */
-double NeuralNetwork::computeOutput(double *inputs)
+double NeuralNetwork::forward(const double *inputs, double *hiddenValues) const
 {
-   for(int i = 0; i < m_input.size(); i++)
-      m_input.get(i)->value = inputs[i];
-
-   double os = 0.0;
-   for(int i = 0; i < m_hidden.size(); i++)
+   double os = m_outputBias;
+   const double *w = m_inputWeights;
+   for(int i = 0; i < m_hiddenCount; i++, w += m_inputCount)
    {
-      double s = 0.0;
-      for(int j = 0; j < m_input.size(); j++)   // compute i-h sum of weights * inputs
-      {
-         s += inputs[j] + m_input.get(j)->weights[i];
-      }
-      s += m_hidden.get(i)->bias;
-
+      double s = m_hiddenBiases[i];
+      for(int j = 0; j < m_inputCount; j++)   // input-hidden sum of weights * inputs
+         s += inputs[j] * w[j];
       double v = tanh(s);
-      m_hidden.get(i)->value = v;
-
-      os += v * m_hidden.get(i)->weights[0]; // update h-o sum of weights * hidden
+      hiddenValues[i] = v;
+      os += v * m_hiddenWeights[i];  // hidden-output sum of weights * hidden
    }
-
-   os += m_output.bias; // add bias to output sum
-   m_output.value = os;
    return os;
 }
 
+/**
+ * Compute output value
+ */
+double NeuralNetwork::computeOutput(const double *inputs)
+{
+   return forward(inputs, m_hiddenValues);
+}
+
 /**
  * Shuffle array
  */
@@ -113,107 +125,65 @@ static void Shuffle(int *data, int size)
    for(int i = 0; i < size - 1; i++)
    {
       int idx = i + rand() % (size - i);
-      int t = data[idx];
+      int t = data[i];
       data[i] = data[idx];
       data[idx] = t;
    }
 }
 
 /**
- * Train network using given data series
+ * Train network using given data series. Each training sample is a window of input count
+ * consecutive values from the series, with next value as expected output.
  */
-void NeuralNetwork::train(double *series, size_t length, int rounds, double learnRate)
+void NeuralNetwork::train(const double *series, size_t length, int rounds, double learnRate)
 {
-   if (length <= m_input.size())
+   if (length <= static_cast<size_t>(m_inputCount))
       return;  // Series is too short
 
-   // Prepare training data
-   int blockCount = static_cast<int>(length) - m_input.size();
-   int blockSize = m_input.size() + 1;
-   double **trainData = new double*[blockCount];
-   int idx = 0;
-   for(int i = 0; i < blockCount; i++)
-   {
-      trainData[i] = new double[blockSize];
-      memcpy(trainData[i], &series[idx++], sizeof(double) * blockSize);
-   }
-
-   double *hSignals = new double[m_hidden.size()];
-
-   for(int i = 0; i < m_input.size(); i++)
-      m_input.get(i)->reset();
-   for(int i = 0; i < m_hidden.size(); i++)
-      m_hidden.get(i)->reset();
-   m_output.reset();
+   int sampleCount = static_cast<int>(length) - m_inputCount;
+   double *hiddenSignals = MemAllocArray<double>(m_hiddenCount);
 
    // Processing sequence
-   int *sequence = new int[blockCount];
-   for(int i = 0; i < blockCount; i++)
+   int *sequence = MemAllocArrayNoInit<int>(sampleCount);
+   for(int i = 0; i < sampleCount; i++)
       sequence[i] = i;
 
    while(rounds-- > 0)
    {
-      Shuffle(sequence, blockCount); // visit each block in random order
-      for(int i = 0; i < blockCount; i++)
+      Shuffle(sequence, sampleCount); // visit each sample in random order
+      for(int i = 0; i < sampleCount; i++)
       {
-         double *block = trainData[sequence[i]];
-         double target = block[m_input.size()];
-         computeOutput(block);
+         const double *inputs = &series[sequence[i]];
+         double target = inputs[m_inputCount];
 
-         // 1. compute output node signal
-         double errorSignal = target - m_output.value;
+         // Forward pass
+         double errorSignal = target - forward(inputs, m_hiddenValues);
 
-         // 2. compute hidden-to-output weight gradients using output signals
-         for(int j = 0; j < m_hidden.size(); j++)
-            m_hidden.get(j)->weightGradients[0] = errorSignal * m_hidden.get(j)->value;
-
-         // 3. compute output bias gradients using output signals
-         m_output.biasGradient = errorSignal;
-
-         // 4. compute hidden node signals
-         for(int j = 0; j < m_hidden.size(); j++)
-         {
-            NeuralNetworkNode *n = m_hidden.get(j);
-            double derivative = (1 + n->value) * (1 - n->value);
-            hSignals[j] = derivative * n->weights[0];
-         }
-
-         // 5. compute input-hidden weight gradients
-         for(int j = 0; j < m_input.size(); j++)
+         // Hidden node signals (computed with hidden-output weights before update)
+         for(int j = 0; j < m_hiddenCount; j++)
          {
-            NeuralNetworkNode *n = m_input.get(j);
-            for(int k = 0; k < m_hidden.size(); k++)
-               n->weightGradients[k] = hSignals[k] * n->value;
+            double v = m_hiddenValues[j];
+            hiddenSignals[j] = (1 + v) * (1 - v) * m_hiddenWeights[j] * errorSignal;
          }
 
-         // 6. compute hidden node bias gradients
-         for(int j = 0; j < m_hidden.size(); j++)
-            m_hidden.get(j)->biasGradient = hSignals[j];
+         // Update hidden-output weights and output bias
+         double rate = errorSignal * learnRate;
+         for(int j = 0; j < m_hiddenCount; j++)
+            m_hiddenWeights[j] += m_hiddenValues[j] * rate;
+         m_outputBias += rate;
 
-         // 7. update input-to-hidden weights
-         for(int j = 0; j < m_input.size(); j++)
+         // Update input-hidden weights and hidden biases
+         double *w = m_inputWeights;
+         for(int j = 0; j < m_hiddenCount; j++, w += m_inputCount)
          {
-            NeuralNetworkNode *n = m_input.get(j);
-            for(int k = 0; k < m_hidden.size(); k++)
-               n->weights[k] += n->weightGradients[k] * learnRate;
+            double hrate = hiddenSignals[j] * learnRate;
+            for(int k = 0; k < m_inputCount; k++)
+               w[k] += inputs[k] * hrate;
+            m_hiddenBiases[j] += hrate;
          }
-
-         // 8. update hidden biases and hidden-to-output weights
-         for(int j = 0; j < m_hidden.size(); j++)
-         {
-            NeuralNetworkNode *n = m_hidden.get(j);
-            n->bias += n->biasGradient * learnRate;
-            n->weights[0] += n->weightGradients[0] * learnRate;
-         }
-
-         // 9. update output node bias
-         m_output.bias += m_output.biasGradient * learnRate;
       }
    }
 
-   delete[] hSignals;
-   delete[] sequence;
-   for(int i = 0; i < blockCount; i++)
-      delete[] trainData[i];
-   delete[] trainData;
+   MemFree(hiddenSignals);
+   MemFree(sequence);
 }
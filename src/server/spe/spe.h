@@ -31,40 +31,31 @@
 #include <npe.h>
 
 /**
- * Neural network node
- */
-struct NeuralNetworkNode
-{
-   int numWeights;
-   double *weights;
-   double *weightGradients;
-   double bias;
-   double biasGradient;
-   double value;
-
-   NeuralNetworkNode(int nextLevelSize);
-   ~NeuralNetworkNode();
-
-   void reset();
-};
-
-/**
- * Neural network class
+ * Neural network class (one hidden layer, single output). Weights are stored in contiguous arrays,
+ * input-hidden weights as row-major matrix with one row per hidden node.
  */
 class NeuralNetwork
 {
 private:
-   ObjectArray<NeuralNetworkNode> m_input;
-   ObjectArray<NeuralNetworkNode> m_hidden;
-   NeuralNetworkNode m_output;
+   int m_inputCount;
+   int m_hiddenCount;
+   double *m_inputWeights;
+   double *m_hiddenBiases;
+   double *m_hiddenWeights;
+   double *m_hiddenValues;
+   double m_outputBias;
    Mutex m_mutex;
 
+   double forward(const double *inputs, double *hiddenValues) const;
+
 public:
    NeuralNetwork(int inputCount, int hiddenCount);
+   NeuralNetwork(const NeuralNetwork& src);
    ~NeuralNetwork();
 
-   double computeOutput(double *inputs);
-   void train(double *series, size_t length, int rounds, double learnRate);
+   double computeOutput(const double *inputs);
+   void train(const double *series, size_t length, int rounds, double learnRate);
+   void copyWeights(const NeuralNetwork& src);
 
    void lock() { m_mutex.lock(); }
    void unlock() { m_mutex.unlock(); }
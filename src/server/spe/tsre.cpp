@@ -110,8 +110,16 @@ void TimeSeriesRegressionEngine::train(UINT32 nodeId, UINT32 dciId, DCObjectStor
       double *series = new double[values->size()];
       for(int i = 0, j = values->size(); i < values->size(); i++)
          series[--j] = values->get(i)->value;
+
+      // Train copy of the network so that predictions are not blocked during training
       NeuralNetwork *nn = acquireNetwork(nodeId, dciId);
-      nn->train(series, values->size(), 10000, 0.01);
+      NeuralNetwork trainee(*nn);
+      nn->unlock();
+
+      trainee.train(series, values->size(), 10000, 0.01);
+
+      nn = acquireNetwork(nodeId, dciId);
+      nn->copyWeights(trainee);
       nn->unlock();
       delete[] series;
    }
@@ -232,7 +240,7 @@ bool TimeSeriesRegressionEngine::getPredictedSeries(UINT32 nodeId, UINT32 dciId,
  */
 int TimeSeriesRegressionEngine::getRequiredCacheSize() const
 {
-   return 1;
+   return INPUT_LAYER_SIZE;
 }
 
 /**
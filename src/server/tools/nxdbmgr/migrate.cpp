@@ -208,13 +208,162 @@ static bool ConnectToSource()
 }
 
 /**
- * Migrate single database table
+ * Report migration progress. In sequential mode progress is shown as single updating counter,
+ * in parallel mode each worker periodically prints separate progress line.
  */
-static bool MigrateTable(const TCHAR *table)
+static void ReportMigrationProgress(const TCHAR *table, int64_t rows, int64_t startTime, int64_t *lastReportTime)
+{
+   if (g_migrationJobs < 2)
+   {
+      _tprintf(_T("%8d\r"), static_cast<int>(rows));
+      fflush(stdout);
+      return;
+   }
+
+   int64_t now = GetCurrentTimeMs();
+   if (now - *lastReportTime < 10000)
+      return;
+   *lastReportTime = now;
+   WriteToTerminalEx(_T("   %s: ") INT64_FMT _T(" rows (") INT64_FMT _T(" rows/sec)\n"), table, rows, rows * 1000 / std::max(now - startTime, static_cast<int64_t>(1)));
+}
+
+/**
+ * Report completion of table migration
+ */
+static void ReportMigrationCompletion(const TCHAR *table, int64_t rows, int64_t startTime)
+{
+   int64_t elapsed = std::max(GetCurrentTimeMs() - startTime, static_cast<int64_t>(1));
+   WriteToTerminalEx(_T("Table \x1b[1m%s\x1b[0m: ") INT64_FMT _T(" rows in %d.%03d seconds (") INT64_FMT _T(" rows/sec)\n"),
+            table, rows, static_cast<int>(elapsed / 1000), static_cast<int>(elapsed % 1000), rows * 1000 / elapsed);
+}
+
+/**
+ * Print failed input record
+ */
+static void PrintFailedRecord(DB_UNBUFFERED_RESULT hResult)
+{
+   _tprintf(_T("Failed input record:\n"));
+   int columnCount = DBGetColumnCount(hResult);
+   for(int i = 0; i < columnCount; i++)
+   {
+      TCHAR name[256];
+      DBGetColumnName(hResult, i, name, 256);
+      TCHAR *value = DBGetField(hResult, i, nullptr, 0);
+      _tprintf(_T("   %s = \"%s\"\n"), name, CHECK_NULL(value));
+      MemFree(value);
+   }
+}
+
+/**
+ * Maximum number of rows in single batch
+ */
+#define MIGRATION_BATCH_SIZE  1000
+
+/**
+ * Row writer for table migration. Executes prepared INSERT statement in driver's batch mode if it is
+ * supported, commits transaction every g_migrationTxnSize rows, and reports progress.
+ */
+class MigrationRowWriter
+{
+private:
+   DB_HANDLE m_hdb;
+   DB_STATEMENT m_hStmt;
+   const TCHAR *m_table;
+   bool m_batchMode;
+   int m_batchRows;
+   int m_txnRows;
+   int64_t m_totalRows;
+   int64_t m_startTime;
+   int64_t m_lastReportTime;
+
+   bool executeBatch(bool reopen)
+   {
+      if (m_batchRows == 0)
+         return true;
+      m_batchRows = 0;
+      bool success = SQLExecute(m_hStmt);
+      if (reopen)
+         DBOpenBatch(m_hStmt);
+      return success;
+   }
+
+public:
+   MigrationRowWriter(DB_HANDLE hdb, DB_STATEMENT hStmt, const TCHAR *table)
+   {
+      m_hdb = hdb;
+      m_hStmt = hStmt;
+      m_table = table;
+      m_batchMode = DBOpenBatch(hStmt);
+      m_batchRows = 0;
+      m_txnRows = 0;
+      m_totalRows = 0;
+      m_startTime = GetCurrentTimeMs();
+      m_lastReportTime = m_startTime;
+   }
+
+   bool isBatchMode() const { return m_batchMode; }
+
+   /**
+    * Start new row (should be called before binding row values)
+    */
+   void beginRow()
+   {
+      if (m_batchMode)
+         DBNextBatchRow(m_hStmt);
+   }
+
+   /**
+    * Complete row (should be called after binding row values)
+    */
+   bool endRow()
+   {
+      if (m_batchMode)
+      {
+         m_batchRows++;
+         if ((m_batchRows >= MIGRATION_BATCH_SIZE) && !executeBatch(true))
+            return false;
+      }
+      else if (!SQLExecute(m_hStmt))
+      {
+         return false;
+      }
+
+      m_txnRows++;
+      if (m_txnRows >= g_migrationTxnSize)
+      {
+         if (!executeBatch(true))
+            return false;
+         m_txnRows = 0;
+         DBCommit(m_hdb);
+         DBBegin(m_hdb);
+      }
+
+      m_totalRows++;
+      if ((m_totalRows & 0xFF) == 0)
+         ReportMigrationProgress(m_table, m_totalRows, m_startTime, &m_lastReportTime);
+      return true;
+   }
+
+   /**
+    * Execute remaining rows and report completion
+    */
+   bool finish()
+   {
+      if (!executeBatch(false))
+         return false;
+      ReportMigrationCompletion(m_table, m_totalRows, m_startTime);
+      return true;
+   }
+};
+
+/**
+ * Migrate single database table using given source and target connections
+ */
+static bool MigrateTable(const TCHAR *table, DB_HANDLE hdbSource, DB_HANDLE hdbTarget)
 {
    WriteToTerminalEx(_T("%s table \x1b[1m%s\x1b[0m\n"), s_import ? _T("Importing") : _T("Migrating"), table);
 
-   if (!DBBegin(g_dbHandle))
+   if (!DBBegin(hdbTarget))
    {
       _tprintf(_T("ERROR: unable to start transaction in target database\n"));
       return false;
@@ -226,7 +375,7 @@ static bool MigrateTable(const TCHAR *table)
    if ((s_sourceSyntax == DB_SYNTAX_TSDB) && IsTimestampConversionNeeded(table))
    {
       _sntprintf(buffer, 512, _T("SELECT * FROM %s WHERE 1=0"), table);
-      DB_RESULT hResult = DBSelectEx(s_hdbSource, buffer, errorText);
+      DB_RESULT hResult = DBSelectEx(hdbSource, buffer, errorText);
       if (hResult != nullptr)
       {
          StringBuffer columns;
@@ -256,7 +405,7 @@ static bool MigrateTable(const TCHAR *table)
       else
       {
          _tprintf(_T("ERROR: unable to read data from source table (%s)\n"), errorText);
-         DBRollback(g_dbHandle);
+         DBRollback(hdbTarget);
          return false;
       }
    }
@@ -265,11 +414,11 @@ static bool MigrateTable(const TCHAR *table)
       _sntprintf(buffer, 512, _T("SELECT * FROM %s"), table);
    }
 
-   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(s_hdbSource, buffer, errorText);
+   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(hdbSource, buffer, errorText);
    if (hResult == nullptr)
    {
       _tprintf(_T("ERROR: unable to read data from source table (%s)\n"), errorText);
-      DBRollback(g_dbHandle);
+      DBRollback(hdbTarget);
       return false;
    }
 
@@ -306,13 +455,14 @@ static bool MigrateTable(const TCHAR *table)
    query.shrink();
    query += _T(")");
 
-   DB_STATEMENT hStmt = DBPrepareEx(g_dbHandle, query, true, errorText);
+   DB_STATEMENT hStmt = DBPrepareEx(hdbTarget, query, true, errorText);
    if (hStmt != nullptr)
    {
       success = true;
-      int rows = 0, totalRows = 0;
+      MigrationRowWriter writer(hdbTarget, hStmt, table);
       while(DBFetch(hResult))
       {
+         writer.beginRow();
          for(int i = 0; i < columnCount; i++)
          {
 			   TCHAR *value = DBGetField(hResult, i, nullptr, 0);
@@ -328,97 +478,176 @@ static bool MigrateTable(const TCHAR *table)
 			      DBBind(hStmt, i + 1, DB_SQLTYPE_VARCHAR, value, DB_BIND_DYNAMIC);
 			   }
          }
-         if (!SQLExecute(hStmt))
+         if (!writer.endRow())
          {
-            _tprintf(_T("Failed input record:\n"));
-            for(int i = 0; i < columnCount; i++)
-            {
-               DBGetColumnName(hResult, i, buffer, 512);
-               TCHAR *value = DBGetField(hResult, i, nullptr, 0);
-               _tprintf(_T("   %s = \"%s\"\n"), buffer, CHECK_NULL(value));
-               MemFree(value);
-            }
+            if (!writer.isBatchMode())
+               PrintFailedRecord(hResult);
             success = false;
             break;
          }
-
-         rows++;
-         if (rows >= g_migrationTxnSize)
-         {
-            rows = 0;
-            DBCommit(g_dbHandle);
-            DBBegin(g_dbHandle);
-         }
-
-         totalRows++;
-         if ((totalRows & 0xFF) == 0)
-         {
-            _tprintf(_T("%8d\r"), totalRows);
-            fflush(stdout);
-         }
       }
 
-      if (success)
-         DBCommit(g_dbHandle);
+      if (success && writer.finish())
+      {
+         DBCommit(hdbTarget);
+      }
       else
-         DBRollback(g_dbHandle);
+      {
+         success = false;
+         DBRollback(hdbTarget);
+      }
       DBFreeStatement(hStmt);
    }
    else
    {
 		_tprintf(_T("ERROR: cannot prepare INSERT statement (%s)\n"), errorText);
-      DBRollback(g_dbHandle);
+      DBRollback(hdbTarget);
    }
    DBFreeResult(hResult);
 	return success;
 }
 
 /**
- * Migrate data tables
+ * Migration job
  */
-static bool MigrateDataTables(bool ignoreDataMigrationErrors)
+struct MigrationJob
 {
-   IntegerArray<uint32_t> *targets = GetDataCollectionTargets();
-   if (targets == nullptr)
-      return false;
+   TCHAR name[64];
+   std::function<bool (DB_HANDLE, DB_HANDLE)> handler;
+   bool ignoreErrors;
 
-	// Create and import idata_xx and tdata_xx tables for each data collection target
-	int count = targets->size();
-   int i;
-	for(i = 0; i < count; i++)
-	{
-	   uint32_t id = targets->get(i);
-      if (!g_dataOnlyMigration)
-      {
-		   if (!CreateIDataTable(id))
-			   break;	// Failed to create idata_xx table
-      }
+   MigrationJob(const TCHAR *_name, const std::function<bool (DB_HANDLE, DB_HANDLE)>& _handler, bool _ignoreErrors) : handler(_handler)
+   {
+      _tcslcpy(name, _name, 64);
+      ignoreErrors = _ignoreErrors;
+   }
+};
 
-      if (!g_skipDataMigration)
-      {
-         TCHAR table[32];
-		   _sntprintf(table, 32, _T("idata_%u"), id);
-		   if (!MigrateTable(table) && !ignoreDataMigrationErrors)
-			   break;
-      }
+/**
+ * List of migration jobs. Jobs are picked up by workers in order of addition.
+ */
+class MigrationJobList
+{
+private:
+   ObjectArray<MigrationJob> m_jobs;
+   Mutex m_mutex;
+   int m_next;
+   bool m_failed;
+
+public:
+   MigrationJobList() : m_jobs(64, 64, Ownership::True), m_mutex(MutexType::FAST)
+   {
+      m_next = 0;
+      m_failed = false;
+   }
+
+   void add(const TCHAR *name, const std::function<bool (DB_HANDLE, DB_HANDLE)>& handler, bool ignoreErrors = false)
+   {
+      m_jobs.add(new MigrationJob(name, handler, ignoreErrors));
+   }
+
+   void addTable(const TCHAR *table, bool ignoreErrors = false)
+   {
+      add(table, [table] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool { return MigrateTable(table, hdbSource, hdbTarget); }, ignoreErrors);
+   }
+
+   int size() const { return m_jobs.size(); }
+   bool isFailed() const { return m_failed; }
+
+   /**
+    * Get next job for execution. Returns nullptr if there are no more jobs or if one of the jobs failed.
+    */
+   MigrationJob *next()
+   {
+      m_mutex.lock();
+      MigrationJob *job = (!m_failed && (m_next < m_jobs.size())) ? m_jobs.get(m_next++) : nullptr;
+      m_mutex.unlock();
+      return job;
+   }
+
+   /**
+    * Register job completion
+    */
+   void complete(MigrationJob *job, bool success)
+   {
+      if (success || job->ignoreErrors)
+         return;
+      m_mutex.lock();
+      m_failed = true;
+      m_mutex.unlock();
+   }
+};
+
+/**
+ * Migration worker
+ */
+static void MigrationWorker(MigrationJobList *jobs, DB_HANDLE hdbSource, DB_HANDLE hdbTarget)
+{
+   MigrationJob *job;
+   while((job = jobs->next()) != nullptr)
+      jobs->complete(job, job->handler(hdbSource, hdbTarget));
+}
+
+/**
+ * Connections used by additional migration worker
+ */
+struct MigrationWorkerContext
+{
+   DB_HANDLE hdbSource;
+   DB_HANDLE hdbTarget;
+   THREAD thread;
+};
+
+/**
+ * Run migration jobs. In parallel mode jobs are executed by several workers, each having
+ * own source and target database connections. Main connections are used by first worker.
+ */
+static bool RunMigrationJobs(MigrationJobList *jobs)
+{
+   int workerCount = std::min(g_migrationJobs, jobs->size());
+   if (workerCount < 2)
+   {
+      MigrationWorker(jobs, s_hdbSource, g_dbHandle);
+      return !jobs->isFailed();
+   }
 
-      if (!g_dataOnlyMigration)
+   StructArray<MigrationWorkerContext> workers(workerCount);
+   for(int i = 1; i < workerCount; i++)
+   {
+      TCHAR errorText[DBDRV_MAX_ERROR_TEXT];
+      DB_HANDLE hdbSource = DBConnect(s_driver, s_dbServer, s_dbName, s_dbLogin, s_dbPassword, s_dbSchema, errorText);
+      if (hdbSource == nullptr)
       {
-         if (!CreateTDataTable(id))
-			   break;	// Failed to create tdata tables
+         WriteToTerminalEx(_T("\x1b[33;1mWARNING:\x1b[0m Unable to open additional connection to source database (%s)\n"), errorText);
+         break;
       }
-
-      if (!g_skipDataMigration)
+      DB_HANDLE hdbTarget = ConnectToDatabase();
+      if (hdbTarget == nullptr)
       {
-         TCHAR table[32];
-		   _sntprintf(table, 32, _T("tdata_%u"), id);
-		   if (!MigrateTable(table) && !ignoreDataMigrationErrors)
-			   break;
+         DBDisconnect(hdbSource);
+         break;
       }
-	}
+      MigrationWorkerContext *w = workers.addPlaceholder();
+      w->hdbSource = hdbSource;
+      w->hdbTarget = hdbTarget;
+   }
 
-	delete targets;
-	return i == count;
+   WriteToTerminalEx(_T("Running \x1b[1m%d\x1b[0m migration jobs in \x1b[1m%d\x1b[0m parallel workers\n"), jobs->size(), workers.size() + 1);
+   for(int i = 0; i < workers.size(); i++)
+   {
+      MigrationWorkerContext *w = workers.get(i);
+      w->thread = ThreadCreateEx(MigrationWorker, jobs, w->hdbSource, w->hdbTarget);
+   }
+   MigrationWorker(jobs, s_hdbSource, g_dbHandle);
+   for(int i = 0; i < workers.size(); i++)
+   {
+      MigrationWorkerContext *w = workers.get(i);
+      ThreadJoin(w->thread);
+      DBDisconnect(w->hdbSource);
+      DBDisconnect(w->hdbTarget);
+   }
+
+   return !jobs->isFailed();
 }
 
 /**
@@ -472,12 +701,12 @@ static bool LoadDCIStorageClasses()
 /**
  * Migrate collected data from multi-table to single table configuration
  */
-static bool MigrateDataToSingleTable(uint32_t nodeId, bool tdata)
+static bool MigrateDataToSingleTable(uint32_t nodeId, bool tdata, DB_HANDLE hdbSource, DB_HANDLE hdbTarget)
 {
    const TCHAR *prefix = tdata ? _T("tdata") : _T("idata");
    WriteToTerminalEx(_T("%s table \x1b[1m%s_%u\x1b[0m to \x1b[1m%s\x1b[0m\n"), s_import ? _T("Importing") : _T("Migrating"), prefix, nodeId, prefix);
 
-   if (!DBBegin(g_dbHandle))
+   if (!DBBegin(hdbTarget))
    {
       _tprintf(_T("ERROR: unable to start transaction in target database\n"));
       return false;
@@ -487,15 +716,15 @@ static bool MigrateDataToSingleTable(uint32_t nodeId, bool tdata)
    TCHAR buffer[256], errorText[DBDRV_MAX_ERROR_TEXT];
    _sntprintf(buffer, 256, _T("SELECT item_id,%s_timestamp,%s_value%s FROM %s_%u"),
             prefix, prefix, tdata ? _T("") : _T(",raw_value"), prefix, nodeId);
-   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(s_hdbSource, buffer, errorText);
+   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(hdbSource, buffer, errorText);
    if (hResult == nullptr)
    {
       _tprintf(_T("ERROR: unable to read data from source table (%s)\n"), errorText);
-      DBRollback(g_dbHandle);
+      DBRollback(hdbTarget);
       return false;
    }
 
-   DB_STATEMENT hStmt = DBPrepareEx(g_dbHandle,
+   DB_STATEMENT hStmt = DBPrepareEx(hdbTarget,
             tdata ?
                _T("INSERT INTO tdata (item_id,tdata_timestamp,tdata_value) VALUES (?,?,?)")
                : _T("INSERT INTO idata (item_id,idata_timestamp,idata_value,raw_value) VALUES (?,?,?,?)"),
@@ -503,9 +732,12 @@ static bool MigrateDataToSingleTable(uint32_t nodeId, bool tdata)
    if (hStmt != nullptr)
    {
       success = true;
-      int rows = 0, totalRows = 0;
+      TCHAR table[64];
+      _sntprintf(table, 64, _T("%s_%u"), prefix, nodeId);
+      MigrationRowWriter writer(hdbTarget, hStmt, table);
       while(DBFetch(hResult))
       {
+         writer.beginRow();
          DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, DBGetFieldULong(hResult, 0));
          DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, DBGetFieldULong(hResult, 1));
          if (tdata)
@@ -517,47 +749,30 @@ static bool MigrateDataToSingleTable(uint32_t nodeId, bool tdata)
             DBBind(hStmt, 3, DB_SQLTYPE_VARCHAR, DBGetField(hResult, 2, nullptr, 0), DB_BIND_DYNAMIC);
             DBBind(hStmt, 4, DB_SQLTYPE_VARCHAR, DBGetField(hResult, 3, nullptr, 0), DB_BIND_DYNAMIC);
          }
-         if (!SQLExecute(hStmt))
+         if (!writer.endRow())
          {
-            _tprintf(_T("Failed input record:\n"));
-            int columnCount = DBGetColumnCount(hResult);
-            for(int i = 0; i < columnCount; i++)
-            {
-               DBGetColumnName(hResult, i, buffer, 256);
-               TCHAR *value = DBGetField(hResult, i, nullptr, 0);
-               _tprintf(_T("   %s = \"%s\"\n"), buffer, CHECK_NULL(value));
-               MemFree(value);
-            }
+            if (!writer.isBatchMode())
+               PrintFailedRecord(hResult);
             success = false;
             break;
          }
-
-         rows++;
-         if (rows >= g_migrationTxnSize)
-         {
-            rows = 0;
-            DBCommit(g_dbHandle);
-            DBBegin(g_dbHandle);
-         }
-
-         totalRows++;
-         if ((totalRows & 0xFF) == 0)
-         {
-            _tprintf(_T("%8d\r"), totalRows);
-            fflush(stdout);
-         }
       }
 
-      if (success)
-         DBCommit(g_dbHandle);
+      if (success && writer.finish())
+      {
+         DBCommit(hdbTarget);
+      }
       else
-         DBRollback(g_dbHandle);
+      {
+         success = false;
+         DBRollback(hdbTarget);
+      }
       DBFreeStatement(hStmt);
    }
    else
    {
       _tprintf(_T("ERROR: cannot prepare INSERT statement (%s)\n"), errorText);
-      DBRollback(g_dbHandle);
+      DBRollback(hdbTarget);
    }
    DBFreeResult(hResult);
    return success;
@@ -582,15 +797,17 @@ static inline StringBuffer BuildDataInsertQuery(bool tdata, const TCHAR *sclass)
 /**
  * Migrate collected data from multi-table to single table configuration (TSDB version)
  */
-static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata)
+static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata, DB_HANDLE hdbSource, DB_HANDLE hdbTarget)
 {
    const TCHAR *prefix = tdata ? _T("tdata") : _T("idata");
+   TCHAR table[64];
+   _sntprintf(table, 64, _T("%s_%u"), prefix, nodeId);
    WriteToTerminalEx(_T("%s table \x1b[1m%s_%u\x1b[0m to \x1b[1m%s\x1b[0m\n"), s_import ? _T("Importing") : _T("Migrating"), prefix, nodeId, prefix);
 
    bool success = false;
    TCHAR buffer[256], errorText[DBDRV_MAX_ERROR_TEXT];
    _sntprintf(buffer, 256, _T("SELECT item_id,%s_timestamp,%s_value%s FROM %s_%u"), prefix, prefix, tdata ? _T("") : _T(",raw_value"), prefix, nodeId);
-   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(s_hdbSource, buffer, errorText);
+   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(hdbSource, buffer, errorText);
    if (hResult == nullptr)
    {
       _tprintf(_T("ERROR: unable to read data from source table (%s)\n"), errorText);
@@ -609,7 +826,8 @@ static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata)
    memset(hasContent, 0, sizeof(hasContent));
 
    success = true;
-   int rows = 0, totalRows = 0;
+   int rows = 0;
+   int64_t totalRows = 0, startTime = GetCurrentTimeMs(), lastReportTime = startTime;
    while(DBFetch(hResult))
    {
       uint32_t dciId = DBGetFieldULong(hResult, 0);
@@ -623,13 +841,13 @@ static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata)
       query.append(DBGetFieldULong(hResult, 1));
       query.append(_T("),"));
       TCHAR *value = DBGetField(hResult, 2, nullptr, 0);
-      query.append(DBPrepareString(g_dbHandle, value));
+      query.append(DBPrepareString(hdbTarget, value));
       MemFree(value);
       if (!tdata)
       {
          query.append(_T(','));
          TCHAR *value = DBGetField(hResult, 3, nullptr, 0);
-         query.append(DBPrepareString(g_dbHandle, value));
+         query.append(DBPrepareString(hdbTarget, value));
          MemFree(value);
       }
       query.append(_T(')'));
@@ -645,15 +863,15 @@ static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata)
                continue;
 
             queries[i].append(_T(" ON CONFLICT DO NOTHING"));
-            DBBegin(g_dbHandle);
-            if (DBQueryEx(g_dbHandle, queries[i], errorText))
+            DBBegin(hdbTarget);
+            if (DBQueryEx(hdbTarget, queries[i], errorText))
             {
-               DBCommit(g_dbHandle);
+               DBCommit(hdbTarget);
             }
             else
             {
                _tprintf(_T("ERROR: unable to insert data to destination table (%s)\n"), errorText);
-               DBRollback(g_dbHandle);
+               DBRollback(hdbTarget);
                success = false;
             }
          }
@@ -670,10 +888,7 @@ static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata)
 
       totalRows++;
       if ((totalRows & 0xFF) == 0)
-      {
-         _tprintf(_T("%8d\r"), totalRows);
-         fflush(stdout);
-      }
+         ReportMigrationProgress(table, totalRows, startTime, &lastReportTime);
    }
 
    if (rows > 0)
@@ -684,36 +899,39 @@ static bool MigrateDataToSingleTable_TSDB(uint32_t nodeId, bool tdata)
             continue;
 
          queries[i].append(_T(" ON CONFLICT DO NOTHING"));
-         DBBegin(g_dbHandle);
-         if (DBQueryEx(g_dbHandle, queries[i], errorText))
+         DBBegin(hdbTarget);
+         if (DBQueryEx(hdbTarget, queries[i], errorText))
          {
-            DBCommit(g_dbHandle);
+            DBCommit(hdbTarget);
          }
          else
          {
             _tprintf(_T("ERROR: unable to insert data to destination table (%s)\n"), errorText);
-            DBRollback(g_dbHandle);
+            DBRollback(hdbTarget);
             success = false;
          }
       }
    }
 
    DBFreeResult(hResult);
+   if (success)
+      ReportMigrationCompletion(table, totalRows, startTime);
    return success;
 }
 
 /**
  * Migrate collected data from single table to single table configuration (TSDB version)
  */
-static bool MigrateSingleDataTableToTSDB(bool tdata)
+static bool MigrateSingleDataTableToTSDB(bool tdata, DB_HANDLE hdbSource, DB_HANDLE hdbTarget)
 {
    const TCHAR *prefix = tdata ? _T("tdata") : _T("idata");
+   const TCHAR *table = prefix;
    WriteToTerminalEx(_T("%s table \x1b[1m%s\x1b[0m\n"), s_import ? _T("Importing") : _T("Migrating"), prefix);
 
    bool success = false;
    TCHAR buffer[256], errorText[DBDRV_MAX_ERROR_TEXT];
    _sntprintf(buffer, 256, _T("SELECT item_id,%s_timestamp,%s_value%s FROM %s"), prefix, prefix, tdata ? _T("") : _T(",raw_value"), prefix);
-   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(s_hdbSource, buffer, errorText);
+   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(hdbSource, buffer, errorText);
    if (hResult == nullptr)
    {
       _tprintf(_T("ERROR: unable to read data from source table (%s)\n"), errorText);
@@ -732,7 +950,8 @@ static bool MigrateSingleDataTableToTSDB(bool tdata)
    memset(hasContent, 0, sizeof(hasContent));
 
    success = true;
-   int rows = 0, totalRows = 0;
+   int rows = 0;
+   int64_t totalRows = 0, startTime = GetCurrentTimeMs(), lastReportTime = startTime;
    while(DBFetch(hResult))
    {
       uint32_t dciId = DBGetFieldULong(hResult, 0);
@@ -746,13 +965,13 @@ static bool MigrateSingleDataTableToTSDB(bool tdata)
       query.append(DBGetFieldULong(hResult, 1));
       query.append(_T("),"));
       TCHAR *value = DBGetField(hResult, 2, nullptr, 0);
-      query.append(DBPrepareString(g_dbHandle, value));
+      query.append(DBPrepareString(hdbTarget, value));
       MemFree(value);
       if (!tdata)
       {
          query.append(_T(','));
          TCHAR *value = DBGetField(hResult, 3, nullptr, 0);
-         query.append(DBPrepareString(g_dbHandle, value));
+         query.append(DBPrepareString(hdbTarget, value));
          MemFree(value);
       }
       query.append(_T(')'));
@@ -768,15 +987,15 @@ static bool MigrateSingleDataTableToTSDB(bool tdata)
                continue;
 
             queries[i].append(_T(" ON CONFLICT DO NOTHING"));
-            DBBegin(g_dbHandle);
-            if (DBQueryEx(g_dbHandle, queries[i], errorText))
+            DBBegin(hdbTarget);
+            if (DBQueryEx(hdbTarget, queries[i], errorText))
             {
-               DBCommit(g_dbHandle);
+               DBCommit(hdbTarget);
             }
             else
             {
                _tprintf(_T("ERROR: unable to insert data to destination table (%s)\n"), errorText);
-               DBRollback(g_dbHandle);
+               DBRollback(hdbTarget);
                success = false;
             }
          }
@@ -793,10 +1012,7 @@ static bool MigrateSingleDataTableToTSDB(bool tdata)
 
       totalRows++;
       if ((totalRows & 0xFF) == 0)
-      {
-         _tprintf(_T("%8d\r"), totalRows);
-         fflush(stdout);
-      }
+         ReportMigrationProgress(table, totalRows, startTime, &lastReportTime);
    }
 
    if (rows > 0)
@@ -807,21 +1023,23 @@ static bool MigrateSingleDataTableToTSDB(bool tdata)
             continue;
 
          queries[i].append(_T(" ON CONFLICT DO NOTHING"));
-         DBBegin(g_dbHandle);
-         if (DBQueryEx(g_dbHandle, queries[i], errorText))
+         DBBegin(hdbTarget);
+         if (DBQueryEx(hdbTarget, queries[i], errorText))
          {
-            DBCommit(g_dbHandle);
+            DBCommit(hdbTarget);
          }
          else
          {
             _tprintf(_T("ERROR: unable to insert data to destination table (%s)\n"), errorText);
-            DBRollback(g_dbHandle);
+            DBRollback(hdbTarget);
             success = false;
          }
       }
    }
 
    DBFreeResult(hResult);
+   if (success)
+      ReportMigrationCompletion(table, totalRows, startTime);
    return success;
 }
 
@@ -835,40 +1053,39 @@ static bool MigrateDataTablesToSingleTable(bool ignoreDataMigrationErrors)
       return false;
 
    // Copy data from idata_xx and tdata_xx tables for each node in "nodes" table
-   int count = targets->size();
-   int i;
-   for(i = 0; i < count; i++)
+   MigrationJobList jobs;
+   bool tsdb = (g_dbSyntax == DB_SYNTAX_TSDB);
+   for(int i = 0; i < targets->size(); i++)
    {
       uint32_t id = targets->get(i);
-      if (g_dbSyntax == DB_SYNTAX_TSDB)
-      {
-         if (!MigrateDataToSingleTable_TSDB(id, false) && !ignoreDataMigrationErrors)
-            break;
-         if (!MigrateDataToSingleTable_TSDB(id, true) && !ignoreDataMigrationErrors)
-            break;
-      }
-      else
-      {
-         if (!MigrateDataToSingleTable(id, false) && !ignoreDataMigrationErrors)
-            break;
-         if (!MigrateDataToSingleTable(id, true) && !ignoreDataMigrationErrors)
-            break;
-      }
+      TCHAR name[64];
+      _sntprintf(name, 64, _T("idata_%u"), id);
+      jobs.add(name,
+         [id, tsdb] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool
+         {
+            return tsdb ? MigrateDataToSingleTable_TSDB(id, false, hdbSource, hdbTarget) : MigrateDataToSingleTable(id, false, hdbSource, hdbTarget);
+         }, ignoreDataMigrationErrors);
+      _sntprintf(name, 64, _T("tdata_%u"), id);
+      jobs.add(name,
+         [id, tsdb] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool
+         {
+            return tsdb ? MigrateDataToSingleTable_TSDB(id, true, hdbSource, hdbTarget) : MigrateDataToSingleTable(id, true, hdbSource, hdbTarget);
+         }, ignoreDataMigrationErrors);
    }
-
    delete targets;
-   return i == count;
+
+   return RunMigrationJobs(&jobs);
 }
 
 /**
  * Migrate collected data from single table to multi-single table configuration
  */
-static bool MigrateDataFromSingleTable(uint32_t nodeId, bool tdata)
+static bool MigrateDataFromSingleTable(uint32_t nodeId, bool tdata, DB_HANDLE hdbSource, DB_HANDLE hdbTarget)
 {
    const TCHAR *prefix = tdata ? _T("tdata") : _T("idata");
    WriteToTerminalEx(_T("%s table \x1b[1m%s_%u\x1b[0m from \x1b[1m%s\x1b[0m\n"), s_import ? _T("Importing") : _T("Migrating"), prefix, nodeId, prefix);
 
-   if (!DBBegin(g_dbHandle))
+   if (!DBBegin(hdbTarget))
    {
       _tprintf(_T("ERROR: unable to start transaction in target database\n"));
       return false;
@@ -886,11 +1103,11 @@ static bool MigrateDataFromSingleTable(uint32_t nodeId, bool tdata)
       _sntprintf(buffer, 256, _T("SELECT item_id,%s_timestamp,%s_value%s FROM %s WHERE item_id IN (SELECT item_id FROM %s WHERE node_id=%u)"),
                prefix, prefix, tdata ? _T("") : _T(",raw_value"), prefix, tdata ? _T("dc_tables") : _T("items"), nodeId);
    }
-   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(s_hdbSource, buffer, errorText);
+   DB_UNBUFFERED_RESULT hResult = DBSelectUnbufferedEx(hdbSource, buffer, errorText);
    if (hResult == nullptr)
    {
       _tprintf(_T("ERROR: unable to read data from source table (%s)\n"), errorText);
-      DBRollback(g_dbHandle);
+      DBRollback(hdbTarget);
       return false;
    }
 
@@ -898,13 +1115,16 @@ static bool MigrateDataFromSingleTable(uint32_t nodeId, bool tdata)
       _sntprintf(buffer, 256, _T("INSERT INTO tdata_%u (item_id,tdata_timestamp,tdata_value) VALUES (?,?,?)"), nodeId);
    else
       _sntprintf(buffer, 256, _T("INSERT INTO idata_%u (item_id,idata_timestamp,idata_value,raw_value) VALUES (?,?,?,?)"), nodeId);
-   DB_STATEMENT hStmt = DBPrepareEx(g_dbHandle, buffer, true, errorText);
+   DB_STATEMENT hStmt = DBPrepareEx(hdbTarget, buffer, true, errorText);
    if (hStmt != nullptr)
    {
       success = true;
-      int rows = 0, totalRows = 0;
+      TCHAR table[64];
+      _sntprintf(table, 64, _T("%s_%u"), prefix, nodeId);
+      MigrationRowWriter writer(hdbTarget, hStmt, table);
       while(DBFetch(hResult))
       {
+         writer.beginRow();
          DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, DBGetFieldULong(hResult, 0));
          DBBind(hStmt, 2, DB_SQLTYPE_INTEGER, DBGetFieldULong(hResult, 1));
          if (tdata)
@@ -916,52 +1136,50 @@ static bool MigrateDataFromSingleTable(uint32_t nodeId, bool tdata)
             DBBind(hStmt, 3, DB_SQLTYPE_VARCHAR, DBGetField(hResult, 2, nullptr, 0), DB_BIND_DYNAMIC);
             DBBind(hStmt, 4, DB_SQLTYPE_VARCHAR, DBGetField(hResult, 3, nullptr, 0), DB_BIND_DYNAMIC);
          }
-         if (!SQLExecute(hStmt))
+         if (!writer.endRow())
          {
-            _tprintf(_T("Failed input record:\n"));
-            int columnCount = DBGetColumnCount(hResult);
-            for(int i = 0; i < columnCount; i++)
-            {
-               DBGetColumnName(hResult, i, buffer, 256);
-               TCHAR *value = DBGetField(hResult, i, nullptr, 0);
-               _tprintf(_T("   %s = \"%s\"\n"), buffer, CHECK_NULL(value));
-               MemFree(value);
-            }
+            if (!writer.isBatchMode())
+               PrintFailedRecord(hResult);
             success = false;
             break;
          }
-
-         rows++;
-         if (rows >= g_migrationTxnSize)
-         {
-            rows = 0;
-            DBCommit(g_dbHandle);
-            DBBegin(g_dbHandle);
-         }
-
-         totalRows++;
-         if ((totalRows & 0xFF) == 0)
-         {
-            _tprintf(_T("%8d\r"), totalRows);
-            fflush(stdout);
-         }
       }
 
-      if (success)
-         DBCommit(g_dbHandle);
+      if (success && writer.finish())
+      {
+         DBCommit(hdbTarget);
+      }
       else
-         DBRollback(g_dbHandle);
+      {
+         success = false;
+         DBRollback(hdbTarget);
+      }
       DBFreeStatement(hStmt);
    }
    else
    {
       _tprintf(_T("ERROR: cannot prepare INSERT statement (%s)\n"), errorText);
-      DBRollback(g_dbHandle);
+      DBRollback(hdbTarget);
    }
    DBFreeResult(hResult);
    return success;
 }
 
+/**
+ * Create idata_xx and tdata_xx tables for each data collection target. Tables are created
+ * before data copy starts so copy jobs for different targets can run in parallel.
+ */
+static bool CreateDataTables(const IntegerArray<uint32_t>& targets)
+{
+   for(int i = 0; i < targets.size(); i++)
+   {
+      uint32_t id = targets.get(i);
+      if (!CreateIDataTable(id) || !CreateTDataTable(id))
+         return false;
+   }
+   return true;
+}
+
 /**
  * Migrate data tables from single table
  */
@@ -971,54 +1189,92 @@ static bool MigrateDataTablesFromSingleTable(bool ignoreDataMigrationErrors)
    if (targets == nullptr)
       return false;
 
-   // Create and import idata_xx and tdata_xx tables for each data collection target
-   int count = targets->size();
-   int i;
-   for(i = 0; i < count; i++)
+   if (!g_dataOnlyMigration && !CreateDataTables(*targets))
    {
-      uint32_t id = targets->get(i);
+      delete targets;
+      return false;
+   }
 
-      if (!g_dataOnlyMigration)
+   MigrationJobList jobs;
+   if (!g_skipDataMigration)
+   {
+      for(int i = 0; i < targets->size(); i++)
       {
-         if (!CreateIDataTable(id))
-            break;   // Failed to create idata_xx table
+         uint32_t id = targets->get(i);
+         TCHAR name[64];
+         _sntprintf(name, 64, _T("idata_%u"), id);
+         jobs.add(name,
+            [id] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool { return MigrateDataFromSingleTable(id, false, hdbSource, hdbTarget); },
+            ignoreDataMigrationErrors);
+         _sntprintf(name, 64, _T("tdata_%u"), id);
+         jobs.add(name,
+            [id] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool { return MigrateDataFromSingleTable(id, true, hdbSource, hdbTarget); },
+            ignoreDataMigrationErrors);
       }
+   }
+   delete targets;
 
-      if (!g_skipDataMigration)
-      {
-         if (!MigrateDataFromSingleTable(id, false) && !ignoreDataMigrationErrors)
-            break;
-      }
+   return RunMigrationJobs(&jobs);
+}
 
-      if (!g_dataOnlyMigration)
-      {
-         if (!CreateTDataTable(id))
-            break;   // Failed to create tdata tables
-      }
+/**
+ * Migrate data tables
+ */
+static bool MigrateDataTables(bool ignoreDataMigrationErrors)
+{
+   IntegerArray<uint32_t> *targets = GetDataCollectionTargets();
+   if (targets == nullptr)
+      return false;
+
+   if (!g_dataOnlyMigration && !CreateDataTables(*targets))
+   {
+      delete targets;
+      return false;
+   }
 
-      if (!g_skipDataMigration)
+   MigrationJobList jobs;
+   if (!g_skipDataMigration)
+   {
+      for(int i = 0; i < targets->size(); i++)
       {
-         if (!MigrateDataFromSingleTable(id, true) && !ignoreDataMigrationErrors)
-            break;
+         uint32_t id = targets->get(i);
+         TCHAR name[64];
+         _sntprintf(name, 64, _T("idata_%u"), id);
+         jobs.add(name,
+            [id] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool
+            {
+               TCHAR table[64];
+               _sntprintf(table, 64, _T("idata_%u"), id);
+               return MigrateTable(table, hdbSource, hdbTarget);
+            }, ignoreDataMigrationErrors);
+         _sntprintf(name, 64, _T("tdata_%u"), id);
+         jobs.add(name,
+            [id] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool
+            {
+               TCHAR table[64];
+               _sntprintf(table, 64, _T("tdata_%u"), id);
+               return MigrateTable(table, hdbSource, hdbTarget);
+            }, ignoreDataMigrationErrors);
       }
    }
-
    delete targets;
-   return i == count;
+
+   return RunMigrationJobs(&jobs);
 }
 
 /**
- * Callback for migrating module table
+ * Callback for adding migration job for module table
  */
-static bool MigrateTableCallback(const TCHAR *table, void *context)
+static bool AddModuleTableCallback(const TCHAR *table, void *context)
 {
-   auto lists = static_cast<std::pair<const StringList*, const StringList*>*>(context);
-   if (lists->first->contains(table) || (!lists->second->isEmpty() && !lists->second->contains(table)))
+   auto data = static_cast<std::tuple<const StringList*, const StringList*, MigrationJobList*>*>(context);
+   if (std::get<0>(*data)->contains(table) || (!std::get<1>(*data)->isEmpty() && !std::get<1>(*data)->contains(table)))
    {
       WriteToTerminalEx(_T("Skipping table \x1b[1m%s\x1b[0m\n"), table);
       return true;
    }
-   return MigrateTable(table);
+   std::get<2>(*data)->addTable(table);
+   return true;
 }
 
 /**
@@ -1029,6 +1285,12 @@ static bool ImportOrMigrateDatabase(const StringList& excludedTables, const Stri
    if (!ConnectToSource())
       return false;
 
+   if ((g_migrationJobs > 1) && (g_dbSyntax == DB_SYNTAX_SQLITE))
+   {
+      WriteToTerminal(_T("\x1b[33;1mWARNING:\x1b[0m Parallel migration is not supported for SQLite target database\n"));
+      g_migrationJobs = 1;
+   }
+
    bool success = false;
    if (!g_dataOnlyMigration)
    {
@@ -1040,6 +1302,7 @@ static bool ImportOrMigrateDatabase(const StringList& excludedTables, const Stri
       }
 
       // Migrate tables
+      MigrationJobList jobs;
       for(int i = 0; g_tables[i] != nullptr; i++)
       {
          const TCHAR *table = g_tables[i];
@@ -1055,12 +1318,13 @@ static bool ImportOrMigrateDatabase(const StringList& excludedTables, const Stri
             continue;
          }
 
-         if (!MigrateTable(table))
-            goto cleanup;
+         jobs.addTable(table);
       }
 
-      std::pair<const StringList*, const StringList*> data(&excludedTables, &includedTables);
-      if (!EnumerateModuleTables(MigrateTableCallback, &data))
+      std::tuple<const StringList*, const StringList*, MigrationJobList*> data(&excludedTables, &includedTables, &jobs);
+      EnumerateModuleTables(AddModuleTableCallback, &data);
+
+      if (!RunMigrationJobs(&jobs))
          goto cleanup;
    }
 
@@ -1071,52 +1335,34 @@ static bool ImportOrMigrateDatabase(const StringList& excludedTables, const Stri
 
       if (singleTableSource && singleTableDestination && !g_skipDataMigration)
       {
+         MigrationJobList jobs;
          if (g_dbSyntax == DB_SYNTAX_TSDB)
          {
             if (s_sourceSyntax == DB_SYNTAX_TSDB)
             {
-               if (!MigrateTable(_T("idata_sc_default")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("idata_sc_7")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("idata_sc_30")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("idata_sc_90")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("idata_sc_180")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("idata_sc_other")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("tdata_sc_default")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("tdata_sc_7")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("tdata_sc_30")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("tdata_sc_90")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("tdata_sc_180")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateTable(_T("tdata_sc_other")) && !ignoreDataMigrationErrors)
-                  goto cleanup;
+               static const TCHAR *tables[] = {
+                  _T("idata_sc_default"), _T("idata_sc_7"), _T("idata_sc_30"), _T("idata_sc_90"), _T("idata_sc_180"), _T("idata_sc_other"),
+                  _T("tdata_sc_default"), _T("tdata_sc_7"), _T("tdata_sc_30"), _T("tdata_sc_90"), _T("tdata_sc_180"), _T("tdata_sc_other"),
+                  nullptr
+               };
+               for(int i = 0; tables[i] != nullptr; i++)
+                  jobs.addTable(tables[i], ignoreDataMigrationErrors);
             }
             else
             {
                if (!LoadDCIStorageClasses())
                   goto cleanup;
-               if (!MigrateSingleDataTableToTSDB(false) && !ignoreDataMigrationErrors)
-                  goto cleanup;
-               if (!MigrateSingleDataTableToTSDB(true) && !ignoreDataMigrationErrors)
-                  goto cleanup;
+               jobs.add(_T("idata"), [] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool { return MigrateSingleDataTableToTSDB(false, hdbSource, hdbTarget); }, ignoreDataMigrationErrors);
+               jobs.add(_T("tdata"), [] (DB_HANDLE hdbSource, DB_HANDLE hdbTarget) -> bool { return MigrateSingleDataTableToTSDB(true, hdbSource, hdbTarget); }, ignoreDataMigrationErrors);
             }
          }
          else
          {
-            if (!MigrateTable(_T("idata")) && !ignoreDataMigrationErrors)
-               goto cleanup;
-            if (!MigrateTable(_T("tdata")) && !ignoreDataMigrationErrors)
-               goto cleanup;
+            jobs.addTable(_T("idata"), ignoreDataMigrationErrors);
+            jobs.addTable(_T("tdata"), ignoreDataMigrationErrors);
          }
+         if (!RunMigrationJobs(&jobs))
+            goto cleanup;
       }
       else if (singleTableSource && !singleTableDestination)
       {
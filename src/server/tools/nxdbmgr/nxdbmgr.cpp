@@ -41,6 +41,7 @@ bool g_skipDataMigration = false;
 bool g_skipDataSchemaMigration = false;
 bool g_machineReadableOutput = false;
 int g_migrationTxnSize = 4096;
+int g_migrationJobs = 1;
 
 /**
  * Static data
@@ -366,7 +367,7 @@ int main(int argc, char *argv[])
 
    // Parse command line
    opterr = 1;
-   while((ch = getopt(argc, argv, "c:C:dDe:fF:GhIL:mMNoPqsStT:vxXY:Z:")) != -1)
+   while((ch = getopt(argc, argv, "c:C:dDe:fF:GhIj:L:mMNoPqsStT:vxXY:Z:")) != -1)
    {
       switch(ch)
       {
@@ -378,6 +379,7 @@ int main(int argc, char *argv[])
                      _T("   batch <file>         : Run SQL batch file\n")
                      _T("   check                : Check database for errors\n")
                      _T("   check-data-tables    : Check database for missing data tables\n")
+                     _T("   enable-partitioning  : Convert log and collected data tables to time partitioned layout (PostgreSQL and MySQL only)\n")
                      _T("   export <file>        : Export database to file\n")
                      _T("   get <pattern>        : Get value of server configuration variable(s) matching given pattern\n")
                      _T("   import <file>        : Import database from file\n")
@@ -400,6 +402,7 @@ int main(int argc, char *argv[])
 #endif
                      _T("   -h          : Display help and exit.\n")
                      _T("   -I          : MySQL only - specify TYPE=InnoDB for new tables.\n")
+                     _T("   -j <jobs>   : Number of tables to migrate in parallel.\n")
                      _T("   -L <log>    : Migrate only specific log.\n")
                      _T("   -m          : Improved machine readability of output.\n")
                      _T("   -M          : MySQL only - specify TYPE=MyISAM for new tables.\n")
@@ -543,6 +546,14 @@ int main(int argc, char *argv[])
                g_migrationTxnSize = 4096;
             }
             break;
+         case 'j':
+            g_migrationJobs = strtol(optarg, nullptr, 0);
+            if ((g_migrationJobs < 1) || (g_migrationJobs > 64))
+            {
+               _tprintf(_T("WARNING: invalid number of migration jobs, reset to default\n"));
+               g_migrationJobs = 1;
+            }
+            break;
          case 'X':
             g_ignoreErrors = true;
             break;
@@ -602,6 +613,7 @@ int main(int argc, char *argv[])
        strcmp(argv[optind], "batch") &&
        strcmp(argv[optind], "check") &&
        strcmp(argv[optind], "check-data-tables") &&
+       strcmp(argv[optind], "enable-partitioning") &&
        strcmp(argv[optind], "export") &&
        strcmp(argv[optind], "get") &&
        strcmp(argv[optind], "import") &&
@@ -811,6 +823,10 @@ int main(int argc, char *argv[])
          g_checkDataTablesOnly = true;
          CheckDatabase();
       }
+      else if (!strcmp(argv[optind], "enable-partitioning"))
+      {
+         ConvertToPartitionedTables();
+      }
       else if (!strcmp(argv[optind], "upgrade"))
       {
          UpgradeDatabase();
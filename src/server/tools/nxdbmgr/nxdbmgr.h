@@ -55,6 +55,7 @@ void MigrateDatabase(const TCHAR *sourceConfig, TCHAR *destConfFields, const Str
 void UpgradeDatabase();
 void UnlockDatabase();
 void ReindexIData();
+void ConvertToPartitionedTables();
 
 bool ExecSQLBatch(const char *pszFile, bool showOutput);
 bool ValidateDatabase();
@@ -103,5 +104,6 @@ extern bool g_skipDataMigration;
 extern bool g_skipDataSchemaMigration;
 extern bool g_machineReadableOutput;
 extern int g_migrationTxnSize;
+extern int g_migrationJobs;
 
 #endif
@@ -0,0 +1,302 @@
+/*
+** nxdbmgr - NetXMS database manager
+** Copyright (C) 2004-2023 Raden Solutions
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: partitions.cpp
+**
+**/
+
+#include "nxdbmgr.h"
+
+/**
+ * Partition interval (one day)
+ */
+#define PARTITION_INTERVAL    86400
+
+/**
+ * Number of partitions created in advance
+ */
+#define PARTITIONS_AHEAD      7
+
+/**
+ * Maximum age of oldest created partition (in days). Older records are placed into default partition.
+ */
+#define MAX_PARTITION_AGE     366
+
+/**
+ * Table partitioning information
+ */
+struct PartitionedTable
+{
+   const TCHAR *name;
+   const TCHAR *timestampColumn;
+   const TCHAR *primaryKey;
+   bool perfData;
+};
+
+/**
+ * Tables that can be partitioned. Primary key should include timestamp column.
+ */
+static PartitionedTable s_tables[] =
+{
+   { _T("idata"), _T("idata_timestamp"), _T("item_id,idata_timestamp"), true },
+   { _T("tdata"), _T("tdata_timestamp"), _T("item_id,tdata_timestamp"), true },
+   { _T("event_log"), _T("event_timestamp"), _T("event_id,event_timestamp"), false },
+   { _T("snmp_trap_log"), _T("trap_timestamp"), _T("trap_id,trap_timestamp"), false },
+   { _T("syslog"), _T("msg_timestamp"), _T("msg_id,msg_timestamp"), false },
+   { nullptr, nullptr, nullptr, false }
+};
+
+/**
+ * Build partition name for given start time
+ */
+static void BuildPartitionName(const TCHAR *table, time_t start, TCHAR *name)
+{
+#if HAVE_GMTIME_R
+   struct tm tmBuffer;
+   struct tm *t = gmtime_r(&start, &tmBuffer);
+#else
+   struct tm *t = gmtime(&start);
+#endif
+   if (g_dbSyntax == DB_SYNTAX_MYSQL)
+      _sntprintf(name, 64, _T("p%04d%02d%02d"), t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+   else
+      _sntprintf(name, 64, _T("%s_p%04d%02d%02d"), table, t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+}
+
+/**
+ * Check if table is already partitioned
+ */
+static bool IsTablePartitioned(const TCHAR *table)
+{
+   TCHAR query[512];
+   if (g_dbSyntax == DB_SYNTAX_MYSQL)
+      _sntprintf(query, 512, _T("SELECT count(*) FROM information_schema.partitions WHERE table_schema=database() AND table_name='%s' AND partition_name IS NOT NULL"), table);
+   else
+      _sntprintf(query, 512, _T("SELECT count(*) FROM pg_partitioned_table p INNER JOIN pg_class c ON c.oid=p.partrelid WHERE c.relname='%s'"), table);
+
+   bool partitioned = false;
+   DB_RESULT hResult = SQLSelect(query);
+   if (hResult != nullptr)
+   {
+      partitioned = (DBGetFieldLong(hResult, 0, 0) > 0);
+      DBFreeResult(hResult);
+   }
+   return partitioned;
+}
+
+/**
+ * Get start time of first partition for given table
+ */
+static time_t GetFirstPartitionStart(const PartitionedTable *table, time_t today)
+{
+   time_t start = today;
+
+   TCHAR query[256];
+   _sntprintf(query, 256, _T("SELECT min(%s) FROM %s"), table->timestampColumn, table->name);
+   DB_RESULT hResult = SQLSelect(query);
+   if (hResult != nullptr)
+   {
+      time_t oldest = static_cast<time_t>(DBGetFieldInt64(hResult, 0, 0));
+      if (oldest > 0)   // Will be 0 if table is empty
+         start = std::min(oldest / PARTITION_INTERVAL * PARTITION_INTERVAL, today);
+      DBFreeResult(hResult);
+   }
+
+   return std::max(start, today - MAX_PARTITION_AGE * PARTITION_INTERVAL);
+}
+
+/**
+ * Convert table to partitioned layout - PostgreSQL version. Table is re-created as partitioned and data copied from original table.
+ */
+static bool ConvertTable_PGSQL(const PartitionedTable *table, time_t firstPartition, time_t lastPartition)
+{
+   TCHAR query[1024];
+
+   // Save index definitions (except primary key) so they can be re-created on new table
+   StringList indexes;
+   _sntprintf(query, 1024, _T("SELECT i.indexname,i.indexdef FROM pg_indexes i WHERE i.tablename='%s' AND NOT EXISTS (SELECT 1 FROM pg_constraint c WHERE c.conname=i.indexname AND c.contype='p')"), table->name);
+   DB_RESULT hResult = SQLSelect(query);
+   if (hResult == nullptr)
+      return false;
+   int count = DBGetNumRows(hResult);
+   for(int i = 0; i < count; i++)
+   {
+      TCHAR name[128];
+      DBGetField(hResult, i, 0, name, 128);
+      indexes.addPreallocated(DBGetField(hResult, i, 1, nullptr, 0));
+      _sntprintf(query, 1024, _T("DROP INDEX %s"), name);
+      if (!SQLQuery(query))
+      {
+         DBFreeResult(hResult);
+         return false;
+      }
+   }
+   DBFreeResult(hResult);
+
+   CHK_EXEC_NO_SP(DBDropPrimaryKey(g_dbHandle, table->name));
+
+   _sntprintf(query, 1024, _T("ALTER TABLE %s RENAME TO %s_old"), table->name, table->name);
+   CHK_EXEC_NO_SP(SQLQuery(query));
+
+   _sntprintf(query, 1024, _T("CREATE TABLE %s (LIKE %s_old INCLUDING DEFAULTS) PARTITION BY RANGE (%s)"), table->name, table->name, table->timestampColumn);
+   CHK_EXEC_NO_SP(SQLQuery(query));
+   CHK_EXEC_NO_SP(DBAddPrimaryKey(g_dbHandle, table->name, table->primaryKey));
+
+   _sntprintf(query, 1024, _T("CREATE TABLE %s_pdefault PARTITION OF %s DEFAULT"), table->name, table->name);
+   CHK_EXEC_NO_SP(SQLQuery(query));
+
+   for(time_t start = firstPartition; start <= lastPartition; start += PARTITION_INTERVAL)
+   {
+      TCHAR name[64];
+      BuildPartitionName(table->name, start, name);
+      _sntprintf(query, 1024, _T("CREATE TABLE %s PARTITION OF %s FOR VALUES FROM (") INT64_FMT _T(") TO (") INT64_FMT _T(")"),
+               name, table->name, static_cast<int64_t>(start), static_cast<int64_t>(start + PARTITION_INTERVAL));
+      CHK_EXEC_NO_SP(SQLQuery(query));
+   }
+
+   _sntprintf(query, 1024, _T("INSERT INTO %s SELECT * FROM %s_old"), table->name, table->name);
+   CHK_EXEC_NO_SP(SQLQuery(query));
+
+   for(int i = 0; i < indexes.size(); i++)
+      CHK_EXEC_NO_SP(SQLQuery(indexes.get(i)));
+
+   _sntprintf(query, 1024, _T("DROP TABLE %s_old"), table->name);
+   CHK_EXEC_NO_SP(SQLQuery(query));
+   return true;
+}
+
+/**
+ * Convert table to partitioned layout - MySQL version. Table is partitioned in place.
+ */
+static bool ConvertTable_MYSQL(const PartitionedTable *table, time_t firstPartition, time_t lastPartition)
+{
+   // Primary key of log tables should be extended with timestamp column
+   if (!table->perfData)
+   {
+      StringBuffer query(_T("ALTER TABLE "));
+      query.append(table->name);
+      query.append(_T(" DROP PRIMARY KEY, ADD PRIMARY KEY ("));
+      query.append(table->primaryKey);
+      query.append(_T(")"));
+      CHK_EXEC_NO_SP(SQLQuery(query));
+   }
+
+   StringBuffer query(_T("ALTER TABLE "));
+   query.append(table->name);
+   query.append(_T(" PARTITION BY RANGE ("));
+   query.append(table->timestampColumn);
+   query.append(_T(") ("));
+   for(time_t start = firstPartition; start <= lastPartition; start += PARTITION_INTERVAL)
+   {
+      TCHAR name[64];
+      BuildPartitionName(table->name, start, name);
+      query.append(_T("PARTITION "));
+      query.append(name);
+      query.append(_T(" VALUES LESS THAN ("));
+      query.append(static_cast<int64_t>(start + PARTITION_INTERVAL));
+      query.append(_T("),"));
+   }
+   query.append(_T("PARTITION pmax VALUES LESS THAN MAXVALUE)"));
+   return SQLQuery(query);
+}
+
+/**
+ * Convert log and collected data tables to time partitioned layout
+ */
+void ConvertToPartitionedTables()
+{
+   if ((g_dbSyntax != DB_SYNTAX_PGSQL) && (g_dbSyntax != DB_SYNTAX_MYSQL))
+   {
+      _tprintf(_T("Table partitioning is only supported for PostgreSQL, MySQL, and MariaDB databases\n"));
+      return;
+   }
+
+   if (!ValidateDatabase())
+      return;
+
+   if (g_dbSyntax == DB_SYNTAX_PGSQL)
+   {
+      int version = 0;
+      DB_RESULT hResult = SQLSelect(_T("SHOW server_version_num"));
+      if (hResult != nullptr)
+      {
+         version = DBGetFieldLong(hResult, 0, 0);
+         DBFreeResult(hResult);
+      }
+      if (version < 110000)
+      {
+         _tprintf(_T("PostgreSQL version 11 or higher is required for table partitioning\n"));
+         return;
+      }
+   }
+
+   bool singleTablePerfData = (DBMgrMetaDataReadInt32(_T("SingeTablePerfData"), 0) != 0);
+   if (!singleTablePerfData)
+      _tprintf(_T("Collected data is stored in per-object tables, only log tables will be converted\n"));
+
+   WriteToTerminal(_T("\n\n\x1b[1mWARNING!!!\x1b[0m\n"));
+   if (!GetYesNo(_T("This operation will rebuild log and collected data tables and may take very long time.\nServer should be stopped during conversion.\nAre you sure?")))
+      return;
+
+   time_t today = time(nullptr) / PARTITION_INTERVAL * PARTITION_INTERVAL;
+   time_t lastPartition = today + PARTITIONS_AHEAD * PARTITION_INTERVAL;
+   bool success = true;
+   for(int i = 0; (s_tables[i].name != nullptr) && success; i++)
+   {
+      const PartitionedTable *table = &s_tables[i];
+      if (table->perfData && !singleTablePerfData)
+         continue;
+
+      if (IsTablePartitioned(table->name))
+      {
+         WriteToTerminalEx(_T("Table \x1b[1m%s\x1b[0m is already partitioned\n"), table->name);
+         continue;
+      }
+
+      WriteToTerminalEx(_T("Converting table \x1b[1m%s\x1b[0m\n"), table->name);
+      time_t firstPartition = GetFirstPartitionStart(table, today);
+      if (g_dbSyntax == DB_SYNTAX_PGSQL)
+      {
+         // PostgreSQL supports transactional DDL, so conversion of each table is atomic
+         if (!DBBegin(g_dbHandle))
+         {
+            success = false;
+            break;
+         }
+         success = ConvertTable_PGSQL(table, firstPartition, lastPartition);
+         if (success)
+            DBCommit(g_dbHandle);
+         else
+            DBRollback(g_dbHandle);
+      }
+      else
+      {
+         success = ConvertTable_MYSQL(table, firstPartition, lastPartition);
+      }
+   }
+
+   if (success)
+   {
+      DBMgrMetaDataWriteInt32(_T("PartitionedTables"), 1);
+      _tprintf(_T("Tables converted successfully\n"));
+   }
+   else
+   {
+      _tprintf(_T("Table conversion failed\n"));
+   }
+}
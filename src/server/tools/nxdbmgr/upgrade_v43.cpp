@@ -22,6 +22,58 @@
 
 #include "nxdbmgr.h"
 
+/**
+ * Upgrade from 43.12 to 43.13
+ */
+static bool H_UpgradeFromV12()
+{
+   CHK_EXEC(CreateConfigParam(_T("NetworkDiscovery.ActiveDiscovery.MaxParallelBlocks"), _T("2"), _T("Maximum number of address blocks within single range scanned in parallel during active discovery."), nullptr, 'I', true, true, false, false));
+   CHK_EXEC(CreateConfigParam(_T("NetworkDiscovery.ActiveDiscovery.MaxParallelRanges"), _T("4"), _T("Maximum number of address ranges scanned in parallel during active discovery."), nullptr, 'I', true, true, false, false));
+   CHK_EXEC(SetMinorSchemaVersion(13));
+   return true;
+}
+
+/**
+ * Upgrade from 43.11 to 43.12
+ */
+static bool H_UpgradeFromV11()
+{
+   CHK_EXEC(CreateConfigParam(_T("Server.NXCP.CompressionLevel"), _T("6"), _T("Compression level (1 - fastest, 9 - best compression) for NXCP messages compressed with deflate method."), nullptr, 'I', true, false, false, false));
+   CHK_EXEC(SetMinorSchemaVersion(12));
+   return true;
+}
+
+/**
+ * Upgrade from 43.10 to 43.11
+ */
+static bool H_UpgradeFromV10()
+{
+   CHK_EXEC(CreateConfigParam(_T("SNMP.MaxVarbindsPerRequest"), _T("32"), _T("Maximum number of varbinds in single coalesced SNMP GET request used for data collection. Value of 1 disables request coalescing."), nullptr, 'I', true, false, false, false));
+   CHK_EXEC(SetMinorSchemaVersion(11));
+   return true;
+}
+
+/**
+ * Upgrade from 43.9 to 43.10
+ */
+static bool H_UpgradeFromV9()
+{
+   CHK_EXEC(CreateConfigParam(_T("Events.LogWriter.Threads"), _T("1"), _T("Number of threads used for writing events to event log. Each thread takes connection from database connection pool for every batch it writes."), _T("threads"), 'I', true, true, false, false));
+   CHK_EXEC(SetMinorSchemaVersion(10));
+   return true;
+}
+
+/**
+ * Upgrade from 43.8 to 43.9
+ */
+static bool H_UpgradeFromV8()
+{
+   CHK_EXEC(CreateConfigParam(_T("NXSL.VMPool.SizePerScript"), _T("8"), _T("Maximum number of idle script VMs kept in pool for each script."), nullptr, 'I', true, true, false, false));
+   CHK_EXEC(CreateConfigParam(_T("NXSL.VMPool.TotalSize"), _T("1024"), _T("Maximum total number of idle script VMs kept in pool."), nullptr, 'I', true, true, false, false));
+   CHK_EXEC(SetMinorSchemaVersion(9));
+   return true;
+}
+
 /**
  * Upgrade from 43.7 to 43.8
  */
@@ -334,6 +386,11 @@ static struct
    int nextMinor;
    bool (*upgradeProc)();
 } s_dbUpgradeMap[] = {
+   { 12, 43, 13, H_UpgradeFromV12 },
+   { 11, 43, 12, H_UpgradeFromV11 },
+   { 10, 43, 11, H_UpgradeFromV10 },
+   { 9,  43, 10, H_UpgradeFromV9  },
+   { 8,  43, 9,  H_UpgradeFromV8  },
    { 7,  43, 8,  H_UpgradeFromV7  },
    { 6,  43, 7,  H_UpgradeFromV6  },
    { 5,  43, 6,  H_UpgradeFromV5  },
@@ -0,0 +1,445 @@
+/*
+** NetXMS - Network Management System
+** SNMP support library
+** Copyright (C) 2003-2023 Victor Kirhenshtein
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation; either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+** File: async.cpp
+**
+**/
+
+#include "libnxsnmp.h"
+
+#define DEBUG_TAG _T("snmp.async")
+
+/**
+ * Number of slots in timer wheel
+ */
+#define TIMER_WHEEL_SLOTS     1024
+
+/**
+ * Timer wheel tick (milliseconds)
+ */
+#define TIMER_WHEEL_TICK      10
+
+/**
+ * Size of receive buffer for engine sockets
+ */
+#define SOCKET_RECEIVE_BUFFER_SIZE  (4 * 1024 * 1024)
+
+/**
+ * Pending asynchronous request
+ */
+struct AsyncRequest
+{
+   AsyncRequest *prev;     // Previous request in timer wheel slot
+   AsyncRequest *next;     // Next request in timer wheel slot
+   int slot;
+   uint32_t rounds;        // Number of full timer wheel rotations before expiration
+   uint32_t requestId;
+   SOCKET socket;
+   SockAddrBuffer peer;
+   BYTE *packet;
+   size_t packetSize;
+   uint32_t timeout;
+   int retries;            // Remaining retransmissions
+   SNMP_RequestCallback callback;
+   void *context;
+   char codepage[16];
+};
+
+/**
+ * Engine state
+ */
+static SOCKET s_socketV4 = INVALID_SOCKET;
+#ifdef WITH_IPV6
+static SOCKET s_socketV6 = INVALID_SOCKET;
+#endif
+static THREAD s_ioThread = INVALID_THREAD_HANDLE;
+static bool s_running = false;
+static Mutex s_lock(MutexType::FAST);
+static HashMap<uint32_t, AsyncRequest> s_requests(Ownership::False);
+static AsyncRequest *s_timerWheel[TIMER_WHEEL_SLOTS];
+static int s_currentSlot = 0;
+static VolatileCounter s_requestId = 0;
+
+/**
+ * Destroy request object
+ */
+static inline void DestroyRequest(AsyncRequest *r)
+{
+   MemFree(r->packet);
+   MemFree(r);
+}
+
+/**
+ * Put request into timer wheel. Engine lock must be held.
+ */
+static void ScheduleRequest(AsyncRequest *r)
+{
+   uint32_t ticks = std::max((r->timeout + TIMER_WHEEL_TICK - 1) / TIMER_WHEEL_TICK, static_cast<uint32_t>(1));
+   r->slot = (s_currentSlot + ticks) % TIMER_WHEEL_SLOTS;
+   r->rounds = (ticks - 1) / TIMER_WHEEL_SLOTS;
+   r->prev = nullptr;
+   r->next = s_timerWheel[r->slot];
+   if (r->next != nullptr)
+      r->next->prev = r;
+   s_timerWheel[r->slot] = r;
+}
+
+/**
+ * Remove request from timer wheel. Engine lock must be held.
+ */
+static void UnscheduleRequest(AsyncRequest *r)
+{
+   if (r->prev != nullptr)
+      r->prev->next = r->next;
+   else
+      s_timerWheel[r->slot] = r->next;
+   if (r->next != nullptr)
+      r->next->prev = r->prev;
+}
+
+/**
+ * Send request packet. Engine lock must be held.
+ */
+static inline bool SendRequest(AsyncRequest *r)
+{
+   return sendto(r->socket, reinterpret_cast<char*>(r->packet), static_cast<int>(r->packetSize), 0,
+            reinterpret_cast<struct sockaddr*>(&r->peer), SA_LEN(reinterpret_cast<struct sockaddr*>(&r->peer))) > 0;
+}
+
+/**
+ * Process expired timers for given number of ticks
+ */
+static void ProcessTimers(int ticks)
+{
+   AsyncRequest *expired = nullptr;
+
+   s_lock.lock();
+   for(int i = 0; i < std::min(ticks, TIMER_WHEEL_SLOTS); i++)
+   {
+      s_currentSlot = (s_currentSlot + 1) % TIMER_WHEEL_SLOTS;
+      AsyncRequest *r = s_timerWheel[s_currentSlot];
+      while(r != nullptr)
+      {
+         AsyncRequest *next = r->next;
+         if (r->rounds > 0)
+         {
+            r->rounds--;
+         }
+         else
+         {
+            UnscheduleRequest(r);
+            if ((r->retries > 0) && SendRequest(r))
+            {
+               r->retries--;
+               ScheduleRequest(r);
+            }
+            else
+            {
+               s_requests.remove(r->requestId);
+               r->next = expired;
+               expired = r;
+            }
+         }
+         r = next;
+      }
+   }
+   s_lock.unlock();
+
+   while(expired != nullptr)
+   {
+      AsyncRequest *next = expired->next;
+      expired->callback(SNMP_ERR_TIMEOUT, nullptr, expired->context);
+      DestroyRequest(expired);
+      expired = next;
+   }
+}
+
+/**
+ * Receive and dispatch response from given socket
+ */
+static void ReceiveResponse(SOCKET s, BYTE *buffer, size_t bufferSize)
+{
+   SockAddrBuffer sender;
+   socklen_t addrLen = sizeof(sender);
+   int bytes = recvfrom(s, reinterpret_cast<char*>(buffer), static_cast<int>(bufferSize), 0, reinterpret_cast<struct sockaddr*>(&sender), &addrLen);
+   if (bytes <= 0)
+      return;
+
+   SNMP_PDU *response = new SNMP_PDU();
+   if (!response->parse(buffer, bytes, nullptr, false))
+   {
+      nxlog_debug_tag(DEBUG_TAG, 7, _T("Cannot parse received SNMP packet (%d bytes)"), bytes);
+      delete response;
+      return;
+   }
+
+   s_lock.lock();
+   // Match both address and port, as connected socket used by synchronous path does
+   AsyncRequest *r = s_requests.get(response->getRequestId());
+   if ((r != nullptr) && SocketAddressEquals(reinterpret_cast<struct sockaddr*>(&sender), reinterpret_cast<struct sockaddr*>(&r->peer)) &&
+       (SA_PORT(&sender) == SA_PORT(&r->peer)))
+   {
+      s_requests.remove(r->requestId);
+      UnscheduleRequest(r);
+   }
+   else
+   {
+      r = nullptr;
+   }
+   s_lock.unlock();
+
+   if (r == nullptr)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 8, _T("Response with unknown request ID %u ignored"), response->getRequestId());
+      delete response;
+      return;
+   }
+
+   if (r->codepage[0] != 0)
+      response->setCodepage(r->codepage);
+   r->callback(SNMP_ERR_SUCCESS, response, r->context);
+   DestroyRequest(r);
+}
+
+/**
+ * Engine I/O thread
+ */
+static void IOThread()
+{
+   ThreadSetName("SNMPAsyncIO");
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("SNMP asynchronous engine I/O thread started"));
+
+   BYTE *buffer = MemAllocArrayNoInit<BYTE>(65536);
+   int64_t lastTick = GetCurrentTimeMs();
+   SocketPoller sp;
+   while(s_running)
+   {
+      sp.reset();
+      if (s_socketV4 != INVALID_SOCKET)
+         sp.add(s_socketV4);
+#ifdef WITH_IPV6
+      if (s_socketV6 != INVALID_SOCKET)
+         sp.add(s_socketV6);
+#endif
+      if (sp.poll(TIMER_WHEEL_TICK) > 0)
+      {
+         if ((s_socketV4 != INVALID_SOCKET) && sp.isSet(s_socketV4))
+            ReceiveResponse(s_socketV4, buffer, 65536);
+#ifdef WITH_IPV6
+         if ((s_socketV6 != INVALID_SOCKET) && sp.isSet(s_socketV6))
+            ReceiveResponse(s_socketV6, buffer, 65536);
+#endif
+      }
+
+      int64_t now = GetCurrentTimeMs();
+      int ticks = static_cast<int>((now - lastTick) / TIMER_WHEEL_TICK);
+      if (ticks > 0)
+      {
+         ProcessTimers(ticks);
+         lastTick += static_cast<int64_t>(ticks) * TIMER_WHEEL_TICK;
+      }
+   }
+
+   MemFree(buffer);
+   nxlog_debug_tag(DEBUG_TAG, 2, _T("SNMP asynchronous engine I/O thread stopped"));
+}
+
+/**
+ * Create engine socket for given address family
+ */
+static SOCKET CreateEngineSocket(int family)
+{
+   SOCKET s = CreateSocket(family, SOCK_DGRAM, 0);
+   if (s == INVALID_SOCKET)
+      return INVALID_SOCKET;
+
+   SockAddrBuffer localAddr;
+   memset(&localAddr, 0, sizeof(SockAddrBuffer));
+   if (family == AF_INET)
+   {
+      localAddr.sa4.sin_family = AF_INET;
+      localAddr.sa4.sin_addr.s_addr = htonl(INADDR_ANY);
+   }
+#ifdef WITH_IPV6
+   else
+   {
+      localAddr.sa6.sin6_family = AF_INET6;
+   }
+#endif
+   if (bind(s, reinterpret_cast<struct sockaddr*>(&localAddr), SA_LEN(reinterpret_cast<struct sockaddr*>(&localAddr))) != 0)
+   {
+      closesocket(s);
+      return INVALID_SOCKET;
+   }
+
+   int size = SOCKET_RECEIVE_BUFFER_SIZE;
+   setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<char*>(&size), sizeof(size));
+   return s;
+}
+
+/**
+ * Start asynchronous SNMP engine. When engine is running, SNMPv1 and SNMPv2c requests sent via
+ * UDP transports are multiplexed over shared sockets and served by single I/O thread.
+ */
+bool LIBNXSNMP_EXPORTABLE SnmpStartAsyncEngine()
+{
+   if (s_running)
+      return true;
+
+   s_socketV4 = CreateEngineSocket(AF_INET);
+#ifdef WITH_IPV6
+   s_socketV6 = CreateEngineSocket(AF_INET6);
+#endif
+   if (s_socketV4 == INVALID_SOCKET)
+   {
+      nxlog_debug_tag(DEBUG_TAG, 1, _T("Cannot start SNMP asynchronous engine (unable to create socket)"));
+#ifdef WITH_IPV6
+      if (s_socketV6 != INVALID_SOCKET)
+      {
+         closesocket(s_socketV6);
+         s_socketV6 = INVALID_SOCKET;
+      }
+#endif
+      return false;
+   }
+
+   memset(s_timerWheel, 0, sizeof(s_timerWheel));
+   s_running = true;
+   s_ioThread = ThreadCreateEx(IOThread);
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("SNMP asynchronous engine started"));
+   return true;
+}
+
+/**
+ * Stop asynchronous SNMP engine. All pending requests are completed with SNMP_ERR_ABORTED.
+ */
+void LIBNXSNMP_EXPORTABLE SnmpStopAsyncEngine()
+{
+   if (!s_running)
+      return;
+
+   s_lock.lock();
+   s_running = false;
+   s_lock.unlock();
+   ThreadJoin(s_ioThread);
+   s_ioThread = INVALID_THREAD_HANDLE;
+
+   ObjectArray<AsyncRequest> pending(0, 64, Ownership::False);
+   s_lock.lock();
+   s_requests.forEach<ObjectArray<AsyncRequest>>(
+      [] (const uint32_t& id, AsyncRequest *r, ObjectArray<AsyncRequest> *pending) -> EnumerationCallbackResult
+      {
+         pending->add(r);
+         return _CONTINUE;
+      }, &pending);
+   s_requests.clear();
+   memset(s_timerWheel, 0, sizeof(s_timerWheel));
+   s_lock.unlock();
+
+   for(int i = 0; i < pending.size(); i++)
+   {
+      AsyncRequest *r = pending.get(i);
+      r->callback(SNMP_ERR_ABORTED, nullptr, r->context);
+      DestroyRequest(r);
+   }
+
+   closesocket(s_socketV4);
+   s_socketV4 = INVALID_SOCKET;
+#ifdef WITH_IPV6
+   if (s_socketV6 != INVALID_SOCKET)
+   {
+      closesocket(s_socketV6);
+      s_socketV6 = INVALID_SOCKET;
+   }
+#endif
+   nxlog_debug_tag(DEBUG_TAG, 1, _T("SNMP asynchronous engine stopped (%d pending requests aborted)"), pending.size());
+}
+
+/**
+ * Get number of requests currently in flight in asynchronous engine
+ */
+int LIBNXSNMP_EXPORTABLE SnmpGetAsyncEnginePendingRequests()
+{
+   s_lock.lock();
+   int count = s_requests.size();
+   s_lock.unlock();
+   return count;
+}
+
+/**
+ * Check if asynchronous engine can serve requests to peers of given address family
+ */
+bool SnmpAsyncEngineSupportsFamily(int family)
+{
+   if (!s_running)
+      return false;
+#ifdef WITH_IPV6
+   if (family == AF_INET6)
+      return s_socketV6 != INVALID_SOCKET;
+#endif
+   return family == AF_INET;
+}
+
+/**
+ * Submit request to asynchronous engine. Request is encoded immediately, so request PDU can be destroyed by caller
+ * after this call. Returns false if request cannot be handled by engine (callback will not be called in that case).
+ */
+bool SnmpAsyncEngineSubmit(const SockAddrBuffer *peer, SNMP_PDU *request, SNMP_SecurityContext *securityContext, const char *codepage,
+         uint32_t timeout, int numRetries, SNMP_RequestCallback callback, void *context)
+{
+   int family = reinterpret_cast<const struct sockaddr*>(peer)->sa_family;
+   if (!SnmpAsyncEngineSupportsFamily(family))
+      return false;
+
+   AsyncRequest *r = MemAllocStruct<AsyncRequest>();
+   r->requestId = static_cast<uint32_t>(InterlockedIncrement(&s_requestId)) & 0x7FFFFFFF;
+   request->setRequestId(r->requestId);
+   r->packetSize = request->encode(&r->packet, securityContext);
+   if (r->packetSize == 0)
+   {
+      DestroyRequest(r);
+      return false;
+   }
+#ifdef WITH_IPV6
+   r->socket = (family == AF_INET6) ? s_socketV6 : s_socketV4;
+#else
+   r->socket = s_socketV4;
+#endif
+   memcpy(&r->peer, peer, sizeof(SockAddrBuffer));
+   r->timeout = timeout;
+   r->retries = numRetries - 1;
+   r->callback = callback;
+   r->context = context;
+   if (codepage != nullptr)
+      strlcpy(r->codepage, codepage, 16);
+
+   // Request is sent under lock so I/O thread cannot complete and destroy it before it is sent
+   s_lock.lock();
+   bool success = s_running && SendRequest(r);
+   if (success)
+   {
+      s_requests.set(r->requestId, r);
+      ScheduleRequest(r);
+   }
+   s_lock.unlock();
+
+   if (!success)
+      DestroyRequest(r);
+   return success;
+}
@@ -140,4 +140,8 @@ bool BER_DecodeIdentifier(const BYTE *rawData, size_t rawSize, uint32_t *type, s
 bool BER_DecodeContent(uint32_t type, const BYTE *data, size_t length, BYTE *buffer);
 size_t BER_Encode(uint32_t type, const BYTE *data, size_t dataLength, BYTE *buffer, size_t bufferSize);
 
+bool SnmpAsyncEngineSupportsFamily(int family);
+bool SnmpAsyncEngineSubmit(const SockAddrBuffer *peer, SNMP_PDU *request, SNMP_SecurityContext *securityContext, const char *codepage,
+         uint32_t timeout, int numRetries, SNMP_RequestCallback callback, void *context);
+
 #endif   /* _libnxsnmp_h_ */
@@ -53,9 +53,44 @@ static void ProcessResponse(SOCKET sock, uint32_t baseAddr, uint32_t lastAddr, S
 }
 
 /**
- * Scan range of IPv4 addresses using SNMP requests
+ * Number of requests sent before waiting for responses
  */
-uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, const InetAddress& to, uint16_t port, SNMP_Version snmpVersion, const char *community, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
+#define SCAN_WINDOW_SIZE   32
+
+/**
+ * Encoded probe request
+ */
+struct ProbeRequest
+{
+   BYTE *pdu;
+   size_t size;
+};
+
+/**
+ * Encode probe request for given SNMP version and community
+ */
+static void EncodeProbeRequest(ProbeRequest *probe, SNMP_Version snmpVersion, const char *community)
+{
+   SNMP_SecurityContext securityContext;
+   SNMP_PDU request(SNMP_GET_REQUEST, 1, snmpVersion);
+   if (snmpVersion == SNMP_VERSION_3)
+   {
+      // Use engine ID discovery as request
+      request.bindVariable(new SNMP_Variable(_T(".1.3.6.1.6.3.10.2.1.1.0")));
+   }
+   else
+   {
+      securityContext.setCommunity(community);
+      request.bindVariable(new SNMP_Variable(_T(".1.3.6.1.2.1.1.1.0")));
+   }
+   probe->size = request.encode(&probe->pdu, &securityContext);
+}
+
+/**
+ * Scan range of IPv4 addresses sending all given probe requests to each address. Requests are sent in windows
+ * of SCAN_WINDOW_SIZE addresses, responses are collected while sending and then until timeout expires.
+ */
+static uint32_t ScanAddressRange(uint32_t from, uint32_t to, uint16_t port, const ProbeRequest *probes, int probeCount, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
 {
    SOCKET sock = CreateSocket(AF_INET, SOCK_DGRAM, 0);
    if (sock == INVALID_SOCKET)
@@ -72,41 +107,31 @@ uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, cons
    }
    SetSocketNonBlocking(sock);
 
-   SNMP_SecurityContext securityContext;
-   SNMP_PDU request(SNMP_GET_REQUEST, 1, snmpVersion);
-   if (snmpVersion == SNMP_VERSION_3)
-   {
-      // Use engine ID discovery as request
-      request.bindVariable(new SNMP_Variable(_T(".1.3.6.1.6.3.10.2.1.1.0")));
-   }
-   else
-   {
-      securityContext.setCommunity(community);
-      request.bindVariable(new SNMP_Variable(_T(".1.3.6.1.2.1.1.1.0")));
-   }
-   BYTE *pdu;
-   size_t size = request.encode(&pdu, &securityContext);
-
    struct sockaddr_in saDest;
    memset(&saDest, 0, sizeof(sockaddr_in));
    saDest.sin_family = AF_INET;
    saDest.sin_port = htons(port);
 
    SocketPoller sp;
-   ScanStatus *status = MemAllocArray<ScanStatus>(to.getAddressV4() - from.getAddressV4() + 1);
-   uint32_t baseAddr = from.getAddressV4();
-   for(uint32_t a = baseAddr, i = 0; a <= to.getAddressV4(); a++, i++)
+   ScanStatus *status = MemAllocArray<ScanStatus>(to - from + 1);
+   for(uint32_t a = from, i = 0; a <= to; a++, i++)
    {
       saDest.sin_addr.s_addr = htonl(a);
       status[i].startTime = GetCurrentTimeMs();
       status[i].success = false;
-      sendto(sock, (char *)pdu, static_cast<int>(size), 0, (struct sockaddr *)&saDest, sizeof(struct sockaddr_in));
+      for(int j = 0; j < probeCount; j++)
+         sendto(sock, (char *)probes[j].pdu, static_cast<int>(probes[j].size), 0, (struct sockaddr *)&saDest, sizeof(struct sockaddr_in));
 
-      sp.reset();
-      sp.add(sock);
-      if (sp.poll(10) > 0)
+      // Wait for responses only after each full window, otherwise just read what is already available
+      bool windowEnd = ((i + 1) % SCAN_WINDOW_SIZE == 0);
+      while(true)
       {
-         ProcessResponse(sock, baseAddr, to.getAddressV4(), status);
+         sp.reset();
+         sp.add(sock);
+         if (sp.poll(windowEnd ? 10 : 0) <= 0)
+            break;
+         ProcessResponse(sock, from, to, status);
+         windowEnd = false;
       }
    }
 
@@ -120,14 +145,13 @@ uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, cons
       if (sp.poll(timeout - elapsedTime) <= 0)
          break;
 
-      ProcessResponse(sock, baseAddr, to.getAddressV4(), status);
+      ProcessResponse(sock, from, to, status);
       elapsedTime += static_cast<uint32_t>(GetCurrentTimeMs() - startTime);
    }
 
    closesocket(sock);
-   MemFree(pdu);
 
-   for(uint32_t a = baseAddr, i = 0; a <= to.getAddressV4(); a++, i++)
+   for(uint32_t a = from, i = 0; a <= to; a++, i++)
    {
       if (status[i].success)
          callback(a, status[i].rtt, context);
@@ -136,3 +160,49 @@ uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, cons
 
    return SNMP_ERR_SUCCESS;
 }
+
+/**
+ * Scan range of IPv4 addresses using SNMP requests
+ */
+uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, const InetAddress& to, uint16_t port, SNMP_Version snmpVersion, const char *community, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
+{
+   ProbeRequest probe;
+   EncodeProbeRequest(&probe, snmpVersion, community);
+   uint32_t rc = ScanAddressRange(from.getAddressV4(), to.getAddressV4(), port, &probe, 1, callback, context);
+   MemFree(probe.pdu);
+   return rc;
+}
+
+/**
+ * Scan range of IPv4 addresses using SNMP requests with all given communities (both version 1 and 2c) and
+ * optionally SNMPv3 engine ID discovery request in single pass.
+ */
+uint32_t LIBNXSNMP_EXPORTABLE SnmpScanAddressRange(const InetAddress& from, const InetAddress& to, uint16_t port, const StringList& communities, bool probeV3, void (*callback)(const InetAddress&, uint32_t, void*), void *context)
+{
+   int probeCount = communities.size() * 2 + (probeV3 ? 1 : 0);
+   if (probeCount == 0)
+      return SNMP_ERR_SUCCESS;
+
+   ProbeRequest *probes = MemAllocArrayNoInit<ProbeRequest>(probeCount);
+   int index = 0;
+   for(int i = 0; i < communities.size(); i++)
+   {
+#ifdef UNICODE
+      char community[256];
+      wchar_to_mb(communities.get(i), -1, community, 256);
+#else
+      const char *community = communities.get(i);
+#endif
+      EncodeProbeRequest(&probes[index++], SNMP_VERSION_1, community);
+      EncodeProbeRequest(&probes[index++], SNMP_VERSION_2C, community);
+   }
+   if (probeV3)
+      EncodeProbeRequest(&probes[index++], SNMP_VERSION_3, nullptr);
+
+   uint32_t rc = ScanAddressRange(from.getAddressV4(), to.getAddressV4(), port, probes, probeCount, callback, context);
+
+   for(int i = 0; i < probeCount; i++)
+      MemFree(probes[i].pdu);
+   MemFree(probes);
+   return rc;
+}
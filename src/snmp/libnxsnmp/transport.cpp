@@ -137,6 +137,70 @@ uint32_t SNMP_Transport::doRequest(SNMP_PDU *request, SNMP_PDU **response)
    return doRequest(request, response, SnmpGetDefaultTimeout(), s_defaultRetryCount, false);
 }
 
+/**
+ * Submit request to asynchronous engine. Default implementation does not support asynchronous requests.
+ */
+bool SNMP_Transport::submitAsyncRequest(SNMP_PDU *request, uint32_t timeout, int numRetries, SNMP_RequestCallback callback, void *context)
+{
+   return false;
+}
+
+/**
+ * Send request without waiting for response. Callback will be called when response is received or request fails.
+ * Request PDU can be destroyed by caller after this call. If transport cannot serve request asynchronously, request
+ * is executed synchronously and callback is called before this method returns.
+ */
+void SNMP_Transport::doRequestAsync(SNMP_PDU *request, SNMP_RequestCallback callback, void *context, uint32_t timeout, int numRetries)
+{
+   if ((request == nullptr) || (numRetries <= 0))
+   {
+      callback(SNMP_ERR_PARAM, nullptr, context);
+      return;
+   }
+
+   if (submitAsyncRequest(request, timeout, numRetries, callback, context))
+      return;
+
+   SNMP_PDU *response;
+   uint32_t rc = doRequest(request, &response, timeout, numRetries, false);
+   callback(rc, response, context);
+}
+
+/**
+ * Send request without waiting for response using default timeout and retry count
+ */
+void SNMP_Transport::doRequestAsync(SNMP_PDU *request, SNMP_RequestCallback callback, void *context)
+{
+   doRequestAsync(request, callback, context, SnmpGetDefaultTimeout(), s_defaultRetryCount);
+}
+
+/**
+ * Context for synchronous request executed by asynchronous engine
+ */
+struct SyncRequestContext
+{
+   Condition completed;
+   uint32_t rc;
+   SNMP_PDU *response;
+
+   SyncRequestContext() : completed(true)
+   {
+      rc = SNMP_ERR_ABORTED;
+      response = nullptr;
+   }
+};
+
+/**
+ * Completion callback for synchronous request executed by asynchronous engine
+ */
+static void SyncRequestCallback(uint32_t rc, SNMP_PDU *response, void *context)
+{
+   SyncRequestContext *ctx = static_cast<SyncRequestContext*>(context);
+   ctx->rc = rc;
+   ctx->response = response;
+   ctx->completed.set();
+}
+
 /**
  * Send a request and wait for response with respect for timeouts and retransmissions
  */
@@ -151,6 +215,18 @@ uint32_t SNMP_Transport::doRequest(SNMP_PDU *request, SNMP_PDU **response, uint3
 	if (m_securityContext == nullptr)
 		m_securityContext = new SNMP_SecurityContext();
 
+   // Use shared asynchronous engine if transport supports it and wait for completion
+   if (!engineIdDiscoveryOnly)
+   {
+      SyncRequestContext ctx;
+      if (submitAsyncRequest(request, timeout, numRetries, SyncRequestCallback, &ctx))
+      {
+         ctx.completed.wait(INFINITE);
+         *response = ctx.response;
+         return ctx.rc;
+      }
+   }
+
 	// Update SNMP V3 request with cached context engine id
 	if (request->getVersion() == SNMP_VERSION_3)
 	{
@@ -416,15 +492,32 @@ uint32_t SNMP_UDPTransport::createUDPTransport(const InetAddress& hostAddr, uint
    m_port = port;
    hostAddr.fillSockAddr(&m_peerAddr, port);
 
+   // Socket is not needed while requests are served by shared asynchronous engine.
+   // It will be created on first use if engine is not available at that time.
+   if (SnmpAsyncEngineSupportsFamily(hostAddr.getFamily()))
+   {
+      m_connected = true;
+      return SNMP_ERR_SUCCESS;
+   }
+
+   return createSocket();
+}
+
+/**
+ * Create socket for communication with peer set by createUDPTransport
+ */
+uint32_t SNMP_UDPTransport::createSocket()
+{
    uint32_t result;
 
    // Create and connect socket
-   m_hSocket = CreateSocket(hostAddr.getFamily(), SOCK_DGRAM, 0);
+   int family = reinterpret_cast<struct sockaddr*>(&m_peerAddr)->sa_family;
+   m_hSocket = CreateSocket(family, SOCK_DGRAM, 0);
    if (m_hSocket != INVALID_SOCKET)
    {
       SockAddrBuffer localAddr;
 		memset(&localAddr, 0, sizeof(SockAddrBuffer));
-      if (hostAddr.getFamily() == AF_INET)
+      if (family == AF_INET)
       {
 		   localAddr.sa4.sin_family = AF_INET;
 		   localAddr.sa4.sin_addr.s_addr = htonl(INADDR_ANY);
@@ -616,6 +709,9 @@ int SNMP_UDPTransport::readMessage(SNMP_PDU **pdu, uint32_t timeout, struct sock
  */
 int SNMP_UDPTransport::sendMessage(SNMP_PDU *pdu, uint32_t timeout)
 {
+   if ((m_hSocket == INVALID_SOCKET) && m_connected && (createSocket() != SNMP_ERR_SUCCESS))
+      return -1;
+
    int bytes = 0;
    BYTE *buffer;
    size_t size = pdu->encode(&buffer, m_securityContext);
@@ -650,3 +746,17 @@ bool SNMP_UDPTransport::isProxyTransport()
 {
    return false;
 }
+
+/**
+ * Submit request to shared asynchronous engine. SNMPv3 requests are not handled by engine because
+ * engine ID discovery and time window synchronization are implemented only in synchronous code path.
+ */
+bool SNMP_UDPTransport::submitAsyncRequest(SNMP_PDU *request, uint32_t timeout, int numRetries, SNMP_RequestCallback callback, void *context)
+{
+   if ((request->getVersion() == SNMP_VERSION_3) || !m_connected || m_updatePeerOnRecv)
+      return false;
+
+   if (m_securityContext == nullptr)
+      m_securityContext = new SNMP_SecurityContext();
+   return SnmpAsyncEngineSubmit(&m_peerAddr, request, m_securityContext, m_codepage, timeout, numRetries, callback, context);
+}
@@ -125,6 +125,24 @@ void TestMessageClass()
 
    EndTest();
 
+   StartTest(_T("NXCP message compression (LZ4)"));
+
+   binMsg = msg.serialize(NXCP_STREAM_COMPRESSION_LZ4);
+   AssertNotNull(binMsg);
+   AssertTrue((ntohs(binMsg->flags) & (MF_COMPRESSED | MF_COMPRESSED_LZ4)) == (MF_COMPRESSED | MF_COMPRESSED_LZ4));
+
+   dmsg = NXCPMessage::deserialize(binMsg);
+   AssertNotNull(dmsg);
+   AssertTrue(!dmsg->isCompressedStream());
+   longTextOut = dmsg->getFieldAsString(100);
+   AssertNotNull(longTextOut);
+   AssertTrue(!_tcscmp(longTextOut, longText));
+   MemFree(longTextOut);
+   delete dmsg;
+   MemFree(binMsg);
+
+   EndTest();
+
 #if !WITH_ADDRESS_SANITIZER
    StartTest(_T("NXCP message compression performance"));
    INT64 start = GetCurrentTimeMs();
@@ -141,5 +159,16 @@ void TestMessageClass()
       MemFree(binMsg);
    }
    EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("NXCP message compression performance (LZ4)"));
+   start = GetCurrentTimeMs();
+   for(int i = 0; i < 10000; i++)
+   {
+      msg.deleteAllFields();
+      msg.setField(100, longText);
+      NXCP_MESSAGE *binMsg = msg.serialize(NXCP_STREAM_COMPRESSION_LZ4);
+      MemFree(binMsg);
+   }
+   EndTest(GetCurrentTimeMs() - start);
 #endif
 }
@@ -195,3 +195,128 @@ void TestSharedObjectQueue()
 
    delete q;
 }
+
+/**
+ * Bounded queue producer thread
+ */
+static void BoundedQueueProducer(BoundedQueue *q)
+{
+   void *batch[16];
+   for(int i = 0; i < 10000; i += 16)
+   {
+      for(int j = 0; j < 16; j++)
+         batch[j] = CAST_TO_POINTER(i + j + 1, void*);
+      q->putMany(batch, 16);
+   }
+}
+
+/**
+ * Bounded queue consumer context
+ */
+struct BoundedQueueConsumerContext
+{
+   BoundedQueue *queue;
+   int64_t sum;
+   int count;
+};
+
+/**
+ * Bounded queue consumer thread
+ */
+static void BoundedQueueConsumer(BoundedQueueConsumerContext *context)
+{
+   while(true)
+   {
+      void *p = context->queue->getOrBlock();
+      if (p == INVALID_POINTER_VALUE)
+         break;
+      context->sum += CAST_FROM_POINTER(p, int);
+      context->count++;
+   }
+}
+
+/**
+ * Test bounded queue
+ */
+void TestBoundedQueue()
+{
+   BoundedQueue *q = new BoundedQueue(10);
+
+   StartTest(_T("BoundedQueue: put/get"));
+   AssertEquals(q->capacity(), 16);
+   for(int i = 0; i < 16; i++)
+      AssertTrue(q->tryPut(CAST_TO_POINTER(i + 1, void *)));
+   AssertFalse(q->tryPut(CAST_TO_POINTER(17, void *)));
+   AssertEquals(q->size(), 16);
+   for(int i = 0; i < 16; i++)
+   {
+      void *p = q->get();
+      AssertNotNull(p);
+      AssertEquals(CAST_FROM_POINTER(p, int), i + 1);
+   }
+   AssertNull(q->get());
+   AssertEquals(q->size(), 0);
+   EndTest();
+
+   StartTest(_T("BoundedQueue: putMany/getAll"));
+   void *batch[32];
+   for(int i = 0; i < 12; i++)
+      batch[i] = CAST_TO_POINTER(i + 1, void *);
+   AssertTrue(q->putMany(batch, 12));
+   AssertEquals(q->size(), 12);
+   memset(batch, 0, sizeof(batch));
+   AssertEquals(q->getAll(batch, 5), 5);
+   AssertEquals(CAST_FROM_POINTER(batch[0], int), 1);
+   AssertEquals(CAST_FROM_POINTER(batch[4], int), 5);
+   AssertEquals(q->getAll(batch, 32), 7);
+   AssertEquals(CAST_FROM_POINTER(batch[6], int), 12);
+   AssertEquals(q->getAll(batch, 32), 0);
+   EndTest();
+
+   StartTest(_T("BoundedQueue: getOrBlock timeout"));
+   INT64 startTime = GetCurrentTimeMs();
+   AssertNull(q->getOrBlock(200));
+   AssertTrue(GetCurrentTimeMs() - startTime >= 190);
+   EndTest();
+
+   StartTest(_T("BoundedQueue: shutdown"));
+   q->put(CAST_TO_POINTER(1, void *));
+   q->setShutdownMode();
+   AssertTrue(q->get() == INVALID_POINTER_VALUE);
+   AssertTrue(q->getOrBlock() == INVALID_POINTER_VALUE);
+   delete q;
+   EndTest();
+
+   StartTest(_T("BoundedQueue: multiple producers and consumers"));
+   q = new BoundedQueue(64);
+   THREAD producers[4];
+   THREAD consumers[4];
+   BoundedQueueConsumerContext context[4];
+   for(int i = 0; i < 4; i++)
+   {
+      context[i].queue = q;
+      context[i].sum = 0;
+      context[i].count = 0;
+      consumers[i] = ThreadCreateEx(BoundedQueueConsumer, &context[i]);
+   }
+   for(int i = 0; i < 4; i++)
+      producers[i] = ThreadCreateEx(BoundedQueueProducer, q);
+   for(int i = 0; i < 4; i++)
+      ThreadJoin(producers[i]);
+   while(q->size() > 0)
+      ThreadSleepMs(10);
+   ThreadSleepMs(100);
+   q->setShutdownMode();
+   int64_t sum = 0;
+   int count = 0;
+   for(int i = 0; i < 4; i++)
+   {
+      ThreadJoin(consumers[i]);
+      sum += context[i].sum;
+      count += context[i].count;
+   }
+   AssertEquals(count, 40000);
+   AssertEquals(sum, static_cast<int64_t>(4) * 10000 * 10001 / 2);
+   delete q;
+   EndTest();
+}
@@ -0,0 +1,126 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <testtools.h>
+
+/**
+ * Create connected pair of TCP sockets on loopback interface
+ */
+static bool CreateSocketPair(SOCKET *s1, SOCKET *s2)
+{
+   SOCKET listener = CreateSocket(AF_INET, SOCK_STREAM, 0);
+   if (listener == INVALID_SOCKET)
+      return false;
+
+   struct sockaddr_in addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   socklen_t len = sizeof(addr);
+   if ((bind(listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) ||
+       (listen(listener, 1) != 0) ||
+       (getsockname(listener, reinterpret_cast<struct sockaddr*>(&addr), &len) != 0))
+   {
+      closesocket(listener);
+      return false;
+   }
+
+   *s1 = CreateSocket(AF_INET, SOCK_STREAM, 0);
+   if ((*s1 == INVALID_SOCKET) || (connect(*s1, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0))
+   {
+      closesocket(*s1);
+      closesocket(listener);
+      return false;
+   }
+   *s2 = accept(listener, nullptr, nullptr);
+   closesocket(listener);
+   if (*s2 == INVALID_SOCKET)
+   {
+      closesocket(*s1);
+      return false;
+   }
+   return true;
+}
+
+/**
+ * Background poll result
+ */
+struct BackgroundPollTestContext
+{
+   Condition completed;
+   BackgroundSocketPollResult result;
+
+   BackgroundPollTestContext() : completed(true)
+   {
+      result = BackgroundSocketPollResult::FAILURE;
+   }
+};
+
+/**
+ * Background poll callback
+ */
+static void BackgroundPollTestCallback(BackgroundSocketPollResult result, SOCKET s, BackgroundPollTestContext *context)
+{
+   context->result = result;
+   context->completed.set();
+}
+
+/**
+ * Test socket poller
+ */
+void TestSocketPoller()
+{
+   SOCKET s1, s2;
+
+   StartTest(_T("SocketPoller: read and write polling on same socket"));
+   AssertTrue(CreateSocketPair(&s1, &s2));
+
+   // Connected socket with no incoming data is writable but not readable
+   SocketPoller sp;
+   sp.add(s1, false);
+   sp.add(s1, true);
+   AssertTrue(sp.poll(1000) > 0);
+   AssertTrue(sp.isSet(s1, true));
+   AssertFalse(sp.isSet(s1, false));
+
+   send(s2, "x", 1, 0);
+   sp.reset();
+   sp.add(s1, false);
+   sp.add(s1, true);
+   AssertTrue(sp.poll(1000) > 0);
+   AssertTrue(sp.isSet(s1, true));
+   AssertTrue(sp.isSet(s1, false));
+   EndTest();
+
+   StartTest(_T("BackgroundSocketPoller: read and write requests for same socket"));
+   BackgroundSocketPoller poller;
+   AssertTrue(poller.isValid());
+
+   // Write request completes immediately, read request waits for data
+   char buffer[16];
+   recv(s1, buffer, sizeof(buffer), 0);
+   BackgroundPollTestContext readContext, writeContext;
+   poller.poll(s1, 5000, BackgroundPollTestCallback, &readContext, false);
+   poller.poll(s1, 5000, BackgroundPollTestCallback, &writeContext, true);
+   AssertTrue(writeContext.completed.wait(1000));
+   AssertTrue(writeContext.result == BackgroundSocketPollResult::SUCCESS);
+   AssertFalse(readContext.completed.wait(200));
+
+   send(s2, "x", 1, 0);
+   AssertTrue(readContext.completed.wait(1000));
+   AssertTrue(readContext.result == BackgroundSocketPollResult::SUCCESS);
+
+   // Cancel applies to all requests for socket
+   recv(s1, buffer, sizeof(buffer), 0);
+   BackgroundPollTestContext cancelContext1, cancelContext2;
+   poller.poll(s1, 5000, BackgroundPollTestCallback, &cancelContext1, false);
+   poller.poll(s1, 5000, BackgroundPollTestCallback, &cancelContext2, false);
+   poller.cancel(s1);
+   AssertTrue(cancelContext1.completed.wait(1000));
+   AssertTrue(cancelContext1.result == BackgroundSocketPollResult::CANCELLED);
+   AssertTrue(cancelContext2.completed.wait(1000));
+   AssertTrue(cancelContext2.result == BackgroundSocketPollResult::CANCELLED);
+
+   closesocket(s1);
+   closesocket(s2);
+   EndTest();
+}
@@ -17,6 +17,8 @@ void TestObjectMemoryPool();
 void TestThreadPool();
 void TestQueue();
 void TestSharedObjectQueue();
+void TestBoundedQueue();
+void TestSocketPoller();
 void TestMsgWaitQueue();
 void TestMessageClass();
 void TestMutex();
@@ -1711,6 +1713,140 @@ static void TestTable()
    AssertTrue(!_tcscmp(table2->getAsString(15, 0), table->getAsString(15, 0)));
    EndTest(GetCurrentTimeMs() - start);
 
+   StartTest(_T("Table: pack binary"));
+   table->setStatusAt(5, 1, 3);
+   table->setCellObjectIdAt(7, 2, 42);
+   table->setObjectIdAt(9, 17);
+   start = GetCurrentTimeMs();
+   char *packedData = table->createPackedData();
+   AssertNotNull(packedData);
+   EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("Table: unpack binary"));
+   start = GetCurrentTimeMs();
+   Table *binTable = Table::createFromPackedData(packedData);
+   MemFree(packedData);
+   AssertNotNull(binTable);
+   AssertEquals(binTable->getNumColumns(), table->getNumColumns());
+   AssertEquals(binTable->getNumRows(), table->getNumRows());
+   AssertEquals(binTable->getAsInt(10, 1), table->getAsInt(10, 1));
+   AssertTrue(!_tcscmp(binTable->getAsString(15, 0), table->getAsString(15, 0)));
+   AssertTrue(!_tcscmp(binTable->getColumnName(4), _T("DATA3")));
+   AssertEquals(binTable->getStatus(5, 1), 3);
+   AssertEquals(binTable->getStatus(6, 1), -1);
+   AssertEquals(binTable->getCellObjectId(7, 2), 42);
+   AssertEquals(binTable->getObjectId(9), 17);
+   delete binTable;
+   EndTest(GetCurrentTimeMs() - start);
+
+   StartTest(_T("Table: unpack malformed binary"));
+   packedData = table->createPackedData();
+   AssertNotNull(packedData);
+   char *decoded = nullptr;
+   size_t decodedSize = 0;
+   base64_decode_alloc(packedData, strlen(packedData), &decoded, &decodedSize);
+   MemFree(packedData);
+   AssertNotNull(decoded);
+   AssertTrue(decodedSize > 16);
+
+   // Truncated input
+   char *encoded = nullptr;
+   base64_encode_alloc(decoded, decodedSize / 2, &encoded);
+   AssertNull(Table::createFromPackedData(encoded));
+   MemFree(encoded);
+
+   // Declared body size far above what input can produce
+   decoded[4] = 0x7F;
+   base64_encode_alloc(decoded, decodedSize, &encoded);
+   AssertNull(Table::createFromPackedData(encoded));
+   MemFree(encoded);
+
+   // Header only
+   base64_encode_alloc(decoded, 8, &encoded);
+   AssertNull(Table::createFromPackedData(encoded));
+   MemFree(encoded);
+   MemFree(decoded);
+   EndTest();
+
+   StartTest(_T("Table: pack small table without compression"));
+   Table *smallTable = new Table();
+   smallTable->addColumn(_T("NAME"), DCI_DT_STRING, nullptr, true);
+   smallTable->addColumn(_T("VALUE"), DCI_DT_INT);
+   smallTable->addRow();
+   smallTable->set(0, _T("eth0"));
+   smallTable->set(1, 42);
+   packedData = smallTable->createPackedData();
+   delete smallTable;
+   AssertNotNull(packedData);
+   binTable = Table::createFromPackedData(packedData);
+   MemFree(packedData);
+   AssertNotNull(binTable);
+   AssertEquals(binTable->getNumRows(), 1);
+   AssertTrue(!_tcscmp(binTable->getAsString(0, 0), _T("eth0")));
+   AssertEquals(binTable->getAsInt(0, 1), 42);
+   delete binTable;
+   EndTest();
+
+   StartTest(_T("Table: unpack XML as packed data"));
+   packedTable = table->createPackedXML();
+   binTable = Table::createFromPackedData(packedTable);
+   MemFree(packedTable);
+   AssertNotNull(binTable);
+   AssertEquals(binTable->getNumRows(), table->getNumRows());
+   AssertTrue(!_tcscmp(binTable->getAsString(15, 0), table->getAsString(15, 0)));
+   delete binTable;
+   EndTest();
+
+   StartTest(_T("Table: typed values"));
+   table->setColumnDataType(1, DCI_DT_INT);
+   table->setColumnDataType(2, DCI_DT_FLOAT);
+   table->setColumnDataType(3, DCI_DT_UINT64);
+   AssertEquals(table->getAsInt(10, 1), 9);
+   AssertEquals(table->getAsDouble(10, 2), 900.0);
+   AssertEquals(table->getAsUInt64(10, 3), _ULL(900009));
+   table->setAt(10, 1, _T("0x20"));
+   AssertEquals(table->getAsInt(10, 1), 32);
+   table->setAt(10, 2, 2.5);
+   AssertEquals(table->getAsDouble(10, 2), 2.5);
+   AssertEquals(table->getAsInt(10, 2), 2);
+   EndTest();
+
+   StartTest(_T("Table: find row by instance"));
+   Table *itable = new Table();
+   itable->addColumn(_T("NAME"), DCI_DT_STRING, nullptr, true);
+   itable->addColumn(_T("VALUE"), DCI_DT_INT);
+   for(int i = 0; i < 5000; i++)
+   {
+      itable->addRow();
+      TCHAR b[64];
+      _sntprintf(b, 64, _T("Instance %d"), i);
+      itable->set(0, b);
+      itable->set(1, i);
+   }
+   start = GetCurrentTimeMs();
+   for(int i = 0; i < 5000; i++)
+   {
+      TCHAR b[64];
+      _sntprintf(b, 64, _T("Instance %d"), i);
+      AssertEquals(itable->findRowByInstance(b), i);
+   }
+   AssertEquals(itable->findRowByInstance(_T("Instance 5000")), -1);
+   itable->setAt(100, 0, _T("Renamed"));
+   AssertEquals(itable->findRowByInstance(_T("Renamed")), 100);
+   AssertEquals(itable->findRowByInstance(_T("Instance 100")), -1);
+   itable->setAt(200, 0, _T("Instance 300"));
+   AssertEquals(itable->findRowByInstance(_T("Instance 300")), 200);
+   itable->setAt(200, 0, _T("Instance 200"));
+   AssertEquals(itable->findRowByInstance(_T("Instance 300")), 300);
+   itable->deleteRow(0);
+   AssertEquals(itable->findRowByInstance(_T("Instance 1")), 0);
+   AssertEquals(itable->findRowByInstance(_T("Instance 0")), -1);
+   itable->addRow();
+   itable->set(0, _T("Instance 0"));
+   AssertEquals(itable->findRowByInstance(_T("Instance 0")), 4999);
+   delete itable;
+   EndTest(GetCurrentTimeMs() - start);
+
    StartTest(_T("Table: merge"));
    Table *table3 = new Table();
    table3->addColumn(_T("NAME"));
@@ -2191,6 +2327,8 @@ int main(int argc, char *argv[])
    TestIntegerToString();
    TestQueue();
    TestSharedObjectQueue();
+   TestBoundedQueue();
+   TestSocketPoller();
    TestHashMap();
    TestSharedHashMap();
    TestSynchronizedSharedHashMap();
@@ -0,0 +1,294 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <nms_agent.h>
+#include <testtools.h>
+#include <netxms-version.h>
+
+NETXMS_EXECUTABLE_HEADER(test-libnxagent)
+
+/**
+ * Directory for offline data queue tests
+ */
+static const TCHAR *s_queuePath = _T("test-dcqueue");
+
+/**
+ * Build path to file in queue directory
+ */
+static void BuildQueueFilePath(const TCHAR *name, TCHAR *path)
+{
+   _sntprintf(path, MAX_PATH, _T("%s") FS_PATH_SEPARATOR _T("%s"), s_queuePath, name);
+}
+
+/**
+ * Create test record. Record content is determined by record number and size.
+ */
+static void CreateTestRecord(int n, BYTE *buffer, size_t size)
+{
+   for(size_t i = 0; i < size; i++)
+      buffer[i] = static_cast<BYTE>(n + i);
+}
+
+/**
+ * Append test records with numbers from first to last (inclusive)
+ */
+static void AppendTestRecords(OfflineDataQueue *queue, int first, int last, size_t size)
+{
+   BYTE buffer[1024];
+   for(int n = first; n <= last; n++)
+   {
+      CreateTestRecord(n, buffer, size);
+      AssertTrue(queue->append(buffer, size));
+   }
+}
+
+/**
+ * Check that record matches test record with given number
+ */
+static bool CheckTestRecord(OfflineQueueRecord *record, int n, size_t size)
+{
+   if (record->size != size)
+      return false;
+   BYTE buffer[1024];
+   CreateTestRecord(n, buffer, size);
+   return memcmp(record->data, buffer, size) == 0;
+}
+
+/**
+ * Overwrite part of file in queue directory
+ */
+static void DamageFile(const TCHAR *name, long offset, const void *data, size_t size)
+{
+   TCHAR path[MAX_PATH];
+   BuildQueueFilePath(name, path);
+   FILE *f = _tfopen(path, _T("r+b"));
+   AssertNotNull(f);
+   AssertEquals(fseek(f, offset, SEEK_SET), 0);
+   AssertEquals(fwrite(data, size, 1, f), static_cast<size_t>(1));
+   fclose(f);
+}
+
+/**
+ * Test appending and reading records
+ */
+static void TestOfflineDataQueueAppendAndRead()
+{
+   StartTest(_T("Offline data queue: append and read"));
+
+   DeleteDirectoryTree(s_queuePath);
+   OfflineDataQueue queue(s_queuePath, 65536);
+   AssertTrue(queue.open());
+   AssertEquals(queue.getPendingRecords(), 0u);
+
+   AppendTestRecords(&queue, 1, 10, 100);
+   AssertEquals(queue.getPendingRecords(), 10u);
+   AssertFalse(queue.append("", 0));
+
+   ObjectArray<OfflineQueueRecord> records(16, 16, Ownership::True);
+   queue.read(4, &records);
+   AssertEquals(records.size(), 4);
+   for(int i = 0; i < 4; i++)
+      AssertTrue(CheckTestRecord(records.get(i), i + 1, 100));
+
+   // Reading does not move cursor
+   records.clear();
+   queue.read(4, &records);
+   AssertEquals(records.size(), 4);
+   AssertTrue(CheckTestRecord(records.get(0), 1, 100));
+
+   queue.acknowledge(records.get(3)->next, 4);
+   AssertEquals(queue.getPendingRecords(), 6u);
+
+   records.clear();
+   queue.read(100, &records);
+   AssertEquals(records.size(), 6);
+   for(int i = 0; i < 6; i++)
+      AssertTrue(CheckTestRecord(records.get(i), i + 5, 100));
+
+   queue.acknowledge(records.get(5)->next, 6);
+   AssertEquals(queue.getPendingRecords(), 0u);
+   records.clear();
+   queue.read(100, &records);
+   AssertEquals(records.size(), 0);
+
+   queue.destroy();
+   EndTest();
+}
+
+/**
+ * Test segment rollover and deletion of consumed segments
+ */
+static void TestOfflineDataQueueSegmentRollover()
+{
+   StartTest(_T("Offline data queue: segment rollover"));
+
+   DeleteDirectoryTree(s_queuePath);
+   OfflineDataQueue queue(s_queuePath, 4096);
+   AssertTrue(queue.open());
+
+   // 1000 byte records, so each segment can hold 4 records
+   AppendTestRecords(&queue, 1, 10, 1000);
+   AssertEquals(queue.getPendingRecords(), 10u);
+   AssertEquals(queue.getSegmentCount(), 3);
+
+   // Segment files are allocated in full on creation
+   TCHAR path[MAX_PATH];
+   BuildQueueFilePath(_T("0000000000000001.seg"), path);
+   AssertEquals(FileSize(path), static_cast<UINT64>(4096));
+
+   // Records are read across segment boundaries in order
+   ObjectArray<OfflineQueueRecord> records(16, 16, Ownership::True);
+   queue.read(6, &records);
+   AssertEquals(records.size(), 6);
+   for(int i = 0; i < 6; i++)
+      AssertTrue(CheckTestRecord(records.get(i), i + 1, 1000));
+
+   // Acknowledging records from second segment deletes first segment
+   queue.acknowledge(records.get(5)->next, 6);
+   AssertEquals(queue.getPendingRecords(), 4u);
+   AssertEquals(queue.getSegmentCount(), 2);
+   AssertTrue(_taccess(path, 0) != 0);
+
+   records.clear();
+   queue.read(100, &records);
+   AssertEquals(records.size(), 4);
+   for(int i = 0; i < 4; i++)
+      AssertTrue(CheckTestRecord(records.get(i), i + 7, 1000));
+
+   // Write segment is kept after all records are consumed
+   queue.acknowledge(records.get(3)->next, 4);
+   AssertEquals(queue.getPendingRecords(), 0u);
+   AssertEquals(queue.getSegmentCount(), 1);
+
+   queue.destroy();
+
+   // Record larger than segment size gets its own segment
+   OfflineDataQueue smallSegmentQueue(s_queuePath, 512);
+   AssertTrue(smallSegmentQueue.open());
+   AppendTestRecords(&smallSegmentQueue, 1, 1, 1000);
+   AppendTestRecords(&smallSegmentQueue, 2, 2, 100);
+   AssertEquals(smallSegmentQueue.getSegmentCount(), 2);
+   records.clear();
+   smallSegmentQueue.read(100, &records);
+   AssertEquals(records.size(), 2);
+   AssertTrue(CheckTestRecord(records.get(0), 1, 1000));
+   AssertTrue(CheckTestRecord(records.get(1), 2, 100));
+   smallSegmentQueue.destroy();
+
+   EndTest();
+}
+
+/**
+ * Test replay of unacknowledged records after queue reopen
+ */
+static void TestOfflineDataQueueReplay()
+{
+   StartTest(_T("Offline data queue: replay after restart"));
+
+   DeleteDirectoryTree(s_queuePath);
+   OfflineDataQueue *queue = new OfflineDataQueue(s_queuePath, 4096);
+   AssertTrue(queue->open());
+   AppendTestRecords(queue, 1, 10, 500);
+
+   ObjectArray<OfflineQueueRecord> records(16, 16, Ownership::True);
+   queue->read(7, &records);
+   AssertEquals(records.size(), 7);
+   queue->acknowledge(records.get(2)->next, 3);   // Records 4..7 were read but not acknowledged
+   delete queue;
+
+   queue = new OfflineDataQueue(s_queuePath, 4096);
+   AssertTrue(queue->open());
+   AssertEquals(queue->getPendingRecords(), 7u);
+
+   records.clear();
+   queue->read(100, &records);
+   AssertEquals(records.size(), 7);
+   for(int i = 0; i < 7; i++)
+      AssertTrue(CheckTestRecord(records.get(i), i + 4, 500));
+
+   // New records are appended after existing ones
+   AppendTestRecords(queue, 11, 12, 500);
+   AssertEquals(queue->getPendingRecords(), 9u);
+   records.clear();
+   queue->read(100, &records);
+   AssertEquals(records.size(), 9);
+   AssertTrue(CheckTestRecord(records.get(8), 12, 500));
+
+   queue->destroy();
+   delete queue;
+   EndTest();
+}
+
+/**
+ * Test recovery from damaged segment and cursor files
+ */
+static void TestOfflineDataQueueCorruption()
+{
+   StartTest(_T("Offline data queue: recovery from corruption"));
+
+   // Segment header is 16 bytes, record header is 8 bytes
+   DeleteDirectoryTree(s_queuePath);
+   OfflineDataQueue *queue = new OfflineDataQueue(s_queuePath, 65536);
+   AssertTrue(queue->open());
+   AppendTestRecords(queue, 1, 3, 100);
+   delete queue;
+
+   // Damage payload of last record (simulates torn write); record should be discarded on open
+   BYTE garbage[32];
+   memset(garbage, 0xAA, sizeof(garbage));
+   DamageFile(_T("0000000000000001.seg"), 16 + 2 * 108 + 8 + 50, garbage, 4);
+
+   queue = new OfflineDataQueue(s_queuePath, 65536);
+   AssertTrue(queue->open());
+   AssertEquals(queue->getPendingRecords(), 2u);
+
+   // New record replaces discarded one
+   AppendTestRecords(queue, 4, 4, 100);
+   ObjectArray<OfflineQueueRecord> records(16, 16, Ownership::True);
+   queue->read(100, &records);
+   AssertEquals(records.size(), 3);
+   AssertTrue(CheckTestRecord(records.get(0), 1, 100));
+   AssertTrue(CheckTestRecord(records.get(1), 2, 100));
+   AssertTrue(CheckTestRecord(records.get(2), 4, 100));
+
+   queue->acknowledge(records.get(0)->next, 1);
+   AssertEquals(queue->getPendingRecords(), 2u);
+   delete queue;
+
+   // Damaged cursor file causes reading from oldest segment, so records are delivered again
+   DamageFile(_T("cursor"), 0, garbage, sizeof(garbage));
+   queue = new OfflineDataQueue(s_queuePath, 65536);
+   AssertTrue(queue->open());
+   AssertEquals(queue->getPendingRecords(), 3u);
+   records.clear();
+   queue->read(100, &records);
+   AssertEquals(records.size(), 3);
+   AssertTrue(CheckTestRecord(records.get(0), 1, 100));
+
+   // Damaged segment header makes segment unusable
+   delete queue;
+   DamageFile(_T("0000000000000001.seg"), 0, garbage, 4);
+   queue = new OfflineDataQueue(s_queuePath, 65536);
+   AssertTrue(queue->open());
+   AssertEquals(queue->getPendingRecords(), 0u);
+   AssertEquals(queue->getSegmentCount(), 0);
+   AppendTestRecords(queue, 5, 5, 100);
+   AssertEquals(queue->getPendingRecords(), 1u);
+
+   queue->destroy();
+   delete queue;
+   EndTest();
+}
+
+/**
+ * main()
+ */
+int main(int argc, char *argv[])
+{
+   InitNetXMSProcess(true);
+
+   TestOfflineDataQueueAppendAndRead();
+   TestOfflineDataQueueSegmentRollover();
+   TestOfflineDataQueueReplay();
+   TestOfflineDataQueueCorruption();
+   return 0;
+}
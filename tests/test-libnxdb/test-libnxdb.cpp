@@ -11,6 +11,11 @@ NETXMS_EXECUTABLE_HEADER(test-libnxdb)
 #define MYSQL_LOGIN    _T("builder")
 #define MYSQL_PASSWORD _T("builder1")
 
+#define PGSQL_SERVER   _T("postgres")
+#define PGSQL_DBNAME   _T("nx_build_test")
+#define PGSQL_LOGIN    _T("builder")
+#define PGSQL_PASSWORD _T("builder1")
+
 #define ORA_SERVER   _T("//127.0.0.1/XE")
 #define ORA_LOGIN    _T("netxms")
 #define ORA_PASSWORD _T("netxms")
@@ -124,6 +129,50 @@ static void CommonTests(const TCHAR *prefix, const TCHAR *driver, const TCHAR *s
    AssertEquals(count, 200);
    EndTest();
 
+   /*** batch insert ***/
+   StartTest(prefix, _T("batch insert"));
+   hStmt = DBPrepareEx(session, _T("INSERT INTO nx_test (id,value1,value2_new) VALUES (?,?,?)"), true, buffer);
+   AssertNotNullEx(hStmt, buffer);
+   bool batchMode = DBOpenBatch(hStmt);
+   for(int32_t i = 1001; i <= 1600; i++)
+   {
+      if (batchMode)
+         DBNextBatchRow(hStmt);
+      DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, i);
+      DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, _T("batch"), DB_BIND_STATIC);
+      DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, i);
+      if (!batchMode)
+         AssertTrueEx(DBExecuteEx(hStmt, buffer), buffer);
+   }
+   if (batchMode)
+      AssertTrueEx(DBExecuteEx(hStmt, buffer), buffer);
+   hResult = DBSelectEx(session, _T("SELECT count(*) FROM nx_test WHERE value1='batch'"), buffer);
+   AssertNotNullEx(hResult, buffer);
+   AssertEquals(DBGetFieldLong(hResult, 0, 0), 600);
+   DBFreeResult(hResult);
+   EndTest();
+
+   /*** failed batch should not be applied partially ***/
+   if (batchMode)
+   {
+      StartTest(prefix, _T("failed batch insert"));
+      AssertTrue(DBOpenBatch(hStmt));
+      for(int32_t i = 2001; i <= 2010; i++)
+      {
+         DBNextBatchRow(hStmt);
+         DBBind(hStmt, 1, DB_SQLTYPE_INTEGER, (i == 2005) ? 1001 : i);   // duplicate key in the middle of batch
+         DBBind(hStmt, 2, DB_SQLTYPE_VARCHAR, _T("failed batch"), DB_BIND_STATIC);
+         DBBind(hStmt, 3, DB_SQLTYPE_INTEGER, i);
+      }
+      AssertFalse(DBExecuteEx(hStmt, buffer));
+      hResult = DBSelectEx(session, _T("SELECT count(*) FROM nx_test WHERE value1='failed batch'"), buffer);
+      AssertNotNullEx(hResult, buffer);
+      AssertEquals(DBGetFieldLong(hResult, 0, 0), 0);
+      DBFreeResult(hResult);
+      EndTest();
+   }
+   DBFreeStatement(hStmt);
+
    /*** drop test table ***/
    StartTest(prefix, _T("drop test table"));
    AssertTrue(DBQuery(session, _T("DROP TABLE nx_test")));
@@ -145,6 +194,7 @@ int main(int argc, char *argv[])
    InitNetXMSProcess(true);
 
    bool skipMySQL = false;
+   bool skipPgSQL = false;
    bool skipOracle = false;
    bool skipSQLite = false;
 
@@ -152,6 +202,8 @@ int main(int argc, char *argv[])
    {
       if (!strcmp(argv[i], "--skip-mysql"))
          skipMySQL = true;
+      else if (!strcmp(argv[i], "--skip-pgsql"))
+         skipPgSQL = true;
       else if (!strcmp(argv[i], "--skip-oracle"))
          skipOracle = true;
       else if (!strcmp(argv[i], "--skip-sqlite"))
@@ -165,6 +217,11 @@ int main(int argc, char *argv[])
       CommonTests(_T("MySQL"), _T("mysql.ddr"), MYSQL_SERVER, MYSQL_DBNAME, MYSQL_LOGIN, MYSQL_PASSWORD, _T("MYSQL"));
    }
 
+   if (!skipPgSQL)
+   {
+      CommonTests(_T("PostgreSQL"), _T("pgsql.ddr"), PGSQL_SERVER, PGSQL_DBNAME, PGSQL_LOGIN, PGSQL_PASSWORD, _T("PGSQL"));
+   }
+
    if (!skipOracle)
    {
       CommonTests(_T("Oracle"), _T("oracle.ddr"), ORA_SERVER, NULL, ORA_LOGIN, ORA_PASSWORD, _T("ORACLE"));
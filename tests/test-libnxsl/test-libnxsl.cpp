@@ -72,6 +72,175 @@ static void TestStop()
    EndTest();
 }
 
+/**
+ * Test VM pool in script library
+ */
+static void TestVMPool()
+{
+   StartTest(_T("NXSL_Library VM pool"));
+
+   TCHAR errorMessage[256];
+   NXSL_Environment env;
+   NXSL_Program *program = NXSLCompile(_T("if ($marker != null) return -1; return $1 * 2;"), errorMessage, 256, nullptr, &env);
+   AssertNotNull(program);
+
+   NXSL_Library library;
+   ScriptVMHandle vm = library.acquireVM(program, [] { return new NXSL_Environment(); });
+   AssertTrue(vm.isValid());
+   AssertTrue(vm.isPooled());
+   NXSL_VM *firstVM = vm.vm();
+   vm->setGlobalVariable("$marker", vm->createValue(1));
+   vm->setUserData(program);
+   NXSL_Value *arg = vm->createValue(21);
+   AssertTrue(vm->run(1, &arg));
+   AssertEquals(vm->getResult()->getValueAsInt32(), -1);
+   vm.destroy();
+   AssertEquals(library.getVMPoolSize(), 1);
+
+   // Same VM should be reused with clean state
+   vm = library.acquireVM(program, [] { return new NXSL_Environment(); });
+   AssertTrue(vm.isValid());
+   AssertTrue(vm.vm() == firstVM);
+   AssertEquals(library.getVMPoolSize(), 0);
+   AssertNull(vm->findGlobalVariable("$marker"));
+   AssertNull(vm->getUserData());
+   arg = vm->createValue(21);
+   AssertTrue(vm->run(1, &arg));
+   AssertEquals(vm->getResult()->getValueAsInt32(), 42);
+   vm.destroy();
+   AssertEquals(library.getVMPoolSize(), 1);
+
+   // Library change should invalidate pooled VMs
+   library.addScript(new NXSL_LibraryScript(1, uuid::generate(), _T("Module"), MemCopyString(_T("return 1;")), &env));
+   vm = library.acquireVM(program, [] { return new NXSL_Environment(); });
+   AssertTrue(vm.isValid());
+   AssertEquals(library.getVMPoolSize(), 0);
+   vm.destroy();
+   AssertEquals(library.getVMPoolSize(), 1);
+
+   library.purgeVMPool(-1);
+   AssertEquals(library.getVMPoolSize(), 0);
+
+   delete program;
+
+   EndTest();
+}
+
+/**
+ * Scripts for optimizer tests. Each script should produce same result with and without full optimization.
+ */
+static const TCHAR *s_optimizerTestScripts[] =
+{
+   _T("return 2 + 3 * 4 - 10 / 4;"),
+   _T("return (1 << 4) | 3 ^ 7 & 12;"),
+   _T("return 17 % 5 + 17 \\ 5 - -3;"),
+   _T("return 2147483647 + 1;"),
+   _T("return 4294967295U + 1;"),
+   _T("return 1.5 * 4 > 5;"),
+   _T("return \"abc\" .. 12 .. \"def\" .. 1.5;"),
+   _T("return 5 == 5.0;"),
+   _T("return 5 == \"5\";"),
+   _T("return null == 0;"),
+   _T("return null != null;"),
+   _T("return \"abc\" like \"a*\";"),
+   _T("return \"ABC\" ilike \"a?c\";"),
+   _T("return !0 && ~5 == -6;"),
+   _T("return 10 / 0;"),
+   _T("return 10 % 0;"),
+   _T("return 1.5 & 1;"),
+   _T("return \"text\" + 1;"),
+   _T("a = 0; for(i = 0; i < 100; i++) a += i; return a;"),
+   _T("a = 0; for(i = 10; i > 0; i--) a -= i * 2; return a;"),
+   _T("x = 10; x++; ++x; x--; --x; x++; return x - 1;"),
+   _T("x = 2147483647; x += 1; return x;"),
+   _T("x = 5000000000; return (x > 7) .. (x < -7) .. (x == 5000000000);"),
+   _T("x = 1.5; return (x + 1) .. (x - 1) .. (x >= 1) .. (x <= 1);"),
+   _T("x = \"5\"; return x < 10;"),
+   _T("x = \"5\"; return x + 1;"),
+   _T("x = null; return x == 0;"),
+   _T("x = null; return x + 1;"),
+   _T("x = 3U; return (x - 5) .. (x > 2) .. (x != 3);"),
+   _T("x = 3; switch(x) { case 1: return \"one\"; case 3: return \"three\"; default: return \"other\"; }"),
+   _T("function f(n) { if (n > 1) return n * f(n - 1); return 1; return 0; } return f(10);"),
+   _T("function f(n) { return n + 1; exit 2; } a = f(1); return a; b = 10; return b;"),
+   _T("s = 0; try { s = 1; abort 5; s = 2; } catch { s += 10; } return s;"),
+   _T("c = 0; while(true) { c++; if (c >= 10) break; } return c;"),
+   _T("with x = { 10 }, y = { return 7; } r = (x + y + 1) * 2; return r;"),
+   nullptr
+};
+
+/**
+ * Run script compiled with given optimization mode. Returns result as string or error code.
+ */
+static String RunOptimizerTestScript(const TCHAR *source, bool fullOptimization, uint32_t *codeSize)
+{
+   TCHAR errorMessage[256];
+   NXSL_Environment *env = new NXSL_Environment();
+   NXSL_Program *program = NXSLCompile(source, errorMessage, 256, nullptr, env, fullOptimization);
+   if (program == nullptr)
+   {
+      delete env;
+      return String(_T("compilation error"));
+   }
+   *codeSize = program->getCodeSize();
+
+   StringBuffer result;
+   NXSL_VM *vm = new NXSL_VM(env);
+   if (vm->load(program) && vm->run())
+   {
+      NXSL_Value *v = vm->getResult();
+      result.append(v->getDataType());
+      result.append(_T(":"));
+      result.append(v->isNull() ? _T("null") : v->getValueAsCString());
+   }
+   else
+   {
+      result.append(_T("error "));
+      result.append(vm->getErrorCode());
+   }
+   delete vm;
+   delete program;
+   return result;
+}
+
+/**
+ * Test NXSL optimizer (compare results of optimized and unoptimized code)
+ */
+static void TestOptimizer()
+{
+   StartTest(_T("NXSL optimizer"));
+   for(int i = 0; s_optimizerTestScripts[i] != nullptr; i++)
+   {
+      uint32_t basicCodeSize = 0, fullCodeSize = 0;
+      String basic = RunOptimizerTestScript(s_optimizerTestScripts[i], false, &basicCodeSize);
+      String full = RunOptimizerTestScript(s_optimizerTestScripts[i], true, &fullCodeSize);
+      if (!basic.equals(full))
+         _tprintf(_T("\n   Result mismatch for script \"%s\": \"%s\" / \"%s\"\n"), s_optimizerTestScripts[i], basic.cstr(), full.cstr());
+      AssertTrue(basic.equals(full));
+      AssertTrue(fullCodeSize <= basicCodeSize);
+   }
+
+   // Constant expression should be evaluated at compile time
+   TCHAR errorMessage[256];
+   NXSL_Environment env;
+   NXSL_Program *program = NXSLCompile(_T("return 2 + 3 * 4 .. \"x\";"), errorMessage, 256, nullptr, &env);
+   AssertNotNull(program);
+   AssertEquals(program->getCodeSize(), 3);   // PUSH_CONSTANT, RETURN, RET_NULL
+   delete program;
+
+   // Unreachable code should be removed
+   program = NXSLCompile(_T("function f() { return 1; a = 2; return a; } return f();"), errorMessage, 256, nullptr, &env, false);
+   AssertNotNull(program);
+   uint32_t basicCodeSize = program->getCodeSize();
+   delete program;
+   program = NXSLCompile(_T("function f() { return 1; a = 2; return a; } return f();"), errorMessage, 256, nullptr, &env);
+   AssertNotNull(program);
+   AssertTrue(program->getCodeSize() < basicCodeSize);
+   delete program;
+
+   EndTest();
+}
+
 /**
  * Run test NXSL script
  */
@@ -140,6 +309,8 @@ int main(int argc, char *argv[])
 
    TestCompiler();
    TestStop();
+   TestVMPool();
+   TestOptimizer();
    RunTestScript(_T("addr.nxsl"));
    RunTestScript(_T("arrays.nxsl"));
    RunTestScript(_T("base64.nxsl"));
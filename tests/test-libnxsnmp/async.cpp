@@ -0,0 +1,318 @@
+#include <nms_common.h>
+#include <nms_util.h>
+#include <nxsnmp.h>
+#include <testtools.h>
+
+static uint32_t s_sysDescription[] = { 1, 3, 6, 1, 2, 1, 1, 1, 0 };
+static SNMP_ObjectId s_oidSysDescription(s_sysDescription, sizeof(s_sysDescription) / sizeof(uint32_t));
+static uint32_t s_sysLocation[] = { 1, 3, 6, 1, 2, 1, 1, 6, 0 };
+static SNMP_ObjectId s_oidSysLocation(s_sysLocation, sizeof(s_sysLocation) / sizeof(uint32_t));
+
+/**
+ * Context for asynchronous request
+ */
+struct AsyncTestContext
+{
+   Condition completed;
+   uint32_t rc;
+   SNMP_PDU *response;
+
+   AsyncTestContext() : completed(true)
+   {
+      rc = SNMP_ERR_ABORTED;
+      response = nullptr;
+   }
+
+   ~AsyncTestContext()
+   {
+      delete response;
+   }
+};
+
+/**
+ * Completion callback for asynchronous request
+ */
+static void AsyncTestCallback(uint32_t rc, SNMP_PDU *response, void *context)
+{
+   auto ctx = static_cast<AsyncTestContext*>(context);
+   ctx->rc = rc;
+   ctx->response = response;
+   ctx->completed.set();
+}
+
+/**
+ * Create UDP socket for fake agent bound to loopback address
+ */
+static SOCKET CreateAgentSocket(uint16_t *port)
+{
+   SOCKET s = CreateSocket(AF_INET, SOCK_DGRAM, 0);
+   if (s == INVALID_SOCKET)
+      return INVALID_SOCKET;
+
+   struct sockaddr_in addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   socklen_t len = sizeof(addr);
+   if ((bind(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) ||
+       (getsockname(s, reinterpret_cast<struct sockaddr*>(&addr), &len) != 0))
+   {
+      closesocket(s);
+      return INVALID_SOCKET;
+   }
+   *port = ntohs(addr.sin_port);
+   return s;
+}
+
+/**
+ * Receive request on fake agent socket
+ */
+static SNMP_PDU *ReceiveRequest(SOCKET s, SockAddrBuffer *sender, uint32_t timeout)
+{
+   SocketPoller sp;
+   sp.add(s);
+   if (sp.poll(timeout) <= 0)
+      return nullptr;
+
+   BYTE buffer[65536];
+   socklen_t addrLen = sizeof(SockAddrBuffer);
+   int bytes = recvfrom(s, reinterpret_cast<char*>(buffer), sizeof(buffer), 0, reinterpret_cast<struct sockaddr*>(sender), &addrLen);
+   if (bytes <= 0)
+      return nullptr;
+
+   SNMP_PDU *request = new SNMP_PDU();
+   if (!request->parse(buffer, bytes, nullptr, false))
+   {
+      delete request;
+      return nullptr;
+   }
+   return request;
+}
+
+/**
+ * Send response to given request from fake agent socket. Response contains same variable names as request.
+ */
+static void SendResponse(SOCKET s, SNMP_PDU *request, const SockAddrBuffer *peer)
+{
+   SNMP_PDU response(SNMP_RESPONSE, request->getRequestId(), request->getVersion());
+   for(int i = 0; i < request->getNumVariables(); i++)
+   {
+      auto v = new SNMP_Variable(request->getVariable(i)->getName());
+      v->setValueFromString(ASN_OCTET_STRING, _T("test"));
+      response.bindVariable(v);
+   }
+
+   SNMP_SecurityContext context("public");
+   BYTE *packet;
+   size_t size = response.encode(&packet, &context);
+   if (size > 0)
+   {
+      sendto(s, reinterpret_cast<char*>(packet), static_cast<int>(size), 0,
+               reinterpret_cast<const struct sockaddr*>(peer), SA_LEN(reinterpret_cast<const struct sockaddr*>(peer)));
+      MemFree(packet);
+   }
+}
+
+/**
+ * Test demultiplexing of responses by request ID
+ */
+static void TestRequestIdDemultiplexing()
+{
+   StartTest(_T("SNMP async engine: demultiplexing by request ID"));
+
+   uint16_t port;
+   SOCKET s = CreateAgentSocket(&port);
+   AssertTrue(s != INVALID_SOCKET);
+
+   // Agent collects both requests and answers them in reverse order
+   THREAD agent = ThreadCreateEx(
+      [s] () -> void
+      {
+         SNMP_PDU *requests[2];
+         SockAddrBuffer peers[2];
+         int count = 0;
+         while((count < 2) && ((requests[count] = ReceiveRequest(s, &peers[count], 2000)) != nullptr))
+            count++;
+         for(int i = count - 1; i >= 0; i--)
+         {
+            SendResponse(s, requests[i], &peers[i]);
+            delete requests[i];
+         }
+      });
+
+   SNMP_UDPTransport transport;
+   AssertEquals(transport.createUDPTransport(InetAddress::LOOPBACK, port), SNMP_ERR_SUCCESS);
+
+   SNMP_PDU request1(SNMP_GET_REQUEST, 0, SNMP_VERSION_2C);
+   request1.bindVariable(new SNMP_Variable(s_oidSysDescription));
+   SNMP_PDU request2(SNMP_GET_REQUEST, 0, SNMP_VERSION_2C);
+   request2.bindVariable(new SNMP_Variable(s_oidSysLocation));
+
+   AsyncTestContext context1, context2;
+   transport.doRequestAsync(&request1, AsyncTestCallback, &context1, 2000, 1);
+   transport.doRequestAsync(&request2, AsyncTestCallback, &context2, 2000, 1);
+
+   AssertTrue(context1.completed.wait(5000));
+   AssertTrue(context2.completed.wait(5000));
+   ThreadJoin(agent);
+   closesocket(s);
+
+   AssertEquals(context1.rc, SNMP_ERR_SUCCESS);
+   AssertNotNull(context1.response);
+   AssertEquals(context1.response->getVariable(0)->getName().compare(s_oidSysDescription), OID_EQUAL);
+   AssertEquals(context2.rc, SNMP_ERR_SUCCESS);
+   AssertNotNull(context2.response);
+   AssertEquals(context2.response->getVariable(0)->getName().compare(s_oidSysLocation), OID_EQUAL);
+   AssertEquals(SnmpGetAsyncEnginePendingRequests(), 0);
+
+   EndTest();
+}
+
+/**
+ * Test that response with matching request ID but from different peer is ignored
+ */
+static void TestPeerDemultiplexing()
+{
+   StartTest(_T("SNMP async engine: demultiplexing by peer address"));
+
+   uint16_t port, otherPort;
+   SOCKET s = CreateAgentSocket(&port);
+   AssertTrue(s != INVALID_SOCKET);
+   SOCKET other = CreateAgentSocket(&otherPort);
+   AssertTrue(other != INVALID_SOCKET);
+
+   // Agent answers from different port, so response does not match request peer
+   THREAD agent = ThreadCreateEx(
+      [s, other] () -> void
+      {
+         SockAddrBuffer peer;
+         SNMP_PDU *request = ReceiveRequest(s, &peer, 2000);
+         if (request != nullptr)
+         {
+            SendResponse(other, request, &peer);
+            delete request;
+         }
+      });
+
+   SNMP_UDPTransport transport;
+   AssertEquals(transport.createUDPTransport(InetAddress::LOOPBACK, port), SNMP_ERR_SUCCESS);
+
+   SNMP_PDU request(SNMP_GET_REQUEST, 0, SNMP_VERSION_2C);
+   request.bindVariable(new SNMP_Variable(s_oidSysDescription));
+
+   AsyncTestContext context;
+   transport.doRequestAsync(&request, AsyncTestCallback, &context, 500, 1);
+   AssertTrue(context.completed.wait(5000));
+   ThreadJoin(agent);
+   closesocket(s);
+   closesocket(other);
+
+   AssertEquals(context.rc, SNMP_ERR_TIMEOUT);
+   AssertNull(context.response);
+
+   EndTest();
+}
+
+/**
+ * Test timeout and retransmission scheduling
+ */
+static void TestTimeoutAndRetries()
+{
+   StartTest(_T("SNMP async engine: timeout and retransmissions"));
+
+   uint16_t port;
+   SOCKET s = CreateAgentSocket(&port);
+   AssertTrue(s != INVALID_SOCKET);
+
+   // Agent never answers, only counts received packets
+   int packets = 0;
+   THREAD agent = ThreadCreateEx(
+      [s, &packets] () -> void
+      {
+         SockAddrBuffer peer;
+         SNMP_PDU *request;
+         while((request = ReceiveRequest(s, &peer, 1000)) != nullptr)
+         {
+            packets++;
+            delete request;
+         }
+      });
+
+   SNMP_UDPTransport transport;
+   AssertEquals(transport.createUDPTransport(InetAddress::LOOPBACK, port), SNMP_ERR_SUCCESS);
+
+   SNMP_PDU request(SNMP_GET_REQUEST, 0, SNMP_VERSION_2C);
+   request.bindVariable(new SNMP_Variable(s_oidSysDescription));
+
+   AsyncTestContext context;
+   int64_t startTime = GetCurrentTimeMs();
+   transport.doRequestAsync(&request, AsyncTestCallback, &context, 100, 3);
+   AssertEquals(SnmpGetAsyncEnginePendingRequests(), 1);
+   AssertTrue(context.completed.wait(5000));
+   int64_t elapsed = GetCurrentTimeMs() - startTime;
+   ThreadJoin(agent);
+   closesocket(s);
+
+   AssertEquals(context.rc, SNMP_ERR_TIMEOUT);
+   AssertEquals(packets, 3);   // Initial request and two retransmissions
+   AssertTrue(elapsed >= 250);
+   AssertEquals(SnmpGetAsyncEnginePendingRequests(), 0);
+
+   EndTest();
+}
+
+/**
+ * Test that SNMPv3 requests are executed via synchronous path
+ */
+static void TestV3Fallback()
+{
+   StartTest(_T("SNMP async engine: synchronous fallback for SNMPv3"));
+
+   uint16_t port;
+   SOCKET s = CreateAgentSocket(&port);
+   AssertTrue(s != INVALID_SOCKET);
+
+   SNMP_UDPTransport transport;
+   AssertEquals(transport.createUDPTransport(InetAddress::LOOPBACK, port), SNMP_ERR_SUCCESS);
+   transport.setSecurityContext(new SNMP_SecurityContext("user", "password", SNMP_AUTH_SHA1));
+
+   SNMP_PDU request(SNMP_GET_REQUEST, 0, SNMP_VERSION_3);
+   request.bindVariable(new SNMP_Variable(s_oidSysDescription));
+
+   // Request is not handled by engine, so callback is called before doRequestAsync returns
+   AsyncTestContext context;
+   transport.doRequestAsync(&request, AsyncTestCallback, &context, 100, 1);
+   AssertTrue(context.completed.wait(0));
+   AssertTrue(context.rc != SNMP_ERR_SUCCESS);
+   AssertEquals(SnmpGetAsyncEnginePendingRequests(), 0);
+
+   // Synchronous path should still reach the agent (engine ID discovery request)
+   SockAddrBuffer peer;
+   SNMP_PDU *received = ReceiveRequest(s, &peer, 1000);
+   AssertNotNull(received);
+   AssertEquals(received->getVersion(), SNMP_VERSION_3);
+   delete received;
+   closesocket(s);
+
+   EndTest();
+}
+
+/**
+ * Asynchronous SNMP engine tests
+ */
+void TestAsyncEngine()
+{
+   StartTest(_T("SNMP async engine: start"));
+   AssertTrue(SnmpStartAsyncEngine());
+   EndTest();
+
+   TestRequestIdDemultiplexing();
+   TestPeerDemultiplexing();
+   TestTimeoutAndRetries();
+   TestV3Fallback();
+
+   StartTest(_T("SNMP async engine: stop"));
+   SnmpStopAsyncEngine();
+   AssertEquals(SnmpGetAsyncEnginePendingRequests(), 0);
+   EndTest();
+}
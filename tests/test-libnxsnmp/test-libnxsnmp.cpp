@@ -14,6 +14,8 @@ static SNMP_ObjectId s_oidSysLocation(s_sysLocation, sizeof(s_sysLocation) / siz
 static uint32_t s_system[] = { 1, 3, 6, 1, 2, 1, 1 };
 static SNMP_ObjectId s_oidSystem(s_system, sizeof(s_system) / sizeof(uint32_t));
 
+void TestAsyncEngine();
+
 /**
  * Test OID conversion
  */
@@ -153,5 +155,6 @@ int main(int argc, char *argv[])
    TestOidConversion();
    TestOidClass();
    TestVariableClass();
+   TestAsyncEngine();
    return 0;
 }